@@ -58,10 +58,12 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_acmp_sm_listener.h"
 
 #include "openavb_avdecc_msg_server.h"
+#include "openavb_endpoint_status.h"
 #include "openavb_trace.h"
 
 // forward declarations
 static bool openavbAvdeccMsgSrvrReceiveFromClient(int avdeccMsgHandle, openavbAvdeccMessage_t *msg);
+static void openavbAvdeccMsgSrvrPollEndpointStatus(void);
 
 // OSAL specific functions
 #include "openavb_avdecc_msg_server_osal.c"
@@ -249,6 +251,43 @@ bool openavbAvdeccMsgSrvrHndlTalkerStreamIDFromClient(int avdeccMsgHandle, U8 sr
 	return true;
 }
 
+/* Talkers whose streams have a slot in the endpoint status table don't send
+ * their stream information.  Pick up changes to it from the table instead.
+ */
+static void openavbAvdeccMsgSrvrPollEndpointStatus(void)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AVDECC_MSG);
+
+	avdecc_msg_state_t *pState;
+	int i1;
+
+	for (i1 = 0; (pState = AvdeccMsgStateListGetIndex(i1)) != NULL; i1++) {
+		openavb_tl_data_cfg_t *pCfg = pState->stream;
+		if (!pState->bTalker || !pCfg) {
+			continue;
+		}
+
+		AVBStreamID_t streamID;
+		memset(&streamID, 0, sizeof(AVBStreamID_t));
+		if (pCfg->stream_addr.mac) {
+			memcpy(streamID.addr, pCfg->stream_addr.mac->ether_addr_octet, ETH_ALEN);
+		}
+		streamID.uniqueID = pCfg->stream_uid;
+
+		openavb_endpoint_status_t status;
+		if (!openavbEptStatusFind(&streamID, &status) || status.updates == pState->statusUpdates) {
+			continue;
+		}
+		pState->statusUpdates = status.updates;
+
+		openavbAvdeccMsgSrvrHndlTalkerStreamIDFromClient(pState->avdeccMsgHandle,
+			status.srClass, status.streamID.addr, status.streamID.uniqueID,
+			status.destAddr, status.vlanID);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
+}
+
 bool openavbAvdeccMsgSrvrListenerStreamID(int avdeccMsgHandle, U8 sr_class, const U8 stream_src_mac[6], U16 stream_uid, const U8 stream_dest_mac[6], U16 stream_vlan_id)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AVDECC_MSG);
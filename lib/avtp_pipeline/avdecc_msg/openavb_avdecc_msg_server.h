@@ -52,6 +52,9 @@ struct _avdecc_msg_state {
 	// Talker/Listener state information.
 	openavbAvdeccMsgStateType_t lastRequestedState;
 	openavbAvdeccMsgStateType_t lastReportedState;
+
+	// Changes of the Talker stream in the endpoint status table already passed on.
+	U32 statusUpdates;
 };
 
 #endif // OPENAVB_AVDECC_MSG_SERVER_H
@@ -253,7 +253,7 @@ static void inline rxDeliveryStats(avtp_rx_info_t *rxInfo,
 }
 #endif
 
-static openavbRC fillAvtpHdr(avtp_stream_t *pStream, U8 *pFill)
+openavbRC openavbAvtpFillHdr(avtp_stream_t *pStream, U8 *pFill)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AVTP_DETAIL);
 
@@ -320,7 +320,7 @@ openavbRC openavbAvtpTx(void *pv, bool bSend, bool txBlockingInIntf)
 		avtpFrameLen = pStream->frameLen - pStream->ethHdrLen;
 
 		// Fill the AVTP Header. This must be done before calling the interface and mapping modules.
-		openavbRC rc = fillAvtpHdr(pStream, pFill);
+		openavbRC rc = openavbAvtpFillHdr(pStream, pFill);
 		if (IS_OPENAVB_FAILURE(rc)) {
 			AVB_RC_LOG_TRACE_RET(rc, AVB_TRACE_AVTP_DETAIL);
 		}
@@ -467,7 +467,7 @@ openavbRC openavbAvtpRxInit(
 	AVB_RC_TRACE_RET(OPENAVB_AVTP_SUCCESS, AVB_TRACE_AVTP);
 }
 
-static void x_avtpRxFrame(avtp_stream_t *pStream, U8 *pFrame, U32 frameLen)
+void openavbAvtpRxFrame(avtp_stream_t *pStream, U8 *pFrame, U32 frameLen)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AVTP_DETAIL);
 	IF_LOG_INTERVAL(4096) AVB_LOGF_DEBUG("pFrame=%p, len=%u", pFrame, frameLen);
@@ -558,7 +558,7 @@ static void avtpTryRx(avtp_stream_t *pStream)
 	while (!pBuf) {
 		if (!openavbMediaQUsecTillTail(pStream->pMediaQ, &timeout)) {
 			// No mediaQ item available therefore wait for a new packet
-			timeout = AVTP_MAX_BLOCK_USEC;
+			timeout = pStream->bRxPoll ? OPENAVB_RAWSOCK_NONBLOCK : AVTP_MAX_BLOCK_USEC;
 			pBuf = (U8 *)openavbRawsockGetRxFrame(pStream->rawsock, timeout, &offsetToFrame, &frameLen);
 			if (!pBuf) {
 				AVB_TRACE_EXIT(AVB_TRACE_AVTP_DETAIL);
@@ -572,6 +572,10 @@ static void avtpTryRx(avtp_stream_t *pStream)
 			// Previously would check for new packets but disabled to favor presentation times.
 			// pBuf = (U8 *)openavbRawsockGetRxFrame(pStream->rawsock, OPENAVB_RAWSOCK_NONBLOCK, &offsetToFrame, &frameLen);
 		}
+		else if (pStream->bRxPoll) {
+			// The pending item isn't due yet. Only take a packet that is already waiting.
+			pBuf = (U8 *)openavbRawsockGetRxFrame(pStream->rawsock, OPENAVB_RAWSOCK_NONBLOCK, &offsetToFrame, &frameLen);
+		}
 		else {
 			if (timeout > AVTP_MAX_BLOCK_USEC)
 				timeout = AVTP_MAX_BLOCK_USEC;
@@ -582,6 +586,12 @@ static void avtpTryRx(avtp_stream_t *pStream)
 			if (!pBuf)
 				pStream->pIntfCB->intf_rx_cb(pStream->pMediaQ);
 		}
+
+		if (!pBuf && pStream->bRxPoll) {
+			// Come back on the next poll rather than waiting here.
+			AVB_TRACE_EXIT(AVB_TRACE_AVTP_DETAIL);
+			return;
+		}
 	}
 
 	hdrLen = openavbRawsockRxParseHdr(pStream->rawsock, pBuf, &hdrInfo);
@@ -591,7 +601,7 @@ static void avtpTryRx(avtp_stream_t *pStream)
 	else {
 		pAvtpPdu = pBuf + offsetToFrame + hdrLen;
 		avtpPduLen = frameLen - hdrLen;
-		x_avtpRxFrame(pStream, pAvtpPdu, avtpPduLen);
+		openavbAvtpRxFrame(pStream, pAvtpPdu, avtpPduLen);
 	}
 	openavbRawsockRelRxFrame(pStream->rawsock, pBuf);
 
@@ -664,6 +674,22 @@ openavbRC openavbAvtpRx(void *pv)
 	AVB_RC_TRACE_RET(AVB_RC(OPENAVB_AVTP_FAILURE | OPENAVBAVTP_RC_NO_FRAMES_PROCESSED), AVB_TRACE_AVTP_DETAIL);
 }
 
+void openavbAvtpSetRxPoll(void *handle, bool bPoll)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_AVTP);
+
+	avtp_stream_t *pStream = (avtp_stream_t *)handle;
+	if (!pStream) {
+		AVB_RC_LOG(AVB_RC(OPENAVB_AVTP_FAILURE | OPENAVB_RC_INVALID_ARGUMENT));
+		AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+		return;
+	}
+
+	pStream->bRxPoll = bPoll;
+
+	AVB_TRACE_EXIT(AVB_TRACE_AVTP);
+}
+
 void openavbAvtpConfigTimsstampEval(void *handle, U32 tsInterval, U32 reportInterval, bool smoothing, U32 tsMaxJitter, U32 tsMaxDrift)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AVTP);
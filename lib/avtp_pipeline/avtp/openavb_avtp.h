@@ -126,6 +126,8 @@ typedef struct
 	// MediaQ
 	media_q_t *pMediaQ;
 	bool bRxSignalMode;
+	// Never block in openavbAvtpRx(). Used when the stream shares a worker thread.
+	bool bRxPoll;
 
 	// TX frame buffer
 	U8* pBuf;
@@ -174,6 +176,9 @@ openavbRC openavbAvtpRxInit(media_q_t *pMediaQ,
 
 openavbRC openavbAvtpRx(void *handle);
 
+// Make openavbAvtpRx() return at once when no frame is waiting.
+void openavbAvtpSetRxPoll(void *handle, bool bPoll);
+
 void openavbAvtpConfigTimsstampEval(void *handle, U32 tsInterval, U32 reportInterval, bool smoothing, U32 tsMaxJitter, U32 tsMaxDrift);
 
 void openavbAvtpPause(void *handle, bool bPause);
@@ -189,4 +194,12 @@ int openavbAvtpLost(void *handle);
 
 U64 openavbAvtpBytes(void *handle);
 
+// Fill the common stream data header of the next frame of a talker stream.
+// Called by openavbAvtpTx(), the pipeline bench times it directly.
+openavbRC openavbAvtpFillHdr(avtp_stream_t *pStream, U8 *pFill);
+
+// Check the header of a received frame, count lost frames and pass it to the mapping module.
+// Called by openavbAvtpRx(), the pipeline bench times it directly.
+void openavbAvtpRxFrame(avtp_stream_t *pStream, U8 *pFrame, U32 frameLen);
+
 #endif //AVB_AVTP_H
@@ -61,6 +61,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_qmgr.h"
 #include "openavb_maap.h"
 #include "openavb_shaper.h"
+#include "openavb_hash.h"
 
 #define	AVB_LOG_COMPONENT	"Endpoint"
 #include "openavb_pub.h"
@@ -72,6 +73,15 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 // list of streams that we're managing
 clientStream_t* 				x_streamList;
+static clientStream_t*			x_streamListTail;
+// indexes into the list, so lookups don't have to walk it
+static openavb_hash_t			x_streamsById;		// by 8 byte stream ID
+static openavb_hash_t			x_streamsByMaap;	// by MAAP handle
+static openavb_hash_t			x_streamsByHandle;	// by client handle (one stream per client)
+// the MAAP restart callback looks streams up from the MAAP thread
+static pthread_mutex_t			x_streamMutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+#define STREAMS_LOCK()			pthread_mutex_lock(&x_streamMutex)
+#define STREAMS_UNLOCK()		pthread_mutex_unlock(&x_streamMutex)
 // true until we are signalled to stop
 bool endpointRunning = TRUE;
 // data from our configuration file
@@ -119,14 +129,56 @@ void openavbEndPtLogAllStaticStreams(void)
 	}
 }
 
+/* Stream ID in the 8 byte form used as the index key
+ */
+static void x_streamKey(const AVBStreamID_t *streamID, U8 key[8])
+{
+	memcpy(key, streamID->addr, ETH_ALEN);
+	key[6] = streamID->uniqueID >> 8;
+	key[7] = streamID->uniqueID & 0xFF;
+}
+
+static bool x_streamIndexOpen(void)
+{
+	x_streamList = NULL;
+	x_streamListTail = NULL;
+	x_streamsById = openavbHashNew(8, x_cfg.maxStreams);
+	x_streamsByMaap = openavbHashNew(sizeof(void *), x_cfg.maxStreams);
+	x_streamsByHandle = openavbHashNew(sizeof(int), x_cfg.maxStreams);
+	return x_streamsById && x_streamsByMaap && x_streamsByHandle;
+}
+
+static void x_streamIndexClose(void)
+{
+	while (x_streamList) {
+		clientStream_t *ps = x_streamList;
+		x_streamList = ps->next;
+		free(ps);
+	}
+	x_streamListTail = NULL;
+	openavbHashDelete(x_streamsById);
+	openavbHashDelete(x_streamsByMaap);
+	openavbHashDelete(x_streamsByHandle);
+	x_streamsById = NULL;
+	x_streamsByMaap = NULL;
+	x_streamsByHandle = NULL;
+}
+
 /* Called for each talker or listener stream declared by clients
  */
 clientStream_t* addStream(int h, AVBStreamID_t *streamID)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
-	clientStream_t *newClientStream = NULL, **lpp;
+	clientStream_t *newClientStream = NULL;
+	U8 key[8];
 
+	STREAMS_LOCK();
 	do {
+		if (openavbHashCount(x_streamsById) >= x_cfg.maxStreams) {
+			AVB_LOGF_ERROR("addStream: Stream limit reached (max_streams = %u)", x_cfg.maxStreams);
+			break;
+		}
+
 		newClientStream = (clientStream_t *)calloc(1, sizeof(clientStream_t));
 		if(newClientStream == NULL) {
 			AVB_LOG_ERROR("addStream: Failed to malloc stream");
@@ -137,37 +189,104 @@ clientStream_t* addStream(int h, AVBStreamID_t *streamID)
 		newClientStream->streamID.uniqueID = streamID->uniqueID;
 		newClientStream->clientHandle = h;
 		newClientStream->fwmark = INVALID_FWMARK;
+		newClientStream->pStatus = openavbEptStatusSlotOpen(streamID);
+
+		x_streamKey(streamID, key);
+		if (!openavbHashPut(x_streamsById, key, newClientStream)
+			|| !openavbHashPut(x_streamsByHandle, &h, newClientStream)) {
+			AVB_LOG_ERROR("addStream: Failed to index stream");
+			openavbHashRemove(x_streamsById, key);
+			openavbEptStatusSlotClose(newClientStream->pStatus);
+			free(newClientStream);
+			newClientStream = NULL;
+			break;
+		}
 
-		if(x_streamList == NULL) {
+		// insert at end
+		newClientStream->prev = x_streamListTail;
+		if (x_streamListTail)
+			x_streamListTail->next = newClientStream;
+		else
 			x_streamList = newClientStream;
-		}else {
-			// insert at end
-			for(lpp = &x_streamList; *lpp != NULL; lpp = &(*lpp)->next) {
-				if ((*lpp)->next == NULL) {
-					(*lpp)->next = newClientStream;
-					break;
-				}
-			}
-		}
+		x_streamListTail = newClientStream;
 	} while (0);
+	STREAMS_UNLOCK();
 	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 	return newClientStream;
 }
 
 void delStream(clientStream_t* ps)
 {
-	clientStream_t **lpp;
-	for(lpp = &x_streamList; *lpp != NULL; lpp = &(*lpp)->next) {
-		if((*lpp) == ps) {
-			*lpp = (*lpp)->next;
-			free(ps);
-			break;
-		}
-	}
+	U8 key[8];
+
+	if (!ps)
+		return;
+
+	STREAMS_LOCK();
+	x_streamKey(&ps->streamID, key);
+	if (openavbHashGet(x_streamsById, key) == ps)
+		openavbHashRemove(x_streamsById, key);
+	if (openavbHashGet(x_streamsByHandle, &ps->clientHandle) == ps)
+		openavbHashRemove(x_streamsByHandle, &ps->clientHandle);
+	setStreamMaap(ps, NULL);
+	openavbEptStatusSlotClose(ps->pStatus);
+
+	if (ps->prev)
+		ps->prev->next = ps->next;
+	else
+		x_streamList = ps->next;
+	if (ps->next)
+		ps->next->prev = ps->prev;
+	else
+		x_streamListTail = ps->prev;
+	STREAMS_UNLOCK();
+	free(ps);
+}
+
+/* Record the MAAP allocation for a stream, so the MAAP restart
+ * callback can find the stream from the handle.
+ */
+void setStreamMaap(clientStream_t *ps, void *hndMaap)
+{
+	STREAMS_LOCK();
+	if (ps->hndMaap && openavbHashGet(x_streamsByMaap, &ps->hndMaap) == ps)
+		openavbHashRemove(x_streamsByMaap, &ps->hndMaap);
+	ps->hndMaap = hndMaap;
+	if (hndMaap && !openavbHashPut(x_streamsByMaap, &hndMaap, ps))
+		AVB_LOG_ERROR("Failed to index MAAP handle");
+	STREAMS_UNLOCK();
 }
 
 /* Find a stream in the list of streams we're handling
  */
+/* Copy what we know about a stream to its slot in the status table.
+ */
+void publishStream(clientStream_t *ps)
+{
+	openavb_endpoint_status_t *pSlot = ps->pStatus;
+
+	if (!pSlot)
+		return;
+
+	openavbEptStatusBegin(pSlot);
+	pSlot->role = ps->role;
+	memcpy(pSlot->destAddr, ps->destAddr, ETH_ALEN);
+	pSlot->bMaap = ps->hndMaap != NULL;
+	pSlot->bShaped = ps->hndShaper != NULL;
+	pSlot->srClass = ps->srClass;
+	pSlot->srRank = ps->srRank;
+	pSlot->priority = ps->priority;
+	pSlot->vlanID = ps->vlanID;
+	pSlot->classRate = ps->classRate;
+	pSlot->tSpec = ps->tSpec;
+	pSlot->latency = ps->latency;
+	pSlot->fwmark = ps->fwmark;
+	pSlot->lsnrDecl = ps->lsnrDecl;
+	pSlot->tlkrDecl = ps->tlkrDecl;
+	pSlot->failInfo = ps->failInfo;
+	openavbEptStatusEnd(pSlot);
+}
+
 clientStream_t* findStream(AVBStreamID_t *streamID)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
@@ -196,15 +315,24 @@ clientStream_t* findStream(AVBStreamID_t *streamID)
 		AVB_LOGF_DEBUG("Replaced default streamID MAC with interface MAC "ETH_FORMAT, ETH_OCTETS(streamID->addr));
 	}
 
-	clientStream_t **lpp;
-	for(lpp = &x_streamList; *lpp != NULL; lpp = &(*lpp)->next) {
-		if (memcmp(streamID->addr, (*lpp)->streamID.addr, ETH_ALEN) == 0
-			&& streamID->uniqueID == (*lpp)->streamID.uniqueID)
-		{
-			ps = *lpp;
-			break;
-		}
-	}
+	U8 key[8];
+	x_streamKey(streamID, key);
+	STREAMS_LOCK();
+	ps = openavbHashGet(x_streamsById, key);
+	STREAMS_UNLOCK();
+
+	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+	return ps;
+}
+
+/* Find the stream belonging to a client
+ */
+clientStream_t* findStreamHandle(int h)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
+	STREAMS_LOCK();
+	clientStream_t* ps = openavbHashGet(x_streamsByHandle, &h);
+	STREAMS_UNLOCK();
 	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 	return ps;
 }
@@ -214,16 +342,9 @@ clientStream_t* findStream(AVBStreamID_t *streamID)
 static clientStream_t* findStreamMaap(void* hndMaap)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
-	clientStream_t* ps = NULL;
-
-	clientStream_t **lpp;
-	for(lpp = &x_streamList; *lpp != NULL; lpp = &(*lpp)->next) {
-		if ((*lpp)->hndMaap == hndMaap)
-		{
-			ps = *lpp;
-			break;
-		}
-	}
+	STREAMS_LOCK();
+	clientStream_t* ps = openavbHashGet(x_streamsByMaap, &hndMaap);
+	STREAMS_UNLOCK();
 	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 	return ps;
 }
@@ -253,7 +374,7 @@ bool x_talkerDeregister(clientStream_t *ps)
 	// Release MAAP address allocation
 	if (ps->hndMaap) {
 		openavbMaapRelease(ps->hndMaap);
-		ps->hndMaap = NULL;
+		setStreamMaap(ps, NULL);
 	}
 
 	// Finish Shaping
@@ -347,7 +468,13 @@ openavbRC strmAttachCb(void* pv,
 		rc = OPENAVB_SUCCESS;
 	}
 
-	if (IS_OPENAVB_SUCCESS(rc)) {
+	if (lsnrDecl != openavbSrp_LDSt_Stream_Info) {
+		ps->lsnrDecl = lsnrDecl;
+	}
+	publishStream(ps);
+
+	// A client with a slot in the status table reads the new state from there
+	if (IS_OPENAVB_SUCCESS(rc) && !ps->pStatus) {
 
 		openavbEptSrvrNotifyTlkrOfSrpCb(ps->clientHandle,
 		                             &ps->streamID,
@@ -381,15 +508,31 @@ openavbRC strmRegCb(void *pv,
 	clientStream_t *ps = (clientStream_t*)pv;
 	AVB_LOGF_INFO("SRP listener callback uid=%d: tlkrDecl=%x", ps->streamID.uniqueID, tlkrDecl);
 
-	openavbEptSrvrNotifyLstnrOfSrpCb(ps->clientHandle,
-								&ps->streamID,
-								x_cfg.ifname,
-								destAddr,
-								tlkrDecl,
-								tSpec,
-								srClass,
-								accumLatency,
-								failInfo);
+	// For a listener these describe the talker's stream
+	ps->tlkrDecl = tlkrDecl;
+	if (destAddr)
+		memcpy(ps->destAddr, destAddr, ETH_ALEN);
+	if (tSpec)
+		ps->tSpec = *tSpec;
+	ps->srClass = srClass;
+	ps->latency = accumLatency;
+	if (failInfo)
+		ps->failInfo = *failInfo;
+	else
+		memset(&ps->failInfo, 0, sizeof(ps->failInfo));
+	publishStream(ps);
+
+	if (!ps->pStatus) {
+		openavbEptSrvrNotifyLstnrOfSrpCb(ps->clientHandle,
+									&ps->streamID,
+									x_cfg.ifname,
+									destAddr,
+									tlkrDecl,
+									tSpec,
+									srClass,
+									accumLatency,
+									failInfo);
+	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 	return OPENAVB_SUCCESS;
@@ -473,16 +616,27 @@ int avbEndpointLoop(void)
 			AVB_LOG_WARNING(" ");
 		}
 
-		x_streamList = NULL;
+		if (!x_streamIndexOpen()) {
+			AVB_LOG_ERROR("Failed to allocate stream tables");
+			x_streamIndexClose();
+			break;
+		}
+
+		// Without the status table clients are told about their streams over the socket
+		if (!openavbEptStatusCreate(x_cfg.maxStreams, x_cfg.ifname, x_cfg.ifmac)) {
+			AVB_LOG_WARNING("Failed to create stream status table");
+		}
 
 		if (!openavbQmgrInitialize(x_cfg.fqtss_mode, x_cfg.ifindex, x_cfg.ifname, x_cfg.mtu, x_cfg.link_kbit, x_cfg.nsr_kbit)) {
 			AVB_LOG_ERROR("Failed to initialize QMgr");
+			x_streamIndexClose();
 			break;
 		}
 
-		if (!openavbMaapInitialize(x_cfg.ifname, x_cfg.maapPort, &(x_cfg.maap_preferred), maapRestartCallback)) {
+		if (!openavbMaapInitialize(x_cfg.ifname, x_cfg.maapPort, &(x_cfg.maap_preferred), x_cfg.maxStreams, maapRestartCallback)) {
 			AVB_LOG_ERROR("Failed to initialize MAAP");
 			openavbQmgrFinalize();
+			x_streamIndexClose();
 			break;
 		}
 
@@ -490,6 +644,7 @@ int avbEndpointLoop(void)
 			AVB_LOG_ERROR("Failed to initialize Shaper");
 			openavbMaapFinalize();
 			openavbQmgrFinalize();
+			x_streamIndexClose();
 			break;
 		}
 
@@ -512,6 +667,7 @@ int avbEndpointLoop(void)
 			openavbShaperFinalize();
 			openavbMaapFinalize();
 			openavbQmgrFinalize();
+			x_streamIndexClose();
 			break;
 		}
 
@@ -534,9 +690,12 @@ int avbEndpointLoop(void)
 		openavbShaperFinalize();
 		openavbMaapFinalize();
 		openavbQmgrFinalize();
+		x_streamIndexClose();
 
 	} while (0);
 
+	openavbEptStatusDestroy();
+
 	if (!x_cfg.bypassAsCapableCheck && (stopPTP() < 0)) {
 		AVB_LOG_WARNING("Failed to execute PTP stop command: killall -s SIGINT openavb_gptp");
 	}
@@ -40,6 +40,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_srp_api.h"
 #include "openavb_endpoint_cfg.h"
 #include "openavb_tl.h"
+#include "openavb_endpoint_status.h"
 
 #define AVB_ENDPOINT_HANDLE_INVALID (-1)
 #define ENDPOINT_RECONNECT_SECONDS 	10
@@ -125,6 +126,7 @@ typedef struct {
 
 typedef struct clientStream_t {
 	struct clientStream_t *next; // next link list pointer
+	struct clientStream_t *prev; // previous link list pointer
 
 	int				clientHandle;		// ID that links this info to client (talker or listener)
 
@@ -143,6 +145,9 @@ typedef struct clientStream_t {
 	U8				priority;			// AVB priority to use for stream
 	U16				vlanID;				// VLAN ID to use for stream
 	U32				classRate;			// observation intervals per second
+	U8				lsnrDecl;			// last listener declaration (talker)
+	U8				tlkrDecl;			// last talker declaration (listener)
+	openavbSrpFailInfo_t failInfo;		// failure reported with the talker declaration (listener)
 
 	// Information provided by MAAP
 	void			*hndMaap;			// handle for MAAP address allocation
@@ -153,6 +158,9 @@ typedef struct clientStream_t {
 
 	// Information provided by QMgr
 	int				fwmark;				// mark to identify packets of this stream
+
+	// Slot in the stream status table, kept up to date by publishStream()
+	openavb_endpoint_status_t *pStatus;
 } clientStream_t;
 
 int startPTP(void);
@@ -161,8 +169,11 @@ int stopPTP(void);
 bool openavbEndpointServerOpen(void);
 void openavbEndpointServerClose(void);
 clientStream_t* findStream(AVBStreamID_t *streamID);
+clientStream_t* findStreamHandle(int h);
 void delStream(clientStream_t* ps);
 clientStream_t* addStream(int h, AVBStreamID_t *streamID);
+void setStreamMaap(clientStream_t *ps, void *hndMaap);
+void publishStream(clientStream_t *ps);
 void openavbEndPtLogAllStaticStreams(void);
 bool x_talkerDeregister(clientStream_t *ps);
 bool x_listenerDetach(clientStream_t *ps);
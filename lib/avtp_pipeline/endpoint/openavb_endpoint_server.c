@@ -62,11 +62,10 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 // forward declarations
 static bool openavbEptSrvrReceiveFromClient(int h, openavbEndpointMessage_t *msg);
 
-#include "openavb_endpoint_server_osal.c"
-
 // the following are from openavb_endpoint.c
 extern openavb_endpoint_cfg_t  x_cfg;
-extern clientStream_t*         x_streamList;
+
+#include "openavb_endpoint_server_osal.c"
 
 
 static bool openavbEptSrvrReceiveFromClient(int h, openavbEndpointMessage_t *msg)
@@ -243,7 +242,7 @@ bool openavbEptSrvrRegisterStream(int h,
 	if ((!noMaapAllocation && openavbMaapDaemonAvailable()) ||
 			memcmp(ps->destAddr, destAddr, ETH_ALEN) == 0) {
 		struct ether_addr addr;
-		ps->hndMaap = openavbMaapAllocate(1, &addr);
+		setStreamMaap(ps, openavbMaapAllocate(1, &addr));
 		if (ps->hndMaap) {
 			memcpy(ps->destAddr, addr.ether_addr_octet, ETH_ALEN);
 			strmAttachCb((void*)ps, openavbSrp_LDSt_Stream_Info);		// Inform talker about MAAP
@@ -258,7 +257,7 @@ bool openavbEptSrvrRegisterStream(int h,
 	else {
 		// client-supplied destination MAC address
 		memcpy(ps->destAddr, destAddr, ETH_ALEN);
-		ps->hndMaap = NULL;
+		setStreamMaap(ps, NULL);
 	}
 
 	// If the Shaper is available, enable it.
@@ -274,6 +273,8 @@ bool openavbEptSrvrRegisterStream(int h,
 		}
 	}
 
+	publishStream(ps);
+
 	// Do SRP talker register
 	AVB_LOGF_DEBUG("REGISTER: ps=%p, streamID=%d, tspec=%d,%d, srClass=%d, srRank=%d, latency=%d, tsRate=%d, da="ETH_FORMAT"",
 				   ps, streamID->uniqueID,
@@ -335,6 +336,7 @@ bool openavbEptSrvrAttachStream(int h,
 			return FALSE;
 		}
 		ps->role = clientListener;
+		publishStream(ps);
 	}
 
 	if(x_cfg.noSrp) {
@@ -403,16 +405,12 @@ void openavbEptSrvrCloseClientConnection(int h)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
 
-	clientStream_t **lpp;
-	for(lpp = &x_streamList; *lpp != NULL; lpp = &(*lpp)->next) {
-		if ((*lpp)->clientHandle == h)
-		{
-			if ((*lpp)->role == clientTalker)
-				x_talkerDeregister((*lpp));
-			else if ((*lpp)->role == clientListener)
-				x_listenerDetach((*lpp));
-			break;
-		}
+	clientStream_t *ps = findStreamHandle(h);
+	if (ps) {
+		if (ps->role == clientTalker)
+			x_talkerDeregister(ps);
+		else if (ps->role == clientListener)
+			x_listenerDetach(ps);
 	}
 	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 }
@@ -0,0 +1,386 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Shared memory table of the endpoint's stream status.
+*
+* The table is a header followed by a fixed number of slots. Only the endpoint writes it;
+* a mutex serializes its own threads (server and SRP callbacks) while the slot sequence
+* counts let readers in other processes take consistent copies without any locking
+* between processes. A reader keeps its mapping until it finds the table closed or the
+* endpoint that created it gone, and then maps the current one.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "openavb_platform.h"
+#include "openavb_trace.h"
+#include "openavb_endpoint_status.h"
+
+#define	AVB_LOG_COMPONENT	"Endpoint Status"
+#include "openavb_pub.h"
+#include "openavb_log.h"
+
+#define STATUS_MAGIC		"AVBSTAT"
+
+// Reads of a slot that keeps changing give up after this many tries
+#define STATUS_READ_TRIES	1000
+
+typedef struct {
+	char magic[8];
+	U32 layout;
+	U32 slotSize;
+	U32 slotCount;
+	U32 avbVersion;
+	char ifname[IFNAMSIZ + 10];
+	U8 ifmac[ETH_ALEN];
+	// Cleared when the endpoint removes the table
+	volatile U32 bOpen;
+} status_header_t;
+
+#define STATUS_SLOTS(pHdr)	((openavb_endpoint_status_t *)((U8 *)(pHdr) + sizeof(status_header_t)))
+
+// Table as created by this process (endpoint only)
+static status_header_t *x_pWriter = NULL;
+static U32 x_writerSize = 0;
+static MUTEX_HANDLE_ALT(x_writerMutex) = PTHREAD_MUTEX_INITIALIZER;
+
+// Table as mapped for reading
+static status_header_t *x_pReader = NULL;
+static U32 x_readerSize = 0;
+static MUTEX_HANDLE_ALT(x_readerMutex) = PTHREAD_MUTEX_INITIALIZER;
+
+static bool x_streamIdEqual(const AVBStreamID_t *pA, const AVBStreamID_t *pB)
+{
+	return pA->uniqueID == pB->uniqueID && memcmp(pA->addr, pB->addr, ETH_ALEN) == 0;
+}
+
+static void x_writeBegin(openavb_endpoint_status_t *pSlot)
+{
+	__sync_fetch_and_add(&pSlot->seq, 1);
+	__sync_synchronize();
+}
+
+static void x_writeEnd(openavb_endpoint_status_t *pSlot)
+{
+	pSlot->updates++;
+	__sync_synchronize();
+	__sync_fetch_and_add(&pSlot->seq, 1);
+}
+
+bool openavbEptStatusCreate(U32 maxStreams, const char *ifname, const U8 ifmac[ETH_ALEN])
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
+
+	MUTEX_LOCK_ALT(x_writerMutex);
+	if (x_pWriter) {
+		MUTEX_UNLOCK_ALT(x_writerMutex);
+		AVB_LOG_ERROR("Stream status table already created");
+		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+		return FALSE;
+	}
+
+	U32 size = sizeof(status_header_t) + maxStreams * sizeof(openavb_endpoint_status_t);
+	status_header_t *pHdr = openavbEptStatusMapOsal(TRUE, &size);
+	if (!pHdr) {
+		MUTEX_UNLOCK_ALT(x_writerMutex);
+		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+		return FALSE;
+	}
+
+	// The object is new and zero filled, so all slots are free. Readers
+	// ignore the table until bOpen is set.
+	memcpy(pHdr->magic, STATUS_MAGIC, sizeof(pHdr->magic));
+	pHdr->layout = OPENAVB_ENDPOINT_STATUS_LAYOUT;
+	pHdr->slotSize = sizeof(openavb_endpoint_status_t);
+	pHdr->slotCount = maxStreams;
+	pHdr->avbVersion = AVB_CORE_VER_FULL;
+	strncpy(pHdr->ifname, ifname, sizeof(pHdr->ifname) - 1);
+	memcpy(pHdr->ifmac, ifmac, ETH_ALEN);
+	__sync_synchronize();
+	pHdr->bOpen = TRUE;
+
+	x_pWriter = pHdr;
+	x_writerSize = size;
+	MUTEX_UNLOCK_ALT(x_writerMutex);
+
+	AVB_LOGF_DEBUG("Stream status table %s created for %" PRIu32 " streams", OPENAVB_ENDPOINT_STATUS_NAME, maxStreams);
+	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+	return TRUE;
+}
+
+void openavbEptStatusDestroy(void)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
+
+	MUTEX_LOCK_ALT(x_writerMutex);
+	if (x_pWriter) {
+		x_pWriter->bOpen = FALSE;
+		__sync_synchronize();
+		openavbEptStatusUnmapOsal(x_pWriter, x_writerSize, TRUE);
+		x_pWriter = NULL;
+		x_writerSize = 0;
+	}
+	MUTEX_UNLOCK_ALT(x_writerMutex);
+
+	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+}
+
+openavb_endpoint_status_t *openavbEptStatusSlotOpen(const AVBStreamID_t *streamID)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
+	openavb_endpoint_status_t *pSlot = NULL;
+	U32 i1;
+
+	MUTEX_LOCK_ALT(x_writerMutex);
+	if (x_pWriter && streamID) {
+		openavb_endpoint_status_t *pSlots = STATUS_SLOTS(x_pWriter);
+		for (i1 = 0; i1 < x_pWriter->slotCount; i1++) {
+			if (!pSlots[i1].inUse) {
+				pSlot = &pSlots[i1];
+				x_writeBegin(pSlot);
+				// Everything after the sequence count starts over
+				memset((U8 *)pSlot + sizeof(pSlot->seq), 0, sizeof(*pSlot) - sizeof(pSlot->seq));
+				pSlot->streamID = *streamID;
+				pSlot->inUse = TRUE;
+				x_writeEnd(pSlot);
+				break;
+			}
+		}
+		if (!pSlot) {
+			AVB_LOG_WARNING("Stream status table full");
+		}
+	}
+	MUTEX_UNLOCK_ALT(x_writerMutex);
+
+	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+	return pSlot;
+}
+
+void openavbEptStatusSlotClose(openavb_endpoint_status_t *pSlot)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
+
+	MUTEX_LOCK_ALT(x_writerMutex);
+	if (x_pWriter && pSlot) {
+		x_writeBegin(pSlot);
+		pSlot->inUse = FALSE;
+		x_writeEnd(pSlot);
+	}
+	MUTEX_UNLOCK_ALT(x_writerMutex);
+
+	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+}
+
+void openavbEptStatusBegin(openavb_endpoint_status_t *pSlot)
+{
+	MUTEX_LOCK_ALT(x_writerMutex);
+	if (x_pWriter && pSlot) {
+		x_writeBegin(pSlot);
+	}
+}
+
+void openavbEptStatusEnd(openavb_endpoint_status_t *pSlot)
+{
+	if (x_pWriter && pSlot) {
+		x_writeEnd(pSlot);
+	}
+	MUTEX_UNLOCK_ALT(x_writerMutex);
+}
+
+// Take a consistent copy of a slot in use, if streamID is NULL or matches it.
+static bool x_slotRead(const openavb_endpoint_status_t *pSlot, const AVBStreamID_t *streamID, openavb_endpoint_status_t *pStatus)
+{
+	int tries;
+
+	for (tries = 0; tries < STATUS_READ_TRIES; tries++) {
+		U32 seq = pSlot->seq;
+		__sync_synchronize();
+		if (seq & 1) {
+			continue;
+		}
+
+		bool bMatch = pSlot->inUse && (!streamID || x_streamIdEqual(&pSlot->streamID, streamID));
+		if (bMatch) {
+			memcpy(pStatus, (const void *)pSlot, sizeof(*pStatus));
+		}
+
+		__sync_synchronize();
+		if (pSlot->seq == seq) {
+			return bMatch;
+		}
+	}
+	return FALSE;
+}
+
+static void x_readerUnmap(void)
+{
+	if (x_pReader) {
+		openavbEptStatusUnmapOsal(x_pReader, x_readerSize, FALSE);
+		x_pReader = NULL;
+		x_readerSize = 0;
+	}
+}
+
+// Make sure x_pReader is the table of the running endpoint. Called with the reader mutex held.
+static bool x_readerAttach(void)
+{
+	if (x_pReader) {
+		if (x_pReader->bOpen && openavbEptStatusOwnerAliveOsal()) {
+			return TRUE;
+		}
+		x_readerUnmap();
+	}
+
+	U32 size = 0;
+	status_header_t *pHdr = openavbEptStatusMapOsal(FALSE, &size);
+	if (!pHdr) {
+		return FALSE;
+	}
+
+	if (size < sizeof(status_header_t)
+		|| memcmp(pHdr->magic, STATUS_MAGIC, sizeof(pHdr->magic)) != 0
+		|| pHdr->layout != OPENAVB_ENDPOINT_STATUS_LAYOUT
+		|| pHdr->slotSize != sizeof(openavb_endpoint_status_t)
+		|| pHdr->slotCount > (size - sizeof(status_header_t)) / sizeof(openavb_endpoint_status_t)
+		|| !pHdr->bOpen
+		|| !openavbEptStatusOwnerAliveOsal()) {
+		openavbEptStatusUnmapOsal(pHdr, size, FALSE);
+		return FALSE;
+	}
+
+	x_pReader = pHdr;
+	x_readerSize = size;
+	return TRUE;
+}
+
+bool openavbEptStatusFind(const AVBStreamID_t *streamID, openavb_endpoint_status_t *pStatus)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
+	static const U8 emptyMAC[ETH_ALEN] = { 0, 0, 0, 0, 0, 0 };
+	bool bFound = FALSE;
+	U32 i1;
+
+	if (!streamID || !pStatus) {
+		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+		return FALSE;
+	}
+
+	MUTEX_LOCK_ALT(x_readerMutex);
+	if (x_readerAttach()) {
+		AVBStreamID_t id = *streamID;
+		if (memcmp(id.addr, emptyMAC, ETH_ALEN) == 0) {
+			memcpy(id.addr, x_pReader->ifmac, ETH_ALEN);
+		}
+
+		const openavb_endpoint_status_t *pSlots = STATUS_SLOTS(x_pReader);
+		for (i1 = 0; i1 < x_pReader->slotCount && !bFound; i1++) {
+			bFound = x_slotRead(&pSlots[i1], &id, pStatus);
+		}
+	}
+	MUTEX_UNLOCK_ALT(x_readerMutex);
+
+	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+	return bFound;
+}
+
+U32 openavbEptStatusGetAll(openavb_endpoint_status_t *pStatus, U32 max)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
+	U32 count = 0;
+	U32 i1;
+
+	if (!pStatus) {
+		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+		return 0;
+	}
+
+	MUTEX_LOCK_ALT(x_readerMutex);
+	if (x_readerAttach()) {
+		const openavb_endpoint_status_t *pSlots = STATUS_SLOTS(x_pReader);
+		for (i1 = 0; i1 < x_pReader->slotCount && count < max; i1++) {
+			if (x_slotRead(&pSlots[i1], NULL, &pStatus[count])) {
+				count++;
+			}
+		}
+	}
+	MUTEX_UNLOCK_ALT(x_readerMutex);
+
+	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+	return count;
+}
+
+U32 openavbEptStatusSlotCount(void)
+{
+	U32 count = 0;
+
+	MUTEX_LOCK_ALT(x_readerMutex);
+	if (x_readerAttach()) {
+		count = x_pReader->slotCount;
+	}
+	MUTEX_UNLOCK_ALT(x_readerMutex);
+	return count;
+}
+
+bool openavbEptStatusEndpointVersion(U32 *pVersion)
+{
+	bool bRet = FALSE;
+
+	MUTEX_LOCK_ALT(x_readerMutex);
+	if (pVersion && x_readerAttach()) {
+		*pVersion = x_pReader->avbVersion;
+		bRet = TRUE;
+	}
+	MUTEX_UNLOCK_ALT(x_readerMutex);
+	return bRet;
+}
+
+bool openavbEptStatusIfname(char *pIfname, U32 size)
+{
+	bool bRet = FALSE;
+
+	MUTEX_LOCK_ALT(x_readerMutex);
+	if (pIfname && size > 0 && x_readerAttach()) {
+		strncpy(pIfname, x_pReader->ifname, size - 1);
+		pIfname[size - 1] = '\0';
+		bRet = TRUE;
+	}
+	MUTEX_UNLOCK_ALT(x_readerMutex);
+	return bRet;
+}
+
+void openavbEptStatusDetach(void)
+{
+	MUTEX_LOCK_ALT(x_readerMutex);
+	x_readerUnmap();
+	MUTEX_UNLOCK_ALT(x_readerMutex);
+}
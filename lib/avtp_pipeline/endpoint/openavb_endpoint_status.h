@@ -0,0 +1,146 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Shared memory table of the endpoint's stream status.
+*
+* - The endpoint process creates the table and keeps one slot per stream up to date:
+*   SRP declarations, destination address, class parameters and fwmark.
+* - Any process on the host (talkers, listeners, controllers) can map it read-only and look
+*   at every stream without a round trip to the endpoint.
+* - Each slot is guarded by a sequence count, odd while the endpoint is changing it, so
+*   readers never block the endpoint and retry until they have a consistent copy.
+* - The table also carries the AVB core version and the interface of the endpoint.
+* - Talkers, listeners and AVDECC take the state of their streams from the table. The endpoint
+*   only sends it over the socket for a stream that didn't get a slot.
+*/
+
+#ifndef OPENAVB_ENDPOINT_STATUS_H
+#define OPENAVB_ENDPOINT_STATUS_H 1
+
+#include "openavb_types.h"
+#include "openavb_srp_api.h"
+
+// Shared memory object name of the table. Tests use their own so they leave a running endpoint alone.
+#ifndef OPENAVB_ENDPOINT_STATUS_NAME
+#define OPENAVB_ENDPOINT_STATUS_NAME		"/avb_endpoint_status"
+#endif
+
+// Bumped whenever the layout of the table changes
+#define OPENAVB_ENDPOINT_STATUS_LAYOUT		3
+
+typedef struct {
+	// Incremented before and after the slot changes. Odd while it is being changed.
+	volatile U32 seq;
+	// Slot holds a stream
+	U32 inUse;
+	// Times the slot has changed since the stream was added
+	U32 updates;
+
+	AVBStreamID_t streamID;
+	// clientRole_t of the client that declared the stream
+	U8 role;
+	U8 destAddr[ETH_ALEN];
+	// Destination address was allocated by MAAP
+	U8 bMaap;
+	// Stream is shaped
+	U8 bShaped;
+	U8 srClass;
+	U8 srRank;
+	U8 priority;
+	U16 vlanID;
+	U32 classRate;
+	AVBTSpec_t tSpec;
+	// Talker internal latency, or the accumulated latency reported to a listener
+	U32 latency;
+	U32 fwmark;
+
+	// Last listener declaration seen by a talker. Ready means somebody is listening.
+	U8 lsnrDecl;
+	// Last talker declaration seen by a listener
+	U8 tlkrDecl;
+	openavbSrpFailInfo_t failInfo;
+} openavb_endpoint_status_t;
+
+// Endpoint side
+
+// Create the table with room for maxStreams streams, replacing any left by an earlier endpoint.
+// ifname and ifmac are the interface the endpoint runs on.
+bool openavbEptStatusCreate(U32 maxStreams, const char *ifname, const U8 ifmac[ETH_ALEN]);
+
+// Remove the table. Processes that still have it mapped see it closed.
+void openavbEptStatusDestroy(void);
+
+// Hand out a free slot for a stream. Returns NULL if the table is not open or is full.
+openavb_endpoint_status_t *openavbEptStatusSlotOpen(const AVBStreamID_t *streamID);
+
+// Release a slot. NULL is ignored.
+void openavbEptStatusSlotClose(openavb_endpoint_status_t *pSlot);
+
+// Bracket every change to a slot. Changes from different threads are serialized.
+void openavbEptStatusBegin(openavb_endpoint_status_t *pSlot);
+void openavbEptStatusEnd(openavb_endpoint_status_t *pSlot);
+
+// Reader side. The table is mapped on first use and again after the endpoint restarts.
+
+// Copy the status of a stream. Returns FALSE if there is no table or the stream is not in it.
+// A stream ID without a MAC address is taken to be on the endpoint interface, as the endpoint does.
+bool openavbEptStatusFind(const AVBStreamID_t *streamID, openavb_endpoint_status_t *pStatus);
+
+// Copy the status of up to max streams. Returns the number copied.
+U32 openavbEptStatusGetAll(openavb_endpoint_status_t *pStatus, U32 max);
+
+// Number of slots in the table, 0 if there is none.
+U32 openavbEptStatusSlotCount(void);
+
+// AVB core version of the running endpoint. Returns FALSE if there is no table.
+bool openavbEptStatusEndpointVersion(U32 *pVersion);
+
+// Interface name of the running endpoint. Returns FALSE if there is no table.
+bool openavbEptStatusIfname(char *pIfname, U32 size);
+
+// Unmap the table.
+void openavbEptStatusDetach(void);
+
+// OSAL functions
+
+// Map the shared memory object. With bCreate it is created with *pSize bytes, mapped writable and
+// locked as owned by this process until it is unmapped. Otherwise it is mapped read-only and *pSize
+// is set to its size. Returns NULL on failure.
+void *openavbEptStatusMapOsal(bool bCreate, U32 *pSize);
+
+// Unmap the object. bRemove is set for the table mapped with bCreate, which is also removed.
+void openavbEptStatusUnmapOsal(void *pMap, U32 size, bool bRemove);
+
+// Whether the process that created the table mapped for reading still owns it.
+bool openavbEptStatusOwnerAliveOsal(void);
+
+#endif // OPENAVB_ENDPOINT_STATUS_H
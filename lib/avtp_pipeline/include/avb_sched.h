@@ -33,20 +33,20 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #define AVB_SCHED_H
 
 // Macros to map stream/class into 16-bit fwmark
-// Bottom 8 bits are used for stream index (allows 32 streams/class)
-// Upper  8 bits are used for class index
+// Bottom 12 bits are used for stream index (allows 4096 streams/class)
+// Upper   4 bits are used for class index
 //
 // The fwmark is attached to the socket, and the kernel uses it to
 // steer AVTP frames into the correct queues.
 //
-// If we ever want more than 256 classes (won't happen) or 256 streams
-// per class (very unlikely) we'll need to shift the boundary between
-// the bits used for the class idex and those used for stream idx.
+// If we ever want more than 14 classes (won't happen) or 4096 streams
+// per class we'll need to shift the boundary between the bits used
+// for the class idex and those used for stream idx.
 //
 // If the combination of the two needs more than 16 bits, we'll have
 // to use something other than the FWMARK to communicate with the kernel.
 //
-#define TC_AVB_CLASS_SHIFT		8
+#define TC_AVB_CLASS_SHIFT		12
 #define TC_AVB_STREAM_MASK 		((1 << TC_AVB_CLASS_SHIFT) - 1)
 #define TC_AVB_MARK_CLASS(M) 	(((M) >> TC_AVB_CLASS_SHIFT) - 1)
 #define TC_AVB_MARK_STREAM(M) 	((M)  & TC_AVB_STREAM_MASK)
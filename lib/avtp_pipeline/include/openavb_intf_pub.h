@@ -188,6 +188,54 @@ typedef void (*openavb_intf_set_stream_uid_t)(media_q_t *pMediaQ, U16 stream_uid
  */
 typedef void (*openavb_intf_enable_fixed_timestamp)(media_q_t *pMediaQ, bool enable, U32 transmitInterval, U32 batchFactor);
 
+/** Get the number of xruns seen by the interface.
+ *
+ * Reports how often the media source overran (talker) or the media sink
+ * underran (listener) since the stream was started. The value is available
+ * through openavbTLStat() as TL_STAT_INTF_XRUNS.
+ * \param pMediaQ A pointer to the media queue for this stream
+ * \return Number of xruns.
+ *
+ * \note This callback is optional, does not need to be implemented in the
+ * interface module.
+ */
+typedef U32 (*openavb_intf_get_xruns_t)(media_q_t *pMediaQ);
+
+/** Latency distribution reported by an interface module.
+ *
+ * All values are in nanoseconds. Percentiles come from a log bucketed
+ * histogram and are accurate to a few percent.
+ */
+typedef struct {
+	/// Number of measurements
+	U64 count;
+	/// Smallest measurement
+	S64 minNS;
+	/// Mean of all measurements
+	S64 meanNS;
+	/// Median
+	S64 p50NS;
+	/// 99th percentile
+	S64 p99NS;
+	/// 99.9th percentile
+	S64 p999NS;
+	/// Largest measurement
+	S64 maxNS;
+} openavb_intf_latency_t;
+
+/** Get the latency distribution measured by the interface.
+ *
+ * \param pMediaQ A pointer to the media queue for this stream
+ * \param interval If true report the last completed measurement interval,
+ *        otherwise everything since the stream was started
+ * \param pLatency Filled in with the distribution
+ * \return TRUE if the interface is measuring latency, otherwise FALSE.
+ *
+ * \note This callback is optional, does not need to be implemented in the
+ * interface module.
+ */
+typedef bool (*openavb_intf_get_latency_t)(media_q_t *pMediaQ, bool interval, openavb_intf_latency_t *pLatency);
+
 /** Interface callbacks structure.
  */
 typedef struct {
@@ -217,6 +265,10 @@ typedef struct {
 	openavb_intf_set_stream_uid_t  intf_set_stream_uid_cb;
 	/// Enable fixed timestamp callback
 	openavb_intf_enable_fixed_timestamp intf_enable_fixed_timestamp;
+	/// Xrun count callback
+	openavb_intf_get_xruns_t		intf_get_xruns_cb;
+	/// Latency distribution callback
+	openavb_intf_get_latency_t	intf_get_latency_cb;
 } openavb_intf_cb_t;
 
 /** Main initialization entry point into the interface module.
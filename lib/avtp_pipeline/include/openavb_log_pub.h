@@ -138,6 +138,14 @@ static const bool OPENAVB_LOG_PULL_MODE = FALSE;
 #define LOG_QUEUE_MSG_CNT		82
 #define LOG_QUEUE_SLEEP_MSEC	100
 
+// When using the OPENAVB_LOG_FROM_THREAD option messages are captured as binary records (format pointer,
+// argument values and a timestamp) in a lock-free ring per thread and formatted by the logging thread.
+// Messages with conversions that can't be captured (%n, '*' width, positional arguments) use the msg queue.
+#define LOG_BIN_RING_SIZE		65536		// Bytes per logging thread. Must be a power of 2
+#define LOG_BIN_MAX_ARGS		16
+#define LOG_BIN_MAX_STR_LEN		(LOG_MSG_LEN - 1)	// %s arguments are copied up to this length, as much as a message can hold
+#define LOG_BIN_RT_ITEM_CNT		32			// Max items in one RT log chain
+
 // RT (RealTime logging) related defines
 #define LOG_RT_QUEUE_CNT		128
 #define LOG_RT_BEGIN			TRUE
@@ -208,7 +216,7 @@ void avbLogBuffer(
 #define avbLogFn2(level, tag, company, component, path, line, fmt, ...) \
     {\
         if (level <= AVB_LOG_LEVEL) \
-            avbLogFn(0, tag, company, component, path, line, fmt, __VA_ARGS__); \
+            avbLogFn(level, tag, company, component, path, line, fmt, __VA_ARGS__); \
     }
 
 #define avbLogRT2(level, bBegin, bItem, bEnd, pFormat, dataType, pVar) \
@@ -269,6 +277,10 @@ void avbLogBuffer(
 #define AVB_LOG_BUFFER(LEVEL, DATA, DATALEN, LINELINE)
 #endif	// AVB_LOG_ON
 
+// Number of errors the calling thread has logged. Tells a caller whether a callback that
+// returns nothing, such as a module cfg callback, rejected its input.
+U32 avbLogErrorCount(void);
+
 // Get a queued log message. Intended to be used with the OPENAVB_LOG_PULL_MODE option.
 // Message will not be null terminated.
 U32 avbLogGetMsg(U8 *pBuf, U32 bufSize);
@@ -47,7 +47,8 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include <stdio.h>
 #include "openavb_types_pub.h"
 
-// Uncomment AVB_TRACE_ON to enable tracing.
+// Uncomment AVB_TRACE_ON to enable tracing. Not needed for AVB_TRACE_MODE_RING which is
+// always compiled in and switched on at runtime.
 //#define AVB_TRACE_ON				1
 
 // Specific reporting modes
@@ -58,9 +59,21 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #define AVB_TRACE_MODE_DELTA_STATS	4
 #define AVB_TRACE_MODE_FUNC_TIME	5
 #define AVB_TRACE_MODE_DOC			6
+#define AVB_TRACE_MODE_RING			7
 
 // One of the above reporting modes must be set here
-#define AVB_TRACE_MODE 				AVB_TRACE_MODE_NORMAL
+#define AVB_TRACE_MODE 				AVB_TRACE_MODE_RING
+
+// AVB_TRACE_MODE_RING records entry / exit events with a raw timestamp into a ring per thread
+// and writes them as a Chrome trace (JSON) file that can be loaded in chrome://tracing or Perfetto.
+// When tracing is off each trace point costs a single test of avbTraceGen. Features are selected
+// at runtime by name, i.e. "TL,INTF,MAP_DETAIL" or "ALL", so the 0 / 1 feature values below only
+// apply to the other modes.
+//   OPENAVB_TRACE environment variable: feature list to start tracing with.
+//   OPENAVB_TRACE_FILE environment variable: trace file name. Default AVB_TRACE_RING_FILE.
+//   SIGUSR2: toggle tracing. Turning it off writes the trace file.
+#define AVB_TRACE_RING_EVENTS		32768		// Events kept per thread. Must be a power of 2
+#define AVB_TRACE_RING_FILE			"/tmp/openavb_trace.json"
 
 // Delta Stats Interval 
 #define AVB_TRACE_OPT_DELTA_STATS_INTERVAL		80000
@@ -97,7 +110,58 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #endif
 
 
-#if !defined(AVB_TRACE_ON) || (AVB_TRACE_MODE == AVB_TRACE_MODE_NONE)
+// Trace point of AVB_TRACE_MODE_RING. Resolved against the enabled features once per avbTraceGen.
+typedef struct {
+	const char *pFeature;
+	const char *pFunction;
+	const char *pFile;
+	int line;
+	volatile U32 gen;
+	volatile bool bEnabled;
+} avb_trace_site_t;
+
+typedef enum {
+	AVB_TRACE_RING_ENTRY,
+	AVB_TRACE_RING_EXIT,
+	AVB_TRACE_RING_LINE,
+	AVB_TRACE_RING_LOOP_ENTRY,
+	AVB_TRACE_RING_LOOP_EXIT,
+} avb_trace_ring_type_t;
+
+// Zero when tracing is off, otherwise the generation of the enabled feature list.
+extern volatile U32 avbTraceGen;
+
+void avbTraceInit(void);
+void avbTraceExit(void);
+
+// Comma separated feature names with or without the AVB_TRACE_ prefix, "ALL" for everything.
+// NULL or an empty list turns tracing off.
+void avbTraceSetFeatures(const char *pFeatures);
+
+// Switch tracing on or off. Safe to call from a signal handler. The trace file is written by
+// avbTraceService() after tracing is switched off.
+void avbTraceToggle(void);
+
+// Write the events recorded since the last dump. Called periodically from the logging thread.
+void avbTraceService(void);
+bool avbTraceDump(const char *pFileName);
+
+void avbTraceRingFn(avb_trace_site_t *pSite, avb_trace_ring_type_t type);
+
+#define AVB_TRACE_RING_POINT(FEATURE_NAME, TYPE) \
+	do { \
+		static avb_trace_site_t traceSite = { FEATURE_NAME, __FUNCTION__, TRACE_FILE_NAME, __LINE__, 0, FALSE }; \
+		if (avbTraceGen) \
+			avbTraceRingFn(&traceSite, TYPE); \
+	} while (0)
+
+#if (AVB_TRACE_MODE == AVB_TRACE_MODE_RING)
+#define AVB_TRACE_LINE(FEATURE)			AVB_TRACE_RING_POINT(#FEATURE, AVB_TRACE_RING_LINE)
+#define AVB_TRACE_ENTRY(FEATURE)		AVB_TRACE_RING_POINT(#FEATURE, AVB_TRACE_RING_ENTRY)
+#define AVB_TRACE_EXIT(FEATURE)			AVB_TRACE_RING_POINT(#FEATURE, AVB_TRACE_RING_EXIT)
+#define AVB_TRACE_LOOP_ENTRY(FEATURE)	AVB_TRACE_RING_POINT(#FEATURE, AVB_TRACE_RING_LOOP_ENTRY)
+#define AVB_TRACE_LOOP_EXIT(FEATURE)	AVB_TRACE_RING_POINT(#FEATURE, AVB_TRACE_RING_LOOP_EXIT)
+#elif !defined(AVB_TRACE_ON) || (AVB_TRACE_MODE == AVB_TRACE_MODE_NONE)
 #define AVB_TRACE_LINE(FEATURE)
 #define AVB_TRACE_ENTRY(FEATURE)
 #define AVB_TRACE_EXIT(FEATURE)
@@ -141,7 +205,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #define AVB_TRACE_LOOP_EXIT(FEATURE)
 #endif
 
-#ifdef AVB_TRACE_ON
+#if defined(AVB_TRACE_ON) && (AVB_TRACE_MODE != AVB_TRACE_MODE_RING)
 
 static inline void avbTraceMinimalFn(int featureOn, const char *tag, const char *function, const char *file, int line)
 {
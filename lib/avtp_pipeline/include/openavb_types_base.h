@@ -53,10 +53,11 @@ typedef struct { // per IEEE 802.1Q-2011 Section 35.2.2.8.4
 // All of the above
 #define OPENAVB_AVTP_ETHER_FRAME_OVERHEAD (OPENAVB_AVTP_L1_OVERHEAD + OPENAVB_AVTP_L2_OVERHEAD)
 
-// Maximum number of streams per class
-// (Fixed number for efficiency in FQTSS kernel module)
+// Default number of streams per class
 #define MAX_AVB_STREAMS_PER_CLASS 16
-// Maximum number of streams that we handle
+// Default number of streams that we handle
+// (The endpoint max_streams setting overrides this at runtime, and the
+// stream tables are sized from it rather than from this constant.)
 #define MAX_AVB_STREAMS (MAX_AVB_SR_CLASSES * MAX_AVB_STREAMS_PER_CLASS)
 
 #define SR_CLASS_IS_VALID(C) (C>=0 && C<MAX_AVB_SR_CLASSES)
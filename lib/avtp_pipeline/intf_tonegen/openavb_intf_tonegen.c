@@ -34,6 +34,8 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 * 
 * - This interface module generates and audio tone for use with -6 and AAF mappings
 * - Requires an OSAL sin implementation of reasonable performance. 
+* - Every tone in use is rendered once at talker start into a wavetable holding
+*   one exact period of encoded frames, so filling an item is a block copy.
 */
 
 #include <stdlib.h>
@@ -55,6 +57,25 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 #define PI 3.14159265358979f
 
+// Distinct tones held as wavetables. Enough for the 14 melody notes and silence.
+#define TONEGEN_MAX_TONES				16
+
+// Largest wavetable of whole frames per tone. Longer periods replicate each sample across the channels instead.
+#define TONEGEN_FRAME_TABLE_MAX_BYTES	(4 * 1024 * 1024)
+
+typedef struct {
+	U32 freq;
+
+	// Number of frames until the tone repeats exactly
+	U32 period;
+
+	// One period of samples in the output encoding
+	U8 *pSamples;
+
+	// One period of whole frames including fixed value channels, or NULL if too large
+	U8 *pFrames;
+} tonegen_table_t;
+
 typedef struct {
 	/////////////
 	// Config data
@@ -107,9 +128,6 @@ typedef struct {
 	// Keeps track of how long before toggling the tone on / off
 	U32 freqCountdown;
 
-	// Ratio precalc
-	float ratio;
-
 	// Index to into the melody string
 	U32 melodyIdx;
 
@@ -118,6 +136,24 @@ typedef struct {
 
 	U32 fvChannels;
 
+	// Wavetables for every tone the talker can play
+	tonegen_table_t tables[TONEGEN_MAX_TONES];
+	U32 tableCount;
+
+	// Table of the current tone and the next frame within its period
+	tonegen_table_t *pTable;
+	U32 tableIdx;
+
+	// Frames sent modulo the audio rate. Tones restart in phase with this count.
+	U32 frameIdx;
+
+	// Bytes per encoded sample, zero for unsupported formats
+	U32 sampleBytes;
+
+	// Bytes per frame and the encoded fixed value channels at the end of each frame
+	U32 frameBytes;
+	U8 fvBytes[8];
+
 	// Media clock synthesis for precise timestamps
 	mcs_t mcs;
 
@@ -360,6 +396,210 @@ void openavbIntfToneGenGenInitCB(media_q_t *pMediaQ)
 	AVB_TRACE_EXIT(AVB_TRACE_INTF);
 }
 
+static U16 convertToDesiredEndianOrder16(U16 hostData, avb_audio_endian_t audioEndian);
+static U32 convertToDesiredEndianOrder32(U32 hostData, avb_audio_endian_t audioEndian);
+
+static U32 xGcd(U32 a, U32 b)
+{
+	while (b) {
+		U32 t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+// Encode one sample the way the tone has always been scaled for each format.
+static void xEncodeSample(pvt_data_t *pPvtData, float value, U8 *pData)
+{
+	if (pPvtData->audioType == AVB_AUDIO_TYPE_INT) {
+		if (pPvtData->audioBitDepth == 32) {
+			S32 sample32 = (S32)(value * (32000 << 16));
+			S32 tmp32 = convertToDesiredEndianOrder32(sample32, pPvtData->audioEndian);
+			memcpy(pData, (U8 *)&tmp32, 4);
+		} else if (pPvtData->audioBitDepth == 24) {
+			S32 sample24 = (S32)(value * (32000 << 16));
+			S32 tmp24 = convertToDesiredEndianOrder32(sample24, pPvtData->audioEndian);
+			if (pPvtData->audioEndian == AVB_AUDIO_ENDIAN_BIG) {
+				memcpy(pData, (U8 *)&tmp24, 3);
+			} else {
+				memcpy(pData, ((U8 *)&tmp24) + 1, 3);
+			}
+		} else if (pPvtData->audioBitDepth == 16) {
+			S16 sample16 = (S32)(value * 32000);
+			S16 tmp16 = convertToDesiredEndianOrder16(sample16, pPvtData->audioEndian);
+			memcpy(pData, (U8 *)&tmp16, 2);
+		}
+	} else if (pPvtData->audioType == AVB_AUDIO_TYPE_FLOAT) {
+		U32 tmp32f;
+		memcpy((U8 *)&tmp32f, (U8 *)&value, 4);  // done so no warning with -Wstrict-aliasing
+		tmp32f = convertToDesiredEndianOrder32(tmp32f, pPvtData->audioEndian);
+		memcpy(pData, (U8 *)&tmp32f, 4);
+	}
+}
+
+static U32 xSampleBytes(pvt_data_t *pPvtData)
+{
+	if (pPvtData->audioType == AVB_AUDIO_TYPE_INT) {
+		if (pPvtData->audioBitDepth == 32 || pPvtData->audioBitDepth == 24 || pPvtData->audioBitDepth == 16) {
+			return pPvtData->audioBitDepth / 8;
+		}
+	} else if (pPvtData->audioType == AVB_AUDIO_TYPE_FLOAT && pPvtData->audioBitDepth == 32) {
+		return 4;
+	}
+	return 0;
+}
+
+// Write count copies of one encoded sample followed by the fixed value channels. Any
+// padding at the end of the item frame, as with the AAF non wire item formats, is zeroed.
+static void xReplicateFrame(pvt_data_t *pPvtData, const U8 *pSample, U32 count, U8 *pData)
+{
+	U32 toneLen = count * pPvtData->sampleBytes;
+	U32 fvLen = pPvtData->fvChannels * pPvtData->sampleBytes;
+	U32 ch;
+	switch (pPvtData->sampleBytes) {
+		case 4: {
+			U32 v;
+			memcpy(&v, pSample, 4);
+			for (ch = 0; ch < count; ch++) {
+				memcpy(pData + ch * 4, &v, 4);
+			}
+			break;
+		}
+		case 3:
+			for (ch = 0; ch < count; ch++) {
+				pData[ch * 3] = pSample[0];
+				pData[ch * 3 + 1] = pSample[1];
+				pData[ch * 3 + 2] = pSample[2];
+			}
+			break;
+		case 2: {
+			U16 v;
+			memcpy(&v, pSample, 2);
+			for (ch = 0; ch < count; ch++) {
+				memcpy(pData + ch * 2, &v, 2);
+			}
+			break;
+		}
+	}
+	memcpy(pData + toneLen, pPvtData->fvBytes, fvLen);
+	memset(pData + toneLen + fvLen, 0, pPvtData->frameBytes - toneLen - fvLen);
+}
+
+static tonegen_table_t *xFindTable(pvt_data_t *pPvtData, U32 freq)
+{
+	U32 i;
+	for (i = 0; i < pPvtData->tableCount; i++) {
+		if (pPvtData->tables[i].freq == freq) {
+			return &pPvtData->tables[i];
+		}
+	}
+	return NULL;
+}
+
+// Render one period of a tone. With integer tone and sample rates the tone repeats
+// exactly after audioRate / gcd(audioRate, freq) frames.
+static void xAddTable(pvt_data_t *pPvtData, U32 freq, U32 audioRate, U32 toneChannels)
+{
+	if (xFindTable(pPvtData, freq)) {
+		return;
+	}
+	if (pPvtData->tableCount >= TONEGEN_MAX_TONES) {
+		AVB_LOGF_ERROR("Too many distinct tones, %u Hz not available", freq);
+		return;
+	}
+
+	tonegen_table_t *pTable = &pPvtData->tables[pPvtData->tableCount];
+	U32 period = freq ? audioRate / xGcd(audioRate, freq) : 1;
+	U32 sampleBytes = pPvtData->sampleBytes ? pPvtData->sampleBytes : 1;
+	U32 idx;
+
+	pTable->pSamples = calloc(period, sampleBytes);
+	if (!pTable->pSamples) {
+		AVB_LOGF_ERROR("Unable to allocate wavetable for %u Hz", freq);
+		return;
+	}
+	pTable->freq = freq;
+	pTable->period = period;
+	pPvtData->tableCount++;
+
+	if (pPvtData->sampleBytes) {
+		for (idx = 0; idx < period; idx++) {
+			float value = SIN(2.0 * M_PI * ((U64)idx * freq % audioRate) / audioRate) * pPvtData->volume;
+			xEncodeSample(pPvtData, value, pTable->pSamples + idx * sampleBytes);
+		}
+	}
+
+	if ((U64)period * pPvtData->frameBytes <= TONEGEN_FRAME_TABLE_MAX_BYTES) {
+		pTable->pFrames = malloc(period * pPvtData->frameBytes);
+		if (pTable->pFrames) {
+			for (idx = 0; idx < period; idx++) {
+				xReplicateFrame(pPvtData, pTable->pSamples + idx * sampleBytes, toneChannels, pTable->pFrames + idx * pPvtData->frameBytes);
+			}
+		}
+	}
+}
+
+static void xFreeTables(pvt_data_t *pPvtData)
+{
+	U32 i;
+	for (i = 0; i < pPvtData->tableCount; i++) {
+		free(pPvtData->tables[i].pSamples);
+		free(pPvtData->tables[i].pFrames);
+	}
+	memset(pPvtData->tables, 0, sizeof(pPvtData->tables));
+	pPvtData->tableCount = 0;
+	pPvtData->pTable = NULL;
+}
+
+static void xSelectTone(pvt_data_t *pPvtData, U32 freq)
+{
+	tonegen_table_t *pTable = xFindTable(pPvtData, freq);
+	if (!pTable) {
+		pTable = xFindTable(pPvtData, 0);
+	}
+	if (pTable != pPvtData->pTable) {
+		pPvtData->pTable = pTable;
+		pPvtData->tableIdx = pTable ? pPvtData->frameIdx % pTable->period : 0;
+	}
+}
+
+// Copy frameCnt frames of the current tone to pData.
+static void xFillFrames(pvt_data_t *pPvtData, U8 *pData, U32 frameCnt, U32 toneChannels)
+{
+	tonegen_table_t *pTable = pPvtData->pTable;
+
+	if (!pTable) {
+		memset(pData, 0, frameCnt * pPvtData->frameBytes);
+		return;
+	}
+
+	while (frameCnt) {
+		U32 run = pTable->period - pPvtData->tableIdx;
+		if (run > frameCnt) {
+			run = frameCnt;
+		}
+
+		if (pTable->pFrames) {
+			memcpy(pData, pTable->pFrames + pPvtData->tableIdx * pPvtData->frameBytes, run * pPvtData->frameBytes);
+		}
+		else {
+			U32 i;
+			for (i = 0; i < run; i++) {
+				xReplicateFrame(pPvtData, pTable->pSamples + (pPvtData->tableIdx + i) * pPvtData->sampleBytes,
+					toneChannels, pData + i * pPvtData->frameBytes);
+			}
+		}
+
+		pData += run * pPvtData->frameBytes;
+		frameCnt -= run;
+		pPvtData->tableIdx += run;
+		if (pPvtData->tableIdx >= pTable->period) {
+			pPvtData->tableIdx = 0;
+		}
+	}
+}
+
 // A call to this callback indicates that this interface module will be
 // a talker. Any talker initialization can be done in this function.
 void openavbIntfToneGenTxInitCB(media_q_t *pMediaQ) 
@@ -393,6 +633,51 @@ void openavbIntfToneGenTxInitCB(media_q_t *pMediaQ)
 		}
 		
 		pPvtData->melodyIdx = 0;
+
+		// Frame layout
+		U32 toneChannels = pPubMapUncmpAudioInfo->audioChannels - pPvtData->fvChannels;
+		pPvtData->sampleBytes = xSampleBytes(pPvtData);
+		pPvtData->frameBytes = pPubMapUncmpAudioInfo->itemFrameSizeBytes;
+		memset(pPvtData->fvBytes, 0, sizeof(pPvtData->fvBytes));
+		if (!pPvtData->sampleBytes) {
+			AVB_LOG_ERROR("Audio sample size format not implemented yet for tone generator interface module");
+		}
+		else if (pPvtData->audioType == AVB_AUDIO_TYPE_INT && pPvtData->audioBitDepth == 32) {
+			U8 *pFv = pPvtData->fvBytes;
+			if (pPvtData->fv1Enabled) {
+				S32 tmp32 = convertToDesiredEndianOrder32(pPvtData->fv1, pPvtData->audioEndian);
+				memcpy(pFv, (U8 *)&tmp32, 4);
+				pFv += 4;
+			}
+			if (pPvtData->fv2Enabled) {
+				S32 tmp32 = convertToDesiredEndianOrder32(pPvtData->fv2, pPvtData->audioEndian);
+				memcpy(pFv, (U8 *)&tmp32, 4);
+			}
+		}
+		if (pPvtData->frameBytes < toneChannels * pPvtData->sampleBytes + pPvtData->fvChannels * pPvtData->sampleBytes
+			|| pPvtData->fvChannels * pPvtData->sampleBytes > sizeof(pPvtData->fvBytes)) {
+			AVB_LOG_ERROR("Media queue frame size does not match the tone generator format");
+			pPvtData->sampleBytes = 0;
+		}
+
+		// Render every tone the talker can play.
+		xFreeTables(pPvtData);
+		xAddTable(pPvtData, 0, pPubMapUncmpAudioInfo->audioRate, toneChannels);
+		if (pPvtData->pMelodyString) {
+			U32 idx;
+			for (idx = 0; idx < pPvtData->melodyLen; idx += 2) {
+				U32 freq, intervalMSec;
+				xGetMelodyToneAndDuration(pPvtData->pMelodyString[idx], pPvtData->pMelodyString[idx + 1], &freq, &intervalMSec);
+				xAddTable(pPvtData, freq, pPubMapUncmpAudioInfo->audioRate, toneChannels);
+			}
+		}
+		else {
+			xAddTable(pPvtData, pPvtData->toneHz, pPubMapUncmpAudioInfo->audioRate, toneChannels);
+		}
+		pPvtData->frameIdx = 0;
+		xSelectTone(pPvtData, 0);
+
+		AVB_LOGF_INFO("Tone generator: %u wavetables, %u channels, %u byte frames", pPvtData->tableCount, toneChannels, pPvtData->frameBytes);
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_INTF);
@@ -476,14 +761,17 @@ bool openavbIntfToneGenTxCB(media_q_t *pMediaQ)
 				AVB_LOG_ERROR("Media queue item not large enough for samples");
 			}
 
-			// Tone on
-			static U32 runningFrameCnt = 0;
-			U32 frameCnt;
-			U32 channelCnt;
+			U32 toneChannels = pPubMapUncmpAudioInfo->audioChannels - pPvtData->fvChannels;
+			U32 framesLeft = pPubMapUncmpAudioInfo->framesPerItem;
 			U8 *pData = pMediaQItem->pPubData;
 
-			for (frameCnt = 0; frameCnt < pPubMapUncmpAudioInfo->framesPerItem; frameCnt++) {
+			if (!pPvtData->sampleBytes) {
+				memset(pData, 0, pPubMapUncmpAudioInfo->itemSize);
+				framesLeft = 0;
+			}
 
+			// Fill the item in runs that each play a single tone.
+			while (framesLeft) {
 				// Check for tone on / off toggle
 				if (!pPvtData->freqCountdown) {
 					if (pPvtData->pMelodyString) {
@@ -514,64 +802,18 @@ bool openavbIntfToneGenTxCB(media_q_t *pMediaQ)
 							pPvtData->freq = pPvtData->toneHz;
 						}
 					}
-					pPvtData->ratio = (float)pPvtData->freq / (float)pPubMapUncmpAudioInfo->audioRate;
-				}
-				pPvtData->freqCountdown--;
-
-				float value = SIN(2 * PI * (runningFrameCnt++ % pPubMapUncmpAudioInfo->audioRate) * pPvtData->ratio) * pPvtData->volume;
-
-				for (channelCnt = 0; channelCnt < pPubMapUncmpAudioInfo->audioChannels - pPvtData->fvChannels; channelCnt++) {
-					if (pPvtData->audioType == AVB_AUDIO_TYPE_INT) {
-						if (pPvtData->audioBitDepth == 32) {
-							S32 sample32 = (S32)(value * (32000 << 16));
-							S32 tmp32 = convertToDesiredEndianOrder32(sample32, pPvtData->audioEndian);
-							memcpy(pData, (U8 *)&tmp32, 4);
-							pData += 4;
-						} else if (pPvtData->audioBitDepth == 24) {
-							S32 sample24 = (S32)(value * (32000 << 16));
-							S32 tmp24 = convertToDesiredEndianOrder32(sample24, pPvtData->audioEndian);
-							if (pPvtData->audioEndian == AVB_AUDIO_ENDIAN_BIG) {
-								memcpy(pData, (U8 *)&tmp24, 3);
-							} else {
-								memcpy(pData, ((U8 *)&tmp24) + 1, 3);
-							}
-							pData += 3;
-						} else if (pPvtData->audioBitDepth == 16) {
-							S16 sample16 = (S32)(value * 32000);
-							S16 tmp16 = convertToDesiredEndianOrder16(sample16, pPvtData->audioEndian);
-							memcpy(pData, (U8 *)&tmp16, 2);
-							pData += 2;
-						}
-					} else if (pPvtData->audioType == AVB_AUDIO_TYPE_FLOAT) {
-						U32 tmp32f;
-						// value *= .75; // attenuate value
-						memcpy((U8 *)&tmp32f, (U8 *)&value, 4);  // done so no warning with -Wstrict-aliasing
-						tmp32f = convertToDesiredEndianOrder32(tmp32f, pPvtData->audioEndian);
-						memcpy(pData, (U8 *)&tmp32f, 4);
-						pData += 4;
-					} else {
-						// CORE_TODO
-						AVB_LOG_ERROR("Audio sample size format not implemented yet for tone generator interface module");
+					xSelectTone(pPvtData, pPvtData->freq);
+					if (!pPvtData->freqCountdown) {
+						pPvtData->freqCountdown = 1;
 					}
 				}
 
-				if (pPvtData->fvChannels > 0) {
-					if (pPvtData->audioType == AVB_AUDIO_TYPE_INT) {
-						if (pPvtData->audioBitDepth == 32) {
-							if (pPvtData->fv1Enabled) {
-								S32 tmp32 = convertToDesiredEndianOrder32(pPvtData->fv1, pPvtData->audioEndian);
-								memcpy(pData, (U8 *)&tmp32, 4);
-								pData += 4;
-							}
-
-							if (pPvtData->fv2Enabled) {
-								S32 tmp32 = convertToDesiredEndianOrder32(pPvtData->fv2, pPvtData->audioEndian);
-								memcpy(pData, (U8 *)&tmp32, 4);
-								pData += 4;
-							}
-						}
-					}
-				}
+				U32 run = framesLeft < pPvtData->freqCountdown ? framesLeft : pPvtData->freqCountdown;
+				xFillFrames(pPvtData, pData, run, toneChannels);
+				pData += run * pPvtData->frameBytes;
+				framesLeft -= run;
+				pPvtData->freqCountdown -= run;
+				pPvtData->frameIdx = (pPvtData->frameIdx + run) % pPubMapUncmpAudioInfo->audioRate;
 			}
 			
 			pMediaQItem->dataLen = pPubMapUncmpAudioInfo->itemSize;
@@ -619,6 +861,14 @@ bool openavbIntfToneGenRxCB(media_q_t *pMediaQ)
 void openavbIntfToneGenEndCB(media_q_t *pMediaQ) 
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (pPvtData) {
+			xFreeTables(pPvtData);
+		}
+	}
+
 	AVB_TRACE_EXIT(AVB_TRACE_INTF);
 }
 
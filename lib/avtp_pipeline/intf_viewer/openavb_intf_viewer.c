@@ -44,6 +44,8 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_trace_pub.h"
 #include "openavb_mediaq_pub.h"
 #include "openavb_intf_pub.h"
+#include "openavb_osal_pub.h"
+#include "openavb_intf_viewer_hist.h"
 
 #define	AVB_LOG_COMPONENT	"Viewer Interface"
 #include "openavb_log_pub.h" 
@@ -76,6 +78,9 @@ typedef struct {
 	// Ignore timestamp at listener.
 	bool ignoreTimestamp;
 
+	// Log every histogram bucket when the stream stops.
+	bool histDump;
+
 	/////////////
 	// Variable data
 	/////////////
@@ -103,8 +108,45 @@ typedef struct {
 	
 	S32 avgForJitter;
 
+	// Measurements of the current interval. Only touched by the listener thread.
+	viewer_hist_t intervalHist;
+
+	// Completed intervals since the stream was started.
+	viewer_hist_t totalHist;
+
+	// Summary of the last completed interval.
+	openavb_intf_latency_t intervalLatency;
+
+	// Guards totalHist and intervalLatency, which are read by openavbIntfViewerGetLatencyCB().
+	MUTEX_HANDLE_ALT(histMutex);
+
 } pvt_data_t;
 
+static bool x_histMode(viewer_mode_t viewType)
+{
+	return viewType == VIEWER_MODE_LATENCY || viewType == VIEWER_MODE_LATE || viewType == VIEWER_MODE_GAP;
+}
+
+// Finish a measurement interval. Appends the percentiles to the log line the caller
+// started and publishes the interval for openavbIntfViewerGetLatencyCB().
+static void x_histEndInterval(pvt_data_t *pPvtData)
+{
+	openavb_intf_latency_t latency;
+
+	openavbViewerHistSummary(&pPvtData->intervalHist, &latency);
+
+	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "  P50: %lld NS  ", LOG_RT_DATATYPE_S64, &latency.p50NS);
+	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "P99: %lld NS  ", LOG_RT_DATATYPE_S64, &latency.p99NS);
+	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, LOG_RT_END, "P99.9: %lld NS", LOG_RT_DATATYPE_S64, &latency.p999NS);
+
+	MUTEX_LOCK_ALT(pPvtData->histMutex);
+	openavbViewerHistMerge(&pPvtData->totalHist, &pPvtData->intervalHist);
+	pPvtData->intervalLatency = latency;
+	MUTEX_UNLOCK_ALT(pPvtData->histMutex);
+
+	openavbViewerHistReset(&pPvtData->intervalHist);
+}
+
 // Each configuration name value pair for this mapping will result in this callback being called.
 void openavbIntfViewerCfgCB(media_q_t *pMediaQ, const char *name, const char *value) 
 {
@@ -148,6 +190,13 @@ void openavbIntfViewerCfgCB(media_q_t *pMediaQ, const char *name, const char *va
 				pPvtData->ignoreTimestamp = (tmp == 1);
 			}
 		}
+
+		else if (strcmp(name, "intf_nv_hist_dump") == 0) {
+			tmp = strtol(value, &pEnd, 10);
+			if (*pEnd == '\0') {
+				pPvtData->histDump = (tmp == 1);
+			}
+		}
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_INTF);
@@ -186,6 +235,12 @@ void openavbIntfViewerRxInitCB(media_q_t *pMediaQ)
 			AVB_LOG_ERROR("Private interface module data not allocated.");
 			return;
 		}
+
+		openavbViewerHistReset(&pPvtData->intervalHist);
+		MUTEX_LOCK_ALT(pPvtData->histMutex);
+		openavbViewerHistReset(&pPvtData->totalHist);
+		memset(&pPvtData->intervalLatency, 0, sizeof(pPvtData->intervalLatency));
+		MUTEX_UNLOCK_ALT(pPvtData->histMutex);
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_INTF);
@@ -344,6 +399,7 @@ bool openavbIntfViewerRxCB(media_q_t *pMediaQ)
 							pPvtData->maxLateNS = lateNS;
 						}
 						pPvtData->accumLateNS += lateNS;
+						openavbViewerHistRecord(&pPvtData->intervalHist, lateNS);
 						
 						if (pPvtData->avgForJitter != 0) {
 							S32 lateJitter = pPvtData->avgForJitter - lateNS;
@@ -358,7 +414,8 @@ bool openavbIntfViewerRxCB(media_q_t *pMediaQ)
 							AVB_LOGRT_INFO(LOG_RT_BEGIN, LOG_RT_ITEM, FALSE, "Latency: %d NS  ", LOG_RT_DATATYPE_S32, &lateNS);
 							AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "Latency Avg: %d NS  ", LOG_RT_DATATYPE_S32, &lateAvg);
 							AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "Latency Max: %d NS  ", LOG_RT_DATATYPE_S32, &pPvtData->maxLateNS);
-							AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, LOG_RT_END, "Jitter: %d", LOG_RT_DATATYPE_S32, &jitter);
+							AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "Jitter: %d", LOG_RT_DATATYPE_S32, &jitter);
+							x_histEndInterval(pPvtData);
 							
 							pPvtData->accumLateNS = 0;
 							pPvtData->maxLateNS = 0;
@@ -393,6 +450,7 @@ bool openavbIntfViewerRxCB(media_q_t *pMediaQ)
 							pPvtData->maxLateNS = lateNS;
 						}
 						pPvtData->accumLateNS += lateNS;
+						openavbViewerHistRecord(&pPvtData->intervalHist, lateNS);
 						
 						if (pPvtData->avgForJitter != 0) {
 							S32 lateJitter = pPvtData->avgForJitter - lateNS;
@@ -407,7 +465,8 @@ bool openavbIntfViewerRxCB(media_q_t *pMediaQ)
 							AVB_LOGRT_INFO(LOG_RT_BEGIN, LOG_RT_ITEM, FALSE, "Late: %d NS  ", LOG_RT_DATATYPE_S32, &lateNS);
 							AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "Late Avg: %d NS  ", LOG_RT_DATATYPE_S32, &lateAvg);
 							AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "Late Max: %d NS  ", LOG_RT_DATATYPE_S32, &pPvtData->maxLateNS);
-							AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, LOG_RT_END, "Jitter: %d", LOG_RT_DATATYPE_S32, &jitter);
+							AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "Jitter: %d", LOG_RT_DATATYPE_S32, &jitter);
+							x_histEndInterval(pPvtData);
 							
 							pPvtData->accumLateNS = 0;
 							pPvtData->maxLateNS = 0;
@@ -431,6 +490,7 @@ bool openavbIntfViewerRxCB(media_q_t *pMediaQ)
 							pPvtData->maxGapNS = gapNS;
 						}
 						pPvtData->accumGapNS += gapNS;
+						openavbViewerHistRecord(&pPvtData->intervalHist, (S64)gapNS);
 						
 						if (pPvtData->avgForJitter != 0) {
 							S32 gapJitter = pPvtData->avgForJitter - gapNS;
@@ -447,7 +507,8 @@ bool openavbIntfViewerRxCB(media_q_t *pMediaQ)
 						AVB_LOGRT_INFO(LOG_RT_BEGIN, LOG_RT_ITEM, FALSE, "Gap: %d NS  ", LOG_RT_DATATYPE_S32, &gapNS);
 						AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "Gap Avg: %d NS  ", LOG_RT_DATATYPE_S32, &gapAvg);
 						AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "Gap Max: %d NS  ", LOG_RT_DATATYPE_S32, &pPvtData->maxGapNS);
-						AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, LOG_RT_END, "Jitter: %d", LOG_RT_DATATYPE_S32, &jitter);
+						AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "Jitter: %d", LOG_RT_DATATYPE_S32, &jitter);
+						x_histEndInterval(pPvtData);
 					  
 						pPvtData->accumGapNS = 0;
 						pPvtData->maxGapNS = 0;
@@ -473,13 +534,86 @@ bool openavbIntfViewerRxCB(media_q_t *pMediaQ)
 void openavbIntfViewerEndCB(media_q_t *pMediaQ) 
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return;
+		}
+
+		if (x_histMode(pPvtData->viewType)) {
+			openavb_intf_latency_t latency;
+
+			// Include the partial last interval in the totals.
+			MUTEX_LOCK_ALT(pPvtData->histMutex);
+			openavbViewerHistMerge(&pPvtData->totalHist, &pPvtData->intervalHist);
+			openavbViewerHistReset(&pPvtData->intervalHist);
+			openavbViewerHistSummary(&pPvtData->totalHist, &latency);
+			MUTEX_UNLOCK_ALT(pPvtData->histMutex);
+
+			if (latency.count) {
+				AVB_LOGF_INFO("Totals: count:%llu min:%lld mean:%lld P50:%lld P99:%lld P99.9:%lld max:%lld NS",
+					(unsigned long long)latency.count, (long long)latency.minNS, (long long)latency.meanNS,
+					(long long)latency.p50NS, (long long)latency.p99NS, (long long)latency.p999NS, (long long)latency.maxNS);
+				if (pPvtData->histDump) {
+					openavbViewerHistDump(&pPvtData->totalHist, "Totals");
+				}
+			}
+		}
+	}
+
 	AVB_TRACE_EXIT(AVB_TRACE_INTF);
 }
 
 void openavbIntfViewerGenEndCB(media_q_t *pMediaQ) 
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (pPvtData) {
+			MUTEX_DESTROY_ALT(pPvtData->histMutex);
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+}
+
+// Report the measured distribution. Latency and late modes measure how late
+// packets are relative to their presentation time, gap mode the time between packets.
+bool openavbIntfViewerGetLatencyCB(media_q_t *pMediaQ, bool interval, openavb_intf_latency_t *pLatency)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (!pMediaQ || !pLatency) {
+		AVB_TRACE_EXIT(AVB_TRACE_INTF);
+		return FALSE;
+	}
+
+	pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+	if (!pPvtData) {
+		AVB_LOG_ERROR("Private interface module data not allocated.");
+		AVB_TRACE_EXIT(AVB_TRACE_INTF);
+		return FALSE;
+	}
+
+	if (!x_histMode(pPvtData->viewType)) {
+		AVB_TRACE_EXIT(AVB_TRACE_INTF);
+		return FALSE;
+	}
+
+	MUTEX_LOCK_ALT(pPvtData->histMutex);
+	if (interval) {
+		*pLatency = pPvtData->intervalLatency;
+	}
+	else {
+		openavbViewerHistSummary(&pPvtData->totalHist, pLatency);
+	}
+	MUTEX_UNLOCK_ALT(pPvtData->histMutex);
+
 	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+	return TRUE;
 }
 
 // Main initialization entry point into the interface module
@@ -505,6 +639,7 @@ extern DLL_EXPORT bool openavbIntfViewerInitialize(media_q_t *pMediaQ, openavb_i
 		pIntfCB->intf_rx_cb = openavbIntfViewerRxCB;
 		pIntfCB->intf_end_cb = openavbIntfViewerEndCB;
 		pIntfCB->intf_gen_end_cb = openavbIntfViewerGenEndCB;
+		pIntfCB->intf_get_latency_cb = openavbIntfViewerGetLatencyCB;
 
 		pPvtData->viewType = VIEWER_MODE_DETAIL;
 		pPvtData->viewInterval = 1000;
@@ -514,6 +649,8 @@ extern DLL_EXPORT bool openavbIntfViewerInitialize(media_q_t *pMediaQ, openavb_i
 		pPvtData->skipCountdown = 0;
 		pPvtData->jitter = 0.0;
 		pPvtData->avgForJitter = 0;
+		pPvtData->histDump = FALSE;
+		MUTEX_CREATE_ALT(pPvtData->histMutex);
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_INTF);
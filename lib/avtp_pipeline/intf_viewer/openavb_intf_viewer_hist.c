@@ -0,0 +1,218 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Log bucketed histograms for the viewer interface module.
+*
+* Bucket index i below 2^VIEWER_HIST_SUB_BITS holds the value i. Above that a
+* magnitude is shifted right until it has VIEWER_HIST_SUB_BITS significant
+* bits, and the shift count selects the group of buckets the remaining bits
+* index into. Recording is a count leading zeros and a few shifts.
+*/
+
+#include <string.h>
+#include "openavb_types_pub.h"
+#include "openavb_intf_viewer_hist.h"
+
+#define	AVB_LOG_COMPONENT	"Viewer Interface"
+#include "openavb_log_pub.h"
+
+#define VIEWER_HIST_MAX_MAG		((1ULL << VIEWER_HIST_MAX_BITS) - 1)
+
+static U32 x_msb(U64 value)
+{
+#if defined(__GNUC__)
+	return 63 - __builtin_clzll(value);
+#else
+	U32 msb = 0;
+	while (value >>= 1) {
+		msb++;
+	}
+	return msb;
+#endif
+}
+
+static U32 x_bucketIndex(U64 mag)
+{
+	if (mag < (1 << VIEWER_HIST_SUB_BITS)) {
+		return (U32)mag;
+	}
+	if (mag > VIEWER_HIST_MAX_MAG) {
+		mag = VIEWER_HIST_MAX_MAG;
+	}
+	U32 shift = x_msb(mag) - (VIEWER_HIST_SUB_BITS - 1);
+	return (shift << (VIEWER_HIST_SUB_BITS - 1)) + (U32)(mag >> shift);
+}
+
+// Smallest and largest magnitude counted in a bucket.
+static void x_bucketRange(U32 idx, U64 *pLow, U64 *pHigh)
+{
+	if (idx < (1 << VIEWER_HIST_SUB_BITS)) {
+		*pLow = *pHigh = idx;
+		return;
+	}
+	U32 shift = (idx >> (VIEWER_HIST_SUB_BITS - 1)) - 1;
+	U64 mantissa = idx - (shift << (VIEWER_HIST_SUB_BITS - 1));
+	*pLow = mantissa << shift;
+	*pHigh = *pLow + (1ULL << shift) - 1;
+}
+
+void openavbViewerHistReset(viewer_hist_t *pHist)
+{
+	memset(pHist, 0, sizeof(*pHist));
+}
+
+void openavbViewerHistRecord(viewer_hist_t *pHist, S64 value)
+{
+	if (pHist->count == 0 || value < pHist->min) {
+		pHist->min = value;
+	}
+	if (pHist->count == 0 || value > pHist->max) {
+		pHist->max = value;
+	}
+	pHist->count++;
+	pHist->sum += value;
+
+	if (value < 0) {
+		pHist->neg[x_bucketIndex(-(U64)value)]++;
+	}
+	else {
+		pHist->pos[x_bucketIndex((U64)value)]++;
+	}
+}
+
+void openavbViewerHistMerge(viewer_hist_t *pDst, const viewer_hist_t *pSrc)
+{
+	U32 i1;
+
+	if (pSrc->count == 0) {
+		return;
+	}
+	if (pDst->count == 0 || pSrc->min < pDst->min) {
+		pDst->min = pSrc->min;
+	}
+	if (pDst->count == 0 || pSrc->max > pDst->max) {
+		pDst->max = pSrc->max;
+	}
+	pDst->count += pSrc->count;
+	pDst->sum += pSrc->sum;
+
+	for (i1 = 0; i1 < VIEWER_HIST_BUCKETS; i1++) {
+		pDst->neg[i1] += pSrc->neg[i1];
+		pDst->pos[i1] += pSrc->pos[i1];
+	}
+}
+
+S64 openavbViewerHistPercentile(const viewer_hist_t *pHist, U32 ppm)
+{
+	U64 low, high;
+	U64 seen = 0;
+	U64 rank;
+	S64 value = 0;
+	S32 i1;
+
+	if (pHist->count == 0) {
+		return 0;
+	}
+	if (ppm >= 1000000) {
+		return pHist->max;
+	}
+
+	rank = (pHist->count * ppm + 999999) / 1000000;
+	if (rank == 0) {
+		rank = 1;
+	}
+
+	// Most negative values first, so walk the negative buckets downwards.
+	for (i1 = VIEWER_HIST_BUCKETS - 1; i1 >= 0; i1--) {
+		seen += pHist->neg[i1];
+		if (seen >= rank) {
+			x_bucketRange(i1, &low, &high);
+			value = -(S64)low;
+			break;
+		}
+	}
+	if (seen < rank) {
+		for (i1 = 0; i1 < VIEWER_HIST_BUCKETS; i1++) {
+			seen += pHist->pos[i1];
+			if (seen >= rank) {
+				x_bucketRange(i1, &low, &high);
+				value = (S64)high;
+				break;
+			}
+		}
+	}
+
+	if (value < pHist->min) {
+		value = pHist->min;
+	}
+	if (value > pHist->max) {
+		value = pHist->max;
+	}
+	return value;
+}
+
+void openavbViewerHistSummary(const viewer_hist_t *pHist, openavb_intf_latency_t *pSummary)
+{
+	memset(pSummary, 0, sizeof(*pSummary));
+	if (pHist->count == 0) {
+		return;
+	}
+
+	pSummary->count = pHist->count;
+	pSummary->minNS = pHist->min;
+	pSummary->meanNS = pHist->sum / (S64)pHist->count;
+	pSummary->p50NS = openavbViewerHistPercentile(pHist, VIEWER_HIST_P50);
+	pSummary->p99NS = openavbViewerHistPercentile(pHist, VIEWER_HIST_P99);
+	pSummary->p999NS = openavbViewerHistPercentile(pHist, VIEWER_HIST_P999);
+	pSummary->maxNS = pHist->max;
+}
+
+void openavbViewerHistDump(const viewer_hist_t *pHist, const char *pLabel)
+{
+	U64 low, high;
+	S32 i1;
+
+	AVB_LOGF_INFO("%s histogram: %llu values", pLabel, (unsigned long long)pHist->count);
+
+	for (i1 = VIEWER_HIST_BUCKETS - 1; i1 >= 0; i1--) {
+		if (pHist->neg[i1]) {
+			x_bucketRange(i1, &low, &high);
+			AVB_LOGF_INFO("%s [%lld, %lld] NS: %u", pLabel, -(long long)high, -(long long)low, pHist->neg[i1]);
+		}
+	}
+	for (i1 = 0; i1 < VIEWER_HIST_BUCKETS; i1++) {
+		if (pHist->pos[i1]) {
+			x_bucketRange(i1, &low, &high);
+			AVB_LOGF_INFO("%s [%lld, %lld] NS: %u", pLabel, (long long)low, (long long)high, pHist->pos[i1]);
+		}
+	}
+}
@@ -0,0 +1,89 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* HEADER SUMMARY : Log bucketed histograms for the viewer interface module.
+*
+* Values are counted in buckets whose width grows with the magnitude of the
+* value, so a histogram covers nanoseconds to minutes in a fixed amount of
+* memory with a bounded relative error, in the style of HdrHistogram.
+* Negative values (early packets) are counted in a mirrored set of buckets.
+*/
+
+#ifndef OPENAVB_INTF_VIEWER_HIST_H
+#define OPENAVB_INTF_VIEWER_HIST_H 1
+
+#include "openavb_types_pub.h"
+#include "openavb_intf_pub.h"
+
+// Values below 2^VIEWER_HIST_SUB_BITS get a bucket each. Above that every power
+// of two is split into 2^(VIEWER_HIST_SUB_BITS - 1) buckets, which bounds the
+// relative error of a reported value to about 3%.
+#define VIEWER_HIST_SUB_BITS	6
+#define VIEWER_HIST_HALF_COUNT	(1 << (VIEWER_HIST_SUB_BITS - 1))
+
+// Magnitudes of 2^VIEWER_HIST_MAX_BITS ns (about 18 minutes) and above are
+// counted in the last bucket. min and max are still tracked exactly.
+#define VIEWER_HIST_MAX_BITS	40
+#define VIEWER_HIST_BUCKETS		((VIEWER_HIST_MAX_BITS - VIEWER_HIST_SUB_BITS + 2) * VIEWER_HIST_HALF_COUNT)
+
+// Percentiles are given in parts per million.
+#define VIEWER_HIST_P50		500000
+#define VIEWER_HIST_P99		990000
+#define VIEWER_HIST_P999	999000
+
+typedef struct {
+	U64 count;
+	S64 sum;
+	S64 min;
+	S64 max;
+	U32 neg[VIEWER_HIST_BUCKETS];
+	U32 pos[VIEWER_HIST_BUCKETS];
+} viewer_hist_t;
+
+void openavbViewerHistReset(viewer_hist_t *pHist);
+
+void openavbViewerHistRecord(viewer_hist_t *pHist, S64 value);
+
+// Add all counts of pSrc to pDst.
+void openavbViewerHistMerge(viewer_hist_t *pDst, const viewer_hist_t *pSrc);
+
+// Smallest recorded value at or below which ppm parts per million of the
+// values fall. The result is the upper end of the bucket, clamped to max.
+S64 openavbViewerHistPercentile(const viewer_hist_t *pHist, U32 ppm);
+
+// Fill in count, min, mean, p50, p99, p99.9 and max.
+void openavbViewerHistSummary(const viewer_hist_t *pHist, openavb_intf_latency_t *pSummary);
+
+// Log every non empty bucket.
+void openavbViewerHistDump(const viewer_hist_t *pHist, const char *pLabel);
+
+#endif // OPENAVB_INTF_VIEWER_HIST_H
@@ -44,12 +44,16 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_mediaq_pub.h"
 #include "openavb_map_pub.h"
 #include "openavb_map_aaf_audio_pub.h"
+#include "openavb_map_aaf_audio_convert.h"
 
 #define	AVB_LOG_COMPONENT	"AAF Mapping"
 #include "openavb_log_pub.h"
 
 #define AVTP_SUBTYPE_AAF			2
 
+// Forces the shared Tx/Rx bodies into each specialization.
+#define AAF_ALWAYS_INLINE			inline __attribute__ ((always_inline))
+
 // Header sizes (bytes)
 #define AVTP_V0_HEADER_SIZE			12
 #define AAF_HEADER_SIZE				12
@@ -133,6 +137,16 @@ typedef struct {
 	// MCR clock recovery interval
 	U32 mcrRecoveryInterval;
 
+	// map_nv_item_format
+	aaf_item_format_t itemFormat;
+
+	// map_nv_item_layout
+	aaf_item_layout_t itemLayout;
+
+	// map_nv_channel_map - media queue item channel for each stream channel
+	U16 channelMap[AAF_CHANNEL_MAP_MAX];
+	U32 channelMapCount;
+
 	/////////////
 	// Variable data
 	/////////////
@@ -155,8 +169,128 @@ typedef struct {
 
 	bool mediaQItemSyncTS;
 
+	// Stream channel N uses item channel N and the layout is interleaved
+	bool itemIdentity;
+
+	// Host order AAF format_info header word and packet_info word (less the
+	// reserved bits) for the configured stream
+	U32 formatInfo;
+	U32 packetInfo;
+
+	// map_nv_fast_path - allow the specialized callbacks
+	bool fastPath;
+
+	// Specialized callbacks selected at Tx/Rx init, NULL for the generic path
+	openavb_map_tx_cb_t txFastCB;
+	openavb_map_rx_cb_t rxFastCB;
+
+	// Listener sample conversion kernel and the incoming format it was selected for
+	openavb_aaf_convert_fn_t convertFn;
+	aaf_sample_format_t convertInFormat;
+
 } pvt_data_t;
 
+static void x_selectFastPath(media_q_t *pMediaQ);
+
+// Check the channel map against the channel count and note if it can be skipped.
+static void x_validateChannelMap(media_q_t *pMediaQ)
+{
+	media_q_pub_map_aaf_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+	pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+	U32 i1;
+
+	if (pPvtData->channelMapCount > pPubMapInfo->audioChannels) {
+		AVB_LOGF_ERROR("Channel map has %d entries for %d channels", pPvtData->channelMapCount, pPubMapInfo->audioChannels);
+		pPvtData->channelMapCount = 0;
+	}
+	for (i1 = 0; i1 < pPvtData->channelMapCount; i1++) {
+		if (pPvtData->channelMap[i1] >= pPubMapInfo->audioChannels) {
+			AVB_LOGF_ERROR("Channel map entry %d (%d) out of range", i1, pPvtData->channelMap[i1]);
+			pPvtData->channelMapCount = 0;
+			break;
+		}
+	}
+	if (pPvtData->itemFormat == AAF_ITEM_FORMAT_WIRE && pPvtData->channelMapCount > 0) {
+		AVB_LOG_WARNING("Channel map ignored without map_nv_item_format");
+		pPvtData->channelMapCount = 0;
+	}
+
+	pPvtData->itemIdentity = (pPvtData->itemLayout == AAF_ITEM_LAYOUT_INTERLEAVED) ? TRUE : FALSE;
+	for (i1 = 0; i1 < pPvtData->channelMapCount; i1++) {
+		if (pPvtData->channelMap[i1] != i1) {
+			pPvtData->itemIdentity = FALSE;
+		}
+	}
+}
+
+// Media queue item channel carrying stream channel
+static inline U32 x_itemChannel(pvt_data_t *pPvtData, U32 channel)
+{
+	return (channel < pPvtData->channelMapCount) ? pPvtData->channelMap[channel] : channel;
+}
+
+// Encode frames from a float32 / int32 item starting at frameIdx into the AAF payload.
+static void x_itemToWire(media_q_t *pMediaQ, U8 *pPayload, U8 *pItemData, U32 frameIdx, U32 frames)
+{
+	media_q_pub_map_aaf_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+	pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+	bool itemFloat = (pPvtData->itemFormat == AAF_ITEM_FORMAT_FLOAT32) ? TRUE : FALSE;
+	bool wireFloat = (pPvtData->aaf_format == AAF_FORMAT_FLOAT_32) ? TRUE : FALSE;
+	U32 wireBytes = pPubMapInfo->packetSampleSizeBytes;
+	U32 channels = pPubMapInfo->audioChannels;
+	U32 i1;
+
+	if (pPvtData->itemIdentity) {
+		// Same sample order on both sides, one contiguous run.
+		openavbAafEncodeSamples(pPayload, wireBytes, wireBytes, wireFloat,
+			pItemData + frameIdx * pPubMapInfo->itemFrameSizeBytes, 4, itemFloat, frames * channels);
+		return;
+	}
+
+	for (i1 = 0; i1 < channels; i1++) {
+		U32 itemChannel = x_itemChannel(pPvtData, i1);
+		if (pPvtData->itemLayout == AAF_ITEM_LAYOUT_PLANAR) {
+			openavbAafEncodeSamples(pPayload + i1 * wireBytes, pPubMapInfo->packetFrameSizeBytes, wireBytes, wireFloat,
+				pItemData + (itemChannel * pPubMapInfo->framesPerItem + frameIdx) * 4, 4, itemFloat, frames);
+		}
+		else {
+			openavbAafEncodeSamples(pPayload + i1 * wireBytes, pPubMapInfo->packetFrameSizeBytes, wireBytes, wireFloat,
+				pItemData + frameIdx * pPubMapInfo->itemFrameSizeBytes + itemChannel * 4, pPubMapInfo->itemFrameSizeBytes, itemFloat, frames);
+		}
+	}
+}
+
+// Decode frames of an AAF payload in the incoming format into a float32 / int32 item at frameIdx.
+static void x_wireToItem(media_q_t *pMediaQ, U8 *pItemData, U32 frameIdx, U8 *pPayload, aaf_sample_format_t wireFormat, U32 frames)
+{
+	media_q_pub_map_aaf_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+	pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+	bool itemFloat = (pPvtData->itemFormat == AAF_ITEM_FORMAT_FLOAT32) ? TRUE : FALSE;
+	bool wireFloat = (wireFormat == AAF_FORMAT_FLOAT_32) ? TRUE : FALSE;
+	U32 wireBytes = wireFloat ? 4 : 6 - wireFormat;
+	U32 channels = pPubMapInfo->audioChannels;
+	U32 wireFrameBytes = wireBytes * channels;
+	U32 i1;
+
+	if (pPvtData->itemIdentity) {
+		openavbAafDecodeSamples(pItemData + frameIdx * pPubMapInfo->itemFrameSizeBytes, 4, itemFloat,
+			pPayload, wireBytes, wireBytes, wireFloat, frames * channels);
+		return;
+	}
+
+	for (i1 = 0; i1 < channels; i1++) {
+		U32 itemChannel = x_itemChannel(pPvtData, i1);
+		if (pPvtData->itemLayout == AAF_ITEM_LAYOUT_PLANAR) {
+			openavbAafDecodeSamples(pItemData + (itemChannel * pPubMapInfo->framesPerItem + frameIdx) * 4, 4, itemFloat,
+				pPayload + i1 * wireBytes, wireFrameBytes, wireBytes, wireFloat, frames);
+		}
+		else {
+			openavbAafDecodeSamples(pItemData + frameIdx * pPubMapInfo->itemFrameSizeBytes + itemChannel * 4, pPubMapInfo->itemFrameSizeBytes, itemFloat,
+				pPayload + i1 * wireBytes, wireFrameBytes, wireBytes, wireFloat, frames);
+		}
+	}
+}
+
 static void x_calculateSizes(media_q_t *pMediaQ)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_MAP);
@@ -268,6 +402,18 @@ static void x_calculateSizes(media_q_t *pMediaQ)
 		AVB_LOGF_INFO("aaf_format=%d (%s%d)",
 			pPvtData->aaf_format, typeStr, pPubMapInfo->audioBitDepth);
 
+		if (pPvtData->itemFormat != AAF_ITEM_FORMAT_WIRE) {
+			if (pPvtData->aaf_format < AAF_FORMAT_FLOAT_32 || pPvtData->aaf_format > AAF_FORMAT_INT_16) {
+				AVB_LOG_ERROR("Item format conversion requires a float or integer AAF format");
+				pPvtData->itemFormat = AAF_ITEM_FORMAT_WIRE;
+			}
+			else {
+				// Items carry 32 bit samples regardless of the wire format.
+				pPubMapInfo->itemSampleSizeBytes = 4;
+			}
+		}
+		x_validateChannelMap(pMediaQ);
+
 		// Audio frames per packet
 		pPubMapInfo->framesPerPacket = (pPubMapInfo->audioRate / pPvtData->txInterval);
 		if (pPubMapInfo->audioRate % pPvtData->txInterval != 0) {
@@ -287,6 +433,13 @@ static void x_calculateSizes(media_q_t *pMediaQ)
 			pPubMapInfo->packetFrameSizeBytes,
 			pPubMapInfo->framesPerPacket,
 			pPvtData->payloadSize);
+		pPvtData->formatInfo = pPvtData->aaf_format << 24;
+		pPvtData->formatInfo |= pPvtData->aaf_rate << 20;
+		pPvtData->formatInfo |= pPubMapInfo->audioChannels << 8;
+		pPvtData->formatInfo |= pPvtData->aaf_bit_depth;
+		pPvtData->packetInfo = pPvtData->payloadSize << 16;
+		pPvtData->packetInfo |= pPvtData->aaf_event_field << 8;
+
 		if (pPvtData->aaf_format >= AAF_FORMAT_INT_32 && pPvtData->aaf_format <= AAF_FORMAT_INT_16) {
 			// Determine the largest size we could receive before adjustments.
 			pPvtData->payloadSizeMaxListener = 4 * pPubMapInfo->audioChannels * pPubMapInfo->framesPerPacket;
@@ -359,6 +512,51 @@ void openavbMapAVTPAudioCfgCB(media_q_t *pMediaQ, const char *name, const char *
 			char *pEnd;
 			pPvtData->mcrRecoveryInterval = strtol(value, &pEnd, 10);
 		}
+		else if (strcmp(name, "map_nv_fast_path") == 0) {
+			char *pEnd;
+			pPvtData->fastPath = strtol(value, &pEnd, 10) ? TRUE : FALSE;
+		}
+		else if (strcmp(name, "map_nv_item_format") == 0) {
+			if (strcmp(value, "wire") == 0) {
+				pPvtData->itemFormat = AAF_ITEM_FORMAT_WIRE;
+			}
+			else if (strcmp(value, "float32") == 0) {
+				pPvtData->itemFormat = AAF_ITEM_FORMAT_FLOAT32;
+			}
+			else if (strcmp(value, "int32") == 0) {
+				pPvtData->itemFormat = AAF_ITEM_FORMAT_INT32;
+			}
+			else {
+				AVB_LOGF_ERROR("Invalid map_nv_item_format: %s", value);
+			}
+		}
+		else if (strcmp(name, "map_nv_item_layout") == 0) {
+			if (strcmp(value, "interleaved") == 0) {
+				pPvtData->itemLayout = AAF_ITEM_LAYOUT_INTERLEAVED;
+			}
+			else if (strcmp(value, "planar") == 0) {
+				pPvtData->itemLayout = AAF_ITEM_LAYOUT_PLANAR;
+			}
+			else {
+				AVB_LOGF_ERROR("Invalid map_nv_item_layout: %s", value);
+			}
+		}
+		else if (strcmp(name, "map_nv_channel_map") == 0) {
+			// Comma separated item channel for each stream channel, e.g. 1,0,3,2
+			const char *pCur = value;
+			char *pEnd;
+			pPvtData->channelMapCount = 0;
+			while (*pCur && pPvtData->channelMapCount < AAF_CHANNEL_MAP_MAX) {
+				long tmp = strtol(pCur, &pEnd, 10);
+				if (pEnd == pCur || tmp < 0) {
+					AVB_LOGF_ERROR("Invalid map_nv_channel_map: %s", value);
+					pPvtData->channelMapCount = 0;
+					break;
+				}
+				pPvtData->channelMap[pPvtData->channelMapCount++] = tmp;
+				pCur = (*pEnd == ',') ? pEnd + 1 : pEnd;
+			}
+		}
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
@@ -451,6 +649,7 @@ void openavbMapAVTPAudioTxInitCB(media_q_t *pMediaQ)
 		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
 		if (pPvtData) {
 			pPvtData->isTalker = TRUE;
+			x_selectFastPath(pMediaQ);
 		}
 	}
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
@@ -459,8 +658,10 @@ void openavbMapAVTPAudioTxInitCB(media_q_t *pMediaQ)
 // CORE_TODO: This callback should be updated to work in a similar way the uncompressed audio mapping. With allowing AVTP packets to be built
 //  from multiple media queue items. This allows interface to set into the media queue blocks of audio frames to properly correspond to
 //  a SYT_INTERVAL. Additionally the public data member sytInterval needs to be set in the same way the uncompressed audio mapping does.
-// This talker callback will be called for each AVB observation interval.
-tx_cb_ret_t openavbMapAVTPAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
+// Talker packet builder shared by the generic and the specialized callbacks. The
+// specializations pass constant arguments so the compiler can drop the format
+// branches and inline the payload copy.
+static AAF_ALWAYS_INLINE tx_cb_ret_t x_txCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen, const U32 payloadSize, const bool knownWire)
 {
 	media_q_item_t *pMediaQItem = NULL;
 	AVB_TRACE_ENTRY(AVB_TRACE_MAP_DETAIL);
@@ -494,14 +695,13 @@ tx_cb_ret_t openavbMapAVTPAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 		return TX_CB_RET_PACKET_NOT_READY;
 	}
 
-	if ((*dataLen - TOTAL_HEADER_SIZE) < pPvtData->payloadSize) {
+	if ((*dataLen - TOTAL_HEADER_SIZE) < payloadSize) {
 		AVB_LOG_ERROR("Not enough room in packet for payload");
 		openavbMediaQTailUnlock(pMediaQ);
 		AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
 		return TX_CB_RET_PACKET_NOT_READY;
 	}
 
-	U32 tmp32;
 	U8 *pHdrV0 = pData;
 	U32 *pHdr = (U32 *)(pData + AVTP_V0_HEADER_SIZE);
 	U8  *pPayload = pData + TOTAL_HEADER_SIZE;
@@ -545,16 +745,10 @@ tx_cb_ret_t openavbMapAVTPAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 			}
 
 			// - 4 bytes	format info (format, sample rate, channels per frame, bit depth)
-			tmp32 = pPvtData->aaf_format << 24;
-			tmp32 |= pPvtData->aaf_rate  << 20;
-			tmp32 |= pPubMapInfo->audioChannels << 8;
-			tmp32 |= pPvtData->aaf_bit_depth;
-			*pHdr++ = htonl(tmp32);
+			*pHdr++ = htonl(pPvtData->formatInfo);
 
 			// - 4 bytes	packet info (data length, evt field)
-			tmp32 = pPvtData->payloadSize << 16;
-			tmp32 |= pPvtData->aaf_event_field << 8;
-			*pHdr++ = htonl(tmp32);
+			*pHdr++ = htonl(pPvtData->packetInfo);
 
 			// Set (clear) sparse mode flag
 			if (pPvtData->sparseMode == TS_SPARSE_MODE_ENABLED) {
@@ -563,7 +757,7 @@ tx_cb_ret_t openavbMapAVTPAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 				pHdrV0[HIDX_AVTP_HIDE7_SP] &= ~SP_M0_BIT;
 			}
 
-			if ((pMediaQItem->dataLen - pMediaQItem->readIdx) < pPvtData->payloadSize) {
+			if ((pMediaQItem->dataLen - pMediaQItem->readIdx) < bytesNeeded) {
 				// This should not happen so we will just toss it away.
 				AVB_LOG_ERROR("Not enough data in media queue item for packet");
 				openavbMediaQTailPull(pMediaQ);
@@ -571,10 +765,17 @@ tx_cb_ret_t openavbMapAVTPAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 				return TX_CB_RET_PACKET_NOT_READY;
 			}
 
-			memcpy(pPayload, (uint8_t *)pMediaQItem->pPubData + pMediaQItem->readIdx, pPvtData->payloadSize);
-			bytesProcessed += pPvtData->payloadSize;
+			if (knownWire || pPvtData->itemFormat == AAF_ITEM_FORMAT_WIRE) {
+				memcpy(pPayload, (uint8_t *)pMediaQItem->pPubData + pMediaQItem->readIdx, payloadSize);
+			}
+			else {
+				x_itemToWire(pMediaQ, pPayload, pMediaQItem->pPubData,
+					pMediaQItem->readIdx / pPubMapInfo->itemFrameSizeBytes, pPubMapInfo->framesPerPacket);
+			}
+			// Item and payload sizes differ when the item format is not the wire format.
+			bytesProcessed += bytesNeeded;
 
-			pMediaQItem->readIdx += pPvtData->payloadSize;
+			pMediaQItem->readIdx += bytesNeeded;
 			if (pMediaQItem->readIdx >= pMediaQItem->dataLen) {
 				// Finished reading the entire item
 				openavbMediaQTailPull(pMediaQ);
@@ -590,7 +791,7 @@ tx_cb_ret_t openavbMapAVTPAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 	}
 
 	// Set out bound data length (entire packet length)
-	*dataLen = bytesNeeded + TOTAL_HEADER_SIZE;
+	*dataLen = payloadSize + TOTAL_HEADER_SIZE;
 
 	AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
 	return TX_CB_RET_PACKET_READY;
@@ -608,6 +809,7 @@ void openavbMapAVTPAudioRxInitCB(media_q_t *pMediaQ)
 			return;
 		}
 		pPvtData->isTalker = FALSE;
+		x_selectFastPath(pMediaQ);
 		if (pPvtData->audioMcr != AVB_MCR_NONE) {
 			HAL_INIT_MCR_V2(pPvtData->txInterval, pPvtData->packingFactor, pPvtData->mcrTimestampInterval, pPvtData->mcrRecoveryInterval);
 		}
@@ -639,8 +841,10 @@ void openavbMapAVTPAudioRxInitCB(media_q_t *pMediaQ)
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
 }
 
-// This callback occurs when running as a listener and data is available.
-bool openavbMapAVTPAudioRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
+// Listener packet handler shared by the generic and the specialized callbacks.
+// A packet whose header words match the configured stream skips the field by
+// field validation.
+static AAF_ALWAYS_INLINE bool x_rxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen, const U32 payloadSize, const bool knownWire)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_MAP_DETAIL);
 	if (pMediaQ && pData) {
@@ -668,77 +872,83 @@ bool openavbMapAVTPAudioRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 		bool streamSparseMode = (pHdrV0[HIDX_AVTP_HIDE7_SP] & SP_M0_BIT) ? TRUE : FALSE;
 		U16 payloadLen = ntohs(*(U16 *)(&pHdrV0[HIDX_STREAM_DATA_LEN16]));
 
-		if (payloadLen > dataLen - TOTAL_HEADER_SIZE) {
-			if (pPvtData->dataValid)
-				AVB_LOGF_ERROR("header data len %d > actual data len %d",
-					       payloadLen, dataLen - TOTAL_HEADER_SIZE);
-			dataValid = FALSE;
-		}
+		incoming_aaf_format = (aaf_sample_format_t) ((format_info >> 24) & 0xFF);
+		if (format_info != pPvtData->formatInfo
+				|| (packet_info & 0xFFFF0F00) != pPvtData->packetInfo
+				|| streamSparseMode != listenerSparseMode
+				|| payloadLen > dataLen - TOTAL_HEADER_SIZE) {
+			if (payloadLen > dataLen - TOTAL_HEADER_SIZE) {
+				if (pPvtData->dataValid)
+					AVB_LOGF_ERROR("header data len %d > actual data len %d",
+						       payloadLen, dataLen - TOTAL_HEADER_SIZE);
+				dataValid = FALSE;
+			}
 
-		if ((incoming_aaf_format = (aaf_sample_format_t) ((format_info >> 24) & 0xFF)) != pPvtData->aaf_format) {
-			// Check if we can convert the incoming data.
-			if (incoming_aaf_format >= AAF_FORMAT_INT_32 && incoming_aaf_format <= AAF_FORMAT_INT_16 &&
-					pPvtData->aaf_format >= AAF_FORMAT_INT_32 && pPvtData->aaf_format <= AAF_FORMAT_INT_16) {
-				// Integer conversion should be supported.
-				dataConversionEnabled = TRUE;
+			if (incoming_aaf_format != pPvtData->aaf_format) {
+				// Check if we can convert the incoming data.
+				if (incoming_aaf_format >= AAF_FORMAT_INT_32 && incoming_aaf_format <= AAF_FORMAT_INT_16 &&
+						pPvtData->aaf_format >= AAF_FORMAT_INT_32 && pPvtData->aaf_format <= AAF_FORMAT_INT_16) {
+					// Integer conversion should be supported.
+					dataConversionEnabled = TRUE;
+				}
+				else {
+					if (pPvtData->dataValid)
+						AVB_LOGF_ERROR("Listener format %d doesn't match received data (%d)",
+							pPvtData->aaf_format, incoming_aaf_format);
+					dataValid = FALSE;
+				}
 			}
-			else {
+			if ((tmp = ((format_info >> 20) & 0x0F)) != pPvtData->aaf_rate) {
 				if (pPvtData->dataValid)
-					AVB_LOGF_ERROR("Listener format %d doesn't match received data (%d)",
-						pPvtData->aaf_format, incoming_aaf_format);
+					AVB_LOGF_ERROR("Listener sample rate (%d) doesn't match received data (%d)",
+						pPvtData->aaf_rate, tmp);
 				dataValid = FALSE;
 			}
-		}
-		if ((tmp = ((format_info >> 20) & 0x0F)) != pPvtData->aaf_rate) {
-			if (pPvtData->dataValid)
-				AVB_LOGF_ERROR("Listener sample rate (%d) doesn't match received data (%d)",
-					pPvtData->aaf_rate, tmp);
-			dataValid = FALSE;
-		}
-		if ((tmp = ((format_info >> 8) & 0x3FF)) != pPubMapInfo->audioChannels) {
-			if (pPvtData->dataValid)
-				AVB_LOGF_ERROR("Listener channel count (%d) doesn't match received data (%d)",
-					pPubMapInfo->audioChannels, tmp);
-			dataValid = FALSE;
-		}
-		if ((incoming_bit_depth = (U8) (format_info & 0xFF)) == 0) {
-			if (pPvtData->dataValid)
-				AVB_LOGF_ERROR("Listener bit depth (%d) not valid",
-					incoming_bit_depth);
-			dataValid = FALSE;
-		}
-		if ((tmp = ((packet_info >> 16) & 0xFFFF)) != pPvtData->payloadSize) {
-			if (!dataConversionEnabled) {
+			if ((tmp = ((format_info >> 8) & 0x3FF)) != pPubMapInfo->audioChannels) {
 				if (pPvtData->dataValid)
-					AVB_LOGF_ERROR("Listener payload size (%d) doesn't match received data (%d)",
-						pPvtData->payloadSize, tmp);
+					AVB_LOGF_ERROR("Listener channel count (%d) doesn't match received data (%d)",
+						pPubMapInfo->audioChannels, tmp);
 				dataValid = FALSE;
 			}
-			else {
-				int nInSampleLength = 6 - incoming_aaf_format; // Calculate the number of integer bytes per sample received
-				int nOutSampleLength = 6 - pPvtData->aaf_format; // Calculate the number of integer bytes per sample we want
-				if (tmp / nInSampleLength != pPvtData->payloadSize / nOutSampleLength) {
+			if ((incoming_bit_depth = (U8) (format_info & 0xFF)) == 0) {
+				if (pPvtData->dataValid)
+					AVB_LOGF_ERROR("Listener bit depth (%d) not valid",
+						incoming_bit_depth);
+				dataValid = FALSE;
+			}
+			if ((tmp = ((packet_info >> 16) & 0xFFFF)) != payloadSize) {
+				if (!dataConversionEnabled) {
 					if (pPvtData->dataValid)
-						AVB_LOGF_ERROR("Listener payload samples (%d) doesn't match received data samples (%d)",
-							pPvtData->payloadSize / nOutSampleLength, tmp / nInSampleLength);
+						AVB_LOGF_ERROR("Listener payload size (%d) doesn't match received data (%d)",
+							payloadSize, tmp);
 					dataValid = FALSE;
 				}
+				else {
+					int nInSampleLength = 6 - incoming_aaf_format; // Calculate the number of integer bytes per sample received
+					int nOutSampleLength = 6 - pPvtData->aaf_format; // Calculate the number of integer bytes per sample we want
+					if (tmp / nInSampleLength != payloadSize / nOutSampleLength) {
+						if (pPvtData->dataValid)
+							AVB_LOGF_ERROR("Listener payload samples (%d) doesn't match received data samples (%d)",
+								payloadSize / nOutSampleLength, tmp / nInSampleLength);
+						dataValid = FALSE;
+					}
+				}
+			}
+			if ((tmp = ((packet_info >> 8) & 0x0F)) != pPvtData->aaf_event_field) {
+				if (pPvtData->dataValid)
+					AVB_LOGF_ERROR("Listener event field (%d) doesn't match received data (%d)",
+						pPvtData->aaf_event_field, tmp);
+			}
+			if (streamSparseMode && !listenerSparseMode) {
+				AVB_LOG_INFO("Listener enabling sparse mode to match incoming stream");
+				pPvtData->sparseMode = TS_SPARSE_MODE_ENABLED;
+				listenerSparseMode = TRUE;
+			}
+			if (!streamSparseMode && listenerSparseMode) {
+				AVB_LOG_INFO("Listener disabling sparse mode to match incoming stream");
+				pPvtData->sparseMode = TS_SPARSE_MODE_DISABLED;
+				listenerSparseMode = FALSE;
 			}
-		}
-		if ((tmp = ((packet_info >> 8) & 0x0F)) != pPvtData->aaf_event_field) {
-			if (pPvtData->dataValid)
-				AVB_LOGF_ERROR("Listener event field (%d) doesn't match received data (%d)",
-					pPvtData->aaf_event_field, tmp);
-		}
-		if (streamSparseMode && !listenerSparseMode) {
-			AVB_LOG_INFO("Listener enabling sparse mode to match incoming stream");
-			pPvtData->sparseMode = TS_SPARSE_MODE_ENABLED;
-			listenerSparseMode = TRUE;
-		}
-		if (!streamSparseMode && listenerSparseMode) {
-			AVB_LOG_INFO("Listener disabling sparse mode to match incoming stream");
-			pPvtData->sparseMode = TS_SPARSE_MODE_DISABLED;
-			listenerSparseMode = FALSE;
 		}
 
 		if (dataValid) {
@@ -775,54 +985,44 @@ bool openavbMapAVTPAudioRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 					}
 				}
 				if (dataValid) {
-					if (!dataConversionEnabled) {
+					U32 itemBytes = payloadSize;
+					if (!knownWire && pPvtData->itemFormat != AAF_ITEM_FORMAT_WIRE) {
+						// Translate in place on the wire data, then decode into the item.
+						if (pPubMapInfo->intf_rx_translate_cb) {
+							pPubMapInfo->intf_rx_translate_cb(pMediaQ, pPayload, payloadLen);
+						}
+
+						x_wireToItem(pMediaQ, pMediaQItem->pPubData, pMediaQItem->dataLen / pPubMapInfo->itemFrameSizeBytes,
+							pPayload, incoming_aaf_format, pPubMapInfo->framesPerPacket);
+						itemBytes = pPubMapInfo->framesPerPacket * pPubMapInfo->itemFrameSizeBytes;
+					}
+					else if (!dataConversionEnabled) {
 						// Just use the raw incoming data, and ignore the incoming bit_depth.
 						if (pPubMapInfo->intf_rx_translate_cb) {
-							pPubMapInfo->intf_rx_translate_cb(pMediaQ, pPayload, pPvtData->payloadSize);
+							pPubMapInfo->intf_rx_translate_cb(pMediaQ, pPayload, payloadSize);
 						}
 
-						memcpy((uint8_t *)pMediaQItem->pPubData + pMediaQItem->dataLen, pPayload, pPvtData->payloadSize);
+						memcpy((uint8_t *)pMediaQItem->pPubData + pMediaQItem->dataLen, pPayload, payloadSize);
 					}
 					else {
-						static U8 s_audioBuffer[1500];
-						U8 *pInData = pPayload;
-						U8 *pInDataEnd = pPayload + payloadLen;
-						U8 *pOutData = s_audioBuffer;
-						int nInSampleLength = 6 - incoming_aaf_format; // Calculate the number of integer bytes per sample received
-						int nOutSampleLength = 6 - pPvtData->aaf_format; // Calculate the number of integer bytes per sample we want
-						int i;
-						if (nInSampleLength < nOutSampleLength) {
-							// We need to pad the data supplied.
-							while (pInData < pInDataEnd) {
-								for (i = 0; i < nInSampleLength; ++i) {
-									*pOutData++ = *pInData++;
-								}
-								for ( ; i < nOutSampleLength; ++i) {
-									*pOutData++ = 0; // Value specified in Clause 7.3.4.
-								}
-							}
-						}
-						else {
-							// We need to truncate the data supplied.
-							while (pInData < pInDataEnd) {
-								for (i = 0; i < nOutSampleLength; ++i) {
-									*pOutData++ = *pInData++;
-								}
-								pInData += (nInSampleLength - nOutSampleLength);
-							}
-						}
-						if (pOutData - s_audioBuffer != pPvtData->payloadSize) {
-							AVB_LOGF_ERROR("Output not expected size (%d instead of %d)", pOutData - s_audioBuffer, pPvtData->payloadSize);
+						// Convert straight into the media queue item.
+						U8 *pOutData = (U8 *)pMediaQItem->pPubData + pMediaQItem->dataLen;
+						U32 nInSampleLength = 6 - incoming_aaf_format; // Calculate the number of integer bytes per sample received
+						U32 nOutSampleLength = 6 - pPvtData->aaf_format; // Calculate the number of integer bytes per sample we want
+						if (!pPvtData->convertFn || pPvtData->convertInFormat != incoming_aaf_format) {
+							pPvtData->convertFn = openavbAafConvertSelect(nInSampleLength, nOutSampleLength);
+							pPvtData->convertInFormat = incoming_aaf_format;
+							AVB_LOGF_INFO("Converting AAF format %d to %d (%s)",
+								incoming_aaf_format, pPvtData->aaf_format, openavbAafConvertIsaName());
 						}
+						pPvtData->convertFn(pOutData, pPayload, payloadSize / nOutSampleLength);
 
 						if (pPubMapInfo->intf_rx_translate_cb) {
-							pPubMapInfo->intf_rx_translate_cb(pMediaQ, s_audioBuffer, pPvtData->payloadSize);
+							pPubMapInfo->intf_rx_translate_cb(pMediaQ, pOutData, payloadSize);
 						}
-
-						memcpy((uint8_t *)pMediaQItem->pPubData + pMediaQItem->dataLen, s_audioBuffer, pPvtData->payloadSize);
 					}
 
-					pMediaQItem->dataLen += pPvtData->payloadSize;
+					pMediaQItem->dataLen += itemBytes;
 				}
 
 				if (pMediaQItem->dataLen < pMediaQItem->itemSize) {
@@ -854,6 +1054,104 @@ bool openavbMapAVTPAudioRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 	return FALSE;
 }
 
+// This talker callback will be called for each AVB observation interval.
+tx_cb_ret_t openavbMapAVTPAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
+{
+	pvt_data_t *pPvtData = pMediaQ ? pMediaQ->pPvtMapInfo : NULL;
+	if (pPvtData && pPvtData->txFastCB) {
+		return pPvtData->txFastCB(pMediaQ, pData, dataLen);
+	}
+	return x_txCB(pMediaQ, pData, dataLen, pPvtData ? pPvtData->payloadSize : 0, FALSE);
+}
+
+// This callback occurs when running as a listener and data is available.
+bool openavbMapAVTPAudioRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
+{
+	pvt_data_t *pPvtData = pMediaQ ? pMediaQ->pPvtMapInfo : NULL;
+	if (pPvtData && pPvtData->rxFastCB) {
+		return pPvtData->rxFastCB(pMediaQ, pData, dataLen);
+	}
+	return x_rxCB(pMediaQ, pData, dataLen, pPvtData ? pPvtData->payloadSize : 0, FALSE);
+}
+
+// Specialized callbacks for common stream formats. Each one is the shared body
+// with the payload size fixed and the media queue items known to hold wire
+// format samples.
+#define AAF_SPECIALIZE(channels, sampleBytes, frames) \
+	static tx_cb_ret_t x_txCB_##channels##_##sampleBytes##_##frames(media_q_t *pMediaQ, U8 *pData, U32 *dataLen) \
+	{ \
+		return x_txCB(pMediaQ, pData, dataLen, (channels) * (sampleBytes) * (frames), TRUE); \
+	} \
+	static bool x_rxCB_##channels##_##sampleBytes##_##frames(media_q_t *pMediaQ, U8 *pData, U32 dataLen) \
+	{ \
+		return x_rxCB(pMediaQ, pData, dataLen, (channels) * (sampleBytes) * (frames), TRUE); \
+	}
+
+#define AAF_FAST_PATH(channels, sampleBytes, frames) \
+	{ channels, sampleBytes, frames, x_txCB_##channels##_##sampleBytes##_##frames, x_rxCB_##channels##_##sampleBytes##_##frames }
+
+// 6 frames per packet is 48 kHz at the class A rate of 8000 packets per second;
+// 12 frames is 48 kHz at the class B rate of 4000.
+AAF_SPECIALIZE(2, 2, 6)
+AAF_SPECIALIZE(2, 3, 6)
+AAF_SPECIALIZE(2, 4, 6)
+AAF_SPECIALIZE(8, 2, 6)
+AAF_SPECIALIZE(8, 3, 6)
+AAF_SPECIALIZE(8, 4, 6)
+AAF_SPECIALIZE(2, 2, 12)
+AAF_SPECIALIZE(8, 3, 12)
+
+typedef struct {
+	U32 channels;
+	U32 sampleBytes;
+	U32 framesPerPacket;
+	openavb_map_tx_cb_t txCB;
+	openavb_map_rx_cb_t rxCB;
+} fast_path_t;
+
+static const fast_path_t x_fastPaths[] = {
+	AAF_FAST_PATH(2, 2, 6),
+	AAF_FAST_PATH(2, 3, 6),
+	AAF_FAST_PATH(2, 4, 6),
+	AAF_FAST_PATH(8, 2, 6),
+	AAF_FAST_PATH(8, 3, 6),
+	AAF_FAST_PATH(8, 4, 6),
+	AAF_FAST_PATH(2, 2, 12),
+	AAF_FAST_PATH(8, 3, 12),
+};
+
+// Pick a specialized callback matching the configured stream, if there is one.
+static void x_selectFastPath(media_q_t *pMediaQ)
+{
+	media_q_pub_map_aaf_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+	pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+	U32 i1;
+
+	pPvtData->txFastCB = NULL;
+	pPvtData->rxFastCB = NULL;
+	if (!pPvtData->fastPath || pPvtData->itemFormat != AAF_ITEM_FORMAT_WIRE || pPvtData->aaf_format == AAF_FORMAT_UNSPEC) {
+		return;
+	}
+
+	for (i1 = 0; i1 < sizeof(x_fastPaths) / sizeof(x_fastPaths[0]); i1++) {
+		const fast_path_t *pPath = &x_fastPaths[i1];
+		if (pPath->channels == pPubMapInfo->audioChannels
+				&& pPath->sampleBytes == pPubMapInfo->packetSampleSizeBytes
+				&& pPath->framesPerPacket == pPubMapInfo->framesPerPacket
+				&& pPath->channels * pPath->sampleBytes * pPath->framesPerPacket == pPvtData->payloadSize) {
+			if (pPvtData->isTalker) {
+				pPvtData->txFastCB = pPath->txCB;
+			}
+			else {
+				pPvtData->rxFastCB = pPath->rxCB;
+			}
+			AVB_LOGF_INFO("Using specialized path: %d channels, %d byte samples, %d frames per packet",
+				pPath->channels, pPath->sampleBytes, pPath->framesPerPacket);
+			return;
+		}
+	}
+}
+
 // This callback will be called when the mapping module needs to be closed.
 // All cleanup should occur in this function.
 void openavbMapAVTPAudioEndCB(media_q_t *pMediaQ)
@@ -923,6 +1221,7 @@ extern DLL_EXPORT bool openavbMapAVTPAudioInitialize(media_q_t *pMediaQ, openavb
 		pPvtData->aaf_event_field = AAF_STATIC_CHANNELS_LAYOUT;
 		pPvtData->intervalCounter = 0;
 		pPvtData->mediaQItemSyncTS = FALSE;
+		pPvtData->fastPath = TRUE;
 		openavbMediaQSetMaxLatency(pMediaQ, inMaxTransitUsec);
 	}
 
@@ -0,0 +1,870 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+ 
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ 
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ 
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+Attributions: The inih library portion of the source code is licensed from 
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt. 
+Complete license and copyright information can be found at 
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+ * MODULE SUMMARY : AAF integer sample format conversion kernels.
+ *
+ * Samples are big-endian so padding appends zero bytes after each sample and
+ * truncation drops the trailing bytes. Each kernel handles the bulk of the
+ * buffer with vector instructions and finishes the remainder with the scalar
+ * kernel. Vector loops are bounded so that loads never read past the end of the
+ * source and stores never write past the end of the destination.
+ *
+ * The float32 / int32 encode and decode functions convert four samples at a
+ * time with SSE2 on x86 (always present on x86-64) or NEON on AArch64. Samples
+ * pass through a 32 bit word holding the wire sample left justified, so every
+ * wire width shares the same conversion.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "openavb_types_pub.h"
+#include "openavb_map_aaf_audio_convert.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AAF_CONVERT_X86		1
+#include <immintrin.h>
+#define X86_TARGET(isa)		__attribute__ ((target (isa)))
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define AAF_CONVERT_NEON	1
+#include <arm_neon.h>
+#endif
+
+#define CONVERT_KEY(inBytes, outBytes)	(((inBytes) << 4) | (outBytes))
+
+/////////////
+// Scalar kernels
+/////////////
+
+// Constant arguments let the compiler fully unroll the per sample loops.
+static inline void x_convertScalar(U8 *pDst, const U8 *pSrc, U32 sampleCount, const U32 inBytes, const U32 outBytes)
+{
+	const U32 copyBytes = (inBytes < outBytes) ? inBytes : outBytes;
+	while (sampleCount--) {
+		U32 i;
+		for (i = 0; i < copyBytes; i++) {
+			pDst[i] = pSrc[i];
+		}
+		for ( ; i < outBytes; i++) {
+			pDst[i] = 0; // Value specified in Clause 7.3.4.
+		}
+		pSrc += inBytes;
+		pDst += outBytes;
+	}
+}
+
+static void x_scalar2to3(U8 *pDst, const U8 *pSrc, U32 sampleCount) { x_convertScalar(pDst, pSrc, sampleCount, 2, 3); }
+static void x_scalar2to4(U8 *pDst, const U8 *pSrc, U32 sampleCount) { x_convertScalar(pDst, pSrc, sampleCount, 2, 4); }
+static void x_scalar3to2(U8 *pDst, const U8 *pSrc, U32 sampleCount) { x_convertScalar(pDst, pSrc, sampleCount, 3, 2); }
+static void x_scalar3to4(U8 *pDst, const U8 *pSrc, U32 sampleCount) { x_convertScalar(pDst, pSrc, sampleCount, 3, 4); }
+static void x_scalar4to2(U8 *pDst, const U8 *pSrc, U32 sampleCount) { x_convertScalar(pDst, pSrc, sampleCount, 4, 2); }
+static void x_scalar4to3(U8 *pDst, const U8 *pSrc, U32 sampleCount) { x_convertScalar(pDst, pSrc, sampleCount, 4, 3); }
+
+static void x_scalarSwap2(U8 *pData, U32 sampleCount)
+{
+	while (sampleCount--) {
+		U8 tmp = pData[0];
+		pData[0] = pData[1];
+		pData[1] = tmp;
+		pData += 2;
+	}
+}
+
+static void x_scalarSwap3(U8 *pData, U32 sampleCount)
+{
+	while (sampleCount--) {
+		U8 tmp = pData[0];
+		pData[0] = pData[2];
+		pData[2] = tmp;
+		pData += 3;
+	}
+}
+
+static void x_scalarSwap4(U8 *pData, U32 sampleCount)
+{
+	while (sampleCount--) {
+		U8 tmp = pData[0];
+		pData[0] = pData[3];
+		pData[3] = tmp;
+		tmp = pData[1];
+		pData[1] = pData[2];
+		pData[2] = tmp;
+		pData += 4;
+	}
+}
+
+static openavb_aaf_convert_fn_t x_scalarConvert(U32 key)
+{
+	switch (key) {
+		case CONVERT_KEY(2, 3): return x_scalar2to3;
+		case CONVERT_KEY(2, 4): return x_scalar2to4;
+		case CONVERT_KEY(3, 2): return x_scalar3to2;
+		case CONVERT_KEY(3, 4): return x_scalar3to4;
+		case CONVERT_KEY(4, 2): return x_scalar4to2;
+		case CONVERT_KEY(4, 3): return x_scalar4to3;
+		default: return NULL;
+	}
+}
+
+static openavb_aaf_swap_fn_t x_scalarSwap(U32 sampleBytes)
+{
+	switch (sampleBytes) {
+		case 2: return x_scalarSwap2;
+		case 3: return x_scalarSwap3;
+		case 4: return x_scalarSwap4;
+		default: return NULL;
+	}
+}
+
+#if AAF_CONVERT_X86
+/////////////
+// SSE2 kernels
+/////////////
+
+X86_TARGET("sse2") static void x_sse2_2to4(U8 *pDst, const U8 *pSrc, U32 sampleCount)
+{
+	const __m128i zero = _mm_setzero_si128();
+	U32 i = 0;
+	for ( ; i + 8 <= sampleCount; i += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(pSrc + i * 2));
+		_mm_storeu_si128((__m128i *)(pDst + i * 4), _mm_unpacklo_epi16(v, zero));
+		_mm_storeu_si128((__m128i *)(pDst + i * 4 + 16), _mm_unpackhi_epi16(v, zero));
+	}
+	x_scalar2to4(pDst + i * 4, pSrc + i * 2, sampleCount - i);
+}
+
+X86_TARGET("sse2") static void x_sse2_4to2(U8 *pDst, const U8 *pSrc, U32 sampleCount)
+{
+	U32 i = 0;
+	for ( ; i + 8 <= sampleCount; i += 8) {
+		// Sign extend the first two bytes of each sample so the saturating pack is exact.
+		__m128i a = _mm_loadu_si128((const __m128i *)(pSrc + i * 4));
+		__m128i b = _mm_loadu_si128((const __m128i *)(pSrc + i * 4 + 16));
+		a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+		b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+		_mm_storeu_si128((__m128i *)(pDst + i * 2), _mm_packs_epi32(a, b));
+	}
+	x_scalar4to2(pDst + i * 2, pSrc + i * 4, sampleCount - i);
+}
+
+/////////////
+// SSSE3 kernels
+/////////////
+
+X86_TARGET("ssse3") static void x_ssse3_2to3(U8 *pDst, const U8 *pSrc, U32 sampleCount)
+{
+	const __m128i mask = _mm_setr_epi8(0, 1, -128, 2, 3, -128, 4, 5, -128, 6, 7, -128, -128, -128, -128, -128);
+	U32 i = 0;
+	// 4 samples per pass; the 16 byte store needs 6 samples of room.
+	for ( ; i + 6 <= sampleCount; i += 4) {
+		__m128i v = _mm_loadl_epi64((const __m128i *)(pSrc + i * 2));
+		_mm_storeu_si128((__m128i *)(pDst + i * 3), _mm_shuffle_epi8(v, mask));
+	}
+	x_scalar2to3(pDst + i * 3, pSrc + i * 2, sampleCount - i);
+}
+
+X86_TARGET("ssse3") static void x_ssse3_3to2(U8 *pDst, const U8 *pSrc, U32 sampleCount)
+{
+	const __m128i mask = _mm_setr_epi8(0, 1, 3, 4, 6, 7, 9, 10, -128, -128, -128, -128, -128, -128, -128, -128);
+	U32 i = 0;
+	// 8 samples per pass; the second 16 byte load needs 10 samples of source.
+	for ( ; i + 10 <= sampleCount; i += 8) {
+		__m128i a = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(pSrc + i * 3)), mask);
+		__m128i b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(pSrc + i * 3 + 12)), mask);
+		_mm_storeu_si128((__m128i *)(pDst + i * 2), _mm_unpacklo_epi64(a, b));
+	}
+	x_scalar3to2(pDst + i * 2, pSrc + i * 3, sampleCount - i);
+}
+
+X86_TARGET("ssse3") static void x_ssse3_3to4(U8 *pDst, const U8 *pSrc, U32 sampleCount)
+{
+	const __m128i mask = _mm_setr_epi8(0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128);
+	U32 i = 0;
+	// 4 samples per pass; the 16 byte load needs 6 samples of source.
+	for ( ; i + 6 <= sampleCount; i += 4) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(pSrc + i * 3));
+		_mm_storeu_si128((__m128i *)(pDst + i * 4), _mm_shuffle_epi8(v, mask));
+	}
+	x_scalar3to4(pDst + i * 4, pSrc + i * 3, sampleCount - i);
+}
+
+X86_TARGET("ssse3") static void x_ssse3_4to3(U8 *pDst, const U8 *pSrc, U32 sampleCount)
+{
+	const __m128i mask = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -128, -128, -128, -128);
+	U32 i = 0;
+	// 4 samples per pass; the 16 byte store needs 6 samples of room.
+	for ( ; i + 6 <= sampleCount; i += 4) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(pSrc + i * 4));
+		_mm_storeu_si128((__m128i *)(pDst + i * 3), _mm_shuffle_epi8(v, mask));
+	}
+	x_scalar4to3(pDst + i * 3, pSrc + i * 4, sampleCount - i);
+}
+
+X86_TARGET("ssse3") static void x_ssse3Swap2(U8 *pData, U32 sampleCount)
+{
+	const __m128i mask = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+	U32 i = 0;
+	for ( ; i + 8 <= sampleCount; i += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(pData + i * 2));
+		_mm_storeu_si128((__m128i *)(pData + i * 2), _mm_shuffle_epi8(v, mask));
+	}
+	x_scalarSwap2(pData + i * 2, sampleCount - i);
+}
+
+X86_TARGET("ssse3") static void x_ssse3Swap3(U8 *pData, U32 sampleCount)
+{
+	// 5 samples per pass; byte 15 is written back unchanged.
+	const __m128i mask = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+	U32 i = 0;
+	for ( ; i + 6 <= sampleCount; i += 5) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(pData + i * 3));
+		_mm_storeu_si128((__m128i *)(pData + i * 3), _mm_shuffle_epi8(v, mask));
+	}
+	x_scalarSwap3(pData + i * 3, sampleCount - i);
+}
+
+X86_TARGET("ssse3") static void x_ssse3Swap4(U8 *pData, U32 sampleCount)
+{
+	const __m128i mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	U32 i = 0;
+	for ( ; i + 4 <= sampleCount; i += 4) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(pData + i * 4));
+		_mm_storeu_si128((__m128i *)(pData + i * 4), _mm_shuffle_epi8(v, mask));
+	}
+	x_scalarSwap4(pData + i * 4, sampleCount - i);
+}
+
+/////////////
+// AVX2 kernels
+/////////////
+
+X86_TARGET("avx2") static void x_avx2_2to4(U8 *pDst, const U8 *pSrc, U32 sampleCount)
+{
+	U32 i = 0;
+	for ( ; i + 8 <= sampleCount; i += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(pSrc + i * 2));
+		_mm256_storeu_si256((__m256i *)(pDst + i * 4), _mm256_cvtepu16_epi32(v));
+	}
+	x_scalar2to4(pDst + i * 4, pSrc + i * 2, sampleCount - i);
+}
+
+X86_TARGET("avx2") static void x_avx2_4to2(U8 *pDst, const U8 *pSrc, U32 sampleCount)
+{
+	const __m256i mask = _mm256_setr_epi8(
+		0, 1, 4, 5, 8, 9, 12, 13, -128, -128, -128, -128, -128, -128, -128, -128,
+		0, 1, 4, 5, 8, 9, 12, 13, -128, -128, -128, -128, -128, -128, -128, -128);
+	U32 i = 0;
+	for ( ; i + 8 <= sampleCount; i += 8) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)(pSrc + i * 4));
+		v = _mm256_shuffle_epi8(v, mask);
+		// Gather the low 8 bytes of each 128 bit lane.
+		v = _mm256_permute4x64_epi64(v, 0x08);
+		_mm_storeu_si128((__m128i *)(pDst + i * 2), _mm256_castsi256_si128(v));
+	}
+	x_scalar4to2(pDst + i * 2, pSrc + i * 4, sampleCount - i);
+}
+
+X86_TARGET("avx2") static void x_avx2_3to4(U8 *pDst, const U8 *pSrc, U32 sampleCount)
+{
+	const __m256i mask = _mm256_setr_epi8(
+		0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128,
+		0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128);
+	U32 i = 0;
+	// 8 samples per pass, 4 per lane; the second 16 byte load needs 10 samples of source.
+	for ( ; i + 10 <= sampleCount; i += 8) {
+		__m256i v = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(pSrc + i * 3)));
+		v = _mm256_inserti128_si256(v, _mm_loadu_si128((const __m128i *)(pSrc + i * 3 + 12)), 1);
+		_mm256_storeu_si256((__m256i *)(pDst + i * 4), _mm256_shuffle_epi8(v, mask));
+	}
+	x_ssse3_3to4(pDst + i * 4, pSrc + i * 3, sampleCount - i);
+}
+
+X86_TARGET("avx2") static void x_avx2Swap2(U8 *pData, U32 sampleCount)
+{
+	const __m256i mask = _mm256_setr_epi8(
+		1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+		1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+	U32 i = 0;
+	for ( ; i + 16 <= sampleCount; i += 16) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)(pData + i * 2));
+		_mm256_storeu_si256((__m256i *)(pData + i * 2), _mm256_shuffle_epi8(v, mask));
+	}
+	x_ssse3Swap2(pData + i * 2, sampleCount - i);
+}
+
+X86_TARGET("avx2") static void x_avx2Swap4(U8 *pData, U32 sampleCount)
+{
+	const __m256i mask = _mm256_setr_epi8(
+		3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+		3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	U32 i = 0;
+	for ( ; i + 8 <= sampleCount; i += 8) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)(pData + i * 4));
+		_mm256_storeu_si256((__m256i *)(pData + i * 4), _mm256_shuffle_epi8(v, mask));
+	}
+	x_ssse3Swap4(pData + i * 4, sampleCount - i);
+}
+
+static bool x_cpuHas(const char *isa)
+{
+	__builtin_cpu_init();
+	if (strcmp(isa, "avx2") == 0)
+		return __builtin_cpu_supports("avx2") ? TRUE : FALSE;
+	if (strcmp(isa, "ssse3") == 0)
+		return __builtin_cpu_supports("ssse3") ? TRUE : FALSE;
+	if (strcmp(isa, "sse2") == 0)
+		return __builtin_cpu_supports("sse2") ? TRUE : FALSE;
+	return FALSE;
+}
+
+static openavb_aaf_convert_fn_t x_vectorConvert(U32 key)
+{
+	if (x_cpuHas("avx2")) {
+		switch (key) {
+			case CONVERT_KEY(2, 4): return x_avx2_2to4;
+			case CONVERT_KEY(4, 2): return x_avx2_4to2;
+			case CONVERT_KEY(3, 4): return x_avx2_3to4;
+			default: break;
+		}
+	}
+	if (x_cpuHas("ssse3")) {
+		switch (key) {
+			case CONVERT_KEY(2, 3): return x_ssse3_2to3;
+			case CONVERT_KEY(3, 2): return x_ssse3_3to2;
+			case CONVERT_KEY(3, 4): return x_ssse3_3to4;
+			case CONVERT_KEY(4, 3): return x_ssse3_4to3;
+			default: break;
+		}
+	}
+	if (x_cpuHas("sse2")) {
+		switch (key) {
+			case CONVERT_KEY(2, 4): return x_sse2_2to4;
+			case CONVERT_KEY(4, 2): return x_sse2_4to2;
+			default: break;
+		}
+	}
+	return NULL;
+}
+
+static openavb_aaf_swap_fn_t x_vectorSwap(U32 sampleBytes)
+{
+	if (x_cpuHas("avx2")) {
+		if (sampleBytes == 2) return x_avx2Swap2;
+		if (sampleBytes == 4) return x_avx2Swap4;
+	}
+	if (x_cpuHas("ssse3")) {
+		if (sampleBytes == 2) return x_ssse3Swap2;
+		if (sampleBytes == 3) return x_ssse3Swap3;
+		if (sampleBytes == 4) return x_ssse3Swap4;
+	}
+	return NULL;
+}
+
+const char *openavbAafConvertIsaName(void)
+{
+	if (x_cpuHas("avx2"))
+		return "AVX2";
+	if (x_cpuHas("ssse3"))
+		return "SSSE3";
+	if (x_cpuHas("sse2"))
+		return "SSE2";
+	return "scalar";
+}
+
+#elif AAF_CONVERT_NEON
+/////////////
+// NEON kernels
+/////////////
+
+// The structured loads and stores split and merge the sample bytes, so each
+// kernel handles 16 samples per pass without reading or writing out of bounds.
+
+static void x_neon2to3(U8 *pDst, const U8 *pSrc, U32 sampleCount)
+{
+	U32 i = 0;
+	for ( ; i + 16 <= sampleCount; i += 16) {
+		uint8x16x2_t in = vld2q_u8(pSrc + i * 2);
+		uint8x16x3_t out = { { in.val[0], in.val[1], vdupq_n_u8(0) } };
+		vst3q_u8(pDst + i * 3, out);
+	}
+	x_scalar2to3(pDst + i * 3, pSrc + i * 2, sampleCount - i);
+}
+
+static void x_neon2to4(U8 *pDst, const U8 *pSrc, U32 sampleCount)
+{
+	U32 i = 0;
+	for ( ; i + 16 <= sampleCount; i += 16) {
+		uint8x16x2_t in = vld2q_u8(pSrc + i * 2);
+		uint8x16x4_t out = { { in.val[0], in.val[1], vdupq_n_u8(0), vdupq_n_u8(0) } };
+		vst4q_u8(pDst + i * 4, out);
+	}
+	x_scalar2to4(pDst + i * 4, pSrc + i * 2, sampleCount - i);
+}
+
+static void x_neon3to2(U8 *pDst, const U8 *pSrc, U32 sampleCount)
+{
+	U32 i = 0;
+	for ( ; i + 16 <= sampleCount; i += 16) {
+		uint8x16x3_t in = vld3q_u8(pSrc + i * 3);
+		uint8x16x2_t out = { { in.val[0], in.val[1] } };
+		vst2q_u8(pDst + i * 2, out);
+	}
+	x_scalar3to2(pDst + i * 2, pSrc + i * 3, sampleCount - i);
+}
+
+static void x_neon3to4(U8 *pDst, const U8 *pSrc, U32 sampleCount)
+{
+	U32 i = 0;
+	for ( ; i + 16 <= sampleCount; i += 16) {
+		uint8x16x3_t in = vld3q_u8(pSrc + i * 3);
+		uint8x16x4_t out = { { in.val[0], in.val[1], in.val[2], vdupq_n_u8(0) } };
+		vst4q_u8(pDst + i * 4, out);
+	}
+	x_scalar3to4(pDst + i * 4, pSrc + i * 3, sampleCount - i);
+}
+
+static void x_neon4to2(U8 *pDst, const U8 *pSrc, U32 sampleCount)
+{
+	U32 i = 0;
+	for ( ; i + 16 <= sampleCount; i += 16) {
+		uint8x16x4_t in = vld4q_u8(pSrc + i * 4);
+		uint8x16x2_t out = { { in.val[0], in.val[1] } };
+		vst2q_u8(pDst + i * 2, out);
+	}
+	x_scalar4to2(pDst + i * 2, pSrc + i * 4, sampleCount - i);
+}
+
+static void x_neon4to3(U8 *pDst, const U8 *pSrc, U32 sampleCount)
+{
+	U32 i = 0;
+	for ( ; i + 16 <= sampleCount; i += 16) {
+		uint8x16x4_t in = vld4q_u8(pSrc + i * 4);
+		uint8x16x3_t out = { { in.val[0], in.val[1], in.val[2] } };
+		vst3q_u8(pDst + i * 3, out);
+	}
+	x_scalar4to3(pDst + i * 3, pSrc + i * 4, sampleCount - i);
+}
+
+static void x_neonSwap2(U8 *pData, U32 sampleCount)
+{
+	U32 i = 0;
+	for ( ; i + 8 <= sampleCount; i += 8) {
+		vst1q_u8(pData + i * 2, vrev16q_u8(vld1q_u8(pData + i * 2)));
+	}
+	x_scalarSwap2(pData + i * 2, sampleCount - i);
+}
+
+static void x_neonSwap3(U8 *pData, U32 sampleCount)
+{
+	U32 i = 0;
+	for ( ; i + 16 <= sampleCount; i += 16) {
+		uint8x16x3_t v = vld3q_u8(pData + i * 3);
+		uint8x16_t tmp = v.val[0];
+		v.val[0] = v.val[2];
+		v.val[2] = tmp;
+		vst3q_u8(pData + i * 3, v);
+	}
+	x_scalarSwap3(pData + i * 3, sampleCount - i);
+}
+
+static void x_neonSwap4(U8 *pData, U32 sampleCount)
+{
+	U32 i = 0;
+	for ( ; i + 4 <= sampleCount; i += 4) {
+		vst1q_u8(pData + i * 4, vrev32q_u8(vld1q_u8(pData + i * 4)));
+	}
+	x_scalarSwap4(pData + i * 4, sampleCount - i);
+}
+
+static openavb_aaf_convert_fn_t x_vectorConvert(U32 key)
+{
+	switch (key) {
+		case CONVERT_KEY(2, 3): return x_neon2to3;
+		case CONVERT_KEY(2, 4): return x_neon2to4;
+		case CONVERT_KEY(3, 2): return x_neon3to2;
+		case CONVERT_KEY(3, 4): return x_neon3to4;
+		case CONVERT_KEY(4, 2): return x_neon4to2;
+		case CONVERT_KEY(4, 3): return x_neon4to3;
+		default: return NULL;
+	}
+}
+
+static openavb_aaf_swap_fn_t x_vectorSwap(U32 sampleBytes)
+{
+	switch (sampleBytes) {
+		case 2: return x_neonSwap2;
+		case 3: return x_neonSwap3;
+		case 4: return x_neonSwap4;
+		default: return NULL;
+	}
+}
+
+const char *openavbAafConvertIsaName(void)
+{
+	return "NEON";
+}
+
+#else
+
+static openavb_aaf_convert_fn_t x_vectorConvert(U32 key)
+{
+	return NULL;
+}
+
+static openavb_aaf_swap_fn_t x_vectorSwap(U32 sampleBytes)
+{
+	return NULL;
+}
+
+const char *openavbAafConvertIsaName(void)
+{
+	return "scalar";
+}
+
+#endif
+
+openavb_aaf_convert_fn_t openavbAafConvertSelectScalar(U32 inSampleBytes, U32 outSampleBytes)
+{
+	return x_scalarConvert(CONVERT_KEY(inSampleBytes, outSampleBytes));
+}
+
+openavb_aaf_convert_fn_t openavbAafConvertSelect(U32 inSampleBytes, U32 outSampleBytes)
+{
+	U32 key = CONVERT_KEY(inSampleBytes, outSampleBytes);
+	openavb_aaf_convert_fn_t fn = x_vectorConvert(key);
+	return fn ? fn : x_scalarConvert(key);
+}
+
+openavb_aaf_swap_fn_t openavbAafSwapSelectScalar(U32 sampleBytes)
+{
+	return x_scalarSwap(sampleBytes);
+}
+
+openavb_aaf_swap_fn_t openavbAafSwapSelect(U32 sampleBytes)
+{
+	openavb_aaf_swap_fn_t fn = x_vectorSwap(sampleBytes);
+	return fn ? fn : x_scalarSwap(sampleBytes);
+}
+
+/////////////
+// float32 / int32 item sample encode and decode
+/////////////
+
+#define FULL_SCALE			2147483648.0f
+// Largest float below 2^31; keeps +1.0 from wrapping to the most negative integer.
+#define FULL_SCALE_MAX		2147483520.0f
+
+typedef enum {
+	WORD_COPY = 0,		// Same representation on both sides
+	WORD_FLOAT_TO_INT,	// Float bits in, left justified integer out
+	WORD_INT_TO_FLOAT,	// Left justified integer in, float bits out
+} word_mode_t;
+
+static inline word_mode_t x_encodeMode(bool itemFloat, bool wireFloat)
+{
+	if (itemFloat == wireFloat)
+		return WORD_COPY;
+	return itemFloat ? WORD_FLOAT_TO_INT : WORD_INT_TO_FLOAT;
+}
+
+static inline word_mode_t x_decodeMode(bool itemFloat, bool wireFloat)
+{
+	if (itemFloat == wireFloat)
+		return WORD_COPY;
+	return wireFloat ? WORD_FLOAT_TO_INT : WORD_INT_TO_FLOAT;
+}
+
+static inline U32 x_convertWord(U32 word, word_mode_t mode)
+{
+	float f;
+	switch (mode) {
+		case WORD_FLOAT_TO_INT:
+			memcpy(&f, &word, sizeof(f));
+			f *= FULL_SCALE;
+			// Same ordering as the vector min / max so NaN clips identically.
+			f = (f < FULL_SCALE_MAX) ? f : FULL_SCALE_MAX;
+			f = (f > -FULL_SCALE) ? f : -FULL_SCALE;
+			return (U32)(S32)lrintf(f);
+		case WORD_INT_TO_FLOAT:
+			f = (float)(S32)word * (1.0f / FULL_SCALE);
+			memcpy(&word, &f, sizeof(word));
+			return word;
+		default:
+			return word;
+	}
+}
+
+static inline void x_writeWire(U8 *pDst, U32 word, U32 wireBytes)
+{
+	pDst[0] = word >> 24;
+	pDst[1] = word >> 16;
+	if (wireBytes > 2)
+		pDst[2] = word >> 8;
+	if (wireBytes > 3)
+		pDst[3] = word;
+}
+
+static inline U32 x_readWire(const U8 *pSrc, U32 wireBytes)
+{
+	U32 word = ((U32)pSrc[0] << 24) | ((U32)pSrc[1] << 16);
+	if (wireBytes > 2)
+		word |= (U32)pSrc[2] << 8;
+	if (wireBytes > 3)
+		word |= pSrc[3];
+	return word;
+}
+
+void openavbAafEncodeSamplesScalar(U8 *pDst, U32 dstStride, U32 wireBytes, bool wireFloat,
+	const U8 *pSrc, U32 srcStride, bool itemFloat, U32 count)
+{
+	word_mode_t mode = x_encodeMode(itemFloat, wireFloat);
+	while (count--) {
+		U32 word;
+		memcpy(&word, pSrc, sizeof(word));
+		x_writeWire(pDst, x_convertWord(word, mode), wireBytes);
+		pSrc += srcStride;
+		pDst += dstStride;
+	}
+}
+
+void openavbAafDecodeSamplesScalar(U8 *pDst, U32 dstStride, bool itemFloat,
+	const U8 *pSrc, U32 srcStride, U32 wireBytes, bool wireFloat, U32 count)
+{
+	word_mode_t mode = x_decodeMode(itemFloat, wireFloat);
+	while (count--) {
+		U32 word = x_convertWord(x_readWire(pSrc, wireBytes), mode);
+		memcpy(pDst, &word, sizeof(word));
+		pSrc += srcStride;
+		pDst += dstStride;
+	}
+}
+
+#if AAF_CONVERT_X86 && defined(__SSE2__)
+
+static inline __m128i x_sse2ConvertWords(__m128i v, word_mode_t mode)
+{
+	if (mode == WORD_FLOAT_TO_INT) {
+		__m128 f = _mm_mul_ps(_mm_castsi128_ps(v), _mm_set1_ps(FULL_SCALE));
+		f = _mm_min_ps(f, _mm_set1_ps(FULL_SCALE_MAX));
+		f = _mm_max_ps(f, _mm_set1_ps(-FULL_SCALE));
+		return _mm_cvtps_epi32(f);
+	}
+	if (mode == WORD_INT_TO_FLOAT) {
+		return _mm_castps_si128(_mm_mul_ps(_mm_cvtepi32_ps(v), _mm_set1_ps(1.0f / FULL_SCALE)));
+	}
+	return v;
+}
+
+static inline __m128i x_sse2Bswap32(__m128i v)
+{
+	v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+	return _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xb1), 0xb1);
+}
+
+void openavbAafEncodeSamples(U8 *pDst, U32 dstStride, U32 wireBytes, bool wireFloat,
+	const U8 *pSrc, U32 srcStride, bool itemFloat, U32 count)
+{
+	word_mode_t mode = x_encodeMode(itemFloat, wireFloat);
+	U32 i = 0;
+	for ( ; i + 4 <= count; i += 4) {
+		U32 words[4];
+		__m128i v;
+		if (srcStride == 4) {
+			v = _mm_loadu_si128((const __m128i *)pSrc);
+		}
+		else {
+			memcpy(&words[0], pSrc, 4);
+			memcpy(&words[1], pSrc + srcStride, 4);
+			memcpy(&words[2], pSrc + 2 * srcStride, 4);
+			memcpy(&words[3], pSrc + 3 * srcStride, 4);
+			v = _mm_loadu_si128((const __m128i *)words);
+		}
+		v = x_sse2ConvertWords(v, mode);
+		if (dstStride == 4 && wireBytes == 4) {
+			_mm_storeu_si128((__m128i *)pDst, x_sse2Bswap32(v));
+		}
+		else {
+			_mm_storeu_si128((__m128i *)words, v);
+			x_writeWire(pDst, words[0], wireBytes);
+			x_writeWire(pDst + dstStride, words[1], wireBytes);
+			x_writeWire(pDst + 2 * dstStride, words[2], wireBytes);
+			x_writeWire(pDst + 3 * dstStride, words[3], wireBytes);
+		}
+		pSrc += 4 * srcStride;
+		pDst += 4 * dstStride;
+	}
+	openavbAafEncodeSamplesScalar(pDst, dstStride, wireBytes, wireFloat, pSrc, srcStride, itemFloat, count - i);
+}
+
+void openavbAafDecodeSamples(U8 *pDst, U32 dstStride, bool itemFloat,
+	const U8 *pSrc, U32 srcStride, U32 wireBytes, bool wireFloat, U32 count)
+{
+	word_mode_t mode = x_decodeMode(itemFloat, wireFloat);
+	U32 i = 0;
+	for ( ; i + 4 <= count; i += 4) {
+		U32 words[4];
+		__m128i v;
+		if (srcStride == 4 && wireBytes == 4) {
+			v = x_sse2Bswap32(_mm_loadu_si128((const __m128i *)pSrc));
+		}
+		else {
+			words[0] = x_readWire(pSrc, wireBytes);
+			words[1] = x_readWire(pSrc + srcStride, wireBytes);
+			words[2] = x_readWire(pSrc + 2 * srcStride, wireBytes);
+			words[3] = x_readWire(pSrc + 3 * srcStride, wireBytes);
+			v = _mm_loadu_si128((const __m128i *)words);
+		}
+		v = x_sse2ConvertWords(v, mode);
+		if (dstStride == 4) {
+			_mm_storeu_si128((__m128i *)pDst, v);
+		}
+		else {
+			_mm_storeu_si128((__m128i *)words, v);
+			memcpy(pDst, &words[0], 4);
+			memcpy(pDst + dstStride, &words[1], 4);
+			memcpy(pDst + 2 * dstStride, &words[2], 4);
+			memcpy(pDst + 3 * dstStride, &words[3], 4);
+		}
+		pSrc += 4 * srcStride;
+		pDst += 4 * dstStride;
+	}
+	openavbAafDecodeSamplesScalar(pDst, dstStride, itemFloat, pSrc, srcStride, wireBytes, wireFloat, count - i);
+}
+
+#elif AAF_CONVERT_NEON && defined(__aarch64__)
+
+static inline uint32x4_t x_neonConvertWords(uint32x4_t v, word_mode_t mode)
+{
+	if (mode == WORD_FLOAT_TO_INT) {
+		const float32x4_t max = vdupq_n_f32(FULL_SCALE_MAX);
+		const float32x4_t min = vdupq_n_f32(-FULL_SCALE);
+		float32x4_t f = vmulq_n_f32(vreinterpretq_f32_u32(v), FULL_SCALE);
+		f = vbslq_f32(vcltq_f32(f, max), f, max);
+		f = vbslq_f32(vcgtq_f32(f, min), f, min);
+		return vreinterpretq_u32_s32(vcvtnq_s32_f32(f));
+	}
+	if (mode == WORD_INT_TO_FLOAT) {
+		float32x4_t f = vmulq_n_f32(vcvtq_f32_s32(vreinterpretq_s32_u32(v)), 1.0f / FULL_SCALE);
+		return vreinterpretq_u32_f32(f);
+	}
+	return v;
+}
+
+static inline uint32x4_t x_neonBswap32(uint32x4_t v)
+{
+	return vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(v)));
+}
+
+void openavbAafEncodeSamples(U8 *pDst, U32 dstStride, U32 wireBytes, bool wireFloat,
+	const U8 *pSrc, U32 srcStride, bool itemFloat, U32 count)
+{
+	word_mode_t mode = x_encodeMode(itemFloat, wireFloat);
+	U32 i = 0;
+	for ( ; i + 4 <= count; i += 4) {
+		U32 words[4];
+		uint32x4_t v;
+		if (srcStride == 4) {
+			v = vreinterpretq_u32_u8(vld1q_u8(pSrc));
+		}
+		else {
+			memcpy(&words[0], pSrc, 4);
+			memcpy(&words[1], pSrc + srcStride, 4);
+			memcpy(&words[2], pSrc + 2 * srcStride, 4);
+			memcpy(&words[3], pSrc + 3 * srcStride, 4);
+			v = vld1q_u32(words);
+		}
+		v = x_neonConvertWords(v, mode);
+		if (dstStride == 4 && wireBytes == 4) {
+			vst1q_u8(pDst, vreinterpretq_u8_u32(x_neonBswap32(v)));
+		}
+		else {
+			vst1q_u32(words, v);
+			x_writeWire(pDst, words[0], wireBytes);
+			x_writeWire(pDst + dstStride, words[1], wireBytes);
+			x_writeWire(pDst + 2 * dstStride, words[2], wireBytes);
+			x_writeWire(pDst + 3 * dstStride, words[3], wireBytes);
+		}
+		pSrc += 4 * srcStride;
+		pDst += 4 * dstStride;
+	}
+	openavbAafEncodeSamplesScalar(pDst, dstStride, wireBytes, wireFloat, pSrc, srcStride, itemFloat, count - i);
+}
+
+void openavbAafDecodeSamples(U8 *pDst, U32 dstStride, bool itemFloat,
+	const U8 *pSrc, U32 srcStride, U32 wireBytes, bool wireFloat, U32 count)
+{
+	word_mode_t mode = x_decodeMode(itemFloat, wireFloat);
+	U32 i = 0;
+	for ( ; i + 4 <= count; i += 4) {
+		U32 words[4];
+		uint32x4_t v;
+		if (srcStride == 4 && wireBytes == 4) {
+			v = x_neonBswap32(vreinterpretq_u32_u8(vld1q_u8(pSrc)));
+		}
+		else {
+			words[0] = x_readWire(pSrc, wireBytes);
+			words[1] = x_readWire(pSrc + srcStride, wireBytes);
+			words[2] = x_readWire(pSrc + 2 * srcStride, wireBytes);
+			words[3] = x_readWire(pSrc + 3 * srcStride, wireBytes);
+			v = vld1q_u32(words);
+		}
+		v = x_neonConvertWords(v, mode);
+		if (dstStride == 4) {
+			vst1q_u8(pDst, vreinterpretq_u8_u32(v));
+		}
+		else {
+			vst1q_u32(words, v);
+			memcpy(pDst, &words[0], 4);
+			memcpy(pDst + dstStride, &words[1], 4);
+			memcpy(pDst + 2 * dstStride, &words[2], 4);
+			memcpy(pDst + 3 * dstStride, &words[3], 4);
+		}
+		pSrc += 4 * srcStride;
+		pDst += 4 * dstStride;
+	}
+	openavbAafDecodeSamplesScalar(pDst, dstStride, itemFloat, pSrc, srcStride, wireBytes, wireFloat, count - i);
+}
+
+#else
+
+void openavbAafEncodeSamples(U8 *pDst, U32 dstStride, U32 wireBytes, bool wireFloat,
+	const U8 *pSrc, U32 srcStride, bool itemFloat, U32 count)
+{
+	openavbAafEncodeSamplesScalar(pDst, dstStride, wireBytes, wireFloat, pSrc, srcStride, itemFloat, count);
+}
+
+void openavbAafDecodeSamples(U8 *pDst, U32 dstStride, bool itemFloat,
+	const U8 *pSrc, U32 srcStride, U32 wireBytes, bool wireFloat, U32 count)
+{
+	openavbAafDecodeSamplesScalar(pDst, dstStride, itemFloat, pSrc, srcStride, wireBytes, wireFloat, count);
+}
+
+#endif
@@ -0,0 +1,92 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+ 
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ 
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ 
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+Attributions: The inih library portion of the source code is licensed from 
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt. 
+Complete license and copyright information can be found at 
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* HEADER SUMMARY : AAF integer sample format conversion kernels.
+*
+* AAF carries integer samples big-endian, most significant byte first. Converting
+* between the 32, 24 and 16 bit integer formats is therefore a matter of padding
+* trailing zero bytes (IEEE 1722-2016 Clause 7.3.4) or dropping trailing bytes.
+* The kernels write directly into the destination buffer; vector implementations
+* are chosen at run time where the CPU supports them.
+*
+* The encode / decode functions convert between host order float32 or int32
+* media queue samples and any AAF wire format. Strides are in bytes, so a single
+* call can walk one channel of a planar or interleaved buffer.
+*/
+
+#ifndef OPENAVB_MAP_AAF_AUDIO_CONVERT_H
+#define OPENAVB_MAP_AAF_AUDIO_CONVERT_H 1
+
+#include "openavb_types_pub.h"
+
+// Convert sampleCount samples from pSrc into pDst. Buffers must not overlap.
+typedef void (*openavb_aaf_convert_fn_t)(U8 *pDst, const U8 *pSrc, U32 sampleCount);
+
+// In place byte order reversal of sampleCount samples.
+typedef void (*openavb_aaf_swap_fn_t)(U8 *pData, U32 sampleCount);
+
+// Returns the fastest kernel available to pad or truncate samples of inSampleBytes
+// to outSampleBytes (each 2, 3 or 4), or NULL if the combination is not supported.
+openavb_aaf_convert_fn_t openavbAafConvertSelect(U32 inSampleBytes, U32 outSampleBytes);
+
+// Returns the scalar reference kernel for the same combinations.
+openavb_aaf_convert_fn_t openavbAafConvertSelectScalar(U32 inSampleBytes, U32 outSampleBytes);
+
+// Returns the fastest kernel to byte swap samples of sampleBytes (2, 3 or 4),
+// or NULL if not supported. Intended for interface rx translate callbacks that
+// need host order samples.
+openavb_aaf_swap_fn_t openavbAafSwapSelect(U32 sampleBytes);
+
+// Returns the scalar reference byte swap kernel.
+openavb_aaf_swap_fn_t openavbAafSwapSelectScalar(U32 sampleBytes);
+
+// Encode count host order item samples (float32 when itemFloat, else int32) read
+// every srcStride bytes from pSrc into wire samples of wireBytes (2, 3 or 4; float
+// when wireFloat) written every dstStride bytes to pDst. Floats are full scale at
+// +/-1.0 and are clipped; integers are left justified.
+void openavbAafEncodeSamples(U8 *pDst, U32 dstStride, U32 wireBytes, bool wireFloat,
+	const U8 *pSrc, U32 srcStride, bool itemFloat, U32 count);
+
+// Decode count wire samples into host order item samples; the inverse of openavbAafEncodeSamples.
+void openavbAafDecodeSamples(U8 *pDst, U32 dstStride, bool itemFloat,
+	const U8 *pSrc, U32 srcStride, U32 wireBytes, bool wireFloat, U32 count);
+
+// Scalar reference versions of the encode / decode functions.
+void openavbAafEncodeSamplesScalar(U8 *pDst, U32 dstStride, U32 wireBytes, bool wireFloat,
+	const U8 *pSrc, U32 srcStride, bool itemFloat, U32 count);
+void openavbAafDecodeSamplesScalar(U8 *pDst, U32 dstStride, bool itemFloat,
+	const U8 *pSrc, U32 srcStride, U32 wireBytes, bool wireFloat, U32 count);
+
+// Name of the instruction set the selected kernels use, for logging.
+const char *openavbAafConvertIsaName(void);
+
+#endif // OPENAVB_MAP_AAF_AUDIO_CONVERT_H
@@ -50,4 +50,28 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 // that is why a single static (static/extern pattern) definition can not be used.
 #define MapAVTPAudioMediaQDataFormat "AVTPAudioFormat"
 
+/** Sample representation in the media queue items (map_nv_item_format).
+ */
+typedef enum {
+	/// Items hold samples exactly as they are carried on the wire (default)
+	AAF_ITEM_FORMAT_WIRE = 0,
+	/// Host order 32 bit float, full scale is +/-1.0
+	AAF_ITEM_FORMAT_FLOAT32,
+	/// Host order signed 32 bit integer, left justified
+	AAF_ITEM_FORMAT_INT32,
+} aaf_item_format_t;
+
+/** Channel layout of the media queue items (map_nv_item_layout).
+ * Only used when the item format is not AAF_ITEM_FORMAT_WIRE.
+ */
+typedef enum {
+	/// Frames of one sample per channel (default)
+	AAF_ITEM_LAYOUT_INTERLEAVED = 0,
+	/// One block of framesPerItem samples per channel
+	AAF_ITEM_LAYOUT_PLANAR,
+} aaf_item_layout_t;
+
+/// Largest number of entries accepted in map_nv_channel_map
+#define AAF_CHANNEL_MAP_MAX	64
+
 #endif  // OPENAVB_MAP_AVTP_AUDIO_PUB_H
@@ -0,0 +1,648 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+ 
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ 
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ 
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+Attributions: The inih library portion of the source code is licensed from 
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt. 
+Complete license and copyright information can be found at 
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+ * MODULE SUMMARY : Implementation for CRF mapping module
+ *
+ * CRF (Clock Reference Format) is defined in IEEE 1722-2016 Clause 10.
+ *
+ * The talker synthesizes the media clock with openavb_mcs and places
+ * several timestamps into every AVTPDU, so a low packet rate can carry
+ * a high rate reference clock. The listener hands every received timestamp
+ * to the media clock recovery and passes the timestamps on to the interface
+ * module in the media queue.
+ *
+ *----------------------------------------------------------------*
+ *
+ * HEADERS
+ *
+ *  -+-+-+-+-+-+-+-|-+-+-+-+-+-+-+-|-+-+-+-+-+-+-+-|-+-+-+-+-+-+-+-
+ * |C|             |S|     |M| |F|T|               |               |
+ * |D|subtype      |V|vers |R|R|S|U|sequence number|type           |
+ * --+-+-+-+-+-+-+-|-+-+-+-+-+-+-+-|-+-+-+-+-+-+-+-|-+-+-+-+-+-+-+--
+ * |                                                               |
+ * |stream id                                                      |
+ * --+-+-+-+-+-+-+-|-+-+-+-+-+-+-+-|-+-+-+-+-+-+-+-|-+-+-+-+-+-+-+--
+ * |pull |base frequency                                           |
+ * --+-+-+-+-+-+-+-|-+-+-+-+-+-+-+-|-+-+-+-+-+-+-+-|-+-+-+-+-+-+-+--
+ * |crf data length                |timestamp interval             |
+ * --+-+-+-+-+-+-+-|-+-+-+-+-+-+-+-|-+-+-+-+-+-+-+-|-+-+-+-+-+-+-+--
+ * |crf data (64 bit timestamps)                                   |
+ *  -+-+-+-+-+-+-+-|-+-+-+-+-+-+-+-|-+-+-+-+-+-+-+-|-+-+-+-+-+-+-+-
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "openavb_platform_pub.h"
+#include "openavb_mcr_hal_pub.h"
+#include "openavb_types_pub.h"
+#include "openavb_trace_pub.h"
+#include "openavb_avtp_time_pub.h"
+#include "openavb_mediaq_pub.h"
+#include "openavb_map_pub.h"
+#include "openavb_mcs.h"
+#include "openavb_map_crf_pub.h"
+
+#define	AVB_LOG_COMPONENT	"CRF Mapping"
+#include "openavb_log_pub.h"
+
+#define AVTP_SUBTYPE_CRF			4
+
+// Header sizes (bytes)
+#define AVTP_V0_HEADER_SIZE			12
+#define CRF_HEADER_SIZE				8
+#define TOTAL_HEADER_SIZE			(AVTP_V0_HEADER_SIZE + CRF_HEADER_SIZE)
+
+// Size of a single CRF timestamp (bytes)
+#define CRF_TIMESTAMP_SIZE			8
+
+// Max number of timestamps that fit into an ethernet frame
+#define CRF_MAX_TIMESTAMPS_PER_PDU	((1500 - TOTAL_HEADER_SIZE) / CRF_TIMESTAMP_SIZE)
+
+// - 1 Byte - FS (frame sync) and TU (timestamp uncertain) bits
+#define HIDX_AVTP_HIDE7_FS_TU		1
+#define FS_BIT						(1 << 1)
+#define TU_BIT						(1 << 0)
+
+// - 1 Byte - CRF type
+#define HIDX_CRF_TYPE8				3
+
+// - 4 Bytes - pull and base frequency
+#define HIDX_CRF_PULL_BASE_FREQ32	12
+
+// - 2 Bytes - crf data length
+#define HIDX_CRF_DATA_LEN16			16
+
+// - 2 Bytes - timestamp interval
+#define HIDX_CRF_TS_INTERVAL16		18
+
+typedef struct {
+	/////////////
+	// Config data
+	/////////////
+	// map_nv_item_count
+	U32 itemCount;
+
+	// Transmit interval in frames per second. 0 = derive from the clock configuration.
+	U32 txInterval;
+
+	// MCR mode
+	avb_audio_mcr_t audioMcr;
+
+	// MCR clock recovery interval
+	U32 mcrRecoveryInterval;
+
+	/////////////
+	// Variable data
+	/////////////
+	U32 maxTransitUsec;     // In microseconds
+
+	U32 payloadSize;
+
+	// Media clock synthesis for the talker
+	mcs_t mcs;
+
+	bool dataValid;
+
+} pvt_data_t;
+
+// Returns the clock frequency with the pull applied as a fraction.
+static bool x_pullFraction(crf_pull_t pull, U32 *pNum, U32 *pDen)
+{
+	switch (pull) {
+		case CRF_PULL_1_1:
+			*pNum = 1; *pDen = 1;
+			return TRUE;
+		case CRF_PULL_1_1001:
+			*pNum = 1000; *pDen = 1001;
+			return TRUE;
+		case CRF_PULL_1001_1:
+			*pNum = 1001; *pDen = 1000;
+			return TRUE;
+		case CRF_PULL_24_25:
+			*pNum = 24; *pDen = 25;
+			return TRUE;
+		case CRF_PULL_25_24:
+			*pNum = 25; *pDen = 24;
+			return TRUE;
+		case CRF_PULL_1_8:
+			*pNum = 1; *pDen = 8;
+			return TRUE;
+		default:
+			*pNum = 1; *pDen = 1;
+			return FALSE;
+	}
+}
+
+static void x_calculateSizes(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MAP);
+
+	if (pMediaQ) {
+		media_q_pub_map_crf_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private mapping module data not allocated.");
+			return;
+		}
+
+		if (pPubMapInfo->timestampsPerPdu == 0 || pPubMapInfo->timestampsPerPdu > CRF_MAX_TIMESTAMPS_PER_PDU) {
+			AVB_LOGF_ERROR("Invalid timestamps per PDU (%d), using 1", pPubMapInfo->timestampsPerPdu);
+			pPubMapInfo->timestampsPerPdu = 1;
+		}
+		if (pPubMapInfo->timestampInterval == 0 || pPubMapInfo->timestampInterval > 0xFFFF) {
+			AVB_LOGF_ERROR("Invalid timestamp interval (%d), using 1", pPubMapInfo->timestampInterval);
+			pPubMapInfo->timestampInterval = 1;
+		}
+		if (pPubMapInfo->baseFrequency == 0 || pPubMapInfo->baseFrequency > 0x1FFFFFFF) {
+			AVB_LOGF_ERROR("Invalid base frequency (%d), using 48000", pPubMapInfo->baseFrequency);
+			pPubMapInfo->baseFrequency = 48000;
+		}
+
+		U32 num, den;
+		if (!x_pullFraction(pPubMapInfo->pull, &num, &den)) {
+			AVB_LOGF_ERROR("Invalid pull (%d), using 0", pPubMapInfo->pull);
+			pPubMapInfo->pull = CRF_PULL_1_1;
+		}
+
+		// Period between timestamps, kept as integer nanoseconds plus a correction
+		// in tenths of a nanosecond. Same scheme as the fixed timestamp mode of the audio interfaces.
+		U64 per = NANOSECONDS_PER_SECOND * pPubMapInfo->timestampInterval * den * 10;
+		U64 rate = (U64)pPubMapInfo->baseFrequency * num;
+		U64 rem = (per / 10) % rate;
+		pPubMapInfo->timestampPeriodNSec = (per / 10) / rate;
+		if (rem != 0) {
+			rem *= 10;
+			rem /= rate;
+		}
+		openavbMcsInit(&pPvtData->mcs, pPubMapInfo->timestampPeriodNSec, rem, 10);
+
+		if (pPvtData->txInterval == 0) {
+			// One AVTPDU per group of timestamps
+			U64 tsPerSecond = rate / ((U64)pPubMapInfo->timestampInterval * den);
+			pPvtData->txInterval = tsPerSecond / pPubMapInfo->timestampsPerPdu;
+			if (pPvtData->txInterval == 0) {
+				pPvtData->txInterval = 1;
+			}
+		}
+		else {
+			U64 pduPeriodNSec = pPubMapInfo->timestampPeriodNSec * pPubMapInfo->timestampsPerPdu;
+			if (pduPeriodNSec * pPvtData->txInterval < NANOSECONDS_PER_SECOND - pduPeriodNSec
+				|| pduPeriodNSec * pPvtData->txInterval > NANOSECONDS_PER_SECOND + pduPeriodNSec) {
+				AVB_LOGF_WARNING("TX rate (%d) does not match the CRF timestamp rate, the talker will drift", pPvtData->txInterval);
+			}
+		}
+
+		pPvtData->payloadSize = pPubMapInfo->timestampsPerPdu * CRF_TIMESTAMP_SIZE;
+		pPubMapInfo->itemSize = pPvtData->payloadSize;
+
+		AVB_LOGF_INFO("CRF type=%d base_frequency=%d pull=%d timestamp_interval=%d",
+			pPubMapInfo->crfType, pPubMapInfo->baseFrequency, pPubMapInfo->pull, pPubMapInfo->timestampInterval);
+		AVB_LOGF_INFO("timestamps/packet=%d period=%lluns (+%llu/10) => tx rate=%d payloadSz=%d",
+			pPubMapInfo->timestampsPerPdu, pPubMapInfo->timestampPeriodNSec, rem, pPvtData->txInterval, pPvtData->payloadSize);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MAP);
+}
+
+// Each configuration name value pair for this mapping will result in this callback being called.
+void openavbMapCrfCfgCB(media_q_t *pMediaQ, const char *name, const char *value)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MAP);
+
+	if (pMediaQ) {
+		media_q_pub_map_crf_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private mapping module data not allocated.");
+			return;
+		}
+
+		if (strcmp(name, "map_nv_item_count") == 0) {
+			char *pEnd;
+			pPvtData->itemCount = strtol(value, &pEnd, 10);
+		}
+		else if (strcmp(name, "map_nv_tx_rate") == 0
+			|| strcmp(name, "map_nv_tx_interval") == 0) {
+			char *pEnd;
+			pPvtData->txInterval = strtol(value, &pEnd, 10);
+		}
+		else if (strcmp(name, "map_nv_crf_type") == 0) {
+			char *pEnd;
+			pPubMapInfo->crfType = (crf_type_t)strtol(value, &pEnd, 10);
+		}
+		else if (strcmp(name, "map_nv_base_frequency") == 0) {
+			char *pEnd;
+			pPubMapInfo->baseFrequency = strtol(value, &pEnd, 10);
+		}
+		else if (strcmp(name, "map_nv_pull") == 0) {
+			char *pEnd;
+			pPubMapInfo->pull = (crf_pull_t)strtol(value, &pEnd, 10);
+		}
+		else if (strcmp(name, "map_nv_timestamp_interval") == 0) {
+			char *pEnd;
+			pPubMapInfo->timestampInterval = strtol(value, &pEnd, 10);
+		}
+		else if (strcmp(name, "map_nv_timestamps_per_pdu") == 0) {
+			char *pEnd;
+			pPubMapInfo->timestampsPerPdu = strtol(value, &pEnd, 10);
+		}
+		else if (strcmp(name, "map_nv_audio_mcr") == 0) {
+			char *pEnd;
+			pPvtData->audioMcr = (avb_audio_mcr_t)strtol(value, &pEnd, 10);
+		}
+		else if (strcmp(name, "map_nv_mcr_recovery_interval") == 0) {
+			char *pEnd;
+			pPvtData->mcrRecoveryInterval = strtol(value, &pEnd, 10);
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MAP);
+}
+
+U8 openavbMapCrfSubtypeCB()
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MAP);
+	AVB_TRACE_EXIT(AVB_TRACE_MAP);
+	return AVTP_SUBTYPE_CRF;        // CRF AVB subtype
+}
+
+// Returns the AVTP version used by this mapping
+U8 openavbMapCrfAvtpVersionCB()
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MAP_DETAIL);
+	AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+	return 0x00;        // Version 0
+}
+
+U16 openavbMapCrfMaxDataSizeCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MAP);
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private mapping module data not allocated.");
+			return 0;
+		}
+
+		AVB_TRACE_EXIT(AVB_TRACE_MAP);
+		return pPvtData->payloadSize + TOTAL_HEADER_SIZE;
+	}
+	AVB_TRACE_EXIT(AVB_TRACE_MAP);
+	return 0;
+}
+
+// Returns the intended transmit interval (in frames per second). 0 = default for talker / class.
+U32 openavbMapCrfTransmitIntervalCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MAP);
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private mapping module data not allocated.");
+			return 0;
+		}
+
+		AVB_TRACE_EXIT(AVB_TRACE_MAP);
+		return pPvtData->txInterval;
+	}
+	AVB_TRACE_EXIT(AVB_TRACE_MAP);
+	return 0;
+}
+
+void openavbMapCrfGenInitCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MAP);
+	if (pMediaQ) {
+		media_q_pub_map_crf_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private mapping module data not allocated.");
+			return;
+		}
+
+		x_calculateSizes(pMediaQ);
+		openavbMediaQSetSize(pMediaQ, pPvtData->itemCount, pPubMapInfo->itemSize);
+
+		pPvtData->dataValid = TRUE;
+	}
+	AVB_TRACE_EXIT(AVB_TRACE_MAP);
+}
+
+// A call to this callback indicates that this mapping module will be
+// a talker. Any talker initialization can be done in this function.
+void openavbMapCrfTxInitCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MAP);
+	AVB_TRACE_EXIT(AVB_TRACE_MAP);
+}
+
+// This talker callback will be called for each AVB observation interval.
+tx_cb_ret_t openavbMapCrfTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MAP_DETAIL);
+
+	if (!pMediaQ) {
+		AVB_LOG_ERROR("Mapping module invalid MediaQ");
+		AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+		return TX_CB_RET_PACKET_NOT_READY;
+	}
+
+	if (!pData || !dataLen) {
+		AVB_LOG_ERROR("Mapping module data or data length argument incorrect.");
+		AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+		return TX_CB_RET_PACKET_NOT_READY;
+	}
+
+	media_q_pub_map_crf_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+	pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+	if (!pPvtData) {
+		AVB_LOG_ERROR("Private mapping module data not allocated.");
+		AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+		return TX_CB_RET_PACKET_NOT_READY;
+	}
+
+	if ((*dataLen - TOTAL_HEADER_SIZE) < pPvtData->payloadSize) {
+		AVB_LOG_ERROR("Not enough room in packet for payload");
+		AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+		return TX_CB_RET_PACKET_NOT_READY;
+	}
+
+	// The timestamps are synthesized here, any media queue items from the interface module only pace the stream.
+	media_q_item_t *pMediaQItem = openavbMediaQTailLock(pMediaQ, TRUE);
+	if (pMediaQItem) {
+		openavbMediaQTailPull(pMediaQ);
+	}
+
+	U8 *pHdrV0 = pData;
+	U32 *pHdr = (U32 *)(pData + AVTP_V0_HEADER_SIZE);
+	U8  *pPayload = pData + TOTAL_HEADER_SIZE;
+
+	// The common stream header fills gv/tv, in CRF the same bits are fs/tu.
+	pHdrV0[HIDX_AVTP_HIDE7_FS_TU] &= ~(FS_BIT | TU_BIT);
+	pHdrV0[HIDX_CRF_TYPE8] = pPubMapInfo->crfType;
+
+	// - 4 bytes	pull, base frequency
+	*pHdr++ = htonl(((U32)pPubMapInfo->pull << 29) | (pPubMapInfo->baseFrequency & 0x1FFFFFFF));
+
+	// - 4 bytes	crf data length, timestamp interval
+	*pHdr++ = htonl((pPvtData->payloadSize << 16) | (pPubMapInfo->timestampInterval & 0xFFFF));
+
+	// - N * 8 bytes	crf data
+	U32 i1;
+	for (i1 = 0; i1 < pPubMapInfo->timestampsPerPdu; i1++) {
+		openavbMcsAdvance(&pPvtData->mcs);
+		U64 timestamp = htonll(pPvtData->mcs.edgeTime + ((U64)pPvtData->maxTransitUsec * NANOSECONDS_PER_USEC));
+		// The crf data is only 32 bit aligned
+		memcpy(pPayload, &timestamp, CRF_TIMESTAMP_SIZE);
+		pPayload += CRF_TIMESTAMP_SIZE;
+	}
+
+	// Set out bound data length (entire packet length)
+	*dataLen = pPvtData->payloadSize + TOTAL_HEADER_SIZE;
+
+	AVB_TRACE_LINE(AVB_TRACE_MAP_LINE);
+	AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+	return TX_CB_RET_PACKET_READY;
+}
+
+// A call to this callback indicates that this mapping module will be
+// a listener. Any listener initialization can be done in this function.
+void openavbMapCrfRxInitCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MAP);
+	if (pMediaQ) {
+		media_q_pub_map_crf_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private mapping module data not allocated.");
+			return;
+		}
+		if (pPvtData->audioMcr != AVB_MCR_NONE) {
+			// Every timestamp is one push into the media clock recovery.
+			U32 timestampRate = pPvtData->txInterval * pPubMapInfo->timestampsPerPdu;
+			HAL_INIT_MCR_V2(timestampRate, 1, pPubMapInfo->timestampInterval, pPvtData->mcrRecoveryInterval);
+		}
+	}
+	AVB_TRACE_EXIT(AVB_TRACE_MAP);
+}
+
+// This callback occurs when running as a listener and data is available.
+bool openavbMapCrfRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MAP_DETAIL);
+	if (pMediaQ && pData) {
+		U8 *pHdrV0 = pData;
+		U32 *pHdr = (U32 *)(pData + AVTP_V0_HEADER_SIZE);
+		U8  *pPayload = pData + TOTAL_HEADER_SIZE;
+		media_q_pub_map_crf_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private mapping module data not allocated.");
+			return FALSE;
+		}
+
+		bool dataValid = TRUE;
+		U32 tmp;
+
+		if (dataLen < TOTAL_HEADER_SIZE) {
+			if (pPvtData->dataValid)
+				AVB_LOGF_ERROR("Packet too short for CRF header (%d)", dataLen);
+			dataValid = FALSE;
+		}
+		else {
+			U32 pull_base_freq = ntohl(*pHdr++);
+			U32 len_interval = ntohl(*pHdr++);
+			U16 crfDataLen = len_interval >> 16;
+
+			if ((tmp = pHdrV0[HIDX_CRF_TYPE8]) != pPubMapInfo->crfType) {
+				if (pPvtData->dataValid)
+					AVB_LOGF_ERROR("Listener CRF type (%d) doesn't match received data (%d)",
+						pPubMapInfo->crfType, tmp);
+				dataValid = FALSE;
+			}
+			if ((tmp = pull_base_freq >> 29) != pPubMapInfo->pull) {
+				if (pPvtData->dataValid)
+					AVB_LOGF_ERROR("Listener pull (%d) doesn't match received data (%d)",
+						pPubMapInfo->pull, tmp);
+				dataValid = FALSE;
+			}
+			if ((tmp = pull_base_freq & 0x1FFFFFFF) != pPubMapInfo->baseFrequency) {
+				if (pPvtData->dataValid)
+					AVB_LOGF_ERROR("Listener base frequency (%d) doesn't match received data (%d)",
+						pPubMapInfo->baseFrequency, tmp);
+				dataValid = FALSE;
+			}
+			if ((tmp = len_interval & 0xFFFF) != pPubMapInfo->timestampInterval) {
+				if (pPvtData->dataValid)
+					AVB_LOGF_ERROR("Listener timestamp interval (%d) doesn't match received data (%d)",
+						pPubMapInfo->timestampInterval, tmp);
+				dataValid = FALSE;
+			}
+			if (crfDataLen != pPvtData->payloadSize || crfDataLen > dataLen - TOTAL_HEADER_SIZE) {
+				if (pPvtData->dataValid)
+					AVB_LOGF_ERROR("Listener crf data length (%d) doesn't match received data (%d of %d)",
+						pPvtData->payloadSize, crfDataLen, dataLen - TOTAL_HEADER_SIZE);
+				dataValid = FALSE;
+			}
+		}
+
+		if (dataValid) {
+			if (!pPvtData->dataValid) {
+				AVB_LOG_INFO("RX data valid, stream un-muted");
+				pPvtData->dataValid = TRUE;
+			}
+
+			bool tsUncertain = (pHdrV0[HIDX_AVTP_HIDE7_FS_TU] & TU_BIT) ? TRUE : FALSE;
+
+			media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
+			if (pMediaQItem) {
+				U64 *pItemData = (U64 *)pMediaQItem->pPubData;
+				U32 i1;
+				for (i1 = 0; i1 < pPubMapInfo->timestampsPerPdu; i1++) {
+					U64 timestamp;
+					memcpy(&timestamp, pPayload + (i1 * CRF_TIMESTAMP_SIZE), CRF_TIMESTAMP_SIZE);
+					timestamp = ntohll(timestamp);
+					if (pPvtData->audioMcr == AVB_MCR_CRS && !tsUncertain) {
+						// The recovery works on the 32 bit AVTP representation of gPTP time
+						openavbAvtpTimePushMCR(pMediaQItem->pAvtpTime, (U32)timestamp);
+					}
+					pItemData[i1] = timestamp;
+				}
+
+				// The first timestamp of the PDU is the presentation time of the item
+				openavbAvtpTimeSetToTimestampNS(pMediaQItem->pAvtpTime, pItemData[0]);
+				openavbAvtpTimeSetTimestampUncertain(pMediaQItem->pAvtpTime, tsUncertain);
+
+				pMediaQItem->dataLen = pPvtData->payloadSize;
+				openavbMediaQHeadPush(pMediaQ);
+
+				AVB_TRACE_LINE(AVB_TRACE_MAP_LINE);
+				AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+				return TRUE;    // Normal exit
+			}
+			else {
+				IF_LOG_INTERVAL(1000) AVB_LOG_ERROR("Media queue full");
+				AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+				return FALSE;   // Media queue full
+			}
+		}
+		else {
+			if (pPvtData->dataValid) {
+				AVB_LOG_INFO("RX data invalid, stream muted");
+				pPvtData->dataValid = FALSE;
+			}
+		}
+	}
+	AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+	return FALSE;
+}
+
+// This callback will be called when the mapping module needs to be closed.
+// All cleanup should occur in this function.
+void openavbMapCrfEndCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MAP);
+
+	if (pMediaQ) {
+		media_q_pub_map_crf_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private mapping module data not allocated.");
+			return;
+		}
+
+		if (pPvtData->audioMcr != AVB_MCR_NONE) {
+			HAL_CLOSE_MCR_V2();
+		}
+
+		// Restart the synthesized clock from the current walltime if the stream is restarted.
+		openavbMcsInit(&pPvtData->mcs, pPubMapInfo->timestampPeriodNSec, pPvtData->mcs.correctionAmount, pPvtData->mcs.correctionInterval);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MAP);
+}
+
+void openavbMapCrfGenEndCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MAP);
+	AVB_TRACE_EXIT(AVB_TRACE_MAP);
+}
+
+// Initialization entry point into the mapping module. Will need to be included in the .ini file.
+extern DLL_EXPORT bool openavbMapCrfInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_MAP);
+
+	if (pMediaQ) {
+		pMediaQ->pMediaQDataFormat = strdup(MapCrfMediaQDataFormat);
+		pMediaQ->pPubMapInfo = calloc(1, sizeof(media_q_pub_map_crf_info_t));      // Memory freed by the media queue when the media queue is destroyed.
+		pMediaQ->pPvtMapInfo = calloc(1, sizeof(pvt_data_t));                      // Memory freed by the media queue when the media queue is destroyed.
+
+		if (!pMediaQ->pMediaQDataFormat || !pMediaQ->pPubMapInfo || !pMediaQ->pPvtMapInfo) {
+			AVB_LOG_ERROR("Unable to allocate memory for mapping module");
+			return FALSE;
+		}
+
+		media_q_pub_map_crf_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+
+		pMapCB->map_cfg_cb = openavbMapCrfCfgCB;
+		pMapCB->map_subtype_cb = openavbMapCrfSubtypeCB;
+		pMapCB->map_avtp_version_cb = openavbMapCrfAvtpVersionCB;
+		pMapCB->map_max_data_size_cb = openavbMapCrfMaxDataSizeCB;
+		pMapCB->map_transmit_interval_cb = openavbMapCrfTransmitIntervalCB;
+		pMapCB->map_gen_init_cb = openavbMapCrfGenInitCB;
+		pMapCB->map_tx_init_cb = openavbMapCrfTxInitCB;
+		pMapCB->map_tx_cb = openavbMapCrfTxCB;
+		pMapCB->map_rx_init_cb = openavbMapCrfRxInitCB;
+		pMapCB->map_rx_cb = openavbMapCrfRxCB;
+		pMapCB->map_end_cb = openavbMapCrfEndCB;
+		pMapCB->map_gen_end_cb = openavbMapCrfGenEndCB;
+
+		// Defaults are the 1722 audio sample CRF stream for 48kHz (300 timestamps per second)
+		pPubMapInfo->crfType = CRF_TYPE_AUDIO_SAMPLE;
+		pPubMapInfo->baseFrequency = 48000;
+		pPubMapInfo->pull = CRF_PULL_1_1;
+		pPubMapInfo->timestampInterval = 160;
+		pPubMapInfo->timestampsPerPdu = 6;
+
+		pPvtData->itemCount = 20;
+		pPvtData->txInterval = 0;
+		pPvtData->maxTransitUsec = inMaxTransitUsec;
+		pPvtData->audioMcr = AVB_MCR_CRS;
+		pPvtData->mcrRecoveryInterval = 512;
+		openavbMediaQSetMaxLatency(pMediaQ, inMaxTransitUsec);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_MAP);
+	return TRUE;
+}
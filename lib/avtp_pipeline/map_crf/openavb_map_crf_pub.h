@@ -0,0 +1,112 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+ 
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ 
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ 
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+Attributions: The inih library portion of the source code is licensed from 
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt. 
+Complete license and copyright information can be found at 
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+ * HEADER SUMMARY : Clock Reference Format mapping module public interface
+ *
+ * CRF (Clock Reference Format) is defined in IEEE 1722-2016 Clause 10.
+ */
+
+#ifndef OPENAVB_MAP_CRF_PUB_H
+#define OPENAVB_MAP_CRF_PUB_H 1
+
+#include "openavb_types_pub.h"
+#include "openavb_audio_pub.h"
+
+/** \file
+ * Clock Reference Format mapping module public interface.
+ *
+ * CRF (Clock Reference Format) is defined in IEEE 1722-2016 Clause 10.
+ * On the listener each media queue item holds the timestamps of one CRF
+ * AVTPDU as an array of U64 nanosecond values in host byte order.
+ */
+
+/** \note A define is used for the MediaQDataFormat identifier because it is
+ * needed in separate execution units (static / dynamic libraries) that is why
+ * a single static (static/extern pattern) definition can not be used.
+ */
+#define MapCrfMediaQDataFormat "ClockReferenceFormat"
+
+/** CRF type field (IEEE 1722-2016 Table 26).
+ */
+typedef enum {
+	/// User specified
+	CRF_TYPE_USER			= 0,
+	/// Audio sample timestamp
+	CRF_TYPE_AUDIO_SAMPLE	= 1,
+	/// Video frame sync timestamp
+	CRF_TYPE_VIDEO_FRAME	= 2,
+	/// Video line sync timestamp
+	CRF_TYPE_VIDEO_LINE		= 3,
+	/// Machine cycle timestamp
+	CRF_TYPE_MACHINE_CYCLE	= 4,
+} crf_type_t;
+
+/** CRF pull field (IEEE 1722-2016 Table 27).
+ */
+typedef enum {
+	/// Multiply base_frequency by 1.0
+	CRF_PULL_1_1			= 0,
+	/// Multiply base_frequency by 1/1.001
+	CRF_PULL_1_1001			= 1,
+	/// Multiply base_frequency by 1.001
+	CRF_PULL_1001_1			= 2,
+	/// Multiply base_frequency by 24/25
+	CRF_PULL_24_25			= 3,
+	/// Multiply base_frequency by 25/24
+	CRF_PULL_25_24			= 4,
+	/// Multiply base_frequency by 1/8
+	CRF_PULL_1_8			= 5,
+} crf_pull_t;
+
+/** Contains detailed information of the CRF stream.
+ * \note The mapping module sets these from its configuration during the
+ * general init callback. The interface module can use these during the RX
+ * and TX callbacks.
+ */
+typedef struct {
+	/// CRF type
+	crf_type_t crfType;
+	/// Nominal frequency of the reference clock in Hz
+	U32 baseFrequency;
+	/// Multiplier modifying the base frequency
+	crf_pull_t pull;
+	/// Number of media clock events between two timestamps
+	U32 timestampInterval;
+	/// Number of timestamps in one CRF AVTPDU
+	U32 timestampsPerPdu;
+	/// Nanoseconds between two consecutive timestamps
+	U64 timestampPeriodNSec;
+	/// Media Queue Item size
+	U32 itemSize;
+} media_q_pub_map_crf_info_t;
+
+#endif  // OPENAVB_MAP_CRF_PUB_H
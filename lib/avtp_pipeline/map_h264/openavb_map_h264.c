@@ -65,6 +65,16 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 #define MAX_PAYLOAD_SIZE 1416
 
+// Default media queue item size when items hold whole Annex-B access units.
+#define DEFAULT_AU_ITEM_SIZE (256 * 1024)
+
+// RFC 6184 NAL unit types used when fragmenting access units.
+#define NAL_TYPE_STAP_A				24
+#define NAL_TYPE_FU_A				28
+#define FU_HEADER_SIZE				2
+#define FU_S_BIT					0x80
+#define FU_E_BIT					0x40
+
 //////
 // AVTP Version 0 Header
 //////
@@ -75,6 +85,9 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 // - 1 Byte - TV bit (timestamp valid)
 #define HIDX_AVTP_HIDE7_TV1			1
 
+// - 1 Byte - Sequence number
+#define HIDX_AVTP_SEQ_NUM8			2
+
 // - 1 Byte - TU bit (timestamp uncertain)
 #define HIDX_AVTP_HIDE7_TU1			3
 
@@ -125,6 +138,18 @@ typedef struct {
 	// Max payload size
 	U32 maxPayloadSize;
 
+	// map_nv_tx_access_units: talker items hold complete Annex-B access units
+	// which this mapping fragments into single NAL unit and FU-A packets.
+	bool txAccessUnits;
+
+	// map_nv_rx_reassemble: listener collects the packets of an access unit into
+	// one media queue item as an Annex-B byte stream.
+	bool rxReassemble;
+
+	// map_nv_item_size: media queue item size used with map_nv_tx_access_units
+	// and map_nv_rx_reassemble
+	U32 auItemSize;
+
 	/////////////
 	// Variable data
 	/////////////
@@ -137,8 +162,103 @@ typedef struct {
 	// Maximum media queue item size
 	U32 itemSize;
 
+	// Access unit fragmentation state. nalEnd of 0 means no item is in progress.
+	U32 auOffset;
+	U32 nalStart;
+	U32 nalEnd;
+	U32 nalSent;
+
+	// Access unit reassembly state
+	U8 rxSeq;
+	bool rxSeqValid;
+	bool rxDiscard;
+	bool rxInFu;
+	U32 rxTimestamp;
+	U32 rxAccessUnitsLost;
+
 } pvt_data_t;
 
+static const U8 annexBStartCode[] = { 0x00, 0x00, 0x00, 0x01 };
+
+// Locate the next NAL unit of the access unit starting at auOffset. The NAL
+// unit ends at the next start code, with any trailing zero bytes (zero_byte of
+// a 4 byte start code or trailing_zero_8bits) removed.
+static bool x_nextNal(pvt_data_t *pPvtData, const U8 *pAu, U32 auLen)
+{
+	U32 i = pPvtData->auOffset;
+
+	while (i + 3 <= auLen) {
+		if (pAu[i] == 0x00 && pAu[i + 1] == 0x00 && pAu[i + 2] == 0x01) {
+			U32 start = i + 3;
+			U32 end = start;
+			while (end + 3 <= auLen
+				&& !(pAu[end] == 0x00 && pAu[end + 1] == 0x00 && pAu[end + 2] == 0x01)) {
+				end++;
+			}
+			if (end + 3 > auLen) {
+				end = auLen;
+			}
+			pPvtData->auOffset = end;
+			while (end > start && pAu[end - 1] == 0x00) {
+				end--;
+			}
+			if (end > start) {
+				pPvtData->nalStart = start;
+				pPvtData->nalEnd = end;
+				pPvtData->nalSent = 0;
+				return TRUE;
+			}
+			i = pPvtData->auOffset;
+			continue;
+		}
+		i++;
+	}
+
+	pPvtData->auOffset = auLen;
+	return FALSE;
+}
+
+// Fill the payload of one AVTP packet from the access unit held in the media queue item.
+// Returns the payload length and sets *pLast when this packet completes the access unit.
+static U32 x_fragmentAccessUnit(pvt_data_t *pPvtData, const U8 *pAu, U32 auLen, U8 *pPayload, bool *pLast)
+{
+	const U8 *pNal = pAu + pPvtData->nalStart;
+	U32 nalLen = pPvtData->nalEnd - pPvtData->nalStart;
+	U32 payloadLen;
+
+	if (pPvtData->nalSent == 0 && nalLen <= pPvtData->maxPayloadSize) {
+		// Single NAL unit packet
+		memcpy(pPayload, pNal, nalLen);
+		pPvtData->nalSent = nalLen;
+		payloadLen = nalLen;
+	}
+	else {
+		// FU-A fragment. The NAL unit header is carried in the FU indicator and header.
+		U8 fuHeader = pNal[0] & 0x1F;
+		if (pPvtData->nalSent == 0) {
+			fuHeader |= FU_S_BIT;
+			pPvtData->nalSent = 1;
+		}
+
+		U32 chunk = nalLen - pPvtData->nalSent;
+		if (chunk > pPvtData->maxPayloadSize - FU_HEADER_SIZE) {
+			chunk = pPvtData->maxPayloadSize - FU_HEADER_SIZE;
+		}
+		if (pPvtData->nalSent + chunk == nalLen) {
+			fuHeader |= FU_E_BIT;
+		}
+
+		pPayload[0] = (pNal[0] & 0xE0) | NAL_TYPE_FU_A;
+		pPayload[1] = fuHeader;
+		memcpy(pPayload + FU_HEADER_SIZE, pNal + pPvtData->nalSent, chunk);
+		pPvtData->nalSent += chunk;
+		payloadLen = chunk + FU_HEADER_SIZE;
+	}
+
+	*pLast = (pPvtData->nalSent == nalLen) && !x_nextNal(pPvtData, pAu, auLen);
+	return payloadLen;
+}
+
 
 
 // Each configuration name value pair for this mapping will result in this callback being called.
@@ -172,6 +292,15 @@ void openavbMapH264CfgCB(media_q_t *pMediaQ, const char *name, const char *value
 			pPvtData->maxDataSize = (pPvtData->maxPayloadSize + TOTAL_HEADER_SIZE);
 			pPvtData->itemSize =	pPvtData->maxPayloadSize;
 		}
+		else if (strcmp(name, "map_nv_tx_access_units") == 0) {
+			pPvtData->txAccessUnits = (strtol(value, &pEnd, 10) == 1);
+		}
+		else if (strcmp(name, "map_nv_rx_reassemble") == 0) {
+			pPvtData->rxReassemble = (strtol(value, &pEnd, 10) == 1);
+		}
+		else if (strcmp(name, "map_nv_item_size") == 0) {
+			pPvtData->auItemSize = strtol(value, &pEnd, 10);
+		}
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
@@ -237,6 +366,17 @@ void openavbMapH264GenInitCB(media_q_t *pMediaQ)
 			return;
 		}
 
+		if (pPvtData->txAccessUnits) {
+			if (pPvtData->maxPayloadSize <= FU_HEADER_SIZE) {
+				AVB_LOGF_WARNING("map_nv_max_payload_size too small for FU-A fragmentation. Parameter set to default: %d", MAX_PAYLOAD_SIZE);
+				pPvtData->maxPayloadSize = MAX_PAYLOAD_SIZE;
+				pPvtData->maxDataSize = (pPvtData->maxPayloadSize + TOTAL_HEADER_SIZE);
+			}
+		}
+		if (pPvtData->txAccessUnits || pPvtData->rxReassemble) {
+			pPvtData->itemSize = pPvtData->auItemSize ? pPvtData->auItemSize : DEFAULT_AU_ITEM_SIZE;
+		}
+
 		openavbMediaQSetSize(pMediaQ, pPvtData->itemCount, pPvtData->itemSize);
 		openavbMediaQAllocItemMapData(pMediaQ, sizeof(media_q_item_map_h264_pub_data_t), 0);
 	}
@@ -248,9 +388,90 @@ void openavbMapH264GenInitCB(media_q_t *pMediaQ)
 void openavbMapH264TxInitCB(media_q_t *pMediaQ)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_MAP);
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private mapping module data not allocated.");
+			return;
+		}
+
+		pPvtData->auOffset = 0;
+		pPvtData->nalStart = 0;
+		pPvtData->nalEnd = 0;
+		pPvtData->nalSent = 0;
+	}
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
 }
 
+static void x_setAvtpTimestamp(U8 *pHdr, media_q_item_t *pMediaQItem)
+{
+	// Set timestamp valid flag
+	if (openavbAvtpTimeTimestampIsValid(pMediaQItem->pAvtpTime))
+		pHdr[HIDX_AVTP_HIDE7_TV1] |= 0x01;      // Set
+	else {
+		pHdr[HIDX_AVTP_HIDE7_TV1] &= ~0x01;     // Clear
+	}
+
+	// Set timestamp uncertain flag
+	if (openavbAvtpTimeTimestampIsUncertain(pMediaQItem->pAvtpTime))
+		pHdr[HIDX_AVTP_HIDE7_TU1] |= 0x01;      // Set
+	else pHdr[HIDX_AVTP_HIDE7_TU1] &= ~0x01;    // Clear
+
+	// Set the timestamp.
+	*(U32 *)(&pHdr[HIDX_AVTP_TIMESTAMP32]) = htonl(openavbAvtpTimeGetAvtpTimestamp(pMediaQItem->pAvtpTime));
+}
+
+// Talker path for media queue items holding a complete Annex-B access unit. Each call
+// emits one single NAL unit or FU-A packet; the item is only pulled once the last
+// packet of the access unit (M0 set) has been built.
+static tx_cb_ret_t x_txAccessUnit(media_q_t *pMediaQ, pvt_data_t *pPvtData, media_q_item_t *pMediaQItem, U8 *pData, U32 *dataLen)
+{
+	U8 *pHdr = pData;
+	U8 *pPayload = pData + TOTAL_HEADER_SIZE;
+	U8 *pAu = pMediaQItem->pPubData;
+
+	if (pPvtData->nalEnd == 0) {
+		// First packet of a new access unit
+		pPvtData->auOffset = 0;
+		if (pMediaQItem->dataLen > pPvtData->itemSize
+			|| !x_nextNal(pPvtData, pAu, pMediaQItem->dataLen)) {
+			IF_LOG_INTERVAL(1000) AVB_LOGF_ERROR("Media queue item is not an Annex-B access unit (size %d).", pMediaQItem->dataLen);
+			pPvtData->nalEnd = 0;
+			openavbMediaQTailPull(pMediaQ);
+			*dataLen = 0;
+			return TX_CB_RET_PACKET_NOT_READY;
+		}
+
+		// PTP walltime already set in the interface module. Just add the max transit time.
+		openavbAvtpTimeAddUSec(pMediaQItem->pAvtpTime, pPvtData->maxTransitUsec);
+	}
+
+	x_setAvtpTimestamp(pHdr, pMediaQItem);
+
+	bool last;
+	U32 payloadLen = x_fragmentAccessUnit(pPvtData, pAu, pMediaQItem->dataLen, pPayload, &last);
+
+	pHdr[HIDX_M31_M21_M11_M01_EVT2_RESV2] = last ? 0x10 : 0x00;
+
+	// All packets of the access unit share the same h264_timestamp
+	*(U32 *)(&pHdr[HIDX_H264_TIMESTAMP32]) =
+			htonl(((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->timestamp);
+
+	*(U16 *)(&pHdr[HIDX_STREAM_DATA_LEN16]) = htons(payloadLen);
+
+	// Set out bound data length (entire packet length)
+	*dataLen = payloadLen + TOTAL_HEADER_SIZE;
+
+	if (last) {
+		pPvtData->nalEnd = 0;
+		openavbMediaQTailPull(pMediaQ);
+	}
+	else {
+		openavbMediaQTailUnlock(pMediaQ);
+	}
+	return TX_CB_RET_PACKET_READY;
+}
+
 // This talker callback will be called for each AVB observation interval.
 tx_cb_ret_t openavbMapH264TxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 {
@@ -274,6 +495,12 @@ tx_cb_ret_t openavbMapH264TxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 
 		media_q_item_t *pMediaQItem = openavbMediaQTailLock(pMediaQ, TRUE);
 		if (pMediaQItem) {
+			if (pMediaQItem->dataLen > 0 && pPvtData->txAccessUnits) {
+				tx_cb_ret_t ret = x_txAccessUnit(pMediaQ, pPvtData, pMediaQItem, pData, dataLen);
+				AVB_TRACE_LINE(AVB_TRACE_MAP_LINE);
+				AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+				return ret;
+			}
 			if (pMediaQItem->dataLen > 0) {
 				if (pMediaQItem->dataLen > pPvtData->itemSize) {
 					AVB_LOGF_ERROR("Media queue data item size too large. Reported size: %d  Max Size: %d", pMediaQItem->dataLen, pPvtData->itemSize);
@@ -285,20 +512,7 @@ tx_cb_ret_t openavbMapH264TxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 				// PTP walltime already set in the interface module. Just add the max transit time.
 				openavbAvtpTimeAddUSec(pMediaQItem->pAvtpTime, pPvtData->maxTransitUsec);
 
-				// Set timestamp valid flag
-				if (openavbAvtpTimeTimestampIsValid(pMediaQItem->pAvtpTime))
-					pHdr[HIDX_AVTP_HIDE7_TV1] |= 0x01;      // Set
-				else {
-					pHdr[HIDX_AVTP_HIDE7_TV1] &= ~0x01;     // Clear
-				}
-
-				// Set timestamp uncertain flag
-				if (openavbAvtpTimeTimestampIsUncertain(pMediaQItem->pAvtpTime))
-					pHdr[HIDX_AVTP_HIDE7_TU1] |= 0x01;      // Set
-				else pHdr[HIDX_AVTP_HIDE7_TU1] &= ~0x01;    // Clear
-
-				// Set the timestamp.
-				*(U32 *)(&pHdr[HIDX_AVTP_TIMESTAMP32]) = htonl(openavbAvtpTimeGetAvtpTimestamp(pMediaQItem->pAvtpTime));
+				x_setAvtpTimestamp(pHdr, pMediaQItem);
 
 				if (((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->lastPacket) {
 					pHdr[HIDX_M31_M21_M11_M01_EVT2_RESV2] = 0x10;;
@@ -342,9 +556,194 @@ tx_cb_ret_t openavbMapH264TxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 void openavbMapH264RxInitCB(media_q_t *pMediaQ)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_MAP);
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private mapping module data not allocated.");
+			return;
+		}
+
+		pPvtData->rxSeqValid = FALSE;
+		pPvtData->rxDiscard = FALSE;
+		pPvtData->rxInFu = FALSE;
+		pPvtData->rxAccessUnitsLost = 0;
+	}
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
 }
 
+// Discard the partially reassembled access unit. Packets are then dropped until
+// the next access unit starts.
+static void x_rxDropAccessUnit(pvt_data_t *pPvtData, media_q_item_t *pMediaQItem, const char *reason)
+{
+	if (!pPvtData->rxDiscard) {
+		pPvtData->rxAccessUnitsLost++;
+		IF_LOG_INTERVAL(100) AVB_LOGF_WARNING("H.264 access unit dropped (%s). %u lost so far.", reason, pPvtData->rxAccessUnitsLost);
+	}
+	pPvtData->rxDiscard = TRUE;
+	pPvtData->rxInFu = FALSE;
+	if (pMediaQItem) {
+		pMediaQItem->dataLen = 0;
+	}
+}
+
+static bool x_rxAppend(media_q_item_t *pMediaQItem, const U8 *pSrc, U32 len)
+{
+	if (pMediaQItem->dataLen + len > pMediaQItem->itemSize) {
+		return FALSE;
+	}
+	memcpy((U8 *)pMediaQItem->pPubData + pMediaQItem->dataLen, pSrc, len);
+	pMediaQItem->dataLen += len;
+	return TRUE;
+}
+
+static bool x_rxAppendNal(media_q_item_t *pMediaQItem, const U8 *pNal, U32 len)
+{
+	if (len == 0 || pMediaQItem->dataLen + sizeof(annexBStartCode) + len > pMediaQItem->itemSize) {
+		return FALSE;
+	}
+	x_rxAppend(pMediaQItem, annexBStartCode, sizeof(annexBStartCode));
+	x_rxAppend(pMediaQItem, pNal, len);
+	return TRUE;
+}
+
+// Depacketize one RFC 6184 payload into the access unit being built.
+static bool x_rxDepacketize(pvt_data_t *pPvtData, media_q_item_t *pMediaQItem, const U8 *pPayload, U32 payloadLen)
+{
+	if (payloadLen < 1) {
+		return FALSE;
+	}
+
+	U8 nalType = pPayload[0] & 0x1F;
+	if (nalType >= 1 && nalType <= 23) {
+		return !pPvtData->rxInFu && x_rxAppendNal(pMediaQItem, pPayload, payloadLen);
+	}
+	else if (nalType == NAL_TYPE_STAP_A) {
+		U32 i = 1;
+		if (pPvtData->rxInFu) {
+			return FALSE;
+		}
+		while (i + 2 <= payloadLen) {
+			U32 size = (pPayload[i] << 8) | pPayload[i + 1];
+			i += 2;
+			if (i + size > payloadLen || !x_rxAppendNal(pMediaQItem, pPayload + i, size)) {
+				return FALSE;
+			}
+			i += size;
+		}
+		return TRUE;
+	}
+	else if (nalType == NAL_TYPE_FU_A) {
+		if (payloadLen < FU_HEADER_SIZE) {
+			return FALSE;
+		}
+		U8 fuHeader = pPayload[1];
+		if (fuHeader & FU_S_BIT) {
+			U8 nalHdr = (pPayload[0] & 0xE0) | (fuHeader & 0x1F);
+			if (pPvtData->rxInFu || !x_rxAppendNal(pMediaQItem, &nalHdr, 1)) {
+				return FALSE;
+			}
+			pPvtData->rxInFu = TRUE;
+		}
+		else if (!pPvtData->rxInFu) {
+			return FALSE;
+		}
+		if (!x_rxAppend(pMediaQItem, pPayload + FU_HEADER_SIZE, payloadLen - FU_HEADER_SIZE)) {
+			return FALSE;
+		}
+		if (fuHeader & FU_E_BIT) {
+			pPvtData->rxInFu = FALSE;
+		}
+		return TRUE;
+	}
+
+	// STAP-B, MTAP and FU-B are only used in interleaved mode
+	return FALSE;
+}
+
+// Listener path for map_nv_rx_reassemble. The head item of the media queue is filled
+// across calls and only pushed once the packet with M0 set completes the access unit.
+// Sequence number gaps, an h264_timestamp change before M0 and malformed payloads
+// discard the access unit. After a gap, and for the first packets after start, the
+// access unit is discarded up to the next M0 as its leading packets may be missing.
+static bool x_rxAccessUnit(media_q_t *pMediaQ, pvt_data_t *pPvtData, U8 *pHdr, U8 *pPayload, U16 payloadLen)
+{
+	U8 seq = pHdr[HIDX_AVTP_SEQ_NUM8];
+	bool last = (pHdr[HIDX_M31_M21_M11_M01_EVT2_RESV2] & 0x10) ? TRUE : FALSE;
+	U32 h264Timestamp = ntohl(*(U32 *)(&pHdr[HIDX_H264_TIMESTAMP32]));
+	bool seqGap = pPvtData->rxSeqValid && seq != pPvtData->rxSeq;
+	bool seqUnknown = !pPvtData->rxSeqValid;
+
+	pPvtData->rxSeq = seq + 1;
+	pPvtData->rxSeqValid = TRUE;
+
+	media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
+	if (!pMediaQItem) {
+		IF_LOG_INTERVAL(1000) AVB_LOG_ERROR("Media queue full");
+		pPvtData->rxTimestamp = h264Timestamp;
+		x_rxDropAccessUnit(pPvtData, NULL, "media queue full");
+		if (last) {
+			pPvtData->rxDiscard = FALSE;
+		}
+		return FALSE;
+	}
+
+	// Checked before the timestamp: packets lost in a gap may include the start of the
+	// access unit this packet belongs to, even when its h264_timestamp is new.
+	if (seqGap) {
+		x_rxDropAccessUnit(pPvtData, pMediaQItem, "sequence gap");
+	}
+	else if (seqUnknown) {
+		// First packet after start, the access unit may have begun before it
+		pPvtData->rxDiscard = TRUE;
+		pPvtData->rxInFu = FALSE;
+		pMediaQItem->dataLen = 0;
+	}
+	else if (pPvtData->rxTimestamp != h264Timestamp) {
+		if (pMediaQItem->dataLen > 0) {
+			// The end of the previous access unit never arrived
+			x_rxDropAccessUnit(pPvtData, pMediaQItem, "missing M0");
+		}
+		pPvtData->rxDiscard = FALSE;
+		pPvtData->rxInFu = FALSE;
+	}
+	pPvtData->rxTimestamp = h264Timestamp;
+
+	if (!pPvtData->rxDiscard) {
+		if (pMediaQItem->dataLen == 0) {
+			// First packet of the access unit carries the presentation time.
+			U32 timestamp = ntohl(*(U32 *)(&pHdr[HIDX_AVTP_TIMESTAMP32]));
+			openavbAvtpTimeSetToTimestamp(pMediaQItem->pAvtpTime, timestamp);
+			openavbAvtpTimeSetTimestampValid(pMediaQItem->pAvtpTime, (pHdr[HIDX_AVTP_HIDE7_TV1] & 0x01) ? TRUE : FALSE);
+			openavbAvtpTimeSetTimestampUncertain(pMediaQItem->pAvtpTime, (pHdr[HIDX_AVTP_HIDE7_TU1] & 0x01) ? TRUE : FALSE);
+		}
+
+		if (!x_rxDepacketize(pPvtData, pMediaQItem, pPayload, payloadLen)) {
+			x_rxDropAccessUnit(pPvtData, pMediaQItem,
+				pMediaQItem->dataLen + payloadLen > pMediaQItem->itemSize ? "map_nv_item_size too small" : "invalid payload");
+		}
+	}
+
+	if (last) {
+		bool complete = !pPvtData->rxDiscard && !pPvtData->rxInFu && pMediaQItem->dataLen > 0;
+		if (!complete && pMediaQItem->dataLen > 0) {
+			x_rxDropAccessUnit(pPvtData, pMediaQItem, "incomplete fragmentation unit");
+		}
+		pPvtData->rxDiscard = FALSE;
+		pPvtData->rxInFu = FALSE;
+		if (complete) {
+			media_q_item_map_h264_pub_data_t *pPubMapData = pMediaQItem->pPubMapData;
+			pPubMapData->lastPacket = TRUE;
+			pPubMapData->timestamp = h264Timestamp;
+			pPubMapData->accessUnit = TRUE;
+			openavbMediaQHeadPush(pMediaQ);
+			return TRUE;
+		}
+	}
+
+	openavbMediaQHeadUnlock(pMediaQ);
+	return TRUE;
+}
+
 // This callback occurs when running as a listener and data is available.
 bool openavbMapH264RxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 {
@@ -370,6 +769,14 @@ bool openavbMapH264RxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 			return FALSE;
 		}
 
+		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+		if (pPvtData && pPvtData->rxReassemble) {
+			bool ret = x_rxAccessUnit(pMediaQ, pPvtData, pHdr, pPayload, payloadLen);
+			AVB_TRACE_LINE(AVB_TRACE_MAP_LINE);
+			AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+			return ret;
+		}
+
 		// Get item pointer in media queue
 		media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
 		if (pMediaQItem) {
@@ -381,6 +788,8 @@ bool openavbMapH264RxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 			openavbAvtpTimeSetTimestampValid(pMediaQItem->pAvtpTime, (pHdr[HIDX_AVTP_HIDE7_TV1] & 0x01) ? TRUE : FALSE);
 			openavbAvtpTimeSetTimestampUncertain(pMediaQItem->pAvtpTime, (pHdr[HIDX_AVTP_HIDE7_TU1] & 0x01) ? TRUE : FALSE);
 
+			((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->accessUnit = FALSE;
+
 			if (pHdr[HIDX_M31_M21_M11_M01_EVT2_RESV2] & 0x10)
 				((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->lastPacket = TRUE;
 			else
@@ -56,6 +56,9 @@ typedef struct {
 	bool lastPacket;		// For details see 1722a 9.4.3.1.1 M0 field
 	// The timestamp of h.264 NAL unit fragment.
 	U32 timestamp;			// For details see 1722-2016 8.5.3.1 h264_timestamp field
+	// Item holds a complete Annex-B access unit instead of a single RTP payload.
+	// Set by the mapping on the listener when map_nv_rx_reassemble is enabled.
+	bool accessUnit;
 } media_q_item_map_h264_pub_data_t;
 
 #endif  // OPENAVB_MAP_H264_PUB_H
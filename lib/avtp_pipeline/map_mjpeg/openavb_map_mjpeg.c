@@ -59,6 +59,14 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 #define ITEM_SIZE					MAX_JPEG_PAYLOAD_SIZE
 
+// Default media queue item size when the listener reassembles whole frames
+#define DEFAULT_FRAME_ITEM_SIZE		(512 * 1024)
+
+// RFC 2435 header sizes
+#define RTP_JPEG_HEADER_SIZE			8
+#define RTP_JPEG_RESTART_HEADER_SIZE	4
+#define RTP_JPEG_QUANT_HEADER_SIZE		4
+
 //////
 // AVTP Version 0 Header
 //////
@@ -69,6 +77,9 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 // - 1 Byte - TV bit (timestamp valid)
 #define HIDX_AVTP_HIDE7_TV1			1
 
+// - 1 Byte - Sequence number
+#define HIDX_AVTP_SEQ_NUM8			2
+
 // - 1 Byte - TU bit (timestamp uncertain)
 #define HIDX_AVTP_HIDE7_TU1			3
 
@@ -113,6 +124,13 @@ typedef struct {
 	// Transmit interval in frames per second. 0 = default for talker class.
 	U32 txInterval;
 
+	// map_nv_rx_reassemble: listener collects the fragments of a frame into one
+	// media queue item.
+	bool rxReassemble;
+
+	// map_nv_item_size: media queue item size used with map_nv_rx_reassemble
+	U32 frameItemSize;
+
 	/////////////
 	// Variable data
 	/////////////
@@ -120,6 +138,13 @@ typedef struct {
 
 	U32 timestamp;
 	bool tsvalid;
+
+	// Frame reassembly state
+	U8 rxSeq;
+	bool rxSeqValid;
+	bool rxDiscard;
+	U32 rxHdrLen;
+	U32 rxFramesLost;
 } pvt_data_t;
 
 
@@ -145,6 +170,14 @@ void openavbMapMjpegCfgCB(media_q_t *pMediaQ, const char *name, const char *valu
 			char *pEnd;
 			pPvtData->txInterval = strtol(value, &pEnd, 10);
 		}
+		else if (strcmp(name, "map_nv_rx_reassemble") == 0) {
+			char *pEnd;
+			pPvtData->rxReassemble = (strtol(value, &pEnd, 10) == 1);
+		}
+		else if (strcmp(name, "map_nv_item_size") == 0) {
+			char *pEnd;
+			pPvtData->frameItemSize = strtol(value, &pEnd, 10);
+		}
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
@@ -203,7 +236,13 @@ void openavbMapMjpegGenInitCB(media_q_t *pMediaQ)
 		pPvtData->timestamp = 0;
 		pPvtData->tsvalid = FALSE;
 
-		openavbMediaQSetSize(pMediaQ, pPvtData->itemCount, ITEM_SIZE);
+		if (pPvtData->rxReassemble) {
+			openavbMediaQSetSize(pMediaQ, pPvtData->itemCount,
+				pPvtData->frameItemSize ? pPvtData->frameItemSize : DEFAULT_FRAME_ITEM_SIZE);
+		}
+		else {
+			openavbMediaQSetSize(pMediaQ, pPvtData->itemCount, ITEM_SIZE);
+		}
 		openavbMediaQAllocItemMapData(pMediaQ, sizeof(media_q_item_map_mjpeg_pub_data_t), 0);
 	}
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
@@ -317,9 +356,136 @@ tx_cb_ret_t openavbMapMjpegTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 void openavbMapMjpegRxInitCB(media_q_t *pMediaQ)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_MAP);
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private mapping module data not allocated.");
+			return;
+		}
+
+		pPvtData->rxSeqValid = FALSE;
+		pPvtData->rxDiscard = FALSE;
+		pPvtData->rxFramesLost = 0;
+	}
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
 }
 
+// Discard the partially reassembled frame. Fragments are then dropped until the
+// next frame starts (fragment offset 0).
+static void x_rxDropFrame(pvt_data_t *pPvtData, media_q_item_t *pMediaQItem, const char *reason)
+{
+	if (!pPvtData->rxDiscard) {
+		pPvtData->rxFramesLost++;
+		IF_LOG_INTERVAL(100) AVB_LOGF_WARNING("JPEG frame dropped (%s). %u lost so far.", reason, pPvtData->rxFramesLost);
+	}
+	pPvtData->rxDiscard = TRUE;
+	if (pMediaQItem) {
+		pMediaQItem->dataLen = 0;
+	}
+}
+
+// Listener path for map_nv_rx_reassemble. The fragments of a frame are collected in the
+// head item of the media queue as a single RFC 2435 payload with fragment offset 0, so
+// the interface hands one RTP packet per frame to the depayloader.
+static bool x_rxFrame(media_q_t *pMediaQ, pvt_data_t *pPvtData, U8 *pHdr, U8 *pPayload, U32 payloadLen)
+{
+	U8 seq = pHdr[HIDX_AVTP_SEQ_NUM8];
+	bool last = (pHdr[HIDX_M11_M01_EVT2_RESV2] & 0x10) ? TRUE : FALSE;
+	bool seqGap = pPvtData->rxSeqValid && seq != pPvtData->rxSeq;
+
+	pPvtData->rxSeq = seq + 1;
+	pPvtData->rxSeqValid = TRUE;
+
+	if (payloadLen < RTP_JPEG_HEADER_SIZE) {
+		IF_LOG_INTERVAL(1000) AVB_LOG_ERROR("JPEG fragment too short.");
+		return FALSE;
+	}
+
+	// RFC 2435 3.1 main JPEG header
+	U32 fragOffset = (pPayload[1] << 16) | (pPayload[2] << 8) | pPayload[3];
+	U8 type = pPayload[4];
+	U8 q = pPayload[5];
+	U32 hdrLen = RTP_JPEG_HEADER_SIZE;
+	bool restart = (type >= 64 && type <= 127);
+	if (restart) {
+		hdrLen += RTP_JPEG_RESTART_HEADER_SIZE;
+	}
+	if (fragOffset == 0 && q >= 128) {
+		if (payloadLen < hdrLen + RTP_JPEG_QUANT_HEADER_SIZE) {
+			IF_LOG_INTERVAL(1000) AVB_LOG_ERROR("JPEG fragment too short.");
+			return FALSE;
+		}
+		hdrLen += RTP_JPEG_QUANT_HEADER_SIZE + ((pPayload[hdrLen + 2] << 8) | pPayload[hdrLen + 3]);
+	}
+	if (hdrLen > payloadLen) {
+		IF_LOG_INTERVAL(1000) AVB_LOG_ERROR("JPEG fragment too short.");
+		return FALSE;
+	}
+
+	media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
+	if (!pMediaQItem) {
+		IF_LOG_INTERVAL(1000) AVB_LOG_ERROR("Media queue full.");
+		x_rxDropFrame(pPvtData, NULL, "media queue full");
+		if (last) {
+			pPvtData->rxDiscard = FALSE;
+		}
+		return FALSE;
+	}
+
+	if (fragOffset == 0) {
+		if (pMediaQItem->dataLen > 0) {
+			// The end of the previous frame never arrived
+			x_rxDropFrame(pPvtData, pMediaQItem, "missing M0");
+		}
+		pPvtData->rxDiscard = FALSE;
+
+		if (pMediaQItem->itemSize < payloadLen) {
+			x_rxDropFrame(pPvtData, pMediaQItem, "map_nv_item_size too small");
+		}
+		else {
+			// Get the timestamp and place it in the media queue item.
+			U32 timestamp = ntohl(*(U32 *)(&pHdr[HIDX_AVTP_TIMESTAMP32]));
+			openavbAvtpTimeSetToTimestamp(pMediaQItem->pAvtpTime, timestamp);
+			openavbAvtpTimeSetTimestampValid(pMediaQItem->pAvtpTime, (pHdr[HIDX_AVTP_HIDE7_TV1] & 0x01) ? TRUE : FALSE);
+			openavbAvtpTimeSetTimestampUncertain(pMediaQItem->pAvtpTime, (pHdr[HIDX_AVTP_HIDE7_TU1] & 0x01) ? TRUE : FALSE);
+
+			memcpy(pMediaQItem->pPubData, pPayload, payloadLen);
+			pMediaQItem->dataLen = payloadLen;
+			pPvtData->rxHdrLen = hdrLen;
+			if (restart) {
+				// The frame now holds every restart interval: set F and L, count 0x3FFF.
+				((U8 *)pMediaQItem->pPubData)[RTP_JPEG_HEADER_SIZE + 2] = 0xFF;
+				((U8 *)pMediaQItem->pPubData)[RTP_JPEG_HEADER_SIZE + 3] = 0xFF;
+			}
+		}
+	}
+	else if (!pPvtData->rxDiscard) {
+		if (seqGap || pMediaQItem->dataLen == 0 || fragOffset != pMediaQItem->dataLen - pPvtData->rxHdrLen) {
+			x_rxDropFrame(pPvtData, pMediaQItem, "fragment lost");
+		}
+		else if (pMediaQItem->dataLen + payloadLen - hdrLen > pMediaQItem->itemSize) {
+			x_rxDropFrame(pPvtData, pMediaQItem, "map_nv_item_size too small");
+		}
+		else {
+			memcpy((U8 *)pMediaQItem->pPubData + pMediaQItem->dataLen, pPayload + hdrLen, payloadLen - hdrLen);
+			pMediaQItem->dataLen += payloadLen - hdrLen;
+		}
+	}
+
+	if (last) {
+		bool complete = !pPvtData->rxDiscard && pMediaQItem->dataLen > 0;
+		pPvtData->rxDiscard = FALSE;
+		if (complete) {
+			((media_q_item_map_mjpeg_pub_data_t *)pMediaQItem->pPubMapData)->lastFragment = TRUE;
+			openavbMediaQHeadPush(pMediaQ);
+			return TRUE;
+		}
+	}
+
+	openavbMediaQHeadUnlock(pMediaQ);
+	return TRUE;
+}
+
 // This callback occurs when running as a listener and data is available.
 bool openavbMapMjpegRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 {
@@ -331,6 +497,22 @@ bool openavbMapMjpegRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 //		U16 payloadLen = ntohs(*(U16 *)(&pHdr[HIDX_STREAM_DATA_LEN16]));
 		U16 payloadLen = *(U16 *)(&pHdr[HIDX_STREAM_DATA_LEN16]);
 
+		// The frame may carry Ethernet padding after the payload, stream_data_length is
+		// the payload size. It is in host order, as written by the talker above.
+		if (dataLen < TOTAL_HEADER_SIZE || payloadLen > dataLen - TOTAL_HEADER_SIZE) {
+			IF_LOG_INTERVAL(1000) AVB_LOG_ERROR("header data len > actual data len");
+			AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+			return FALSE;
+		}
+
+		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+		if (pPvtData && pPvtData->rxReassemble) {
+			bool ret = x_rxFrame(pMediaQ, pPvtData, pHdr, pPayload, payloadLen);
+			AVB_TRACE_LINE(AVB_TRACE_MAP_LINE);
+			AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
+			return ret;
+		}
+
 		// Get item pointer in media queue
 		media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
 		if (pMediaQItem) {
@@ -349,9 +531,9 @@ bool openavbMapMjpegRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 				((media_q_item_map_mjpeg_pub_data_t *)pMediaQItem->pPubMapData)->lastFragment = FALSE;
 			}
 
-			if (pMediaQItem->itemSize >= dataLen - TOTAL_HEADER_SIZE) {
+			if (pMediaQItem->itemSize >= payloadLen) {
 				memcpy(pMediaQItem->pPubData, pPayload, payloadLen);
-				pMediaQItem->dataLen = dataLen - TOTAL_HEADER_SIZE;
+				pMediaQItem->dataLen = payloadLen;
 			}
 			else {
 				AVB_LOG_ERROR("Data to large for media queue.");
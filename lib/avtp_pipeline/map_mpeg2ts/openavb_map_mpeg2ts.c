@@ -42,6 +42,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_map_pub.h"
 #include "openavb_map_mpeg2ts_pub.h"
 #include "openavb_types.h"
+#include "openavb_map_mpeg2ts_sync.h"
 #include <assert.h>
 
 #define	AVB_LOG_COMPONENT	"MPEG2TS Mapping"
@@ -146,6 +147,11 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 #define DEFAULT_SRC_PKTS_PER_AVTP_FRAME 5
 
+// PCR clock (27 MHz) handling for map_nv_pcr_timestamps
+#define PCR_PID_ANY					0x1FFF
+#define PCR_MAX_GAP					27000000LL		// 1 second between PCRs is a discontinuity
+#define PCR_MAX_DRIFT_NS			500000000LL
+
 typedef struct {
 	/////////////
 	// Config data
@@ -169,6 +175,14 @@ typedef struct {
 	// Transmit rate in frames per second. 0 = default for talker class.
 	unsigned txRate;
 
+	// map_nv_pcr_timestamps
+	// Derive source packet and AVTP timestamps from the PCR instead of the capture walltime
+	bool pcrTimestamps;
+
+	// map_nv_pcr_pid
+	// PID carrying the PCR. PCR_PID_ANY = the first PID seen with a PCR.
+	U16 pcrPid;
+
 	/////////////
 	// Variable data
 	/////////////
@@ -184,6 +198,18 @@ typedef struct {
 	// Is the input stream out of synch?
 	bool unsynched;
 
+	// Sync byte scanner
+	openavb_mpeg2ts_sync_scan_fn_t syncScanFn;
+
+	// PCR timeline
+	bool pcrValid;
+	U16 pcrLockedPid;
+	U64 pcrAnchor;
+	U64 pcrAnchorNs;
+	U64 pcrLast;
+	U64 pcrTicksPerPkt;
+	U32 pktsSincePcr;
+
 	unsigned int srcBitrate;
 
 } pvt_data_t;
@@ -241,6 +267,20 @@ void openavbMapMpeg2tsCfgCB(media_q_t *pMediaQ, const char *name, const char *va
 				valueOK = TRUE;
 			}
 		}
+		else if (strcmp(name, "map_nv_pcr_timestamps") == 0) {
+			tmp = strtoul(value, &pEnd, 10);
+			if (pEnd != value && *pEnd == '\0' && tmp <= 1) {
+				pPvtData->pcrTimestamps = (tmp == 1);
+				valueOK = TRUE;
+			}
+		}
+		else if (strcmp(name, "map_nv_pcr_pid") == 0) {
+			tmp = strtoul(value, &pEnd, 0);
+			if (pEnd != value && *pEnd == '\0' && tmp <= PCR_PID_ANY) {
+				pPvtData->pcrPid = tmp;
+				valueOK = TRUE;
+			}
+		}
 		else {
 			AVB_LOGF_WARNING("Unknown configuration item: %s", name);
 			nameOK = FALSE;
@@ -323,25 +363,143 @@ void openavbMapMpeg2tsGenInitCB(media_q_t *pMediaQ)
 void openavbMapMpeg2tsTxInitCB(media_q_t *pMediaQ)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_MAP);
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private mapping module data not allocated.");
+			return;
+		}
+
+		pPvtData->syncScanFn = openavbMpeg2tsSyncScanSelect();
+		pPvtData->pcrValid = FALSE;
+		AVB_LOGF_INFO("Sync scan: %s%s", openavbMpeg2tsSyncIsaName(),
+			pPvtData->pcrTimestamps ? ", PCR timestamps" : "");
+	}
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
 }
 
-static int syncScan(media_q_item_t *pMediaQItem, int startIdx)
+// Returns the offset of the next transport stream packet at or after startIdx, or -1.
+static int syncScan(pvt_data_t *pPvtData, media_q_item_t *pMediaQItem, int startIdx)
 {
-	char *data = pMediaQItem->pPubData;
-	int offset;
-	for (offset = startIdx; offset < pMediaQItem->dataLen; offset++) {
-		if (data[offset] == MPEG2_TS_SYNC_BYTE)
-			break;
+	// With 192 byte packets from the interface the sync byte follows the source packet header.
+	int hdrLen = pPvtData->tsPacketSize - MPEG2_TS_PKT_SIZE;
+	int offset = pPvtData->syncScanFn(pMediaQItem->pPubData, pMediaQItem->dataLen, startIdx + hdrLen, pPvtData->tsPacketSize);
+
+	if (offset >= 0) {
+		offset -= hdrLen;
+		if (offset > startIdx) {
+			AVB_LOGF_WARNING("Dropped %d bytes", offset - startIdx);
+		}
+	}
+	else {
+		AVB_LOGF_WARNING("Dropped %d bytes", pMediaQItem->dataLen - startIdx);
 	}
-
-	AVB_LOGF_WARNING("Dropped %d bytes", offset - startIdx);
-	if (offset >= pMediaQItem->dataLen)
-		offset = -1;
 
 	return offset;
 }
 
+// Extract the PCR (27 MHz) from the adaptation field of a transport stream packet.
+static bool x_getPcr(const U8 *pTsPkt, U16 *pPid, U64 *pPcr, bool *pDiscontinuity)
+{
+	if (!(pTsPkt[3] & 0x20) || pTsPkt[4] < 7 || !(pTsPkt[5] & 0x10)) {
+		return FALSE;
+	}
+
+	U64 base = ((U64)pTsPkt[6] << 25) | ((U64)pTsPkt[7] << 17) | ((U64)pTsPkt[8] << 9) | ((U64)pTsPkt[9] << 1) | (pTsPkt[10] >> 7);
+	U32 ext = ((pTsPkt[10] & 0x01) << 8) | pTsPkt[11];
+
+	*pPid = ((pTsPkt[1] & 0x1F) << 8) | pTsPkt[2];
+	*pPcr = base * 300 + ext;
+	*pDiscontinuity = (pTsPkt[5] & 0x80) ? TRUE : FALSE;
+	return TRUE;
+}
+
+// Presentation time of a transport stream packet derived from the PCR. The first PCR
+// is anchored to the (walltime + transit) of its media queue item; packets between
+// PCRs are interpolated at the rate measured over the previous PCR interval.
+static U64 x_pcrTimeNs(pvt_data_t *pPvtData, U64 itemNs, const U8 *pTsPkt)
+{
+	U16 pid;
+	U64 pcr, pcrNow;
+	bool discontinuity;
+
+	if (x_getPcr(pTsPkt, &pid, &pcr, &discontinuity)
+		&& (pPvtData->pcrPid != PCR_PID_ANY ? pid == pPvtData->pcrPid : (!pPvtData->pcrValid || pid == pPvtData->pcrLockedPid))) {
+		if (!pPvtData->pcrValid || discontinuity || pcr <= pPvtData->pcrLast || pcr - pPvtData->pcrLast > PCR_MAX_GAP) {
+			if (pPvtData->pcrValid) {
+				AVB_LOG_INFO("PCR discontinuity, re-anchoring timestamps");
+			}
+			pPvtData->pcrValid = TRUE;
+			pPvtData->pcrLockedPid = pid;
+			pPvtData->pcrAnchor = pcr;
+			pPvtData->pcrAnchorNs = itemNs;
+			pPvtData->pcrTicksPerPkt = 0;
+		}
+		else if (pPvtData->pktsSincePcr) {
+			pPvtData->pcrTicksPerPkt = (pcr - pPvtData->pcrLast) / pPvtData->pktsSincePcr;
+		}
+		pPvtData->pcrLast = pcr;
+		pPvtData->pktsSincePcr = 0;
+		pcrNow = pcr;
+	}
+	else if (!pPvtData->pcrValid) {
+		// No PCR seen yet
+		return itemNs;
+	}
+	else {
+		pcrNow = pPvtData->pcrLast + pPvtData->pktsSincePcr * pPvtData->pcrTicksPerPkt;
+	}
+	pPvtData->pktsSincePcr++;
+
+	U64 ns = pPvtData->pcrAnchorNs + (pcrNow - pPvtData->pcrAnchor) * 1000 / 27;
+
+	// Keep the PCR timeline from drifting away from the capture time.
+	S64 drift = (S64)(ns - itemNs);
+	if (drift > PCR_MAX_DRIFT_NS || drift < -PCR_MAX_DRIFT_NS) {
+		IF_LOG_INTERVAL(100) AVB_LOGF_WARNING("PCR timeline drifted %lld ms from walltime, re-anchoring", (long long)(drift / 1000000));
+		pPvtData->pcrAnchor = pcrNow;
+		pPvtData->pcrAnchorNs = itemNs;
+		ns = itemNs;
+	}
+
+	return ns;
+}
+
+// Set the source packet header timestamp of the source packet at pSrcPkt, and the AVTP
+// timestamp when it is the first source packet of the AVTP packet. 192 byte packets from
+// the interface keep their own source packet header unless PCR timestamps are on.
+static void x_setSourcePacketTimestamp(pvt_data_t *pPvtData, media_q_item_t *pMediaQItem, U8 *pSrcPkt, U8 *pHdr, bool first)
+{
+	U32 timestamp;
+	if (pPvtData->pcrTimestamps) {
+		timestamp = (U32)(x_pcrTimeNs(pPvtData, openavbAvtpTimeGetAvtpTimeNS(pMediaQItem->pAvtpTime),
+				pSrcPkt + MPEGTS_SRC_PKT_HDR_SIZE) & 0xFFFFFFFF);
+	}
+	else {
+		timestamp = openavbAvtpTimeGetAvtpTimestamp(pMediaQItem->pAvtpTime);
+	}
+
+	if (pPvtData->tsPacketSize == MPEG2_TS_PKT_SIZE || pPvtData->pcrTimestamps) {
+		*(U32 *)pSrcPkt = htonl(timestamp);
+	}
+	if (first) {
+		*(U32 *)(&pHdr[HIDX_AVTP_TIMESTAMP32]) = htonl(timestamp);
+	}
+}
+
+// Lost sync at readIdx; skip to the next transport stream packet after it.
+static void x_resync(pvt_data_t *pPvtData, media_q_item_t *pMediaQItem)
+{
+	int offset = syncScan(pPvtData, pMediaQItem, pMediaQItem->readIdx + 1);
+	if (offset >= 0)
+		pMediaQItem->readIdx = offset;
+	else {
+		pPvtData->unsynched = TRUE;
+		pMediaQItem->dataLen = 0;
+		pMediaQItem->readIdx = 0;
+	}
+}
+
 // This talker callback will be called for each AVB observation interval.
 tx_cb_ret_t openavbMapMpeg2tsTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 {
@@ -375,18 +533,20 @@ tx_cb_ret_t openavbMapMpeg2tsTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 		int sourcePacketsAdded = 0;
 		int nItemBytes, nAvailBytes;
 		int offset, bytesNeeded;
-		U32 timestamp;
 		bool moreSourcePackets = TRUE;
+		// Offset of the TS packet within a source packet as passed by the interface
+		const int pktOffset = MPEGTS_SRC_PKT_SIZE - pPvtData->tsPacketSize;
 
 		while (pMediaQItem && moreSourcePackets) {
 
 			if (pPvtData->unsynched) {
 				// Scan forward, looking for next sync byte.
-				offset = syncScan(pMediaQItem, 0);
-				if (offset >= 0)
+				offset = syncScan(pPvtData, pMediaQItem, pMediaQItem->readIdx);
+				if (offset >= 0) {
 					pMediaQItem->readIdx = offset;
+					pPvtData->unsynched = FALSE;
+				}
 				else {
-					pPvtData->unsynched = TRUE;
 					pMediaQItem->dataLen = 0;
 					pMediaQItem->readIdx = 0;
 				}
@@ -405,79 +565,73 @@ tx_cb_ret_t openavbMapMpeg2tsTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen)
 					openavbAvtpTimeAddUSec(pMediaQItem->pAvtpTime, pPvtData->maxTransitUsec);
 				}
 
-				timestamp = openavbAvtpTimeGetAvtpTimestamp(pMediaQItem->pAvtpTime);
-
-				// Set timestamp valid flag
-				if (openavbAvtpTimeTimestampIsValid(pMediaQItem->pAvtpTime))
-					pHdr[HIDX_AVTP_HIDE7_TV1] |= 0x01;      // Set
-				else {
-					pHdr[HIDX_AVTP_HIDE7_TV1] &= ~0x01;     // Clear
-				}
-
-				// Set timestamp uncertain flag
-				if (openavbAvtpTimeTimestampIsUncertain(pMediaQItem->pAvtpTime))
-					pHdr[HIDX_AVTP_HIDE7_TU1] |= 0x01;      // Set
-				else pHdr[HIDX_AVTP_HIDE7_TU1] &= ~0x01;     // Clear
-
-				// Set the timestamp.
 				if (sourcePacketsAdded == 0) {
-					// TODO: I think this is wrong with source packets
-					*(U32 *)(&pHdr[HIDX_AVTP_TIMESTAMP32]) = htonl(timestamp);
-				}
-
-				/* Copy the TS packets into the outgoing AVTP frame
-				 */
-				offset = 0, bytesNeeded = pPvtData->tsPacketSize;
+					// Set timestamp valid flag
+					if (openavbAvtpTimeTimestampIsValid(pMediaQItem->pAvtpTime))
+						pHdr[HIDX_AVTP_HIDE7_TV1] |= 0x01;      // Set
+					else {
+						pHdr[HIDX_AVTP_HIDE7_TV1] &= ~0x01;     // Clear
+					}
 
-				// If getting 188-byte packets from interface, need to add source packet header
-				if (pPvtData->tsPacketSize == MPEG2_TS_PKT_SIZE) {
-					// Set the timestamp on this source packet
-					*((U32 *)pPayload) = htonl(timestamp);
-					offset = MPEGTS_SRC_PKT_HDR_SIZE;
+					// Set timestamp uncertain flag
+					if (openavbAvtpTimeTimestampIsUncertain(pMediaQItem->pAvtpTime))
+						pHdr[HIDX_AVTP_HIDE7_TU1] |= 0x01;      // Set
+					else pHdr[HIDX_AVTP_HIDE7_TU1] &= ~0x01;     // Clear
 				}
 
-				// Use any leftover data from last MQ item
 				if (pPvtData->nSavedBytes) {
-					memcpy(pPayload + offset, pPvtData->savedBytes, pPvtData->nSavedBytes);
-					offset += pPvtData->nSavedBytes;
-					bytesNeeded -= pPvtData->nSavedBytes;
+					// Source packet split across two MQ items: leftover data from the last one first.
+					memcpy(pPayload + pktOffset, pPvtData->savedBytes, pPvtData->nSavedBytes);
+					bytesNeeded = pPvtData->tsPacketSize - pPvtData->nSavedBytes;
+					memcpy(pPayload + pktOffset + pPvtData->nSavedBytes, pMediaQItem->pPubData + pMediaQItem->readIdx, bytesNeeded);
 					pPvtData->nSavedBytes = 0;
-				}
-
-				// Now, copy data from current MQ item
-				memcpy(pPayload + offset, pMediaQItem->pPubData + pMediaQItem->readIdx, bytesNeeded);
-
-				// Check that the data we've copied is synchronized
-				/// i.e. that the transport stream packet starts
-				//  where we think it should
-				if (pPayload[4] == MPEG2_TS_SYNC_BYTE) {
-					// OK, now we can update the read index
-					pMediaQItem->readIdx += bytesNeeded;
-					// and move the payload ptr for the next source packet
-					pPayload += MPEGTS_SRC_PKT_SIZE;
 
-					// Keep track of how many source packets have been added to the outgoing packet
-					sourcePacketsAdded++;
+					// Check that the transport stream packet starts where we think it should
+					if (pPayload[MPEGTS_SRC_PKT_HDR_SIZE] == MPEG2_TS_SYNC_BYTE) {
+						x_setSourcePacketTimestamp(pPvtData, pMediaQItem, pPayload, pHdr, sourcePacketsAdded == 0);
+						pMediaQItem->readIdx += bytesNeeded;
+						pPayload += MPEGTS_SRC_PKT_SIZE;
+						sourcePacketsAdded++;
+					}
+					else {
+						AVB_LOG_WARNING("Alignment problem");
+						// Ignore saved data, start from what's in current item.
+						x_resync(pPvtData, pMediaQItem);
+					}
 				}
 				else {
-					AVB_LOG_WARNING("Alignment problem");
-
-					// Scan forward, looking for next sync byte.
-					// Start scan after 4-byte header if getting 192 byte packets.
-					// Ignore saved data if there was any, start from what's in current item.
-					offset = syncScan(pMediaQItem, pMediaQItem->readIdx + (pPvtData->tsPacketSize - MPEG2_TS_PKT_SIZE) + 1);
-					if (offset >= 0)
-						pMediaQItem->readIdx = offset;
-					else {
-						pPvtData->unsynched = TRUE;
-						pMediaQItem->dataLen = 0;
-						pMediaQItem->readIdx = 0;
+					// Copy as many whole packets from this MQ item as the AVTP packet takes.
+					int nPkts = nItemBytes / pPvtData->tsPacketSize;
+					if (nPkts > pPvtData->numSourcePackets - sourcePacketsAdded)
+						nPkts = pPvtData->numSourcePackets - sourcePacketsAdded;
+
+					const U8 *pSrc = pMediaQItem->pPubData + pMediaQItem->readIdx;
+					const U8 *pEnd = pMediaQItem->pPubData + pMediaQItem->dataLen;
+					const int syncIdx = MPEGTS_SRC_PKT_HDR_SIZE - pktOffset;
+					int i;
+					for (i = 0; i < nPkts; i++) {
+						// The next packet must start with a sync byte as well, if it is in this item.
+						if (pSrc[syncIdx] != MPEG2_TS_SYNC_BYTE
+							|| (pSrc + pPvtData->tsPacketSize + syncIdx < pEnd
+								&& pSrc[pPvtData->tsPacketSize + syncIdx] != MPEG2_TS_SYNC_BYTE))
+							break;
+						memcpy(pPayload + pktOffset, pSrc, pPvtData->tsPacketSize);
+						x_setSourcePacketTimestamp(pPvtData, pMediaQItem, pPayload, pHdr, sourcePacketsAdded == 0);
+						pSrc += pPvtData->tsPacketSize;
+						pPayload += MPEGTS_SRC_PKT_SIZE;
+						sourcePacketsAdded++;
+					}
+					pMediaQItem->readIdx += i * pPvtData->tsPacketSize;
+
+					if (i < nPkts) {
+						AVB_LOG_WARNING("Alignment problem");
+						x_resync(pPvtData, pMediaQItem);
 					}
 				}
 			}
 			else {
 				// Arghhh - a partial packet.
-				assert(pPvtData->nSavedBytes + nItemBytes <= MPEG2_TS_PKT_SIZE);
+				assert(pPvtData->nSavedBytes + nItemBytes <= MPEGTS_SRC_PKT_SIZE);
 
 				memcpy(pPvtData->savedBytes + pPvtData->nSavedBytes,
 					pMediaQItem->pPubData + pMediaQItem->readIdx,
@@ -726,6 +880,8 @@ extern DLL_EXPORT bool openavbMapMpeg2tsInitialize(media_q_t *pMediaQ, openavb_m
 		pPvtData->txRate = 0;
 		pPvtData->maxTransitUsec = inMaxTransitUsec;
 		pPvtData->DBC = 0;
+		pPvtData->pcrPid = PCR_PID_ANY;
+		pPvtData->syncScanFn = openavbMpeg2tsSyncScanSelectScalar();
 
 		openavbMediaQSetMaxLatency(pMediaQ, inMaxTransitUsec);
 	}
@@ -0,0 +1,213 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+ 
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ 
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ 
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+Attributions: The inih library portion of the source code is licensed from 
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt. 
+Complete license and copyright information can be found at 
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+ * MODULE SUMMARY : Transport stream resynchronization for the MPEG2 TS mapping module.
+ *
+ * The vector scanners compare the candidate block and the blocks one and two
+ * strides further against the sync byte at once, so every lane validates a
+ * candidate offset. Offsets whose following packets would lie beyond the end
+ * of the buffer are left to the scalar scanner.
+ */
+
+#include <string.h>
+#include "openavb_types_pub.h"
+#include "openavb_map_mpeg2ts_sync.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MPEG2TS_SYNC_X86	1
+#include <immintrin.h>
+#define X86_TARGET(isa)	__attribute__ ((target (isa)))
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MPEG2TS_SYNC_NEON	1
+#include <arm_neon.h>
+#endif
+
+#define SYNC_BYTE			0x47
+
+/////////////
+// Scalar scanner
+/////////////
+
+static int x_scalarSyncScan(const U8 *pData, U32 len, U32 startIdx, U32 stride)
+{
+	U32 offset;
+	for (offset = startIdx; offset < len; offset++) {
+		if (pData[offset] == SYNC_BYTE) {
+			U32 next = offset + stride;
+			int checked = 1;
+			while (checked < MPEG2TS_SYNC_CHECK_PKTS && next < len && pData[next] == SYNC_BYTE) {
+				next += stride;
+				checked++;
+			}
+			if (checked == MPEG2TS_SYNC_CHECK_PKTS || next >= len) {
+				return offset;
+			}
+		}
+	}
+	return -1;
+}
+
+// Vector loops cover offsets whose last checked packet lies within the buffer.
+static U32 x_vectorLimit(U32 len, U32 stride, U32 width)
+{
+	U32 span = (MPEG2TS_SYNC_CHECK_PKTS - 1) * stride + width;
+	return (len > span) ? len - span : 0;
+}
+
+#if MPEG2TS_SYNC_X86
+/////////////
+// SSE2 scanner
+/////////////
+
+X86_TARGET("sse2") static int x_sse2SyncScan(const U8 *pData, U32 len, U32 startIdx, U32 stride)
+{
+	const __m128i sync = _mm_set1_epi8(SYNC_BYTE);
+	U32 limit = x_vectorLimit(len, stride, 16);
+	U32 offset = startIdx;
+	for ( ; offset <= limit && limit > 0; offset += 16) {
+		__m128i m = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(pData + offset)), sync);
+		m = _mm_and_si128(m, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(pData + offset + stride)), sync));
+		m = _mm_and_si128(m, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(pData + offset + 2 * stride)), sync));
+		int bits = _mm_movemask_epi8(m);
+		if (bits) {
+			return offset + __builtin_ctz(bits);
+		}
+	}
+	return x_scalarSyncScan(pData, len, offset, stride);
+}
+
+/////////////
+// AVX2 scanner
+/////////////
+
+X86_TARGET("avx2") static int x_avx2SyncScan(const U8 *pData, U32 len, U32 startIdx, U32 stride)
+{
+	const __m256i sync = _mm256_set1_epi8(SYNC_BYTE);
+	U32 limit = x_vectorLimit(len, stride, 32);
+	U32 offset = startIdx;
+	for ( ; offset <= limit && limit > 0; offset += 32) {
+		__m256i m = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(pData + offset)), sync);
+		m = _mm256_and_si256(m, _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(pData + offset + stride)), sync));
+		m = _mm256_and_si256(m, _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(pData + offset + 2 * stride)), sync));
+		U32 bits = (U32)_mm256_movemask_epi8(m);
+		if (bits) {
+			return offset + __builtin_ctz(bits);
+		}
+	}
+	return x_scalarSyncScan(pData, len, offset, stride);
+}
+
+static bool x_cpuHas(const char *isa)
+{
+	__builtin_cpu_init();
+	if (strcmp(isa, "avx2") == 0)
+		return __builtin_cpu_supports("avx2") ? TRUE : FALSE;
+	if (strcmp(isa, "sse2") == 0)
+		return __builtin_cpu_supports("sse2") ? TRUE : FALSE;
+	return FALSE;
+}
+
+static openavb_mpeg2ts_sync_scan_fn_t x_vectorSyncScan(void)
+{
+	if (x_cpuHas("avx2"))
+		return x_avx2SyncScan;
+	if (x_cpuHas("sse2"))
+		return x_sse2SyncScan;
+	return NULL;
+}
+
+const char *openavbMpeg2tsSyncIsaName(void)
+{
+	if (x_cpuHas("avx2"))
+		return "AVX2";
+	if (x_cpuHas("sse2"))
+		return "SSE2";
+	return "scalar";
+}
+
+#elif MPEG2TS_SYNC_NEON
+/////////////
+// NEON scanner
+/////////////
+
+static int x_neonSyncScan(const U8 *pData, U32 len, U32 startIdx, U32 stride)
+{
+	const uint8x16_t sync = vdupq_n_u8(SYNC_BYTE);
+	U32 limit = x_vectorLimit(len, stride, 16);
+	U32 offset = startIdx;
+	for ( ; offset <= limit && limit > 0; offset += 16) {
+		uint8x16_t m = vceqq_u8(vld1q_u8(pData + offset), sync);
+		m = vandq_u8(m, vceqq_u8(vld1q_u8(pData + offset + stride), sync));
+		m = vandq_u8(m, vceqq_u8(vld1q_u8(pData + offset + 2 * stride), sync));
+		uint64x2_t m64 = vreinterpretq_u64_u8(m);
+		if (vgetq_lane_u64(m64, 0) | vgetq_lane_u64(m64, 1)) {
+			// A lane matched; the scalar scanner picks the first one.
+			return x_scalarSyncScan(pData, len, offset, stride);
+		}
+	}
+	return x_scalarSyncScan(pData, len, offset, stride);
+}
+
+static openavb_mpeg2ts_sync_scan_fn_t x_vectorSyncScan(void)
+{
+	return x_neonSyncScan;
+}
+
+const char *openavbMpeg2tsSyncIsaName(void)
+{
+	return "NEON";
+}
+
+#else
+
+static openavb_mpeg2ts_sync_scan_fn_t x_vectorSyncScan(void)
+{
+	return NULL;
+}
+
+const char *openavbMpeg2tsSyncIsaName(void)
+{
+	return "scalar";
+}
+
+#endif
+
+openavb_mpeg2ts_sync_scan_fn_t openavbMpeg2tsSyncScanSelectScalar(void)
+{
+	return x_scalarSyncScan;
+}
+
+openavb_mpeg2ts_sync_scan_fn_t openavbMpeg2tsSyncScanSelect(void)
+{
+	openavb_mpeg2ts_sync_scan_fn_t fn = x_vectorSyncScan();
+	return fn ? fn : openavbMpeg2tsSyncScanSelectScalar();
+}
@@ -0,0 +1,62 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+ 
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ 
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ 
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+Attributions: The inih library portion of the source code is licensed from 
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt. 
+Complete license and copyright information can be found at 
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* HEADER SUMMARY : Transport stream resynchronization for the MPEG2 TS mapping module.
+*
+* Locates the start of a transport stream packet in a buffer by looking for a
+* sync byte (0x47) that repeats at the packet stride (188 or 192) for the
+* following packets. Vector implementations are chosen at run time where the
+* CPU supports them.
+*/
+
+#ifndef OPENAVB_MAP_MPEG2TS_SYNC_H
+#define OPENAVB_MAP_MPEG2TS_SYNC_H 1
+
+#include "openavb_types_pub.h"
+
+// Number of packets, including the candidate, that must carry a sync byte at
+// the stride before an offset is accepted (fewer near the end of the buffer).
+#define MPEG2TS_SYNC_CHECK_PKTS		3
+
+// Offset of the first validated sync byte in pData[startIdx, len), or -1.
+typedef int (*openavb_mpeg2ts_sync_scan_fn_t)(const U8 *pData, U32 len, U32 startIdx, U32 stride);
+
+// Fastest sync scanner for this CPU.
+openavb_mpeg2ts_sync_scan_fn_t openavbMpeg2tsSyncScanSelect(void);
+
+// Scalar reference sync scanner.
+openavb_mpeg2ts_sync_scan_fn_t openavbMpeg2tsSyncScanSelectScalar(void);
+
+// Name of the instruction set the selected scanner uses, for logging.
+const char *openavbMpeg2tsSyncIsaName(void);
+
+#endif // OPENAVB_MAP_MPEG2TS_SYNC_H
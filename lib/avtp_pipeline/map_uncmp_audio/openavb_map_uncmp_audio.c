@@ -41,6 +41,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_mediaq_pub.h"
 #include "openavb_map_pub.h"
 #include "openavb_map_uncmp_audio_pub.h"
+#include "openavb_map_uncmp_audio_am824.h"
 
 // DEBUG Uncomment to turn on logging for just this module.
 #define AVB_LOG_ON	1
@@ -143,6 +144,10 @@ typedef struct {
 
 	U32 AM824_label;
 
+	// AM824 packing kernels for the configured item sample size
+	openavb_am824_pack_fn_t am824Pack;
+	openavb_am824_unpack_fn_t am824Unpack;
+
 	U32 maxPayloadSize;
 
 	// Data block continuity counter
@@ -280,6 +285,10 @@ static void x_calculateSizes(media_q_t *pMediaQ)
 				break;
 		}
 
+		// Anything other than 16 bit items is handled as 24 bit
+		pPvtData->am824Pack = openavbAm824PackSelect(pPubMapInfo->itemSampleSizeBytes == 2 ? 2 : 3);
+		pPvtData->am824Unpack = openavbAm824UnpackSelect(pPubMapInfo->itemSampleSizeBytes == 2 ? 2 : 3);
+		AVB_LOGF_INFO("AM824 packing:%s", openavbAm824IsaName());
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_MAP);
@@ -496,37 +505,24 @@ tx_cb_ret_t openavbMapUncmpAudioTxCB(media_q_t *pMediaQ, U8 *pData, U32 *dataLen
 
 				}
 
-				while (framesProcessed < pPubMapInfo->framesPerPacket && pMediaQItem->readIdx < pMediaQItem->dataLen) {
-					int i1;
-					for (i1 = 0; i1 < pPubMapInfo->audioChannels; i1++) {
-						if (pPubMapInfo->itemSampleSizeBytes == 2) {
-							S32 sample = *(S16 *)pItemData;
-							sample &= 0x0000ffff;
-							sample = sample << 8;
-							sample |= pPvtData->AM824_label;
-							sample = htonl(sample);
-							*(U32 *)(pAVTPDataUnit) = sample;
-							pAVTPDataUnit += 4;
-							pItemData += 2;
-						}
-						else {
-							S32 sample = *(S32 *)pItemData;
-							sample &= 0x00ffffff;
-							sample |= pPvtData->AM824_label;
-							sample = htonl(sample);
-							*(U32 *)(pAVTPDataUnit) = sample;
-							pAVTPDataUnit += 4;
-							pItemData += 3;
-						}
+				if (pMediaQItem->readIdx < pMediaQItem->dataLen) {
+					// Pack every frame this packet takes from the item in one block.
+					U32 frames = (pMediaQItem->dataLen - pMediaQItem->readIdx + pPubMapInfo->itemFrameSizeBytes - 1) / pPubMapInfo->itemFrameSizeBytes;
+					if (frames > pPubMapInfo->framesPerPacket - framesProcessed) {
+						frames = pPubMapInfo->framesPerPacket - framesProcessed;
 					}
-					framesProcessed++;
-					if (dbc % sytInt == 0) {
+					pPvtData->am824Pack(pAVTPDataUnit, pItemData, frames * pPubMapInfo->audioChannels, pPvtData->AM824_label >> 24);
+					pAVTPDataUnit += frames * pPubMapInfo->packetFrameSizeBytes;
+
+					// The timestamp goes with the block whose DBC is a multiple of SYT_INTERVAL.
+					if ((sytInt - (dbc % sytInt)) % sytInt < frames) {
 						*(U32 *)(&pHdr[HIDX_AVTP_TIMESTAMP32]) = htonl(openavbAvtpTimeGetAvtpTimestamp(pMediaQItem->pAvtpTime));
 
 						timestampSet = TRUE;
 					}
-					dbc++;
-					pMediaQItem->readIdx += pPubMapInfo->itemFrameSizeBytes;
+					dbc += frames;
+					framesProcessed += frames;
+					pMediaQItem->readIdx += frames * pPubMapInfo->itemFrameSizeBytes;
 				}
 
 				if (pMediaQItem->readIdx >= pMediaQItem->dataLen) {
@@ -583,6 +579,7 @@ bool openavbMapUncmpAudioRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 		U8 *pHdr = pData;
 		U8 *pPayload = pData + TOTAL_HEADER_SIZE;
 		media_q_pub_map_uncmp_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+		pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
 
 		//pHdr[HIDX_AVTP_TIMESTAMP32];
 		//pHdr[HIDX_GATEWAY32];
@@ -620,7 +617,6 @@ bool openavbMapUncmpAudioRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 
 				// Get the timestamp
 				U32 timestamp = ntohl(*(U32 *)(&pHdr[HIDX_AVTP_TIMESTAMP32]));
-				pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
 				if ((pPvtData->audioMcr != AVB_MCR_NONE) && tsValid && !tsUncertain) {
 					// MCR mode set and timestamp is valid, and timestamp uncertain is not set
 					openavbAvtpTimePushMCR(pMediaQItem->pAvtpTime, timestamp);
@@ -645,27 +641,14 @@ bool openavbMapUncmpAudioRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
 					openavbAvtpTimeSetTimestampUncertain(pMediaQItem->pAvtpTime, tsUncertain);
 				}
 
-				while (((pAVTPDataUnit + pPubMapInfo->packetFrameSizeBytes) <= pAVTPDataUnitEnd) && ((pItemData + pPubMapInfo->itemFrameSizeBytes) <= pItemDataEnd)) {
-					int i1;
-					for (i1 = 0; i1 < pPubMapInfo->audioChannels; i1++) {
-						if (pPubMapInfo->itemSampleSizeBytes == 2) {
-							S32 sample = ntohl(*(S32 *)pAVTPDataUnit);
-							sample = sample * 1;
-							*(S16 *)(pItemData) = (sample & 0x00ffffff) >> 8;
-							pAVTPDataUnit += 4;
-							pItemData += 2;
-							itemSizeWritten += 2;
-						}
-						else {
-							S32 sample = ntohl(*(S32 *)pAVTPDataUnit);
-							sample = sample * 1;
-							*(S32 *)(pItemData) = sample & 0x00ffffff;
-							pAVTPDataUnit += 4;
-							pItemData += 3;
-							itemSizeWritten += 3;
-						}
-					}
+				// Unpack as many whole frames as both the packet and the item allow in one block.
+				U32 frames = (pAVTPDataUnitEnd - pAVTPDataUnit) / pPubMapInfo->packetFrameSizeBytes;
+				if (pItemData + frames * pPubMapInfo->itemFrameSizeBytes > pItemDataEnd) {
+					frames = (pItemDataEnd - pItemData) / pPubMapInfo->itemFrameSizeBytes;
 				}
+				pPvtData->am824Unpack(pItemData, pAVTPDataUnit, frames * pPubMapInfo->audioChannels);
+				pAVTPDataUnit += frames * pPubMapInfo->packetFrameSizeBytes;
+				itemSizeWritten += frames * pPubMapInfo->itemFrameSizeBytes;
 
 				pMediaQItem->dataLen += itemSizeWritten;
 
@@ -0,0 +1,384 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+ 
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ 
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ 
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+Attributions: The inih library portion of the source code is licensed from 
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt. 
+Complete license and copyright information can be found at 
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+ * MODULE SUMMARY : AM824 quadlet packing kernels for the 61883-6 mapping module.
+ *
+ * Each kernel handles the bulk of the block with vector instructions and finishes
+ * the remainder with the scalar kernel. Vector loops are bounded so that loads
+ * never read past the end of the source and stores never write past the end of
+ * the destination.
+ */
+
+#include <string.h>
+#include "openavb_types_pub.h"
+#include "openavb_map_uncmp_audio_am824.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AM824_X86		1
+#include <immintrin.h>
+#define X86_TARGET(isa)	__attribute__ ((target (isa)))
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define AM824_NEON		1
+#include <arm_neon.h>
+#endif
+
+/////////////
+// Scalar kernels
+/////////////
+
+static void x_scalarPack16(U8 *pDst, const U8 *pSrc, U32 sampleCount, U8 label)
+{
+	while (sampleCount--) {
+		pDst[0] = label;
+		pDst[1] = pSrc[1];
+		pDst[2] = pSrc[0];
+		pDst[3] = 0;
+		pSrc += 2;
+		pDst += 4;
+	}
+}
+
+static void x_scalarPack24(U8 *pDst, const U8 *pSrc, U32 sampleCount, U8 label)
+{
+	while (sampleCount--) {
+		pDst[0] = label;
+		pDst[1] = pSrc[2];
+		pDst[2] = pSrc[1];
+		pDst[3] = pSrc[0];
+		pSrc += 3;
+		pDst += 4;
+	}
+}
+
+static void x_scalarUnpack16(U8 *pDst, const U8 *pSrc, U32 sampleCount)
+{
+	while (sampleCount--) {
+		pDst[0] = pSrc[2];
+		pDst[1] = pSrc[1];
+		pSrc += 4;
+		pDst += 2;
+	}
+}
+
+static void x_scalarUnpack24(U8 *pDst, const U8 *pSrc, U32 sampleCount)
+{
+	while (sampleCount--) {
+		pDst[0] = pSrc[3];
+		pDst[1] = pSrc[2];
+		pDst[2] = pSrc[1];
+		pSrc += 4;
+		pDst += 3;
+	}
+}
+
+#if AM824_X86
+/////////////
+// SSE2 kernels
+/////////////
+
+X86_TARGET("sse2") static void x_sse2Pack16(U8 *pDst, const U8 *pSrc, U32 sampleCount, U8 label)
+{
+	// Each quadlet is two 16 bit words: (sample & 0xff00) | label, then sample & 0x00ff.
+	const __m128i hiMask = _mm_set1_epi16((short)0xff00);
+	const __m128i loMask = _mm_set1_epi16(0x00ff);
+	const __m128i labelVec = _mm_set1_epi16(label);
+	U32 i = 0;
+	for ( ; i + 8 <= sampleCount; i += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(pSrc + i * 2));
+		__m128i w0 = _mm_or_si128(_mm_and_si128(v, hiMask), labelVec);
+		__m128i w1 = _mm_and_si128(v, loMask);
+		_mm_storeu_si128((__m128i *)(pDst + i * 4), _mm_unpacklo_epi16(w0, w1));
+		_mm_storeu_si128((__m128i *)(pDst + i * 4 + 16), _mm_unpackhi_epi16(w0, w1));
+	}
+	x_scalarPack16(pDst + i * 4, pSrc + i * 2, sampleCount - i, label);
+}
+
+/////////////
+// SSSE3 kernels
+/////////////
+
+X86_TARGET("ssse3") static void x_ssse3Pack24(U8 *pDst, const U8 *pSrc, U32 sampleCount, U8 label)
+{
+	const __m128i mask = _mm_setr_epi8(-128, 2, 1, 0, -128, 5, 4, 3, -128, 8, 7, 6, -128, 11, 10, 9);
+	const __m128i labelVec = _mm_set1_epi32(label);
+	U32 i = 0;
+	// 4 samples per pass; the 16 byte load needs 6 samples of source.
+	for ( ; i + 6 <= sampleCount; i += 4) {
+		__m128i v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(pSrc + i * 3)), mask);
+		_mm_storeu_si128((__m128i *)(pDst + i * 4), _mm_or_si128(v, labelVec));
+	}
+	x_scalarPack24(pDst + i * 4, pSrc + i * 3, sampleCount - i, label);
+}
+
+X86_TARGET("ssse3") static void x_ssse3Unpack16(U8 *pDst, const U8 *pSrc, U32 sampleCount)
+{
+	const __m128i mask = _mm_setr_epi8(2, 1, 6, 5, 10, 9, 14, 13, -128, -128, -128, -128, -128, -128, -128, -128);
+	U32 i = 0;
+	for ( ; i + 8 <= sampleCount; i += 8) {
+		__m128i a = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(pSrc + i * 4)), mask);
+		__m128i b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(pSrc + i * 4 + 16)), mask);
+		_mm_storeu_si128((__m128i *)(pDst + i * 2), _mm_unpacklo_epi64(a, b));
+	}
+	x_scalarUnpack16(pDst + i * 2, pSrc + i * 4, sampleCount - i);
+}
+
+X86_TARGET("ssse3") static void x_ssse3Unpack24(U8 *pDst, const U8 *pSrc, U32 sampleCount)
+{
+	const __m128i mask = _mm_setr_epi8(3, 2, 1, 7, 6, 5, 11, 10, 9, 15, 14, 13, -128, -128, -128, -128);
+	U32 i = 0;
+	// 4 samples per pass; the 16 byte store needs 6 samples of room.
+	for ( ; i + 6 <= sampleCount; i += 4) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(pSrc + i * 4));
+		_mm_storeu_si128((__m128i *)(pDst + i * 3), _mm_shuffle_epi8(v, mask));
+	}
+	x_scalarUnpack24(pDst + i * 3, pSrc + i * 4, sampleCount - i);
+}
+
+/////////////
+// AVX2 kernels
+/////////////
+
+X86_TARGET("avx2") static void x_avx2Pack16(U8 *pDst, const U8 *pSrc, U32 sampleCount, U8 label)
+{
+	// Lane 0 takes samples 0-3 and lane 1 samples 4-7 of the broadcast load.
+	const __m256i mask = _mm256_setr_epi8(
+		-128, 1, 0, -128, -128, 3, 2, -128, -128, 5, 4, -128, -128, 7, 6, -128,
+		-128, 9, 8, -128, -128, 11, 10, -128, -128, 13, 12, -128, -128, 15, 14, -128);
+	const __m256i labelVec = _mm256_set1_epi32(label);
+	U32 i = 0;
+	for ( ; i + 8 <= sampleCount; i += 8) {
+		__m256i v = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(pSrc + i * 2)));
+		v = _mm256_or_si256(_mm256_shuffle_epi8(v, mask), labelVec);
+		_mm256_storeu_si256((__m256i *)(pDst + i * 4), v);
+	}
+	x_scalarPack16(pDst + i * 4, pSrc + i * 2, sampleCount - i, label);
+}
+
+X86_TARGET("avx2") static void x_avx2Pack24(U8 *pDst, const U8 *pSrc, U32 sampleCount, U8 label)
+{
+	const __m256i mask = _mm256_setr_epi8(
+		-128, 2, 1, 0, -128, 5, 4, 3, -128, 8, 7, 6, -128, 11, 10, 9,
+		-128, 2, 1, 0, -128, 5, 4, 3, -128, 8, 7, 6, -128, 11, 10, 9);
+	const __m256i labelVec = _mm256_set1_epi32(label);
+	U32 i = 0;
+	// 8 samples per pass, 4 per lane; the second 16 byte load needs 10 samples of source.
+	for ( ; i + 10 <= sampleCount; i += 8) {
+		__m256i v = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(pSrc + i * 3)));
+		v = _mm256_inserti128_si256(v, _mm_loadu_si128((const __m128i *)(pSrc + i * 3 + 12)), 1);
+		v = _mm256_or_si256(_mm256_shuffle_epi8(v, mask), labelVec);
+		_mm256_storeu_si256((__m256i *)(pDst + i * 4), v);
+	}
+	x_ssse3Pack24(pDst + i * 4, pSrc + i * 3, sampleCount - i, label);
+}
+
+X86_TARGET("avx2") static void x_avx2Unpack16(U8 *pDst, const U8 *pSrc, U32 sampleCount)
+{
+	const __m256i mask = _mm256_setr_epi8(
+		2, 1, 6, 5, 10, 9, 14, 13, -128, -128, -128, -128, -128, -128, -128, -128,
+		2, 1, 6, 5, 10, 9, 14, 13, -128, -128, -128, -128, -128, -128, -128, -128);
+	U32 i = 0;
+	for ( ; i + 8 <= sampleCount; i += 8) {
+		__m256i v = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)(pSrc + i * 4)), mask);
+		// Gather the low 8 bytes of each 128 bit lane.
+		v = _mm256_permute4x64_epi64(v, 0x08);
+		_mm_storeu_si128((__m128i *)(pDst + i * 2), _mm256_castsi256_si128(v));
+	}
+	x_scalarUnpack16(pDst + i * 2, pSrc + i * 4, sampleCount - i);
+}
+
+static bool x_cpuHas(const char *isa)
+{
+	__builtin_cpu_init();
+	if (strcmp(isa, "avx2") == 0)
+		return __builtin_cpu_supports("avx2") ? TRUE : FALSE;
+	if (strcmp(isa, "ssse3") == 0)
+		return __builtin_cpu_supports("ssse3") ? TRUE : FALSE;
+	if (strcmp(isa, "sse2") == 0)
+		return __builtin_cpu_supports("sse2") ? TRUE : FALSE;
+	return FALSE;
+}
+
+static openavb_am824_pack_fn_t x_vectorPack(U32 itemSampleBytes)
+{
+	if (x_cpuHas("avx2"))
+		return (itemSampleBytes == 2) ? x_avx2Pack16 : x_avx2Pack24;
+	if (x_cpuHas("ssse3"))
+		return (itemSampleBytes == 2) ? x_sse2Pack16 : x_ssse3Pack24;
+	if (x_cpuHas("sse2") && itemSampleBytes == 2)
+		return x_sse2Pack16;
+	return NULL;
+}
+
+static openavb_am824_unpack_fn_t x_vectorUnpack(U32 itemSampleBytes)
+{
+	if (x_cpuHas("avx2") && itemSampleBytes == 2)
+		return x_avx2Unpack16;
+	if (x_cpuHas("ssse3"))
+		return (itemSampleBytes == 2) ? x_ssse3Unpack16 : x_ssse3Unpack24;
+	return NULL;
+}
+
+const char *openavbAm824IsaName(void)
+{
+	if (x_cpuHas("avx2"))
+		return "AVX2";
+	if (x_cpuHas("ssse3"))
+		return "SSSE3";
+	if (x_cpuHas("sse2"))
+		return "SSE2";
+	return "scalar";
+}
+
+#elif AM824_NEON
+/////////////
+// NEON kernels
+/////////////
+
+// The structured loads and stores split and merge the quadlet bytes, so each
+// kernel handles 16 samples per pass without reading or writing out of bounds.
+
+static void x_neonPack16(U8 *pDst, const U8 *pSrc, U32 sampleCount, U8 label)
+{
+	const uint8x16_t labelVec = vdupq_n_u8(label);
+	const uint8x16_t zero = vdupq_n_u8(0);
+	U32 i = 0;
+	for ( ; i + 16 <= sampleCount; i += 16) {
+		uint8x16x2_t in = vld2q_u8(pSrc + i * 2);
+		uint8x16x4_t out = { { labelVec, in.val[1], in.val[0], zero } };
+		vst4q_u8(pDst + i * 4, out);
+	}
+	x_scalarPack16(pDst + i * 4, pSrc + i * 2, sampleCount - i, label);
+}
+
+static void x_neonPack24(U8 *pDst, const U8 *pSrc, U32 sampleCount, U8 label)
+{
+	const uint8x16_t labelVec = vdupq_n_u8(label);
+	U32 i = 0;
+	for ( ; i + 16 <= sampleCount; i += 16) {
+		uint8x16x3_t in = vld3q_u8(pSrc + i * 3);
+		uint8x16x4_t out = { { labelVec, in.val[2], in.val[1], in.val[0] } };
+		vst4q_u8(pDst + i * 4, out);
+	}
+	x_scalarPack24(pDst + i * 4, pSrc + i * 3, sampleCount - i, label);
+}
+
+static void x_neonUnpack16(U8 *pDst, const U8 *pSrc, U32 sampleCount)
+{
+	U32 i = 0;
+	for ( ; i + 16 <= sampleCount; i += 16) {
+		uint8x16x4_t in = vld4q_u8(pSrc + i * 4);
+		uint8x16x2_t out = { { in.val[2], in.val[1] } };
+		vst2q_u8(pDst + i * 2, out);
+	}
+	x_scalarUnpack16(pDst + i * 2, pSrc + i * 4, sampleCount - i);
+}
+
+static void x_neonUnpack24(U8 *pDst, const U8 *pSrc, U32 sampleCount)
+{
+	U32 i = 0;
+	for ( ; i + 16 <= sampleCount; i += 16) {
+		uint8x16x4_t in = vld4q_u8(pSrc + i * 4);
+		uint8x16x3_t out = { { in.val[3], in.val[2], in.val[1] } };
+		vst3q_u8(pDst + i * 3, out);
+	}
+	x_scalarUnpack24(pDst + i * 3, pSrc + i * 4, sampleCount - i);
+}
+
+static openavb_am824_pack_fn_t x_vectorPack(U32 itemSampleBytes)
+{
+	return (itemSampleBytes == 2) ? x_neonPack16 : x_neonPack24;
+}
+
+static openavb_am824_unpack_fn_t x_vectorUnpack(U32 itemSampleBytes)
+{
+	return (itemSampleBytes == 2) ? x_neonUnpack16 : x_neonUnpack24;
+}
+
+const char *openavbAm824IsaName(void)
+{
+	return "NEON";
+}
+
+#else
+
+static openavb_am824_pack_fn_t x_vectorPack(U32 itemSampleBytes)
+{
+	return NULL;
+}
+
+static openavb_am824_unpack_fn_t x_vectorUnpack(U32 itemSampleBytes)
+{
+	return NULL;
+}
+
+const char *openavbAm824IsaName(void)
+{
+	return "scalar";
+}
+
+#endif
+
+openavb_am824_pack_fn_t openavbAm824PackSelectScalar(U32 itemSampleBytes)
+{
+	switch (itemSampleBytes) {
+		case 2: return x_scalarPack16;
+		case 3: return x_scalarPack24;
+		default: return NULL;
+	}
+}
+
+openavb_am824_unpack_fn_t openavbAm824UnpackSelectScalar(U32 itemSampleBytes)
+{
+	switch (itemSampleBytes) {
+		case 2: return x_scalarUnpack16;
+		case 3: return x_scalarUnpack24;
+		default: return NULL;
+	}
+}
+
+openavb_am824_pack_fn_t openavbAm824PackSelect(U32 itemSampleBytes)
+{
+	openavb_am824_pack_fn_t fn = NULL;
+	if (itemSampleBytes == 2 || itemSampleBytes == 3) {
+		fn = x_vectorPack(itemSampleBytes);
+	}
+	return fn ? fn : openavbAm824PackSelectScalar(itemSampleBytes);
+}
+
+openavb_am824_unpack_fn_t openavbAm824UnpackSelect(U32 itemSampleBytes)
+{
+	openavb_am824_unpack_fn_t fn = NULL;
+	if (itemSampleBytes == 2 || itemSampleBytes == 3) {
+		fn = x_vectorUnpack(itemSampleBytes);
+	}
+	return fn ? fn : openavbAm824UnpackSelectScalar(itemSampleBytes);
+}
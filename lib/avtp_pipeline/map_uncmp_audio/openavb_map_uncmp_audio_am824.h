@@ -0,0 +1,64 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+ 
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ 
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ 
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ 
+Attributions: The inih library portion of the source code is licensed from 
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt. 
+Complete license and copyright information can be found at 
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* HEADER SUMMARY : AM824 quadlet packing kernels for the 61883-6 mapping module.
+*
+* A block of interleaved media queue samples (frames * channels) is packed into
+* big-endian AM824 quadlets, label in the first byte and the sample left aligned
+* in the remaining 24 bits, or unpacked back. Media queue samples are 2 or 3 byte
+* little endian. Vector implementations are chosen at run time where the CPU
+* supports them.
+*/
+
+#ifndef OPENAVB_MAP_UNCMP_AUDIO_AM824_H
+#define OPENAVB_MAP_UNCMP_AUDIO_AM824_H 1
+
+#include "openavb_types_pub.h"
+
+// Pack sampleCount item samples from pSrc into AM824 quadlets at pDst using label.
+typedef void (*openavb_am824_pack_fn_t)(U8 *pDst, const U8 *pSrc, U32 sampleCount, U8 label);
+
+// Unpack sampleCount AM824 quadlets from pSrc into item samples at pDst.
+typedef void (*openavb_am824_unpack_fn_t)(U8 *pDst, const U8 *pSrc, U32 sampleCount);
+
+// Fastest packer / unpacker for item samples of itemSampleBytes (2 or 3), or NULL.
+openavb_am824_pack_fn_t openavbAm824PackSelect(U32 itemSampleBytes);
+openavb_am824_unpack_fn_t openavbAm824UnpackSelect(U32 itemSampleBytes);
+
+// Scalar reference packer / unpacker.
+openavb_am824_pack_fn_t openavbAm824PackSelectScalar(U32 itemSampleBytes);
+openavb_am824_unpack_fn_t openavbAm824UnpackSelectScalar(U32 itemSampleBytes);
+
+// Name of the instruction set the selected kernels use, for logging.
+const char *openavbAm824IsaName(void);
+
+#endif // OPENAVB_MAP_UNCMP_AUDIO_AM824_H
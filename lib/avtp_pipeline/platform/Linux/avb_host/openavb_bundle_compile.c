@@ -0,0 +1,210 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Compiles talker and listener ini files into a configuration bundle.
+*
+* Every file is parsed and validated, and the bundle is only written when all of them pass,
+* so bad configurations are caught before a host goes live. Must be linked with the same
+* mapping and interface modules as the host that loads the bundle.
+*/
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include "openavb_tl_pub.h"
+#include "openavb_osal_pub.h"
+#include "openavb_plugin.h"
+
+#define	AVB_LOG_COMPONENT	"TL Bundle"
+#include "openavb_log_pub.h"
+
+// Platform independent mapping modules
+extern bool openavbMapPipeInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapAVTPAudioInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapCrfInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapCtrlInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapH264Initialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapMjpegInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapMpeg2tsInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapNullInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapUncmpAudioInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+
+// Platform independent interface modules
+extern bool openavbIntfEchoInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+extern bool openavbIntfCtrlInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+extern bool openavbIntfLoggerInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+extern bool openavbIntfNullInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+extern bool openavbIntfToneGenInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+extern bool openavbIntfViewerInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+
+// Linux interface modules
+extern bool openavbIntfAlsaInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+extern bool openavbIntfMpeg2tsFileInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+extern bool openavbIntfWavFileInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+extern bool openavbIntfShmInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+#ifdef AVB_FEATURE_GSTREAMER
+extern bool openavbIntfMjpegGstInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+extern bool openavbIntfMpeg2tsGstInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+extern bool openavbIntfH264RtpGstInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+#endif
+
+void openavbBundleCompileUsage(char *programName)
+{
+	printf(
+		"\n"
+		"Usage: %s [options] -o bundle file...\n"
+		"  -o val     Bundle file to write.\n"
+		"  -I val     Use given (val) interface globally, can be overriden by giving the ifname= option to the config line.\n"
+		"  -l val     Filename of the log file to use.  If not specified, results will be logged to stderr.\n"
+		"  -h         Prints this message.\n"
+		"\n"
+		"Examples:\n"
+		"  %s -o streams.bundle talker1.ini talker2.ini listener1.ini\n"
+		"    Validate 3 streams and compile them into streams.bundle.\n\n"
+		"  openavb_host -b streams.bundle\n"
+		"    Start the streams of the bundle.\n\n"
+		,
+		programName, programName);
+}
+
+/**********************************************
+ * main
+ */
+int main(int argc, char *argv[])
+{
+	char *programName;
+	char *optBundleFile = NULL;
+	char *optIfnameGlobal = NULL;
+	char *optLogFileName = NULL;
+	int i1;
+
+	programName = strrchr(argv[0], '/');
+	programName = programName ? programName + 1 : argv[0];
+
+	bool optDone = FALSE;
+	while (!optDone) {
+		int opt = getopt(argc, argv, "ho:I:l:");
+		if (opt != EOF) {
+			switch (opt) {
+				case 'o':
+					optBundleFile = strdup(optarg);
+					break;
+				case 'I':
+					optIfnameGlobal = strdup(optarg);
+					break;
+				case 'l':
+					optLogFileName = strdup(optarg);
+					break;
+				case 'h':
+				default:
+					openavbBundleCompileUsage(programName);
+					exit(-1);
+			}
+		}
+		else {
+			optDone = TRUE;
+		}
+	}
+
+	U32 iniCount = argc - optind;
+	if (!optBundleFile || iniCount < 1) {
+		openavbBundleCompileUsage(programName);
+		exit(-1);
+	}
+
+	osalAVBInitialize(optLogFileName, optIfnameGlobal);
+
+	// Keep the modules linked in, so their initialize functions can be found
+	registerStaticMapModule(openavbMapPipeInitialize);
+	registerStaticMapModule(openavbMapAVTPAudioInitialize);
+	registerStaticMapModule(openavbMapCrfInitialize);
+	registerStaticMapModule(openavbMapCtrlInitialize);
+	registerStaticMapModule(openavbMapH264Initialize);
+	registerStaticMapModule(openavbMapMjpegInitialize);
+	registerStaticMapModule(openavbMapMpeg2tsInitialize);
+	registerStaticMapModule(openavbMapNullInitialize);
+	registerStaticMapModule(openavbMapUncmpAudioInitialize);
+
+	registerStaticIntfModule(openavbIntfEchoInitialize);
+	registerStaticIntfModule(openavbIntfCtrlInitialize);
+	registerStaticIntfModule(openavbIntfLoggerInitialize);
+	registerStaticIntfModule(openavbIntfNullInitialize);
+	registerStaticIntfModule(openavbIntfToneGenInitialize);
+	registerStaticIntfModule(openavbIntfViewerInitialize);
+	registerStaticIntfModule(openavbIntfAlsaInitialize);
+	registerStaticIntfModule(openavbIntfMpeg2tsFileInitialize);
+	registerStaticIntfModule(openavbIntfWavFileInitialize);
+	registerStaticIntfModule(openavbIntfShmInitialize);
+#ifdef AVB_FEATURE_GSTREAMER
+	registerStaticIntfModule(openavbIntfMjpegGstInitialize);
+	registerStaticIntfModule(openavbIntfMpeg2tsGstInitialize);
+	registerStaticIntfModule(openavbIntfH264RtpGstInitialize);
+#endif
+
+	char **iniFileList = calloc(iniCount, sizeof(char *));
+	if (!iniFileList) {
+		AVB_LOG_ERROR("Unable to allocate ini list");
+		osalAVBFinalize();
+		exit(-1);
+	}
+
+	for (i1 = 0; i1 < iniCount; i1++) {
+		char iniFile[1024];
+
+		snprintf(iniFile, sizeof(iniFile), "%s", argv[i1 + optind]);
+		if (optIfnameGlobal && !strcasestr(iniFile, ",ifname=")) {
+			snprintf(iniFile + strlen(iniFile), sizeof(iniFile) - strlen(iniFile), ",ifname=%s", optIfnameGlobal);
+		}
+		iniFileList[i1] = strdup(iniFile);
+	}
+
+	bool bOK = openavbTLBundleCompile(optBundleFile, iniFileList, iniCount);
+	if (bOK) {
+		printf("Compiled %u streams into %s\n", iniCount, optBundleFile);
+	}
+	else {
+		printf("No bundle written, see the errors above\n");
+	}
+
+	for (i1 = 0; i1 < iniCount; i1++) {
+		free(iniFileList[i1]);
+	}
+	free(iniFileList);
+	free(optBundleFile);
+	free(optIfnameGlobal);
+	free(optLogFileName);
+
+	osalAVBFinalize();
+
+	exit(bOK ? 0 : -1);
+}
@@ -44,6 +44,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_osal_pub.h"
 #include "openavb_plugin.h"
 #include "openavb_trace_pub.h"
+#include "openavb_metrics.h"
 #ifdef AVB_FEATURE_GSTREAMER
 #include <gst/gst.h>
 #endif
@@ -54,9 +55,13 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 bool bRunning = TRUE;
 
+// How often the worker utilization is logged when streams run on a worker pool
+#define POOL_REPORT_SEC		10
+
 // Platform independent mapping modules
 extern bool openavbMapPipeInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
 extern bool openavbMapAVTPAudioInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapCrfInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
 extern bool openavbMapCtrlInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
 extern bool openavbMapH264Initialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
 extern bool openavbMapMjpegInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
@@ -76,6 +81,7 @@ extern bool openavbIntfViewerInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *p
 extern bool openavbIntfAlsaInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
 extern bool openavbIntfMpeg2tsFileInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
 extern bool openavbIntfWavFileInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+extern bool openavbIntfShmInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
 #ifdef AVB_FEATURE_GSTREAMER
 extern bool openavbIntfMpeg2tsGstInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
 extern bool openavbIntfMjpegGstInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
@@ -104,6 +110,9 @@ static void openavbTLSigHandler(int signal)
 	else if (signal == SIGUSR1) {
 		AVB_LOG_DEBUG("Waking up streaming thread");
 	}
+	else if (signal == SIGUSR2) {
+		avbTraceToggle();
+	}
 	else {
 		AVB_LOG_ERROR("Unexpected signal");
 	}
@@ -123,6 +132,9 @@ void openavbTlHarnessUsage(char *programName)
 		"  -d val     Last byte of destination address from static pool. Full address will be 91:e0:f0:00:fe:val.\n"
 		"  -I val     Use given (val) interface globally, can be overriden by giving the ifname= option to the config line.\n"
 		"  -l val     Filename of the log file to use.  If not specified, results will be logged to stderr.\n"
+		"  -m val     Serve per-stream metrics on the unix socket val. \"GET /metrics\" returns Prometheus text, \"GET /metrics.json\" returns JSON.\n"
+		"  -w val     Run the streams on val worker threads, pinned one per CPU, instead of a thread per stream. 0 uses one worker per CPU.\n"
+		"  -j val     Configure up to val streams at once. Defaults to the number of CPUs, 1 configures them one after the other.\n"
 		"\n"
 		"Examples:\n"
 		"  %s talker.ini\n"
@@ -137,8 +149,12 @@ void openavbTlHarnessUsage(char *programName)
 		"    Start 1 stream and override the sream_addr in the ini file.\n\n"
 		"  %s -i -s 8 -a 84:7E:40:2C:8F:DE listener.ini\n"
 		"    Work interactively with 8 streams overriding the stream_uid and stream_addr of each.\n\n"
+		"  %s -s 200 -m /tmp/avb_metrics listener.ini\n"
+		"    Start 200 streams and export their metrics. Scrape with: curl --unix-socket /tmp/avb_metrics http://localhost/metrics\n\n"
+		"  %s -s 128 -w 4 talker.ini listener.ini\n"
+		"    Start 256 streams on 4 worker threads and log the utilization of each worker.\n\n"
 		,
-		programName, programName, programName, programName, programName, programName, programName);
+		programName, programName, programName, programName, programName, programName, programName, programName, programName);
 }
 
 void openavbTlHarnessMenu()
@@ -152,11 +168,37 @@ void openavbTlHarnessMenu()
 		" 0-99         Toggle the state of the numbered stream\n"
 		" m            Display this menu\n"
 		" z            Stats\n"
+		" w            Pool worker utilization\n"
 		" x            Exit\n"
 		);
 }
 
 
+/***********************************************
+ * Print the load of each worker of the pool.
+ */
+static void openavbTlHarnessPoolReport(tl_pool_handle_t pool, bool bLog)
+{
+	U32 i1;
+	for (i1 = 0; i1 < openavbTLPoolWorkerCount(pool); i1++) {
+		openavb_tl_pool_stats_t stats;
+		if (!openavbTLPoolGetStats(pool, i1, &stats)) {
+			continue;
+		}
+
+		U32 average = stats.runNS ? (U32)((stats.busyNS * 100) / stats.runNS) : 0;
+		if (bLog) {
+			AVB_LOGF_INFO("Worker %u cpu %d: talkers=%u listeners=%u utilization=%u%% average=%u%% steps=%" PRIu64 " overruns=%" PRIu64,
+				i1, stats.cpu, stats.talkers, stats.listeners, stats.utilization, average, stats.steps, stats.overruns);
+		}
+		else {
+			printf("Worker %02u cpu %d: talkers=%u, listeners=%u, utilization=%u%%, average=%u%%, steps=%" PRIu64 ", overruns=%" PRIu64 "\n",
+				i1, stats.cpu, stats.talkers, stats.listeners, stats.utilization, average, stats.steps, stats.overruns);
+		}
+	}
+}
+
+
 /**********************************************
  * main
  */
@@ -167,6 +209,9 @@ int main(int argc, char *argv[])
 	// Command line vars
 	char *programName;
 	char *optStreamAddr = NULL;
+	char *optMetricsPath = NULL;
+	int optWorkers = -1;
+	long optConfigThreads = sysconf(_SC_NPROCESSORS_ONLN);
 	bool optInteractive = FALSE;
 	int optStreamCount = 1;
 	bool optStreamCountSet = FALSE;
@@ -181,6 +226,7 @@ int main(int argc, char *argv[])
 	int tlCount = 0;
 	char **tlIniList = NULL;
 	tl_handle_t *tlHandleList = NULL;
+	tl_pool_handle_t tlPool = NULL;
 
 	// General vars
 	int i1, i2;
@@ -193,12 +239,14 @@ int main(int argc, char *argv[])
 	sigaction(SIGINT, &sa, NULL);
 	sigaction(SIGTERM, &sa, NULL);
 	sigaction(SIGUSR1, &sa, NULL);
+	sigaction(SIGUSR2, &sa, NULL);
 
 	// Ignore SIGPIPE signals.
 	signal(SIGPIPE, SIG_IGN);
 
 	registerStaticMapModule(openavbMapPipeInitialize);
 	registerStaticMapModule(openavbMapAVTPAudioInitialize);
+	registerStaticMapModule(openavbMapCrfInitialize);
 	registerStaticMapModule(openavbMapCtrlInitialize);
 	registerStaticMapModule(openavbMapH264Initialize);
 	registerStaticMapModule(openavbMapMjpegInitialize);
@@ -215,6 +263,7 @@ int main(int argc, char *argv[])
 	registerStaticIntfModule(openavbIntfAlsaInitialize);
 	registerStaticIntfModule(openavbIntfMpeg2tsFileInitialize);
 	registerStaticIntfModule(openavbIntfWavFileInitialize);
+	registerStaticIntfModule(openavbIntfShmInitialize);
 #ifdef AVB_FEATURE_GSTREAMER
 	registerStaticIntfModule(openavbIntfMjpegGstInitialize);
 	registerStaticIntfModule(openavbIntfMpeg2tsGstInitialize);
@@ -231,7 +280,7 @@ int main(int argc, char *argv[])
 
 	bool optDone = FALSE;
 	while (!optDone) {
-		int opt = getopt(argc, argv, "a:his:d:I:l:");
+		int opt = getopt(argc, argv, "a:his:d:I:l:m:w:j:");
 		if (opt != EOF) {
 			switch (opt) {
 				case 'a':
@@ -254,6 +303,15 @@ int main(int argc, char *argv[])
 				case 'l':
 					optLogFileName = strdup(optarg);
 					break;
+				case 'm':
+					optMetricsPath = strdup(optarg);
+					break;
+				case 'w':
+					optWorkers = atoi(optarg);
+					break;
+				case 'j':
+					optConfigThreads = strtol(optarg, NULL, 0);
+					break;
 				case '?':
 				default:
 					openavbTlHarnessUsage(programName);
@@ -292,6 +350,28 @@ int main(int argc, char *argv[])
 		exit(-1);
 	}
 
+	if (optMetricsPath && !openavbMetricsServerStart(optMetricsPath)) {
+		AVB_LOG_ERROR("Unable to start metrics server");
+		osalAVBFinalize();
+		exit(-1);
+	}
+
+	if (optWorkers >= 0) {
+		// Pin the workers to the online CPUs, one each
+		int cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		if (cpus < 1) {
+			cpus = 1;
+		}
+		U32 cpuMask = cpus >= 32 ? 0xFFFFFFFF : (1U << cpus) - 1;
+
+		tlPool = openavbTLPoolCreate(optWorkers ? optWorkers : cpus, cpuMask, 0);
+		if (!tlPool) {
+			AVB_LOG_ERROR("Unable to create worker pool");
+			osalAVBFinalize();
+			exit(-1);
+		}
+	}
+
 	// Populate the ini file list
 	int tlIndex = 0;
 	for (i1 = 0; i1 < iniCount; i1++) {
@@ -339,33 +419,17 @@ int main(int argc, char *argv[])
 	for (i1 = 0; i1 < tlCount; i1++) {
 		printf("Opening: %s\n", tlIniList[i1]);
 		tlHandleList[i1] = openavbTLOpen();
+		if (tlPool) {
+			openavbTLPoolAttach(tlPool, tlHandleList[i1]);
+		}
 	}
 
 	// Parse ini and configure all streams
-	for (i1 = 0; i1 < tlCount; i1++) {
-		printf("Configuring: %s\n", tlIniList[i1]);
-		openavb_tl_cfg_t cfg;
-		openavb_tl_cfg_name_value_t NVCfg;
-
-		openavbTLInitCfg(&cfg);
-		memset(&NVCfg, 0, sizeof(NVCfg));
-
-		if (!openavbTLReadIniFileOsal(tlHandleList[i1], tlIniList[i1], &cfg, &NVCfg)) {
-			printf("Error reading ini file: %s\n", tlIniList[i1]);
-			osalAVBFinalize();
-			exit(-1);
-		}
-		if (!openavbTLConfigure(tlHandleList[i1], &cfg, &NVCfg)) {
-			printf("Error configuring: %s\n", tlIniList[i1]);
-			osalAVBFinalize();
-			exit(-1);
-		}
-
-		int i2;
-		for (i2 = 0; i2 < NVCfg.nLibCfgItems; i2++) {
-			free(NVCfg.libCfgNames[i2]);
-			free(NVCfg.libCfgValues[i2]);
-		}
+	printf("Configuring %d streams\n", tlCount);
+	if (!openavbTLConfigureIniFilesOsal(tlHandleList, tlIniList, tlCount, optConfigThreads > 0 ? optConfigThreads : 1)) {
+		printf("Error configuring streams\n");
+		osalAVBFinalize();
+		exit(-1);
 	}
 
 	if (!optInteractive) {
@@ -378,16 +442,22 @@ int main(int argc, char *argv[])
 			}
 		}
 
+		int reportMsec = 0;
 		while (bRunning) {
 			SLEEP_MSEC(1);
+
+			if (tlPool && ++reportMsec >= POOL_REPORT_SEC * 1000) {
+				openavbTlHarnessPoolReport(tlPool, TRUE);
+				reportMsec = 0;
+			}
 		}
 
 		for (i1 = 0; i1 < tlCount; i1++) {
 			if (tlHandleList[i1] && openavbTLIsRunning(tlHandleList[i1])) {
 				printf("Stopping: %s\n", tlIniList[i1]);
-				openavbTLStop(tlHandleList[i1]);
 			}
 		}
+		openavbTLStopAll(tlHandleList, tlCount);
 	}
 	else {
 		// Interactive mode
@@ -429,9 +499,9 @@ int main(int argc, char *argv[])
 						for (i1 = 0; i1 < tlCount; i1++) {
 							if (tlHandleList[i1] && openavbTLIsRunning(tlHandleList[i1])) {
 								printf("Stopping: %s\n", tlIniList[i1]);
-								openavbTLStop(tlHandleList[i1]);
 							}
 						}
+						openavbTLStopAll(tlHandleList, tlCount);
 					}
 					break;
 				case 'l':
@@ -452,6 +522,15 @@ int main(int argc, char *argv[])
 					// Display menu
 					openavbTlHarnessMenu();
 					break;
+				case 'w':
+					// Pool worker utilization
+					if (tlPool) {
+						openavbTlHarnessPoolReport(tlPool, FALSE);
+					}
+					else {
+						printf("Streams have their own threads. Start with -w to use a worker pool.\n");
+					}
+					break;
 				case 'z':
 					// Stats
 					{
@@ -460,18 +539,25 @@ int main(int argc, char *argv[])
 							if (tlHandleList[i1] && openavbTLIsRunning(tlHandleList[i1])) {
 								printf("%02d: [Started] %s\n", i1, tlIniList[i1]);
 								if (openavbTLGetRole(tlHandleList[i1]) == AVB_ROLE_TALKER) {
-									printf("     Talker totals: calls=%" PRIu64 ", frames=%" PRIu64 ", late=%" PRIu64 ", bytes=%" PRIu64 "\n",
+									printf("     Talker totals: calls=%" PRIu64 ", frames=%" PRIu64 ", late=%" PRIu64 ", bytes=%" PRIu64 ", xruns=%" PRIu64 "\n",
 										openavbTLStat(tlHandleList[i1], TL_STAT_TX_CALLS),
 										openavbTLStat(tlHandleList[i1], TL_STAT_TX_FRAMES),
 										openavbTLStat(tlHandleList[i1], TL_STAT_TX_LATE),
-										openavbTLStat(tlHandleList[i1], TL_STAT_TX_BYTES));
+										openavbTLStat(tlHandleList[i1], TL_STAT_TX_BYTES),
+										openavbTLStat(tlHandleList[i1], TL_STAT_INTF_XRUNS));
 								}
 								else if (openavbTLGetRole(tlHandleList[i1]) == AVB_ROLE_LISTENER) {
-									printf("     Listener totals: calls=%" PRIu64 ", frames=%" PRIu64 ", lost=%" PRIu64 ", bytes=%" PRIu64 "\n",
+									printf("     Listener totals: calls=%" PRIu64 ", frames=%" PRIu64 ", lost=%" PRIu64 ", bytes=%" PRIu64 ", xruns=%" PRIu64 "\n",
 										openavbTLStat(tlHandleList[i1], TL_STAT_RX_CALLS),
 										openavbTLStat(tlHandleList[i1], TL_STAT_RX_FRAMES),
 										openavbTLStat(tlHandleList[i1], TL_STAT_RX_LOST),
-										openavbTLStat(tlHandleList[i1], TL_STAT_RX_BYTES));
+										openavbTLStat(tlHandleList[i1], TL_STAT_RX_BYTES),
+										openavbTLStat(tlHandleList[i1], TL_STAT_INTF_XRUNS));
+									openavb_intf_latency_t latency;
+									if (openavbTLGetIntfLatency(tlHandleList[i1], FALSE, &latency) && latency.count) {
+										printf("     Latency: count=%" PRIu64 ", min=%" PRId64 ", mean=%" PRId64 ", p50=%" PRId64 ", p99=%" PRId64 ", p99.9=%" PRId64 ", max=%" PRId64 " ns\n",
+											latency.count, latency.minNS, latency.meanNS, latency.p50NS, latency.p99NS, latency.p999NS, latency.maxNS);
+									}
 								}
 							}
 							else {
@@ -487,9 +573,9 @@ int main(int argc, char *argv[])
 						for (i1 = 0; i1 < tlCount; i1++) {
 							if (tlHandleList[i1] && openavbTLIsRunning(tlHandleList[i1])) {
 								printf("Stopping: %s\n", tlIniList[i1]);
-								openavbTLStop(tlHandleList[i1]);
 							}
 						}
+						openavbTLStopAll(tlHandleList, tlCount);
 						bRunning = FALSE;
 					}
 					break;
@@ -525,14 +611,19 @@ int main(int argc, char *argv[])
 	}
 
 	// Close the streams
-	for (i1 = 0; i1 < tlCount; i1++) {
-		if (tlHandleList[i1]) {
-			printf("Closing: %s\n", tlIniList[i1]);
+	printf("Closing %d streams\n", tlCount);
+	openavbTLCloseAll(tlHandleList, tlCount);
 
-			openavbTLClose(tlHandleList[i1]);
+	if (tlPool) {
+		openavbTlHarnessPoolReport(tlPool, FALSE);
+		openavbTLPoolDelete(tlPool);
+		tlPool = NULL;
+	}
 
-			tlHandleList[i1] = NULL;
-		}
+	if (optMetricsPath) {
+		openavbMetricsServerStop();
+		free(optMetricsPath);
+		optMetricsPath = NULL;
 	}
 
 	openavbTLCleanup();
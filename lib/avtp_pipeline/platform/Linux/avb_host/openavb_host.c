@@ -40,6 +40,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_tl_pub.h"
 #include "openavb_plugin.h"
 #include "openavb_trace_pub.h"
+#include "openavb_metrics.h"
 #ifdef AVB_FEATURE_GSTREAMER
 #include <gst/gst.h>
 #endif
@@ -52,6 +53,7 @@ bool bRunning = TRUE;
 // Platform independent mapping modules
 extern bool openavbMapPipeInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
 extern bool openavbMapAVTPAudioInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapCrfInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
 extern bool openavbMapCtrlInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
 extern bool openavbMapH264Initialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
 extern bool openavbMapMjpegInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
@@ -71,6 +73,7 @@ extern bool openavbIntfViewerInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *p
 extern bool openavbIntfAlsaInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
 extern bool openavbIntfMpeg2tsFileInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
 extern bool openavbIntfWavFileInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+extern bool openavbIntfShmInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
 #ifdef AVB_FEATURE_GSTREAMER
 extern bool openavbIntfMjpegGstInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
 extern bool openavbIntfMpeg2tsGstInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
@@ -98,6 +101,9 @@ static void openavbTLSigHandler(int signal)
 	else if (signal == SIGUSR1) {
 		AVB_LOG_DEBUG("Waking up streaming thread");
 	}
+	else if (signal == SIGUSR2) {
+		avbTraceToggle();
+	}
 	else {
 		AVB_LOG_ERROR("Unexpected signal");
 	}
@@ -112,6 +118,9 @@ void openavbTlHostUsage(char *programName)
 		"Usage: %s [options] file...\n"
 		"  -I val     Use given (val) interface globally, can be overriden by giving the ifname= option to the config line.\n"
 		"  -l val     Filename of the log file to use.  If not specified, results will be logged to stderr.\n"
+		"  -m val     Serve per-stream metrics on the unix socket val. \"GET /metrics\" returns Prometheus text, \"GET /metrics.json\" returns JSON.\n"
+		"  -j val     Configure up to val streams at once. Defaults to the number of CPUs, 1 configures them one after the other.\n"
+		"  -b val     Start the streams of the bundle val, compiled by openavb_bundle_compile, instead of reading ini files.\n"
 		"\n"
 		"Examples:\n"
 		"  %s talker.ini\n"
@@ -122,8 +131,12 @@ void openavbTlHostUsage(char *programName)
 		"    Start 2 streams with data from the ini files, both talkers use eth0 interface.\n\n"
 		"  %s -I eth0 talker1.ini talker2.ini listener1.ini,ifname=pcap:eth0\n"
 		"    Start 3 streams with data from the ini files, talkers 1&2 use eth0 interface, listener1 use pcap:eth0.\n\n"
+		"  %s -m /tmp/avb_metrics talker1.ini talker2.ini\n"
+		"    Start 2 streams and export their metrics. Scrape with: curl --unix-socket /tmp/avb_metrics http://localhost/metrics\n\n"
+		"  %s -b streams.bundle\n"
+		"    Start the streams compiled into streams.bundle.\n\n"
 		,
-		programName, programName, programName, programName, programName);
+		programName, programName, programName, programName, programName, programName, programName);
 }
 
 /**********************************************
@@ -137,6 +150,9 @@ int main(int argc, char *argv[])
 	char *programName;
 	char *optIfnameGlobal = NULL;
 	char *optLogFileName = NULL;
+	char *optMetricsPath = NULL;
+	char *optBundleFile = NULL;
+	long optConfigThreads = sysconf(_SC_NPROCESSORS_ONLN);
 
 	programName = strrchr(argv[0], '/');
 	programName = programName ? programName + 1 : argv[0];
@@ -152,7 +168,7 @@ int main(int argc, char *argv[])
 	// Process command line
 	bool optDone = FALSE;
 	while (!optDone) {
-		int opt = getopt(argc, argv, "hI:l:");
+		int opt = getopt(argc, argv, "hI:l:m:j:b:");
 		if (opt != EOF) {
 			switch (opt) {
 				case 'I':
@@ -161,6 +177,15 @@ int main(int argc, char *argv[])
 				case 'l':
 					optLogFileName = strdup(optarg);
 					break;
+				case 'm':
+					optMetricsPath = strdup(optarg);
+					break;
+				case 'j':
+					optConfigThreads = strtol(optarg, NULL, 0);
+					break;
+				case 'b':
+					optBundleFile = strdup(optarg);
+					break;
 				case 'h':
 				default:
 					openavbTlHostUsage(programName);
@@ -177,6 +202,17 @@ int main(int argc, char *argv[])
 	iniIdx = optind;
 	U32 tlCount = argc - iniIdx;
 
+	// The whole bundle is checked before any stream is opened
+	tl_bundle_handle_t tlBundle = NULL;
+	if (optBundleFile) {
+		tlBundle = openavbTLBundleOpen(optBundleFile);
+		if (!tlBundle) {
+			osalAVBFinalize();
+			exit(-1);
+		}
+		tlCount = openavbTLBundleCount(tlBundle);
+	}
+
 	if (!openavbTLInitialize(tlCount)) {
 		AVB_LOG_ERROR("Unable to initialize talker listener library");
 		osalAVBFinalize();
@@ -211,12 +247,26 @@ int main(int argc, char *argv[])
 		osalAVBFinalize();
 		exit(-1);
 	}
+	err = sigaction(SIGUSR2, &sa, NULL);
+	if (err)
+	{
+		AVB_LOG_ERROR("Failed to setup SIGUSR2 handler");
+		osalAVBFinalize();
+		exit(-1);
+	}
 
 	// Ignore SIGPIPE signals.
 	signal(SIGPIPE, SIG_IGN);
 
+	if (optMetricsPath && !openavbMetricsServerStart(optMetricsPath)) {
+		AVB_LOG_ERROR("Unable to start metrics server");
+		osalAVBFinalize();
+		exit(-1);
+	}
+
 	registerStaticMapModule(openavbMapPipeInitialize);
 	registerStaticMapModule(openavbMapAVTPAudioInitialize);
+	registerStaticMapModule(openavbMapCrfInitialize);
 	registerStaticMapModule(openavbMapCtrlInitialize);
 	registerStaticMapModule(openavbMapH264Initialize);
 	registerStaticMapModule(openavbMapMjpegInitialize);
@@ -233,6 +283,7 @@ int main(int argc, char *argv[])
 	registerStaticIntfModule(openavbIntfAlsaInitialize);
 	registerStaticIntfModule(openavbIntfMpeg2tsFileInitialize);
 	registerStaticIntfModule(openavbIntfWavFileInitialize);
+	registerStaticIntfModule(openavbIntfShmInitialize);
 #ifdef AVB_FEATURE_GSTREAMER
 	registerStaticIntfModule(openavbIntfMjpegGstInitialize);
 	registerStaticIntfModule(openavbIntfMpeg2tsGstInitialize);
@@ -245,37 +296,39 @@ int main(int argc, char *argv[])
 		tlHandleList[i1] = openavbTLOpen();
 	}
 
-	// Parse ini and configure all streams
-	for (i1 = 0; i1 < tlCount; i1++) {
-		openavb_tl_cfg_t cfg;
-		openavb_tl_cfg_name_value_t NVCfg;
-		char iniFile[1024];
+	bool bConfigured;
+	if (tlBundle) {
+		// Configure all streams from the bundle
+		bConfigured = openavbTLConfigureBundleOsal(tlHandleList, tlBundle, optConfigThreads > 0 ? optConfigThreads : 1);
+		openavbTLBundleClose(tlBundle);
+		tlBundle = NULL;
+	}
+	else {
+		// Parse ini and configure all streams
+		char **iniFileList = calloc(tlCount, sizeof(char *));
+		for (i1 = 0; i1 < tlCount; i1++) {
+			char iniFile[1024];
 
-		snprintf(iniFile, sizeof(iniFile), "%s", argv[i1 + iniIdx]);
+			snprintf(iniFile, sizeof(iniFile), "%s", argv[i1 + iniIdx]);
 
-		if (optIfnameGlobal && !strcasestr(iniFile, ",ifname=")) {
-			snprintf(iniFile + strlen(iniFile), sizeof(iniFile), ",ifname=%s", optIfnameGlobal);
+			if (optIfnameGlobal && !strcasestr(iniFile, ",ifname=")) {
+				snprintf(iniFile + strlen(iniFile), sizeof(iniFile) - strlen(iniFile), ",ifname=%s", optIfnameGlobal);
+			}
+
+			iniFileList[i1] = strdup(iniFile);
 		}
 
-		openavbTLInitCfg(&cfg);
-		memset(&NVCfg, 0, sizeof(NVCfg));
+		bConfigured = openavbTLConfigureIniFilesOsal(tlHandleList, iniFileList, tlCount, optConfigThreads > 0 ? optConfigThreads : 1);
 
-		if (!openavbTLReadIniFileOsal(tlHandleList[i1], iniFile, &cfg, &NVCfg)) {
-			AVB_LOGF_ERROR("Error reading ini file: %s\n", argv[i1 + 1]);
-			osalAVBFinalize();
-			exit(-1);
-		}
-		if (!openavbTLConfigure(tlHandleList[i1], &cfg, &NVCfg)) {
-			AVB_LOGF_ERROR("Error configuring: %s\n", argv[i1 + 1]);
-			osalAVBFinalize();
-			exit(-1);
+		for (i1 = 0; i1 < tlCount; i1++) {
+			free(iniFileList[i1]);
 		}
+		free(iniFileList);
+	}
 
-		int i2;
-		for (i2 = 0; i2 < NVCfg.nLibCfgItems; i2++) {
-			free(NVCfg.libCfgNames[i2]);
-			free(NVCfg.libCfgValues[i2]);
-		}
+	if (!bConfigured) {
+		osalAVBFinalize();
+		exit(-1);
 	}
 
 #ifdef AVB_FEATURE_GSTREAMER
@@ -295,12 +348,14 @@ int main(int argc, char *argv[])
 		SLEEP_MSEC(1);
 	}
 
-	for (i1 = 0; i1 < tlCount; i1++) {
-		openavbTLStop(tlHandleList[i1]);
-	}
+	openavbTLStopAll(tlHandleList, tlCount);
+	openavbTLCloseAll(tlHandleList, tlCount);
+	free(tlHandleList);
 
-	for (i1 = 0; i1 < tlCount; i1++) {
-		openavbTLClose(tlHandleList[i1]);
+	if (optMetricsPath) {
+		openavbMetricsServerStop();
+		free(optMetricsPath);
+		optMetricsPath = NULL;
 	}
 
 	openavbTLCleanup();
@@ -310,6 +365,11 @@ int main(int argc, char *argv[])
 		optLogFileName = NULL;
 	}
 
+	if (optBundleFile) {
+		free(optBundleFile);
+		optBundleFile = NULL;
+	}
+
 #ifdef AVB_FEATURE_GSTREAMER
 	// If we're supporting the interface modules which use GStreamer,
 	// De-initialize GStreamer to clean up resources.
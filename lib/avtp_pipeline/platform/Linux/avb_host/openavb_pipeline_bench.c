@@ -0,0 +1,1329 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Microbenchmarks for the AVTP pipeline hot paths.
+*
+* Times the media queue, the Tx and Rx callbacks of the mapping modules, the AVTP stream
+* header, clock reads, logging and tracing, together with the sample conversion kernels the
+* audio mappings select at run time. Everything runs in process without a network interface,
+* so the results only depend on the build and the CPU. Results are written as JSON lines or
+* CSV and can be compared with a previous run to fail on a slowdown.
+*/
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <signal.h>
+#include "openavb_platform_pub.h"
+#include "openavb_osal_pub.h"
+#include "openavb_trace_pub.h"
+#include "openavb_mediaq_pub.h"
+#include "openavb_map_pub.h"
+#include "openavb_avtp.h"
+#include "openavb_avtp_time_pub.h"
+#include "openavb_map_uncmp_audio_pub.h"
+#include "openavb_map_h264_pub.h"
+#include "openavb_map_mjpeg_pub.h"
+#include "openavb_map_aaf_audio_convert.h"
+#include "openavb_map_uncmp_audio_am824.h"
+#include "openavb_map_mpeg2ts_sync.h"
+#include <inttypes.h>
+
+#define	AVB_LOG_COMPONENT	"Pipeline Bench"
+#include "openavb_log_pub.h"
+
+#define BENCH_DEFAULT_MIN_MSEC		50		// Minimum time of each repetition
+#define BENCH_DEFAULT_REPS			5
+#define BENCH_DEFAULT_THRESHOLD_PCT	10		// Allowed slowdown against the baseline
+#define BENCH_MAX					128
+#define BENCH_MAX_REPS				64
+#define BENCH_NAME_LEN				64
+
+#define BENCH_BATCH					1024	// Operations per batch of the simple benchmarks
+#define BENCH_LOG_BATCH				256		// Messages per batch, fits the per thread log ring
+#define BENCH_MEDIAQ_ITEMS			32
+#define BENCH_KERNEL_SAMPLES		1536	// Samples converted by one kernel call
+#define BENCH_KERNEL_CALLS			16		// Kernel calls per batch
+#define BENCH_TS_SCAN_LEN			9024	// Bytes scanned for a sync byte, one mpeg2ts item
+#define BENCH_MAP_ITEMS				32		// Talker media queue items
+#define BENCH_MAP_FRAMES			64		// Frames built per batch and listener media queue items
+#define BENCH_MAP_TRANSIT_USEC		2000
+
+// Keeps the compiler from dropping the work of a batch
+#define BENCH_CLOBBER()	__asm__ __volatile__("" : : : "memory")
+
+typedef enum {
+	BENCH_FORMAT_JSON,
+	BENCH_FORMAT_CSV,
+	BENCH_FORMAT_TEXT,
+} bench_format_t;
+
+// Runs one batch and returns the time taken in nanoseconds. *pOps is set to the operations done.
+typedef U64 (*bench_batch_fn_t)(void *pArg, U32 *pOps);
+
+typedef struct {
+	char name[BENCH_NAME_LEN];
+	bool (*setupFn)(void *pArg);
+	bench_batch_fn_t batchFn;
+	void (*teardownFn)(void *pArg);
+	void *pArg;
+	U32 bytesPerOp;
+	// Each repetition is one batch followed by a pause, for work drained by another thread
+	bool bSingleBatch;
+	// Setup may fail where the benchmark does not apply, i.e. walltime without gPTP
+	bool bOptional;
+} bench_t;
+
+typedef struct {
+	char name[BENCH_NAME_LEN];
+	U64 ops;
+	double nsPerOp;				// Median of the repetitions
+	double nsPerOpMin;
+	U32 bytesPerOp;
+} bench_result_t;
+
+typedef struct {
+	char name[BENCH_NAME_LEN];
+	double nsPerOp;
+} bench_baseline_t;
+
+// Platform independent mapping modules
+extern bool openavbMapPipeInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapAVTPAudioInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapCrfInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapCtrlInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapH264Initialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapMjpegInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapMpeg2tsInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapNullInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapUncmpAudioInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+
+static bool bRunning = TRUE;
+
+static bench_t benchList[BENCH_MAX];
+static U32 benchCount = 0;
+
+// Results of the benchmarks end up here so they are not optimized away
+static volatile U64 benchSink;
+
+static void openavbPipelineBenchSigHandler(int signal)
+{
+	if (signal == SIGINT || signal == SIGTERM) {
+		if (bRunning) {
+			bRunning = FALSE;
+		}
+		else {
+			// Force shutdown
+			exit(2);
+		}
+	}
+}
+
+void openavbPipelineBenchUsage(char *programName)
+{
+	printf(
+		"\n"
+		"Usage: %s [options]\n"
+		"  -h         Prints this message.\n"
+		"  -f val     Output format: json (one object per line, default), csv or text.\n"
+		"  -o val     Write the results to file val instead of stdout.\n"
+		"  -t val     Run each repetition of a benchmark for at least val msec. Defaults to %d.\n"
+		"  -r val     Repetitions of each benchmark, the median is reported. Defaults to %d.\n"
+		"  -m val     Only run the benchmarks whose name contains val.\n"
+		"  -L         List the benchmarks and exit.\n"
+		"  -b val     Compare with the json results in file val and exit with 1 on a regression.\n"
+		"  -x val     Percent a benchmark may be slower than the baseline. Defaults to %d.\n"
+		"  -l val     Filename of the log file to use.  If not specified, results will be logged to stderr.\n"
+		"\n"
+		"Examples:\n"
+		"  %s -o baseline.json\n"
+		"    Run all benchmarks and keep the results.\n\n"
+		"  %s -b baseline.json\n"
+		"    Run again and fail if any benchmark got more than %d%% slower.\n\n"
+		"  %s -f text -m map.aaf\n"
+		"    Show the AAF mapping results only.\n\n"
+		,
+		programName, BENCH_DEFAULT_MIN_MSEC, BENCH_DEFAULT_REPS, BENCH_DEFAULT_THRESHOLD_PCT,
+		programName, programName, BENCH_DEFAULT_THRESHOLD_PCT, programName);
+}
+
+static U64 x_nowNS(void)
+{
+	U64 nowNS = 0;
+	CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &nowNS);
+	return nowNS;
+}
+
+static int x_compareDouble(const void *pA, const void *pB)
+{
+	double a = *(const double *)pA;
+	double b = *(const double *)pB;
+	return a < b ? -1 : a > b ? 1 : 0;
+}
+
+static bench_t *x_benchAdd(bench_batch_fn_t batchFn, void *pArg, U32 bytesPerOp, const char *pFmt, ...)
+{
+	if (benchCount >= BENCH_MAX) {
+		AVB_LOG_ERROR("Too many benchmarks");
+		return NULL;
+	}
+
+	bench_t *pBench = &benchList[benchCount++];
+	memset(pBench, 0, sizeof(*pBench));
+
+	va_list args;
+	va_start(args, pFmt);
+	vsnprintf(pBench->name, sizeof(pBench->name), pFmt, args);
+	va_end(args);
+
+	pBench->batchFn = batchFn;
+	pBench->pArg = pArg;
+	pBench->bytesPerOp = bytesPerOp;
+	return pBench;
+}
+
+
+/***********************************************
+ * Media queue
+ */
+typedef struct {
+	bool bThreadSafe;
+	media_q_t *pMediaQ;
+} bench_mediaq_t;
+
+static bench_mediaq_t benchMediaQ = { FALSE, NULL };
+static bench_mediaq_t benchMediaQThreadSafe = { TRUE, NULL };
+
+static bool x_mediaQSetup(void *pArg)
+{
+	bench_mediaq_t *pState = pArg;
+
+	pState->pMediaQ = openavbMediaQCreate();
+	if (!pState->pMediaQ) {
+		return FALSE;
+	}
+	if (pState->bThreadSafe) {
+		openavbMediaQThreadSafeOn(pState->pMediaQ);
+	}
+	return openavbMediaQSetSize(pState->pMediaQ, BENCH_MEDIAQ_ITEMS, 1024);
+}
+
+static void x_mediaQTeardown(void *pArg)
+{
+	bench_mediaq_t *pState = pArg;
+
+	openavbMediaQDelete(pState->pMediaQ);
+	pState->pMediaQ = NULL;
+}
+
+// One item in flight, as a talker whose interface keeps up with the map
+static U64 x_mediaQPushPull(void *pArg, U32 *pOps)
+{
+	media_q_t *pMediaQ = ((bench_mediaq_t *)pArg)->pMediaQ;
+	U32 i1;
+
+	U64 startNS = x_nowNS();
+	for (i1 = 0; i1 < BENCH_BATCH; i1++) {
+		media_q_item_t *pItem = openavbMediaQHeadLock(pMediaQ);
+		if (!pItem) {
+			break;
+		}
+		pItem->dataLen = 64;
+		openavbMediaQHeadPush(pMediaQ);
+
+		pItem = openavbMediaQTailLock(pMediaQ, TRUE);
+		if (!pItem) {
+			break;
+		}
+		openavbMediaQTailPull(pMediaQ);
+	}
+	U64 elapsedNS = x_nowNS() - startNS;
+
+	*pOps = i1;
+	return elapsedNS;
+}
+
+// Fill the queue and drain it again
+static U64 x_mediaQBurst(void *pArg, U32 *pOps)
+{
+	media_q_t *pMediaQ = ((bench_mediaq_t *)pArg)->pMediaQ;
+	media_q_item_t *pItem;
+	U32 ops = 0;
+	U32 i1;
+
+	U64 startNS = x_nowNS();
+	for (i1 = 0; i1 < BENCH_BATCH / BENCH_MEDIAQ_ITEMS; i1++) {
+		while ((pItem = openavbMediaQHeadLock(pMediaQ)) != NULL) {
+			pItem->dataLen = 64;
+			openavbMediaQHeadPush(pMediaQ);
+		}
+		while ((pItem = openavbMediaQTailLock(pMediaQ, TRUE)) != NULL) {
+			openavbMediaQTailPull(pMediaQ);
+			ops++;
+		}
+	}
+	U64 elapsedNS = x_nowNS() - startNS;
+
+	*pOps = ops;
+	return elapsedNS;
+}
+
+
+/***********************************************
+ * AVTP stream header
+ */
+#define BENCH_AVTP_FRAMES	256		// One frame per sequence number, so no frame looks lost
+
+typedef struct {
+	U8 frames[BENCH_AVTP_FRAMES][AVTP_COMMON_STREAM_DATA_HDR_LEN];
+	openavb_map_cb_t mapCB;
+	avtp_stream_t stream;
+} bench_avtp_t;
+
+static bench_avtp_t benchAvtp;
+
+static U8 x_avtpVersionCB(void)
+{
+	return 0;
+}
+
+// Stands in for the mapping module, so only the AVTP layer is timed
+static bool x_avtpRxCB(media_q_t *pMediaQ, U8 *pData, U32 dataLen)
+{
+	BENCH_CLOBBER();
+	return TRUE;
+}
+
+static bool x_avtpSetup(void *pArg)
+{
+	bench_avtp_t *pState = pArg;
+	static const U8 streamIDnet[8] = { 0x00, 0x1b, 0x21, 0x00, 0x00, 0x01, 0x00, 0x01 };
+	U32 i1;
+
+	memset(pState, 0, sizeof(*pState));
+	pState->mapCB.map_avtp_version_cb = x_avtpVersionCB;
+	pState->mapCB.map_rx_cb = x_avtpRxCB;
+	pState->stream.pMapCB = &pState->mapCB;
+	pState->stream.subtype = 0x02;
+	memcpy(pState->stream.streamIDnet, streamIDnet, sizeof(pState->stream.streamIDnet));
+
+	for (i1 = 0; i1 < BENCH_AVTP_FRAMES; i1++) {
+		if (IS_OPENAVB_FAILURE(openavbAvtpFillHdr(&pState->stream, pState->frames[i1]))) {
+			return FALSE;
+		}
+		pState->stream.avtp_sequence_num++;
+	}
+	return TRUE;
+}
+
+// The header fill of openavbAvtpTx()
+static U64 x_avtpFill(void *pArg, U32 *pOps)
+{
+	bench_avtp_t *pState = pArg;
+	U32 i1;
+
+	U64 startNS = x_nowNS();
+	for (i1 = 0; i1 < BENCH_BATCH; i1++) {
+		openavbAvtpFillHdr(&pState->stream, pState->frames[i1 % BENCH_AVTP_FRAMES]);
+		pState->stream.avtp_sequence_num++;
+		BENCH_CLOBBER();
+	}
+	U64 elapsedNS = x_nowNS() - startNS;
+
+	*pOps = i1;
+	return elapsedNS;
+}
+
+// The header checks and loss count of openavbAvtpRx(), up to the mapping module
+static U64 x_avtpParse(void *pArg, U32 *pOps)
+{
+	bench_avtp_t *pState = pArg;
+	U32 i1;
+
+	pState->stream.nLost = -1;
+	U64 startNS = x_nowNS();
+	for (i1 = 0; i1 < BENCH_BATCH; i1++) {
+		openavbAvtpRxFrame(&pState->stream, pState->frames[i1 % BENCH_AVTP_FRAMES], AVTP_COMMON_STREAM_DATA_HDR_LEN);
+		BENCH_CLOBBER();
+	}
+	U64 elapsedNS = x_nowNS() - startNS;
+
+	benchSink += pState->stream.nLost;
+	*pOps = i1;
+	return elapsedNS;
+}
+
+
+/***********************************************
+ * Clocks
+ */
+static openavb_clockId_t benchClockMonotonic = OPENAVB_CLOCK_MONOTONIC;
+static openavb_clockId_t benchClockWalltime = OPENAVB_CLOCK_WALLTIME;
+
+static bool x_wallTimeSetup(void *pArg)
+{
+	// Walltime comes from the gPTP daemon shared memory
+	if (!osalAVBTimeInit()) {
+		AVB_LOG_WARNING("gPTP is not running, clock.walltime skipped");
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static U64 x_clockRead(void *pArg, U32 *pOps)
+{
+	openavb_clockId_t clockId = *(openavb_clockId_t *)pArg;
+	U64 sum = 0;
+	U32 i1;
+
+	U64 startNS = x_nowNS();
+	for (i1 = 0; i1 < BENCH_BATCH; i1++) {
+		U64 timeNS = 0;
+		CLOCK_GETTIME64(clockId, &timeNS);
+		sum += timeNS;
+	}
+	U64 elapsedNS = x_nowNS() - startNS;
+
+	benchSink += sum;
+	*pOps = i1;
+	return elapsedNS;
+}
+
+
+/***********************************************
+ * Log and trace
+ */
+
+// A rate limited message as used on the Tx and Rx paths, nearly always skipped
+static U64 x_logInterval(void *pArg, U32 *pOps)
+{
+	U32 i1;
+
+	U64 startNS = x_nowNS();
+	for (i1 = 0; i1 < BENCH_BATCH; i1++) {
+		IF_LOG_INTERVAL(BENCH_BATCH * 1024) AVB_LOGF_STATUS("Pipeline bench interval message %u", i1);
+	}
+	U64 elapsedNS = x_nowNS() - startNS;
+
+	*pOps = i1;
+	return elapsedNS;
+}
+
+// Capture into the thread ring. The logging thread formats and writes the messages later.
+static U64 x_logCapture(void *pArg, U32 *pOps)
+{
+	U32 i1;
+
+	U64 startNS = x_nowNS();
+	for (i1 = 0; i1 < BENCH_LOG_BATCH; i1++) {
+		AVB_LOGF_STATUS("Pipeline bench message %u %s", i1, "status");
+	}
+	U64 elapsedNS = x_nowNS() - startNS;
+
+	*pOps = i1;
+	return elapsedNS;
+}
+
+static bool x_traceOtherSetup(void *pArg)
+{
+	avbTraceSetFeatures("AVTP");
+	return TRUE;
+}
+
+static bool x_traceOnSetup(void *pArg)
+{
+	avbTraceSetFeatures("HOST");
+	return TRUE;
+}
+
+static void x_traceTeardown(void *pArg)
+{
+	avbTraceSetFeatures(NULL);
+}
+
+// One entry / exit pair per operation
+static U64 x_tracePair(void *pArg, U32 *pOps)
+{
+	U32 i1;
+
+	U64 startNS = x_nowNS();
+	for (i1 = 0; i1 < BENCH_BATCH; i1++) {
+		AVB_TRACE_ENTRY(AVB_TRACE_HOST);
+		BENCH_CLOBBER();
+		AVB_TRACE_EXIT(AVB_TRACE_HOST);
+	}
+	U64 elapsedNS = x_nowNS() - startNS;
+
+	*pOps = i1;
+	return elapsedNS;
+}
+
+
+/***********************************************
+ * Audio sample kernels, the selected implementation against the scalar one
+ */
+static U8 benchKernelSrc[BENCH_KERNEL_SAMPLES * 8] __attribute__((aligned(64)));
+static U8 benchKernelDst[BENCH_KERNEL_SAMPLES * 8] __attribute__((aligned(64)));
+
+static void x_kernelFill(void)
+{
+	float *pFloat = (float *)benchKernelSrc;
+	U32 i1;
+
+	// Valid float samples for the encoders, the other kernels take any bit pattern
+	for (i1 = 0; i1 < BENCH_KERNEL_SAMPLES; i1++) {
+		pFloat[i1] = (float)((int)(i1 % 2001) - 1000) / 1000.0f;
+	}
+}
+
+typedef struct {
+	openavb_aaf_convert_fn_t convertFn;
+} bench_convert_t;
+
+static bench_convert_t benchConvert[2][6];
+
+static U64 x_aafConvert(void *pArg, U32 *pOps)
+{
+	openavb_aaf_convert_fn_t convertFn = ((bench_convert_t *)pArg)->convertFn;
+	U32 i1;
+
+	U64 startNS = x_nowNS();
+	for (i1 = 0; i1 < BENCH_KERNEL_CALLS; i1++) {
+		convertFn(benchKernelDst, benchKernelSrc, BENCH_KERNEL_SAMPLES);
+		BENCH_CLOBBER();
+	}
+	U64 elapsedNS = x_nowNS() - startNS;
+
+	*pOps = i1;
+	return elapsedNS;
+}
+
+static bool benchScalar = TRUE;
+static bool benchSelected = FALSE;
+
+// float32 items to 24 bit wire samples and back
+static U64 x_aafEncode(void *pArg, U32 *pOps)
+{
+	bool bScalar = *(bool *)pArg;
+	U32 i1;
+
+	U64 startNS = x_nowNS();
+	for (i1 = 0; i1 < BENCH_KERNEL_CALLS; i1++) {
+		if (bScalar) {
+			openavbAafEncodeSamplesScalar(benchKernelDst, 3, 3, FALSE, benchKernelSrc, 4, TRUE, BENCH_KERNEL_SAMPLES);
+		}
+		else {
+			openavbAafEncodeSamples(benchKernelDst, 3, 3, FALSE, benchKernelSrc, 4, TRUE, BENCH_KERNEL_SAMPLES);
+		}
+		BENCH_CLOBBER();
+	}
+	U64 elapsedNS = x_nowNS() - startNS;
+
+	*pOps = i1;
+	return elapsedNS;
+}
+
+static U64 x_aafDecode(void *pArg, U32 *pOps)
+{
+	bool bScalar = *(bool *)pArg;
+	U32 i1;
+
+	U64 startNS = x_nowNS();
+	for (i1 = 0; i1 < BENCH_KERNEL_CALLS; i1++) {
+		if (bScalar) {
+			openavbAafDecodeSamplesScalar(benchKernelDst, 4, TRUE, benchKernelSrc, 3, 3, FALSE, BENCH_KERNEL_SAMPLES);
+		}
+		else {
+			openavbAafDecodeSamples(benchKernelDst, 4, TRUE, benchKernelSrc, 3, 3, FALSE, BENCH_KERNEL_SAMPLES);
+		}
+		BENCH_CLOBBER();
+	}
+	U64 elapsedNS = x_nowNS() - startNS;
+
+	*pOps = i1;
+	return elapsedNS;
+}
+
+// AM824 packs one 61883-6 packet of 6 frames per operation
+#define BENCH_AM824_FRAMES		6
+
+typedef struct {
+	U32 sampleCount;
+	openavb_am824_pack_fn_t packFn;
+	openavb_am824_unpack_fn_t unpackFn;
+} bench_am824_t;
+
+static bench_am824_t benchAm824[2][2][4];
+
+static U64 x_am824Pack(void *pArg, U32 *pOps)
+{
+	bench_am824_t *pState = pArg;
+	U32 i1;
+
+	U64 startNS = x_nowNS();
+	for (i1 = 0; i1 < BENCH_BATCH; i1++) {
+		pState->packFn(benchKernelDst, benchKernelSrc, pState->sampleCount, 0x40);
+		BENCH_CLOBBER();
+	}
+	U64 elapsedNS = x_nowNS() - startNS;
+
+	*pOps = i1;
+	return elapsedNS;
+}
+
+static U64 x_am824Unpack(void *pArg, U32 *pOps)
+{
+	bench_am824_t *pState = pArg;
+	U32 i1;
+
+	U64 startNS = x_nowNS();
+	for (i1 = 0; i1 < BENCH_BATCH; i1++) {
+		pState->unpackFn(benchKernelDst, benchKernelSrc, pState->sampleCount);
+		BENCH_CLOBBER();
+	}
+	U64 elapsedNS = x_nowNS() - startNS;
+
+	*pOps = i1;
+	return elapsedNS;
+}
+
+// Worst case resync, no sync byte in the whole item
+static U8 benchTsData[BENCH_TS_SCAN_LEN + 188];
+static openavb_mpeg2ts_sync_scan_fn_t benchTsScan[2];
+
+static U64 x_mpeg2tsScan(void *pArg, U32 *pOps)
+{
+	openavb_mpeg2ts_sync_scan_fn_t scanFn = *(openavb_mpeg2ts_sync_scan_fn_t *)pArg;
+	U32 i1;
+
+	U64 startNS = x_nowNS();
+	for (i1 = 0; i1 < BENCH_KERNEL_CALLS; i1++) {
+		benchSink += scanFn(benchTsData, BENCH_TS_SCAN_LEN, 0, 188);
+	}
+	U64 elapsedNS = x_nowNS() - startNS;
+
+	*pOps = i1;
+	return elapsedNS;
+}
+
+
+/***********************************************
+ * Mapping modules. A talker media queue feeds the Tx callback, the frames it builds are
+ * given to the Rx callback of a listener media queue. Each batch times the two separately.
+ */
+typedef void (*bench_item_fn_t)(media_q_item_t *pItem);
+
+typedef struct {
+	const char *pName;
+	openavb_map_initialize_fn_t initFn;
+	const char *pCfg;			// "name=value,..." map_nv_ items
+	avb_audio_type_t audioType;	// Audio mappings when audioChannels is set
+	avb_audio_bit_depth_t audioBitDepth;
+	avb_audio_channels_t audioChannels;
+	U32 itemFill;				// Bytes put in each talker item, 0 for the item size
+	bench_item_fn_t itemFn;
+} bench_map_cfg_t;
+
+typedef struct {
+	const bench_map_cfg_t *pCfg;
+	bool bRx;
+	media_q_t *pTalkerQ;
+	media_q_t *pListenerQ;
+	openavb_map_cb_t talkerCB;
+	openavb_map_cb_t listenerCB;
+	avtp_stream_t talker;		// AVTP state of the talker, for the stream header
+	U32 frameSize;
+	U8 *pFrames;
+	U32 frameLen[BENCH_MAP_FRAMES];
+} bench_map_t;
+
+static void x_h264Item(media_q_item_t *pItem)
+{
+	media_q_item_map_h264_pub_data_t *pPubMapData = pItem->pPubMapData;
+	pPubMapData->lastPacket = TRUE;
+	pPubMapData->timestamp = 0;
+	pPubMapData->accessUnit = FALSE;
+	// Single NAL unit packet
+	((U8 *)pItem->pPubData)[0] = 0x65;
+}
+
+static void x_mjpegItem(media_q_item_t *pItem)
+{
+	media_q_item_map_mjpeg_pub_data_t *pPubMapData = pItem->pPubMapData;
+	pPubMapData->lastFragment = TRUE;
+}
+
+static void x_mpeg2tsItem(media_q_item_t *pItem)
+{
+	static U8 continuity = 0;
+	U8 *pData = pItem->pPubData;
+	U32 offset;
+
+	pItem->dataLen -= pItem->dataLen % 188;
+	for (offset = 0; offset + 188 <= pItem->dataLen; offset += 188) {
+		pData[offset] = 0x47;
+		pData[offset + 1] = 0x01;
+		pData[offset + 2] = 0x00;
+		pData[offset + 3] = 0x10 | (continuity++ & 0x0F);
+	}
+}
+
+static const bench_map_cfg_t benchMapCfgs[] = {
+	{ "null", openavbMapNullInitialize, NULL, 0, 0, 0, 0, NULL },
+	{ "pipe", openavbMapPipeInitialize, NULL, 0, 0, 0, 512, NULL },
+	{ "ctrl", openavbMapCtrlInitialize, NULL, 0, 0, 0, 512, NULL },
+	// No media clock recovery, that pushes to the clock hardware
+	{ "crf", openavbMapCrfInitialize, "map_nv_audio_mcr=0", 0, 0, 0, 0, NULL },
+	{ "h264", openavbMapH264Initialize, NULL, 0, 0, 0, 1024, x_h264Item },
+	{ "mjpeg", openavbMapMjpegInitialize, NULL, 0, 0, 0, 1024, x_mjpegItem },
+	{ "mpeg2ts", openavbMapMpeg2tsInitialize, NULL, 0, 0, 0, 0, x_mpeg2tsItem },
+	{ "uncmp_audio.2ch_s24", openavbMapUncmpAudioInitialize, "map_nv_tx_rate=8000",
+		AVB_AUDIO_TYPE_INT, AVB_AUDIO_BIT_DEPTH_24BIT, 2, 0, NULL },
+	{ "uncmp_audio.8ch_s16", openavbMapUncmpAudioInitialize, "map_nv_tx_rate=8000",
+		AVB_AUDIO_TYPE_INT, AVB_AUDIO_BIT_DEPTH_16BIT, 8, 0, NULL },
+	{ "aaf.2ch_s16", openavbMapAVTPAudioInitialize, "map_nv_tx_rate=8000",
+		AVB_AUDIO_TYPE_INT, AVB_AUDIO_BIT_DEPTH_16BIT, 2, 0, NULL },
+	// The same streams through the generic callbacks, for the specialized path gain
+	{ "aaf.2ch_s16.generic", openavbMapAVTPAudioInitialize, "map_nv_tx_rate=8000,map_nv_fast_path=0",
+		AVB_AUDIO_TYPE_INT, AVB_AUDIO_BIT_DEPTH_16BIT, 2, 0, NULL },
+	{ "aaf.8ch_s24", openavbMapAVTPAudioInitialize, "map_nv_tx_rate=8000",
+		AVB_AUDIO_TYPE_INT, AVB_AUDIO_BIT_DEPTH_24BIT, 8, 0, NULL },
+	{ "aaf.8ch_s24.generic", openavbMapAVTPAudioInitialize, "map_nv_tx_rate=8000,map_nv_fast_path=0",
+		AVB_AUDIO_TYPE_INT, AVB_AUDIO_BIT_DEPTH_24BIT, 8, 0, NULL },
+	{ "aaf.2ch_s24.float32", openavbMapAVTPAudioInitialize, "map_nv_tx_rate=8000,map_nv_item_format=float32",
+		AVB_AUDIO_TYPE_INT, AVB_AUDIO_BIT_DEPTH_24BIT, 2, 0, NULL },
+};
+
+#define BENCH_MAP_CFG_COUNT	(sizeof(benchMapCfgs) / sizeof(benchMapCfgs[0]))
+
+static bench_map_t benchMaps[BENCH_MAP_CFG_COUNT][2];
+
+/***********************************************
+ * Create a media queue and run a mapping module through the same steps as
+ * openavbTLConfigure() and the Tx / Rx thread start.
+ */
+static media_q_t *x_mapOpen(const bench_map_cfg_t *pCfg, openavb_map_cb_t *pMapCB, bool bTalker, U32 itemCount)
+{
+	media_q_t *pMediaQ = openavbMediaQCreate();
+	if (!pMediaQ) {
+		return NULL;
+	}
+
+	memset(pMapCB, 0, sizeof(*pMapCB));
+	if (!pCfg->initFn(pMediaQ, pMapCB, BENCH_MAP_TRANSIT_USEC)) {
+		openavbMediaQDelete(pMediaQ);
+		return NULL;
+	}
+
+	char value[16];
+	snprintf(value, sizeof(value), "%u", itemCount);
+	pMapCB->map_cfg_cb(pMediaQ, "map_nv_item_count", value);
+
+	if (pCfg->pCfg) {
+		char cfg[256];
+		char *pSave = NULL;
+		char *pItem;
+
+		snprintf(cfg, sizeof(cfg), "%s", pCfg->pCfg);
+		for (pItem = strtok_r(cfg, ",", &pSave); pItem; pItem = strtok_r(NULL, ",", &pSave)) {
+			char *pValue = strchr(pItem, '=');
+			if (pValue) {
+				*pValue++ = '\0';
+				pMapCB->map_cfg_cb(pMediaQ, pItem, pValue);
+			}
+		}
+	}
+
+	// Normally set by the interface module
+	if (pCfg->audioChannels) {
+		media_q_pub_map_uncmp_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+		pPubMapInfo->audioRate = AVB_AUDIO_RATE_48KHZ;
+		pPubMapInfo->audioType = pCfg->audioType;
+		pPubMapInfo->audioBitDepth = pCfg->audioBitDepth;
+		pPubMapInfo->audioEndian = AVB_AUDIO_ENDIAN_LITTLE;
+		pPubMapInfo->audioChannels = pCfg->audioChannels;
+	}
+
+	pMapCB->map_gen_init_cb(pMediaQ);
+	if (bTalker) {
+		pMapCB->map_tx_init_cb(pMediaQ);
+	}
+	else {
+		pMapCB->map_rx_init_cb(pMediaQ);
+	}
+	return pMediaQ;
+}
+
+static void x_mapClose(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB)
+{
+	if (!pMediaQ) {
+		return;
+	}
+	if (pMapCB->map_end_cb) {
+		pMapCB->map_end_cb(pMediaQ);
+	}
+	if (pMapCB->map_gen_end_cb) {
+		pMapCB->map_gen_end_cb(pMediaQ);
+	}
+	openavbMediaQDelete(pMediaQ);
+}
+
+static void x_mapTeardown(void *pArg)
+{
+	bench_map_t *pState = pArg;
+
+	x_mapClose(pState->pTalkerQ, &pState->talkerCB);
+	x_mapClose(pState->pListenerQ, &pState->listenerCB);
+	free(pState->pFrames);
+	pState->pTalkerQ = NULL;
+	pState->pListenerQ = NULL;
+	pState->pFrames = NULL;
+}
+
+static bool x_mapSetup(void *pArg)
+{
+	bench_map_t *pState = pArg;
+	static const U8 streamIDnet[8] = { 0x00, 0x1b, 0x21, 0x00, 0x00, 0x01, 0x00, 0x01 };
+
+
+	pState->pTalkerQ = x_mapOpen(pState->pCfg, &pState->talkerCB, TRUE, BENCH_MAP_ITEMS);
+	pState->pListenerQ = x_mapOpen(pState->pCfg, &pState->listenerCB, FALSE, BENCH_MAP_FRAMES);
+	if (!pState->pTalkerQ || !pState->pListenerQ) {
+		x_mapTeardown(pState);
+		return FALSE;
+	}
+
+	memset(&pState->talker, 0, sizeof(pState->talker));
+	pState->talker.pMapCB = &pState->talkerCB;
+	pState->talker.subtype = pState->talkerCB.map_subtype_cb();
+	memcpy(pState->talker.streamIDnet, streamIDnet, sizeof(pState->talker.streamIDnet));
+	pState->frameSize = pState->talkerCB.map_max_data_size_cb(pState->pTalkerQ);
+	pState->pFrames = calloc(BENCH_MAP_FRAMES, pState->frameSize);
+	if (!pState->pFrames) {
+		x_mapTeardown(pState);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static U64 x_mapBatch(void *pArg, U32 *pOps)
+{
+	bench_map_t *pState = pArg;
+	media_q_item_t *pItem;
+	U32 frameCount;
+	U32 i1;
+
+	// Refill the talker queue
+	while ((pItem = openavbMediaQHeadLock(pState->pTalkerQ)) != NULL) {
+		U32 itemFill = pState->pCfg->itemFill;
+		pItem->dataLen = (itemFill && itemFill < pItem->itemSize) ? itemFill : pItem->itemSize;
+		pItem->readIdx = 0;
+		openavbAvtpTimeSetToSystemTime(pItem->pAvtpTime);
+		if (pState->pCfg->itemFn) {
+			pState->pCfg->itemFn(pItem);
+		}
+		openavbMediaQHeadPush(pState->pTalkerQ);
+	}
+
+	// The stream header is filled before the Tx callback
+	for (i1 = 0; i1 < BENCH_MAP_FRAMES; i1++) {
+		openavbAvtpFillHdr(&pState->talker, pState->pFrames + i1 * pState->frameSize);
+		pState->talker.avtp_sequence_num++;
+	}
+
+	U64 txStartNS = x_nowNS();
+	for (frameCount = 0; frameCount < BENCH_MAP_FRAMES; frameCount++) {
+		U32 frameLen = pState->frameSize;
+		if (pState->talkerCB.map_tx_cb(pState->pTalkerQ, pState->pFrames + frameCount * pState->frameSize, &frameLen) == TX_CB_RET_PACKET_NOT_READY) {
+			break;
+		}
+		pState->frameLen[frameCount] = frameLen;
+	}
+	U64 txNS = x_nowNS() - txStartNS;
+
+	U64 rxStartNS = x_nowNS();
+	for (i1 = 0; i1 < frameCount; i1++) {
+		pState->listenerCB.map_rx_cb(pState->pListenerQ, pState->pFrames + i1 * pState->frameSize, pState->frameLen[i1]);
+	}
+	U64 rxNS = x_nowNS() - rxStartNS;
+
+	// Play out whatever the listener produced
+	while ((pItem = openavbMediaQTailLock(pState->pListenerQ, TRUE)) != NULL) {
+		openavbMediaQTailPull(pState->pListenerQ);
+	}
+
+	*pOps = frameCount;
+	return pState->bRx ? rxNS : txNS;
+}
+
+
+/***********************************************
+ * Build the benchmark list
+ */
+static void x_benchRegister(void)
+{
+	static const U32 convertPairs[6][2] = { { 2, 3 }, { 2, 4 }, { 3, 2 }, { 3, 4 }, { 4, 2 }, { 4, 3 } };
+	static const U32 am824Channels[4] = { 2, 8, 32, 64 };
+	static const char *implNames[2] = { "scalar", "selected" };
+	bench_t *pBench;
+	U32 i1, i2, i3;
+
+	pBench = x_benchAdd(x_mediaQPushPull, &benchMediaQ, 0, "mediaq.push_pull");
+	if (pBench) {
+		pBench->setupFn = x_mediaQSetup;
+		pBench->teardownFn = x_mediaQTeardown;
+	}
+	pBench = x_benchAdd(x_mediaQPushPull, &benchMediaQThreadSafe, 0, "mediaq.push_pull.threadsafe");
+	if (pBench) {
+		pBench->setupFn = x_mediaQSetup;
+		pBench->teardownFn = x_mediaQTeardown;
+	}
+	pBench = x_benchAdd(x_mediaQBurst, &benchMediaQ, 0, "mediaq.burst");
+	if (pBench) {
+		pBench->setupFn = x_mediaQSetup;
+		pBench->teardownFn = x_mediaQTeardown;
+	}
+
+	pBench = x_benchAdd(x_avtpFill, &benchAvtp, AVTP_COMMON_STREAM_DATA_HDR_LEN, "avtp.hdr_fill");
+	if (pBench) {
+		pBench->setupFn = x_avtpSetup;
+	}
+	pBench = x_benchAdd(x_avtpParse, &benchAvtp, AVTP_COMMON_STREAM_DATA_HDR_LEN, "avtp.hdr_parse");
+	if (pBench) {
+		pBench->setupFn = x_avtpSetup;
+	}
+
+	x_benchAdd(x_clockRead, &benchClockMonotonic, 0, "clock.monotonic");
+	pBench = x_benchAdd(x_clockRead, &benchClockWalltime, 0, "clock.walltime");
+	if (pBench) {
+		pBench->setupFn = x_wallTimeSetup;
+		pBench->bOptional = TRUE;
+	}
+
+	x_benchAdd(x_logInterval, NULL, 0, "log.interval");
+	pBench = x_benchAdd(x_logCapture, NULL, 0, "log.capture");
+	if (pBench) {
+		pBench->bSingleBatch = TRUE;
+	}
+
+	pBench = x_benchAdd(x_tracePair, NULL, 0, "trace.off");
+	if (pBench) {
+		pBench->teardownFn = x_traceTeardown;
+	}
+	pBench = x_benchAdd(x_tracePair, NULL, 0, "trace.other_feature");
+	if (pBench) {
+		pBench->setupFn = x_traceOtherSetup;
+		pBench->teardownFn = x_traceTeardown;
+	}
+	pBench = x_benchAdd(x_tracePair, NULL, 0, "trace.on");
+	if (pBench) {
+		pBench->setupFn = x_traceOnSetup;
+		pBench->teardownFn = x_traceTeardown;
+	}
+
+	for (i1 = 0; i1 < 6; i1++) {
+		U32 inBytes = convertPairs[i1][0];
+		U32 outBytes = convertPairs[i1][1];
+		benchConvert[0][i1].convertFn = openavbAafConvertSelectScalar(inBytes, outBytes);
+		benchConvert[1][i1].convertFn = openavbAafConvertSelect(inBytes, outBytes);
+		for (i2 = 0; i2 < 2; i2++) {
+			if (benchConvert[i2][i1].convertFn) {
+				x_benchAdd(x_aafConvert, &benchConvert[i2][i1], BENCH_KERNEL_SAMPLES * inBytes,
+					"aaf.convert.%uto%u.%s", inBytes, outBytes, implNames[i2]);
+			}
+		}
+	}
+	x_benchAdd(x_aafEncode, &benchScalar, BENCH_KERNEL_SAMPLES * 4, "aaf.encode.float32_to_s24.scalar");
+	x_benchAdd(x_aafEncode, &benchSelected, BENCH_KERNEL_SAMPLES * 4, "aaf.encode.float32_to_s24.selected");
+	x_benchAdd(x_aafDecode, &benchScalar, BENCH_KERNEL_SAMPLES * 3, "aaf.decode.s24_to_float32.scalar");
+	x_benchAdd(x_aafDecode, &benchSelected, BENCH_KERNEL_SAMPLES * 3, "aaf.decode.s24_to_float32.selected");
+
+	for (i1 = 0; i1 < 2; i1++) {
+		U32 sampleBytes = i1 ? 3 : 2;
+		for (i2 = 0; i2 < 4; i2++) {
+			for (i3 = 0; i3 < 2; i3++) {
+				bench_am824_t *pState = &benchAm824[i1][i3][i2];
+				pState->sampleCount = am824Channels[i2] * BENCH_AM824_FRAMES;
+				pState->packFn = i3 ? openavbAm824PackSelect(sampleBytes) : openavbAm824PackSelectScalar(sampleBytes);
+				pState->unpackFn = i3 ? openavbAm824UnpackSelect(sampleBytes) : openavbAm824UnpackSelectScalar(sampleBytes);
+				if (pState->packFn) {
+					x_benchAdd(x_am824Pack, pState, pState->sampleCount * sampleBytes,
+						"am824.pack.%ubit.%uch.%s", sampleBytes * 8, am824Channels[i2], implNames[i3]);
+				}
+				if (pState->unpackFn) {
+					x_benchAdd(x_am824Unpack, pState, pState->sampleCount * 4,
+						"am824.unpack.%ubit.%uch.%s", sampleBytes * 8, am824Channels[i2], implNames[i3]);
+				}
+			}
+		}
+	}
+
+	benchTsScan[0] = openavbMpeg2tsSyncScanSelectScalar();
+	benchTsScan[1] = openavbMpeg2tsSyncScanSelect();
+	for (i1 = 0; i1 < 2; i1++) {
+		if (benchTsScan[i1]) {
+			x_benchAdd(x_mpeg2tsScan, &benchTsScan[i1], BENCH_TS_SCAN_LEN, "mpeg2ts.sync_scan.%s", implNames[i1]);
+		}
+	}
+
+	for (i1 = 0; i1 < BENCH_MAP_CFG_COUNT; i1++) {
+		for (i2 = 0; i2 < 2; i2++) {
+			bench_map_t *pState = &benchMaps[i1][i2];
+			pState->pCfg = &benchMapCfgs[i1];
+			pState->bRx = i2 ? TRUE : FALSE;
+			pBench = x_benchAdd(x_mapBatch, pState, 0, "map.%s.%s", benchMapCfgs[i1].pName, i2 ? "rx" : "tx");
+			if (pBench) {
+				pBench->setupFn = x_mapSetup;
+				pBench->teardownFn = x_mapTeardown;
+			}
+		}
+	}
+}
+
+
+/***********************************************
+ * Run one benchmark: a warm up batch then reps repetitions of at least minNS each.
+ */
+static bool x_benchRun(bench_t *pBench, U64 minNS, U32 reps, bench_result_t *pResult)
+{
+	double nsPerOp[BENCH_MAX_REPS];
+	U32 ops = 0;
+	U32 rep;
+
+	if (pBench->setupFn && !pBench->setupFn(pBench->pArg)) {
+		if (!pBench->bOptional) {
+			AVB_LOGF_ERROR("%s: setup failed", pBench->name);
+		}
+		return FALSE;
+	}
+
+	pBench->batchFn(pBench->pArg, &ops);
+	if (pBench->bSingleBatch) {
+		SLEEP_MSEC(2 * LOG_QUEUE_SLEEP_MSEC);
+	}
+	if (!ops) {
+		AVB_LOGF_ERROR("%s: no operations done", pBench->name);
+		if (pBench->teardownFn) {
+			pBench->teardownFn(pBench->pArg);
+		}
+		return FALSE;
+	}
+
+	memset(pResult, 0, sizeof(*pResult));
+	snprintf(pResult->name, sizeof(pResult->name), "%s", pBench->name);
+	pResult->bytesPerOp = pBench->bytesPerOp;
+
+	for (rep = 0; rep < reps && bRunning; rep++) {
+		U64 repNS = 0;
+		U64 repOps = 0;
+
+		do {
+			ops = 0;
+			repNS += pBench->batchFn(pBench->pArg, &ops);
+			repOps += ops;
+		} while (!pBench->bSingleBatch && ops && repNS < minNS);
+
+		if (pBench->bSingleBatch) {
+			// Let the logging thread drain the ring
+			SLEEP_MSEC(2 * LOG_QUEUE_SLEEP_MSEC);
+		}
+		if (!repOps) {
+			break;
+		}
+		nsPerOp[rep] = (double)repNS / repOps;
+		pResult->ops += repOps;
+	}
+
+	if (pBench->teardownFn) {
+		pBench->teardownFn(pBench->pArg);
+	}
+
+	if (rep < reps) {
+		if (bRunning) {
+			AVB_LOGF_ERROR("%s: no operations done", pBench->name);
+		}
+		return FALSE;
+	}
+
+	qsort(nsPerOp, reps, sizeof(double), x_compareDouble);
+	pResult->nsPerOpMin = nsPerOp[0];
+	pResult->nsPerOp = (reps & 1) ? nsPerOp[reps / 2] : (nsPerOp[reps / 2 - 1] + nsPerOp[reps / 2]) / 2;
+	return TRUE;
+}
+
+static void x_printResult(FILE *pOut, bench_format_t format, const bench_result_t *pResult)
+{
+	double mbPerSec = pResult->bytesPerOp ? pResult->bytesPerOp * 1000.0 / pResult->nsPerOp : 0;
+
+	switch (format) {
+		case BENCH_FORMAT_JSON:
+			fprintf(pOut, "{\"name\":\"%s\",\"ops\":%" PRIu64 ",\"ns_per_op\":%.3f,\"ns_per_op_min\":%.3f,\"bytes_per_op\":%u,\"mb_per_sec\":%.1f}\n",
+				pResult->name, pResult->ops, pResult->nsPerOp, pResult->nsPerOpMin, pResult->bytesPerOp, mbPerSec);
+			break;
+		case BENCH_FORMAT_CSV:
+			fprintf(pOut, "%s,%" PRIu64 ",%.3f,%.3f,%u,%.1f\n",
+				pResult->name, pResult->ops, pResult->nsPerOp, pResult->nsPerOpMin, pResult->bytesPerOp, mbPerSec);
+			break;
+		case BENCH_FORMAT_TEXT:
+		default:
+			fprintf(pOut, "%-40s %12.3f ns/op  min %12.3f", pResult->name, pResult->nsPerOp, pResult->nsPerOpMin);
+			if (pResult->bytesPerOp) {
+				fprintf(pOut, "  %10.1f MB/s", mbPerSec);
+			}
+			fprintf(pOut, "\n");
+			break;
+	}
+	fflush(pOut);
+}
+
+/***********************************************
+ * Read the name and ns_per_op of each result line of a previous json run.
+ */
+static U32 x_baselineLoad(const char *pFileName, bench_baseline_t *pBaseline, U32 maxCount)
+{
+	FILE *pFile = fopen(pFileName, "r");
+	char line[512];
+	U32 count = 0;
+
+	if (!pFile) {
+		AVB_LOGF_ERROR("Unable to open baseline %s", pFileName);
+		return 0;
+	}
+
+	while (count < maxCount && fgets(line, sizeof(line), pFile)) {
+		char *pName = strstr(line, "\"name\":\"");
+		char *pNs = strstr(line, "\"ns_per_op\":");
+		if (!pName || !pNs) {
+			continue;
+		}
+		pName += strlen("\"name\":\"");
+		char *pEnd = strchr(pName, '"');
+		if (!pEnd || pEnd - pName >= BENCH_NAME_LEN) {
+			continue;
+		}
+		memcpy(pBaseline[count].name, pName, pEnd - pName);
+		pBaseline[count].name[pEnd - pName] = '\0';
+		if (sscanf(pNs + strlen("\"ns_per_op\":"), "%lf", &pBaseline[count].nsPerOp) == 1 && pBaseline[count].nsPerOp > 0) {
+			count++;
+		}
+	}
+
+	fclose(pFile);
+	return count;
+}
+
+/**********************************************
+ * main
+ */
+int main(int argc, char *argv[])
+{
+	char *programName;
+	char *optLogFileName = NULL;
+	char *optOutFileName = NULL;
+	char *optMatch = NULL;
+	char *optBaselineFileName = NULL;
+	bench_format_t optFormat = BENCH_FORMAT_JSON;
+	int optMinMsec = BENCH_DEFAULT_MIN_MSEC;
+	int optReps = BENCH_DEFAULT_REPS;
+	double optThresholdPct = BENCH_DEFAULT_THRESHOLD_PCT;
+	bool optList = FALSE;
+	U32 i1, i2;
+
+	programName = strrchr(argv[0], '/');
+	programName = programName ? programName + 1 : argv[0];
+
+	bool optDone = FALSE;
+	while (!optDone) {
+		int opt = getopt(argc, argv, "hf:o:t:r:m:Lb:x:l:");
+		if (opt != EOF) {
+			switch (opt) {
+				case 'f':
+					if (strcmp(optarg, "json") == 0) {
+						optFormat = BENCH_FORMAT_JSON;
+					}
+					else if (strcmp(optarg, "csv") == 0) {
+						optFormat = BENCH_FORMAT_CSV;
+					}
+					else if (strcmp(optarg, "text") == 0) {
+						optFormat = BENCH_FORMAT_TEXT;
+					}
+					else {
+						openavbPipelineBenchUsage(programName);
+						exit(-1);
+					}
+					break;
+				case 'o':
+					optOutFileName = optarg;
+					break;
+				case 't':
+					optMinMsec = atoi(optarg);
+					break;
+				case 'r':
+					optReps = atoi(optarg);
+					break;
+				case 'm':
+					optMatch = optarg;
+					break;
+				case 'L':
+					optList = TRUE;
+					break;
+				case 'b':
+					optBaselineFileName = optarg;
+					break;
+				case 'x':
+					optThresholdPct = atof(optarg);
+					break;
+				case 'l':
+					optLogFileName = optarg;
+					break;
+				case 'h':
+				default:
+					openavbPipelineBenchUsage(programName);
+					exit(-1);
+			}
+		}
+		else {
+			optDone = TRUE;
+		}
+	}
+
+	if (optind < argc || optMinMsec < 1 || optReps < 1 || optReps > BENCH_MAX_REPS) {
+		openavbPipelineBenchUsage(programName);
+		exit(-1);
+	}
+
+	x_kernelFill();
+	x_benchRegister();
+
+	if (optList) {
+		for (i1 = 0; i1 < benchCount; i1++) {
+			printf("%s\n", benchList[i1].name);
+		}
+		exit(0);
+	}
+
+	struct sigaction sa;
+	sa.sa_handler = openavbPipelineBenchSigHandler;
+	sigemptyset(&sa.sa_mask);
+	sa.sa_flags = 0;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	signal(SIGPIPE, SIG_IGN);
+
+	osalAVBInitialize(optLogFileName, NULL);
+
+	bench_baseline_t *pBaseline = NULL;
+	U32 baselineCount = 0;
+	if (optBaselineFileName) {
+		pBaseline = calloc(BENCH_MAX, sizeof(bench_baseline_t));
+		if (pBaseline) {
+			baselineCount = x_baselineLoad(optBaselineFileName, pBaseline, BENCH_MAX);
+		}
+		if (!baselineCount) {
+			AVB_LOG_ERROR("No results in the baseline");
+			osalAVBFinalize();
+			exit(-1);
+		}
+	}
+
+	FILE *pOut = stdout;
+	if (optOutFileName) {
+		pOut = fopen(optOutFileName, "w");
+		if (!pOut) {
+			AVB_LOGF_ERROR("Unable to open %s", optOutFileName);
+			osalAVBFinalize();
+			exit(-1);
+		}
+	}
+
+	// Which kernels were selected matters when comparing results of different machines
+	switch (optFormat) {
+		case BENCH_FORMAT_JSON:
+			fprintf(pOut, "{\"meta\":{\"aaf_isa\":\"%s\",\"am824_isa\":\"%s\",\"mpeg2ts_isa\":\"%s\",\"min_msec\":%d,\"reps\":%d}}\n",
+				openavbAafConvertIsaName(), openavbAm824IsaName(), openavbMpeg2tsSyncIsaName(), optMinMsec, optReps);
+			break;
+		case BENCH_FORMAT_CSV:
+			fprintf(pOut, "name,ops,ns_per_op,ns_per_op_min,bytes_per_op,mb_per_sec\n");
+			break;
+		case BENCH_FORMAT_TEXT:
+		default:
+			fprintf(pOut, "aaf %s, am824 %s, mpeg2ts %s, %d x %d msec\n",
+				openavbAafConvertIsaName(), openavbAm824IsaName(), openavbMpeg2tsSyncIsaName(), optReps, optMinMsec);
+			break;
+	}
+
+	U32 nFailed = 0;
+	U32 nRegressions = 0;
+	for (i1 = 0; i1 < benchCount && bRunning; i1++) {
+		bench_t *pBench = &benchList[i1];
+		bench_result_t result;
+
+		if (optMatch && !strstr(pBench->name, optMatch)) {
+			continue;
+		}
+
+		if (!x_benchRun(pBench, (U64)optMinMsec * NANOSECONDS_PER_MSEC, optReps, &result)) {
+			if (!pBench->bOptional) {
+				nFailed++;
+			}
+			continue;
+		}
+		x_printResult(pOut, optFormat, &result);
+
+		for (i2 = 0; i2 < baselineCount; i2++) {
+			if (strcmp(pBaseline[i2].name, result.name) == 0) {
+				double pct = (result.nsPerOp / pBaseline[i2].nsPerOp - 1.0) * 100.0;
+				if (pct > optThresholdPct) {
+					fprintf(stderr, "REGRESSION %s: %.3f ns/op, baseline %.3f ns/op (+%.1f%%)\n",
+						result.name, result.nsPerOp, pBaseline[i2].nsPerOp, pct);
+					nRegressions++;
+				}
+				break;
+			}
+		}
+	}
+
+	if (pOut != stdout) {
+		fclose(pOut);
+	}
+	free(pBaseline);
+
+	osalAVBFinalize();
+
+	if (nRegressions || nFailed) {
+		fprintf(stderr, "%u regressions, %u failed benchmarks\n", nRegressions, nFailed);
+		exit(1);
+	}
+	exit(0);
+}
@@ -0,0 +1,440 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Measures how long talkers and listeners take to start and stop.
+*
+* Configures and runs N streams, waits until each has sent or received its first frame and
+* reports the wall time of each phase together with the distribution of the per-stream
+* connected, streaming and first frame times. Needs a running endpoint (or SRP peer) for the
+* streams to get past the connected stage.
+*/
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include "openavb_tl_pub.h"
+#include "openavb_osal_pub.h"
+#include "openavb_plugin.h"
+#include "openavb_trace_pub.h"
+#include <inttypes.h>
+
+#define	AVB_LOG_COMPONENT	"TL Startup Bench"
+#include "openavb_log_pub.h"
+
+// How long to wait for the first frames when not given
+#define BENCH_DEFAULT_TIMEOUT_SEC	10
+
+bool bRunning = TRUE;
+
+// Platform independent mapping modules
+extern bool openavbMapPipeInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapAVTPAudioInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapCrfInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapCtrlInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapH264Initialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapMjpegInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapMpeg2tsInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapNullInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbMapUncmpAudioInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+
+// Platform independent interface modules
+extern bool openavbIntfEchoInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+extern bool openavbIntfCtrlInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+extern bool openavbIntfLoggerInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+extern bool openavbIntfNullInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+extern bool openavbIntfToneGenInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+extern bool openavbIntfViewerInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+
+// Linux interface modules
+extern bool openavbIntfAlsaInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+extern bool openavbIntfMpeg2tsFileInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+extern bool openavbIntfWavFileInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+extern bool openavbIntfShmInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+
+static void openavbStartupBenchSigHandler(int signal)
+{
+	if (signal == SIGINT || signal == SIGTERM) {
+		if (bRunning) {
+			bRunning = FALSE;
+		}
+		else {
+			// Force shutdown
+			exit(2);
+		}
+	}
+}
+
+void openavbStartupBenchUsage(char *programName)
+{
+	printf(
+		"\n"
+		"Usage: %s [options] file...\n"
+		"  -h         Prints this message.\n"
+		"  -n val     Start val streams for each configuration file. stream_uid will be overriden.\n"
+		"  -j val     Configure up to val streams at once. Defaults to the number of CPUs, 1 configures them one after the other.\n"
+		"  -w val     Run the streams on val worker threads instead of a thread per stream. 0 uses one worker per CPU.\n"
+		"  -t val     Seconds to wait for the first frame of every stream. Defaults to %d.\n"
+		"  -b val     Configure the streams from the bundle val, compiled by openavb_bundle_compile, instead of ini files.\n"
+		"  -I val     Use given (val) interface globally, can be overriden by giving the ifname= option to the config line.\n"
+		"  -l val     Filename of the log file to use.  If not specified, results will be logged to stderr.\n"
+		"\n"
+		"Examples:\n"
+		"  %s -n 64 -I eth0 talker.ini\n"
+		"    Start 64 talkers and report how long they took to send their first frame.\n\n"
+		"  %s -n 64 -j 1 -I eth0 talker.ini\n"
+		"    The same, configuring the streams one after the other for comparison.\n\n"
+		"  %s -b streams.bundle\n"
+		"    Start the streams compiled into streams.bundle.\n\n"
+		,
+		programName, BENCH_DEFAULT_TIMEOUT_SEC, programName, programName, programName);
+}
+
+static U64 x_nowNS(void)
+{
+	U64 nowNS = 0;
+	CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &nowNS);
+	return nowNS;
+}
+
+static int x_compareU64(const void *pA, const void *pB)
+{
+	U64 a = *(const U64 *)pA;
+	U64 b = *(const U64 *)pB;
+	return a < b ? -1 : a > b ? 1 : 0;
+}
+
+/***********************************************
+ * Print min / p50 / p99 / max of the times reached by the streams.
+ * Zero entries are streams that never got there.
+ */
+static void x_printDistribution(const char *pName, U64 *pTimesNS, U32 count)
+{
+	U64 *pSorted = malloc(count * sizeof(U64));
+	U32 reached = 0;
+	U32 i1;
+
+	if (!pSorted) {
+		return;
+	}
+
+	for (i1 = 0; i1 < count; i1++) {
+		if (pTimesNS[i1]) {
+			pSorted[reached++] = pTimesNS[i1];
+		}
+	}
+
+	if (!reached) {
+		printf("%-13s reached by 0/%u\n", pName, count);
+		free(pSorted);
+		return;
+	}
+
+	qsort(pSorted, reached, sizeof(U64), x_compareU64);
+	printf("%-13s reached by %u/%u  min=%.3f  p50=%.3f  p99=%.3f  max=%.3f ms\n",
+		pName, reached, count,
+		pSorted[0] / (double)NANOSECONDS_PER_MSEC,
+		pSorted[(reached - 1) / 2] / (double)NANOSECONDS_PER_MSEC,
+		pSorted[((reached - 1) * 99) / 100] / (double)NANOSECONDS_PER_MSEC,
+		pSorted[reached - 1] / (double)NANOSECONDS_PER_MSEC);
+
+	free(pSorted);
+}
+
+/**********************************************
+ * main
+ */
+int main(int argc, char *argv[])
+{
+	char *programName;
+	char *optIfnameGlobal = NULL;
+	char *optLogFileName = NULL;
+	char *optBundleFile = NULL;
+	int optStreamCount = 1;
+	bool optStreamCountSet = FALSE;
+	long optConfigThreads = sysconf(_SC_NPROCESSORS_ONLN);
+	int optWorkers = -1;
+	int optTimeoutSec = BENCH_DEFAULT_TIMEOUT_SEC;
+
+	tl_pool_handle_t tlPool = NULL;
+	int i1, i2;
+
+	programName = strrchr(argv[0], '/');
+	programName = programName ? programName + 1 : argv[0];
+
+	if (argc < 2) {
+		openavbStartupBenchUsage(programName);
+		exit(-1);
+	}
+
+	bool optDone = FALSE;
+	while (!optDone) {
+		int opt = getopt(argc, argv, "hn:j:w:t:b:I:l:");
+		if (opt != EOF) {
+			switch (opt) {
+				case 'n':
+					optStreamCount = atoi(optarg);
+					optStreamCountSet = TRUE;
+					break;
+				case 'j':
+					optConfigThreads = strtol(optarg, NULL, 0);
+					break;
+				case 'w':
+					optWorkers = atoi(optarg);
+					break;
+				case 't':
+					optTimeoutSec = atoi(optarg);
+					break;
+				case 'b':
+					optBundleFile = strdup(optarg);
+					break;
+				case 'I':
+					optIfnameGlobal = strdup(optarg);
+					break;
+				case 'l':
+					optLogFileName = strdup(optarg);
+					break;
+				case 'h':
+				default:
+					openavbStartupBenchUsage(programName);
+					exit(-1);
+			}
+		}
+		else {
+			optDone = TRUE;
+		}
+	}
+
+	int iniCount = argc - optind;
+	if ((iniCount < 1 && !optBundleFile) || optStreamCount < 1) {
+		openavbStartupBenchUsage(programName);
+		exit(-1);
+	}
+
+	struct sigaction sa;
+	sa.sa_handler = openavbStartupBenchSigHandler;
+	sigemptyset(&sa.sa_mask);
+	sa.sa_flags = 0;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	signal(SIGPIPE, SIG_IGN);
+
+	osalAVBInitialize(optLogFileName, optIfnameGlobal);
+
+	registerStaticMapModule(openavbMapPipeInitialize);
+	registerStaticMapModule(openavbMapAVTPAudioInitialize);
+	registerStaticMapModule(openavbMapCrfInitialize);
+	registerStaticMapModule(openavbMapCtrlInitialize);
+	registerStaticMapModule(openavbMapH264Initialize);
+	registerStaticMapModule(openavbMapMjpegInitialize);
+	registerStaticMapModule(openavbMapMpeg2tsInitialize);
+	registerStaticMapModule(openavbMapNullInitialize);
+	registerStaticMapModule(openavbMapUncmpAudioInitialize);
+
+	registerStaticIntfModule(openavbIntfEchoInitialize);
+	registerStaticIntfModule(openavbIntfCtrlInitialize);
+	registerStaticIntfModule(openavbIntfLoggerInitialize);
+	registerStaticIntfModule(openavbIntfNullInitialize);
+	registerStaticIntfModule(openavbIntfToneGenInitialize);
+	registerStaticIntfModule(openavbIntfViewerInitialize);
+	registerStaticIntfModule(openavbIntfAlsaInitialize);
+	registerStaticIntfModule(openavbIntfMpeg2tsFileInitialize);
+	registerStaticIntfModule(openavbIntfWavFileInitialize);
+	registerStaticIntfModule(openavbIntfShmInitialize);
+
+	// Loading the bundle counts towards the configure time
+	U64 configureNS = x_nowNS();
+	tl_bundle_handle_t tlBundle = NULL;
+	U32 tlCount = iniCount * optStreamCount;
+	if (optBundleFile) {
+		tlBundle = openavbTLBundleOpen(optBundleFile);
+		if (!tlBundle) {
+			osalAVBFinalize();
+			exit(-1);
+		}
+		tlCount = openavbTLBundleCount(tlBundle);
+	}
+	U64 bundleOpenNS = x_nowNS() - configureNS;
+
+	char **tlIniList = calloc(tlCount, sizeof(char *));
+	tl_handle_t *tlHandleList = calloc(tlCount, sizeof(tl_handle_t));
+	U64 *connectedNS = calloc(tlCount, sizeof(U64));
+	U64 *streamingNS = calloc(tlCount, sizeof(U64));
+	U64 *firstFrameNS = calloc(tlCount, sizeof(U64));
+	if (!tlIniList || !tlHandleList || !connectedNS || !streamingNS || !firstFrameNS) {
+		AVB_LOG_ERROR("Unable to allocate stream lists");
+		osalAVBFinalize();
+		exit(-1);
+	}
+
+	if (!openavbTLInitialize(tlCount)) {
+		AVB_LOG_ERROR("Unable to initialize talker listener library");
+		osalAVBFinalize();
+		exit(-1);
+	}
+
+	if (optWorkers >= 0) {
+		int cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		if (cpus < 1) {
+			cpus = 1;
+		}
+		U32 cpuMask = cpus >= 32 ? 0xFFFFFFFF : (1U << cpus) - 1;
+
+		tlPool = openavbTLPoolCreate(optWorkers ? optWorkers : cpus, cpuMask, 0);
+		if (!tlPool) {
+			AVB_LOG_ERROR("Unable to create worker pool");
+			osalAVBFinalize();
+			exit(-1);
+		}
+	}
+
+	// Populate the ini file list
+	U32 tlIndex = 0;
+	for (i1 = 0; i1 < iniCount && !tlBundle; i1++) {
+		for (i2 = 0; i2 < optStreamCount; i2++) {
+			char iniFile[1024];
+
+			if (optStreamCountSet) {
+				snprintf(iniFile, sizeof(iniFile), "%s,stream_uid=%u", argv[i1 + optind], tlIndex);
+			}
+			else {
+				snprintf(iniFile, sizeof(iniFile), "%s", argv[i1 + optind]);
+			}
+			if (optIfnameGlobal && !strcasestr(iniFile, ",ifname=")) {
+				snprintf(iniFile + strlen(iniFile), sizeof(iniFile) - strlen(iniFile), ",ifname=%s", optIfnameGlobal);
+			}
+			tlIniList[tlIndex++] = strdup(iniFile);
+		}
+	}
+
+	for (i1 = 0; i1 < tlCount; i1++) {
+		tlHandleList[i1] = openavbTLOpen();
+		if (tlPool) {
+			openavbTLPoolAttach(tlPool, tlHandleList[i1]);
+		}
+	}
+
+	// Configure
+	configureNS = x_nowNS();
+	bool bConfigured;
+	if (tlBundle) {
+		bConfigured = openavbTLConfigureBundleOsal(tlHandleList, tlBundle, optConfigThreads > 0 ? optConfigThreads : 1);
+		openavbTLBundleClose(tlBundle);
+		tlBundle = NULL;
+	}
+	else {
+		bConfigured = openavbTLConfigureIniFilesOsal(tlHandleList, tlIniList, tlCount, optConfigThreads > 0 ? optConfigThreads : 1);
+	}
+	if (!bConfigured) {
+		printf("Error configuring streams\n");
+		osalAVBFinalize();
+		exit(-1);
+	}
+	configureNS = x_nowNS() - configureNS + bundleOpenNS;
+
+	// Run and wait for the first frames
+	U64 runNS = x_nowNS();
+	for (i1 = 0; i1 < tlCount; i1++) {
+		openavbTLRun(tlHandleList[i1]);
+	}
+	runNS = x_nowNS() - runNS;
+
+	U64 waitStartNS = x_nowNS();
+	U64 timeoutNS = (U64)optTimeoutSec * NANOSECONDS_PER_SECOND;
+	U32 nFirstFrame = 0;
+	while (bRunning && nFirstFrame < tlCount && x_nowNS() - waitStartNS < timeoutNS) {
+		SLEEP_MSEC(1);
+
+		nFirstFrame = 0;
+		for (i1 = 0; i1 < tlCount; i1++) {
+			openavb_tl_startup_times_t times;
+			if (openavbTLGetStartupTimes(tlHandleList[i1], &times)) {
+				connectedNS[i1] = times.connectedNS;
+				streamingNS[i1] = times.streamingNS;
+				firstFrameNS[i1] = times.firstFrameNS;
+			}
+			if (firstFrameNS[i1]) {
+				nFirstFrame++;
+			}
+		}
+	}
+	U64 allStreamingNS = x_nowNS() - waitStartNS;
+
+	// Stop and close
+	U64 stopNS = x_nowNS();
+	openavbTLStopAll(tlHandleList, tlCount);
+	stopNS = x_nowNS() - stopNS;
+
+	U64 closeNS = x_nowNS();
+	openavbTLCloseAll(tlHandleList, tlCount);
+	closeNS = x_nowNS() - closeNS;
+
+	printf("\n%u streams from %s, %ld config threads, %s\n", tlCount, optBundleFile ? "a bundle" : "ini files",
+		optConfigThreads > 0 ? optConfigThreads : 1, tlPool ? "worker pool" : "thread per stream");
+	printf("configure     %.3f ms\n", configureNS / (double)NANOSECONDS_PER_MSEC);
+	printf("run           %.3f ms\n", runNS / (double)NANOSECONDS_PER_MSEC);
+	if (nFirstFrame == tlCount) {
+		printf("all streaming %.3f ms after run returned\n", allStreamingNS / (double)NANOSECONDS_PER_MSEC);
+	}
+	else {
+		printf("all streaming not reached, %u/%u streams had a first frame\n", nFirstFrame, tlCount);
+	}
+	x_printDistribution("connected", connectedNS, tlCount);
+	x_printDistribution("streaming", streamingNS, tlCount);
+	x_printDistribution("first frame", firstFrameNS, tlCount);
+	printf("stop          %.3f ms\n", stopNS / (double)NANOSECONDS_PER_MSEC);
+	printf("close         %.3f ms\n", closeNS / (double)NANOSECONDS_PER_MSEC);
+
+	if (tlPool) {
+		openavbTLPoolDelete(tlPool);
+		tlPool = NULL;
+	}
+
+	openavbTLCleanup();
+
+	for (i1 = 0; i1 < tlCount; i1++) {
+		free(tlIniList[i1]);
+	}
+	free(tlIniList);
+	free(tlHandleList);
+	free(connectedNS);
+	free(streamingNS);
+	free(firstFrameNS);
+	free(optIfnameGlobal);
+	free(optLogFileName);
+	free(optBundleFile);
+
+	osalAVBFinalize();
+
+	exit(nFirstFrame == tlCount ? 0 : 1);
+}
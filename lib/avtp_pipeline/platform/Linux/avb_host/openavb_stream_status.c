@@ -0,0 +1,185 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Prints the endpoint's stream status table.
+*
+* Reads the shared memory table the endpoint publishes, so the state of every stream on
+* the host is shown without talking to the endpoint or to any talker or listener.
+*/
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include "openavb_platform.h"
+#include "openavb_endpoint.h"
+
+#define	AVB_LOG_COMPONENT	"Stream Status"
+#include "openavb_log_pub.h"
+
+static const char *x_roleName(U8 role)
+{
+	switch (role) {
+		case clientTalker:
+			return "talker";
+		case clientListener:
+			return "listener";
+		default:
+			return "none";
+	}
+}
+
+void openavbStreamStatusUsage(char *programName)
+{
+	printf(
+		"\n"
+		"Usage: %s [options]\n"
+		"  -j         Print JSON instead of a table.\n"
+		"  -w val     Print again every val milliseconds until interrupted.\n"
+		"  -h         Prints this message.\n"
+		"\n"
+		,
+		programName);
+}
+
+static void x_printTable(openavb_endpoint_status_t *pStatus, U32 count)
+{
+	U32 i1;
+
+	printf("%-24s %-8s %-17s %-5s %-4s %-4s %-6s %-8s %-6s %-4s %-4s %-4s\n",
+		"stream", "role", "dest", "class", "prio", "vlan", "fwmark", "latency", "maap", "ld", "td", "fail");
+	for (i1 = 0; i1 < count; i1++) {
+		openavb_endpoint_status_t *p = &pStatus[i1];
+		char stream[32];
+		char dest[24];
+		snprintf(stream, sizeof(stream), STREAMID_FORMAT, STREAMID_ARGS(&p->streamID));
+		snprintf(dest, sizeof(dest), ETH_FORMAT, ETH_OCTETS(p->destAddr));
+		printf("%-24s %-8s %-17s %-5u %-4u %-4u %-6u %-8u %-6s 0x%02x 0x%02x %-4u\n",
+			stream, x_roleName(p->role), dest, p->srClass, p->priority, p->vlanID, p->fwmark,
+			p->latency, p->bMaap ? "yes" : "no", p->lsnrDecl, p->tlkrDecl, p->failInfo.FailureCode);
+	}
+}
+
+static void x_printJson(openavb_endpoint_status_t *pStatus, U32 count)
+{
+	U32 i1;
+
+	printf("[");
+	for (i1 = 0; i1 < count; i1++) {
+		openavb_endpoint_status_t *p = &pStatus[i1];
+		printf("%s\n {\"stream\":\"" STREAMID_FORMAT "\",\"role\":\"%s\",\"dest\":\"" ETH_FORMAT "\","
+			"\"srClass\":%u,\"srRank\":%u,\"priority\":%u,\"vlanID\":%u,\"classRate\":%u,"
+			"\"maxFrameSize\":%u,\"maxIntervalFrames\":%u,\"latency\":%u,\"fwmark\":%u,"
+			"\"maap\":%s,\"shaped\":%s,\"lsnrDecl\":%u,\"tlkrDecl\":%u,\"failureCode\":%u,\"updates\":%u}",
+			i1 ? "," : "",
+			STREAMID_ARGS(&p->streamID), x_roleName(p->role), ETH_OCTETS(p->destAddr),
+			p->srClass, p->srRank, p->priority, p->vlanID, p->classRate,
+			p->tSpec.maxFrameSize, p->tSpec.maxIntervalFrames, p->latency, p->fwmark,
+			p->bMaap ? "true" : "false", p->bShaped ? "true" : "false",
+			p->lsnrDecl, p->tlkrDecl, p->failInfo.FailureCode, p->updates);
+	}
+	printf("\n]\n");
+}
+
+/**********************************************
+ * main
+ */
+int main(int argc, char *argv[])
+{
+	char *programName;
+	bool optJson = FALSE;
+	int optWatchMsec = 0;
+
+	programName = strrchr(argv[0], '/');
+	programName = programName ? programName + 1 : argv[0];
+
+	bool optDone = FALSE;
+	while (!optDone) {
+		int opt = getopt(argc, argv, "hjw:");
+		if (opt != EOF) {
+			switch (opt) {
+				case 'j':
+					optJson = TRUE;
+					break;
+				case 'w':
+					optWatchMsec = atoi(optarg);
+					break;
+				case 'h':
+				default:
+					openavbStreamStatusUsage(programName);
+					exit(-1);
+			}
+		}
+		else {
+			optDone = TRUE;
+		}
+	}
+
+	avbLogInit();
+
+	do {
+		U32 slots = openavbEptStatusSlotCount();
+		if (slots == 0) {
+			fprintf(stderr, "No stream status table, is the endpoint running?\n");
+			if (!optWatchMsec) {
+				avbLogExit();
+				exit(-1);
+			}
+		}
+		else {
+			openavb_endpoint_status_t *pStatus = calloc(slots, sizeof(openavb_endpoint_status_t));
+			if (!pStatus) {
+				fprintf(stderr, "Unable to allocate %u status entries\n", slots);
+				avbLogExit();
+				exit(-1);
+			}
+
+			U32 count = openavbEptStatusGetAll(pStatus, slots);
+			if (optJson) {
+				x_printJson(pStatus, count);
+			}
+			else {
+				x_printTable(pStatus, count);
+			}
+			fflush(stdout);
+			free(pStatus);
+		}
+
+		if (optWatchMsec) {
+			SLEEP_MSEC(optWatchMsec);
+		}
+	} while (optWatchMsec);
+
+	openavbEptStatusDetach();
+	avbLogExit();
+	return 0;
+}
@@ -34,23 +34,61 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 #define AVB_AVDECC_LISTEN_FDS	0 // first fds, was last MAX_AVB_STREAMS
 #define SOCK_INVALID (-1)
-#define POLL_FD_COUNT ((MAX_AVB_STREAMS) + 1)
+#define POLL_FD_INITIAL_COUNT ((MAX_AVB_STREAMS) + 1)
+// Longest wait for a message, which is also how often the endpoint status table is looked at
+#define POLL_TIMEOUT_MSEC 100
 
+// The fds table doubles whenever it fills up. Unused client entries
+// are kept on a stack so a new connection doesn't search for one.
 static int lsock  = SOCK_INVALID;
-static struct pollfd fds[POLL_FD_COUNT];
+static struct pollfd *fds = NULL;
+static int *fdsFree = NULL;
+static int fdsCount = 0;
+static int fdsFreeCount = 0;
 static struct sockaddr_un serverAddr;
 
+static bool fdsGrow(int count)
+{
+	struct pollfd *newFds = realloc(fds, count * sizeof(struct pollfd));
+	if (!newFds) {
+		return FALSE;
+	}
+	fds = newFds;
+
+	int *newFree = realloc(fdsFree, count * sizeof(int));
+	if (!newFree) {
+		return FALSE;
+	}
+	fdsFree = newFree;
+
+	// Push the new entries so the lowest is handed out first
+	int i;
+	for (i = count - 1; i >= fdsCount; i--) {
+		fds[i].fd = SOCK_INVALID;
+		fds[i].events = 0;
+		fds[i].revents = 0;
+		if (i != AVB_AVDECC_LISTEN_FDS) {
+			fdsFree[fdsFreeCount++] = i;
+		}
+	}
+	fdsCount = count;
+	return TRUE;
+}
+
 static void socketClose(int h)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AVDECC_MSG);
 
-	if (h < 0 || h >= POLL_FD_COUNT) {
+	if (h < 0 || h >= fdsCount) {
 		AVB_LOG_ERROR("Closing socket; invalid handle");
 	}
 	else {
 		if (h != AVB_AVDECC_LISTEN_FDS) {
 			openavbAvdeccMsgSrvrCloseClientConnection(h);
 		}
+		if (fds[h].fd != SOCK_INVALID && h != AVB_AVDECC_LISTEN_FDS) {
+			fdsFree[fdsFreeCount++] = h;
+		}
 		close(fds[h].fd);
 		fds[h].fd = SOCK_INVALID;
 		fds[h].events = 0;
@@ -63,7 +101,7 @@ static bool openavbAvdeccMsgSrvrSendToClient(int h, openavbAvdeccMessage_t *msg)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AVDECC_MSG);
 
-	if (h < 0 || h >= POLL_FD_COUNT) {
+	if (h < 0 || h >= fdsCount) {
 		AVB_LOG_ERROR("Sending message; invalid handle");
 		AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
 		return FALSE;
@@ -104,14 +142,13 @@ static bool openavbAvdeccMsgSrvrSendToClient(int h, openavbAvdeccMessage_t *msg)
 bool openavbAvdeccMsgServerOpen(void)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AVDECC_MSG);
-	int i;
 
 	// Perform the base initialization.
 	openavbAvdeccMsgInitialize();
 
-	for (i=0; i < POLL_FD_COUNT; i++) {
-		fds[i].fd = SOCK_INVALID;
-		fds[i].events = 0;
+	if (!fdsGrow(POLL_FD_INITIAL_COUNT)) {
+		AVB_LOG_ERROR("Failed to allocate poll table");
+		goto error;
 	}
 
 	lsock = socket(AF_UNIX, SOCK_STREAM, 0);
@@ -135,7 +172,7 @@ bool openavbAvdeccMsgServerOpen(void)
 		goto error;
 	}
 
-	rslt = listen(lsock, 5);
+	rslt = listen(lsock, SOMAXCONN);
 	if (rslt != 0) {
 		AVB_LOGF_ERROR("Failed to listen on socket: %s", strerror(errno));
 		goto error;
@@ -165,11 +202,11 @@ void openavbAvdeccMsgSrvrService(void)
 	int i, j;
 	int  csock;
 
-	int nfds = POLL_FD_COUNT;
+	int nfds = fdsCount;
 	int pRet;
 
 	AVB_LOG_VERBOSE("Waiting for event...");
-	pRet = poll(fds, nfds, 1000);
+	pRet = poll(fds, nfds, POLL_TIMEOUT_MSEC);
 
 	if (pRet == 0) {
 		AVB_LOG_VERBOSE("poll timeout");
@@ -196,14 +233,16 @@ void openavbAvdeccMsgSrvrService(void)
 						AVB_LOGF_ERROR("Failed to accept connection: %s", strerror(errno));
 					}
 					else {
-						for (j = 0; j < POLL_FD_COUNT; j++) {
-							if (fds[j].fd == SOCK_INVALID) {
-								fds[j].fd = csock;
-								fds[j].events = POLLIN;
-								break;
-							}
+						if (fdsFreeCount == 0) {
+							fdsGrow(fdsCount * 2);
+						}
+						if (fdsFreeCount > 0) {
+							j = fdsFree[--fdsFreeCount];
+							fds[j].fd = csock;
+							fds[j].events = POLLIN;
+							fds[j].revents = 0;
 						}
-						if (j >= POLL_FD_COUNT) {
+						else {
 							AVB_LOG_ERROR("Too many client connections");
 							close(csock);
 						}
@@ -242,6 +281,9 @@ void openavbAvdeccMsgSrvrService(void)
 			}
 		}
 	}
+
+	openavbAvdeccMsgSrvrPollEndpointStatus();
+
 	AVB_TRACE_EXIT(AVB_TRACE_AVDECC_MSG);
 }
 
@@ -249,7 +291,7 @@ void openavbAvdeccMsgServerClose(void)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_AVDECC_MSG);
 	int i;
-	for (i = 0; i < POLL_FD_COUNT; i++) {
+	for (i = 0; i < fdsCount; i++) {
 		if (fds[i].fd != SOCK_INVALID) {
 			socketClose(i);
 		}
@@ -262,6 +304,13 @@ void openavbAvdeccMsgServerClose(void)
 		AVB_LOGF_ERROR("Failed to unlink %s: %s", serverAddr.sun_path, strerror(errno));
 	}
 
+	free(fds);
+	free(fdsFree);
+	fds = NULL;
+	fdsFree = NULL;
+	fdsCount = 0;
+	fdsFreeCount = 0;
+
 	// Perform the base cleanup.
 	openavbAvdeccMsgCleanup();
 
@@ -109,6 +109,16 @@ static int cfgCallback(void *user, const char *section, const char *name, const
 			if (*pEnd == '\0' && errno == 0)
 				valOK = TRUE;
 		}
+		else if (MATCH(name, "max_streams")) {
+			errno = 0;
+			unsigned temp = strtoul(value, &pEnd, 10);
+			if (*pEnd == '\0' && errno == 0) {
+				if (temp >= 1 && temp <= ENDPOINT_MAX_STREAMS_LIMIT) {
+					pCfg->maxStreams = temp;
+					valOK = TRUE;
+				}
+			}
+		}
 		else {
 			// unmatched item, fail
 			AVB_LOGF_ERROR("Unrecognized configuration item: section=%s, name=%s", section, name);
@@ -255,6 +265,7 @@ int openavbReadConfig(const char *ini_file, const char *save_ini_file, openavb_e
 	// defaults - most are handled by setting everything to 0
 	memset(pCfg, 0, sizeof(openavb_endpoint_cfg_t));
 	pCfg->fqtss_mode = -1;
+	pCfg->maxStreams = MAX_AVB_STREAMS;
 
 	int result = ini_parse(ini_file, cfgCallback, pCfg);
 	if (result < 0) {
@@ -41,11 +41,15 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 #include "openavb_types.h"
 #include "openavb_srp_api.h"
+#include "avb_sched.h"
 #include "net/if.h"
 
 #define DEFAULT_INI_FILE "endpoint.ini"
 #define DEFAULT_SAVE_INI_FILE "endpoint_save.ini"
 
+// Upper bound for max_streams; the FWMARK encoding limits each SR class to this many streams.
+#define ENDPOINT_MAX_STREAMS_LIMIT (MAX_AVB_SR_CLASSES * (TC_AVB_STREAM_MASK + 1))
+
 typedef struct {
 	char				ifname[IFNAMSIZ + 10]; // Include space for the socket type prefix (e.g. "simple:eth0")
 	U8					ifmac[ETH_ALEN];
@@ -54,6 +58,7 @@ typedef struct {
 	unsigned			link_kbit;
 	unsigned			nsr_kbit;
 	unsigned			mtu;
+	unsigned			maxStreams;
 	unsigned			fqtss_mode;
 	bool				noSrp;
 	unsigned			maapPort;
@@ -32,42 +32,342 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #ifndef OPENAVB_ENDPOINT_CLIENT_OSAL_C
 #define OPENAVB_ENDPOINT_CLIENT_OSAL_C
 
+#include <sys/eventfd.h>
+
+#include "openavb_endpoint_frame_osal.c"
+
+#define NOTIFY_FD_INVALID (-1)
+#define NOTIFY_MAX_EVENTS 64
+
+// One thread watches the endpoint connections of every talker and listener in the
+// process. When the endpoint sends something it raises the pending flag registered
+// for the connection, so the message is serviced on the next step of the talker or
+// listener instead of the next once a second IPC service. Connections are armed one
+// shot and armed again by openavbEptClntNotify() after each service. The flags are
+// kept in a table indexed by socket, which is only touched with the mutex held.
+THREAD_TYPE(eptNotifyThread);
+THREAD_DEFINITON(eptNotifyThread);
+static MUTEX_HANDLE_ALT(eptNotifyMutex) = PTHREAD_MUTEX_INITIALIZER;
+static bool bNotifyRunning = FALSE;
+static int notifyEpfd = NOTIFY_FD_INVALID;
+static int notifyEvfd = NOTIFY_FD_INVALID;
+static volatile bool **notifyFlags = NULL;
+static int notifyFlagsCount = 0;
+
+// Frames are read without blocking, each connection keeps the part of a frame read so far.
+// Messages to the endpoint are queued and sent as one frame when the connection is next
+// serviced or armed. The connections are kept in a table indexed by socket too, guarded
+// by the same mutex. Each gets a serial number, so a service pass can tell its connection
+// was closed by a message handler even if the socket was reused since.
+typedef struct {
+	frame_rx_t rx;
+	openavbEndpointMessage_t txMsgs[OPENAVB_ENDPOINT_FRAME_MAX_MSGS];
+	int txCount;
+	U32 serial;
+} conn_t;
+
+static conn_t **conns = NULL;
+static int connsCount = 0;
+static U32 connSerial = 0;
+
+static void *notifyThreadFn(void *pv)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
+	struct epoll_event events[NOTIFY_MAX_EVENTS];
+	bool bRunning = TRUE;
+	int i;
+
+	while (bRunning) {
+		int nEvents = epoll_wait(notifyEpfd, events, NOTIFY_MAX_EVENTS, -1);
+		if (nEvents < 0) {
+			if (errno != EINTR) {
+				AVB_LOGF_ERROR("Endpoint notify epoll error: %s", strerror(errno));
+				break;
+			}
+			continue;
+		}
+
+		MUTEX_LOCK_ALT(eptNotifyMutex);
+		for (i = 0; i < nEvents; i++) {
+			int fd = events[i].data.fd;
+			if (fd == notifyEvfd) {
+				U64 count;
+				if (read(notifyEvfd, &count, sizeof(count)) < 0) {
+					AVB_LOGF_ERROR("Endpoint notify read error: %s", strerror(errno));
+				}
+			}
+			else if (fd < notifyFlagsCount && notifyFlags[fd]) {
+				// An event from a connection closed since the wait is ignored
+				*notifyFlags[fd] = TRUE;
+			}
+		}
+		bRunning = bNotifyRunning;
+		MUTEX_UNLOCK_ALT(eptNotifyMutex);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+	return NULL;
+}
+
+// Start the watcher thread. Called with the mutex held.
+static bool notifyStart(void)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
+
+	notifyEpfd = epoll_create1(EPOLL_CLOEXEC);
+	if (notifyEpfd < 0) {
+		AVB_LOGF_ERROR("Failed to create endpoint notify epoll: %s", strerror(errno));
+		goto error;
+	}
+
+	notifyEvfd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (notifyEvfd < 0) {
+		AVB_LOGF_ERROR("Failed to create endpoint notify eventfd: %s", strerror(errno));
+		goto error;
+	}
+
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.fd = notifyEvfd;
+	if (epoll_ctl(notifyEpfd, EPOLL_CTL_ADD, notifyEvfd, &ev) < 0) {
+		AVB_LOGF_ERROR("Failed to add endpoint notify eventfd: %s", strerror(errno));
+		goto error;
+	}
+
+	bool errResult;
+	bNotifyRunning = TRUE;
+	THREAD_CREATE(eptNotifyThread, eptNotifyThread, NULL, notifyThreadFn, NULL);
+	THREAD_CHECK_ERROR(eptNotifyThread, "Thread / task creation failed", errResult);
+	if (errResult) {
+		bNotifyRunning = FALSE;
+		goto error;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+	return TRUE;
+
+  error:
+	if (notifyEvfd >= 0) {
+		close(notifyEvfd);
+		notifyEvfd = NOTIFY_FD_INVALID;
+	}
+	if (notifyEpfd >= 0) {
+		close(notifyEpfd);
+		notifyEpfd = NOTIFY_FD_INVALID;
+	}
+	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+	return FALSE;
+}
+
+// Stop watching a connection. Done before its socket is closed, so the descriptor
+// can't be reused by another connection while still registered.
+static void notifyRemove(int h)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
+
+	MUTEX_LOCK_ALT(eptNotifyMutex);
+	if (h >= 0 && h < notifyFlagsCount && notifyFlags[h]) {
+		epoll_ctl(notifyEpfd, EPOLL_CTL_DEL, h, NULL);
+		notifyFlags[h] = NULL;
+	}
+	MUTEX_UNLOCK_ALT(eptNotifyMutex);
+
+	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+}
+
+// Allocate the state of a new connection.
+static bool connOpen(int h)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
+	bool rc = FALSE;
+
+	MUTEX_LOCK_ALT(eptNotifyMutex);
+	do {
+		if (h >= connsCount) {
+			int count = connsCount ? connsCount : 64;
+			while (count <= h) {
+				count *= 2;
+			}
+			conn_t **newConns = realloc(conns, count * sizeof(*conns));
+			if (!newConns) {
+				break;
+			}
+			memset(newConns + connsCount, 0, (count - connsCount) * sizeof(*conns));
+			conns = newConns;
+			connsCount = count;
+		}
+
+		free(conns[h]);
+		conns[h] = calloc(1, sizeof(conn_t));
+		if (conns[h]) {
+			conns[h]->serial = ++connSerial;
+			rc = TRUE;
+		}
+	} while (0);
+	MUTEX_UNLOCK_ALT(eptNotifyMutex);
+
+	if (!rc) {
+		AVB_LOG_ERROR("Failed to allocate endpoint connection");
+	}
+	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+	return rc;
+}
+
+// A connection is only used and closed by the thread running its talker or listener,
+// so the state stays valid until that thread closes it.
+static conn_t *connGet(int h)
+{
+	conn_t *pConn = NULL;
+
+	MUTEX_LOCK_ALT(eptNotifyMutex);
+	if (h >= 0 && h < connsCount) {
+		pConn = conns[h];
+	}
+	MUTEX_UNLOCK_ALT(eptNotifyMutex);
+	return pConn;
+}
+
+// Send the messages queued for a connection as one frame.
+static bool connFlush(int h, conn_t *pConn)
+{
+	bool rc = TRUE;
+
+	if (pConn->txCount) {
+		rc = x_frameSend(h, pConn->txMsgs, pConn->txCount);
+		pConn->txCount = 0;
+		if (!rc) {
+			AVB_LOG_ERROR("Client send failed");
+		}
+	}
+	return rc;
+}
+
+bool openavbEptClntNotify(int h, volatile bool *pPending)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
+	bool rc = FALSE;
+
+	if (h == AVB_ENDPOINT_HANDLE_INVALID || h < 0 || !pPending) {
+		AVB_LOG_ERROR("Client notify: invalid argument passed");
+		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+		return FALSE;
+	}
+
+	// Send what the last pass queued before waiting for the replies. A failed send ends
+	// the stream, which is seen as a lost connection on the next service.
+	conn_t *pConn = connGet(h);
+	if (pConn && !connFlush(h, pConn)) {
+		shutdown(h, SHUT_RDWR);
+	}
+
+	MUTEX_LOCK_ALT(eptNotifyMutex);
+
+	if (!bNotifyRunning && !notifyStart()) {
+		goto done;
+	}
+
+	if (h >= notifyFlagsCount) {
+		int count = notifyFlagsCount ? notifyFlagsCount : 64;
+		while (count <= h) {
+			count *= 2;
+		}
+		volatile bool **newFlags = realloc(notifyFlags, count * sizeof(*notifyFlags));
+		if (!newFlags) {
+			AVB_LOG_ERROR("Failed to allocate endpoint notify table");
+			goto done;
+		}
+		memset(newFlags + notifyFlagsCount, 0, (count - notifyFlagsCount) * sizeof(*notifyFlags));
+		notifyFlags = newFlags;
+		notifyFlagsCount = count;
+	}
+
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN | EPOLLONESHOT;
+	ev.data.fd = h;
+	if (epoll_ctl(notifyEpfd, notifyFlags[h] ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, h, &ev) < 0) {
+		AVB_LOGF_ERROR("Failed to watch endpoint connection: %s", strerror(errno));
+		goto done;
+	}
+	notifyFlags[h] = pPending;
+	rc = TRUE;
+
+  done:
+	MUTEX_UNLOCK_ALT(eptNotifyMutex);
+	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+	return rc;
+}
+
+void openavbEptClntNotifyStop(void)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
+
+	MUTEX_LOCK_ALT(eptNotifyMutex);
+	bool bRunning = bNotifyRunning;
+	if (bRunning) {
+		U64 one = 1;
+		bNotifyRunning = FALSE;
+		if (write(notifyEvfd, &one, sizeof(one)) < 0) {
+			AVB_LOGF_ERROR("Endpoint notify write error: %s", strerror(errno));
+		}
+	}
+	MUTEX_UNLOCK_ALT(eptNotifyMutex);
+
+	if (bRunning) {
+		THREAD_JOIN(eptNotifyThread, NULL);
+
+		MUTEX_LOCK_ALT(eptNotifyMutex);
+		close(notifyEvfd);
+		close(notifyEpfd);
+		notifyEvfd = NOTIFY_FD_INVALID;
+		notifyEpfd = NOTIFY_FD_INVALID;
+		free(notifyFlags);
+		notifyFlags = NULL;
+		notifyFlagsCount = 0;
+		MUTEX_UNLOCK_ALT(eptNotifyMutex);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+}
+
 static void socketClose(int h)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
 	if (h != AVB_ENDPOINT_HANDLE_INVALID) {
+		notifyRemove(h);
+
+		MUTEX_LOCK_ALT(eptNotifyMutex);
+		if (h >= 0 && h < connsCount) {
+			free(conns[h]);
+			conns[h] = NULL;
+		}
+		MUTEX_UNLOCK_ALT(eptNotifyMutex);
+
 		close(h);
 	}
 	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 }
 
+// Messages are queued, and go out when the connection is next serviced or armed,
+// or closed. Only a full queue is sent at once.
 static bool openavbEptClntSendToServer(int h, openavbEndpointMessage_t *msg)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
 
-	if (!msg || h == AVB_ENDPOINT_HANDLE_INVALID) {
+	conn_t *pConn = connGet(h);
+	if (!msg || h == AVB_ENDPOINT_HANDLE_INVALID || !pConn) {
 		AVB_LOG_ERROR("Client send: invalid argument passed");
 		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 		return FALSE;
 	}
 
-	ssize_t nWrite = write(h, msg, OPENAVB_ENDPOINT_MSG_LEN);
-	AVB_LOGF_VERBOSE("Sent message, len=%zu, nWrite=%zu", OPENAVB_ENDPOINT_MSG_LEN, nWrite);
-
-	if (nWrite < OPENAVB_ENDPOINT_MSG_LEN) {
-		if (nWrite < 0) {
-			AVB_LOGF_ERROR("Client failed to write socket: %s", strerror(errno));
-		}
-		else if (nWrite == 0) {
-			AVB_LOG_ERROR("Client send: socket closed unexpectedly");
-		}
-		else {
-			AVB_LOG_ERROR("Client send: short write");
-		}
+	if (pConn->txCount == OPENAVB_ENDPOINT_FRAME_MAX_MSGS && !connFlush(h, pConn)) {
 		socketClose(h);
 		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 		return FALSE;
 	}
+	memcpy(&pConn->txMsgs[pConn->txCount++], msg, OPENAVB_ENDPOINT_MSG_LEN);
 
 	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 	return TRUE;
@@ -96,6 +396,12 @@ int openavbEptClntOpenSrvrConnection(tl_state_t *pTLState)
 		return AVB_ENDPOINT_HANDLE_INVALID;
 	}
 
+	if (!connOpen(h)) {
+		socketClose(h);
+		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+		return AVB_ENDPOINT_HANDLE_INVALID;
+	}
+
 	AVB_LOG_DEBUG("Connected to endpoint");
 	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 	return h;
@@ -104,6 +410,11 @@ int openavbEptClntOpenSrvrConnection(tl_state_t *pTLState)
 void openavbEptClntCloseSrvrConnection(int h)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
+	// Send a final stop before closing
+	conn_t *pConn = connGet(h);
+	if (pConn) {
+		connFlush(h, pConn);
+	}
 	socketClose(h);
 	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 }
@@ -111,70 +422,87 @@ void openavbEptClntCloseSrvrConnection(int h)
 bool openavbEptClntService(int h, int timeout)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
-	bool rc = FALSE;
+	openavbEndpointMessage_t msgBuf[OPENAVB_ENDPOINT_FRAME_MAX_MSGS];
+	int i;
 
-	if (h == AVB_ENDPOINT_HANDLE_INVALID) {
+	conn_t *pConn = connGet(h);
+	if (h == AVB_ENDPOINT_HANDLE_INVALID || !pConn) {
 		AVB_LOG_ERROR("Client service: invalid socket");
 		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 		return FALSE;
 	}
-	
+	U32 serial = pConn->serial;
+
+	// Send what was queued since the last pass before waiting for replies
+	if (!connFlush(h, pConn)) {
+		socketClose(h);
+		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+		return FALSE;
+	}
+
 	struct pollfd fds[1];
 	memset(fds, 0, sizeof(struct pollfd));
 	fds[0].fd = h;
 	fds[0].events = POLLIN;
 
-	AVB_LOG_VERBOSE("Waiting for event...");
-	int pRet = poll(fds, 1, timeout);
+	// Handle every frame that is waiting; only the first poll may block.
+	while (1) {
+		AVB_LOG_VERBOSE("Waiting for event...");
+		int pRet = poll(fds, 1, timeout);
 
-	if (pRet == 0) {
-		AVB_LOG_VERBOSE("Poll timeout");
-		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
-		return TRUE;
-	}
-	else if (pRet < 0) {
-		if (errno == EINTR) {
-			AVB_LOG_VERBOSE("Poll interrupted");
+		if (pRet == 0) {
+			AVB_LOG_VERBOSE("Poll timeout");
 			AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 			return TRUE;
 		}
-		else {
+		else if (pRet < 0) {
+			if (errno == EINTR) {
+				AVB_LOG_VERBOSE("Poll interrupted");
+				AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+				return TRUE;
+			}
 			AVB_LOGF_ERROR("Poll error: %s", strerror(errno));
+			AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+			return FALSE;
 		}
-	}
-	else {
+
 		AVB_LOGF_DEBUG("Poll returned %d events", pRet);
-		// only one fd, so it's readable.
-		openavbEndpointMessage_t msgBuf;
-		memset(&msgBuf, 0, OPENAVB_ENDPOINT_MSG_LEN);
-		ssize_t nRead = read(h, &msgBuf, OPENAVB_ENDPOINT_MSG_LEN);
-					
-		if (nRead < OPENAVB_ENDPOINT_MSG_LEN) {
-			// sock closed
-			if (nRead == 0) {
-				AVB_LOG_ERROR("Socket closed unexpectedly");
-			}
-			else if (nRead < 0) {
-				AVB_LOGF_ERROR("Socket read error: %s", strerror(errno));
-			}
-			else {
-				AVB_LOG_ERROR("Socket read to short");
-			}
-			socketClose(h);
+		if (fds[0].revents & POLLNVAL) {
+			// Closed while handling a message
+			AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+			return FALSE;
 		}
-		else {
-			// got a message
-			if (openavbEptClntReceiveFromServer(h, &msgBuf)) {
-				rc = TRUE;
-			}
-			else {
-				AVB_LOG_ERROR("Invalid message received");
+		// only one fd, so it's readable. Handle every whole frame read.
+		int nMsgs;
+		while ((nMsgs = x_frameRead(h, &pConn->rx, msgBuf)) != FRAME_READ_NONE) {
+			if (nMsgs < 0) {
+				// sock closed
+				if (nMsgs == FRAME_READ_CLOSED) {
+					AVB_LOG_ERROR("Socket closed unexpectedly");
+				}
 				socketClose(h);
+				AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+				return FALSE;
+			}
+
+			for (i = 0; i < nMsgs; i++) {
+				if (!openavbEptClntReceiveFromServer(h, &msgBuf[i])) {
+					AVB_LOG_ERROR("Invalid message received");
+					socketClose(h);
+					AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+					return FALSE;
+				}
+
+				// Stop if the handler closed the connection
+				pConn = connGet(h);
+				if (!pConn || pConn->serial != serial) {
+					AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+					return FALSE;
+				}
 			}
 		}
+		timeout = 0;
 	}
-	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
-	return rc;
 }
 
 #endif // OPENAVB_ENDPOINT_CLIENT_OSAL_C
@@ -0,0 +1,218 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Framing of the messages sent between the endpoint and its clients.
+* Included by both openavb_endpoint_client_osal.c and openavb_endpoint_server_osal.c.
+*/
+
+#ifndef OPENAVB_ENDPOINT_FRAME_OSAL_C
+#define OPENAVB_ENDPOINT_FRAME_OSAL_C
+
+#include <sys/socket.h>
+
+// Write count messages as one frame into buf, which must hold OPENAVB_ENDPOINT_FRAME_MAX_LEN
+// bytes. Returns the frame length, or 0 if count is out of range.
+static U32 x_frameEncode(U8 *buf, const openavbEndpointMessage_t *msgs, int count)
+{
+	openavbEndpointFrameLen_t len;
+
+	if (count < 1 || count > OPENAVB_ENDPOINT_FRAME_MAX_MSGS) {
+		AVB_LOGF_ERROR("Invalid frame message count: %d", count);
+		return 0;
+	}
+
+	len = count * OPENAVB_ENDPOINT_MSG_LEN;
+	memcpy(buf, &len, sizeof(len));
+	memcpy(buf + sizeof(len), msgs, len);
+	return sizeof(len) + len;
+}
+
+// Send count messages as one frame. The frame goes out in a single write so frames
+// from threads sharing a socket are never interleaved. Frames are read back without
+// blocking, so they may arrive in pieces; see x_frameRead().
+static bool x_frameSend(int sock, const openavbEndpointMessage_t *msgs, int count)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
+
+	U8 frame[OPENAVB_ENDPOINT_FRAME_MAX_LEN];
+	U32 frameLen = x_frameEncode(frame, msgs, count);
+	if (!frameLen) {
+		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+		return FALSE;
+	}
+
+	ssize_t nWrite = send(sock, frame, frameLen, MSG_NOSIGNAL);
+	AVB_LOGF_VERBOSE("Sent frame, msgs=%d, nWrite=%zd", count, nWrite);
+
+	if (nWrite < (ssize_t)frameLen) {
+		if (nWrite < 0) {
+			AVB_LOGF_ERROR("Failed to write socket: %s", strerror(errno));
+		}
+		else if (nWrite == 0) {
+			AVB_LOG_ERROR("Socket closed unexpectedly");
+		}
+		else {
+			AVB_LOG_ERROR("Socket write too short");
+		}
+		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+		return FALSE;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+	return TRUE;
+}
+
+// Frames a peer hasn't taken yet. Used on non-blocking sockets, where a frame may go out
+// in pieces over several writes.
+#define FRAME_TX_MAX_FRAMES	8
+
+typedef struct {
+	U8 buf[FRAME_TX_MAX_FRAMES * OPENAVB_ENDPOINT_FRAME_MAX_LEN];
+	U32 len;
+} frame_tx_t;
+
+// Add count messages to pTx as one frame. Returns FALSE if the peer has fallen so far
+// behind that there is no room for it.
+static bool x_frameQueue(frame_tx_t *pTx, const openavbEndpointMessage_t *msgs, int count)
+{
+	if (sizeof(pTx->buf) - pTx->len < OPENAVB_ENDPOINT_FRAME_MAX_LEN) {
+		AVB_LOG_ERROR("Socket send buffer full");
+		return FALSE;
+	}
+
+	U32 frameLen = x_frameEncode(pTx->buf + pTx->len, msgs, count);
+	pTx->len += frameLen;
+	return frameLen != 0;
+}
+
+// Write as much of pTx as sock takes without blocking and keep the rest.
+// Returns FALSE on a write error.
+static bool x_frameWrite(int sock, frame_tx_t *pTx)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
+
+	U32 sent = 0;
+	while (sent < pTx->len) {
+		ssize_t nWrite = send(sock, pTx->buf + sent, pTx->len - sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (nWrite > 0) {
+			sent += nWrite;
+			continue;
+		}
+		if (nWrite < 0 && errno == EINTR) {
+			continue;
+		}
+		if (nWrite < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			break;
+		}
+
+		AVB_LOGF_ERROR("Failed to write socket: %s", nWrite < 0 ? strerror(errno) : "closed");
+		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+		return FALSE;
+	}
+
+	AVB_LOGF_VERBOSE("Wrote %u bytes, %u left", sent, pTx->len - sent);
+	pTx->len -= sent;
+	memmove(pTx->buf, pTx->buf + sent, pTx->len);
+
+	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+	return TRUE;
+}
+
+// Returned by x_frameRead() besides a message count
+#define FRAME_READ_NONE		0		// No whole frame has arrived yet
+#define FRAME_READ_CLOSED	(-1)	// The peer closed the socket
+#define FRAME_READ_ERROR	(-2)	// Read error or malformed frame
+
+// Bytes read from a socket that don't make up a whole frame yet
+typedef struct {
+	U8 buf[OPENAVB_ENDPOINT_FRAME_MAX_LEN];
+	U32 len;
+} frame_rx_t;
+
+// Take the next frame from what has been read on sock into pRx, reading more without
+// blocking when it isn't whole yet. msgs must hold OPENAVB_ENDPOINT_FRAME_MAX_MSGS messages.
+// Returns the number of messages in the frame, or one of the FRAME_READ_ codes.
+static int x_frameRead(int sock, frame_rx_t *pRx, openavbEndpointMessage_t *msgs)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
+
+	openavbEndpointFrameLen_t len;
+
+	while (1) {
+		if (pRx->len >= sizeof(len)) {
+			memcpy(&len, pRx->buf, sizeof(len));
+			if (len == 0 || len % OPENAVB_ENDPOINT_MSG_LEN != 0 || len > OPENAVB_ENDPOINT_FRAME_MAX_MSGS * OPENAVB_ENDPOINT_MSG_LEN) {
+				AVB_LOGF_ERROR("Invalid frame length: %u", len);
+				AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+				return FRAME_READ_ERROR;
+			}
+
+			U32 frameLen = sizeof(len) + len;
+			if (pRx->len >= frameLen) {
+				memcpy(msgs, pRx->buf + sizeof(len), len);
+				pRx->len -= frameLen;
+				memmove(pRx->buf, pRx->buf + frameLen, pRx->len);
+
+				AVB_LOGF_VERBOSE("Read frame, msgs=%u", len / OPENAVB_ENDPOINT_MSG_LEN);
+				AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+				return len / OPENAVB_ENDPOINT_MSG_LEN;
+			}
+		}
+
+		// A valid frame fits in the buffer, so there is always room left for the rest of one
+		ssize_t nRead = recv(sock, pRx->buf + pRx->len, sizeof(pRx->buf) - pRx->len, MSG_DONTWAIT);
+		if (nRead > 0) {
+			pRx->len += nRead;
+			continue;
+		}
+		if (nRead == 0) {
+			if (pRx->len) {
+				AVB_LOG_ERROR("Socket closed in the middle of a frame");
+			}
+			AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+			return FRAME_READ_CLOSED;
+		}
+		if (errno == EINTR) {
+			continue;
+		}
+		if (errno == EAGAIN || errno == EWOULDBLOCK) {
+			AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+			return FRAME_READ_NONE;
+		}
+
+		AVB_LOGF_ERROR("Socket read error: %s", strerror(errno));
+		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+		return FRAME_READ_ERROR;
+	}
+}
+
+#endif // OPENAVB_ENDPOINT_FRAME_OSAL_C
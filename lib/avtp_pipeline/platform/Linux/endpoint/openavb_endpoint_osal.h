@@ -38,6 +38,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include <net/if.h>
 #include <unistd.h>
 #include <signal.h>
+#include <sys/epoll.h>
 
 typedef struct {
 	openavbEndpointMsgType_t	type;
@@ -56,6 +57,12 @@ typedef struct {
 	} params;
 } openavbEndpointMessage_t;
 
+// Messages travel over the socket in frames: the byte count of the messages that
+// follow, then that many whole messages. A single write can so carry several commands.
+typedef U32 openavbEndpointFrameLen_t;
+#define OPENAVB_ENDPOINT_FRAME_MAX_MSGS 16
+#define OPENAVB_ENDPOINT_FRAME_MAX_LEN (sizeof(openavbEndpointFrameLen_t) + OPENAVB_ENDPOINT_FRAME_MAX_MSGS * OPENAVB_ENDPOINT_MSG_LEN)
+
 
 bool startEndpoint(int mode, int ifindex, const char* ifname, unsigned mtu, unsigned link_kbit, unsigned nsr_kbit);
 void stopEndpoint();
@@ -54,6 +54,8 @@ extern openavb_endpoint_cfg_t x_cfg;
 
 #define MAAP_DYNAMIC_POOL_BASE 0x91E0F0000000LL /**< MAAP dynamic allocation pool base address - Defined in IEEE 1722-2016 Table B.9 */
 #define MAAP_DYNAMIC_POOL_SIZE 0xFE00 /**< MAAP dynamic allocation pool size - Defined in IEEE 1722-2016 Table B.9 */
+#define MAAP_LOCAL_POOL_END 0x91E0F000FF00LL /**< End of the MAAP locally administered pool - Defined in IEEE 1722-2016 Table B.9 */
+#define MAAP_FALLBACK_BASE 0x91E0F000FE80LL /**< First fallback address used when the MAAP daemon is not available */
 
 
 /*******************************************************************************
@@ -65,7 +67,12 @@ typedef struct {
 	bool taken;
 } maapAlloc_t;
 
-static maapAlloc_t maapAllocList[MAX_AVB_STREAMS];
+// Allocation list, sized once at initialization so handles stay valid.
+// Unused entries are kept on a stack of indexes for constant time allocation.
+static maapAlloc_t *maapAllocList = NULL;
+static int *maapFreeList = NULL;
+static int maapAllocCount = 0;
+static int maapFreeCount = 0;
 static openavbMaapRestartCb_t *maapRestartCallback = NULL;
 static struct ether_addr *maapPreferredAddress = NULL;
 
@@ -158,7 +165,7 @@ static void process_maap_notify(Maap_Notify *mn, int socketfd)
 			memset(&maapcmd, 0, sizeof(Maap_Cmd));
 			maapcmd.kind = MAAP_CMD_RESERVE;
 			maapcmd.start = 0; // No preferred address
-			maapcmd.count = MAX_AVB_STREAMS;
+			maapcmd.count = maapAllocCount;
 			if (maapPreferredAddress != NULL) {
 				// Suggest the addresses from the previous time this application was run.
 				maapcmd.start = MaapMacAddrToLongLong(maapPreferredAddress);
@@ -203,7 +210,7 @@ static void process_maap_notify(Maap_Notify *mn, int socketfd)
 			// Update the stored addresses.
 			MAAP_LOCK();
 			int i = 0;
-			for (i = 0; i < mn->count && i < MAX_AVB_STREAMS; i++) {
+			for (i = 0; i < mn->count && i < maapAllocCount; i++) {
 				MaapResultToMacAddr(mn->start + i, &(maapAllocList[i].destAddr));
 				if (maapAllocList[i].taken && maapRestartCallback) {
 					// Use the callback to notify that a change has occurred.
@@ -450,10 +457,26 @@ static void* maapThread(void *arg)
 	return NULL;
 }
 
-bool openavbMaapInitialize(const char *ifname, unsigned int maapPort, struct ether_addr *maapPrefAddr, openavbMaapRestartCb_t* cbfn)
+bool openavbMaapInitialize(const char *ifname, unsigned int maapPort, struct ether_addr *maapPrefAddr, unsigned int maxStreams, openavbMaapRestartCb_t* cbfn)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_MAAP);
 
+	if (maxStreams == 0) {
+		maxStreams = MAX_AVB_STREAMS;
+	}
+	maapAllocList = calloc(maxStreams, sizeof(maapAlloc_t));
+	maapFreeList = calloc(maxStreams, sizeof(int));
+	if (!maapAllocList || !maapFreeList) {
+		AVB_LOG_ERROR("Unable to allocate the MAAP address list");
+		free(maapAllocList);
+		free(maapFreeList);
+		maapAllocList = NULL;
+		maapFreeList = NULL;
+		AVB_TRACE_EXIT(AVB_TRACE_MAAP);
+		return false;
+	}
+	maapAllocCount = maxStreams;
+
 	// Save the supplied callback function.
 	maapRestartCallback = cbfn;
 	maapPreferredAddress = maapPrefAddr;
@@ -468,11 +491,18 @@ bool openavbMaapInitialize(const char *ifname, unsigned int maapPort, struct eth
 
 	// Default to using addresses from the MAAP locally administered Pool.
 	int i = 0;
-	U8 destAddr[ETH_ALEN] = {0x91, 0xe0, 0xf0, 0x00, 0xfe, 0x80};
-	for (i = 0; i < MAX_AVB_STREAMS; i++) {
-		memcpy(maapAllocList[i].destAddr.ether_addr_octet, destAddr, ETH_ALEN);
+	for (i = 0; i < maapAllocCount; i++) {
+		MaapResultToMacAddr(MAAP_FALLBACK_BASE + i, &(maapAllocList[i].destAddr));
 		maapAllocList[i].taken = false;
-		destAddr[5] += 1;
+	}
+	if (MAAP_FALLBACK_BASE + maapAllocCount > MAAP_LOCAL_POOL_END) {
+		AVB_LOGF_WARNING("max_streams %d exceeds the MAAP locally administered Pool; fallback addresses will extend past it", maapAllocCount);
+	}
+
+	// Stack the free entries so the lowest index is handed out first.
+	maapFreeCount = 0;
+	for (i = maapAllocCount - 1; i >= 0; i--) {
+		maapFreeList[maapFreeCount++] = i;
 	}
 
 	if (maapPort == 0) {
@@ -512,6 +542,13 @@ void openavbMaapFinalize()
 	MUTEX_DESTROY(maapMutex);
 	MUTEX_LOG_ERR("Error destroying mutex");
 
+	free(maapAllocList);
+	free(maapFreeList);
+	maapAllocList = NULL;
+	maapFreeList = NULL;
+	maapAllocCount = 0;
+	maapFreeCount = 0;
+
 	AVB_TRACE_EXIT(AVB_TRACE_MAAP);
 }
 
@@ -557,14 +594,9 @@ void* openavbMaapAllocate(int count, /* out */ struct ether_addr *addr)
 
 	MAAP_LOCK();
 
-	// Find the next non-allocated address.
-	int i = 0;
-	while (i < MAX_AVB_STREAMS && maapAllocList[i].taken) {
-		i++;
-	}
-
 	// Allocate an address from the pool.
-	if (i < MAX_AVB_STREAMS) {
+	if (maapFreeCount > 0) {
+		int i = maapFreeList[--maapFreeCount];
 		maapAllocList[i].taken = true;
 		memcpy(addr, maapAllocList[i].destAddr.ether_addr_octet, sizeof(struct ether_addr));
 		AVB_LOGF_INFO("Allocated MAAP address " ETH_FORMAT, ETH_OCTETS(addr->ether_addr_octet));
@@ -577,7 +609,7 @@ void* openavbMaapAllocate(int count, /* out */ struct ether_addr *addr)
 
 	MAAP_UNLOCK();
 
-	AVB_LOG_ERROR("All MAAP addresses already allocated");
+	AVB_LOGF_ERROR("All %d MAAP addresses already allocated (see max_streams)", maapAllocCount);
 	AVB_TRACE_EXIT(AVB_TRACE_MAAP);
 	return NULL;
 }
@@ -588,8 +620,11 @@ void openavbMaapRelease(void* handle)
 
 	MAAP_LOCK();
 	maapAlloc_t *elem = handle;
-	elem->taken = false;
-	AVB_LOGF_DEBUG("Freed MAAP address " ETH_FORMAT, ETH_OCTETS(elem->destAddr.ether_addr_octet));
+	if (elem->taken) {
+		elem->taken = false;
+		maapFreeList[maapFreeCount++] = elem - maapAllocList;
+		AVB_LOGF_DEBUG("Freed MAAP address " ETH_FORMAT, ETH_OCTETS(elem->destAddr.ether_addr_octet));
+	}
 	MAAP_UNLOCK();
 
 	AVB_TRACE_EXIT(AVB_TRACE_MAAP);
@@ -61,6 +61,8 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #define ETH_ALEN 6
 #endif
 
+// Each reservation is allocated separately and its address is the handle,
+// so there is no fixed limit and release does not need to search.
 typedef struct shaper_reservation
 {
 	int in_use;
@@ -71,8 +73,7 @@ typedef struct shaper_reservation
 	unsigned char stream_da[ETH_ALEN];
 } shaper_reservation;
 
-#define MAX_SHAPER_RESERVATIONS 4
-static shaper_reservation shaperReservationList[MAX_SHAPER_RESERVATIONS];
+static int shaperReservationCount = 0;
 
 static bool shaperRunning = FALSE;
 static pthread_t shaperThreadHandle;
@@ -247,7 +248,7 @@ bool openavbShaperInitialize(const char *ifname, unsigned int shaperPort)
 	MUTEX_CREATE(shaperMutex, mta);
 	MUTEX_LOG_ERR("Could not create/initialize 'shaperMutex' mutex");
 
-	memset(shaperReservationList, 0, sizeof(shaperReservationList));
+	shaperReservationCount = 0;
 
 	if (shaperPort == 0) {
 		shaperState = SHAPER_STATE_NOT_AVAILABLE;
@@ -331,44 +332,36 @@ void* openavbShaperHandle(SRClassIdx_t sr_class, int measurement_interval_usec,
 		return NULL;
 	}
 
-	// Find the first available index.
-	int i;
-	for (i = 0; i < MAX_SHAPER_RESERVATIONS; ++i)
+	shaper_reservation *pReservation = calloc(1, sizeof(shaper_reservation));
+	if (!pReservation)
 	{
-		if (!(shaperReservationList[i].in_use))
-		{
-			break;
-		}
-	}
-	if (i >= MAX_SHAPER_RESERVATIONS)
-	{
-		AVB_LOG_ERROR("No Shaper reservations are available");
+		AVB_LOG_ERROR("Unable to allocate a Shaper reservation");
 		return NULL;
 	}
 
 	// Fill in the information.
-	shaperReservationList[i].in_use = TRUE;
-	shaperReservationList[i].sr_class = sr_class;
-	shaperReservationList[i].measurement_interval = measurement_interval_usec;
-	shaperReservationList[i].max_frame_size = max_frame_size_bytes;
-	shaperReservationList[i].max_frames_per_interval = max_frames_per_interval;
-	memcpy(shaperReservationList[i].stream_da, stream_da, ETH_ALEN);
+	pReservation->in_use = TRUE;
+	pReservation->sr_class = sr_class;
+	pReservation->measurement_interval = measurement_interval_usec;
+	pReservation->max_frame_size = max_frame_size_bytes;
+	pReservation->max_frames_per_interval = max_frames_per_interval;
+	memcpy(pReservation->stream_da, stream_da, ETH_ALEN);
 
 	// Send the information to the Shaper daemon.
 	// Reserving Bandwidth Example:  -ri eth2 -c A -s 125 -b 74 -f 1 -a ff:ff:ff:ff:ff:11\n
 	char szCommand[200];
 	sprintf(szCommand, "-ri %s -c %c -s %u -b %u -f %u -a %02x:%02x:%02x:%02x:%02x:%02x",
 		interfaceOnly,
-		( shaperReservationList[i].sr_class == SR_CLASS_A ? 'A' : 'B' ),
-		shaperReservationList[i].measurement_interval,
-		shaperReservationList[i].max_frame_size,
-		shaperReservationList[i].max_frames_per_interval,
-		shaperReservationList[i].stream_da[0],
-		shaperReservationList[i].stream_da[1],
-		shaperReservationList[i].stream_da[2],
-		shaperReservationList[i].stream_da[3],
-		shaperReservationList[i].stream_da[4],
-		shaperReservationList[i].stream_da[5]);
+		( pReservation->sr_class == SR_CLASS_A ? 'A' : 'B' ),
+		pReservation->measurement_interval,
+		pReservation->max_frame_size,
+		pReservation->max_frames_per_interval,
+		pReservation->stream_da[0],
+		pReservation->stream_da[1],
+		pReservation->stream_da[2],
+		pReservation->stream_da[3],
+		pReservation->stream_da[4],
+		pReservation->stream_da[5]);
 	AVB_LOGF_DEBUG("Sending Shaper command:  %s", szCommand);
 	strcat(szCommand, "\n");
 	if (send(socketfd, szCommand, strlen(szCommand), 0) < 0)
@@ -376,51 +369,49 @@ void* openavbShaperHandle(SRClassIdx_t sr_class, int measurement_interval_usec,
 		/* Something went wrong.  Abort! */
 		AVB_LOGF_ERROR("Shaper:  Error %d writing to network socket (%s)", errno, strerror(errno));
 		shaperState = SHAPER_STATE_ERROR;
+		free(pReservation);
 		return NULL;
 	}
 
 	shaperState = SHAPER_STATE_ENABLED;
+	shaperReservationCount++;
+	AVB_LOGF_DEBUG("Shaper reservations in use:  %d", shaperReservationCount);
 
 	// TODO:  Verify that the command was successful.
 
-	return (void *)(&(shaperReservationList[i]));
+	return (void *)pReservation;
 }
 
 void openavbShaperRelease(void* handle)
 {
-	int i;
-	for (i = 0; i < MAX_SHAPER_RESERVATIONS; ++i)
+	shaper_reservation *pReservation = handle;
+	if (pReservation && pReservation->in_use)
 	{
-		if (handle == (void *)(&(shaperReservationList[i])))
+		// Send the information to the Shaper daemon.
+		// Unreserving Bandwidth Example:  -ua ff:ff:ff:ff:ff:11\n
+		char szCommand[200];
+		sprintf(szCommand, "-ua %02x:%02x:%02x:%02x:%02x:%02x",
+			pReservation->stream_da[0],
+			pReservation->stream_da[1],
+			pReservation->stream_da[2],
+			pReservation->stream_da[3],
+			pReservation->stream_da[4],
+			pReservation->stream_da[5]);
+
+		pReservation->in_use = FALSE;
+		free(pReservation);
+		shaperReservationCount--;
+
+		AVB_LOGF_DEBUG("Sending Shaper command:  %s", szCommand);
+		strcat(szCommand, "\n");
+		if (send(socketfd, szCommand, strlen(szCommand), 0) < 0)
 		{
-			if (shaperReservationList[i].in_use)
-			{
-				// Send the information to the Shaper daemon.
-				// Unreserving Bandwidth Example:  -ua ff:ff:ff:ff:ff:11\n
-				char szCommand[200];
-				sprintf(szCommand, "-ua %02x:%02x:%02x:%02x:%02x:%02x",
-					shaperReservationList[i].stream_da[0],
-					shaperReservationList[i].stream_da[1],
-					shaperReservationList[i].stream_da[2],
-					shaperReservationList[i].stream_da[3],
-					shaperReservationList[i].stream_da[4],
-					shaperReservationList[i].stream_da[5]);
-
-				shaperReservationList[i].in_use = FALSE;
-
-				AVB_LOGF_DEBUG("Sending Shaper command:  %s", szCommand);
-				strcat(szCommand, "\n");
-				if (send(socketfd, szCommand, strlen(szCommand), 0) < 0)
-				{
-					/* Something went wrong. */
-					AVB_LOGF_ERROR("Shaper:  Error %d writing to network socket (%s)", errno, strerror(errno));
-					shaperState = SHAPER_STATE_ERROR;
-				}
-				else {
-					// TODO:  Verify that the command was successful.
-				}
-			}
-			break;
+			/* Something went wrong. */
+			AVB_LOGF_ERROR("Shaper:  Error %d writing to network socket (%s)", errno, strerror(errno));
+			shaperState = SHAPER_STATE_ERROR;
+		}
+		else {
+			// TODO:  Verify that the command was successful.
 		}
 	}
 }
@@ -37,7 +37,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_endpoint.h"
 #include "openavb_srp.h"
 #include "mrp_client.h"
-#include "openavb_list.h"
+#include "openavb_hash.h"
 
 #define	AVB_LOG_COMPONENT	"Endpoint SRP"
 //#define AVB_LOG_LEVEL AVB_LOG_LEVEL_DEBUG
@@ -65,7 +65,12 @@ typedef struct {
 	int subtype;
 } strElem_t;
 
-openavb_list_t strElemList;
+// Stream elements keyed by the 8 byte stream ID. The MRP callbacks arrive
+// on the monitor thread, so lookups and updates are done under srpMutex.
+static openavb_hash_t strElemHash = NULL;
+static pthread_mutex_t srpMutex = PTHREAD_MUTEX_INITIALIZER;
+#define SRP_LOCK()		pthread_mutex_lock(&srpMutex)
+#define SRP_UNLOCK()	pthread_mutex_unlock(&srpMutex)
 
 #define SID_FORMAT "%02x:%02x:%02x:%02x:%02x:%02x/%u"
 #define SID_OCTETS(a) (a)[0],(a)[1],(a)[2],(a)[3],(a)[4],(a)[5],(a)[6]<<8|(a)[7]
@@ -79,20 +84,23 @@ void mrp_attach_cb(unsigned char streamid[8], int subtype)
 	AVB_LOGF_DEBUG("mrp_attach_cb "SID_FORMAT" subtype %d", SID_OCTETS(streamid), subtype);
 
 	if (_attachCb) {
-		openavb_list_node_t node = openavbListIterFirst(strElemList);
-		while (node) {
-			strElem_t *elem = openavbListData(node);
-			if (elem && elem->talker && memcmp(streamid, elem->streamId, sizeof(elem->streamId)) == 0) {
-				_attachCb(elem->avtpHandle, subtype);
-				elem->subtype = subtype;
-				AVB_LOGF_DEBUG("mrp_attach_cb subtype changed to %d", elem->subtype);
-				break;
-			}
-			else if (elem) {
-				AVB_LOGF_DEBUG("mrp_attach_cb skipping elem " SID_FORMAT ", talker %d",
-					SID_OCTETS(elem->streamId), elem->talker ? 1 : 0);
-			}
-			node = openavbListIterNext(strElemList);
+		void *avtpHandle = NULL;
+
+		SRP_LOCK();
+		strElem_t *elem = openavbHashGet(strElemHash, streamid);
+		if (elem && elem->talker) {
+			avtpHandle = elem->avtpHandle;
+			elem->subtype = subtype;
+			AVB_LOGF_DEBUG("mrp_attach_cb subtype changed to %d", elem->subtype);
+		}
+		else if (elem) {
+			AVB_LOGF_DEBUG("mrp_attach_cb skipping elem " SID_FORMAT ", talker %d",
+				SID_OCTETS(elem->streamId), elem->talker ? 1 : 0);
+		}
+		SRP_UNLOCK();
+
+		if (avtpHandle) {
+			_attachCb(avtpHandle, subtype);
 		}
 	}
 
@@ -109,30 +117,33 @@ void mrp_register_cb(unsigned char streamid[8], int join, unsigned char destaddr
 	             SID_OCTETS(streamid), ETH_OCTETS(destaddr), join, max_frame_size, max_interval_frames, vid, latency);
 
 	if (_registerCb) {
-		openavb_list_node_t node = openavbListIterFirst(strElemList);
-		while (node) {
-			strElem_t *elem = openavbListData(node);
-			if (elem && !elem->talker && memcmp(streamid, elem->streamId, sizeof(elem->streamId)) == 0) {
-				AVBTSpec_t tSpec;
-				tSpec.maxFrameSize = max_frame_size;
-				tSpec.maxIntervalFrames = max_interval_frames;
-				_registerCb(elem->avtpHandle,
-						join ? openavbSrp_AtTyp_TalkerAdvertise : openavbSrp_AtTyp_None,
-						destaddr,
-						&tSpec,
-						0, // SR_CLASS is ignored anyway
-						latency,
-						NULL
-						);
-				elem->subtype = join;
-				AVB_LOGF_DEBUG("mrp_register_cb subtype changed to %d", elem->subtype);
-				break;
-			}
-			else if (elem) {
-				AVB_LOGF_DEBUG("mrp_register_cb skipping elem " SID_FORMAT ", talker %d",
-					SID_OCTETS(elem->streamId), elem->talker ? 1 : 0);
-			}
-			node = openavbListIterNext(strElemList);
+		void *avtpHandle = NULL;
+
+		SRP_LOCK();
+		strElem_t *elem = openavbHashGet(strElemHash, streamid);
+		if (elem && !elem->talker) {
+			avtpHandle = elem->avtpHandle;
+			elem->subtype = join;
+			AVB_LOGF_DEBUG("mrp_register_cb subtype changed to %d", elem->subtype);
+		}
+		else if (elem) {
+			AVB_LOGF_DEBUG("mrp_register_cb skipping elem " SID_FORMAT ", talker %d",
+				SID_OCTETS(elem->streamId), elem->talker ? 1 : 0);
+		}
+		SRP_UNLOCK();
+
+		if (avtpHandle) {
+			AVBTSpec_t tSpec;
+			tSpec.maxFrameSize = max_frame_size;
+			tSpec.maxIntervalFrames = max_interval_frames;
+			_registerCb(avtpHandle,
+					join ? openavbSrp_AtTyp_TalkerAdvertise : openavbSrp_AtTyp_None,
+					destaddr,
+					&tSpec,
+					0, // SR_CLASS is ignored anyway
+					latency,
+					NULL
+					);
 		}
 	}
 
@@ -145,7 +156,17 @@ openavbRC openavbSrpInitialize(strmAttachCb_t attachCb, strmRegCb_t registerCb,
 	AVB_TRACE_ENTRY(AVB_TRACE_SRP_PUBLIC);
 	int err;
 
-	strElemList = openavbListNewList();
+	// The element table outlives a shutdown, since the MRP monitor thread
+	// is not joined and may still deliver callbacks.
+	SRP_LOCK();
+	if (!strElemHash) {
+		strElemHash = openavbHashNew(8, MAX_AVB_STREAMS);
+	}
+	SRP_UNLOCK();
+	if (!strElemHash) {
+		AVB_LOG_ERROR("Unable to allocate the SRP stream table");
+		goto error;
+	}
 
 	_attachCb = attachCb;
 	_registerCb = registerCb;
@@ -229,8 +250,11 @@ openavbRC openavbSrpRegisterStream(void* avtpHandle,
 	streamId[6] = _streamId->uniqueID >> 8;
 	streamId[7] = _streamId->uniqueID & 0xFF;
 
-	openavb_list_node_t node = openavbListNew(strElemList, sizeof(strElem_t));
-	strElem_t* elem = openavbListData(node);
+	strElem_t* elem = calloc(1, sizeof(strElem_t));
+	if (!elem) {
+		AVB_LOG_ERROR("Unable to allocate SRP stream element");
+		goto error;
+	}
 
 	elem->avtpHandle = avtpHandle;
 	elem->talker = true;
@@ -241,6 +265,18 @@ openavbRC openavbSrpRegisterStream(void* avtpHandle,
 	elem->latency = Latency;
 	elem->subtype = openavbSrp_LDSt_None;
 
+	SRP_LOCK();
+	strElem_t *oldElem = openavbHashRemove(strElemHash, streamId);
+	bool added = openavbHashPut(strElemHash, streamId, elem);
+	SRP_UNLOCK();
+	free(oldElem);
+	if (!added) {
+		AVB_LOG_ERROR("Unable to add SRP stream element");
+		free(elem);
+		elem = NULL;
+		goto error;
+	}
+
 	switch (SRClassIdx) {
 	case SR_CLASS_A:
 		elem->vlanId = domain_class_a_vid;
@@ -280,6 +316,13 @@ openavbRC openavbSrpRegisterStream(void* avtpHandle,
 	return OPENAVB_SRP_SUCCESS;
 
 error:
+	if (elem) {
+		SRP_LOCK();
+		if (openavbHashGet(strElemHash, streamId) == elem)
+			openavbHashRemove(strElemHash, streamId);
+		SRP_UNLOCK();
+		free(elem);
+	}
 	AVB_TRACE_EXIT(AVB_TRACE_SRP_PUBLIC);
 	return OPENAVB_SRP_FAILURE;
 }
@@ -294,20 +337,17 @@ openavbRC openavbSrpDeregisterStream(AVBStreamID_t* _streamId)
 	streamId[6] = _streamId->uniqueID >> 8;
 	streamId[7] = _streamId->uniqueID & 0xFF;
 
-	openavb_list_node_t node = openavbListIterFirst(strElemList);
-	while (node) {
-		strElem_t *elem = openavbListData(node);
-		if (elem && memcmp(streamId, elem->streamId, sizeof(elem->streamId)) == 0) {
-			int err = mrp_unadvertise_stream(elem->streamId, elem->destAddr, elem->vlanId, elem->maxFrameSize, elem->maxIntervalFrames, elem->priority, elem->latency);
-			if (err) {
-				AVB_LOG_ERROR("mrp_unadvertise_stream failed");
-			}
-			openavbListDelete(strElemList, node);
-			break;
+	SRP_LOCK();
+	strElem_t *elem = openavbHashRemove(strElemHash, streamId);
+	SRP_UNLOCK();
+	if (elem) {
+		int err = mrp_unadvertise_stream(elem->streamId, elem->destAddr, elem->vlanId, elem->maxFrameSize, elem->maxIntervalFrames, elem->priority, elem->latency);
+		if (err) {
+			AVB_LOG_ERROR("mrp_unadvertise_stream failed");
 		}
-		node = openavbListIterNext(strElemList);
+		free(elem);
 	}
-	if (!node)
+	else
 		AVB_LOGF_ERROR("%s: unknown stream "SID_FORMAT, __func__, SID_OCTETS(streamId));
 	AVB_TRACE_EXIT(AVB_TRACE_SRP_PUBLIC);
 	return OPENAVB_SRP_SUCCESS;
@@ -327,25 +367,26 @@ openavbRC openavbSrpAttachStream(void* avtpHandle,
 
 	AVB_LOGF_DEBUG("openavbSrpAttachStream "SID_FORMAT, SID_OCTETS(streamId));
 
-	openavb_list_node_t node = openavbListIterFirst(strElemList);
-	// lets check if this streamId is on our list
-	while (node) {
-		strElem_t *elem = openavbListData(node);
-		if (elem && memcmp(streamId, elem->streamId, sizeof(elem->streamId)) == 0) {
-			break;
-		}
-		node = openavbListIterNext(strElemList);
-	}
-	if (!node) {
+	// lets check if this streamId is in our table
+	SRP_LOCK();
+	if (!openavbHashGet(strElemHash, streamId)) {
 		// not found so add it
-		node = openavbListNew(strElemList, sizeof(strElem_t));
-		strElem_t* elem = openavbListData(node);
-
-		elem->avtpHandle = avtpHandle;
-		elem->talker = false;
-		memcpy(elem->streamId, streamId, sizeof(elem->streamId));
-		elem->subtype = type;
+		strElem_t* elem = calloc(1, sizeof(strElem_t));
+		if (elem) {
+			elem->avtpHandle = avtpHandle;
+			elem->talker = false;
+			memcpy(elem->streamId, streamId, sizeof(elem->streamId));
+			elem->subtype = type;
+			if (!openavbHashPut(strElemHash, streamId, elem)) {
+				free(elem);
+				elem = NULL;
+			}
+		}
+		if (!elem) {
+			AVB_LOG_ERROR("Unable to add SRP stream element");
+		}
 	}
+	SRP_UNLOCK();
 
 	int err = mrp_send_ready(streamId);
 	if (err) {
@@ -368,20 +409,17 @@ openavbRC openavbSrpDetachStream(AVBStreamID_t* _streamId)
 
 	AVB_LOGF_DEBUG("openavbSrpDetachStream "SID_FORMAT, SID_OCTETS(streamId));
 
-	openavb_list_node_t node = openavbListIterFirst(strElemList);
-	while (node) {
-		strElem_t *elem = openavbListData(node);
-		if (elem && memcmp(streamId, elem->streamId, sizeof(elem->streamId)) == 0) {
-			int err = mrp_send_leave(streamId);
-			if (err) {
-				AVB_LOG_ERROR("mrp_send_leave failed");
-			}
-			openavbListDelete(strElemList, node);
-			break;
+	SRP_LOCK();
+	strElem_t *elem = openavbHashRemove(strElemHash, streamId);
+	SRP_UNLOCK();
+	if (elem) {
+		int err = mrp_send_leave(streamId);
+		if (err) {
+			AVB_LOG_ERROR("mrp_send_leave failed");
 		}
-		node = openavbListIterNext(strElemList);
+		free(elem);
 	}
-	if (!node)
+	else
 		AVB_LOGF_ERROR("%s: unknown stream "SID_FORMAT, __func__, SID_OCTETS(streamId));
 
 	AVB_TRACE_EXIT(AVB_TRACE_SRP_PUBLIC);
@@ -32,26 +32,199 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #ifndef OPENAVB_ENDPOINT_SERVER_OSAL_C
 #define OPENAVB_ENDPOINT_SERVER_OSAL_C
 
+#include <sys/eventfd.h>
+
+#include "openavb_endpoint_frame_osal.c"
+
 #define AVB_ENDPOINT_LISTEN_FDS	0 // first fds, was last MAX_AVB_STREAMS
 #define SOCK_INVALID (-1)
-#define POLL_FD_COUNT ((MAX_AVB_STREAMS) + 1)
+#define POLL_FD_INITIAL_COUNT (x_cfg.maxStreams + 1)
+#define EPOLL_MAX_EVENTS 64
+#define EPOLL_WAKE_DATA ((U32)-1)
+
+// Each client connection buffers what it has read of a frame, and queues the replies and
+// SRP callbacks for it so all of those from one server wake go out as a single frame.
+// Client sockets don't block; what a client hasn't taken yet waits in tx until epoll
+// reports the socket writable.
+typedef struct {
+	frame_rx_t rx;						// Only used by the server thread
+	openavbEndpointMessage_t txMsgs[OPENAVB_ENDPOINT_FRAME_MAX_MSGS];
+	int txCount;
+	bool bTxQueued;						// On the txQueued stack
+	frame_tx_t tx;
+	bool bTxWait;						// Socket watched for writing
+} client_t;
 
+// The fds table holds the socket of each handle and doubles whenever it fills up.
+// Unused client entries are kept on a stack so a new connection doesn't search for one.
+// All sockets are in one epoll set, with the handle as the event data.
 static int lsock  = SOCK_INVALID;
-static struct pollfd fds[POLL_FD_COUNT];
+static int epfd = SOCK_INVALID;
+static int *fds = NULL;
+static int *fdsFree = NULL;
+static int fdsCount = 0;
+static int fdsFreeCount = 0;
 static struct sockaddr_un serverAddr;
 
+// SRP callbacks are queued from the SRP thread, so the client queues, the stack of handles
+// with queued messages and the fds table are changed with the mutex held. Messages queued
+// while the server waits for events wake it through the eventfd.
+static MUTEX_HANDLE_ALT(clientsMutex) = PTHREAD_MUTEX_INITIALIZER;
+static client_t **clients = NULL;
+static int *txQueued = NULL;
+static int txQueuedCount = 0;
+static bool bServing = FALSE;
+static int wakefd = SOCK_INVALID;
+
+static bool fdsGrow(int count)
+{
+	bool ret = FALSE;
+
+	MUTEX_LOCK_ALT(clientsMutex);
+	do {
+		int *newFds = realloc(fds, count * sizeof(int));
+		if (!newFds) {
+			break;
+		}
+		fds = newFds;
+
+		int *newFree = realloc(fdsFree, count * sizeof(int));
+		if (!newFree) {
+			break;
+		}
+		fdsFree = newFree;
+
+		client_t **newClients = realloc(clients, count * sizeof(client_t *));
+		if (!newClients) {
+			break;
+		}
+		clients = newClients;
+
+		int *newQueued = realloc(txQueued, count * sizeof(int));
+		if (!newQueued) {
+			break;
+		}
+		txQueued = newQueued;
+
+		// Push the new entries so the lowest is handed out first
+		int i;
+		for (i = count - 1; i >= fdsCount; i--) {
+			fds[i] = SOCK_INVALID;
+			clients[i] = NULL;
+			if (i != AVB_ENDPOINT_LISTEN_FDS) {
+				fdsFree[fdsFreeCount++] = i;
+			}
+		}
+		fdsCount = count;
+		ret = TRUE;
+	} while (0);
+	MUTEX_UNLOCK_ALT(clientsMutex);
+
+	return ret;
+}
+
+// Watch a client socket for writing only while there is something it hasn't taken.
+// Called with the mutex held.
+static void clientWatchTx(int h)
+{
+	client_t *pClient = clients[h];
+	bool bWait = pClient->tx.len != 0;
+
+	if (bWait != pClient->bTxWait) {
+		struct epoll_event ev;
+		memset(&ev, 0, sizeof(ev));
+		ev.events = bWait ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+		ev.data.u32 = h;
+		if (epoll_ctl(epfd, EPOLL_CTL_MOD, fds[h], &ev) < 0) {
+			AVB_LOGF_ERROR("Failed to change socket in epoll: %s", strerror(errno));
+		}
+		pClient->bTxWait = bWait;
+	}
+}
+
+// Send the messages queued for a client as one frame, after anything the client hasn't
+// taken yet. Called with the mutex held, so it never blocks. A failed send, or a client
+// that stops reading, shuts the socket down, and the server closes it when it reads the
+// end of the stream.
+static void clientFlush(int h)
+{
+	client_t *pClient = clients[h];
+
+	if (fds[h] != SOCK_INVALID) {
+		bool bOk = TRUE;
+		if (pClient->txCount) {
+			bOk = x_frameQueue(&pClient->tx, pClient->txMsgs, pClient->txCount);
+		}
+		if (bOk && pClient->tx.len) {
+			bOk = x_frameWrite(fds[h], &pClient->tx);
+		}
+		if (!bOk) {
+			shutdown(fds[h], SHUT_RDWR);
+			pClient->tx.len = 0;
+		}
+		clientWatchTx(h);
+	}
+	pClient->txCount = 0;
+}
+
+// Send what was queued for every client during this wake of the server.
+static void clientsFlushAll(void)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
+	int i;
+
+	MUTEX_LOCK_ALT(clientsMutex);
+	for (i = 0; i < txQueuedCount; i++) {
+		int h = txQueued[i];
+		clientFlush(h);
+		clients[h]->bTxQueued = FALSE;
+	}
+	txQueuedCount = 0;
+	bServing = FALSE;
+	MUTEX_UNLOCK_ALT(clientsMutex);
+
+	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+}
+
+static bool socketWatch(int h)
+{
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.u32 = h;
+	if (epoll_ctl(epfd, EPOLL_CTL_ADD, fds[h], &ev) < 0) {
+		AVB_LOGF_ERROR("Failed to add socket to epoll: %s", strerror(errno));
+		return FALSE;
+	}
+	return TRUE;
+}
+
 static void socketClose(int h)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
 
-	if (h < 0 || h >= POLL_FD_COUNT) {
+	if (h < 0 || h >= fdsCount) {
 		AVB_LOG_ERROR("Closing socket; invalid handle");
 	}
 	else {
 		openavbEptSrvrCloseClientConnection(h);
-		close(fds[h].fd);
-		fds[h].fd = SOCK_INVALID;
-		fds[h].events = 0;
+
+		MUTEX_LOCK_ALT(clientsMutex);
+		if (fds[h] != SOCK_INVALID) {
+			epoll_ctl(epfd, EPOLL_CTL_DEL, fds[h], NULL);
+			close(fds[h]);
+			if (h != AVB_ENDPOINT_LISTEN_FDS) {
+				fdsFree[fdsFreeCount++] = h;
+			}
+		}
+		fds[h] = SOCK_INVALID;
+		if (clients[h]) {
+			// Anything still queued is dropped with the connection
+			clients[h]->txCount = 0;
+			clients[h]->tx.len = 0;
+			clients[h]->bTxWait = FALSE;
+		}
+		MUTEX_UNLOCK_ALT(clientsMutex);
 	}
 	
 	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
@@ -61,40 +234,49 @@ static bool openavbEptSrvrSendToClient(int h, openavbEndpointMessage_t *msg)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
 
-	if (h < 0 || h >= POLL_FD_COUNT) {
-		AVB_LOG_ERROR("Sending message; invalid handle");
+	if (!msg) {
+		AVB_LOG_ERROR("Sending message; invalid argument passed");
 		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 		return FALSE;
 	}
-	if (!msg) {
-		AVB_LOG_ERROR("Sending message; invalid argument passed");
+
+	MUTEX_LOCK_ALT(clientsMutex);
+
+	if (h < 0 || h >= fdsCount) {
+		MUTEX_UNLOCK_ALT(clientsMutex);
+		AVB_LOG_ERROR("Sending message; invalid handle");
 		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 		return FALSE;
 	}
 
-	int csock = fds[h].fd;
-	if (csock == SOCK_INVALID) {
+	client_t *pClient = clients[h];
+	if (fds[h] == SOCK_INVALID || !pClient) {
+		MUTEX_UNLOCK_ALT(clientsMutex);
 		AVB_LOG_ERROR("Socket closed unexpectedly");
+		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 		return FALSE;
 	}
 
-	ssize_t nWrite = write(csock, msg, OPENAVB_ENDPOINT_MSG_LEN);
-	AVB_LOGF_VERBOSE("Sent message, len=%zu, nWrite=%zu", OPENAVB_ENDPOINT_MSG_LEN, nWrite);
-	if (nWrite < OPENAVB_ENDPOINT_MSG_LEN) {
-		if (nWrite < 0) {
-			AVB_LOGF_ERROR("Failed to write socket: %s", strerror(errno));
-		}
-		else if (nWrite == 0) {
-			AVB_LOG_ERROR("Socket closed unexpectedly");
-		}
-		else {
-			AVB_LOG_ERROR("Socket write too short");
+	// Replies and SRP callbacks are queued and sent together once the server is done with
+	// this wake, unless the frame is already full.
+	if (pClient->txCount == OPENAVB_ENDPOINT_FRAME_MAX_MSGS) {
+		clientFlush(h);
+	}
+	memcpy(&pClient->txMsgs[pClient->txCount++], msg, OPENAVB_ENDPOINT_MSG_LEN);
+
+	if (!pClient->bTxQueued) {
+		pClient->bTxQueued = TRUE;
+		txQueued[txQueuedCount++] = h;
+		if (!bServing) {
+			U64 one = 1;
+			if (write(wakefd, &one, sizeof(one)) < 0) {
+				AVB_LOGF_ERROR("Failed to wake the server: %s", strerror(errno));
+			}
 		}
-		socketClose(h);
-		AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
-		return FALSE;
 	}
 
+	MUTEX_UNLOCK_ALT(clientsMutex);
+
 	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 	return TRUE;
 }
@@ -102,14 +284,35 @@ static bool openavbEptSrvrSendToClient(int h, openavbEndpointMessage_t *msg)
 bool openavbEndpointServerOpen(void)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
-	int i;
 
-	for (i=0; i < POLL_FD_COUNT; i++) {
-		fds[i].fd = SOCK_INVALID;
-		fds[i].events = 0;
+	if (!fdsGrow(POLL_FD_INITIAL_COUNT)) {
+		AVB_LOG_ERROR("Failed to allocate poll table");
+		goto error;
 	}
 
-	lsock = socket(AF_UNIX, SOCK_STREAM, 0);
+	epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (epfd < 0) {
+		AVB_LOGF_ERROR("Failed to create epoll: %s", strerror(errno));
+		goto error;
+	}
+
+	wakefd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (wakefd < 0) {
+		AVB_LOGF_ERROR("Failed to create eventfd: %s", strerror(errno));
+		goto error;
+	}
+
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.u32 = EPOLL_WAKE_DATA;
+	if (epoll_ctl(epfd, EPOLL_CTL_ADD, wakefd, &ev) < 0) {
+		AVB_LOGF_ERROR("Failed to add eventfd to epoll: %s", strerror(errno));
+		goto error;
+	}
+
+	// Non-blocking, so each wake can accept every pending connection
+	lsock = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
 	if (lsock < 0) {
 		AVB_LOGF_ERROR("Failed to open socket: %s", strerror(errno));
 		goto error;
@@ -130,15 +333,18 @@ bool openavbEndpointServerOpen(void)
 		goto error;
 	}
 
-	rslt = listen(lsock, 5);
+	rslt = listen(lsock, SOMAXCONN);
 	if (rslt != 0) {
 		AVB_LOGF_ERROR("Failed to listen on socket: %s", strerror(errno));
 		goto error;
 	}
 	AVB_LOGF_DEBUG("Listening on socket: %s", serverAddr.sun_path);
 
-	fds[AVB_ENDPOINT_LISTEN_FDS].fd = lsock;
-	fds[AVB_ENDPOINT_LISTEN_FDS].events = POLLIN;
+	fds[AVB_ENDPOINT_LISTEN_FDS] = lsock;
+	if (!socketWatch(AVB_ENDPOINT_LISTEN_FDS)) {
+		fds[AVB_ENDPOINT_LISTEN_FDS] = SOCK_INVALID;
+		goto error;
+	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 	return TRUE;
@@ -148,93 +354,190 @@ bool openavbEndpointServerOpen(void)
 		close(lsock);
 		lsock = SOCK_INVALID;
 	}
+	if (wakefd >= 0) {
+		close(wakefd);
+		wakefd = SOCK_INVALID;
+	}
+	if (epfd >= 0) {
+		close(epfd);
+		epfd = SOCK_INVALID;
+	}
 	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 	return FALSE;
 }
- 
-void openavbEptSrvrService(void)
+
+// Accept every connection waiting on the listen socket.
+static void socketAcceptAll(void)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
 	struct sockaddr_un addrClient;
 	socklen_t lenAddr;
-	int i, j;
-	int  csock;
+	int j;
+	int csock;
+
+	while (1) {
+		lenAddr = sizeof(addrClient);
+		csock = accept4(lsock, (struct sockaddr*)&addrClient, &lenAddr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+		if (csock < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				AVB_LOGF_ERROR("Failed to accept connection: %s", strerror(errno));
+			}
+			break;
+		}
+
+		if (fdsFreeCount == 0) {
+			fdsGrow(fdsCount * 2);
+		}
+		if (fdsFreeCount > 0) {
+			j = fdsFree[--fdsFreeCount];
+
+			// Client entries are kept for the next connection on the handle
+			client_t *pClient = clients[j] ? clients[j] : calloc(1, sizeof(client_t));
+			if (!pClient) {
+				AVB_LOG_ERROR("Failed to allocate client");
+				close(csock);
+				fdsFree[fdsFreeCount++] = j;
+				continue;
+			}
+			pClient->rx.len = 0;
+
+			MUTEX_LOCK_ALT(clientsMutex);
+			pClient->txCount = 0;
+			pClient->tx.len = 0;
+			pClient->bTxWait = FALSE;
+			clients[j] = pClient;
+			fds[j] = csock;
+			MUTEX_UNLOCK_ALT(clientsMutex);
+
+			if (!socketWatch(j)) {
+				close(csock);
+				MUTEX_LOCK_ALT(clientsMutex);
+				fds[j] = SOCK_INVALID;
+				MUTEX_UNLOCK_ALT(clientsMutex);
+				fdsFree[fdsFreeCount++] = j;
+			}
+		}
+		else {
+			AVB_LOG_ERROR("Too many client connections");
+			close(csock);
+		}
+	}
 
-	int nfds = POLL_FD_COUNT;
+	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+}
+
+// Read what a client sent and handle every message of the whole frames in it.
+static void socketReceive(int h)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
+	openavbEndpointMessage_t msgBuf[OPENAVB_ENDPOINT_FRAME_MAX_MSGS];
+	int i;
+
+	// Stop if handling a message dropped the connection
+	while (fds[h] != SOCK_INVALID) {
+		int nMsgs = x_frameRead(fds[h], &clients[h]->rx, msgBuf);
+		AVB_LOGF_VERBOSE("Socket read h=%d,fd=%d: msgs=%d", h, fds[h], nMsgs);
+
+		if (nMsgs == FRAME_READ_NONE) {
+			// The rest of a partial frame comes with a later event
+			break;
+		}
+		if (nMsgs < 0) {
+			// sock closed
+			if (nMsgs == FRAME_READ_CLOSED) {
+				AVB_LOGF_DEBUG("Socket closed, h=%d", h);
+			}
+			else {
+				AVB_LOGF_ERROR("Socket read failed, h=%d", h);
+			}
+			socketClose(h);
+			break;
+		}
+
+		for (i = 0; i < nMsgs && fds[h] != SOCK_INVALID; i++) {
+			if (!openavbEptSrvrReceiveFromClient(h, &msgBuf[i])) {
+				AVB_LOG_ERROR("Failed to handle message");
+				socketClose(h);
+			}
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+}
+
+void openavbEptSrvrService(void)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
+	struct epoll_event events[EPOLL_MAX_EVENTS];
+	bool bAccept = FALSE;
+	int i, h;
 	int pRet;
 
 	AVB_LOG_VERBOSE("Waiting for event...");
-	pRet = poll(fds, nfds, 1000);
+	pRet = epoll_wait(epfd, events, EPOLL_MAX_EVENTS, 1000);
+
+	// From here SRP callbacks are sent with the replies by clientsFlushAll()
+	MUTEX_LOCK_ALT(clientsMutex);
+	bServing = TRUE;
+	MUTEX_UNLOCK_ALT(clientsMutex);
 
 	if (pRet == 0) {
-		AVB_LOG_VERBOSE("poll timeout");
+		AVB_LOG_VERBOSE("epoll timeout");
 	}
 	else if (pRet < 0) {
 		if (errno == EINTR) {
-			AVB_LOG_VERBOSE("Poll interrupted");
+			AVB_LOG_VERBOSE("epoll interrupted");
 		}
 		else {
-			AVB_LOGF_ERROR("Poll error: %s", strerror(errno));
+			AVB_LOGF_ERROR("epoll error: %s", strerror(errno));
 		}
 	}
 	else {
-		AVB_LOGF_VERBOSE("Poll returned %d events", pRet);
-		for (i=0; i<nfds; i++) {
-			if (fds[i].revents != 0) {
-				AVB_LOGF_VERBOSE("%d sock=%d, event=0x%x, revent=0x%x", i, fds[i].fd, fds[i].events, fds[i].revents);
-
-				if (i == AVB_ENDPOINT_LISTEN_FDS) {
-					// listen sock - indicates new connection from client
-					lenAddr = sizeof(addrClient);
-					csock = accept(lsock, (struct sockaddr*)&addrClient, &lenAddr);
-					if (csock < 0) {
-						AVB_LOGF_ERROR("Failed to accept connection: %s", strerror(errno));
-					}
-					else {
-						for (j = 0; j < POLL_FD_COUNT; j++) {
-							if (fds[j].fd == SOCK_INVALID) {
-								fds[j].fd = csock;
-								fds[j].events = POLLIN;
-								break;
-							}
-						}
-						if (j >= POLL_FD_COUNT) {
-							AVB_LOG_ERROR("Too many client connections");
-							close(csock);
-						}
-					}
+		AVB_LOGF_VERBOSE("epoll returned %d events", pRet);
+		for (i = 0; i < pRet; i++) {
+			if (events[i].data.u32 == EPOLL_WAKE_DATA) {
+				// SRP callbacks were queued, they are sent below
+				U64 count;
+				if (read(wakefd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+					AVB_LOGF_ERROR("Failed to read eventfd: %s", strerror(errno));
 				}
-				else {
-					csock = fds[i].fd;
-					openavbEndpointMessage_t  msgBuf;
-					memset(&msgBuf, 0, OPENAVB_ENDPOINT_MSG_LEN);
-					ssize_t nRead = read(csock, &msgBuf, OPENAVB_ENDPOINT_MSG_LEN);
-					AVB_LOGF_VERBOSE("Socket read h=%d,fd=%d: read=%zu, expect=%zu", i, csock, nRead, OPENAVB_ENDPOINT_MSG_LEN);
-					
-					if (nRead < OPENAVB_ENDPOINT_MSG_LEN) {
-						// sock closed
-						if (nRead == 0) {
-							AVB_LOGF_DEBUG("Socket closed, h=%d", i);
-						}
-						else if (nRead < 0) {
-							AVB_LOGF_ERROR("Socket read, h=%d: %s", i, strerror(errno));
-						}
-						else {
-							AVB_LOGF_ERROR("Short read, h=%d", i);
-						}
-						socketClose(i);
-					}
-					else {
-						// got a message
-						if (!openavbEptSrvrReceiveFromClient(i, &msgBuf)) {
-							AVB_LOG_ERROR("Failed to handle message");
-							socketClose(i);
-						}
+				continue;
+			}
+
+			h = events[i].data.u32;
+			AVB_LOGF_VERBOSE("%d sock=%d, event=0x%x", h, fds[h], events[i].events);
+
+			if (h == AVB_ENDPOINT_LISTEN_FDS) {
+				// listen sock - indicates new connection from client
+				bAccept = TRUE;
+			}
+			else {
+				if (events[i].events & EPOLLOUT) {
+					// Send the rest of what the client hasn't taken
+					MUTEX_LOCK_ALT(clientsMutex);
+					if (fds[h] != SOCK_INVALID) {
+						clientFlush(h);
 					}
+					MUTEX_UNLOCK_ALT(clientsMutex);
+				}
+				if ((events[i].events & ~EPOLLOUT) && fds[h] != SOCK_INVALID) {
+					socketReceive(h);
 				}
 			}
 		}
+
+		// Accept last, so a handle closed above isn't reused while
+		// events for its old socket are still in the list.
+		if (bAccept) {
+			socketAcceptAll();
+		}
 	}
+
+	clientsFlushAll();
+
 	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 }
 
@@ -242,20 +545,44 @@ void openavbEndpointServerClose(void)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
 	int i;
-	for (i = 0; i < POLL_FD_COUNT; i++) {
-		if (fds[i].fd != SOCK_INVALID) {
-			close(fds[i].fd);
-			fds[i].fd = SOCK_INVALID;
+	MUTEX_LOCK_ALT(clientsMutex);
+	for (i = 0; i < fdsCount; i++) {
+		if (fds[i] != SOCK_INVALID) {
+			close(fds[i]);
+			fds[i] = SOCK_INVALID;
 		}
 	}
-	if (lsock != SOCK_INVALID) {
-		close(lsock);
-		lsock = SOCK_INVALID;
+	if (wakefd != SOCK_INVALID) {
+		close(wakefd);
+		wakefd = SOCK_INVALID;
+	}
+	MUTEX_UNLOCK_ALT(clientsMutex);
+	lsock = SOCK_INVALID;
+	if (epfd != SOCK_INVALID) {
+		close(epfd);
+		epfd = SOCK_INVALID;
 	}
 
 	if (unlink(serverAddr.sun_path) != 0) {
 		AVB_LOGF_ERROR("Failed to unlink %s: %s", serverAddr.sun_path, strerror(errno));
 	}
+
+	MUTEX_LOCK_ALT(clientsMutex);
+	for (i = 0; i < fdsCount; i++) {
+		free(clients[i]);
+	}
+	free(fds);
+	free(fdsFree);
+	free(clients);
+	free(txQueued);
+	fds = NULL;
+	fdsFree = NULL;
+	clients = NULL;
+	txQueued = NULL;
+	fdsCount = 0;
+	fdsFreeCount = 0;
+	txQueuedCount = 0;
+	MUTEX_UNLOCK_ALT(clientsMutex);
 	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
 } 
 
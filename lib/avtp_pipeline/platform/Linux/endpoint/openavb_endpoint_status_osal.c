@@ -0,0 +1,164 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : POSIX shared memory for the endpoint stream status table.
+*
+* The endpoint keeps the object open with an exclusive flock() for as long as it runs.
+* Readers keep their descriptor open too, and the endpoint that created the table they
+* mapped is alive exactly while a shared lock on that descriptor would block. Unlike a
+* process id this can't be reused and works across PID namespaces.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <fcntl.h>
+
+#include "openavb_platform.h"
+#include "openavb_trace.h"
+#include "openavb_endpoint_status.h"
+
+#define	AVB_LOG_COMPONENT	"Endpoint Status"
+#include "openavb_log.h"
+
+// Descriptor of the table this process created, holding the owner lock
+static int x_writerFd = -1;
+// Descriptor of the table this process has mapped for reading
+static int x_readerFd = -1;
+
+void *openavbEptStatusMapOsal(bool bCreate, U32 *pSize)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
+	void *pMap;
+	int fd;
+
+	if (bCreate) {
+		// Start from a new object, so readers of one left behind keep their stale copy
+		// instead of seeing it change under them.
+		shm_unlink(OPENAVB_ENDPOINT_STATUS_NAME);
+		fd = shm_open(OPENAVB_ENDPOINT_STATUS_NAME, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+		if (fd < 0) {
+			AVB_LOGF_ERROR("Failed to create %s: %s", OPENAVB_ENDPOINT_STATUS_NAME, strerror(errno));
+			AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+			return NULL;
+		}
+		if (ftruncate(fd, *pSize) < 0) {
+			AVB_LOGF_ERROR("Failed to size %s: %s", OPENAVB_ENDPOINT_STATUS_NAME, strerror(errno));
+			close(fd);
+			shm_unlink(OPENAVB_ENDPOINT_STATUS_NAME);
+			AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+			return NULL;
+		}
+		if (flock(fd, LOCK_EX | LOCK_NB) < 0) {
+			AVB_LOGF_ERROR("Failed to lock %s: %s", OPENAVB_ENDPOINT_STATUS_NAME, strerror(errno));
+			close(fd);
+			shm_unlink(OPENAVB_ENDPOINT_STATUS_NAME);
+			AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+			return NULL;
+		}
+		pMap = mmap(NULL, *pSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	}
+	else {
+		struct stat st;
+		fd = shm_open(OPENAVB_ENDPOINT_STATUS_NAME, O_RDONLY | O_CLOEXEC, 0);
+		if (fd < 0) {
+			// No endpoint running, or one without the table
+			AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+			return NULL;
+		}
+		if (fstat(fd, &st) < 0 || st.st_size <= 0 || st.st_size > 0xFFFFFFFF) {
+			close(fd);
+			AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+			return NULL;
+		}
+		*pSize = st.st_size;
+		pMap = mmap(NULL, *pSize, PROT_READ, MAP_SHARED, fd, 0);
+	}
+
+	if (pMap == MAP_FAILED) {
+		AVB_LOGF_ERROR("Failed to map %s: %s", OPENAVB_ENDPOINT_STATUS_NAME, strerror(errno));
+		close(fd);
+		if (bCreate) {
+			shm_unlink(OPENAVB_ENDPOINT_STATUS_NAME);
+		}
+		AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+		return NULL;
+	}
+
+	// Keep the descriptor for the owner lock
+	if (bCreate) {
+		x_writerFd = fd;
+	}
+	else {
+		x_readerFd = fd;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+	return pMap;
+}
+
+void openavbEptStatusUnmapOsal(void *pMap, U32 size, bool bRemove)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_ENDPOINT);
+
+	if (pMap) {
+		munmap(pMap, size);
+	}
+	if (bRemove && shm_unlink(OPENAVB_ENDPOINT_STATUS_NAME) < 0) {
+		AVB_LOGF_ERROR("Failed to remove %s: %s", OPENAVB_ENDPOINT_STATUS_NAME, strerror(errno));
+	}
+
+	// Closing the writer descriptor drops the owner lock
+	int *pFd = bRemove ? &x_writerFd : &x_readerFd;
+	if (*pFd >= 0) {
+		close(*pFd);
+		*pFd = -1;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_ENDPOINT);
+}
+
+bool openavbEptStatusOwnerAliveOsal(void)
+{
+	if (x_readerFd < 0) {
+		return FALSE;
+	}
+
+	// The lock is only granted once the owner has closed the table or exited
+	if (flock(x_readerFd, LOCK_SH | LOCK_NB) == 0) {
+		flock(x_readerFd, LOCK_UN);
+		return FALSE;
+	}
+	return errno == EWOULDBLOCK;
+}
@@ -99,7 +99,7 @@ GstFlowReturn gst_al_push_buffer(GstAppSrc *src, GstAlBuf *buf);
  */
 GstAlBuf* gst_al_alloc_buffer(gint len);
 /**
- * \brief - unrefs a buffer
+ * \brief - unrefs a buffer taken from a sink
  *
  * \param buf - a buffer to unref
  */
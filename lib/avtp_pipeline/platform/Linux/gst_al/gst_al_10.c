@@ -43,7 +43,6 @@ void gst_al_set_callback(GstAppSinkCallbacks *cbfns, GstAlCallback callback)
 GstAlBuf* gst_al_pull_buffer(GstAppSink *sink)
 {
 	GstAlBuf *buf = g_new0(GstAlBuf,1);
-	GstMemory *memory;
 	GstBuffer * buffer;
 	GstSample *sample = gst_app_sink_pull_sample(sink);
 	buf->m_sample = sample;
@@ -53,18 +52,14 @@ GstAlBuf* gst_al_pull_buffer(GstAppSink *sink)
 		buf->m_buffer = buffer;
 		if(buffer)
 		{
-			memory = gst_buffer_get_memory(buffer, 0);
-			buf->m_memory = memory;
-			if(memory)
+			// Map the whole buffer: a parser that outputs whole access units may
+			// hand them over in several memory blocks, one per NAL unit.
+			GstMapInfo *info = &buf->m_info;
+			if(gst_buffer_map(buffer, info, GST_MAP_READ))
 			{
-				GstMapInfo *info = &buf->m_info;
-				if(gst_memory_map(memory, info, GST_MAP_READ))
-				{
-					buf->m_dptr = info->data;
-					buf->m_dlen = info->size;
-					goto pull_success;
-				}
-				gst_memory_unref(memory);
+				buf->m_dptr = info->data;
+				buf->m_dlen = info->size;
+				goto pull_success;
 			}
 		}
 		gst_sample_unref(sample);
@@ -115,8 +110,7 @@ GstFlowReturn gst_al_push_buffer(GstAppSrc *src, GstAlBuf *buf)
 
 void gst_al_buffer_unref(GstAlBuf *buf)
 {
-	gst_memory_unmap(buf->m_memory, &buf->m_info);
-	gst_memory_unref(buf->m_memory);
+	gst_buffer_unmap(buf->m_buffer, &buf->m_info);
 	gst_sample_unref(buf->m_sample);
 	g_free(buf);
 }
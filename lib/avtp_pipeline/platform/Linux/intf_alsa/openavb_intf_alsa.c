@@ -36,6 +36,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include "openavb_platform_pub.h"
 #include "openavb_types_pub.h"
 #include "openavb_audio_pub.h"
 #include "openavb_trace_pub.h"
@@ -44,6 +45,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_map_aaf_audio_pub.h"
 #include "openavb_intf_pub.h"
 #include "openavb_mcs.h"
+#include "openavb_intf_alsa_asrc.h"
 
 #define	AVB_LOG_COMPONENT	"ALSA Interface"
 #include "openavb_log_pub.h"
@@ -53,6 +55,13 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 #define PCM_DEVICE_NAME_DEFAULT	"default"
 #define PCM_ACCESS_TYPE			SND_PCM_ACCESS_RW_INTERLEAVED
+#define PCM_ACCESS_TYPE_MMAP	SND_PCM_ACCESS_MMAP_INTERLEAVED
+
+// Longest time the listener waits for room in the ALSA ring in mmap mode.
+#define PCM_MMAP_WAIT_MSEC		100
+
+// Default limit of the listener resampler ratio adjustment
+#define ASRC_MAX_PPM_DEFAULT	1000
 
 typedef struct {
 	/////////////
@@ -86,12 +95,38 @@ typedef struct {
 
 	U32 periodTimeUsec;
 
+	// intf_nv_access_mode: Transfer samples through the mapped ALSA ring instead of snd_pcm_readi/writei
+	bool useMmap;
+
+	// intf_nv_asrc: Resample on the listener to follow the talker media clock
+	bool asrcEnabled;
+
+	// intf_nv_asrc_max_ppm: Limit of the resampler ratio adjustment
+	U32 asrcMaxPpm;
+
 	/////////////
 	// Variable data
 	/////////////
 	// Handle for the PCM device
 	snd_pcm_t *pcmHandle;
 
+	// Ring and period size in frames as granted by the device
+	snd_pcm_uframes_t bufferFrames;
+	snd_pcm_uframes_t periodFrames;
+
+	// Playback start threshold in frames
+	snd_pcm_uframes_t startThresholdFrames;
+
+	// Number of overruns (talker) or underruns (listener)
+	U32 xruns;
+
+	// Listener resampler, its output buffer and the playout latency it holds
+	openavb_asrc_t *pAsrc;
+	U8 *pAsrcBuf;
+	bool asrcTargetValid;
+	double asrcTargetSec;
+	U64 asrcLastNS;
+
 	// ALSA stream
 	snd_pcm_stream_t pcmStream;
 
@@ -227,6 +262,238 @@ static snd_pcm_format_t x_AVBAudioFormatToAlsaFormat(avb_audio_type_t type,
 }
 
 
+// Select mmap access if configured. Falls back to read/write access if the device does not support it.
+static int x_setAccess(pvt_data_t *pPvtData, snd_pcm_hw_params_t *hwParams)
+{
+	if (pPvtData->useMmap) {
+		int rslt = snd_pcm_hw_params_set_access(pPvtData->pcmHandle, hwParams, PCM_ACCESS_TYPE_MMAP);
+		if (rslt == 0) {
+			return 0;
+		}
+		AVB_LOGF_WARNING("mmap access not supported: %s. Using read/write access.", snd_strerror(rslt));
+		pPvtData->useMmap = FALSE;
+	}
+	return snd_pcm_hw_params_set_access(pPvtData->pcmHandle, hwParams, PCM_ACCESS_TYPE);
+}
+
+// Copy frames between a buffer and the mapped ALSA ring. The caller must have called
+// snd_pcm_avail_update() and must not ask for more than it returned.
+static snd_pcm_sframes_t x_mmapTransfer(pvt_data_t *pPvtData, U8 *pData, snd_pcm_uframes_t frames, U32 frameBytes, bool capture)
+{
+	snd_pcm_uframes_t done = 0;
+
+	while (done < frames) {
+		const snd_pcm_channel_area_t *areas;
+		snd_pcm_uframes_t offset;
+		snd_pcm_uframes_t chunk = frames - done;
+
+		int rslt = snd_pcm_mmap_begin(pPvtData->pcmHandle, &areas, &offset, &chunk);
+		if (rslt < 0) {
+			return rslt;
+		}
+		if (chunk == 0) {
+			break;
+		}
+
+		// Interleaved access: all channels share the first area.
+		U8 *pRing = (U8 *)areas[0].addr + (areas[0].first / 8) + offset * (areas[0].step / 8);
+		if (capture) {
+			memcpy(pData + done * frameBytes, pRing, chunk * frameBytes);
+		}
+		else {
+			memcpy(pRing, pData + done * frameBytes, chunk * frameBytes);
+		}
+
+		snd_pcm_sframes_t committed = snd_pcm_mmap_commit(pPvtData->pcmHandle, offset, chunk);
+		if (committed < 0) {
+			return committed;
+		}
+		done += committed;
+		if ((snd_pcm_uframes_t)committed != chunk) {
+			break;
+		}
+	}
+
+	return done;
+}
+
+// Read up to frames captured frames from the mapped ALSA ring.
+static snd_pcm_sframes_t x_mmapCapture(pvt_data_t *pPvtData, U8 *pData, snd_pcm_uframes_t frames, U32 frameBytes)
+{
+	snd_pcm_sframes_t avail = snd_pcm_avail_update(pPvtData->pcmHandle);
+	if (avail < 0) {
+		return avail;
+	}
+
+	// Only touch the ring once a full period is ready or the item can be completed.
+	if ((snd_pcm_uframes_t)avail < frames && (snd_pcm_uframes_t)avail < pPvtData->periodFrames) {
+		return -EAGAIN;
+	}
+	if ((snd_pcm_uframes_t)avail < frames) {
+		frames = avail;
+	}
+
+	return x_mmapTransfer(pPvtData, pData, frames, frameBytes, TRUE);
+}
+
+// Write frames for playback. Waits for room in the ring like a blocking snd_pcm_writei().
+static snd_pcm_sframes_t x_playbackWrite(pvt_data_t *pPvtData, U8 *pData, snd_pcm_uframes_t frames, U32 frameBytes)
+{
+	if (!pPvtData->useMmap) {
+		return snd_pcm_writei(pPvtData->pcmHandle, pData, frames);
+	}
+
+	snd_pcm_uframes_t done = 0;
+	while (done < frames) {
+		snd_pcm_sframes_t avail = snd_pcm_avail_update(pPvtData->pcmHandle);
+		if (avail < 0) {
+			return avail;
+		}
+
+		if (avail == 0) {
+			// A ring that fills up before reaching the start threshold still needs to be started.
+			if (snd_pcm_state(pPvtData->pcmHandle) == SND_PCM_STATE_PREPARED) {
+				snd_pcm_start(pPvtData->pcmHandle);
+			}
+			int rslt = snd_pcm_wait(pPvtData->pcmHandle, PCM_MMAP_WAIT_MSEC);
+			if (rslt < 0) {
+				return rslt;
+			}
+			if (rslt == 0) {
+				break;		// Timeout
+			}
+			continue;
+		}
+
+		if ((snd_pcm_uframes_t)avail > frames - done) {
+			avail = frames - done;
+		}
+		snd_pcm_sframes_t written = x_mmapTransfer(pPvtData, pData + done * frameBytes, avail, frameBytes, FALSE);
+		if (written < 0) {
+			return written;
+		}
+		done += written;
+
+		// snd_pcm_mmap_commit() does not apply the start threshold.
+		if (snd_pcm_state(pPvtData->pcmHandle) == SND_PCM_STATE_PREPARED) {
+			snd_pcm_sframes_t room = snd_pcm_avail_update(pPvtData->pcmHandle);
+			if (room >= 0 && pPvtData->bufferFrames - room >= pPvtData->startThresholdFrames) {
+				snd_pcm_start(pPvtData->pcmHandle);
+			}
+		}
+	}
+
+	return done;
+}
+
+// Sample encoding for the listener resampler. Returns FALSE for formats it cannot convert.
+static bool x_asrcSample(snd_pcm_format_t fmt, openavb_asrc_sample_t *pSample, bool *pBigEndian)
+{
+	switch (fmt) {
+		case SND_PCM_FORMAT_S16_LE:
+		case SND_PCM_FORMAT_S16_BE:
+			*pSample = ASRC_SAMPLE_S16;
+			*pBigEndian = (fmt == SND_PCM_FORMAT_S16_BE);
+			return TRUE;
+		case SND_PCM_FORMAT_S24_3LE:
+		case SND_PCM_FORMAT_S24_3BE:
+			*pSample = ASRC_SAMPLE_S24_3;
+			*pBigEndian = (fmt == SND_PCM_FORMAT_S24_3BE);
+			return TRUE;
+		case SND_PCM_FORMAT_S24_LE:
+		case SND_PCM_FORMAT_S24_BE:
+			*pSample = ASRC_SAMPLE_S24_4;
+			*pBigEndian = (fmt == SND_PCM_FORMAT_S24_BE);
+			return TRUE;
+		case SND_PCM_FORMAT_S32_LE:
+		case SND_PCM_FORMAT_S32_BE:
+			*pSample = ASRC_SAMPLE_S32;
+			*pBigEndian = (fmt == SND_PCM_FORMAT_S32_BE);
+			return TRUE;
+		case SND_PCM_FORMAT_FLOAT_LE:
+		case SND_PCM_FORMAT_FLOAT_BE:
+			*pSample = ASRC_SAMPLE_FLOAT;
+			*pBigEndian = (fmt == SND_PCM_FORMAT_FLOAT_BE);
+			return TRUE;
+		default:
+			return FALSE;
+	}
+}
+
+static void x_asrcStart(media_q_t *pMediaQ, pvt_data_t *pPvtData, snd_pcm_format_t fmt)
+{
+	media_q_pub_map_uncmp_audio_info_t *pPubMapUncmpAudioInfo = pMediaQ->pPubMapInfo;
+	openavb_asrc_sample_t sample;
+	bool bigEndian;
+
+	if (!x_asrcSample(fmt, &sample, &bigEndian)) {
+		AVB_LOG_WARNING("Sample format not supported by the resampler. Resampling disabled.");
+		return;
+	}
+
+	pPvtData->pAsrc = openavbAsrcCreate(pPvtData->audioChannels, sample, bigEndian,
+		pPubMapUncmpAudioInfo->framesPerItem, pPvtData->asrcMaxPpm);
+	if (pPvtData->pAsrc) {
+		pPvtData->pAsrcBuf = malloc(openavbAsrcMaxOutFrames(pPvtData->pAsrc) * pPubMapUncmpAudioInfo->itemFrameSizeBytes);
+	}
+	if (!pPvtData->pAsrc || !pPvtData->pAsrcBuf) {
+		AVB_LOG_ERROR("Unable to allocate the resampler. Resampling disabled.");
+		openavbAsrcDelete(pPvtData->pAsrc);
+		pPvtData->pAsrc = NULL;
+		return;
+	}
+
+	pPvtData->asrcTargetValid = FALSE;
+	AVB_LOGF_INFO("Adaptive resampling enabled: %s, max %u ppm", openavbAsrcIsaName(), pPvtData->asrcMaxPpm);
+}
+
+static void x_asrcStop(pvt_data_t *pPvtData)
+{
+	if (pPvtData->pAsrc) {
+		AVB_LOGF_INFO("Resampler adjustment at end: %.2f ppm", openavbAsrcGetPpm(pPvtData->pAsrc));
+		openavbAsrcDelete(pPvtData->pAsrc);
+		pPvtData->pAsrc = NULL;
+	}
+	free(pPvtData->pAsrcBuf);
+	pPvtData->pAsrcBuf = NULL;
+}
+
+// Measure the playout latency of the item about to be written and steer the resampler
+// to hold the latency seen when playback started. With valid AVTP timestamps the latency
+// is measured against the presentation time, otherwise against the queued audio alone.
+static void x_asrcControl(pvt_data_t *pPvtData, media_q_item_t *pMediaQItem)
+{
+	snd_pcm_sframes_t delay;
+	U64 nowNS;
+
+	if (snd_pcm_state(pPvtData->pcmHandle) != SND_PCM_STATE_RUNNING
+		|| snd_pcm_delay(pPvtData->pcmHandle, &delay) < 0) {
+		return;
+	}
+	CLOCK_GETTIME64(OPENAVB_CLOCK_WALLTIME, &nowNS);
+
+	double queuedSec = (delay + openavbAsrcBufferedFrames(pPvtData->pAsrc)) / pPvtData->audioRate;
+	double latencySec = queuedSec;
+	if (!pPvtData->ignoreTimestamp && openavbAvtpTimeTimestampIsValid(pMediaQItem->pAvtpTime)) {
+		S64 lateNS = (S64)(nowNS - openavbAvtpTimeGetAvtpTimeNS(pMediaQItem->pAvtpTime));
+		latencySec += lateNS / (double)NANOSECONDS_PER_SECOND;
+	}
+
+	if (!pPvtData->asrcTargetValid) {
+		pPvtData->asrcTargetSec = latencySec;
+		pPvtData->asrcTargetValid = TRUE;
+		pPvtData->asrcLastNS = nowNS;
+		return;
+	}
+
+	openavbAsrcControl(pPvtData->pAsrc, latencySec - pPvtData->asrcTargetSec,
+		(nowNS - pPvtData->asrcLastNS) / (double)NANOSECONDS_PER_SECOND);
+	pPvtData->asrcLastNS = nowNS;
+
+	IF_LOG_INTERVAL(10000) AVB_LOGF_DEBUG("Resampler latency error: %.3f ms adjustment: %.2f ppm",
+		(latencySec - pPvtData->asrcTargetSec) * 1000.0, openavbAsrcGetPpm(pPvtData->pAsrc));
+}
+
 // Each configuration name value pair for this mapping will result in this callback being called.
 void openavbIntfAlsaCfgCB(media_q_t *pMediaQ, const char *name, const char *value)
 {
@@ -395,6 +662,32 @@ void openavbIntfAlsaCfgCB(media_q_t *pMediaQ, const char *name, const char *valu
 			pPvtData->clockSkewPPB = strtol(value, &pEnd, 10);
 		}
 
+		else if (strcmp(name, "intf_nv_access_mode") == 0) {
+			if (strcasecmp(value, "mmap") == 0)
+				pPvtData->useMmap = TRUE;
+			else if (strcasecmp(value, "rw") == 0)
+				pPvtData->useMmap = FALSE;
+			else
+				AVB_LOG_ERROR("Invalid access mode configured for intf_nv_access_mode.");
+		}
+
+		else if (strcmp(name, "intf_nv_asrc") == 0) {
+			tmp = strtol(value, &pEnd, 10);
+			if (*pEnd == '\0') {
+				pPvtData->asrcEnabled = (tmp == 1);
+			}
+		}
+
+		else if (strcmp(name, "intf_nv_asrc_max_ppm") == 0) {
+			tmp = strtol(value, &pEnd, 10);
+			if (*pEnd == '\0' && tmp > 0 && tmp <= 10000) {
+				pPvtData->asrcMaxPpm = tmp;
+			}
+			else {
+				AVB_LOG_ERROR("Invalid value configured for intf_nv_asrc_max_ppm.");
+			}
+		}
+
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_INTF);
@@ -467,7 +760,7 @@ void openavbIntfAlsaTxInitCB(media_q_t *pMediaQ)
 		}
 
 		// Set the access type
-		rslt = snd_pcm_hw_params_set_access(pPvtData->pcmHandle, hwParams, PCM_ACCESS_TYPE);
+		rslt = x_setAccess(pPvtData, hwParams);
 		if (rslt < 0) {
 			AVB_LOGF_ERROR("snd_pcm_hw_params_set_access() error: %s", snd_strerror(rslt));
 			snd_pcm_close(pPvtData->pcmHandle);
@@ -538,6 +831,16 @@ void openavbIntfAlsaTxInitCB(media_q_t *pMediaQ)
 		snd_pcm_hw_params_free(hwParams);
 		hwParams = NULL;
 
+		rslt = snd_pcm_get_params(pPvtData->pcmHandle, &pPvtData->bufferFrames, &pPvtData->periodFrames);
+		if (rslt < 0) {
+			AVB_LOGF_ERROR("snd_pcm_get_params() error: %s", snd_strerror(rslt));
+			snd_pcm_close(pPvtData->pcmHandle);
+			pPvtData->pcmHandle = NULL;
+			AVB_TRACE_EXIT(AVB_TRACE_INTF);
+			return;
+		}
+		pPvtData->xruns = 0;
+
 		// Get ready for playback
 		rslt = snd_pcm_prepare(pPvtData->pcmHandle);
 		if (rslt < 0) {
@@ -597,16 +900,27 @@ bool openavbIntfAlsaTxCB(media_q_t *pMediaQ)
 					return FALSE;
 				}
 
-				rslt = snd_pcm_readi(pPvtData->pcmHandle, pMediaQItem->pPubData + pMediaQItem->dataLen, pPubMapUncmpAudioInfo->framesPerItem - (pMediaQItem->dataLen / pPubMapUncmpAudioInfo->itemFrameSizeBytes));
+				snd_pcm_uframes_t frames = pPubMapUncmpAudioInfo->framesPerItem - (pMediaQItem->dataLen / pPubMapUncmpAudioInfo->itemFrameSizeBytes);
+				if (pPvtData->useMmap) {
+					rslt = x_mmapCapture(pPvtData, pMediaQItem->pPubData + pMediaQItem->dataLen, frames, pPubMapUncmpAudioInfo->itemFrameSizeBytes);
+				}
+				else {
+					rslt = snd_pcm_readi(pPvtData->pcmHandle, pMediaQItem->pPubData + pMediaQItem->dataLen, frames);
+				}
 
 				if (rslt < 0) {
 					switch(rslt) {
 					case -EPIPE:
-						AVB_LOGF_ERROR("snd_pcm_readi() error: %s", snd_strerror(rslt));
+						pPvtData->xruns++;
+						IF_LOG_INTERVAL(100) AVB_LOGF_ERROR("ALSA capture overrun: %s, total:%u", snd_strerror(rslt), pPvtData->xruns);
 						rslt = snd_pcm_recover(pPvtData->pcmHandle, rslt, 0);
 						if (rslt < 0) {
 							AVB_LOGF_ERROR("snd_pcm_recover: %s", snd_strerror(rslt));
 						}
+						else if (pPvtData->useMmap) {
+							// Capture is only started implicitly by snd_pcm_readi
+							snd_pcm_start(pPvtData->pcmHandle);
+						}
 						break;
 					case -EAGAIN:
 						{ IF_LOG_INTERVAL(1000) AVB_LOG_DEBUG("snd_pcm_readi() had no data available"); }
@@ -710,7 +1024,7 @@ void openavbIntfAlsaRxInitCB(media_q_t *pMediaQ)
 		}
 
 		// Set the access type
-		rslt = snd_pcm_hw_params_set_access(pPvtData->pcmHandle, hwParams, PCM_ACCESS_TYPE);
+		rslt = x_setAccess(pPvtData, hwParams);
 		if (rslt < 0) {
 			AVB_LOGF_ERROR("snd_pcm_hw_params_set_access() error: %s", snd_strerror(rslt));
 			snd_pcm_close(pPvtData->pcmHandle);
@@ -869,6 +1183,16 @@ void openavbIntfAlsaRxInitCB(media_q_t *pMediaQ)
 		snd_pcm_hw_params_free(hwParams);
 		hwParams = NULL;
 
+		rslt = snd_pcm_get_params(pPvtData->pcmHandle, &pPvtData->bufferFrames, &pPvtData->periodFrames);
+		if (rslt < 0) {
+			AVB_LOGF_ERROR("snd_pcm_get_params() error: %s", snd_strerror(rslt));
+			snd_pcm_close(pPvtData->pcmHandle);
+			pPvtData->pcmHandle = NULL;
+			AVB_TRACE_EXIT(AVB_TRACE_INTF);
+			return;
+		}
+		pPvtData->xruns = 0;
+
 
 		// Set software parameters
 
@@ -895,7 +1219,8 @@ void openavbIntfAlsaRxInitCB(media_q_t *pMediaQ)
 			return;
 		}
 
-		rslt = snd_pcm_sw_params_set_start_threshold(pPvtData->pcmHandle, swParams, period_size * pPvtData->startThresholdPeriods);
+		pPvtData->startThresholdFrames = period_size * pPvtData->startThresholdPeriods;
+		rslt = snd_pcm_sw_params_set_start_threshold(pPvtData->pcmHandle, swParams, pPvtData->startThresholdFrames);
 		if (rslt < 0) {
 			AVB_LOGF_ERROR("snd_pcm_sw_params_set_start_threshold error(): %s", snd_strerror(rslt));
 			snd_pcm_close(pPvtData->pcmHandle);
@@ -954,6 +1279,10 @@ void openavbIntfAlsaRxInitCB(media_q_t *pMediaQ)
 			return;
 		}
 
+		if (pPvtData->asrcEnabled) {
+			x_asrcStart(pMediaQ, pPvtData, fmt);
+		}
+
 		// Dump settings
 		snd_output_t* out;
 		snd_output_stdio_attach(&out, stderr, 0);
@@ -985,18 +1314,37 @@ bool openavbIntfAlsaRxCB(media_q_t *pMediaQ)
 			if (pMediaQItem) {
 				if (pMediaQItem->dataLen) {
 					S32 rslt;
+					U8 *pData = pMediaQItem->pPubData;
+					U32 frames = pPubMapUncmpAudioInfo->framesPerItem;
+
+					if (pPvtData->pAsrc) {
+						x_asrcControl(pPvtData, pMediaQItem);
+						frames = openavbAsrcProcess(pPvtData->pAsrc, pData, frames, pPvtData->pAsrcBuf);
+						pData = pPvtData->pAsrcBuf;
+					}
 
-					rslt = snd_pcm_writei(pPvtData->pcmHandle, pMediaQItem->pPubData, pPubMapUncmpAudioInfo->framesPerItem);
+					rslt = x_playbackWrite(pPvtData, pData, frames, pPubMapUncmpAudioInfo->itemFrameSizeBytes);
 					if (rslt < 0) {
-						AVB_LOGF_ERROR("snd_pcm_writei: %s", snd_strerror(rslt));
+						if (rslt == -EPIPE) {
+							pPvtData->xruns++;
+							IF_LOG_INTERVAL(100) AVB_LOGF_ERROR("ALSA playback underrun: %s, total:%u", snd_strerror(rslt), pPvtData->xruns);
+						}
+						else {
+							AVB_LOGF_ERROR("ALSA playback error: %s", snd_strerror(rslt));
+						}
 						rslt = snd_pcm_recover(pPvtData->pcmHandle, rslt, 0);
 						if (rslt < 0) {
 							AVB_LOGF_ERROR("snd_pcm_recover: %s", snd_strerror(rslt));
 						}
-						rslt = snd_pcm_writei(pPvtData->pcmHandle, pMediaQItem->pPubData, pPubMapUncmpAudioInfo->framesPerItem);
+						if (pPvtData->pAsrc) {
+							// Latency restarts from the start threshold after recovery.
+							openavbAsrcResync(pPvtData->pAsrc);
+							pPvtData->asrcTargetValid = FALSE;
+						}
+						rslt = x_playbackWrite(pPvtData, pData, frames, pPubMapUncmpAudioInfo->itemFrameSizeBytes);
 					}
-					if (rslt != pPubMapUncmpAudioInfo->framesPerItem) {
-						AVB_LOGF_WARNING("Not all pcm data consumed written:%u  consumed:%u", pMediaQItem->dataLen, rslt * pPubMapUncmpAudioInfo->audioChannels);
+					if (rslt != frames) {
+						AVB_LOGF_WARNING("Not all pcm data consumed written:%u  consumed:%u", frames * pPubMapUncmpAudioInfo->audioChannels, rslt * pPubMapUncmpAudioInfo->audioChannels);
 					}
 
 					// DEBUG
@@ -1032,8 +1380,12 @@ void openavbIntfAlsaEndCB(media_q_t *pMediaQ)
 		}
 
 		if (pPvtData->pcmHandle) {
+			if (pPvtData->xruns) {
+				AVB_LOGF_WARNING("ALSA xruns: %u", pPvtData->xruns);
+			}
 			snd_pcm_close(pPvtData->pcmHandle);
 			pPvtData->pcmHandle = NULL;
+			x_asrcStop(pPvtData);
 
 #if 0
 			// Optional call when using Valgrind to stop reports of memory leaks.
@@ -1051,6 +1403,14 @@ void openavbIntfAlsaGenEndCB(media_q_t *pMediaQ)
 	AVB_TRACE_EXIT(AVB_TRACE_INTF);
 }
 
+U32 openavbIntfAlsaGetXruns(media_q_t *pMediaQ)
+{
+	if (pMediaQ && pMediaQ->pPvtIntfInfo) {
+		return ((pvt_data_t *)pMediaQ->pPvtIntfInfo)->xruns;
+	}
+	return 0;
+}
+
 void openavbIntfAlsaEnableFixedTimestamp(media_q_t *pMediaQ, bool enabled, U32 transmitInterval, U32 batchFactor)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
@@ -1108,6 +1468,7 @@ extern DLL_EXPORT bool openavbIntfAlsaInitialize(media_q_t *pMediaQ, openavb_int
 		pIntfCB->intf_end_cb = openavbIntfAlsaEndCB;
 		pIntfCB->intf_gen_end_cb = openavbIntfAlsaGenEndCB;
 		pIntfCB->intf_enable_fixed_timestamp = openavbIntfAlsaEnableFixedTimestamp;
+		pIntfCB->intf_get_xruns_cb = openavbIntfAlsaGetXruns;
 
 		pPvtData->ignoreTimestamp = FALSE;
 		pPvtData->pDeviceName = strdup(PCM_DEVICE_NAME_DEFAULT);
@@ -1115,6 +1476,9 @@ extern DLL_EXPORT bool openavbIntfAlsaInitialize(media_q_t *pMediaQ, openavb_int
 		pPvtData->intervalCounter = 0;
 		pPvtData->startThresholdPeriods = 2;	// Default to 2 periods of frames as the start threshold
 		pPvtData->periodTimeUsec = 100000;
+		pPvtData->useMmap = FALSE;
+		pPvtData->asrcEnabled = FALSE;
+		pPvtData->asrcMaxPpm = ASRC_MAX_PPM_DEFAULT;
 
 		pPvtData->fixedTimestampEnabled = FALSE;
 		pPvtData->clockSkewPPB = 0;
@@ -0,0 +1,620 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+ * MODULE SUMMARY : Adaptive sample rate converter for the ALSA interface module.
+ *
+ * Each output frame is a dot product of ASRC_TAPS history samples per channel
+ * with a windowed sinc kernel. The kernel for the fractional read position is
+ * interpolated linearly between the two nearest of ASRC_PHASES precomputed
+ * rows. History is kept planar so the vector kernels load taps contiguously.
+ * The read position advances in 32.32 fixed point so no drift accumulates on
+ * long running streams.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "openavb_types_pub.h"
+#include "openavb_intf_alsa_asrc.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ASRC_X86	1
+#include <immintrin.h>
+#define X86_TARGET(isa)	__attribute__ ((target (isa)))
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define ASRC_NEON	1
+#include <arm_neon.h>
+#endif
+
+#define ASRC_TAPS			32
+#define ASRC_PHASE_BITS		8
+#define ASRC_PHASES			(1 << ASRC_PHASE_BITS)
+#define ASRC_FRAC_BITS		(32 - ASRC_PHASE_BITS)
+
+// Pass band edge relative to the Nyquist frequency, and the Kaiser window shape.
+#define ASRC_CUTOFF			0.90
+#define ASRC_KAISER_BETA	8.0
+
+// Loop filter. A natural frequency of 10 mHz keeps corrections far below
+// audible pitch modulation while following crystal drift with temperature.
+#define ASRC_LOOP_HZ		0.01
+#define ASRC_LOOP_DAMPING	1.0
+#define ASRC_ERROR_TAU_SEC	1.0
+
+#define ASRC_FIXED_ONE		4294967296.0
+
+// Compute one output frame from the history at idx.
+typedef void (*asrc_frame_fn_t)(float *const *ppHist, U32 idx, U32 channels, const float *pCoef, const float *pDelta, float frac, float *pOut);
+
+struct openavb_asrc {
+	U32 channels;
+	openavb_asrc_sample_t sample;
+	bool bigEndian;
+	U32 sampleBytes;
+	U32 maxInFrames;
+	double maxAdjust;
+
+	// Kernel rows and the difference to the following row, ASRC_PHASES x ASRC_TAPS each
+	float *pCoef;
+	float *pDelta;
+
+	// Planar history, one array per channel
+	float **ppHist;
+	U32 histSize;
+	U32 histLen;
+
+	// Scratch output frame
+	float *pFrame;
+
+	// Read position in the history and its increment per output frame, 32.32 fixed point
+	U64 pos;
+	U64 step;
+
+	// Controller state
+	bool errorValid;
+	double error;
+	double integral;
+	double adjust;
+
+	asrc_frame_fn_t frameFn;
+};
+
+/////////////
+// Filter design
+/////////////
+
+// Zeroth order modified Bessel function of the first kind
+static double x_besselI0(double x)
+{
+	double sum = 1.0, term = 1.0;
+	int k;
+	for (k = 1; k < 50 && term > sum * 1e-12; k++) {
+		double t = x / (2.0 * k);
+		term *= t * t;
+		sum += term;
+	}
+	return sum;
+}
+
+// Kernel taps for an interpolated position f in [0, 1] past tap ASRC_TAPS / 2 - 1
+static void x_kernelRow(double f, double *pRow)
+{
+	double i0Beta = x_besselI0(ASRC_KAISER_BETA);
+	double sum = 0;
+	int t;
+
+	for (t = 0; t < ASRC_TAPS; t++) {
+		double x = t - (ASRC_TAPS / 2 - 1) - f;
+		double u = x / (ASRC_TAPS / 2);
+		double w = (u * u < 1.0) ? x_besselI0(ASRC_KAISER_BETA * sqrt(1.0 - u * u)) / i0Beta : 0.0;
+		double s = (x == 0.0) ? 1.0 : sin(M_PI * ASRC_CUTOFF * x) / (M_PI * ASRC_CUTOFF * x);
+		pRow[t] = s * w;
+		sum += pRow[t];
+	}
+	// Unity gain at DC for every phase so ratio changes cannot modulate the level.
+	for (t = 0; t < ASRC_TAPS; t++) {
+		pRow[t] /= sum;
+	}
+}
+
+static void x_designKernel(float *pCoef, float *pDelta)
+{
+	double row[ASRC_TAPS], next[ASRC_TAPS];
+	int p, t;
+
+	x_kernelRow(0.0, next);
+	for (p = 0; p < ASRC_PHASES; p++) {
+		memcpy(row, next, sizeof(row));
+		x_kernelRow((double)(p + 1) / ASRC_PHASES, next);
+		for (t = 0; t < ASRC_TAPS; t++) {
+			pCoef[p * ASRC_TAPS + t] = row[t];
+			pDelta[p * ASRC_TAPS + t] = next[t] - row[t];
+		}
+	}
+}
+
+/////////////
+// Scalar filter
+/////////////
+
+static void x_scalarFrame(float *const *ppHist, U32 idx, U32 channels, const float *pCoef, const float *pDelta, float frac, float *pOut)
+{
+	float h[ASRC_TAPS];
+	U32 t, ch;
+
+	for (t = 0; t < ASRC_TAPS; t++) {
+		h[t] = pCoef[t] + frac * pDelta[t];
+	}
+	for (ch = 0; ch < channels; ch++) {
+		const float *x = ppHist[ch] + idx;
+		float acc = 0;
+		for (t = 0; t < ASRC_TAPS; t++) {
+			acc += x[t] * h[t];
+		}
+		pOut[ch] = acc;
+	}
+}
+
+#if ASRC_X86
+/////////////
+// SSE filter
+/////////////
+
+X86_TARGET("sse") static float x_sseHsum(__m128 v)
+{
+	v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+	v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 0x55));
+	return _mm_cvtss_f32(v);
+}
+
+X86_TARGET("sse") static void x_sseFrame(float *const *ppHist, U32 idx, U32 channels, const float *pCoef, const float *pDelta, float frac, float *pOut)
+{
+	__m128 h[ASRC_TAPS / 4];
+	const __m128 f = _mm_set1_ps(frac);
+	U32 t, ch;
+
+	for (t = 0; t < ASRC_TAPS / 4; t++) {
+		h[t] = _mm_add_ps(_mm_load_ps(pCoef + t * 4), _mm_mul_ps(f, _mm_load_ps(pDelta + t * 4)));
+	}
+	for (ch = 0; ch < channels; ch++) {
+		const float *x = ppHist[ch] + idx;
+		__m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+		for (t = 0; t < ASRC_TAPS / 4; t += 2) {
+			acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(x + t * 4), h[t]));
+			acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(x + t * 4 + 4), h[t + 1]));
+		}
+		pOut[ch] = x_sseHsum(_mm_add_ps(acc0, acc1));
+	}
+}
+
+/////////////
+// AVX filter
+/////////////
+
+X86_TARGET("avx") static void x_avxFrame(float *const *ppHist, U32 idx, U32 channels, const float *pCoef, const float *pDelta, float frac, float *pOut)
+{
+	__m256 h[ASRC_TAPS / 8];
+	const __m256 f = _mm256_set1_ps(frac);
+	U32 t, ch;
+
+	for (t = 0; t < ASRC_TAPS / 8; t++) {
+		h[t] = _mm256_add_ps(_mm256_load_ps(pCoef + t * 8), _mm256_mul_ps(f, _mm256_load_ps(pDelta + t * 8)));
+	}
+	for (ch = 0; ch < channels; ch++) {
+		const float *x = ppHist[ch] + idx;
+		__m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+		for (t = 0; t < ASRC_TAPS / 8; t += 2) {
+			acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(x + t * 8), h[t]));
+			acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(x + t * 8 + 8), h[t + 1]));
+		}
+		__m256 acc = _mm256_add_ps(acc0, acc1);
+		pOut[ch] = x_sseHsum(_mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1)));
+	}
+}
+
+static asrc_frame_fn_t x_vectorFrame(void)
+{
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx"))
+		return x_avxFrame;
+	if (__builtin_cpu_supports("sse"))
+		return x_sseFrame;
+	return NULL;
+}
+
+const char *openavbAsrcIsaName(void)
+{
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx"))
+		return "AVX";
+	if (__builtin_cpu_supports("sse"))
+		return "SSE";
+	return "scalar";
+}
+
+#elif ASRC_NEON
+/////////////
+// NEON filter
+/////////////
+
+static void x_neonFrame(float *const *ppHist, U32 idx, U32 channels, const float *pCoef, const float *pDelta, float frac, float *pOut)
+{
+	float32x4_t h[ASRC_TAPS / 4];
+	U32 t, ch;
+
+	for (t = 0; t < ASRC_TAPS / 4; t++) {
+		h[t] = vmlaq_n_f32(vld1q_f32(pCoef + t * 4), vld1q_f32(pDelta + t * 4), frac);
+	}
+	for (ch = 0; ch < channels; ch++) {
+		const float *x = ppHist[ch] + idx;
+		float32x4_t acc0 = vdupq_n_f32(0), acc1 = vdupq_n_f32(0);
+		for (t = 0; t < ASRC_TAPS / 4; t += 2) {
+			acc0 = vmlaq_f32(acc0, vld1q_f32(x + t * 4), h[t]);
+			acc1 = vmlaq_f32(acc1, vld1q_f32(x + t * 4 + 4), h[t + 1]);
+		}
+		float32x4_t acc = vaddq_f32(acc0, acc1);
+		float32x2_t sum = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+		pOut[ch] = vget_lane_f32(vpadd_f32(sum, sum), 0);
+	}
+}
+
+static asrc_frame_fn_t x_vectorFrame(void)
+{
+	return x_neonFrame;
+}
+
+const char *openavbAsrcIsaName(void)
+{
+	return "NEON";
+}
+
+#else
+
+static asrc_frame_fn_t x_vectorFrame(void)
+{
+	return NULL;
+}
+
+const char *openavbAsrcIsaName(void)
+{
+	return "scalar";
+}
+
+#endif
+
+/////////////
+// Sample conversion
+/////////////
+
+static U32 x_load32(const U8 *p, bool bigEndian)
+{
+	if (bigEndian)
+		return ((U32)p[0] << 24) | ((U32)p[1] << 16) | ((U32)p[2] << 8) | p[3];
+	return ((U32)p[3] << 24) | ((U32)p[2] << 16) | ((U32)p[1] << 8) | p[0];
+}
+
+static void x_store32(U8 *p, U32 v, bool bigEndian)
+{
+	if (bigEndian) {
+		p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+	}
+	else {
+		p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+	}
+}
+
+static S32 x_load24(const U8 *p, bool bigEndian)
+{
+	U32 v = bigEndian ? ((U32)p[0] << 16) | ((U32)p[1] << 8) | p[2]
+		: ((U32)p[2] << 16) | ((U32)p[1] << 8) | p[0];
+	return (S32)(v << 8) >> 8;
+}
+
+static void x_store24(U8 *p, S32 v, bool bigEndian)
+{
+	if (bigEndian) {
+		p[0] = v >> 16; p[1] = v >> 8; p[2] = v;
+	}
+	else {
+		p[0] = v; p[1] = v >> 8; p[2] = v >> 16;
+	}
+}
+
+static float x_loadSample(const openavb_asrc_t *pAsrc, const U8 *p)
+{
+	bool be = pAsrc->bigEndian;
+	switch (pAsrc->sample) {
+		case ASRC_SAMPLE_S16:
+			return (S16)(be ? (p[0] << 8) | p[1] : (p[1] << 8) | p[0]) * (1.0f / 32768.0f);
+		case ASRC_SAMPLE_S24_3:
+			return x_load24(p, be) * (1.0f / 8388608.0f);
+		case ASRC_SAMPLE_S24_4:
+			return x_load24(be ? p + 1 : p, be) * (1.0f / 8388608.0f);
+		case ASRC_SAMPLE_S32:
+			return (S32)x_load32(p, be) * (1.0f / 2147483648.0f);
+		case ASRC_SAMPLE_FLOAT:
+		default: {
+			U32 v = x_load32(p, be);
+			float f;
+			memcpy(&f, &v, sizeof(f));
+			return f;
+		}
+	}
+}
+
+static S32 x_quantize(float y, double scale)
+{
+	double v = floor(y * scale + 0.5);
+	if (v > scale - 1)
+		return (S32)(scale - 1);
+	if (v < -scale)
+		return (S32)(-scale);
+	return (S32)v;
+}
+
+static void x_storeSample(const openavb_asrc_t *pAsrc, U8 *p, float y)
+{
+	bool be = pAsrc->bigEndian;
+	switch (pAsrc->sample) {
+		case ASRC_SAMPLE_S16: {
+			S32 v = x_quantize(y, 32768.0);
+			if (be) {
+				p[0] = v >> 8; p[1] = v;
+			}
+			else {
+				p[0] = v; p[1] = v >> 8;
+			}
+			break;
+		}
+		case ASRC_SAMPLE_S24_3:
+			x_store24(p, x_quantize(y, 8388608.0), be);
+			break;
+		case ASRC_SAMPLE_S24_4:
+			x_store32(p, (U32)x_quantize(y, 8388608.0) & 0x00FFFFFF, be);
+			break;
+		case ASRC_SAMPLE_S32:
+			x_store32(p, (U32)x_quantize(y, 2147483648.0), be);
+			break;
+		case ASRC_SAMPLE_FLOAT:
+		default: {
+			U32 v;
+			memcpy(&v, &y, sizeof(v));
+			x_store32(p, v, be);
+			break;
+		}
+	}
+}
+
+/////////////
+// Public API
+/////////////
+
+openavb_asrc_t *openavbAsrcCreate(U32 channels, openavb_asrc_sample_t sample, bool bigEndian, U32 maxInFrames, U32 maxPpm)
+{
+	static const U32 sampleBytes[] = { 2, 3, 4, 4, 4 };
+	U32 ch;
+
+	if (channels == 0 || maxInFrames == 0 || (U32)sample >= sizeof(sampleBytes) / sizeof(sampleBytes[0])) {
+		return NULL;
+	}
+
+	openavb_asrc_t *pAsrc = calloc(1, sizeof(openavb_asrc_t));
+	if (!pAsrc) {
+		return NULL;
+	}
+
+	pAsrc->channels = channels;
+	pAsrc->sample = sample;
+	pAsrc->bigEndian = bigEndian;
+	pAsrc->sampleBytes = sampleBytes[sample];
+	pAsrc->maxInFrames = maxInFrames;
+	pAsrc->maxAdjust = maxPpm / 1e6;
+	if (pAsrc->maxAdjust > 0.01) {
+		pAsrc->maxAdjust = 0.01;
+	}
+	pAsrc->histSize = maxInFrames + ASRC_TAPS + 2;
+	pAsrc->frameFn = x_vectorFrame();
+	if (!pAsrc->frameFn) {
+		pAsrc->frameFn = x_scalarFrame;
+	}
+
+	// The vector kernels use aligned loads for the coefficients.
+	if (posix_memalign((void **)&pAsrc->pCoef, 32, ASRC_PHASES * ASRC_TAPS * sizeof(float)) != 0
+		|| posix_memalign((void **)&pAsrc->pDelta, 32, ASRC_PHASES * ASRC_TAPS * sizeof(float)) != 0) {
+		openavbAsrcDelete(pAsrc);
+		return NULL;
+	}
+	pAsrc->ppHist = calloc(channels, sizeof(float *));
+	pAsrc->pFrame = calloc(channels, sizeof(float));
+	if (!pAsrc->ppHist || !pAsrc->pFrame) {
+		openavbAsrcDelete(pAsrc);
+		return NULL;
+	}
+	for (ch = 0; ch < channels; ch++) {
+		pAsrc->ppHist[ch] = calloc(pAsrc->histSize, sizeof(float));
+		if (!pAsrc->ppHist[ch]) {
+			openavbAsrcDelete(pAsrc);
+			return NULL;
+		}
+	}
+
+	x_designKernel(pAsrc->pCoef, pAsrc->pDelta);
+
+	// Leading silence puts the first input frame at the center of the first kernel.
+	pAsrc->histLen = ASRC_TAPS / 2 - 1;
+	pAsrc->pos = 0;
+	pAsrc->step = (U64)ASRC_FIXED_ONE;
+
+	return pAsrc;
+}
+
+void openavbAsrcDelete(openavb_asrc_t *pAsrc)
+{
+	if (pAsrc) {
+		if (pAsrc->ppHist) {
+			U32 ch;
+			for (ch = 0; ch < pAsrc->channels; ch++) {
+				free(pAsrc->ppHist[ch]);
+			}
+			free(pAsrc->ppHist);
+		}
+		free(pAsrc->pFrame);
+		free(pAsrc->pCoef);
+		free(pAsrc->pDelta);
+		free(pAsrc);
+	}
+}
+
+U32 openavbAsrcMaxOutFrames(openavb_asrc_t *pAsrc)
+{
+	if (!pAsrc) {
+		return 0;
+	}
+	return (U32)ceil(pAsrc->maxInFrames / (1.0 - pAsrc->maxAdjust)) + 2;
+}
+
+U32 openavbAsrcProcess(openavb_asrc_t *pAsrc, const U8 *pIn, U32 inFrames, U8 *pOut)
+{
+	U32 frameBytes, ch, i, outFrames = 0;
+
+	if (!pAsrc || !pIn || !pOut) {
+		return 0;
+	}
+	if (inFrames > pAsrc->maxInFrames) {
+		inFrames = pAsrc->maxInFrames;
+	}
+	frameBytes = pAsrc->channels * pAsrc->sampleBytes;
+
+	// Deinterleave into the history
+	for (i = 0; i < inFrames; i++) {
+		const U8 *pFrameIn = pIn + i * frameBytes;
+		for (ch = 0; ch < pAsrc->channels; ch++) {
+			pAsrc->ppHist[ch][pAsrc->histLen + i] = x_loadSample(pAsrc, pFrameIn + ch * pAsrc->sampleBytes);
+		}
+	}
+	pAsrc->histLen += inFrames;
+
+	for (;;) {
+		U32 idx = (U32)(pAsrc->pos >> 32);
+		if (idx + ASRC_TAPS > pAsrc->histLen) {
+			break;
+		}
+
+		U32 frac = (U32)pAsrc->pos;
+		U32 phase = frac >> ASRC_FRAC_BITS;
+		float interp = (frac & ((1U << ASRC_FRAC_BITS) - 1)) * (1.0f / (1U << ASRC_FRAC_BITS));
+
+		pAsrc->frameFn(pAsrc->ppHist, idx, pAsrc->channels,
+			pAsrc->pCoef + phase * ASRC_TAPS, pAsrc->pDelta + phase * ASRC_TAPS, interp, pAsrc->pFrame);
+
+		U8 *pFrameOut = pOut + outFrames * frameBytes;
+		for (ch = 0; ch < pAsrc->channels; ch++) {
+			x_storeSample(pAsrc, pFrameOut + ch * pAsrc->sampleBytes, pAsrc->pFrame[ch]);
+		}
+		outFrames++;
+		pAsrc->pos += pAsrc->step;
+	}
+
+	// Drop history that no future kernel position can reach.
+	U32 drop = (U32)(pAsrc->pos >> 32);
+	if (drop > pAsrc->histLen) {
+		drop = pAsrc->histLen;
+	}
+	if (drop) {
+		for (ch = 0; ch < pAsrc->channels; ch++) {
+			memmove(pAsrc->ppHist[ch], pAsrc->ppHist[ch] + drop, (pAsrc->histLen - drop) * sizeof(float));
+		}
+		pAsrc->histLen -= drop;
+		pAsrc->pos -= (U64)drop << 32;
+	}
+
+	return outFrames;
+}
+
+double openavbAsrcBufferedFrames(openavb_asrc_t *pAsrc)
+{
+	if (!pAsrc) {
+		return 0;
+	}
+	double center = pAsrc->pos / ASRC_FIXED_ONE + (ASRC_TAPS / 2 - 1);
+	return pAsrc->histLen > center ? pAsrc->histLen - center : 0;
+}
+
+void openavbAsrcControl(openavb_asrc_t *pAsrc, double errorSec, double intervalSec)
+{
+	if (!pAsrc) {
+		return;
+	}
+	if (intervalSec < 0) {
+		intervalSec = 0;
+	}
+
+	// Low pass the measurement. Device pointers often only move once per period.
+	if (!pAsrc->errorValid) {
+		pAsrc->error = errorSec;
+		pAsrc->errorValid = TRUE;
+	}
+	else {
+		pAsrc->error += (errorSec - pAsrc->error) * intervalSec / (ASRC_ERROR_TAU_SEC + intervalSec);
+	}
+
+	// The queued audio integrates the ratio error, so a PI controller gives a second order loop.
+	double w = 2.0 * M_PI * ASRC_LOOP_HZ;
+	pAsrc->integral += w * w * pAsrc->error * intervalSec;
+	if (pAsrc->integral > pAsrc->maxAdjust)
+		pAsrc->integral = pAsrc->maxAdjust;
+	else if (pAsrc->integral < -pAsrc->maxAdjust)
+		pAsrc->integral = -pAsrc->maxAdjust;
+
+	pAsrc->adjust = 2.0 * ASRC_LOOP_DAMPING * w * pAsrc->error + pAsrc->integral;
+	if (pAsrc->adjust > pAsrc->maxAdjust)
+		pAsrc->adjust = pAsrc->maxAdjust;
+	else if (pAsrc->adjust < -pAsrc->maxAdjust)
+		pAsrc->adjust = -pAsrc->maxAdjust;
+
+	pAsrc->step = (U64)((1.0 + pAsrc->adjust) * ASRC_FIXED_ONE + 0.5);
+}
+
+void openavbAsrcResync(openavb_asrc_t *pAsrc)
+{
+	if (pAsrc) {
+		pAsrc->errorValid = FALSE;
+		pAsrc->error = 0;
+		pAsrc->adjust = pAsrc->integral;
+		pAsrc->step = (U64)((1.0 + pAsrc->adjust) * ASRC_FIXED_ONE + 0.5);
+	}
+}
+
+double openavbAsrcGetPpm(openavb_asrc_t *pAsrc)
+{
+	return pAsrc ? pAsrc->adjust * 1e6 : 0;
+}
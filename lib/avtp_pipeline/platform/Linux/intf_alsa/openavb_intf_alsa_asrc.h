@@ -0,0 +1,85 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* HEADER SUMMARY : Adaptive sample rate converter for the ALSA interface module.
+*
+* Converts interleaved PCM by a ratio close to 1 with a windowed sinc polyphase
+* filter, so a listener can follow a talker media clock that runs at a slightly
+* different rate than the local audio device. A PI controller adjusts the ratio
+* from measurements of the playout error. Vector implementations of the filter
+* are chosen at run time where the CPU supports them.
+*/
+
+#ifndef OPENAVB_INTF_ALSA_ASRC_H
+#define OPENAVB_INTF_ALSA_ASRC_H 1
+
+#include "openavb_types_pub.h"
+
+// Sample encodings the converter can read and write.
+typedef enum {
+	ASRC_SAMPLE_S16,
+	ASRC_SAMPLE_S24_3,		// Packed in 3 bytes
+	ASRC_SAMPLE_S24_4,		// Low 24 bits of a 4 byte container
+	ASRC_SAMPLE_S32,
+	ASRC_SAMPLE_FLOAT,
+} openavb_asrc_sample_t;
+
+typedef struct openavb_asrc openavb_asrc_t;
+
+// Create a converter for up to maxInFrames input frames per call. maxPpm limits the ratio adjustment.
+openavb_asrc_t *openavbAsrcCreate(U32 channels, openavb_asrc_sample_t sample, bool bigEndian, U32 maxInFrames, U32 maxPpm);
+
+void openavbAsrcDelete(openavb_asrc_t *pAsrc);
+
+// Largest number of frames openavbAsrcProcess() can produce in one call.
+U32 openavbAsrcMaxOutFrames(openavb_asrc_t *pAsrc);
+
+// Convert inFrames frames from pIn into pOut. Returns the number of frames written.
+U32 openavbAsrcProcess(openavb_asrc_t *pAsrc, const U8 *pIn, U32 inFrames, U8 *pOut);
+
+// Input frames held by the converter that have not been played out yet.
+double openavbAsrcBufferedFrames(openavb_asrc_t *pAsrc);
+
+// Feed one playout error measurement in seconds, positive when too much audio is
+// queued, taken intervalSec after the previous one. Adjusts the conversion ratio.
+void openavbAsrcControl(openavb_asrc_t *pAsrc, double errorSec, double intervalSec);
+
+// Forget the filtered error after a discontinuity. The learned clock offset is kept.
+void openavbAsrcResync(openavb_asrc_t *pAsrc);
+
+// Current ratio adjustment in parts per million. Positive values consume input faster.
+double openavbAsrcGetPpm(openavb_asrc_t *pAsrc);
+
+// Name of the instruction set the filter uses, for logging.
+const char *openavbAsrcIsaName(void);
+
+#endif // OPENAVB_INTF_ALSA_ASRC_H
@@ -59,6 +59,15 @@ typedef struct pvt_data_t
 
 	bool ignoreTimestamp;
 
+	// Talker pipeline has no RTP payloader and delivers Annex-B access units.
+	// Requires map_nv_tx_access_units = 1 on the H.264 mapping.
+	bool txAccessUnits;
+
+	// Listener mapping delivers reassembled Annex-B access units (map_nv_rx_reassemble = 1)
+	// which are pushed as plain buffers instead of RTP packets.
+	bool rxAccessUnits;
+	U32 rxFirstTimestamp;
+
 	GstElement       *pipe;
 	GstAppSink       *appsink;
 	GstAppSrc       *appsrc;
@@ -210,8 +219,11 @@ static void createTxPipeline(media_q_t *pMediaQ)
 	}
 	else
 	{
-		AVB_LOG_ERROR("Cannot set mtu on rtppayloader. Make sure that its name is avbrtppay in the pipeline.");
+		// Without a payloader the sink must deliver byte-stream, access unit aligned buffers
+		// which the H.264 mapping fragments itself.
+		AVB_LOG_INFO("No avbrtppay element in the pipeline. Passing Annex-B access units to the mapping (map_nv_tx_access_units = 1).");
 	}
+	pPvtData->txAccessUnits = (rtpPayloader == NULL);
 
 	if (GST_STATE_CHANGE_FAILURE == gst_element_set_state(pPvtData->pipe, GST_STATE_PLAYING)) {
 		AVB_LOG_ERROR("Failed to change pipeline state to PLAYING.");
@@ -305,7 +317,14 @@ bool openavbIntfH264RtpGstTxCB(media_q_t *pMediaQ)
 
 			GstAlBuf *txBuf = NULL;
 
-			txBuf = gst_al_pull_rtp_buffer(GST_APP_SINK(pPvtData->appsink));
+			if (pPvtData->txAccessUnits)
+			{
+				txBuf = gst_al_pull_buffer(GST_APP_SINK(pPvtData->appsink));
+			}
+			else
+			{
+				txBuf = gst_al_pull_rtp_buffer(GST_APP_SINK(pPvtData->appsink));
+			}
 
 			if (!txBuf)
 			{
@@ -325,13 +344,33 @@ bool openavbIntfH264RtpGstTxCB(media_q_t *pMediaQ)
 
 				pMediaQItem->dataLen = 0;
 				openavbMediaQHeadUnlock(pMediaQ);
-				gst_al_rtp_buffer_unref(txBuf);
+				if (pPvtData->txAccessUnits)
+				{
+					gst_al_buffer_unref(txBuf);
+				}
+				else
+				{
+					gst_al_rtp_buffer_unref(txBuf);
+				}
 
 				return FALSE;
 			}
 
 			pMediaQItem->dataLen = paySize;
 			memcpy(pMediaQItem->pPubData, GST_AL_BUF_DATA(txBuf), paySize);
+			if (pPvtData->txAccessUnits)
+			{
+				// A whole access unit. h264_timestamp uses the 90 kHz RTP clock (RFC 6184).
+				GstClockTime pts = GST_AL_BUFFER_TIMESTAMP(txBuf);
+				((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->lastPacket = TRUE;
+				((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->timestamp =
+						GST_CLOCK_TIME_IS_VALID(pts) ? (U32)gst_util_uint64_scale(pts, 90000, GST_SECOND) : 0;
+				openavbAvtpTimeSetToWallTime(pMediaQItem->pAvtpTime);
+				openavbMediaQHeadPush(pMediaQ);
+
+				gst_al_buffer_unref(txBuf);
+				continue;
+			}
 			if (gst_al_rtp_buffer_get_marker(txBuf))
 			{
 				((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->lastPacket = TRUE;
@@ -405,7 +444,15 @@ static void *openavbIntfH264RtpGstRxThreadfn(void *pv)
 			{
 				pPvtData->rxBufs[pPvtData->bufrd%NBUFS] = NULL;
 				__sync_fetch_and_add(&pPvtData->bufrd, 1);
-				GstFlowReturn ret = gst_al_push_rtp_buffer(GST_APP_SRC(pPvtData->appsrc), rxBuf);
+				GstFlowReturn ret;
+				if (pPvtData->rxAccessUnits)
+				{
+					ret = gst_al_push_buffer(GST_APP_SRC(pPvtData->appsrc), rxBuf);
+				}
+				else
+				{
+					ret = gst_al_push_rtp_buffer(GST_APP_SRC(pPvtData->appsrc), rxBuf);
+				}
 
 				if (ret != GST_FLOW_OK)
 				{
@@ -443,6 +490,7 @@ void openavbIntfH264RtpGstRxInitCB(media_q_t *pMediaQ)
 	}
 
 	pPvtData->firstSample = true;
+	pPvtData->rxAccessUnits = FALSE;
 
 	GError *error = NULL;
 	pPvtData->pipe = gst_parse_launch(pPvtData->pPipelineStr, &error);
@@ -537,7 +585,22 @@ bool openavbIntfH264RtpGstRxCB(media_q_t *pMediaQ)
 				continue;
 			}
 		}
-		GstAlBuf *rxBuf = gst_al_alloc_rtp_buffer(pMediaQItem->dataLen, 0,0);
+		media_q_item_map_h264_pub_data_t *pPubMapData = pMediaQItem->pPubMapData;
+		GstAlBuf *rxBuf;
+		if (pPubMapData->accessUnit)
+		{
+			// Whole access unit in byte-stream format; one push per frame.
+			if (!pPvtData->rxAccessUnits)
+			{
+				pPvtData->rxAccessUnits = TRUE;
+				pPvtData->rxFirstTimestamp = pPubMapData->timestamp;
+			}
+			rxBuf = gst_al_alloc_buffer(pMediaQItem->dataLen);
+		}
+		else
+		{
+			rxBuf = gst_al_alloc_rtp_buffer(pMediaQItem->dataLen, 0,0);
+		}
 
 		if (!rxBuf)
 		{
@@ -547,15 +610,25 @@ bool openavbIntfH264RtpGstRxCB(media_q_t *pMediaQ)
 		}
 		memcpy(GST_AL_BUF_DATA(rxBuf), pMediaQItem->pPubData, pMediaQItem->dataLen);
 
-		//GST_AL_BUFFER_TIMESTAMP(rxBuf) = GST_CLOCK_TIME_NONE;
-		GST_AL_BUFFER_TIMESTAMP(rxBuf) = ((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->timestamp;
-		GST_AL_BUFFER_DURATION(rxBuf) = GST_CLOCK_TIME_NONE;
-		if ( ((media_q_item_map_h264_pub_data_t *)pMediaQItem->pPubMapData)->lastPacket )
+		if (pPubMapData->accessUnit)
 		{
-			gst_al_rtp_buffer_set_marker(rxBuf,TRUE);
+			// 90 kHz h264_timestamp relative to the first access unit
+			GST_AL_BUFFER_TIMESTAMP(rxBuf) =
+					gst_util_uint64_scale((U32)(pPubMapData->timestamp - pPvtData->rxFirstTimestamp), GST_SECOND, 90000);
+			GST_AL_BUFFER_DURATION(rxBuf) = GST_CLOCK_TIME_NONE;
 		}
+		else
+		{
+			//GST_AL_BUFFER_TIMESTAMP(rxBuf) = GST_CLOCK_TIME_NONE;
+			GST_AL_BUFFER_TIMESTAMP(rxBuf) = pPubMapData->timestamp;
+			GST_AL_BUFFER_DURATION(rxBuf) = GST_CLOCK_TIME_NONE;
+			if (pPubMapData->lastPacket)
+			{
+				gst_al_rtp_buffer_set_marker(rxBuf,TRUE);
+			}
 
-		gst_al_rtp_buffer_set_params(rxBuf, 5, 96, 2, pPvtData->seq++);
+			gst_al_rtp_buffer_set_params(rxBuf, 5, 96, 2, pPvtData->seq++);
+		}
 
 		if (pPvtData->asyncRx)
 		{
@@ -568,7 +641,15 @@ bool openavbIntfH264RtpGstRxCB(media_q_t *pMediaQ)
 		else
 		{
 			// appsrc manages this buffer at this point
-			GstFlowReturn ret = gst_al_push_rtp_buffer(GST_APP_SRC(pPvtData->appsrc), rxBuf);
+			GstFlowReturn ret;
+			if (pPubMapData->accessUnit)
+			{
+				ret = gst_al_push_buffer(GST_APP_SRC(pPvtData->appsrc), rxBuf);
+			}
+			else
+			{
+				ret = gst_al_push_rtp_buffer(GST_APP_SRC(pPvtData->appsrc), rxBuf);
+			}
 			if (ret != GST_FLOW_OK)
 			{
 				AVB_LOGF_ERROR("Pushing buffer to appsrc failed with code %d", ret);
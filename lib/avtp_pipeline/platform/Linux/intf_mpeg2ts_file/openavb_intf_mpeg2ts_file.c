@@ -38,6 +38,11 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "openavb_types_pub.h"
 #include "openavb_trace_pub.h"
 #include "openavb_mediaq_pub.h"
@@ -53,6 +58,15 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #define MAX_TABLE_PIDS 100
 #define F27_MHZ 27000000.0
 #define F90_KHZ 90000.0
+#define TS_PACKET_SIZE 188
+
+// Default number of bytes the kernel is asked to read ahead of the talker
+#define DEFAULT_READAHEAD_BYTES (16 * 1024 * 1024)
+#define MIN_READAHEAD_BYTES (256 * 1024)
+
+// If pacing falls further behind than this the schedule is restarted
+// instead of sending a burst to catch up.
+#define MAX_PACING_LAG 0.05 // (seconds)
 
 struct PIDStatus {
   double firstClock, lastClock, firstRealTime, lastRealTime;
@@ -78,11 +92,24 @@ typedef struct {
 	// Ignore timestamp at listener.
 	bool ignoreTimestamp;
 
+	// intf_nv_mmap: Memory map the input file instead of reading it
+	bool useMmap;
+
+	// intf_nv_readahead_bytes: How far ahead of the talker the kernel reads the mapped file
+	U32 readaheadBytes;
+
 	/////////////
 	// Variable data
 	/////////////
 	FILE *pFile;
 
+	// Memory mapped input file. pFile is NULL while the map is in use.
+	U8 *pMap;
+	size_t mapLen;
+	size_t mapOffset;
+	size_t readaheadOffset;
+	size_t releasedOffset;
+
 	// Talker variables for tracking rewind
 	struct timespec startTime;
 	int nRepeatCount;
@@ -174,6 +201,20 @@ void openavbIntfMpeg2tsFileCfgCB(media_q_t *pMediaQ, const char *name, const cha
 				valueOK = TRUE;
 			}
 		}
+		else if (strcmp(name, "intf_nv_mmap") == 0) {
+			tmp = strtoul(value, &pEnd, 10);
+			if (*pEnd == '\0' && pEnd != value && (tmp == 0 || tmp == 1)) {
+				pPvtData->useMmap = (tmp == 1);
+				valueOK = TRUE;
+			}
+		}
+		else if (strcmp(name, "intf_nv_readahead_bytes") == 0) {
+			tmp = strtoul(value, &pEnd, 10);
+			if (*pEnd == '\0' && pEnd != value && tmp >= MIN_READAHEAD_BYTES) {
+				pPvtData->readaheadBytes = tmp;
+				valueOK = TRUE;
+			}
+		}
 		else if (strcmp(name, "intf_nv_enable_proper_bitrate_streaming") == 0) {
 			tmp = strtoul(value, &pEnd, 10);
 			if (*pEnd == '\0' && pEnd != value && (tmp == 0 || tmp == 1)) {
@@ -206,82 +247,194 @@ static void sync_scan(FILE* input)
 	}
 }
 
+static size_t x_pageSize(void)
+{
+	static size_t pageSize = 0;
+	if (!pageSize) {
+		long val = sysconf(_SC_PAGESIZE);
+		pageSize = val > 0 ? val : 4096;
+	}
+	return pageSize;
+}
+
+// Ask the kernel to read the next window of the mapped file and drop pages that have already been sent.
+static void x_mmapReadahead(pvt_data_t *pPvtData)
+{
+	size_t pageMask = x_pageSize() - 1;
+	size_t window = (pPvtData->readaheadBytes + pageMask) & ~pageMask;
+
+	if (pPvtData->readaheadOffset < pPvtData->mapLen
+		&& pPvtData->mapOffset + window > pPvtData->readaheadOffset) {
+		size_t len = pPvtData->mapLen - pPvtData->readaheadOffset;
+		if (len > window) {
+			len = window;
+		}
+		madvise(pPvtData->pMap + pPvtData->readaheadOffset, len, MADV_WILLNEED);
+		pPvtData->readaheadOffset += len;
+	}
+
+	// The page cache keeps the data for repeats. This only keeps the mapping from pinning the whole file.
+	if (pPvtData->mapOffset - pPvtData->releasedOffset >= window) {
+		size_t end = pPvtData->mapOffset & ~pageMask;
+		madvise(pPvtData->pMap + pPvtData->releasedOffset, end - pPvtData->releasedOffset, MADV_DONTNEED);
+		pPvtData->releasedOffset = end;
+	}
+}
+
+static U8 *x_mmapFile(const char *fileName, size_t *pLen)
+{
+	struct stat st;
+	int fd = open(fileName, O_RDONLY);
+	if (fd < 0) {
+		return NULL;
+	}
+
+	// Pipes, devices and empty files are read with stdio instead.
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+		close(fd);
+		return NULL;
+	}
+
+	void *pMap = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (pMap == MAP_FAILED) {
+		AVB_LOGF_WARNING("Unable to map input file: %s, %s", fileName, strerror(errno));
+		return NULL;
+	}
+
+	madvise(pMap, st.st_size, MADV_SEQUENTIAL);
+	*pLen = st.st_size;
+	return pMap;
+}
+
+static bool x_mmapOpen(pvt_data_t *pPvtData)
+{
+	pPvtData->pMap = x_mmapFile(pPvtData->pFileName, &pPvtData->mapLen);
+	if (!pPvtData->pMap) {
+		return FALSE;
+	}
+
+	pPvtData->mapOffset = 0;
+	pPvtData->readaheadOffset = 0;
+	pPvtData->releasedOffset = 0;
+	x_mmapReadahead(pPvtData);
+	return TRUE;
+}
+
+static void x_mmapClose(pvt_data_t *pPvtData)
+{
+	if (pPvtData->pMap) {
+		munmap(pPvtData->pMap, pPvtData->mapLen);
+		pPvtData->pMap = NULL;
+		pPvtData->mapLen = 0;
+	}
+}
+
+// Update the maximum bitrate with one TS packet.
+static void x_bitrateUpdate(const unsigned char *pkt, struct PIDStatus *fPIDStatusTable, double *pTSPacketCount, double *pTSPCRCount, double *pMaxBitrate)
+{
+	double fTSPacketCount = ++(*pTSPacketCount);
+
+	unsigned char const adaptation_field_control = (pkt[3]&0x30)>>4;
+	if (adaptation_field_control != 2 && adaptation_field_control != 3) return;
+	// there's no adaptation_field
+
+	unsigned char const adaptation_field_length = pkt[4];
+	if (adaptation_field_length == 0) return;
+
+	unsigned char const pcrFlag = pkt[5]&0x10;
+	if (pcrFlag == 0) return; // no PCR
+
+	unsigned char const discontinuity_indicator = pkt[5]&0x80;
+	// There's a PCR.  Get it.
+	++(*pTSPCRCount);
+	unsigned int pcrBaseHigh = (pkt[6]<<24)|(pkt[7]<<16)|(pkt[8]<<8)|pkt[9];
+	double fClock = pcrBaseHigh/(F90_KHZ/2);
+	if ((pkt[10]&0x80) != 0) fClock += 1/F90_KHZ; // add in low-bit (if set)
+	unsigned short pcrExt = ((pkt[10]&0x01)<<8) | pkt[11];
+	fClock += pcrExt/F27_MHZ;
+
+	unsigned pid = ((pkt[1]&0x1F)<<8) | pkt[2];
+	int idx = pidTableFindOrCreatePid(fPIDStatusTable, pid);
+	if (idx < 0) return; // PID table full
+	if (!fPIDStatusTable[idx].used) {
+		// We're seeing this PID's PCR for the first time:
+		fPIDStatusTable[idx].used = 1;
+		fPIDStatusTable[idx].firstClock = fClock;
+		fPIDStatusTable[idx].lastClock = fClock;
+		fPIDStatusTable[idx].lastPacketNum = fTSPacketCount;
+	}
+	else {
+		if (discontinuity_indicator == 0) {
+			double duration = fClock - fPIDStatusTable[idx].lastClock;
+			if (duration > 0) {
+				double data = (fTSPacketCount - fPIDStatusTable[idx].lastPacketNum) * 188 * 8;
+				double bitrate = data / duration;
+				if (bitrate > *pMaxBitrate)
+					*pMaxBitrate = bitrate;
+			}
+			fPIDStatusTable[idx].lastClock = fClock;
+			if (duration > 0)
+				fPIDStatusTable[idx].lastPacketNum = fTSPacketCount;
+		}
+		else {
+			fPIDStatusTable[idx].firstClock = fClock;
+			fPIDStatusTable[idx].lastPacketNum = fTSPacketCount;
+		}
+	}
+}
+
 #define TS_PACKETS 1
 static unsigned int openavbComputeFileBitrate(char *fileName, media_q_t *pMediaQ)
 {
+	pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
 	double max_bitrate = 0;
-	FILE *input = fopen(fileName, "rb");
-	if (input != NULL) {
-		unsigned char* packets = (unsigned char *) malloc(188*TS_PACKETS);
-		double fTSPCRCount = 0;
-		struct PIDStatus *fPIDStatusTable = (struct PIDStatus*) calloc(MAX_TABLE_PIDS, sizeof(struct PIDStatus));
-		double fTSPacketCount = 0;
-		int i = 0;
-		for(i = 0; i < MAX_TABLE_PIDS; ++i)
+	double fTSPCRCount = 0;
+	double fTSPacketCount = 0;
+	struct PIDStatus *fPIDStatusTable = (struct PIDStatus*) calloc(MAX_TABLE_PIDS, sizeof(struct PIDStatus));
+	int i = 0;
+
+	if (!fileName || !fPIDStatusTable) {
+		free(fPIDStatusTable);
+		return 0;
+	}
+
+	for(i = 0; i < MAX_TABLE_PIDS; ++i)
+	{
+		fPIDStatusTable[i].pid = -1;
+		fPIDStatusTable[i].used = 0;
+	}
+
+	size_t mapLen = 0;
+	U8 *pMap = pPvtData->useMmap ? x_mmapFile(fileName, &mapLen) : NULL;
+	if (pMap) {
+		size_t offset = 0;
+		while (offset < mapLen && pMap[offset] != MPEGTS_SYNC_BYTE)
+			++offset;
+		for (; offset + TS_PACKET_SIZE <= mapLen; offset += TS_PACKET_SIZE)
 		{
-			fPIDStatusTable[i].pid = -1;
-			fPIDStatusTable[i].used = 0;
+			x_bitrateUpdate(pMap + offset, fPIDStatusTable, &fTSPacketCount, &fTSPCRCount, &max_bitrate);
 		}
-		sync_scan(input);
-		while((TS_PACKETS * 188) == fread((void *)packets, 1, 188*TS_PACKETS, input))
-		{
-			unsigned char* pkt;
-			for (pkt = packets; pkt < &(packets[TS_PACKETS*188]); pkt += 188)
+		munmap(pMap, mapLen);
+	}
+	else {
+		FILE *input = fopen(fileName, "rb");
+		if (input != NULL) {
+			unsigned char* packets = (unsigned char *) malloc(188*TS_PACKETS);
+			sync_scan(input);
+			while(packets && (TS_PACKETS * 188) == fread((void *)packets, 1, 188*TS_PACKETS, input))
 			{
-				fTSPacketCount++;
-
-				unsigned char const adaptation_field_control = (pkt[3]&0x30)>>4;
-				if (adaptation_field_control != 2 && adaptation_field_control != 3)  continue;
-				// there's no adaptation_field
-
-				unsigned char const adaptation_field_length = pkt[4];
-				if (adaptation_field_length == 0) continue;
-
-				unsigned char const pcrFlag = pkt[5]&0x10;
-				if (pcrFlag == 0) continue; // no PCR
-
-				unsigned char const discontinuity_indicator = pkt[5]&0x80;
-				// There's a PCR.  Get it.
-				++fTSPCRCount;
-				unsigned int pcrBaseHigh = (pkt[6]<<24)|(pkt[7]<<16)|(pkt[8]<<8)|pkt[9];
-				double fClock = pcrBaseHigh/(F90_KHZ/2);
-				if ((pkt[10]&0x80) != 0) fClock += 1/F90_KHZ; // add in low-bit (if set)
-				unsigned short pcrExt = ((pkt[10]&0x01)<<8) | pkt[11];
-				fClock += pcrExt/F27_MHZ;
-
-				unsigned pid = ((pkt[1]&0x1F)<<8) | pkt[2];
-				int idx = pidTableFindOrCreatePid(fPIDStatusTable, pid);
-				if (!fPIDStatusTable[idx].used) {
-					// We're seeing this PID's PCR for the first time:
-					fPIDStatusTable[idx].used = 1;
-					fPIDStatusTable[idx].firstClock = fClock;
-					fPIDStatusTable[idx].lastClock = fClock;
-					fPIDStatusTable[idx].lastPacketNum = fTSPacketCount;
-				}
-				else {
-					if (discontinuity_indicator == 0) {
-						double duration = fClock - fPIDStatusTable[idx].lastClock;
-						if (duration > 0) {
-							double data = (fTSPacketCount - fPIDStatusTable[idx].lastPacketNum) * 188 * 8;
-							double bitrate = data / duration;
-							if (bitrate > max_bitrate)
-								max_bitrate = bitrate;
-						}
-						fPIDStatusTable[idx].lastClock = fClock;
-						if (duration > 0)
-							fPIDStatusTable[idx].lastPacketNum = fTSPacketCount;
-					}
-					else {
-						fPIDStatusTable[idx].firstClock = fClock;
-						fPIDStatusTable[idx].lastPacketNum = fTSPacketCount;
-					}
+				unsigned char* pkt;
+				for (pkt = packets; pkt < &(packets[TS_PACKETS*188]); pkt += 188)
+				{
+					x_bitrateUpdate(pkt, fPIDStatusTable, &fTSPacketCount, &fTSPCRCount, &max_bitrate);
 				}
 			}
+			fclose(input);
+			free(packets);
 		}
-		fclose(input);
-		free(fPIDStatusTable);
-		free(packets);
 	}
+	free(fPIDStatusTable);
 
 	return (unsigned int)max_bitrate;
 }
@@ -319,12 +472,16 @@ void openavbIntfMpeg2tsFileTxInitCB(media_q_t *pMediaQ)
 
 		pPvtData->nRepeatCount = 0;
 		pPvtData->nBuffersSent = 0;
+		pPvtData->nextTransmitTime = 0;
 
 		if (!pPvtData->pFileName) {
 			AVB_LOG_INFO("using stdin");
 			pPvtData->pFileName = strdup("stdin");
 			pPvtData->pFile = stdin;
 		}
+		else if (pPvtData->useMmap && x_mmapOpen(pPvtData)) {
+			AVB_LOGF_INFO("Input file mapped: %s, %zu bytes", pPvtData->pFileName, pPvtData->mapLen);
+		}
 		else {
 			pPvtData->pFile = fopen(pPvtData->pFileName, "rb");
 			if (!pPvtData->pFile) {
@@ -354,7 +511,7 @@ bool openavbIntfMpeg2tsFileTxCB(media_q_t *pMediaQ)
 			return FALSE;
 		}
 
-		if (!pPvtData->pFile) {
+		if (!pPvtData->pFile && !pPvtData->pMap) {
 			// input already closed
 			AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
 			return FALSE;
@@ -374,7 +531,7 @@ bool openavbIntfMpeg2tsFileTxCB(media_q_t *pMediaQ)
 		}
 
 		// handle end-of-file
-		if (feof(pPvtData->pFile)) {
+		if (pPvtData->pMap ? pPvtData->mapOffset >= pPvtData->mapLen : feof(pPvtData->pFile)) {
 			if (pPvtData->pFileName && pPvtData->repeat) {
 				if (pPvtData->nRepeatCount < 2)
 					; // No delay for first few rewinds - want to buffer some data for restarts
@@ -387,7 +544,15 @@ bool openavbIntfMpeg2tsFileTxCB(media_q_t *pMediaQ)
 				}
 
 				AVB_LOGF_INFO("EOF, rewinding input file: %s", pPvtData->pFileName);
-				fseek(pPvtData->pFile, 0, 0);
+				if (pPvtData->pMap) {
+					pPvtData->mapOffset = 0;
+					pPvtData->readaheadOffset = 0;
+					pPvtData->releasedOffset = 0;
+					x_mmapReadahead(pPvtData);
+				}
+				else {
+					fseek(pPvtData->pFile, 0, 0);
+				}
 
 				pPvtData->nRepeatCount++;
 				pPvtData->nBuffersSent = 0;
@@ -409,8 +574,13 @@ bool openavbIntfMpeg2tsFileTxCB(media_q_t *pMediaQ)
 			}
 			else {
 				AVB_LOGF_INFO("EOF, closing input file: %s", pPvtData->pFileName);
-				fclose(pPvtData->pFile);
-				pPvtData->pFile = NULL;
+				if (pPvtData->pMap) {
+					x_mmapClose(pPvtData);
+				}
+				else {
+					fclose(pPvtData->pFile);
+					pPvtData->pFile = NULL;
+				}
 				AVB_TRACE_EXIT(AVB_TRACE_MAP_DETAIL);
 				return FALSE;
 			}
@@ -423,8 +593,21 @@ bool openavbIntfMpeg2tsFileTxCB(media_q_t *pMediaQ)
 			return FALSE;	// Media queue full
 		}
  
-		size_t result = fread(pMediaQItem->pPubData, 1, pMediaQItem->itemSize, pPvtData->pFile);
-		if (result == 0) {
+		size_t result;
+		if (pPvtData->pMap) {
+			// Pages are already being read ahead, so this copy does not wait on the disk.
+			result = pPvtData->mapLen - pPvtData->mapOffset;
+			if (result > pMediaQItem->itemSize) {
+				result = pMediaQItem->itemSize;
+			}
+			memcpy(pMediaQItem->pPubData, pPvtData->pMap + pPvtData->mapOffset, result);
+			pPvtData->mapOffset += result;
+			x_mmapReadahead(pPvtData);
+		}
+		else {
+			result = fread(pMediaQItem->pPubData, 1, pMediaQItem->itemSize, pPvtData->pFile);
+		}
+		if (result == 0 && pPvtData->pFile) {
 			int e = ferror(pPvtData->pFile);
 			if (e != 0) {
 				AVB_LOGF_ERROR("Error reading file: %s, %s", pPvtData->pFileName, strerror(e));
@@ -437,7 +620,12 @@ bool openavbIntfMpeg2tsFileTxCB(media_q_t *pMediaQ)
 		else {
 			pMediaQItem->dataLen = result;
 			if (pPvtData->enableBitrateTracking) {
-				pPvtData->nextTransmitTime = nowSeconds + openavbIntfMpeg2tsFileComputeDuration(pPvtData,(unsigned char*) pMediaQItem->pPubData, pMediaQItem->dataLen);
+				// Schedule from the previous transmit time rather than from now so the lateness
+				// of each transmit callback does not accumulate into a lower output rate.
+				if (pPvtData->nextTransmitTime + MAX_PACING_LAG < nowSeconds) {
+					pPvtData->nextTransmitTime = nowSeconds;
+				}
+				pPvtData->nextTransmitTime += openavbIntfMpeg2tsFileComputeDuration(pPvtData,(unsigned char*) pMediaQItem->pPubData, pMediaQItem->dataLen);
 			}
 			openavbMediaQHeadPush(pMediaQ);
 			retval = TRUE;
@@ -454,20 +642,22 @@ bool openavbIntfMpeg2tsFileTxCB(media_q_t *pMediaQ)
 
 double openavbIntfMpeg2tsFileComputeDuration(pvt_data_t* pPvtData, unsigned char* pkts, unsigned int length)
 {
-	int offset = 0;
+	unsigned int offset = 0;
 	unsigned char *pkt = NULL;
 
-	while(pkts[offset] != 0x47)
+	while (offset < length && pkts[offset] != 0x47)
 		++offset;
 
-	for (pkt = &pkts[offset]; pkt <= &(pkts[length-188]); pkt += 188)
-	{
-		struct timespec tvNow;
-		clock_gettime(CLOCK_MONOTONIC, &tvNow);
-
+	if (length - offset < 188)
+		return 0;
 
-		double timeNow = tvNow.tv_sec + tvNow.tv_nsec/NANOSECONDS_PER_SECOND;
+	// One clock read per item is enough. All packets of the item are handed over at the same time.
+	struct timespec tvNow;
+	clock_gettime(CLOCK_MONOTONIC, &tvNow);
+	double timeNow = tvNow.tv_sec + tvNow.tv_nsec/NANOSECONDS_PER_SECOND;
 
+	for (pkt = &pkts[offset]; pkt <= &(pkts[length-188]); pkt += 188)
+	{
 		pPvtData->fTSPacketCount++;
 
 		unsigned char const adaptation_field_control = (pkt[3]&0x30)>>4;
@@ -635,6 +825,7 @@ void openavbIntfMpeg2tsFileEndCB(media_q_t *pMediaQ)
 			fclose(pPvtData->pFile);
 			pPvtData->pFile = NULL;
 		}
+		x_mmapClose(pPvtData);
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_INTF);
@@ -687,6 +878,8 @@ extern DLL_EXPORT bool openavbIntfMpeg2tsFileInitialize(media_q_t *pMediaQ, open
 		pIntfCB->intf_get_src_bitrate_cb = openavbIntMpeg2tsGetSrcBitrate;
 
 		pPvtData->ignoreTimestamp = FALSE;
+		pPvtData->useMmap = TRUE;
+		pPvtData->readaheadBytes = DEFAULT_READAHEAD_BYTES;
 
 		pPvtData->fPIDStatusTable = (struct PIDStatus*) calloc(MAX_TABLE_PIDS, sizeof(struct PIDStatus));
 
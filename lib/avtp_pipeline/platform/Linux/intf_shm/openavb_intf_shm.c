@@ -0,0 +1,641 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Shared memory ring interface module.
+*
+* Exposes the media queue to an external process through a single producer,
+* single consumer ring in POSIX shared memory. On a talker the application
+* writes media queue items into the ring and the transmit callback moves one
+* item per call into the media queue. On a listener every item that is due
+* is moved from the media queue into the ring for the application to read.
+*
+* Neither side makes a system call per item. The application can sleep on an
+* eventfd, which this module only writes when the application has flagged
+* in the ring header that it is waiting. The eventfds are passed to the
+* application by a small thread that serves an abstract unix socket.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/eventfd.h>
+#include "openavb_types_pub.h"
+#include "openavb_trace_pub.h"
+#include "openavb_mediaq_pub.h"
+#include "openavb_intf_pub.h"
+#include "openavb_intf_shm_pub.h"
+
+#define	AVB_LOG_COMPONENT	"Shm Interface"
+#include "openavb_log_pub.h"
+
+#define DEFAULT_SLOT_COUNT		64
+#define MAX_SLOT_COUNT			65536
+#define SHM_CACHE_LINE			64
+
+typedef struct {
+	/////////////
+	// Config data
+	/////////////
+	// Name of the ring. Used for the shared memory object and the socket.
+	char *pName;
+
+	// Number of slots in the ring, rounded up to a power of 2
+	U32 slotCount;
+
+	// Ignore timestamp at listener.
+	bool ignoreTimestamp;
+
+	/////////////
+	// Variable data
+	/////////////
+	openavb_shm_hdr_t *pHdr;
+
+	U32 mapSize;
+
+	int dataEvent;
+
+	int spaceEvent;
+
+	// Listening socket that hands the eventfds to applications
+	int listenFd;
+
+	pthread_t acceptThread;
+
+	bool acceptRunning;
+
+	// Items dropped because the application did not keep up
+	U32 overruns;
+
+} pvt_data_t;
+
+static inline U32 x_ringLoad(volatile U32 *pIdx)
+{
+	U32 idx = *pIdx;
+	__sync_synchronize();
+	return idx;
+}
+
+static inline void x_ringStore(volatile U32 *pIdx, U32 idx)
+{
+	__sync_synchronize();
+	*pIdx = idx;
+}
+
+static inline openavb_shm_slot_t *x_slot(openavb_shm_hdr_t *pHdr, U32 idx)
+{
+	return (openavb_shm_slot_t *)((U8 *)pHdr + pHdr->slotOffset + (idx & (pHdr->slotCount - 1)) * pHdr->slotStride);
+}
+
+// Wake the other side if it announced that it is about to sleep. The barrier orders
+// the index update before the read of the flag; the waiter does the opposite.
+static void x_wake(volatile U32 *pWaiting, int eventFd)
+{
+	__sync_synchronize();
+	if (*pWaiting) {
+		U64 one = 1;
+		if (write(eventFd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+			IF_LOG_INTERVAL(1000) AVB_LOGF_ERROR("Unable to signal eventfd: %s", strerror(errno));
+		}
+	}
+}
+
+static void x_sockAddr(const char *pName, struct sockaddr_un *pAddr, socklen_t *pAddrLen)
+{
+	memset(pAddr, 0, sizeof(*pAddr));
+	pAddr->sun_family = AF_UNIX;
+	// Abstract namespace: leading NUL, no file system entry to clean up.
+	int len = snprintf(pAddr->sun_path + 1, sizeof(pAddr->sun_path) - 1, OPENAVB_SHM_NAME_PREFIX "%s", pName);
+	*pAddrLen = offsetof(struct sockaddr_un, sun_path) + 1 + len;
+}
+
+// Hand the eventfds to every application that connects.
+static void *x_acceptThreadFn(void *pv)
+{
+	pvt_data_t *pPvtData = pv;
+
+	while (1) {
+		int fd = accept4(pPvtData->listenFd, NULL, NULL, SOCK_CLOEXEC);
+		if (fd < 0) {
+			if (errno == EINTR || errno == ECONNABORTED) {
+				continue;
+			}
+			// The listening socket was shut down.
+			break;
+		}
+
+		int fds[2] = { pPvtData->dataEvent, pPvtData->spaceEvent };
+		char ctrl[CMSG_SPACE(sizeof(fds))];
+		U8 direction = (U8)pPvtData->pHdr->direction;
+		struct iovec iov = { &direction, sizeof(direction) };
+		struct msghdr msg;
+
+		memset(&msg, 0, sizeof(msg));
+		memset(ctrl, 0, sizeof(ctrl));
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+		msg.msg_control = ctrl;
+		msg.msg_controllen = sizeof(ctrl);
+
+		struct cmsghdr *pCmsg = CMSG_FIRSTHDR(&msg);
+		pCmsg->cmsg_level = SOL_SOCKET;
+		pCmsg->cmsg_type = SCM_RIGHTS;
+		pCmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+		memcpy(CMSG_DATA(pCmsg), fds, sizeof(fds));
+
+		if (sendmsg(fd, &msg, MSG_NOSIGNAL) < 0) {
+			AVB_LOGF_WARNING("Unable to pass eventfds to application: %s", strerror(errno));
+		}
+		close(fd);
+	}
+
+	return NULL;
+}
+
+static void x_ringDestroy(pvt_data_t *pPvtData)
+{
+	if (pPvtData->pHdr) {
+		pPvtData->pHdr->active = FALSE;
+		__sync_synchronize();
+
+		// Wake a sleeping application so it notices the stream stopped.
+		U64 one = 1;
+		if (write(pPvtData->dataEvent, &one, sizeof(one)) < 0 || write(pPvtData->spaceEvent, &one, sizeof(one)) < 0) {
+			AVB_LOGF_WARNING("Unable to signal eventfd: %s", strerror(errno));
+		}
+	}
+
+	if (pPvtData->acceptRunning) {
+		shutdown(pPvtData->listenFd, SHUT_RDWR);
+		pthread_join(pPvtData->acceptThread, NULL);
+		pPvtData->acceptRunning = FALSE;
+	}
+	if (pPvtData->listenFd >= 0) {
+		close(pPvtData->listenFd);
+		pPvtData->listenFd = -1;
+	}
+	if (pPvtData->dataEvent >= 0) {
+		close(pPvtData->dataEvent);
+		pPvtData->dataEvent = -1;
+	}
+	if (pPvtData->spaceEvent >= 0) {
+		close(pPvtData->spaceEvent);
+		pPvtData->spaceEvent = -1;
+	}
+
+	if (pPvtData->pHdr) {
+		char shmName[OPENAVB_SHM_NAME_MAX + 16];
+		snprintf(shmName, sizeof(shmName), "/" OPENAVB_SHM_NAME_PREFIX "%s", pPvtData->pName);
+		munmap(pPvtData->pHdr, pPvtData->mapSize);
+		shm_unlink(shmName);
+		pPvtData->pHdr = NULL;
+	}
+}
+
+static bool x_ringCreate(media_q_t *pMediaQ, openavb_shm_dir_t direction)
+{
+	pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+	char shmName[OPENAVB_SHM_NAME_MAX + 16];
+	U32 slotSize = 0;
+
+	// Slots are sized for a full media queue item.
+	media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
+	if (pMediaQItem) {
+		slotSize = pMediaQItem->itemSize;
+		openavbMediaQHeadUnlock(pMediaQ);
+	}
+	if (!slotSize) {
+		AVB_LOG_ERROR("Unable to determine media queue item size.");
+		return FALSE;
+	}
+
+	U32 slotStride = (sizeof(openavb_shm_slot_t) + slotSize + SHM_CACHE_LINE - 1) & ~(SHM_CACHE_LINE - 1);
+	U32 slotOffset = (sizeof(openavb_shm_hdr_t) + SHM_CACHE_LINE - 1) & ~(SHM_CACHE_LINE - 1);
+	U64 mapSize = slotOffset + (U64)slotStride * pPvtData->slotCount;
+	if (mapSize > 0x7fffffff) {
+		AVB_LOGF_ERROR("Shared memory ring too large: %u slots of %u bytes.", pPvtData->slotCount, slotSize);
+		return FALSE;
+	}
+
+	pPvtData->dataEvent = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	pPvtData->spaceEvent = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (pPvtData->dataEvent < 0 || pPvtData->spaceEvent < 0) {
+		AVB_LOGF_ERROR("Unable to create eventfd: %s", strerror(errno));
+		x_ringDestroy(pPvtData);
+		return FALSE;
+	}
+
+	snprintf(shmName, sizeof(shmName), "/" OPENAVB_SHM_NAME_PREFIX "%s", pPvtData->pName);
+
+	// Remove an object left behind by a previous run so applications never attach to stale data.
+	shm_unlink(shmName);
+	int shmFd = shm_open(shmName, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0660);
+	if (shmFd < 0) {
+		AVB_LOGF_ERROR("Unable to create shared memory %s: %s", shmName, strerror(errno));
+		x_ringDestroy(pPvtData);
+		return FALSE;
+	}
+	if (ftruncate(shmFd, mapSize) < 0) {
+		AVB_LOGF_ERROR("Unable to size shared memory %s: %s", shmName, strerror(errno));
+		close(shmFd);
+		shm_unlink(shmName);
+		x_ringDestroy(pPvtData);
+		return FALSE;
+	}
+	void *pMap = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, shmFd, 0);
+	close(shmFd);
+	if (pMap == MAP_FAILED) {
+		AVB_LOGF_ERROR("Unable to map shared memory %s: %s", shmName, strerror(errno));
+		shm_unlink(shmName);
+		x_ringDestroy(pPvtData);
+		return FALSE;
+	}
+
+	pPvtData->pHdr = pMap;
+	pPvtData->mapSize = (U32)mapSize;
+	pPvtData->pHdr->magic = OPENAVB_SHM_MAGIC;
+	pPvtData->pHdr->version = OPENAVB_SHM_VERSION;
+	pPvtData->pHdr->direction = direction;
+	pPvtData->pHdr->slotCount = pPvtData->slotCount;
+	pPvtData->pHdr->slotSize = slotSize;
+	pPvtData->pHdr->slotStride = slotStride;
+	pPvtData->pHdr->slotOffset = slotOffset;
+
+	struct sockaddr_un addr;
+	socklen_t addrLen;
+	x_sockAddr(pPvtData->pName, &addr, &addrLen);
+	pPvtData->listenFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (pPvtData->listenFd < 0
+		|| bind(pPvtData->listenFd, (struct sockaddr *)&addr, addrLen) < 0
+		|| listen(pPvtData->listenFd, 4) < 0) {
+		AVB_LOGF_ERROR("Unable to create socket " OPENAVB_SHM_NAME_PREFIX "%s: %s", pPvtData->pName, strerror(errno));
+		x_ringDestroy(pPvtData);
+		return FALSE;
+	}
+
+	int err = pthread_create(&pPvtData->acceptThread, NULL, x_acceptThreadFn, pPvtData);
+	if (err) {
+		AVB_LOGF_ERROR("Unable to start shm accept thread: %s", strerror(err));
+		x_ringDestroy(pPvtData);
+		return FALSE;
+	}
+	pPvtData->acceptRunning = TRUE;
+
+	x_ringStore(&pPvtData->pHdr->active, TRUE);
+
+	AVB_LOGF_INFO("Shared memory ring %s: %u slots of %u bytes", shmName, pPvtData->slotCount, slotSize);
+	return TRUE;
+}
+
+// Each configuration name value pair for this interface will result in this callback being called.
+void openavbIntfShmCfgCB(media_q_t *pMediaQ, const char *name, const char *value)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		char *pEnd;
+		long tmp;
+
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return;
+		}
+
+		if (strcmp(name, "intf_nv_shm_name") == 0) {
+			if (strlen(value) == 0 || strlen(value) >= OPENAVB_SHM_NAME_MAX || strchr(value, '/')) {
+				AVB_LOGF_ERROR("Invalid intf_nv_shm_name: %s", value);
+			}
+			else {
+				if (pPvtData->pName) {
+					free(pPvtData->pName);
+				}
+				pPvtData->pName = strdup(value);
+			}
+		}
+
+		else if (strcmp(name, "intf_nv_shm_slots") == 0) {
+			tmp = strtol(value, &pEnd, 10);
+			if (*pEnd != '\0' || tmp < 2 || tmp > MAX_SLOT_COUNT) {
+				AVB_LOGF_ERROR("Invalid intf_nv_shm_slots: %s", value);
+			}
+			else {
+				U32 slotCount = 2;
+				while (slotCount < tmp) {
+					slotCount <<= 1;
+				}
+				pPvtData->slotCount = slotCount;
+			}
+		}
+
+		else if (strcmp(name, "intf_nv_ignore_timestamp") == 0) {
+			tmp = strtol(value, &pEnd, 10);
+			if (*pEnd == '\0' && tmp == 1) {
+				pPvtData->ignoreTimestamp = (tmp == 1);
+			}
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+}
+
+void openavbIntfShmGenInitCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+}
+
+// A call to this callback indicates that this interface module will be
+// a talker. Any talker initialization can be done in this function.
+void openavbIntfShmTxInitCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return;
+		}
+
+		pPvtData->overruns = 0;
+		x_ringCreate(pMediaQ, OPENAVB_SHM_DIR_TALKER);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+}
+
+// This callback will be called for each AVB transmit interval. Moves at most one
+// item so every item gets its own capture time.
+bool openavbIntfShmTxCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF_DETAIL);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return FALSE;
+		}
+
+		openavb_shm_hdr_t *pHdr = pPvtData->pHdr;
+		if (!pHdr) {
+			AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+			return FALSE;
+		}
+
+		U32 tail = pHdr->tail;
+		if (tail == x_ringLoad(&pHdr->head)) {
+			// Nothing written by the application.
+			AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+			return FALSE;
+		}
+
+		media_q_item_t *pMediaQItem = openavbMediaQHeadLock(pMediaQ);
+		if (!pMediaQItem) {
+			AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+			return FALSE;
+		}
+
+		openavb_shm_slot_t *pSlot = x_slot(pHdr, tail);
+		U32 dataLen = pSlot->dataLen;
+		if (dataLen > pMediaQItem->itemSize) {
+			IF_LOG_INTERVAL(1000) AVB_LOGF_ERROR("Shm item too large: %u > %u", dataLen, pMediaQItem->itemSize);
+			dataLen = pMediaQItem->itemSize;
+		}
+		memcpy(pMediaQItem->pPubData, OPENAVB_SHM_SLOT_DATA(pSlot), dataLen);
+		pMediaQItem->dataLen = dataLen;
+
+		if (pSlot->flags & OPENAVB_SHM_SLOT_TIMESTAMP_VALID) {
+			openavbAvtpTimeSetToTimestampNS(pMediaQItem->pAvtpTime, pSlot->timestampNS);
+		}
+		else {
+			openavbAvtpTimeSetToWallTime(pMediaQItem->pAvtpTime);
+		}
+
+		// Give the slot back before pushing, the data has been copied.
+		x_ringStore(&pHdr->tail, tail + 1);
+		x_wake(&pHdr->producerWaiting, pPvtData->spaceEvent);
+
+		if (dataLen) {
+			openavbMediaQHeadPush(pMediaQ);
+		}
+		else {
+			openavbMediaQHeadUnlock(pMediaQ);
+		}
+
+		AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+		return TRUE;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+	return FALSE;
+}
+
+// A call to this callback indicates that this interface module will be
+// a listener. Any listener initialization can be done in this function.
+void openavbIntfShmRxInitCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return;
+		}
+
+		pPvtData->overruns = 0;
+		x_ringCreate(pMediaQ, OPENAVB_SHM_DIR_LISTENER);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+}
+
+// This callback is called when acting as a listener. Moves every item that is due into the ring.
+bool openavbIntfShmRxCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF_DETAIL);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return FALSE;
+		}
+
+		openavb_shm_hdr_t *pHdr = pPvtData->pHdr;
+		if (!pHdr) {
+			AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+			return FALSE;
+		}
+
+		U32 head = pHdr->head;
+		U32 published = 0;
+		media_q_item_t *pMediaQItem;
+
+		while ((pMediaQItem = openavbMediaQTailLock(pMediaQ, pPvtData->ignoreTimestamp)) != NULL) {
+			if (head - x_ringLoad(&pHdr->tail) >= pHdr->slotCount) {
+				// The application is not keeping up. Drop the item rather than let the media queue go stale.
+				pPvtData->overruns++;
+				pHdr->overruns = pPvtData->overruns;
+				IF_LOG_INTERVAL(1000) AVB_LOGF_WARNING("Shm ring full, item dropped. Total: %u", pPvtData->overruns);
+				openavbMediaQTailPull(pMediaQ);
+				continue;
+			}
+
+			openavb_shm_slot_t *pSlot = x_slot(pHdr, head);
+			U32 dataLen = pMediaQItem->dataLen;
+			if (dataLen > pHdr->slotSize) {
+				dataLen = pHdr->slotSize;
+			}
+			memcpy(OPENAVB_SHM_SLOT_DATA(pSlot), pMediaQItem->pPubData, dataLen);
+			pSlot->dataLen = dataLen;
+			pSlot->flags = 0;
+			pSlot->timestampNS = 0;
+			if (openavbAvtpTimeTimestampIsValid(pMediaQItem->pAvtpTime)) {
+				pSlot->flags |= OPENAVB_SHM_SLOT_TIMESTAMP_VALID;
+				pSlot->timestampNS = openavbAvtpTimeGetAvtpTimeNS(pMediaQItem->pAvtpTime);
+			}
+			if (openavbAvtpTimeTimestampIsUncertain(pMediaQItem->pAvtpTime)) {
+				pSlot->flags |= OPENAVB_SHM_SLOT_TIMESTAMP_UNCERTAIN;
+			}
+
+			head++;
+			x_ringStore(&pHdr->head, head);
+			published++;
+			openavbMediaQTailPull(pMediaQ);
+		}
+
+		if (published) {
+			x_wake(&pHdr->consumerWaiting, pPvtData->dataEvent);
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF_DETAIL);
+	return TRUE;
+}
+
+// This callback will be called when the interface needs to be closed. All shutdown should
+// occur in this function.
+void openavbIntfShmEndCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return;
+		}
+
+		if (pPvtData->overruns) {
+			AVB_LOGF_WARNING("Shm ring overruns: %u", pPvtData->overruns);
+		}
+		x_ringDestroy(pPvtData);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+}
+
+void openavbIntfShmGenEndCB(media_q_t *pMediaQ)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+		if (!pPvtData) {
+			AVB_LOG_ERROR("Private interface module data not allocated.");
+			return;
+		}
+
+		if (pPvtData->pName) {
+			free(pPvtData->pName);
+			pPvtData->pName = NULL;
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+}
+
+U32 openavbIntfShmGetXruns(media_q_t *pMediaQ)
+{
+	if (pMediaQ && pMediaQ->pPvtIntfInfo) {
+		return ((pvt_data_t *)pMediaQ->pPvtIntfInfo)->overruns;
+	}
+	return 0;
+}
+
+// Main initialization entry point into the interface module
+extern DLL_EXPORT bool openavbIntfShmInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_INTF);
+
+	if (pMediaQ) {
+		pMediaQ->pPvtIntfInfo = calloc(1, sizeof(pvt_data_t));		// Memory freed by the media queue when the media queue is destroyed.
+
+		if (!pMediaQ->pPvtIntfInfo) {
+			AVB_LOG_ERROR("Unable to allocate memory for AVTP interface module.");
+			return FALSE;
+		}
+
+		pvt_data_t *pPvtData = pMediaQ->pPvtIntfInfo;
+
+		pIntfCB->intf_cfg_cb = openavbIntfShmCfgCB;
+		pIntfCB->intf_gen_init_cb = openavbIntfShmGenInitCB;
+		pIntfCB->intf_tx_init_cb = openavbIntfShmTxInitCB;
+		pIntfCB->intf_tx_cb = openavbIntfShmTxCB;
+		pIntfCB->intf_rx_init_cb = openavbIntfShmRxInitCB;
+		pIntfCB->intf_rx_cb = openavbIntfShmRxCB;
+		pIntfCB->intf_end_cb = openavbIntfShmEndCB;
+		pIntfCB->intf_gen_end_cb = openavbIntfShmGenEndCB;
+		pIntfCB->intf_get_xruns_cb = openavbIntfShmGetXruns;
+
+		pPvtData->pName = strdup("default");
+		pPvtData->slotCount = DEFAULT_SLOT_COUNT;
+		pPvtData->ignoreTimestamp = FALSE;
+		pPvtData->dataEvent = -1;
+		pPvtData->spaceEvent = -1;
+		pPvtData->listenFd = -1;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_INTF);
+	return TRUE;
+}
@@ -0,0 +1,263 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Application side of the shm interface module ring.
+*
+* Linked into external applications, so it only depends on the C library and
+* reports failures through return values instead of the AVB log.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "openavb_types_pub.h"
+#include "openavb_intf_shm_pub.h"
+
+static inline U32 x_ringLoad(volatile U32 *pIdx)
+{
+	U32 idx = *pIdx;
+	__sync_synchronize();
+	return idx;
+}
+
+static inline void x_ringStore(volatile U32 *pIdx, U32 idx)
+{
+	__sync_synchronize();
+	*pIdx = idx;
+}
+
+static inline openavb_shm_slot_t *x_slot(openavb_shm_hdr_t *pHdr, U32 idx)
+{
+	return (openavb_shm_slot_t *)((U8 *)pHdr + pHdr->slotOffset + (idx & (pHdr->slotCount - 1)) * pHdr->slotStride);
+}
+
+// Receive the data and space eventfds from the interface module.
+static bool x_recvEvents(openavb_shm_client_t *pClient, const char *pName)
+{
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	int len = snprintf(addr.sun_path + 1, sizeof(addr.sun_path) - 1, OPENAVB_SHM_NAME_PREFIX "%s", pName);
+	socklen_t addrLen = offsetof(struct sockaddr_un, sun_path) + 1 + len;
+
+	int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		return FALSE;
+	}
+	if (connect(fd, (struct sockaddr *)&addr, addrLen) < 0) {
+		close(fd);
+		return FALSE;
+	}
+
+	int fds[2];
+	char ctrl[CMSG_SPACE(sizeof(fds))];
+	U8 direction;
+	struct iovec iov = { &direction, sizeof(direction) };
+	struct msghdr msg;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = ctrl;
+	msg.msg_controllen = sizeof(ctrl);
+
+	ssize_t rslt = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+	close(fd);
+	if (rslt <= 0) {
+		return FALSE;
+	}
+
+	struct cmsghdr *pCmsg = CMSG_FIRSTHDR(&msg);
+	if (!pCmsg || pCmsg->cmsg_level != SOL_SOCKET || pCmsg->cmsg_type != SCM_RIGHTS
+		|| pCmsg->cmsg_len != CMSG_LEN(sizeof(fds))) {
+		return FALSE;
+	}
+	memcpy(fds, CMSG_DATA(pCmsg), sizeof(fds));
+	pClient->dataEvent = fds[0];
+	pClient->spaceEvent = fds[1];
+	return TRUE;
+}
+
+bool openavbShmClientOpen(openavb_shm_client_t *pClient, const char *pName)
+{
+	char shmName[OPENAVB_SHM_NAME_MAX + 16];
+	struct stat st;
+
+	memset(pClient, 0, sizeof(*pClient));
+	pClient->dataEvent = -1;
+	pClient->spaceEvent = -1;
+
+	snprintf(shmName, sizeof(shmName), "/" OPENAVB_SHM_NAME_PREFIX "%s", pName);
+	int shmFd = shm_open(shmName, O_RDWR | O_CLOEXEC, 0);
+	if (shmFd < 0) {
+		return FALSE;
+	}
+	if (fstat(shmFd, &st) < 0 || st.st_size < (off_t)sizeof(openavb_shm_hdr_t)) {
+		close(shmFd);
+		return FALSE;
+	}
+	void *pMap = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, shmFd, 0);
+	close(shmFd);
+	if (pMap == MAP_FAILED) {
+		return FALSE;
+	}
+	pClient->pHdr = pMap;
+	pClient->mapSize = (U32)st.st_size;
+
+	openavb_shm_hdr_t *pHdr = pClient->pHdr;
+	if (pHdr->magic != OPENAVB_SHM_MAGIC || pHdr->version != OPENAVB_SHM_VERSION
+		|| pHdr->slotOffset + (U64)pHdr->slotStride * pHdr->slotCount > pClient->mapSize
+		|| !x_recvEvents(pClient, pName)) {
+		openavbShmClientClose(pClient);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+void openavbShmClientClose(openavb_shm_client_t *pClient)
+{
+	if (pClient->pHdr) {
+		munmap(pClient->pHdr, pClient->mapSize);
+		pClient->pHdr = NULL;
+	}
+	if (pClient->dataEvent >= 0) {
+		close(pClient->dataEvent);
+		pClient->dataEvent = -1;
+	}
+	if (pClient->spaceEvent >= 0) {
+		close(pClient->spaceEvent);
+		pClient->spaceEvent = -1;
+	}
+}
+
+openavb_shm_slot_t *openavbShmClientReserve(openavb_shm_client_t *pClient)
+{
+	openavb_shm_hdr_t *pHdr = pClient->pHdr;
+	U32 head = pHdr->head;
+	if (head - x_ringLoad(&pHdr->tail) >= pHdr->slotCount) {
+		return NULL;
+	}
+	return x_slot(pHdr, head);
+}
+
+void openavbShmClientPublish(openavb_shm_client_t *pClient)
+{
+	// The talker polls the ring every transmit interval, so it is never woken.
+	x_ringStore(&pClient->pHdr->head, pClient->pHdr->head + 1);
+}
+
+openavb_shm_slot_t *openavbShmClientPeek(openavb_shm_client_t *pClient)
+{
+	openavb_shm_hdr_t *pHdr = pClient->pHdr;
+	U32 tail = pHdr->tail;
+	if (tail == x_ringLoad(&pHdr->head)) {
+		return NULL;
+	}
+	return x_slot(pHdr, tail);
+}
+
+void openavbShmClientRelease(openavb_shm_client_t *pClient)
+{
+	// The listener never waits for space, it drops items when the ring is full.
+	x_ringStore(&pClient->pHdr->tail, pClient->pHdr->tail + 1);
+}
+
+static bool x_ready(openavb_shm_hdr_t *pHdr)
+{
+	if (pHdr->direction == OPENAVB_SHM_DIR_TALKER) {
+		return pHdr->head - x_ringLoad(&pHdr->tail) < pHdr->slotCount;
+	}
+	return pHdr->tail != x_ringLoad(&pHdr->head);
+}
+
+static int x_elapsedMsec(const struct timespec *pStart)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (int)((now.tv_sec - pStart->tv_sec) * 1000 + (now.tv_nsec - pStart->tv_nsec) / 1000000);
+}
+
+bool openavbShmClientWait(openavb_shm_client_t *pClient, int timeoutMsec)
+{
+	openavb_shm_hdr_t *pHdr = pClient->pHdr;
+	bool talker = (pHdr->direction == OPENAVB_SHM_DIR_TALKER);
+	volatile U32 *pWaiting = talker ? &pHdr->producerWaiting : &pHdr->consumerWaiting;
+	int eventFd = talker ? pClient->spaceEvent : pClient->dataEvent;
+	struct timespec start;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	while (1) {
+		// Items left in the ring can still be read after the stream stopped.
+		if (x_ready(pHdr)) {
+			return TRUE;
+		}
+		if (!pHdr->active) {
+			return FALSE;
+		}
+
+		// Announce the sleep, then look again so a concurrent update is not missed.
+		*pWaiting = TRUE;
+		__sync_synchronize();
+		if (!x_ready(pHdr) && pHdr->active) {
+			int waitMsec = timeoutMsec;
+			if (timeoutMsec >= 0) {
+				waitMsec = timeoutMsec - x_elapsedMsec(&start);
+				if (waitMsec <= 0) {
+					*pWaiting = FALSE;
+					return FALSE;
+				}
+			}
+
+			// A wakeup may be left over from an earlier wait, so loop until the ring is ready.
+			struct pollfd pfd = { eventFd, POLLIN, 0 };
+			if (poll(&pfd, 1, waitMsec) > 0) {
+				U64 count;
+				if (read(eventFd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+					*pWaiting = FALSE;
+					return FALSE;
+				}
+			}
+		}
+		*pWaiting = FALSE;
+	}
+}
@@ -0,0 +1,202 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* HEADER SUMMARY : Shared memory ring interface module public interface.
+*
+* Layout of the shared memory ring used by the shm interface module and the
+* functions an external application uses to feed a talker or consume a
+* listener through it.
+*/
+
+#ifndef OPENAVB_INTF_SHM_PUB_H
+#define OPENAVB_INTF_SHM_PUB_H 1
+
+#include "openavb_types_pub.h"
+
+/** \file
+ * Shared memory ring of the shm interface module.
+ *
+ * The ring lives in the POSIX shared memory object "/openavb_shm_<name>",
+ * where name is set with intf_nv_shm_name. It holds slotCount slots. Each slot
+ * carries one media queue item: an openavb_shm_slot_t header followed by up to
+ * slotSize bytes of data in the format of the mapping module.
+ *
+ * There is exactly one producer and one consumer. The producer fills the slot
+ * at index head and then advances head. The consumer reads the slot at index
+ * tail and then advances tail. Both indexes run freely and are taken modulo
+ * slotCount. For a talker the external application is the producer; for a
+ * listener it is the consumer.
+ *
+ * A side that finds the ring empty (consumer) or full (producer) may sleep.
+ * It sets its waiting flag, checks the ring once more and then reads its
+ * eventfd. The other side only writes the eventfd when the flag is set, so no
+ * system call is made per item while both sides keep up. The eventfds are
+ * passed to the application over the abstract unix socket
+ * "\0openavb_shm_<name>".
+ */
+
+/// Value of openavb_shm_hdr_t.magic
+#define OPENAVB_SHM_MAGIC				0x4d535641
+/// Value of openavb_shm_hdr_t.version
+#define OPENAVB_SHM_VERSION				1
+/// Prefix of the shared memory object and socket names
+#define OPENAVB_SHM_NAME_PREFIX			"openavb_shm_"
+/// Maximum length of intf_nv_shm_name
+#define OPENAVB_SHM_NAME_MAX			64
+
+/// Direction of the ring
+typedef enum {
+	/// The application writes items that the talker sends
+	OPENAVB_SHM_DIR_TALKER = 0,
+	/// The listener writes items that the application reads
+	OPENAVB_SHM_DIR_LISTENER = 1,
+} openavb_shm_dir_t;
+
+/// openavb_shm_slot_t.timestampNS holds a valid gPTP time
+#define OPENAVB_SHM_SLOT_TIMESTAMP_VALID		0x00000001
+/// The listener reported the timestamp as uncertain
+#define OPENAVB_SHM_SLOT_TIMESTAMP_UNCERTAIN	0x00000002
+
+/// Header of every slot, followed by the item data
+typedef struct {
+	/// Number of valid data bytes
+	U32 dataLen;
+	/// OPENAVB_SHM_SLOT_* flags
+	U32 flags;
+	/// Capture time (talker) or presentation time (listener) in gPTP nanoseconds.
+	/// A talker uses the current gPTP time if OPENAVB_SHM_SLOT_TIMESTAMP_VALID is not set.
+	U64 timestampNS;
+} openavb_shm_slot_t;
+
+/// Header at the start of the shared memory object. The producer and consumer
+/// indexes are on separate cache lines.
+typedef struct {
+	/// OPENAVB_SHM_MAGIC
+	U32 magic;
+	/// OPENAVB_SHM_VERSION
+	U32 version;
+	/// openavb_shm_dir_t
+	U32 direction;
+	/// Number of slots, a power of 2
+	U32 slotCount;
+	/// Maximum data bytes per slot
+	U32 slotSize;
+	/// Distance in bytes between slots
+	U32 slotStride;
+	/// Offset of the first slot from the start of the object
+	U32 slotOffset;
+	/// Cleared by the interface module when the stream stops
+	volatile U32 active;
+	U8 reserved0[32];
+
+	/// Slots published by the producer
+	volatile U32 head;
+	/// Set by a producer that is about to sleep on the space eventfd
+	volatile U32 producerWaiting;
+	U8 reserved1[56];
+
+	/// Slots released by the consumer
+	volatile U32 tail;
+	/// Set by a consumer that is about to sleep on the data eventfd
+	volatile U32 consumerWaiting;
+	U8 reserved2[56];
+
+	/// Items the listener could not store because the ring was full
+	volatile U32 overruns;
+	U8 reserved3[60];
+} openavb_shm_hdr_t;
+
+/// Pointer to the data of a slot
+#define OPENAVB_SHM_SLOT_DATA(pSlot)	((U8 *)(pSlot) + sizeof(openavb_shm_slot_t))
+
+/// Application side of a ring
+typedef struct {
+	/// Mapped shared memory object
+	openavb_shm_hdr_t *pHdr;
+	/// Size of the mapping
+	U32 mapSize;
+	/// Signaled when the ring becomes non empty
+	int dataEvent;
+	/// Signaled when the ring becomes non full
+	int spaceEvent;
+} openavb_shm_client_t;
+
+/** Attach to the ring of a running stream.
+ *
+ * \param pClient Client state to initialize
+ * \param pName The intf_nv_shm_name of the stream
+ * \return TRUE on success
+ */
+bool openavbShmClientOpen(openavb_shm_client_t *pClient, const char *pName);
+
+/** Detach from the ring.
+ *
+ * \param pClient Client state from openavbShmClientOpen()
+ */
+void openavbShmClientClose(openavb_shm_client_t *pClient);
+
+/** Get the next free slot of a talker ring.
+ *
+ * \param pClient Client state from openavbShmClientOpen()
+ * \return The slot to fill, or NULL if the ring is full
+ */
+openavb_shm_slot_t *openavbShmClientReserve(openavb_shm_client_t *pClient);
+
+/** Hand the slot from openavbShmClientReserve() to the talker.
+ *
+ * \param pClient Client state from openavbShmClientOpen()
+ */
+void openavbShmClientPublish(openavb_shm_client_t *pClient);
+
+/** Get the oldest item of a listener ring.
+ *
+ * \param pClient Client state from openavbShmClientOpen()
+ * \return The slot to read, or NULL if the ring is empty
+ */
+openavb_shm_slot_t *openavbShmClientPeek(openavb_shm_client_t *pClient);
+
+/** Return the slot from openavbShmClientPeek() to the listener.
+ *
+ * \param pClient Client state from openavbShmClientOpen()
+ */
+void openavbShmClientRelease(openavb_shm_client_t *pClient);
+
+/** Sleep until a slot can be reserved (talker) or peeked (listener).
+ *
+ * \param pClient Client state from openavbShmClientOpen()
+ * \param timeoutMsec Maximum time to wait, -1 to wait forever
+ * \return TRUE if the ring is ready, FALSE on timeout or when the stream stopped
+ *         and no items are left
+ */
+bool openavbShmClientWait(openavb_shm_client_t *pClient, int timeoutMsec);
+
+#endif // OPENAVB_INTF_SHM_PUB_H
@@ -35,12 +35,20 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 * This interface module is narrowly focused to read a common wav file format
 * and send the data samples to mapping modules.
 *
+* On the talker the file is read by a prefetch thread into a single producer,
+* single consumer ring so the transmit callback only copies from memory and
+* never waits on the disk. A playlist of wav files can be played in sequence
+* and optionally looped.
+*
 */
 
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
 #include "openavb_types_pub.h"
 #include "openavb_trace_pub.h"
 #include "openavb_mediaq_pub.h"
@@ -73,6 +81,16 @@ typedef struct {
 
 } wav_file_header_t;
 
+// Default size of the prefetch ring in bytes. Rounded up to a power of 2.
+#define DEFAULT_PREFETCH_SIZE			(1024 * 1024)
+#define MIN_PREFETCH_SIZE				(64 * 1024)
+
+// Largest single read done by the prefetch thread.
+#define PREFETCH_READ_SIZE				(64 * 1024)
+
+// Time the prefetch thread sleeps when the ring is full.
+#define PREFETCH_IDLE_USEC				5000
+
 
 typedef struct {
 	/////////////
@@ -81,11 +99,49 @@ typedef struct {
 	// intf_nv_file_name: The fully qualified file name used both the talker and listener.
 	char *pFileName;
 
+	// intf_nv_playlist: File with one wav file name per line, played in sequence.
+	char **ppPlaylist;
+	U32 playlistCount;
+
+	// intf_nv_loop: Restart from the first file after the last one.
+	bool loop;
+
+	// intf_nv_prefetch: Read the file on a separate thread ahead of the talker.
+	bool prefetch;
+
+	// intf_nv_prefetch_size: Size of the prefetch ring in bytes.
+	U32 prefetchSize;
+
 	/////////////
 	// Variable data
 	/////////////
 	FILE *pFile;
 
+	// Format of the first file. Other playlist entries must match.
+	wav_file_header_t wavFormat;
+
+	// Playlist entry currently open and data bytes left in it.
+	U32 playlistIdx;
+	U32 dataRemaining;
+
+	// Set once the last file has been read and looping is off.
+	bool endOfData;
+
+	// Prefetch ring. ringHead and ringTail are free running byte counts,
+	// ringHead written only by the prefetch thread and ringTail only by the
+	// talker.
+	U8 *pRing;
+	U32 ringSize;
+	volatile U32 ringHead;
+	volatile U32 ringTail;
+	volatile U32 prefetchDone;
+	volatile bool prefetchStop;
+	bool prefetchRunning;
+	pthread_t prefetchThread;
+
+	// Items that could not be filled from the ring in time.
+	U32 underruns;
+
 	// ALSA read/write interval
 	U32 intervalCounter;
 
@@ -127,6 +183,154 @@ static inline void ifwrite(void *ptr, size_t size, size_t num, FILE *stream)
     }
 }
 
+// Read and validate the header of a wav file. The file is left positioned at the start of the data.
+static bool x_readWavHeader(FILE *pFile, const char *pFileName, wav_file_header_t *pWavFileHeader)
+{
+	// RIFF Chunk
+	ifread(pWavFileHeader->chunkID, sizeof(pWavFileHeader->chunkID), 1, pFile);
+	ifread(&pWavFileHeader->chunkSize, sizeof(pWavFileHeader->chunkSize), 1, pFile);
+	ifread(pWavFileHeader->format, sizeof(pWavFileHeader->format), 1, pFile);
+
+	// FMT sub Chunk
+	ifread(pWavFileHeader->subChunk1ID, sizeof(pWavFileHeader->subChunk1ID), 1, pFile);
+	ifread(&pWavFileHeader->subChunk1Size, sizeof(pWavFileHeader->subChunk1Size), 1, pFile);
+	ifread(&pWavFileHeader->audioFormat, sizeof(pWavFileHeader->audioFormat), 1, pFile);
+	ifread(&pWavFileHeader->numberChannels, sizeof(pWavFileHeader->numberChannels), 1, pFile);
+	ifread(&pWavFileHeader->sampleRate, sizeof(pWavFileHeader->sampleRate), 1, pFile);
+	ifread(&pWavFileHeader->byteRate, sizeof(pWavFileHeader->byteRate), 1, pFile);
+	ifread(&pWavFileHeader->blockAlign, sizeof(pWavFileHeader->blockAlign), 1, pFile);
+	ifread(&pWavFileHeader->bitsPerSample, sizeof(pWavFileHeader->bitsPerSample), 1, pFile);
+
+	// Data sub Chunk
+	ifread(pWavFileHeader->subChunk2ID, sizeof(pWavFileHeader->subChunk2ID), 1, pFile);
+	ifread(&pWavFileHeader->subChunk2Size, sizeof(pWavFileHeader->subChunk2Size), 1, pFile);
+
+	// Make sure wav file format is supported
+	if (memcmp(pWavFileHeader->chunkID, "RIFF", 4) != 0
+		|| memcmp(pWavFileHeader->format, "WAVE", 4) != 0
+		|| memcmp(pWavFileHeader->subChunk1ID, "fmt ", 4) != 0
+		|| memcmp(pWavFileHeader->subChunk2ID, "data", 4) != 0
+		|| pWavFileHeader->audioFormat != 1) {
+		AVB_LOGF_ERROR("%s does not appear to be a supported wav file.", pFileName);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static const char *x_playlistFileName(pvt_data_t *pPvtData, U32 idx)
+{
+	if (pPvtData->playlistCount > 0) {
+		return pPvtData->ppPlaylist[idx];
+	}
+	return pPvtData->pFileName;
+}
+
+// Open playlist entry idx and position it at the start of its data.
+static bool x_openPlaylistFile(pvt_data_t *pPvtData, U32 idx)
+{
+	const char *pFileName = x_playlistFileName(pPvtData, idx);
+	wav_file_header_t wavFileHeader;
+
+	if (pPvtData->pFile) {
+		fclose(pPvtData->pFile);
+		pPvtData->pFile = NULL;
+	}
+	pPvtData->playlistIdx = idx;
+	pPvtData->dataRemaining = 0;
+
+	if (!pFileName) {
+		return FALSE;
+	}
+
+	pPvtData->pFile = fopen(pFileName, "rb");
+	if (!pPvtData->pFile) {
+		AVB_LOGF_ERROR("Unable to open input file: %s", pFileName);
+		return FALSE;
+	}
+
+	if (!x_readWavHeader(pPvtData->pFile, pFileName, &wavFileHeader)) {
+		fclose(pPvtData->pFile);
+		pPvtData->pFile = NULL;
+		return FALSE;
+	}
+
+	if (wavFileHeader.sampleRate != pPvtData->wavFormat.sampleRate
+		|| wavFileHeader.numberChannels != pPvtData->wavFormat.numberChannels
+		|| wavFileHeader.bitsPerSample != pPvtData->wavFormat.bitsPerSample) {
+		AVB_LOGF_ERROR("%s does not match the format of the first wav file. Skipping.", pFileName);
+		fclose(pPvtData->pFile);
+		pPvtData->pFile = NULL;
+		return FALSE;
+	}
+
+	posix_fadvise(fileno(pPvtData->pFile), 0, 0, POSIX_FADV_SEQUENTIAL);
+
+	pPvtData->dataRemaining = wavFileHeader.subChunk2Size;
+	return TRUE;
+}
+
+// Move to the next playlist entry that can be opened. Returns FALSE at the end of the
+// playlist when not looping or when no entry can be opened.
+static bool x_nextPlaylistFile(pvt_data_t *pPvtData)
+{
+	U32 count = pPvtData->playlistCount > 0 ? pPvtData->playlistCount : 1;
+	U32 tries;
+
+	for (tries = 0; tries < count; tries++) {
+		U32 idx = pPvtData->playlistIdx + 1;
+		if (idx >= count) {
+			if (!pPvtData->loop) {
+				return FALSE;
+			}
+			idx = 0;
+		}
+		if (x_openPlaylistFile(pPvtData, idx)) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+// Read up to len bytes of sample data, continuing across playlist entries.
+static U32 x_readData(pvt_data_t *pPvtData, U8 *pBuf, U32 len)
+{
+	U32 total = 0;
+	U32 emptyFiles = 0;
+	U32 count = pPvtData->playlistCount > 0 ? pPvtData->playlistCount : 1;
+
+	while (total < len && !pPvtData->endOfData) {
+		if (!pPvtData->pFile || pPvtData->dataRemaining == 0) {
+			// Guard against looping forever over files that hold no data.
+			if (emptyFiles++ > count || !x_nextPlaylistFile(pPvtData)) {
+				pPvtData->endOfData = TRUE;
+				break;
+			}
+			continue;
+		}
+
+		U32 want = len - total;
+		if (want > pPvtData->dataRemaining) {
+			want = pPvtData->dataRemaining;
+		}
+
+		U32 bytesRead = fread(pBuf + total, 1, want, pPvtData->pFile);
+		if (bytesRead < want) {
+			// Data chunk shorter than the header claims.
+			pPvtData->dataRemaining = 0;
+		}
+		else {
+			pPvtData->dataRemaining -= bytesRead;
+		}
+		if (bytesRead > 0) {
+			emptyFiles = 0;
+		}
+		total += bytesRead;
+	}
+
+	return total;
+}
+
 static void x_parseWaveFile(media_q_t *pMediaQ)
 {
 	if (pMediaQ) {
@@ -141,6 +345,9 @@ static void x_parseWaveFile(media_q_t *pMediaQ)
 			return;
 		}
 
+		if (pPvtData->pFile) {
+			fclose(pPvtData->pFile);
+		}
 		pPvtData->pFile = fopen(pPvtData->pFileName, "rb");
 		if (!pPvtData->pFile) {
 			AVB_LOGF_ERROR("Unable to open input file: %s", pPvtData->pFileName);
@@ -149,63 +356,19 @@ static void x_parseWaveFile(media_q_t *pMediaQ)
 
 		// Check if wav file format is valid and of a supported type.
 		wav_file_header_t wavFileHeader;
-
-		// RIFF Chunk
-		ifread(wavFileHeader.chunkID, sizeof(wavFileHeader.chunkID), 1, pPvtData->pFile);
-		ifread(&wavFileHeader.chunkSize, sizeof(wavFileHeader.chunkSize), 1, pPvtData->pFile);
-		ifread(wavFileHeader.format, sizeof(wavFileHeader.format), 1, pPvtData->pFile);
-
-		// FMT sub Chunk
-		ifread(wavFileHeader.subChunk1ID, sizeof(wavFileHeader.subChunk1ID), 1, pPvtData->pFile);
-		ifread(&wavFileHeader.subChunk1Size, sizeof(wavFileHeader.subChunk1Size), 1, pPvtData->pFile);
-		ifread(&wavFileHeader.audioFormat, sizeof(wavFileHeader.audioFormat), 1, pPvtData->pFile);
-		ifread(&wavFileHeader.numberChannels, sizeof(wavFileHeader.numberChannels), 1, pPvtData->pFile);
-		ifread(&wavFileHeader.sampleRate, sizeof(wavFileHeader.sampleRate), 1, pPvtData->pFile);
-		ifread(&wavFileHeader.byteRate, sizeof(wavFileHeader.byteRate), 1, pPvtData->pFile);
-		ifread(&wavFileHeader.blockAlign, sizeof(wavFileHeader.blockAlign), 1, pPvtData->pFile);
-		ifread(&wavFileHeader.bitsPerSample, sizeof(wavFileHeader.bitsPerSample), 1, pPvtData->pFile);
-
-		// Data sub Chunk
-		ifread(wavFileHeader.subChunk2ID, sizeof(wavFileHeader.subChunk2ID), 1, pPvtData->pFile);
-		ifread(&wavFileHeader.subChunk2Size, sizeof(wavFileHeader.subChunk2Size), 1, pPvtData->pFile);
+		bool valid = x_readWavHeader(pPvtData->pFile, pPvtData->pFileName, &wavFileHeader);
 
 		AVB_LOGF_INFO("Number of data bytes:%d", wavFileHeader.subChunk2Size);
 
-		// Make sure wav file format is supported
-		if (memcmp(wavFileHeader.chunkID, "RIFF", 4) != 0) {
-			AVB_LOGF_ERROR("%s does not appear to be a supported wav file.", pPvtData->pFileName);
+		if (!valid) {
 			fclose(pPvtData->pFile);
 			pPvtData->pFile = NULL;
 			return;
 		}
 
-		if (memcmp(wavFileHeader.format, "WAVE", 4) != 0) {
-			AVB_LOGF_ERROR("%s does not appear to be a supported wav file.", pPvtData->pFileName);
-			fclose(pPvtData->pFile);
-			pPvtData->pFile = NULL;
-			return;
-		}
-
-		if (memcmp(wavFileHeader.subChunk1ID, "fmt ", 4) != 0) {
-			AVB_LOGF_ERROR("%s does not appear to be a supported wav file.", pPvtData->pFileName);
-			fclose(pPvtData->pFile);
-			pPvtData->pFile = NULL;
-			return;
-		}
-
-		if (memcmp(wavFileHeader.subChunk2ID, "data", 4) != 0) {
-			AVB_LOGF_ERROR("%s does not appear to be a supported wav file.", pPvtData->pFileName);
-			fclose(pPvtData->pFile);
-			pPvtData->pFile = NULL;
-			return;
-		}
-
-		if (wavFileHeader.audioFormat != 1) {
-			AVB_LOGF_ERROR("%s does not appear to be a supported wav file.", pPvtData->pFileName);
-			fclose(pPvtData->pFile);
-			pPvtData->pFile = NULL;
-			return;
-		}
+		pPvtData->wavFormat = wavFileHeader;
+		pPvtData->playlistIdx = 0;
+		pPvtData->dataRemaining = wavFileHeader.subChunk2Size;
 
 		// Give the audio parameters to the mapping module.
 		if (pMediaQ->pMediaQDataFormat) {
@@ -230,6 +393,202 @@ static void x_parseWaveFile(media_q_t *pMediaQ)
 	}
 }
 
+static void x_freePlaylist(pvt_data_t *pPvtData)
+{
+	U32 i1;
+	for (i1 = 0; i1 < pPvtData->playlistCount; i1++) {
+		free(pPvtData->ppPlaylist[i1]);
+	}
+	free(pPvtData->ppPlaylist);
+	pPvtData->ppPlaylist = NULL;
+	pPvtData->playlistCount = 0;
+}
+
+// Load a playlist file. One wav file name per line. Empty lines and lines starting with # are ignored.
+static bool x_loadPlaylist(pvt_data_t *pPvtData, const char *pPlaylistName)
+{
+	FILE *pPlaylist = fopen(pPlaylistName, "r");
+	char line[1024];
+
+	if (!pPlaylist) {
+		AVB_LOGF_ERROR("Unable to open playlist: %s", pPlaylistName);
+		return FALSE;
+	}
+
+	x_freePlaylist(pPvtData);
+
+	while (fgets(line, sizeof(line), pPlaylist)) {
+		char *pStart = line;
+		char *pEnd;
+
+		while (*pStart == ' ' || *pStart == '\t') {
+			pStart++;
+		}
+		pEnd = pStart + strlen(pStart);
+		while (pEnd > pStart && (pEnd[-1] == '\n' || pEnd[-1] == '\r' || pEnd[-1] == ' ' || pEnd[-1] == '\t')) {
+			*--pEnd = '\0';
+		}
+		if (*pStart == '\0' || *pStart == '#') {
+			continue;
+		}
+
+		char **ppPlaylist = realloc(pPvtData->ppPlaylist, (pPvtData->playlistCount + 1) * sizeof(char *));
+		if (!ppPlaylist) {
+			AVB_LOG_ERROR("Unable to allocate memory for playlist.");
+			break;
+		}
+		pPvtData->ppPlaylist = ppPlaylist;
+		pPvtData->ppPlaylist[pPvtData->playlistCount++] = strdup(pStart);
+	}
+	fclose(pPlaylist);
+
+	if (pPvtData->playlistCount == 0) {
+		AVB_LOGF_ERROR("Playlist is empty: %s", pPlaylistName);
+		return FALSE;
+	}
+
+	AVB_LOGF_INFO("Playlist %s: %u files", pPlaylistName, pPvtData->playlistCount);
+	return TRUE;
+}
+
+static inline U32 x_ringLoad(volatile U32 *pIdx)
+{
+	U32 idx = *pIdx;
+	__sync_synchronize();
+	return idx;
+}
+
+static inline void x_ringStore(volatile U32 *pIdx, U32 idx)
+{
+	__sync_synchronize();
+	*pIdx = idx;
+}
+
+// Fill up to maxBytes of the free space in the prefetch ring from the file. Called only
+// by the producer. Returns FALSE once the end of the data has been reached.
+static bool x_prefetchFill(pvt_data_t *pPvtData, U32 maxBytes)
+{
+	U32 head = pPvtData->ringHead;
+	U32 space = pPvtData->ringSize - (head - x_ringLoad(&pPvtData->ringTail));
+	if (space > maxBytes) {
+		space = maxBytes;
+	}
+
+	while (space > 0) {
+		U32 offset = head & (pPvtData->ringSize - 1);
+		U32 len = pPvtData->ringSize - offset;
+		if (len > space) {
+			len = space;
+		}
+
+		U32 bytesRead = x_readData(pPvtData, pPvtData->pRing + offset, len);
+		head += bytesRead;
+		space -= bytesRead;
+		x_ringStore(&pPvtData->ringHead, head);
+
+		if (bytesRead < len) {
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+static void *x_prefetchThreadFn(void *pv)
+{
+	pvt_data_t *pPvtData = pv;
+
+	while (!pPvtData->prefetchStop) {
+		U32 used = x_ringLoad(&pPvtData->ringHead) - x_ringLoad(&pPvtData->ringTail);
+		if (pPvtData->ringSize - used < PREFETCH_READ_SIZE) {
+			usleep(PREFETCH_IDLE_USEC);
+			continue;
+		}
+
+		if (!x_prefetchFill(pPvtData, PREFETCH_READ_SIZE)) {
+			break;
+		}
+	}
+
+	x_ringStore(&pPvtData->prefetchDone, TRUE);
+	return NULL;
+}
+
+static void x_prefetchStop(pvt_data_t *pPvtData)
+{
+	if (pPvtData->prefetchRunning) {
+		pPvtData->prefetchStop = TRUE;
+		pthread_join(pPvtData->prefetchThread, NULL);
+		pPvtData->prefetchRunning = FALSE;
+	}
+	if (pPvtData->pRing) {
+		free(pPvtData->pRing);
+		pPvtData->pRing = NULL;
+	}
+}
+
+static bool x_prefetchStart(pvt_data_t *pPvtData)
+{
+	U32 ringSize = MIN_PREFETCH_SIZE;
+	while (ringSize < pPvtData->prefetchSize && ringSize < 0x80000000) {
+		ringSize <<= 1;
+	}
+
+	pPvtData->pRing = malloc(ringSize);
+	if (!pPvtData->pRing) {
+		AVB_LOG_ERROR("Unable to allocate memory for prefetch ring.");
+		return FALSE;
+	}
+	pPvtData->ringSize = ringSize;
+	pPvtData->ringHead = 0;
+	pPvtData->ringTail = 0;
+	pPvtData->prefetchStop = FALSE;
+	pPvtData->prefetchDone = FALSE;
+
+	// Prime the ring before the talker starts pulling from it.
+	if (!x_prefetchFill(pPvtData, ringSize)) {
+		// Everything fits in the ring. No thread needed.
+		pPvtData->prefetchDone = TRUE;
+		return TRUE;
+	}
+
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+	int err = pthread_create(&pPvtData->prefetchThread, &attr, x_prefetchThreadFn, pPvtData);
+	pthread_attr_destroy(&attr);
+	if (err) {
+		AVB_LOGF_ERROR("Unable to start prefetch thread: %s", strerror(err));
+		free(pPvtData->pRing);
+		pPvtData->pRing = NULL;
+		return FALSE;
+	}
+	pPvtData->prefetchRunning = TRUE;
+
+	AVB_LOGF_INFO("Prefetch ring: %u bytes", ringSize);
+	return TRUE;
+}
+
+// Copy up to len bytes out of the prefetch ring. Called only by the talker.
+static U32 x_prefetchRead(pvt_data_t *pPvtData, U8 *pBuf, U32 len)
+{
+	U32 tail = pPvtData->ringTail;
+	U32 avail = x_ringLoad(&pPvtData->ringHead) - tail;
+	if (len > avail) {
+		len = avail;
+	}
+
+	U32 offset = tail & (pPvtData->ringSize - 1);
+	U32 first = pPvtData->ringSize - offset;
+	if (first > len) {
+		first = len;
+	}
+	memcpy(pBuf, pPvtData->pRing + offset, first);
+	memcpy(pBuf + first, pPvtData->pRing, len - first);
+
+	x_ringStore(&pPvtData->ringTail, tail + len);
+	return len;
+}
+
 static void passParamToMapModule(media_q_t *pMediaQ)
 {
     if (pMediaQ) {
@@ -372,6 +731,30 @@ void openavbIntfWavFileCfgCB(media_q_t *pMediaQ, const char *name, const char *v
                 AVB_LOG_ERROR("Invalid number of data bytes for intf_nv_number_of_data_bytes.");
             }
         }
+        else if (strcmp(name, "intf_nv_playlist") == 0) {
+            if (x_loadPlaylist(pPvtData, value)) {
+                if (pPvtData->pFileName) {
+                    free(pPvtData->pFileName);
+                }
+                pPvtData->pFileName = strdup(pPvtData->ppPlaylist[0]);
+                x_parseWaveFile(pMediaQ);
+            }
+        }
+        else if (strcmp(name, "intf_nv_loop") == 0) {
+            pPvtData->loop = strtol(value, &pEnd, 10) != 0;
+        }
+        else if (strcmp(name, "intf_nv_prefetch") == 0) {
+            pPvtData->prefetch = strtol(value, &pEnd, 10) != 0;
+        }
+        else if (strcmp(name, "intf_nv_prefetch_size") == 0) {
+            val = strtol(value, &pEnd, 10);
+            if (val >= MIN_PREFETCH_SIZE) {
+                pPvtData->prefetchSize = val;
+            }
+            else {
+                AVB_LOGF_ERROR("Invalid prefetch size for intf_nv_prefetch_size. Minimum %d.", MIN_PREFETCH_SIZE);
+            }
+        }
        else if (strcmp(name, "intf_nv_audio_endian") == 0) {
             if (strncasecmp(value, "big", 3) == 0) {
                 pPvtData->audioEndian = AVB_AUDIO_ENDIAN_BIG;
@@ -419,17 +802,19 @@ void openavbIntfWavFileTxInitCB(media_q_t *pMediaQ)
 			return;
 		}
 
-		if (!pPvtData->pFile) {
-			pPvtData->pFile = fopen(pPvtData->pFileName, "rb");
-			if (!pPvtData->pFile) {
-				AVB_LOGF_ERROR("Unable to open input file: %s", pPvtData->pFileName);
+		// Start from the first file every time the stream starts.
+		pPvtData->endOfData = FALSE;
+		pPvtData->underruns = 0;
+		if (!x_openPlaylistFile(pPvtData, 0)) {
+			if (!x_nextPlaylistFile(pPvtData)) {
 				return;
 			}
 		}
 
-		if (pPvtData->pFile) {
-			// Seek to start of data for our only supported wav file format.
-			fseek(pPvtData->pFile, 44, 0);
+		if (pPvtData->prefetch) {
+			if (!x_prefetchStart(pPvtData)) {
+				AVB_LOG_WARNING("Prefetch disabled. Reading the file from the talker thread.");
+			}
 		}
 	}
 
@@ -459,16 +844,23 @@ bool openavbIntfWavFileTxCB(media_q_t *pMediaQ)
 				AVB_LOG_ERROR("Media queue item not large enough for samples");
 			}
 
-			if (pPvtData->pFile) {
+			if (pPvtData->pRing || pPvtData->pFile) {
+				U32 bytesRead;
 
-				U32 bytesRead = fread(pMediaQItem->pPubData, 1, pPubMapUncmpAudioInfo->itemSize, pPvtData->pFile);
+				if (pPvtData->pRing) {
+					bytesRead = x_prefetchRead(pPvtData, pMediaQItem->pPubData, pPubMapUncmpAudioInfo->itemSize);
+					if (bytesRead < pPubMapUncmpAudioInfo->itemSize && !x_ringLoad(&pPvtData->prefetchDone)) {
+						pPvtData->underruns++;
+						IF_LOG_INTERVAL(1000) AVB_LOGF_WARNING("Prefetch underrun. Total:%u", pPvtData->underruns);
+					}
+				}
+				else {
+					bytesRead = x_readData(pPvtData, pMediaQItem->pPubData, pPubMapUncmpAudioInfo->itemSize);
+				}
 
 				if (bytesRead < pPubMapUncmpAudioInfo->itemSize) {
-					// Pad reminder of item with anything we didn't read because of end of file.
+					// Pad reminder of item with anything we didn't read because of end of data or a prefetch underrun.
 					memset(pMediaQItem->pPubData + bytesRead, 0x00, pPubMapUncmpAudioInfo->itemSize - bytesRead);
-
-					// Repeat wav file. Seek to start of data for our only supported wav file format.
-					fseek(pPvtData->pFile, 44, 0);
 				}
 				pMediaQItem->dataLen = pPubMapUncmpAudioInfo->itemSize;
 
@@ -632,6 +1024,11 @@ void openavbIntfWavFileEndCB(media_q_t *pMediaQ)
 			return;
 		}
 
+		x_prefetchStop(pPvtData);
+		if (pPvtData->underruns) {
+			AVB_LOGF_WARNING("Prefetch underruns: %u", pPvtData->underruns);
+		}
+
 		if (pPvtData->pFile) {
 			fclose(pPvtData->pFile);
 			pPvtData->pFile = NULL;
@@ -656,6 +1053,7 @@ void openavbIntfWavFileGenEndCB(media_q_t *pMediaQ)
             free(pPvtData->pFileName);
             pPvtData->pFileName = NULL;
         }
+        x_freePlaylist(pPvtData);
     }
     AVB_TRACE_EXIT(AVB_TRACE_INTF);
 }
@@ -688,6 +1086,9 @@ extern DLL_EXPORT bool openavbIntfWavFileInitialize(media_q_t *pMediaQ, openavb_
 		pPvtData->intervalCounter = 0;
 		pPvtData->numOfStoredDataBytes = 0;
 		pPvtData->fileReady = FALSE;
+		pPvtData->loop = TRUE;
+		pPvtData->prefetch = TRUE;
+		pPvtData->prefetchSize = DEFAULT_PREFETCH_SIZE;
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_INTF);
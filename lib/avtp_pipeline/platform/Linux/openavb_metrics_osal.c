@@ -0,0 +1,280 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Unix socket server for the metrics registry.
+*
+* A single thread accepts one client at a time, answers its request and closes the connection.
+* Both raw one line requests and HTTP GET are understood so the socket can be scraped with
+* "curl --unix-socket" as well as with socat or nc.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "openavb_platform.h"
+#include "openavb_trace.h"
+#include "openavb_metrics.h"
+
+#define	AVB_LOG_COMPONENT	"Metrics"
+#include "openavb_log.h"
+
+#define METRICS_POLL_MSEC		500
+#define METRICS_IO_TIMEOUT_SEC	1
+#define METRICS_REQUEST_LEN		512
+
+#define METRICS_HTTP_OK			"HTTP/1.0 200 OK\r\nConnection: close\r\nContent-Type: "
+#define METRICS_HTTP_NOT_FOUND	"HTTP/1.0 404 Not Found\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\nNot found\n"
+#define METRICS_TYPE_PROMETHEUS	"text/plain; version=0.0.4"
+#define METRICS_TYPE_JSON		"application/json"
+
+THREAD_TYPE(metricsThread);
+THREAD_DEFINITON(metricsThread);
+
+static int metricsSock = -1;
+static volatile bool metricsRunning = FALSE;
+static struct sockaddr_un metricsAddr;
+
+static bool x_metricsSend(int csock, const char *pBuf, size_t len)
+{
+	while (len > 0) {
+		ssize_t nWrite = send(csock, pBuf, len, MSG_NOSIGNAL);
+		if (nWrite < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			AVB_LOGF_DEBUG("Metrics client write failed: %s", strerror(errno));
+			return FALSE;
+		}
+		pBuf += nWrite;
+		len -= nWrite;
+	}
+	return TRUE;
+}
+
+static void x_metricsServeClient(int csock)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+	char request[METRICS_REQUEST_LEN];
+	size_t len = 0;
+
+	struct timeval tv = { METRICS_IO_TIMEOUT_SEC, 0 };
+	setsockopt(csock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+	setsockopt(csock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+	// Only the first line of the request matters.
+	while (len < sizeof(request) - 1) {
+		ssize_t nRead = recv(csock, request + len, sizeof(request) - 1 - len, 0);
+		if (nRead < 0 && errno == EINTR) {
+			continue;
+		}
+		if (nRead <= 0) {
+			break;
+		}
+		len += nRead;
+		request[len] = '\0';
+		if (strchr(request, '\n')) {
+			break;
+		}
+	}
+	request[len] = '\0';
+	request[strcspn(request, "\r\n")] = '\0';
+
+	bool bHttp = FALSE;
+	bool bFound = TRUE;
+	openavb_metrics_format_t format = OPENAVB_METRICS_FORMAT_PROMETHEUS;
+
+	if (strncmp(request, "GET ", 4) == 0) {
+		char *pPath = request + 4;
+		pPath[strcspn(pPath, " ?")] = '\0';
+		bHttp = TRUE;
+		if (strcmp(pPath, "/metrics.json") == 0 || strcmp(pPath, "/json") == 0) {
+			format = OPENAVB_METRICS_FORMAT_JSON;
+		}
+		else if (strcmp(pPath, "/metrics") != 0 && strcmp(pPath, "/") != 0) {
+			bFound = FALSE;
+		}
+	}
+	else if (strcmp(request, "json") == 0) {
+		format = OPENAVB_METRICS_FORMAT_JSON;
+	}
+
+	if (!bFound) {
+		x_metricsSend(csock, METRICS_HTTP_NOT_FOUND, strlen(METRICS_HTTP_NOT_FOUND));
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return;
+	}
+
+	// Format into memory first so a slow client can't stall the registry walk.
+	char *pBuf = NULL;
+	size_t bufLen = 0;
+	FILE *pOut = open_memstream(&pBuf, &bufLen);
+	if (!pOut) {
+		AVB_LOGF_ERROR("Failed to open metrics buffer: %s", strerror(errno));
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return;
+	}
+	if (bHttp) {
+		fprintf(pOut, METRICS_HTTP_OK "%s\r\n\r\n",
+			format == OPENAVB_METRICS_FORMAT_JSON ? METRICS_TYPE_JSON : METRICS_TYPE_PROMETHEUS);
+	}
+	openavbMetricsWrite(pOut, format);
+	fclose(pOut);
+
+	if (pBuf) {
+		x_metricsSend(csock, pBuf, bufLen);
+		free(pBuf);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+}
+
+static void *metricsThreadFn(void *pv)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	while (metricsRunning) {
+		struct pollfd pfd;
+		pfd.fd = metricsSock;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+
+		int rslt = poll(&pfd, 1, METRICS_POLL_MSEC);
+		if (rslt < 0 && errno != EINTR) {
+			AVB_LOGF_ERROR("Metrics poll error: %s", strerror(errno));
+			SLEEP_MSEC(METRICS_POLL_MSEC);
+		}
+		if (rslt <= 0) {
+			continue;
+		}
+
+		int csock = accept(metricsSock, NULL, NULL);
+		if (csock < 0) {
+			if (errno != EINTR) {
+				AVB_LOGF_ERROR("Failed to accept metrics connection: %s", strerror(errno));
+			}
+			continue;
+		}
+
+		x_metricsServeClient(csock);
+		close(csock);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return NULL;
+}
+
+bool openavbMetricsServerStart(const char *pPath)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	if (metricsRunning) {
+		AVB_LOG_ERROR("Metrics server already running");
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	if (!pPath || !*pPath) {
+		pPath = OPENAVB_METRICS_UNIX_PATH;
+	}
+
+	memset(&metricsAddr, 0, sizeof(metricsAddr));
+	metricsAddr.sun_family = AF_UNIX;
+	if (strlen(pPath) >= sizeof(metricsAddr.sun_path)) {
+		AVB_LOGF_ERROR("Metrics socket path too long: %s", pPath);
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+	strcpy(metricsAddr.sun_path, pPath);
+
+	metricsSock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (metricsSock < 0) {
+		AVB_LOGF_ERROR("Failed to open metrics socket: %s", strerror(errno));
+		goto error;
+	}
+
+	// try remove old socket
+	if (unlink(metricsAddr.sun_path) == -1 && errno != ENOENT) {
+		AVB_LOGF_ERROR("Failed to remove %s: %s", metricsAddr.sun_path, strerror(errno));
+	}
+
+	if (bind(metricsSock, (struct sockaddr *)&metricsAddr, sizeof(metricsAddr)) != 0) {
+		AVB_LOGF_ERROR("Failed to create %s: %s", metricsAddr.sun_path, strerror(errno));
+		goto error;
+	}
+
+	if (listen(metricsSock, 8) != 0) {
+		AVB_LOGF_ERROR("Failed to listen on metrics socket: %s", strerror(errno));
+		unlink(metricsAddr.sun_path);
+		goto error;
+	}
+
+	metricsRunning = TRUE;
+
+	bool errResult;
+	THREAD_CREATE(metricsThread, metricsThread, NULL, metricsThreadFn, NULL);
+	THREAD_CHECK_ERROR(metricsThread, "Thread / task creation failed", errResult);
+	if (errResult) {
+		metricsRunning = FALSE;
+		unlink(metricsAddr.sun_path);
+		goto error;
+	}
+
+	AVB_LOGF_INFO("Serving metrics on %s", metricsAddr.sun_path);
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return TRUE;
+
+  error:
+	if (metricsSock >= 0) {
+		close(metricsSock);
+		metricsSock = -1;
+	}
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return FALSE;
+}
+
+void openavbMetricsServerStop(void)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	if (metricsRunning) {
+		metricsRunning = FALSE;
+		THREAD_JOIN(metricsThread, NULL);
+
+		close(metricsSock);
+		metricsSock = -1;
+		unlink(metricsAddr.sun_path);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+}
@@ -36,6 +36,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #define	AVB_LOG_COMPONENT	"osal"
 #include "openavb_pub.h"
 #include "openavb_log.h"
+#include "openavb_trace_pub.h"
 
 static FILE *s_logfile = NULL;
 
@@ -54,6 +55,7 @@ extern DLL_EXPORT bool osalAVBInitialize(const char* logfilename, const char* if
 	}
 
 	avbLogInitEx(s_logfile);
+	avbTraceInit();
 	osalAVBTimeInit();
 	openavbQmgrInitialize(FQTSS_MODE_HW_CLASS, 0, ifname, 0, 0, 0);
 	return TRUE;
@@ -63,6 +65,7 @@ extern DLL_EXPORT bool osalAVBFinalize(void)
 {
 	openavbQmgrFinalize();
 	osalAVBTimeClose();
+	avbTraceExit();
 	avbLogExit();
 
 	// Done with the log file.
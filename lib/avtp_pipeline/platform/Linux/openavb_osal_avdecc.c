@@ -55,6 +55,7 @@ extern DLL_EXPORT bool osalAvdeccInitialize(const char* logfilename, const char*
 	}
 
 	avbLogInitEx(s_logfile);
+	avbTraceInit();
 	osalAVBTimeInit();
 	if (!osalAVBGrandmasterInit()) { return FALSE; }
 	if (!startAvdecc(ifname, inifiles, numfiles)) { return FALSE; }
@@ -66,6 +67,7 @@ extern DLL_EXPORT bool osalAvdeccFinalize(void)
 	stopAvdecc();
 	osalAVBGrandmasterClose();
 	osalAVBTimeClose();
+	avbTraceExit();
 	avbLogExit();
 
 	// Done with the log file.
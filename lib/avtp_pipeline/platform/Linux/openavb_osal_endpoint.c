@@ -37,6 +37,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #define	AVB_LOG_COMPONENT	"osal"
 #include "openavb_pub.h"
 #include "openavb_log.h"
+#include "openavb_trace_pub.h"
 
 static FILE *s_logfile = NULL;
 
@@ -55,6 +56,7 @@ extern DLL_EXPORT bool osalAVBInitialize(const char* logfilename, const char* if
 	}
 
 	avbLogInitEx(s_logfile);
+	avbTraceInit();
 	osalAVBTimeInit();
 	startEndpoint(FQTSS_MODE_HW_CLASS, 0, ifname, 0, 0, 0);
 	return TRUE;
@@ -64,6 +66,7 @@ extern DLL_EXPORT bool osalAVBFinalize(void)
 {
 	stopEndpoint();
 	osalAVBTimeClose();
+	avbTraceExit();
 	avbLogExit();
 
 	// Done with the log file.
@@ -62,6 +62,9 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 //task loggingThread
 #define loggingThread_THREAD_STK_SIZE    					THREAD_STACK_SIZE
 
+//task metricsThread
+#define metricsThread_THREAD_STK_SIZE    					THREAD_STACK_SIZE
+
 //task TLThread Used for both Talker and Listener threads
 #define TLThread_THREAD_STK_SIZE    						THREAD_STACK_SIZE
 
@@ -71,6 +74,15 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 //task ListenerThread
 #define listenerThread_THREAD_STK_SIZE 						THREAD_STACK_SIZE
 
+//task tlPoolThread Worker running pooled Talkers and Listeners
+#define tlPoolThread_THREAD_STK_SIZE						THREAD_STACK_SIZE
+
+//task tlConfigThread Reads the ini files of Talkers and Listeners and configures them
+#define tlConfigThread_THREAD_STK_SIZE						THREAD_STACK_SIZE
+
+//task eptNotifyThread Watches the endpoint connections of the Talkers and Listeners
+#define eptNotifyThread_THREAD_STK_SIZE						THREAD_STACK_SIZE
+
 //task avdeccMsgThread
 #define avdeccMsgThread_THREAD_STK_SIZE						THREAD_STACK_SIZE
 
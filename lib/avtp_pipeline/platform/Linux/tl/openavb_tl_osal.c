@@ -461,12 +461,12 @@ bool openavbTLThreadFnOsal(tl_state_t *pTLState)
 }
 
 
-EXTERN_DLL_EXPORT bool openavbTLReadIniFileOsal(tl_handle_t TLhandle, const char *fileName, openavb_tl_cfg_t *pCfg, openavb_tl_cfg_name_value_t *pNVCfg)
+bool openavbTLParseIniFileOsal(tl_state_t *pTLState, const char *fileName, openavb_tl_cfg_t *pCfg, openavb_tl_cfg_name_value_t *pNVCfg)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_TL);
 
 	parse_ini_data_t parseIniData;
-	parseIniData.pTLState = (tl_state_t *)TLhandle;
+	parseIniData.pTLState = pTLState;
 	parseIniData.pCfg = pCfg;
 	parseIniData.pNVCfg = pNVCfg;
 
@@ -484,14 +484,6 @@ EXTERN_DLL_EXPORT bool openavbTLReadIniFileOsal(tl_handle_t TLhandle, const char
 	}
 
 	int result = ini_parse(fileName, openavbTLCfgCallback, &parseIniData);
-	if (result == 0) {
-		if_info_t ifinfo;
-		if (pCfg->ifname[0] && !openavbCheckInterface(parseIniData.pCfg->ifname, &ifinfo)) {
-			AVB_LOGF_ERROR("Invalid value: name=%s, value=%s", "ifname", parseIniData.pCfg->ifname);
-			AVB_TRACE_EXIT(AVB_TRACE_TL);
-			return FALSE;
-		}
-	}
 	if (result < 0) {
 		AVB_LOGF_ERROR("Couldn't parse INI file: %s", fileName);
 		AVB_TRACE_EXIT(AVB_TRACE_TL);
@@ -503,33 +495,73 @@ EXTERN_DLL_EXPORT bool openavbTLReadIniFileOsal(tl_handle_t TLhandle, const char
 		return FALSE;
 	}
 
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return TRUE;
+}
+
+bool openavbTLCheckCfgOsal(openavb_tl_cfg_t *pCfg)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	if_info_t ifinfo;
+	if (pCfg->ifname[0] && !openavbCheckInterface(pCfg->ifname, &ifinfo)) {
+		AVB_LOGF_ERROR("Invalid value: name=%s, value=%s", "ifname", pCfg->ifname);
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
 	// For a Talker, use the adapter MAC Address as the stream address when one was not supplied.
-	if (parseIniData.pCfg->role == AVB_ROLE_TALKER &&
-	    (!parseIniData.pCfg->stream_addr.mac || memcmp(parseIniData.pCfg->stream_addr.mac, "\x00\x00\x00\x00\x00\x00", 6) == 0))
+	if (pCfg->role == AVB_ROLE_TALKER &&
+	    (!pCfg->stream_addr.mac || memcmp(pCfg->stream_addr.mac, "\x00\x00\x00\x00\x00\x00", 6) == 0))
 	{
 		// Open a rawsock may be the easiest cross platform way to get the MAC address.
-		void *txSock = openavbRawsockOpen(parseIniData.pCfg->ifname, FALSE, TRUE, ETHERTYPE_AVTP, 100, 1);
+		void *txSock = openavbRawsockOpen(pCfg->ifname, FALSE, TRUE, ETHERTYPE_AVTP, 100, 1);
 		if (txSock) {
-			if (openavbRawsockGetAddr(txSock, parseIniData.pCfg->stream_addr.buffer.ether_addr_octet)) {
-				parseIniData.pCfg->stream_addr.mac = &(parseIniData.pCfg->stream_addr.buffer); // Indicate that the MAC Address is valid.
+			if (openavbRawsockGetAddr(txSock, pCfg->stream_addr.buffer.ether_addr_octet)) {
+				pCfg->stream_addr.mac = &(pCfg->stream_addr.buffer); // Indicate that the MAC Address is valid.
 			}
 			openavbRawsockClose(txSock);
 			txSock = NULL;
 		}
 
-		if (!parseIniData.pCfg->stream_addr.mac || memcmp(parseIniData.pCfg->stream_addr.mac, "\x00\x00\x00\x00\x00\x00", 6) == 0) {
+		if (!pCfg->stream_addr.mac || memcmp(pCfg->stream_addr.mac, "\x00\x00\x00\x00\x00\x00", 6) == 0) {
 			AVB_LOG_ERROR("stream_addr required, but not specified.");
 			AVB_TRACE_EXIT(AVB_TRACE_TL);
 			return FALSE;
 		}
 		AVB_LOGF_DEBUG("Detected stream_addr:  " ETH_FORMAT,
-			ETH_OCTETS(parseIniData.pCfg->stream_addr.buffer.ether_addr_octet));
+			ETH_OCTETS(pCfg->stream_addr.buffer.ether_addr_octet));
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_TL);
 	return TRUE;
 }
 
+EXTERN_DLL_EXPORT bool openavbTLReadIniFileOsal(tl_handle_t TLhandle, const char *fileName, openavb_tl_cfg_t *pCfg, openavb_tl_cfg_name_value_t *pNVCfg)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	bool bRet = openavbTLParseIniFileOsal((tl_state_t *)TLhandle, fileName, pCfg, pNVCfg)
+		&& openavbTLCheckCfgOsal(pCfg);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return bRet;
+}
+
+void *openavbTLFindInitFnOsal(const char *funcName)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	dlerror();
+	void *pFn = dlsym(RTLD_DEFAULT, funcName);
+	if (dlerror() != NULL) {
+		pFn = NULL;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return pFn;
+}
+
 
 bool openavbTLOpenLinkLibsOsal(tl_state_t *pTLState)
 {
@@ -567,3 +599,155 @@ bool openavbTLCloseLinkLibsOsal(tl_state_t *pTLState)
 }
 
 
+
+THREAD_TYPE(tlConfigThread);
+
+typedef struct {
+	tl_handle_t *pHandles;
+	// Either the ini file of each handle or a bundle holding their configuration
+	char **ppFileNames;
+	tl_bundle_handle_t bundle;
+	U32 count;
+	// Next file to be taken by a config thread
+	U32 next;
+	bool bFailed;
+} config_batch_t;
+
+typedef struct {
+	config_batch_t *pBatch;
+	THREAD_DEFINITON(tlConfigThread);
+} config_worker_t;
+
+static void x_configureOne(config_batch_t *pBatch, U32 idx)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	openavb_tl_cfg_t cfg;
+	openavb_tl_cfg_name_value_t NVCfg;
+
+	openavbTLInitCfg(&cfg);
+	memset(&NVCfg, 0, sizeof(NVCfg));
+
+	if (pBatch->bundle) {
+		if (!openavbTLBundleGetCfg(pBatch->bundle, idx, &cfg, &NVCfg)) {
+			pBatch->bFailed = TRUE;
+		}
+		else if (!openavbTLConfigure(pBatch->pHandles[idx], &cfg, &NVCfg)) {
+			AVB_LOGF_ERROR("Error configuring: %s", cfg.friendly_name);
+			pBatch->bFailed = TRUE;
+		}
+	}
+	else if (!openavbTLReadIniFileOsal(pBatch->pHandles[idx], pBatch->ppFileNames[idx], &cfg, &NVCfg)) {
+		AVB_LOGF_ERROR("Error reading ini file: %s", pBatch->ppFileNames[idx]);
+		pBatch->bFailed = TRUE;
+	}
+	else if (!openavbTLConfigure(pBatch->pHandles[idx], &cfg, &NVCfg)) {
+		AVB_LOGF_ERROR("Error configuring: %s", pBatch->ppFileNames[idx]);
+		pBatch->bFailed = TRUE;
+	}
+
+	int i2;
+	for (i2 = 0; i2 < NVCfg.nLibCfgItems; i2++) {
+		free(NVCfg.libCfgNames[i2]);
+		free(NVCfg.libCfgValues[i2]);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+}
+
+static void *x_configThreadFn(void *pv)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	config_batch_t *pBatch = ((config_worker_t *)pv)->pBatch;
+	U32 idx;
+
+	while ((idx = __sync_fetch_and_add(&pBatch->next, 1)) < pBatch->count) {
+		x_configureOne(pBatch, idx);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return NULL;
+}
+
+static bool x_configureBatch(config_batch_t *pBatch, U32 threads)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	U32 count = pBatch->count;
+
+	if (threads > count) {
+		threads = count;
+	}
+
+	// The calling thread is one of them
+	config_worker_t *pWorkers = NULL;
+	if (threads > 1) {
+		pWorkers = calloc(threads - 1, sizeof(config_worker_t));
+		if (!pWorkers) {
+			AVB_LOG_WARNING("Unable to allocate config threads; configuring one at a time");
+		}
+	}
+
+	U32 nStarted = 0;
+	if (pWorkers) {
+		for (nStarted = 0; nStarted < threads - 1; nStarted++) {
+			config_worker_t *pWorker = &pWorkers[nStarted];
+			bool errResult;
+
+			pWorker->pBatch = pBatch;
+			THREAD_CREATE(tlConfigThread, pWorker->tlConfigThread, NULL, x_configThreadFn, pWorker);
+			THREAD_CHECK_ERROR(pWorker->tlConfigThread, "Thread / task creation failed", errResult);
+			if (errResult) {
+				// Whatever the started threads do not take is done below
+				break;
+			}
+		}
+	}
+
+	// Does everything when no threads were started
+	config_worker_t self;
+	self.pBatch = pBatch;
+	x_configThreadFn(&self);
+
+	U32 i1;
+	for (i1 = 0; i1 < nStarted; i1++) {
+		THREAD_JOIN(pWorkers[i1].tlConfigThread, NULL);
+	}
+	free(pWorkers);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return !pBatch->bFailed;
+}
+
+bool openavbTLConfigureIniFilesOsal(tl_handle_t *pHandles, char **ppFileNames, U32 count, U32 threads)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	config_batch_t batch;
+	memset(&batch, 0, sizeof(batch));
+	batch.pHandles = pHandles;
+	batch.ppFileNames = ppFileNames;
+	batch.count = count;
+
+	bool bRet = x_configureBatch(&batch, threads);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return bRet;
+}
+
+bool openavbTLConfigureBundleOsal(tl_handle_t *pHandles, tl_bundle_handle_t bundle, U32 threads)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	config_batch_t batch;
+	memset(&batch, 0, sizeof(batch));
+	batch.pHandles = pHandles;
+	batch.bundle = bundle;
+	batch.count = openavbTLBundleCount(bundle);
+
+	bool bRet = x_configureBatch(&batch, threads);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return bRet;
+}
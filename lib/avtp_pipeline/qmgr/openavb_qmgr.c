@@ -33,6 +33,8 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
  * MODULE : AVB Queue Manager
  */
 
+#include <stdlib.h>
+#include <string.h>
 #include <openavb_types.h>
 
 #define AVB_LOG_COMPONENT "QMGR"
@@ -77,11 +79,6 @@ pthread_mutex_t qmgr_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
 #define LOCK()  	pthread_mutex_lock(&qmgr_mutex)
 #define UNLOCK()	pthread_mutex_unlock(&qmgr_mutex)
 
-// Information for each SR class
-typedef struct {
-	unsigned classBytesPerSec;
-} qmgrClass_t;
-
 // Information for each active stream
 typedef struct {
 	unsigned streamBytesPerSec;
@@ -90,16 +87,66 @@ typedef struct {
 	unsigned maxFrameSize;
 } qmgrStream_t;
 
-// Arrays to hold info for classes and streams
+// Information for each SR class
+typedef struct {
+	unsigned classBytesPerSec;
+	qmgrStream_t *streams;		// indexed by stream number, grows on demand
+	int *freeList;				// stack of unused stream numbers
+	int nStreams;				// entries allocated in streams
+	int nFree;					// entries on freeList
+} qmgrClass_t;
+
+// Array to hold info for classes (and their streams)
 static qmgrClass_t  qmgr_classes[MAX_AVB_SR_CLASSES];
-static qmgrStream_t qmgr_streams[MAX_AVB_STREAMS];
+
+// The fwmark encoding is the hard limit on streams per class
+#define QMGR_MAX_STREAMS_PER_CLASS (TC_AVB_STREAM_MASK + 1)
 
 // Make sure that the scheme we're using to encode the class/stream
 // into the fwmark will work!  (we encode class and stream into 16-bits)
-#if MAX_AVB_STREAMS_PER_CLASS > (1 << TC_AVB_CLASS_SHIFT)
+#if MAX_AVB_STREAMS_PER_CLASS > QMGR_MAX_STREAMS_PER_CLASS
 #error MAX_AVB_STREAMS_PER_CLASS too large for FWMARK encoding
 #endif
 
+// Double the stream table for a class, up to the fwmark limit
+static bool growClass(qmgrClass_t *pClass)
+{
+	int nStreams = pClass->nStreams ? pClass->nStreams * 2 : MAX_AVB_STREAMS_PER_CLASS;
+	if (nStreams > QMGR_MAX_STREAMS_PER_CLASS)
+		nStreams = QMGR_MAX_STREAMS_PER_CLASS;
+	if (nStreams <= pClass->nStreams)
+		return FALSE;
+
+	qmgrStream_t *streams = realloc(pClass->streams, nStreams * sizeof(qmgrStream_t));
+	if (!streams)
+		return FALSE;
+	pClass->streams = streams;
+
+	int *freeList = realloc(pClass->freeList, nStreams * sizeof(int));
+	if (!freeList)
+		return FALSE;
+	pClass->freeList = freeList;
+
+	memset(&streams[pClass->nStreams], 0, (nStreams - pClass->nStreams) * sizeof(qmgrStream_t));
+
+	// Push the new stream numbers so the lowest is handed out first
+	int nStream;
+	for (nStream = nStreams - 1; nStream >= pClass->nStreams; nStream--)
+		freeList[pClass->nFree++] = nStream;
+	pClass->nStreams = nStreams;
+	return TRUE;
+}
+
+static void freeClasses(void)
+{
+	int nClass;
+	for (nClass = SR_CLASS_A; nClass < MAX_AVB_SR_CLASSES; nClass++) {
+		free(qmgr_classes[nClass].streams);
+		free(qmgr_classes[nClass].freeList);
+	}
+	memset(qmgr_classes, 0, sizeof(qmgr_classes));
+}
+
 static bool setupHWQueue(int nClass, unsigned classBytesPerSec)
 {
 	int err = 0;
@@ -138,7 +185,7 @@ U16 openavbQmgrAddStream(SRClassIdx_t nClass, unsigned classRate, unsigned maxIn
 {
 	unsigned fullFrameSize = maxFrameSize + OPENAVB_AVTP_ETHER_FRAME_OVERHEAD + 1;
 	unsigned long streamBytesPerSec = fullFrameSize * maxIntervalFrames * classRate;
-	int idx, nStream;
+	int nStream;
 	U16 fwmark = INVALID_FWMARK;
 
 	AVB_TRACE_ENTRY(AVB_TRACE_QUEUE_MANAGER);
@@ -152,12 +199,13 @@ U16 openavbQmgrAddStream(SRClassIdx_t nClass, unsigned classRate, unsigned maxIn
 		AVB_LOG_ERROR("Adding stream; invalid argument");
 	}
 	else {
-		// Find an unused stream in the appropriate SR class
-		for (nStream = 0, idx = nClass * MAX_AVB_STREAMS_PER_CLASS; nStream < MAX_AVB_STREAMS_PER_CLASS; nStream++, idx++) {
-			if (0 == qmgr_streams[idx].streamBytesPerSec) {
-				fwmark = TC_AVB_MARK(nClass, nStream);
-				break;
-			}
+		// Take an unused stream in the appropriate SR class
+		qmgrClass_t *pClass = &qmgr_classes[nClass];
+		if (pClass->nFree == 0)
+			growClass(pClass);
+		if (pClass->nFree > 0) {
+			nStream = pClass->freeList[pClass->nFree - 1];
+			fwmark = TC_AVB_MARK(nClass, nStream);
 		}
 
 		if (fwmark == INVALID_FWMARK) {
@@ -172,14 +220,16 @@ U16 openavbQmgrAddStream(SRClassIdx_t nClass, unsigned classRate, unsigned maxIn
 
 			if (fwmark != INVALID_FWMARK) {
 				// good to go - update stream
-				qmgr_streams[idx].streamBytesPerSec = streamBytesPerSec;
-				qmgr_streams[idx].classRate = classRate;
-				qmgr_streams[idx].maxIntervalFrames = maxIntervalFrames;
-				qmgr_streams[idx].maxFrameSize = maxFrameSize;
+				qmgrStream_t *pStream = &pClass->streams[nStream];
+				pClass->nFree--;
+				pStream->streamBytesPerSec = streamBytesPerSec;
+				pStream->classRate = classRate;
+				pStream->maxIntervalFrames = maxIntervalFrames;
+				pStream->maxFrameSize = maxFrameSize;
 				// and class
-				qmgr_classes[nClass].classBytesPerSec += streamBytesPerSec;
+				pClass->classBytesPerSec += streamBytesPerSec;
 
-				AVB_LOGF_DEBUG("Added stream; classBPS=%u, streamBPS=%u", qmgr_classes[nClass].classBytesPerSec, qmgr_streams[idx].streamBytesPerSec);
+				AVB_LOGF_DEBUG("Added stream; classBPS=%u, streamBPS=%u", pClass->classBytesPerSec, pStream->streamBytesPerSec);
 			}
 		}
 	}
@@ -202,29 +252,32 @@ void openavbQmgrRemoveStream(U16 fwmark)
 
 	int nClass = TC_AVB_MARK_CLASS(fwmark);
 	int nStream  = TC_AVB_MARK_STREAM(fwmark);
-	int idx = nClass * MAX_AVB_STREAMS_PER_CLASS + nStream;
 
 	LOCK();
 
 	if (nStream < 0
-		|| nStream >= MAX_AVB_STREAMS
 		|| nClass < 0
 		|| nClass >= MAX_AVB_SR_CLASSES
-		|| qmgr_streams[idx].streamBytesPerSec == 0)
+		|| nStream >= qmgr_classes[nClass].nStreams
+		|| qmgr_classes[nClass].streams[nStream].streamBytesPerSec == 0)
 	{
 		// something is wrong
 		AVB_LOG_ERROR("Removing stream; invalid argument or data");
 	}
 	else {
+		qmgrClass_t *pClass = &qmgr_classes[nClass];
+		qmgrStream_t *pStream = &pClass->streams[nStream];
+
 		if (qdisc_data.mode != AVB_SHAPER_DISABLED) {
-			setupHWQueue(nClass, qmgr_classes[nClass].classBytesPerSec - qmgr_streams[idx].streamBytesPerSec);
+			setupHWQueue(nClass, pClass->classBytesPerSec - pStream->streamBytesPerSec);
 		}
 
 		// update class
-		qmgr_classes[nClass].classBytesPerSec -= qmgr_streams[idx].streamBytesPerSec;
-		AVB_LOGF_DEBUG("Removed stream; classBPS=%u, streamBPS=%u", qmgr_classes[nClass].classBytesPerSec, qmgr_streams[idx].streamBytesPerSec);
+		pClass->classBytesPerSec -= pStream->streamBytesPerSec;
+		AVB_LOGF_DEBUG("Removed stream; classBPS=%u, streamBPS=%u", pClass->classBytesPerSec, pStream->streamBytesPerSec);
 		// and stream
-		memset(&qmgr_streams[idx], 0, sizeof(qmgrStream_t));
+		memset(pStream, 0, sizeof(qmgrStream_t));
+		pClass->freeList[pClass->nFree++] = nStream;
 	}
 
 	UNLOCK();
@@ -270,8 +323,7 @@ bool openavbQmgrInitialize(int mode, int ifindex, const char* ifname, unsigned m
 #endif
 	{
 		// Initialize data for classes and streams
-		memset(qmgr_classes, 0, sizeof(qmgr_classes));
-		memset(qmgr_streams, 0, sizeof(qmgr_streams));
+		freeClasses();
 
 		// Save the configuration
 		if (ifname)
@@ -299,22 +351,26 @@ void openavbQmgrFinalize(void)
 	AVB_TRACE_ENTRY(AVB_TRACE_QUEUE_MANAGER);
 	LOCK();
 
-	if (--qdisc_data.ref == 0 && qdisc_data.mode != AVB_SHAPER_DISABLED) {
-		int nClass;
-		for (nClass = SR_CLASS_A; nClass < MAX_AVB_SR_CLASSES; nClass++) {
-			int nStream, idx;
-			for (nStream = 0, idx = nClass * MAX_AVB_STREAMS_PER_CLASS; nStream < MAX_AVB_STREAMS_PER_CLASS; nStream++, idx++) {
-				if (qmgr_streams[idx].streamBytesPerSec) {
-					U16 fwmark = TC_AVB_MARK(nClass, nStream);
-					openavbQmgrRemoveStream(fwmark);
+	if (--qdisc_data.ref == 0) {
+		if (qdisc_data.mode != AVB_SHAPER_DISABLED) {
+			int nClass;
+			for (nClass = SR_CLASS_A; nClass < MAX_AVB_SR_CLASSES; nClass++) {
+				int nStream;
+				for (nStream = 0; nStream < qmgr_classes[nClass].nStreams; nStream++) {
+					if (qmgr_classes[nClass].streams[nStream].streamBytesPerSec) {
+						U16 fwmark = TC_AVB_MARK(nClass, nStream);
+						openavbQmgrRemoveStream(fwmark);
+					}
 				}
 			}
-		}
 
 #if (AVB_FEATURE_IGB)
-		igbReleaseDevice(qdisc_data.igb_dev);
-		qdisc_data.igb_dev = NULL;
+			igbReleaseDevice(qdisc_data.igb_dev);
+			qdisc_data.igb_dev = NULL;
 #endif
+		}
+
+		freeClasses();
 	}
 
 	UNLOCK();
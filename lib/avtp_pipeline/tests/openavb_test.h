@@ -0,0 +1,85 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* HEADER SUMMARY : Checks shared by the avtp_pipeline test programs.
+*
+* Each test is a standalone program run by ctest. A failed TEST_CHECK reports its location
+* and the test carries on so one run shows every mismatch; main() returns TEST_RESULT().
+*/
+
+#ifndef OPENAVB_TEST_H
+#define OPENAVB_TEST_H 1
+
+#include <stdio.h>
+#include "openavb_types_pub.h"
+
+static int testFailures = 0;
+
+#define TEST_CHECK(COND) \
+	do { \
+		if (!(COND)) { \
+			testFailures++; \
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #COND); \
+		} \
+	} while (0)
+
+// Same as TEST_CHECK with a printf style description of the case
+#define TEST_CHECKF(COND, FMT, ...) \
+	do { \
+		if (!(COND)) { \
+			testFailures++; \
+			fprintf(stderr, "%s:%d: check failed: %s (" FMT ")\n", __FILE__, __LINE__, #COND, __VA_ARGS__); \
+		} \
+	} while (0)
+
+#define TEST_RESULT() \
+	(testFailures ? (fprintf(stderr, "%d checks failed\n", testFailures), 1) : (printf("All checks passed\n"), 0))
+
+// Repeatable pseudo random numbers (xorshift32), the state must not be 0
+static inline U32 testRand(U32 *pState)
+{
+	U32 x = *pState;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*pState = x;
+	return x;
+}
+
+static inline void testRandFill(U8 *pData, U32 len, U32 *pState)
+{
+	while (len--) {
+		*pData++ = testRand(pState);
+	}
+}
+
+#endif // OPENAVB_TEST_H
@@ -0,0 +1,283 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Checks the AAF sample conversion kernels against the scalar reference.
+*
+* Every vector kernel compiled for this CPU is run, not only the one openavbAafConvertSelect()
+* picks, so the SSE2 and SSSE3 kernels are covered on an AVX2 machine as well. Sample counts
+* walk through the vector widths so every tail length is hit, buffers are offset to catch
+* alignment assumptions and a guard area after the output catches writes past the end.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "openavb_test.h"
+
+// The kernels are static, build the module into the test to reach all of them
+#include "openavb_map_aaf_audio_convert.c"
+
+#define MAX_COUNT		300		// Samples, several AVX2 iterations plus every tail
+#define MAX_OFFSET		4		// Byte offsets applied to the source and destination
+#define GUARD_BYTES		64
+#define GUARD_FILL		0xA5
+#define BUF_BYTES		(MAX_COUNT * 8 + MAX_OFFSET + GUARD_BYTES)
+
+typedef struct {
+	const char *pName;
+	const char *pIsa;		// Needed CPU feature, NULL when always present
+	openavb_aaf_convert_fn_t convertFn;
+	U32 inBytes;
+	U32 outBytes;
+} convert_kernel_t;
+
+typedef struct {
+	const char *pName;
+	const char *pIsa;
+	openavb_aaf_swap_fn_t swapFn;
+	U32 sampleBytes;
+} swap_kernel_t;
+
+static const convert_kernel_t convertKernels[] = {
+#if AAF_CONVERT_X86
+	{ "sse2_2to4", "sse2", x_sse2_2to4, 2, 4 },
+	{ "sse2_4to2", "sse2", x_sse2_4to2, 4, 2 },
+	{ "ssse3_2to3", "ssse3", x_ssse3_2to3, 2, 3 },
+	{ "ssse3_3to2", "ssse3", x_ssse3_3to2, 3, 2 },
+	{ "ssse3_3to4", "ssse3", x_ssse3_3to4, 3, 4 },
+	{ "ssse3_4to3", "ssse3", x_ssse3_4to3, 4, 3 },
+	{ "avx2_2to4", "avx2", x_avx2_2to4, 2, 4 },
+	{ "avx2_3to4", "avx2", x_avx2_3to4, 3, 4 },
+	{ "avx2_4to2", "avx2", x_avx2_4to2, 4, 2 },
+#elif AAF_CONVERT_NEON
+	{ "neon2to3", NULL, x_neon2to3, 2, 3 },
+	{ "neon2to4", NULL, x_neon2to4, 2, 4 },
+	{ "neon3to2", NULL, x_neon3to2, 3, 2 },
+	{ "neon3to4", NULL, x_neon3to4, 3, 4 },
+	{ "neon4to2", NULL, x_neon4to2, 4, 2 },
+	{ "neon4to3", NULL, x_neon4to3, 4, 3 },
+#endif
+	{ NULL, NULL, NULL, 0, 0 }
+};
+
+static const swap_kernel_t swapKernels[] = {
+#if AAF_CONVERT_X86
+	{ "ssse3Swap2", "ssse3", x_ssse3Swap2, 2 },
+	{ "ssse3Swap3", "ssse3", x_ssse3Swap3, 3 },
+	{ "ssse3Swap4", "ssse3", x_ssse3Swap4, 4 },
+	{ "avx2Swap2", "avx2", x_avx2Swap2, 2 },
+	{ "avx2Swap4", "avx2", x_avx2Swap4, 4 },
+#elif AAF_CONVERT_NEON
+	{ "neonSwap2", NULL, x_neonSwap2, 2 },
+	{ "neonSwap3", NULL, x_neonSwap3, 3 },
+	{ "neonSwap4", NULL, x_neonSwap4, 4 },
+#endif
+	{ NULL, NULL, NULL, 0 }
+};
+
+static U8 srcBuf[BUF_BYTES];
+static U8 refBuf[BUF_BYTES];
+static U8 testBuf[BUF_BYTES];
+
+static bool x_isaAvailable(const char *pIsa)
+{
+#if AAF_CONVERT_X86
+	return !pIsa || x_cpuHas(pIsa);
+#else
+	return TRUE;
+#endif
+}
+
+static void x_checkConvert(const char *pName, openavb_aaf_convert_fn_t testFn, U32 inBytes, U32 outBytes)
+{
+	openavb_aaf_convert_fn_t refFn = openavbAafConvertSelectScalar(inBytes, outBytes);
+	U32 count, srcOffset, dstOffset;
+
+	TEST_CHECKF(refFn != NULL, "%s", pName);
+	if (!refFn) {
+		return;
+	}
+
+	for (count = 0; count <= MAX_COUNT; count++) {
+		for (srcOffset = 0; srcOffset < MAX_OFFSET; srcOffset++) {
+			for (dstOffset = 0; dstOffset < MAX_OFFSET; dstOffset += 3) {
+				memset(refBuf, GUARD_FILL, sizeof(refBuf));
+				memset(testBuf, GUARD_FILL, sizeof(testBuf));
+				refFn(refBuf + dstOffset, srcBuf + srcOffset, count);
+				testFn(testBuf + dstOffset, srcBuf + srcOffset, count);
+				TEST_CHECKF(memcmp(refBuf, testBuf, sizeof(refBuf)) == 0,
+					"%s count %u src offset %u dst offset %u", pName, count, srcOffset, dstOffset);
+			}
+		}
+	}
+}
+
+static void x_checkSwap(const char *pName, openavb_aaf_swap_fn_t testFn, U32 sampleBytes)
+{
+	openavb_aaf_swap_fn_t refFn = openavbAafSwapSelectScalar(sampleBytes);
+	U32 count, offset;
+
+	TEST_CHECKF(refFn != NULL, "%s", pName);
+	if (!refFn) {
+		return;
+	}
+
+	for (count = 0; count <= MAX_COUNT; count++) {
+		for (offset = 0; offset < MAX_OFFSET; offset++) {
+			memcpy(refBuf, srcBuf, sizeof(refBuf));
+			memcpy(testBuf, srcBuf, sizeof(testBuf));
+			refFn(refBuf + offset, count);
+			testFn(testBuf + offset, count);
+			TEST_CHECKF(memcmp(refBuf, testBuf, sizeof(refBuf)) == 0,
+				"%s count %u offset %u", pName, count, offset);
+		}
+	}
+}
+
+// Float items with clipping, exact full scale and NaN
+static void x_fillFloatItems(U32 *pState)
+{
+	static const float specials[] = { 0.0f, -0.0f, 1.0f, -1.0f, 0.99999994f, 1.5f, -1.5f, INFINITY, -INFINITY, NAN };
+	float *pFloat = (float *)srcBuf;
+	U32 i1;
+
+	for (i1 = 0; i1 < BUF_BYTES / sizeof(float); i1++) {
+		if (i1 % 7 == 0) {
+			pFloat[i1] = specials[(i1 / 7) % (sizeof(specials) / sizeof(specials[0]))];
+		}
+		else {
+			pFloat[i1] = ((float)(testRand(pState) % 40001) - 20000.0f) / 10000.0f;
+		}
+	}
+}
+
+static void x_checkEncodeDecode(U32 *pState)
+{
+	static const U32 wireBytesList[] = { 2, 3, 4 };
+	U32 i1, itemFloat, wireFloat, srcSpread, dstSpread, count;
+
+	for (i1 = 0; i1 < 3; i1++) {
+		U32 wireBytes = wireBytesList[i1];
+		for (wireFloat = 0; wireFloat < 2; wireFloat++) {
+			if (wireFloat && wireBytes != 4) {
+				continue;
+			}
+			for (itemFloat = 0; itemFloat < 2; itemFloat++) {
+				// Interleaved (stride of one sample) and one channel of a stereo buffer
+				for (srcSpread = 1; srcSpread <= 2; srcSpread++) {
+					for (dstSpread = 1; dstSpread <= 2; dstSpread++) {
+						for (count = 0; count <= MAX_COUNT / 4; count++) {
+							if (itemFloat) {
+								x_fillFloatItems(pState);
+							}
+							else {
+								testRandFill(srcBuf, sizeof(srcBuf), pState);
+							}
+
+							// Encode
+							memset(refBuf, GUARD_FILL, sizeof(refBuf));
+							memset(testBuf, GUARD_FILL, sizeof(testBuf));
+							openavbAafEncodeSamplesScalar(refBuf, wireBytes * dstSpread, wireBytes, wireFloat,
+								srcBuf, 4 * srcSpread, itemFloat, count);
+							openavbAafEncodeSamples(testBuf, wireBytes * dstSpread, wireBytes, wireFloat,
+								srcBuf, 4 * srcSpread, itemFloat, count);
+							TEST_CHECKF(memcmp(refBuf, testBuf, sizeof(refBuf)) == 0,
+								"encode wire %u float %u item float %u spread %u/%u count %u",
+								wireBytes, wireFloat, itemFloat, srcSpread, dstSpread, count);
+
+							// Decode, from random wire samples
+							testRandFill(srcBuf, sizeof(srcBuf), pState);
+							memset(refBuf, GUARD_FILL, sizeof(refBuf));
+							memset(testBuf, GUARD_FILL, sizeof(testBuf));
+							openavbAafDecodeSamplesScalar(refBuf, 4 * dstSpread, itemFloat,
+								srcBuf, wireBytes * srcSpread, wireBytes, wireFloat, count);
+							openavbAafDecodeSamples(testBuf, 4 * dstSpread, itemFloat,
+								srcBuf, wireBytes * srcSpread, wireBytes, wireFloat, count);
+							TEST_CHECKF(memcmp(refBuf, testBuf, sizeof(refBuf)) == 0,
+								"decode wire %u float %u item float %u spread %u/%u count %u",
+								wireBytes, wireFloat, itemFloat, srcSpread, dstSpread, count);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	static const U32 pairs[6][2] = { { 2, 3 }, { 2, 4 }, { 3, 2 }, { 3, 4 }, { 4, 2 }, { 4, 3 } };
+	U32 randState = 0x1722AAF;
+	U32 i1;
+
+	printf("Selected kernels: %s\n", openavbAafConvertIsaName());
+	testRandFill(srcBuf, sizeof(srcBuf), &randState);
+
+	for (i1 = 0; convertKernels[i1].pName; i1++) {
+		if (x_isaAvailable(convertKernels[i1].pIsa)) {
+			x_checkConvert(convertKernels[i1].pName, convertKernels[i1].convertFn,
+				convertKernels[i1].inBytes, convertKernels[i1].outBytes);
+		}
+		else {
+			printf("%s skipped, no %s\n", convertKernels[i1].pName, convertKernels[i1].pIsa);
+		}
+	}
+	for (i1 = 0; i1 < 6; i1++) {
+		openavb_aaf_convert_fn_t selectedFn = openavbAafConvertSelect(pairs[i1][0], pairs[i1][1]);
+		TEST_CHECKF(selectedFn != NULL, "no kernel for %u to %u bytes", pairs[i1][0], pairs[i1][1]);
+		if (selectedFn) {
+			x_checkConvert("selected", selectedFn, pairs[i1][0], pairs[i1][1]);
+		}
+	}
+	TEST_CHECK(openavbAafConvertSelect(2, 2) == NULL);
+	TEST_CHECK(openavbAafConvertSelect(1, 4) == NULL);
+
+	for (i1 = 0; swapKernels[i1].pName; i1++) {
+		if (x_isaAvailable(swapKernels[i1].pIsa)) {
+			x_checkSwap(swapKernels[i1].pName, swapKernels[i1].swapFn, swapKernels[i1].sampleBytes);
+		}
+		else {
+			printf("%s skipped, no %s\n", swapKernels[i1].pName, swapKernels[i1].pIsa);
+		}
+	}
+	for (i1 = 2; i1 <= 4; i1++) {
+		openavb_aaf_swap_fn_t selectedFn = openavbAafSwapSelect(i1);
+		TEST_CHECKF(selectedFn != NULL, "no swap kernel for %u bytes", i1);
+		if (selectedFn) {
+			x_checkSwap("selected swap", selectedFn, i1);
+		}
+	}
+
+	x_checkEncodeDecode(&randState);
+
+	return TEST_RESULT();
+}
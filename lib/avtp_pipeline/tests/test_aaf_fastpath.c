@@ -0,0 +1,363 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Checks the specialized AAF Tx/Rx callbacks against the generic path.
+*
+* Each stream format with a specialized callback is opened twice, once as configured and
+* once with map_nv_fast_path=0, and both get the same items (talker) or the same frames
+* (listener). Frames and items must come out byte for byte the same. The talker items mix
+* valid, invalid and uncertain timestamps; the listener frames mix matching packets with
+* ones that take the generic header checks: other sample sizes to convert, other channel
+* counts and too short payloads.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "openavb_test.h"
+
+// The callbacks and the private data are static, build the module into the test
+#include "openavb_map_aaf_audio.c"
+#include "openavb_map_aaf_audio_convert.c"
+
+#define TEST_TRANSIT_USEC	2000
+#define TEST_PACKETS		500
+#define TEST_FRAME_LEN		1500
+
+typedef struct {
+	const char *pName;
+	U32 channels;
+	avb_audio_bit_depth_t bitDepth;
+	const char *pTxRate;
+	bool bSparse;
+} fastpath_case_t;
+
+// One case per entry of x_fastPaths, and one in sparse mode
+static const fastpath_case_t fastpathCases[] = {
+	{ "2ch_s16_6", 2, AVB_AUDIO_BIT_DEPTH_16BIT, "8000", FALSE },
+	{ "2ch_s24_6", 2, AVB_AUDIO_BIT_DEPTH_24BIT, "8000", FALSE },
+	{ "2ch_s32_6", 2, AVB_AUDIO_BIT_DEPTH_32BIT, "8000", FALSE },
+	{ "8ch_s16_6", 8, AVB_AUDIO_BIT_DEPTH_16BIT, "8000", FALSE },
+	{ "8ch_s24_6", 8, AVB_AUDIO_BIT_DEPTH_24BIT, "8000", FALSE },
+	{ "8ch_s32_6", 8, AVB_AUDIO_BIT_DEPTH_32BIT, "8000", FALSE },
+	{ "2ch_s16_12", 2, AVB_AUDIO_BIT_DEPTH_16BIT, "4000", FALSE },
+	{ "8ch_s24_12", 8, AVB_AUDIO_BIT_DEPTH_24BIT, "4000", FALSE },
+	{ "2ch_s24_6_sparse", 2, AVB_AUDIO_BIT_DEPTH_24BIT, "8000", TRUE },
+};
+
+#define FASTPATH_CASE_COUNT	(sizeof(fastpathCases) / sizeof(fastpathCases[0]))
+
+typedef struct {
+	media_q_t *pMediaQ;
+	openavb_map_cb_t mapCB;
+} test_map_t;
+
+// Configure a mapping as openavbTLConfigure() does, with the fields an interface sets.
+static bool x_mapOpen(test_map_t *pMap, const fastpath_case_t *pCase, bool bTalker, bool bFastPath)
+{
+	memset(pMap, 0, sizeof(*pMap));
+	pMap->pMediaQ = openavbMediaQCreate();
+	if (!pMap->pMediaQ || !openavbMapAVTPAudioInitialize(pMap->pMediaQ, &pMap->mapCB, TEST_TRANSIT_USEC)) {
+		return FALSE;
+	}
+
+	pMap->mapCB.map_cfg_cb(pMap->pMediaQ, "map_nv_tx_rate", pCase->pTxRate);
+	pMap->mapCB.map_cfg_cb(pMap->pMediaQ, "map_nv_sparse_mode", pCase->bSparse ? "1" : "0");
+	if (!bFastPath) {
+		pMap->mapCB.map_cfg_cb(pMap->pMediaQ, "map_nv_fast_path", "0");
+	}
+
+	media_q_pub_map_aaf_audio_info_t *pPubMapInfo = pMap->pMediaQ->pPubMapInfo;
+	pPubMapInfo->audioRate = AVB_AUDIO_RATE_48KHZ;
+	pPubMapInfo->audioType = AVB_AUDIO_TYPE_INT;
+	pPubMapInfo->audioBitDepth = pCase->bitDepth;
+	pPubMapInfo->audioEndian = AVB_AUDIO_ENDIAN_BIG;
+	pPubMapInfo->audioChannels = pCase->channels;
+
+	pMap->mapCB.map_gen_init_cb(pMap->pMediaQ);
+	if (bTalker) {
+		pMap->mapCB.map_tx_init_cb(pMap->pMediaQ);
+	}
+	else {
+		pMap->mapCB.map_rx_init_cb(pMap->pMediaQ);
+	}
+	return TRUE;
+}
+
+static void x_mapClose(test_map_t *pMap)
+{
+	if (pMap->pMediaQ) {
+		if (pMap->mapCB.map_end_cb) {
+			pMap->mapCB.map_end_cb(pMap->pMediaQ);
+			pMap->mapCB.map_gen_end_cb(pMap->pMediaQ);
+		}
+		openavbMediaQDelete(pMap->pMediaQ);
+	}
+}
+
+// Check that one mapping took the specialized callback and the other the generic one
+static void x_checkSelected(const fastpath_case_t *pCase, test_map_t *pFast, test_map_t *pGeneric, bool bTalker)
+{
+	pvt_data_t *pFastData = pFast->pMediaQ->pPvtMapInfo;
+	pvt_data_t *pGenericData = pGeneric->pMediaQ->pPvtMapInfo;
+
+	if (bTalker) {
+		TEST_CHECKF(pFastData->txFastCB != NULL, "%s talker", pCase->pName);
+		TEST_CHECKF(pGenericData->txFastCB == NULL, "%s talker", pCase->pName);
+	}
+	else {
+		TEST_CHECKF(pFastData->rxFastCB != NULL, "%s listener", pCase->pName);
+		TEST_CHECKF(pGenericData->rxFastCB == NULL, "%s listener", pCase->pName);
+	}
+}
+
+// The AVTP stream header the AVTP layer fills before the Tx callback
+static void x_fillAvtpHdr(U8 *pFrame, U32 seq)
+{
+	static const U8 streamIDnet[8] = { 0x00, 0x1b, 0x21, 0x00, 0x00, 0x01, 0x00, 0x01 };
+
+	pFrame[0] = AVTP_SUBTYPE_AAF;
+	pFrame[1] = 0x81;
+	pFrame[2] = seq;
+	pFrame[3] = 0;
+	memcpy(pFrame + 4, streamIDnet, sizeof(streamIDnet));
+}
+
+// Put the same items in both talker queues until they are full
+static void x_fillItems(const fastpath_case_t *pCase, media_q_t *pFastQ, media_q_t *pGenericQ, U32 *pSeed, U32 *pItemNum)
+{
+	media_q_item_t *pFastItem;
+
+	while ((pFastItem = openavbMediaQHeadLock(pFastQ)) != NULL) {
+		media_q_item_t *pGenericItem = openavbMediaQHeadLock(pGenericQ);
+		TEST_CHECKF(pGenericItem != NULL, "%s item %u", pCase->pName, *pItemNum);
+		if (!pGenericItem) {
+			openavbMediaQHeadUnlock(pFastQ);
+			return;
+		}
+
+		testRandFill(pFastItem->pPubData, pFastItem->itemSize, pSeed);
+		memcpy(pGenericItem->pPubData, pFastItem->pPubData, pFastItem->itemSize);
+		pFastItem->dataLen = pGenericItem->dataLen = pFastItem->itemSize;
+		pFastItem->readIdx = pGenericItem->readIdx = 0;
+
+		// Every fifth item has no timestamp, every third is uncertain
+		U64 timeNS = 1000000000ULL + (U64)*pItemNum * 125000;
+		openavbAvtpTimeSetToTimestampNS(pFastItem->pAvtpTime, timeNS);
+		openavbAvtpTimeSetToTimestampNS(pGenericItem->pAvtpTime, timeNS);
+		if (*pItemNum % 5 == 4) {
+			openavbAvtpTimeSetTimestampValid(pFastItem->pAvtpTime, FALSE);
+			openavbAvtpTimeSetTimestampValid(pGenericItem->pAvtpTime, FALSE);
+		}
+		if (*pItemNum % 3 == 0) {
+			openavbAvtpTimeSetTimestampUncertain(pFastItem->pAvtpTime, TRUE);
+			openavbAvtpTimeSetTimestampUncertain(pGenericItem->pAvtpTime, TRUE);
+		}
+
+		openavbMediaQHeadPush(pFastQ);
+		openavbMediaQHeadPush(pGenericQ);
+		(*pItemNum)++;
+	}
+}
+
+static void x_runTalker(const fastpath_case_t *pCase)
+{
+	test_map_t fast, generic;
+	U8 fastFrame[TEST_FRAME_LEN], genericFrame[TEST_FRAME_LEN];
+	U32 seed = 0x1234567, itemNum = 0, packet;
+
+	bool bOpen = x_mapOpen(&fast, pCase, TRUE, TRUE) && x_mapOpen(&generic, pCase, TRUE, FALSE);
+	TEST_CHECKF(bOpen, "%s talker", pCase->pName);
+	if (bOpen) {
+		x_checkSelected(pCase, &fast, &generic, TRUE);
+
+		for (packet = 0; packet < TEST_PACKETS; packet++) {
+			x_fillItems(pCase, fast.pMediaQ, generic.pMediaQ, &seed, &itemNum);
+
+			memset(fastFrame, 0, sizeof(fastFrame));
+			x_fillAvtpHdr(fastFrame, packet);
+			memcpy(genericFrame, fastFrame, sizeof(genericFrame));
+
+			U32 fastLen = sizeof(fastFrame), genericLen = sizeof(genericFrame);
+			tx_cb_ret_t fastRet = fast.mapCB.map_tx_cb(fast.pMediaQ, fastFrame, &fastLen);
+			tx_cb_ret_t genericRet = generic.mapCB.map_tx_cb(generic.pMediaQ, genericFrame, &genericLen);
+
+			TEST_CHECKF(fastRet == TX_CB_RET_PACKET_READY, "%s packet %u", pCase->pName, packet);
+			TEST_CHECKF(fastRet == genericRet, "%s packet %u", pCase->pName, packet);
+			TEST_CHECKF(fastLen == genericLen, "%s packet %u length %u != %u", pCase->pName, packet, fastLen, genericLen);
+			if (fastRet != genericRet || fastLen != genericLen || memcmp(fastFrame, genericFrame, sizeof(fastFrame)) != 0) {
+				TEST_CHECKF(FALSE, "%s packet %u differs", pCase->pName, packet);
+				break;
+			}
+		}
+	}
+
+	x_mapClose(&fast);
+	x_mapClose(&generic);
+}
+
+// Build a listener frame. Most match the stream; some carry another sample size the
+// listener converts, another channel count or a stream data length past the frame.
+static U32 x_buildFrame(const fastpath_case_t *pCase, media_q_t *pMediaQ, U8 *pFrame, U32 seq, U32 *pSeed)
+{
+	media_q_pub_map_aaf_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+	pvt_data_t *pPvtData = pMediaQ->pPvtMapInfo;
+	U32 formatInfo = pPvtData->formatInfo;
+	U32 payloadSize = pPvtData->payloadSize;
+	U32 dataLen;
+
+	memset(pFrame, 0, TEST_FRAME_LEN);
+	x_fillAvtpHdr(pFrame, seq);
+
+	if (seq % 11 == 5) {
+		// Another integer sample size, converted by the listener
+		aaf_sample_format_t format = pPvtData->aaf_format == AAF_FORMAT_INT_16 ? AAF_FORMAT_INT_24 : AAF_FORMAT_INT_16;
+		U32 sampleBytes = 6 - format;
+		formatInfo = (formatInfo & 0x00FFFF00) | (format << 24) | (sampleBytes * 8);
+		payloadSize = pPubMapInfo->audioChannels * pPubMapInfo->framesPerPacket * sampleBytes;
+	}
+	else if (seq % 17 == 3) {
+		formatInfo = (formatInfo & ~0x3FF00) | ((pPubMapInfo->audioChannels + 1) << 8);
+	}
+	dataLen = TOTAL_HEADER_SIZE + payloadSize;
+
+	if (seq % 3 != 1) {
+		pFrame[HIDX_AVTP_HIDE7_TV1] |= 0x01;
+	}
+	if (seq % 7 == 2) {
+		pFrame[HIDX_AVTP_HIDE7_TU1] |= 0x01;
+	}
+
+	U32 *pHdr = (U32 *)(pFrame + AVTP_V0_HEADER_SIZE);
+	*pHdr++ = htonl(testRand(pSeed));
+	*pHdr++ = htonl(formatInfo);
+	*pHdr++ = htonl((payloadSize << 16) | (pPvtData->aaf_event_field << 8));
+	if (pCase->bSparse) {
+		pFrame[HIDX_AVTP_HIDE7_SP] |= SP_M0_BIT;
+	}
+	testRandFill(pFrame + TOTAL_HEADER_SIZE, payloadSize, pSeed);
+
+	if (seq % 19 == 7) {
+		dataLen -= 4;
+	}
+	return dataLen;
+}
+
+// Compare the items both listeners completed and release them
+static bool x_compareItems(const fastpath_case_t *pCase, media_q_t *pFastQ, media_q_t *pGenericQ, U32 packet)
+{
+	media_q_item_t *pFastItem, *pGenericItem;
+	bool bSame = TRUE;
+
+	while (1) {
+		pFastItem = openavbMediaQTailLock(pFastQ, TRUE);
+		pGenericItem = openavbMediaQTailLock(pGenericQ, TRUE);
+		if (!pFastItem || !pGenericItem) {
+			break;
+		}
+
+		if (pFastItem->dataLen != pGenericItem->dataLen
+				|| memcmp(pFastItem->pPubData, pGenericItem->pPubData, pFastItem->dataLen) != 0
+				|| openavbAvtpTimeTimestampIsValid(pFastItem->pAvtpTime) != openavbAvtpTimeTimestampIsValid(pGenericItem->pAvtpTime)
+				|| openavbAvtpTimeTimestampIsUncertain(pFastItem->pAvtpTime) != openavbAvtpTimeTimestampIsUncertain(pGenericItem->pAvtpTime)) {
+			bSame = FALSE;
+		}
+		openavbMediaQTailPull(pFastQ);
+		openavbMediaQTailPull(pGenericQ);
+	}
+
+	TEST_CHECKF(!pFastItem && !pGenericItem, "%s packet %u items", pCase->pName, packet);
+	if (pFastItem) {
+		openavbMediaQTailUnlock(pFastQ);
+	}
+	if (pGenericItem) {
+		openavbMediaQTailUnlock(pGenericQ);
+	}
+	TEST_CHECKF(bSame, "%s packet %u item differs", pCase->pName, packet);
+	return bSame;
+}
+
+static void x_runListener(const fastpath_case_t *pCase)
+{
+	test_map_t fast, generic;
+	U8 fastFrame[TEST_FRAME_LEN], genericFrame[TEST_FRAME_LEN];
+	U32 seed = 0x7654321, packet, items = 0;
+
+	bool bOpen = x_mapOpen(&fast, pCase, FALSE, TRUE) && x_mapOpen(&generic, pCase, FALSE, FALSE);
+	TEST_CHECKF(bOpen, "%s listener", pCase->pName);
+	if (bOpen) {
+		x_checkSelected(pCase, &fast, &generic, FALSE);
+
+		// Without gPTP the received timestamps can't be placed in time, so no packet would
+		// start an item. Start both as if a timestamped packet had already arrived.
+		((pvt_data_t *)fast.pMediaQ->pPvtMapInfo)->mediaQItemSyncTS = TRUE;
+		((pvt_data_t *)generic.pMediaQ->pPvtMapInfo)->mediaQItemSyncTS = TRUE;
+
+		for (packet = 0; packet < TEST_PACKETS; packet++) {
+			U32 frameLen = x_buildFrame(pCase, fast.pMediaQ, fastFrame, packet, &seed);
+			memcpy(genericFrame, fastFrame, sizeof(genericFrame));
+
+			bool fastRet = fast.mapCB.map_rx_cb(fast.pMediaQ, fastFrame, frameLen);
+			bool genericRet = generic.mapCB.map_rx_cb(generic.pMediaQ, genericFrame, frameLen);
+			TEST_CHECKF(fastRet == genericRet, "%s packet %u", pCase->pName, packet);
+			if (fastRet) {
+				items++;
+			}
+			if (fastRet != genericRet || !x_compareItems(pCase, fast.pMediaQ, generic.pMediaQ, packet)) {
+				break;
+			}
+		}
+		// Most packets must have made it into items, or nothing was compared
+		TEST_CHECKF(items > TEST_PACKETS / 2, "%s listener %u items", pCase->pName, items);
+	}
+
+	x_mapClose(&fast);
+	x_mapClose(&generic);
+}
+
+int main(int argc, char *argv[])
+{
+	U32 i1;
+
+	// Invalid timestamps and mismatched packets are logged, keep that out of the output
+	FILE *pLogFile = fopen("/dev/null", "w");
+	avbLogInitEx(pLogFile);
+	for (i1 = 0; i1 < FASTPATH_CASE_COUNT; i1++) {
+		x_runTalker(&fastpathCases[i1]);
+		x_runListener(&fastpathCases[i1]);
+	}
+	avbLogExit();
+	if (pLogFile) {
+		fclose(pLogFile);
+	}
+
+	return TEST_RESULT();
+}
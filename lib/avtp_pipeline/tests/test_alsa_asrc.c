@@ -0,0 +1,347 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Checks the adaptive sample rate converter of the ALSA interface module.
+*
+* The vector filters compiled for this CPU are compared with the scalar filter for every
+* phase and channel count. The converter itself is checked for level and byte order in
+* every sample encoding, for output that does not depend on how the input is split into
+* calls, for distortion of a sine converted at a fixed ratio, and for the control loop
+* settling on the clock offset of a simulated audio device.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "openavb_test.h"
+
+// The filters are static, build the module into the test to reach all of them
+#include "openavb_intf_alsa_asrc.c"
+
+#define TEST_RATE			48000
+#define TEST_PERIOD			480			// Frames per call, 10 ms
+#define TEST_MAX_CHANNELS	9			// More than one vector of channels plus a tail
+#define TEST_MAX_PPM		1000
+
+typedef struct {
+	const char *pName;
+	const char *pIsa;		// Needed CPU feature, NULL when always present
+	asrc_frame_fn_t frameFn;
+} frame_kernel_t;
+
+static const frame_kernel_t frameKernels[] = {
+#if ASRC_X86
+	{ "sse", "sse", x_sseFrame },
+	{ "avx", "avx", x_avxFrame },
+#elif ASRC_NEON
+	{ "neon", NULL, x_neonFrame },
+#endif
+	{ NULL, NULL, NULL }
+};
+
+static bool x_isaAvailable(const char *pIsa)
+{
+#if ASRC_X86
+	__builtin_cpu_init();
+	if (pIsa && strcmp(pIsa, "avx") == 0)
+		return __builtin_cpu_supports("avx");
+	if (pIsa && strcmp(pIsa, "sse") == 0)
+		return __builtin_cpu_supports("sse");
+#endif
+	return TRUE;
+}
+
+static float x_randSample(U32 *pState)
+{
+	return ((float)(testRand(pState) % 20001) - 10000.0f) / 10000.0f;
+}
+
+// Every phase and interpolation point of one filter against the scalar filter
+static void x_checkFrameKernel(const frame_kernel_t *pKernel, openavb_asrc_t *pAsrc, U32 *pState)
+{
+	float hist[TEST_MAX_CHANNELS][ASRC_TAPS + 8];
+	float *ppHist[TEST_MAX_CHANNELS];
+	float ref[TEST_MAX_CHANNELS], out[TEST_MAX_CHANNELS];
+	U32 channels, ch, t, phase, step, idx;
+
+	for (ch = 0; ch < TEST_MAX_CHANNELS; ch++) {
+		ppHist[ch] = hist[ch];
+	}
+
+	for (channels = 1; channels <= TEST_MAX_CHANNELS; channels++) {
+		for (phase = 0; phase < ASRC_PHASES; phase++) {
+			for (step = 0; step < 4; step++) {
+				float frac = step / 4.0f;
+
+				// History offsets move the unaligned loads across vector boundaries
+				idx = (phase + step) % 8;
+				for (ch = 0; ch < channels; ch++) {
+					for (t = 0; t < ASRC_TAPS + 8; t++) {
+						hist[ch][t] = x_randSample(pState);
+					}
+				}
+
+				memset(out, 0, sizeof(out));
+				x_scalarFrame(ppHist, idx, channels, pAsrc->pCoef + phase * ASRC_TAPS, pAsrc->pDelta + phase * ASRC_TAPS, frac, ref);
+				pKernel->frameFn(ppHist, idx, channels, pAsrc->pCoef + phase * ASRC_TAPS, pAsrc->pDelta + phase * ASRC_TAPS, frac, out);
+				for (ch = 0; ch < TEST_MAX_CHANNELS; ch++) {
+					if (ch < channels) {
+						TEST_CHECKF(fabsf(out[ch] - ref[ch]) < 1e-5f, "%s channels %u phase %u frac %.2f channel %u: %g != %g",
+							pKernel->pName, channels, phase, frac, ch, out[ch], ref[ch]);
+					}
+					else {
+						TEST_CHECKF(out[ch] == 0, "%s channels %u wrote channel %u", pKernel->pName, channels, ch);
+					}
+				}
+			}
+		}
+	}
+}
+
+// A constant level must come out unchanged, in both byte orders, at any ratio.
+static void x_checkLevel(openavb_asrc_sample_t sample, const char *pName)
+{
+	static const float level = 0.3125f;
+	U8 in[TEST_PERIOD * 2 * 4];
+	U8 out[2][(TEST_PERIOD * 2 + 8) * 2 * 4];
+	U32 be, i1, outFrames[2] = { 0, 0 };
+
+	for (be = 0; be < 2; be++) {
+		openavb_asrc_t *pAsrc = openavbAsrcCreate(2, sample, be, TEST_PERIOD, TEST_MAX_PPM);
+		TEST_CHECKF(pAsrc != NULL, "%s", pName);
+		if (!pAsrc) {
+			return;
+		}
+		U32 frameBytes = 2 * pAsrc->sampleBytes;
+		TEST_CHECK(openavbAsrcMaxOutFrames(pAsrc) >= TEST_PERIOD * (1 + TEST_MAX_PPM / 1e6));
+
+		for (i1 = 0; i1 < TEST_PERIOD * 2; i1++) {
+			x_storeSample(pAsrc, in + i1 * pAsrc->sampleBytes, (i1 & 1) ? -level : level);
+		}
+		pAsrc->step = (U64)((1.0 - 0.0007) * ASRC_FIXED_ONE);
+		outFrames[be] = openavbAsrcProcess(pAsrc, in, TEST_PERIOD, out[be]);
+		outFrames[be] += openavbAsrcProcess(pAsrc, in, TEST_PERIOD, out[be] + outFrames[be] * frameBytes);
+		TEST_CHECKF(outFrames[be] <= 2 * openavbAsrcMaxOutFrames(pAsrc), "%s %u frames", pName, outFrames[be]);
+
+		// Skip the frames that still see the leading silence
+		for (i1 = ASRC_TAPS; i1 < outFrames[be]; i1++) {
+			float left = x_loadSample(pAsrc, out[be] + i1 * frameBytes);
+			float right = x_loadSample(pAsrc, out[be] + i1 * frameBytes + pAsrc->sampleBytes);
+			TEST_CHECKF(fabsf(left - level) < 1e-6f && fabsf(right + level) < 1e-6f,
+				"%s big endian %u frame %u: %g %g", pName, be, i1, left, right);
+		}
+		openavbAsrcDelete(pAsrc);
+	}
+	TEST_CHECKF(outFrames[0] == outFrames[1], "%s %u != %u frames", pName, outFrames[0], outFrames[1]);
+}
+
+// The output must not depend on how the input is split into calls.
+static void x_checkSplit(U32 *pState)
+{
+	enum { TOTAL = TEST_PERIOD * 8, CHANNELS = 3 };
+	static float in[TOTAL * CHANNELS];
+	static float outWhole[(TOTAL + 64) * CHANNELS], outSplit[(TOTAL + 64) * CHANNELS];
+	U32 i1, whole = 0, split = 0, done = 0;
+
+	for (i1 = 0; i1 < TOTAL * CHANNELS; i1++) {
+		in[i1] = x_randSample(pState) * 0.5f;
+	}
+
+	openavb_asrc_t *pWhole = openavbAsrcCreate(CHANNELS, ASRC_SAMPLE_FLOAT, FALSE, TOTAL, TEST_MAX_PPM);
+	openavb_asrc_t *pSplit = openavbAsrcCreate(CHANNELS, ASRC_SAMPLE_FLOAT, FALSE, TEST_PERIOD, TEST_MAX_PPM);
+	TEST_CHECK(pWhole && pSplit);
+	if (!pWhole || !pSplit) {
+		openavbAsrcDelete(pWhole);
+		openavbAsrcDelete(pSplit);
+		return;
+	}
+	pWhole->step = pSplit->step = (U64)((1.0 + 0.000613) * ASRC_FIXED_ONE);
+
+	whole = openavbAsrcProcess(pWhole, (U8 *)in, TOTAL, (U8 *)outWhole);
+	while (done < TOTAL) {
+		// Odd sizes, including single frames and calls capped at maxInFrames
+		U32 count = 1 + testRand(pState) % (TEST_PERIOD + 100);
+		if (count > TOTAL - done) {
+			count = TOTAL - done;
+		}
+		U32 used = count > TEST_PERIOD ? TEST_PERIOD : count;
+		split += openavbAsrcProcess(pSplit, (U8 *)(in + done * CHANNELS), count, (U8 *)(outSplit + split * CHANNELS));
+		done += used;
+	}
+
+	TEST_CHECKF(whole == split, "%u != %u frames", whole, split);
+	TEST_CHECK(memcmp(outWhole, outSplit, (whole < split ? whole : split) * CHANNELS * sizeof(float)) == 0);
+	TEST_CHECK(fabs(openavbAsrcBufferedFrames(pWhole) - openavbAsrcBufferedFrames(pSplit)) < 1e-9);
+
+	openavbAsrcDelete(pWhole);
+	openavbAsrcDelete(pSplit);
+}
+
+// Residual of a sine converted at a fixed ratio, after fitting the ideal output sine
+static void x_checkDistortion(double ppm)
+{
+	enum { PERIODS = 100 };
+	static float in[TEST_PERIOD], out[TEST_PERIOD * 2];
+	const double freq = 997.0;
+	double ratio = 1.0 + ppm / 1e6;
+	double outFreq = freq * ratio;
+	double sumS = 0, sumC = 0, sumSS = 0, sumCC = 0, sumSC = 0, sumYS = 0, sumYC = 0, sumYY = 0;
+	U32 period, i1, n = 0, outCount = 0;
+
+	openavb_asrc_t *pAsrc = openavbAsrcCreate(1, ASRC_SAMPLE_FLOAT, FALSE, TEST_PERIOD, TEST_MAX_PPM);
+	TEST_CHECK(pAsrc != NULL);
+	if (!pAsrc) {
+		return;
+	}
+	pAsrc->step = (U64)(ratio * ASRC_FIXED_ONE + 0.5);
+
+	for (period = 0; period < PERIODS; period++) {
+		for (i1 = 0; i1 < TEST_PERIOD; i1++) {
+			in[i1] = 0.5 * sin(2.0 * M_PI * freq * (period * TEST_PERIOD + i1) / TEST_RATE);
+		}
+		U32 frames = openavbAsrcProcess(pAsrc, (U8 *)in, TEST_PERIOD, (U8 *)out);
+		for (i1 = 0; i1 < frames; i1++, outCount++) {
+			// Skip the start up transient
+			if (outCount < TEST_PERIOD) {
+				continue;
+			}
+			double w = 2.0 * M_PI * outFreq * outCount / TEST_RATE;
+			double s = sin(w), c = cos(w), y = out[i1];
+			sumS += s; sumC += c; sumSS += s * s; sumCC += c * c; sumSC += s * c;
+			sumYS += y * s; sumYC += y * c; sumYY += y * y;
+			n++;
+		}
+	}
+
+	// Least squares fit of a * sin + b * cos, then the residual energy
+	double det = sumSS * sumCC - sumSC * sumSC;
+	double a = (sumYS * sumCC - sumYC * sumSC) / det;
+	double b = (sumYC * sumSS - sumYS * sumSC) / det;
+	double residual = sumYY - a * sumYS - b * sumYC;
+	double signal = (a * a + b * b) / 2 * n;
+	double db = 10.0 * log10((residual > 0 ? residual : 1e-30) / signal);
+
+	TEST_CHECKF(fabs(sqrt(a * a + b * b) - 0.5) < 0.001, "%+.0f ppm amplitude %f", ppm, sqrt(a * a + b * b));
+	TEST_CHECKF(db < -80.0, "%+.0f ppm residual %.1f dB", ppm, db);
+	printf("%+5.0f ppm: residual %.1f dB\n", ppm, db);
+
+	openavbAsrcDelete(pAsrc);
+}
+
+// Play into a simulated device whose clock is off by devicePpm and let the loop follow it.
+static void x_checkSettle(double devicePpm)
+{
+	enum { SECONDS = 400 };
+	static float in[TEST_PERIOD], out[TEST_PERIOD * 2];
+	const double interval = (double)TEST_PERIOD / TEST_RATE;
+	double deviceQueued = TEST_RATE * 0.020, targetSec = 0;
+	U32 tick;
+
+	openavb_asrc_t *pAsrc = openavbAsrcCreate(1, ASRC_SAMPLE_FLOAT, FALSE, TEST_PERIOD, TEST_MAX_PPM);
+	TEST_CHECK(pAsrc != NULL);
+	if (!pAsrc) {
+		return;
+	}
+	memset(in, 0, sizeof(in));
+
+	for (tick = 0; tick < SECONDS / interval; tick++) {
+		deviceQueued += openavbAsrcProcess(pAsrc, (U8 *)in, TEST_PERIOD, (U8 *)out);
+		deviceQueued -= TEST_PERIOD * (1.0 + devicePpm / 1e6);
+
+		double queuedSec = (deviceQueued + openavbAsrcBufferedFrames(pAsrc)) / TEST_RATE;
+		if (tick == 0) {
+			targetSec = queuedSec;
+		}
+		else {
+			openavbAsrcControl(pAsrc, queuedSec - targetSec, interval);
+		}
+		TEST_CHECKF(deviceQueued > 0, "%+.0f ppm device underrun at %.2f s", devicePpm, tick * interval);
+		if (deviceQueued <= 0) {
+			break;
+		}
+	}
+
+	double ppm = openavbAsrcGetPpm(pAsrc);
+	double errorMs = ((deviceQueued + openavbAsrcBufferedFrames(pAsrc)) / TEST_RATE - targetSec) * 1000.0;
+	TEST_CHECKF(fabs(ppm + devicePpm) < 2.0, "device %+.0f ppm, converter %+.2f ppm", devicePpm, ppm);
+	TEST_CHECKF(fabs(errorMs) < 0.5, "device %+.0f ppm, error %.3f ms", devicePpm, errorMs);
+	printf("device %+5.0f ppm: converter %+.2f ppm, error %.3f ms\n", devicePpm, ppm, errorMs);
+
+	// A resync keeps the learned offset
+	openavbAsrcResync(pAsrc);
+	TEST_CHECKF(fabs(openavbAsrcGetPpm(pAsrc) + devicePpm) < 5.0, "device %+.0f ppm, after resync %+.2f ppm", devicePpm, openavbAsrcGetPpm(pAsrc));
+
+	openavbAsrcDelete(pAsrc);
+}
+
+int main(int argc, char *argv[])
+{
+	U32 randState = 0x1722A5C;
+	U32 i1;
+
+	printf("Selected filter: %s\n", openavbAsrcIsaName());
+
+	TEST_CHECK(openavbAsrcCreate(0, ASRC_SAMPLE_S16, FALSE, TEST_PERIOD, TEST_MAX_PPM) == NULL);
+	TEST_CHECK(openavbAsrcCreate(2, ASRC_SAMPLE_S16, FALSE, 0, TEST_MAX_PPM) == NULL);
+	TEST_CHECK(openavbAsrcCreate(2, (openavb_asrc_sample_t)99, FALSE, TEST_PERIOD, TEST_MAX_PPM) == NULL);
+
+	openavb_asrc_t *pAsrc = openavbAsrcCreate(TEST_MAX_CHANNELS, ASRC_SAMPLE_FLOAT, FALSE, TEST_PERIOD, TEST_MAX_PPM);
+	TEST_CHECK(pAsrc != NULL);
+	if (pAsrc) {
+		for (i1 = 0; frameKernels[i1].pName; i1++) {
+			if (x_isaAvailable(frameKernels[i1].pIsa)) {
+				x_checkFrameKernel(&frameKernels[i1], pAsrc, &randState);
+			}
+			else {
+				printf("%s skipped, no %s\n", frameKernels[i1].pName, frameKernels[i1].pIsa);
+			}
+		}
+		openavbAsrcDelete(pAsrc);
+	}
+
+	x_checkLevel(ASRC_SAMPLE_S16, "S16");
+	x_checkLevel(ASRC_SAMPLE_S24_3, "S24_3");
+	x_checkLevel(ASRC_SAMPLE_S24_4, "S24_4");
+	x_checkLevel(ASRC_SAMPLE_S32, "S32");
+	x_checkLevel(ASRC_SAMPLE_FLOAT, "FLOAT");
+
+	x_checkSplit(&randState);
+
+	x_checkDistortion(0);
+	x_checkDistortion(500);
+	x_checkDistortion(-500);
+
+	x_checkSettle(180);
+	x_checkSettle(-180);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,220 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Checks the 61883-6 AM824 packing kernels against the scalar reference.
+*
+* Every vector kernel compiled for this CPU is run, not only the one openavbAm824PackSelect()
+* picks. Each channel count from 1 to 64 is packed and unpacked for packets of 1 to 12 frames,
+* with the 24 and 16 bit MBLA labels the mapping module uses, and every label is packed once
+* per channel count. The source is allocated to the exact size so reads past the end show up under
+* AddressSanitizer, and a guard area after the output catches writes past the end.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "openavb_test.h"
+
+// The kernels are static, build the module into the test to reach all of them
+#include "openavb_map_uncmp_audio_am824.c"
+
+#define MAX_CHANNELS	64
+#define MAX_FRAMES		12
+#define MAX_SAMPLES		(MAX_CHANNELS * MAX_FRAMES)
+#define GUARD_BYTES		64
+#define GUARD_FILL		0xA5
+#define BUF_BYTES		(MAX_SAMPLES * 4 + GUARD_BYTES)
+
+typedef struct {
+	const char *pName;
+	const char *pIsa;		// Needed CPU feature, NULL when always present
+	openavb_am824_pack_fn_t packFn;
+	openavb_am824_unpack_fn_t unpackFn;
+	U32 sampleBytes;
+} am824_kernel_t;
+
+static const am824_kernel_t kernels[] = {
+#if AM824_X86
+	{ "sse2Pack16", "sse2", x_sse2Pack16, NULL, 2 },
+	{ "ssse3Pack24", "ssse3", x_ssse3Pack24, NULL, 3 },
+	{ "ssse3Unpack16", "ssse3", NULL, x_ssse3Unpack16, 2 },
+	{ "ssse3Unpack24", "ssse3", NULL, x_ssse3Unpack24, 3 },
+	{ "avx2Pack16", "avx2", x_avx2Pack16, NULL, 2 },
+	{ "avx2Pack24", "avx2", x_avx2Pack24, NULL, 3 },
+	{ "avx2Unpack16", "avx2", NULL, x_avx2Unpack16, 2 },
+#elif AM824_NEON
+	{ "neonPack16", NULL, x_neonPack16, NULL, 2 },
+	{ "neonPack24", NULL, x_neonPack24, NULL, 3 },
+	{ "neonUnpack16", NULL, NULL, x_neonUnpack16, 2 },
+	{ "neonUnpack24", NULL, NULL, x_neonUnpack24, 3 },
+#endif
+	{ NULL, NULL, NULL, NULL, 0 }
+};
+
+// Labels set by the mapping module: multi-bit linear audio, 24 and 16 bit
+static const U8 mapperLabels[] = { 0x40, 0x42 };
+
+static U8 refBuf[BUF_BYTES];
+static U8 testBuf[BUF_BYTES];
+
+static bool x_isaAvailable(const char *pIsa)
+{
+#if AM824_X86
+	return !pIsa || x_cpuHas(pIsa);
+#else
+	return TRUE;
+#endif
+}
+
+// Pack sampleCount samples with both kernels. Returns FALSE on a mismatch.
+static bool x_checkPack(openavb_am824_pack_fn_t testFn, openavb_am824_pack_fn_t refFn,
+	U32 sampleBytes, U32 sampleCount, U8 label, U32 *pState)
+{
+	U8 *pSrc = malloc(sampleCount * sampleBytes + 1);
+	if (!pSrc) {
+		return FALSE;
+	}
+	testRandFill(pSrc, sampleCount * sampleBytes, pState);
+
+	memset(refBuf, GUARD_FILL, sizeof(refBuf));
+	memset(testBuf, GUARD_FILL, sizeof(testBuf));
+	refFn(refBuf, pSrc, sampleCount, label);
+	testFn(testBuf, pSrc, sampleCount, label);
+	free(pSrc);
+	return memcmp(refBuf, testBuf, sizeof(refBuf)) == 0;
+}
+
+// Unpack sampleCount random quadlets with both kernels. Returns FALSE on a mismatch.
+static bool x_checkUnpack(openavb_am824_unpack_fn_t testFn, openavb_am824_unpack_fn_t refFn,
+	U32 sampleCount, U32 *pState)
+{
+	U8 *pSrc = malloc(sampleCount * 4 + 1);
+	if (!pSrc) {
+		return FALSE;
+	}
+	testRandFill(pSrc, sampleCount * 4, pState);
+
+	memset(refBuf, GUARD_FILL, sizeof(refBuf));
+	memset(testBuf, GUARD_FILL, sizeof(testBuf));
+	refFn(refBuf, pSrc, sampleCount);
+	testFn(testBuf, pSrc, sampleCount);
+	free(pSrc);
+	return memcmp(refBuf, testBuf, sizeof(refBuf)) == 0;
+}
+
+static void x_checkKernel(const am824_kernel_t *pKernel, U32 *pState)
+{
+	openavb_am824_pack_fn_t refPack = openavbAm824PackSelectScalar(pKernel->sampleBytes);
+	openavb_am824_unpack_fn_t refUnpack = openavbAm824UnpackSelectScalar(pKernel->sampleBytes);
+	U32 channels, frames, i1;
+
+	TEST_CHECKF(refPack && refUnpack, "%s", pKernel->pName);
+	if (!refPack || !refUnpack) {
+		return;
+	}
+
+	for (channels = 1; channels <= MAX_CHANNELS; channels++) {
+		for (frames = 1; frames <= MAX_FRAMES; frames++) {
+			U32 sampleCount = channels * frames;
+			if (pKernel->packFn) {
+				for (i1 = 0; i1 < sizeof(mapperLabels); i1++) {
+					TEST_CHECKF(x_checkPack(pKernel->packFn, refPack, pKernel->sampleBytes, sampleCount, mapperLabels[i1], pState),
+						"%s channels %u frames %u label 0x%02x", pKernel->pName, channels, frames, mapperLabels[i1]);
+				}
+			}
+			if (pKernel->unpackFn) {
+				TEST_CHECKF(x_checkUnpack(pKernel->unpackFn, refUnpack, sampleCount, pState),
+					"%s channels %u frames %u", pKernel->pName, channels, frames);
+			}
+		}
+
+		// Every label, at the 6 frames of a class A packet at 48 kHz
+		if (pKernel->packFn) {
+			for (i1 = 0; i1 < 256; i1++) {
+				TEST_CHECKF(x_checkPack(pKernel->packFn, refPack, pKernel->sampleBytes, channels * 6, i1, pState),
+					"%s channels %u label 0x%02x", pKernel->pName, channels, i1);
+			}
+		}
+	}
+}
+
+// The selected kernels give back the samples they packed
+static void x_checkRoundTrip(U32 sampleBytes, U32 *pState)
+{
+	static U8 src[MAX_SAMPLES * 3];
+	static U8 out[MAX_SAMPLES * 3];
+	openavb_am824_pack_fn_t packFn = openavbAm824PackSelect(sampleBytes);
+	openavb_am824_unpack_fn_t unpackFn = openavbAm824UnpackSelect(sampleBytes);
+	U32 channels;
+
+	if (!packFn) {
+		packFn = openavbAm824PackSelectScalar(sampleBytes);
+	}
+	if (!unpackFn) {
+		unpackFn = openavbAm824UnpackSelectScalar(sampleBytes);
+	}
+
+	for (channels = 1; channels <= MAX_CHANNELS; channels++) {
+		U32 sampleCount = channels * 6;
+		testRandFill(src, sampleCount * sampleBytes, pState);
+		packFn(refBuf, src, sampleCount, 0x40);
+		unpackFn(out, refBuf, sampleCount);
+		TEST_CHECKF(memcmp(src, out, sampleCount * sampleBytes) == 0, "%u bit channels %u", sampleBytes * 8, channels);
+		TEST_CHECKF(refBuf[0] == 0x40 && refBuf[(sampleCount - 1) * 4] == 0x40, "%u bit channels %u", sampleBytes * 8, channels);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	U32 randState = 0x61883;
+	U32 i1;
+
+	printf("Selected kernels: %s\n", openavbAm824IsaName());
+
+	for (i1 = 0; kernels[i1].pName; i1++) {
+		if (x_isaAvailable(kernels[i1].pIsa)) {
+			x_checkKernel(&kernels[i1], &randState);
+		}
+		else {
+			printf("%s skipped, no %s\n", kernels[i1].pName, kernels[i1].pIsa);
+		}
+	}
+
+	for (i1 = 2; i1 <= 3; i1++) {
+		am824_kernel_t selected = { "selected", NULL, openavbAm824PackSelect(i1), openavbAm824UnpackSelect(i1), i1 };
+		if (selected.packFn || selected.unpackFn) {
+			x_checkKernel(&selected, &randState);
+		}
+		x_checkRoundTrip(i1, &randState);
+	}
+
+	return TEST_RESULT();
+}
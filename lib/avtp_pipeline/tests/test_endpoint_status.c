@@ -0,0 +1,341 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Stress test of the endpoint stream status table.
+*
+* - Slots handed out and released, lookups by stream ID and by the endpoint interface MAC,
+*   and the header values readers see.
+* - The owner lock: a table whose creator exited without removing it is ignored, and a new
+*   one is picked up.
+* - Two writer threads, like the endpoint server and SRP threads, change every slot while
+*   reader threads copy them. Every copy must be consistent and no slot may go backwards.
+*
+* The table code is built into the test under its own shared memory name.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "openavb_test.h"
+
+#define OPENAVB_ENDPOINT_STATUS_NAME	"/avb_endpoint_status_test"
+#include "openavb_endpoint_status.c"
+#include "openavb_endpoint_status_osal.c"
+
+#define TEST_SLOTS			8
+#define TEST_WRITERS		2
+#define TEST_READERS		3
+#define TEST_WRITES			200000
+
+static const char testIfname[] = "eth7";
+static U8 testMac[ETH_ALEN] = { 0x00, 0x1b, 0xc5, 0x0a, 0xb0, 0x00 };
+
+static void x_streamId(U32 idx, AVBStreamID_t *pStreamID)
+{
+	memcpy(pStreamID->addr, testMac, ETH_ALEN);
+	pStreamID->addr[5] = idx;
+	pStreamID->uniqueID = idx;
+}
+
+static void x_testSlots(void)
+{
+	openavb_endpoint_status_t *pSlots[TEST_SLOTS];
+	openavb_endpoint_status_t status[TEST_SLOTS + 1];
+	AVBStreamID_t streamID;
+	char ifname[IFNAMSIZ + 10];
+	U32 version = 0;
+	U32 i1;
+
+	// Nothing to read before the endpoint creates the table
+	x_streamId(0, &streamID);
+	TEST_CHECK(!openavbEptStatusFind(&streamID, &status[0]));
+	TEST_CHECK(openavbEptStatusSlotCount() == 0);
+	TEST_CHECK(!openavbEptStatusEndpointVersion(&version));
+	TEST_CHECK(openavbEptStatusSlotOpen(&streamID) == NULL);
+
+	TEST_CHECK(openavbEptStatusCreate(TEST_SLOTS, testIfname, testMac));
+	TEST_CHECK(!openavbEptStatusCreate(TEST_SLOTS, testIfname, testMac));
+	TEST_CHECK(openavbEptStatusSlotCount() == TEST_SLOTS);
+	TEST_CHECK(openavbEptStatusEndpointVersion(&version) && version == AVB_CORE_VER_FULL);
+	TEST_CHECK(openavbEptStatusIfname(ifname, sizeof(ifname)) && strcmp(ifname, testIfname) == 0);
+
+	for (i1 = 0; i1 < TEST_SLOTS; i1++) {
+		x_streamId(i1, &streamID);
+		pSlots[i1] = openavbEptStatusSlotOpen(&streamID);
+		TEST_CHECKF(pSlots[i1] != NULL, "slot %u", i1);
+	}
+	x_streamId(TEST_SLOTS, &streamID);
+	TEST_CHECK(openavbEptStatusSlotOpen(&streamID) == NULL);
+	TEST_CHECK(openavbEptStatusGetAll(status, TEST_SLOTS + 1) == TEST_SLOTS);
+
+	// The first stream carries the interface MAC, so it is also found without one
+	openavbEptStatusBegin(pSlots[0]);
+	pSlots[0]->latency = 1234;
+	openavbEptStatusEnd(pSlots[0]);
+	memset(&streamID, 0, sizeof(streamID));
+	TEST_CHECK(openavbEptStatusFind(&streamID, &status[0]));
+	TEST_CHECK(status[0].latency == 1234 && status[0].updates == 2);
+
+	// A released slot is gone for readers and handed out again
+	x_streamId(3, &streamID);
+	openavbEptStatusSlotClose(pSlots[3]);
+	TEST_CHECK(!openavbEptStatusFind(&streamID, &status[0]));
+	TEST_CHECK(openavbEptStatusGetAll(status, TEST_SLOTS) == TEST_SLOTS - 1);
+	x_streamId(TEST_SLOTS, &streamID);
+	TEST_CHECK(openavbEptStatusSlotOpen(&streamID) == pSlots[3]);
+	TEST_CHECK(openavbEptStatusFind(&streamID, &status[0]) && status[0].latency == 0);
+
+	// Removing the table closes it for readers
+	openavbEptStatusDestroy();
+	TEST_CHECK(!openavbEptStatusFind(&streamID, &status[0]));
+	TEST_CHECK(openavbEptStatusSlotCount() == 0);
+	openavbEptStatusDetach();
+}
+
+static void x_testOwner(void)
+{
+	openavb_endpoint_status_t status;
+	AVBStreamID_t streamID;
+	int toChild[2], toParent[2];
+	char c = 0;
+
+	x_streamId(1, &streamID);
+	TEST_CHECK(pipe(toChild) == 0 && pipe(toParent) == 0);
+
+	pid_t pid = fork();
+	if (pid == 0) {
+		// An endpoint that dies without removing its table
+		bool bOk = openavbEptStatusCreate(TEST_SLOTS, testIfname, testMac)
+			&& openavbEptStatusSlotOpen(&streamID) != NULL;
+		c = bOk;
+		if (write(toParent[1], &c, 1) != 1 || read(toChild[0], &c, 1) != 1) {
+			_exit(1);
+		}
+		_exit(0);
+	}
+	TEST_CHECK(pid > 0);
+	if (pid <= 0)
+		return;
+
+	TEST_CHECK(read(toParent[0], &c, 1) == 1 && c);
+	TEST_CHECK(openavbEptStatusFind(&streamID, &status));
+
+	// Let it exit. The object is still there, marked open, but nobody owns it.
+	TEST_CHECK(write(toChild[1], &c, 1) == 1);
+	int wstatus = 0;
+	TEST_CHECK(waitpid(pid, &wstatus, 0) == pid && WIFEXITED(wstatus) && WEXITSTATUS(wstatus) == 0);
+	TEST_CHECK(!openavbEptStatusFind(&streamID, &status));
+	TEST_CHECK(openavbEptStatusSlotCount() == 0);
+
+	// A new endpoint replaces it
+	TEST_CHECK(openavbEptStatusCreate(TEST_SLOTS, testIfname, testMac));
+	TEST_CHECK(openavbEptStatusSlotOpen(&streamID) != NULL);
+	TEST_CHECK(openavbEptStatusFind(&streamID, &status));
+	openavbEptStatusDestroy();
+	openavbEptStatusDetach();
+
+	close(toChild[0]);
+	close(toChild[1]);
+	close(toParent[0]);
+	close(toParent[1]);
+}
+
+typedef struct {
+	openavb_endpoint_status_t *pSlots[TEST_SLOTS];
+	volatile bool bDone;
+	U32 seed;
+	// Reader results
+	U32 reads;
+	U32 torn;
+	U32 backwards;
+} stress_t;
+
+// Every field is set from the number of changes the slot has seen before
+static void x_fillSlot(openavb_endpoint_status_t *pSlot, U32 n)
+{
+	int i1;
+
+	pSlot->role = n;
+	for (i1 = 0; i1 < ETH_ALEN; i1++)
+		pSlot->destAddr[i1] = n + i1;
+	pSlot->bMaap = n & 1;
+	pSlot->srClass = n >> 8;
+	pSlot->srRank = n >> 16;
+	pSlot->priority = n >> 24;
+	pSlot->vlanID = n;
+	pSlot->classRate = n;
+	pSlot->tSpec.maxFrameSize = n;
+	pSlot->tSpec.maxIntervalFrames = ~n;
+	pSlot->latency = n;
+	pSlot->fwmark = ~n;
+	pSlot->lsnrDecl = n + 1;
+	pSlot->tlkrDecl = n + 2;
+	pSlot->failInfo.FailureCode = n + 3;
+}
+
+static bool x_slotConsistent(const openavb_endpoint_status_t *pStatus)
+{
+	openavb_endpoint_status_t expect;
+	U32 n = pStatus->updates - 1;
+
+	memcpy(&expect, pStatus, sizeof(expect));
+	x_fillSlot(&expect, n);
+	return pStatus->latency == n && memcmp(&expect, pStatus, sizeof(expect)) == 0;
+}
+
+static void *x_writerFn(void *pv)
+{
+	stress_t *pTest = pv;
+	U32 seed = __sync_fetch_and_add(&pTest->seed, 0x9e3779b9);
+	U32 i1;
+
+	for (i1 = 0; i1 < TEST_WRITES; i1++) {
+		openavb_endpoint_status_t *pSlot = pTest->pSlots[testRand(&seed) % TEST_SLOTS];
+		openavbEptStatusBegin(pSlot);
+		x_fillSlot(pSlot, pSlot->updates);
+		openavbEptStatusEnd(pSlot);
+	}
+	return NULL;
+}
+
+static void *x_readerFn(void *pv)
+{
+	stress_t *pTest = pv;
+	openavb_endpoint_status_t status[TEST_SLOTS];
+	U32 lastUpdates[TEST_SLOTS] = { 0 };
+	AVBStreamID_t streamID;
+	U32 reads = 0, torn = 0, backwards = 0;
+	U32 i1;
+
+	while (!pTest->bDone) {
+		// One stream at a time, and all of them at once
+		for (i1 = 0; i1 < TEST_SLOTS; i1++) {
+			x_streamId(i1, &streamID);
+			if (openavbEptStatusFind(&streamID, &status[0])) {
+				reads++;
+				if (!x_slotConsistent(&status[0]))
+					torn++;
+				if (status[0].updates < lastUpdates[i1])
+					backwards++;
+				lastUpdates[i1] = status[0].updates;
+			}
+		}
+
+		U32 count = openavbEptStatusGetAll(status, TEST_SLOTS);
+		for (i1 = 0; i1 < count; i1++) {
+			U32 idx = status[i1].streamID.uniqueID;
+			reads++;
+			if (!x_slotConsistent(&status[i1]))
+				torn++;
+			if (idx < TEST_SLOTS) {
+				if (status[i1].updates < lastUpdates[idx])
+					backwards++;
+				lastUpdates[idx] = status[i1].updates;
+			}
+		}
+	}
+
+	__sync_fetch_and_add(&pTest->reads, reads);
+	__sync_fetch_and_add(&pTest->torn, torn);
+	__sync_fetch_and_add(&pTest->backwards, backwards);
+	return NULL;
+}
+
+static void x_testStress(void)
+{
+	static stress_t test;
+	pthread_t writers[TEST_WRITERS];
+	pthread_t readers[TEST_READERS];
+	openavb_endpoint_status_t status;
+	AVBStreamID_t streamID;
+	U32 i1;
+
+	memset(&test, 0, sizeof(test));
+	test.seed = 0x2545f491;
+
+	TEST_CHECK(openavbEptStatusCreate(TEST_SLOTS, testIfname, testMac));
+	for (i1 = 0; i1 < TEST_SLOTS; i1++) {
+		x_streamId(i1, &streamID);
+		test.pSlots[i1] = openavbEptStatusSlotOpen(&streamID);
+		TEST_CHECKF(test.pSlots[i1] != NULL, "slot %u", i1);
+		if (!test.pSlots[i1])
+			return;
+		// Opening clears the slot, give it the first consistent state
+		openavbEptStatusBegin(test.pSlots[i1]);
+		x_fillSlot(test.pSlots[i1], test.pSlots[i1]->updates);
+		openavbEptStatusEnd(test.pSlots[i1]);
+	}
+
+	for (i1 = 0; i1 < TEST_READERS; i1++)
+		TEST_CHECK(pthread_create(&readers[i1], NULL, x_readerFn, &test) == 0);
+	for (i1 = 0; i1 < TEST_WRITERS; i1++)
+		TEST_CHECK(pthread_create(&writers[i1], NULL, x_writerFn, &test) == 0);
+
+	for (i1 = 0; i1 < TEST_WRITERS; i1++)
+		pthread_join(writers[i1], NULL);
+	test.bDone = TRUE;
+	for (i1 = 0; i1 < TEST_READERS; i1++)
+		pthread_join(readers[i1], NULL);
+
+	TEST_CHECK(test.reads > 0);
+	TEST_CHECKF(test.torn == 0, "%u of %u reads", test.torn, test.reads);
+	TEST_CHECKF(test.backwards == 0, "%u of %u reads", test.backwards, test.reads);
+
+	// Every write was counted exactly once, besides opening the slot and the first state
+	U32 total = 0;
+	for (i1 = 0; i1 < TEST_SLOTS; i1++) {
+		x_streamId(i1, &streamID);
+		TEST_CHECK(openavbEptStatusFind(&streamID, &status) && x_slotConsistent(&status));
+		total += status.updates - 2;
+	}
+	TEST_CHECKF(total == TEST_WRITERS * TEST_WRITES, "%u", total);
+
+	openavbEptStatusDestroy();
+	openavbEptStatusDetach();
+}
+
+int main(int argc, char *argv[])
+{
+	// The table logs an error when there's none to remove
+	FILE *pLogFile = fopen("/dev/null", "w");
+	avbLogInitEx(pLogFile);
+
+	x_testSlots();
+	x_testOwner();
+	x_testStress();
+
+	avbLogExit();
+	if (pLogFile)
+		fclose(pLogFile);
+	return TEST_RESULT();
+}
@@ -0,0 +1,334 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Stress test of the endpoint stream tables.
+*
+* - openavb_hash against a plain array, through growth, replacement and removal.
+* - addStream/delStream/findStream with max_streams = 1000, through the indexes by stream
+*   ID, client handle and MAAP handle, with the limit enforced.
+* - MAAP fallback allocation: every address distinct, the free stack reused after release.
+* - QMgr fwmarks: a class grows past 256 streams and reuses freed stream numbers.
+*
+* The endpoint module is built into the test for its static index functions. No daemon is
+* needed: MAAP runs without a port and QMgr with the shaper disabled.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "openavb_test.h"
+#include "openavb_hash.h"
+
+// Endpoint module built in, with the indexes and the MAAP restart callback
+#include "openavb_endpoint.c"
+
+#define TEST_HASH_KEYS		20000
+#define TEST_STREAMS		1000
+#define TEST_HANDLE_BASE	100
+
+static U8 testMac[ETH_ALEN] = { 0x00, 0x1b, 0xc5, 0x0a, 0xb0, 0x00 };
+
+static void x_streamId(U32 idx, AVBStreamID_t *pStreamID)
+{
+	memcpy(pStreamID->addr, testMac, ETH_ALEN);
+	pStreamID->addr[5] = idx >> 8;
+	pStreamID->uniqueID = idx & 0xFF;
+}
+
+static void x_testHash(void)
+{
+	static U8 keys[TEST_HASH_KEYS][8];
+	static U32 values[TEST_HASH_KEYS];
+	U32 seed = 0x2545f491;
+	U32 i1;
+
+	// Presized for 1 so the bucket table doubles many times
+	openavb_hash_t hash = openavbHashNew(8, 1);
+	TEST_CHECK(hash != NULL);
+	if (!hash)
+		return;
+
+	for (i1 = 0; i1 < TEST_HASH_KEYS; i1++) {
+		// Random keys with the index in front so they are unique
+		testRandFill(keys[i1], 8, &seed);
+		keys[i1][0] = i1 >> 8;
+		keys[i1][1] = i1 & 0xFF;
+		TEST_CHECK(openavbHashPut(hash, keys[i1], &values[i1]));
+	}
+	TEST_CHECK(openavbHashCount(hash) == TEST_HASH_KEYS);
+
+	U32 misses = 0;
+	for (i1 = 0; i1 < TEST_HASH_KEYS; i1++) {
+		if (openavbHashGet(hash, keys[i1]) != &values[i1])
+			misses++;
+	}
+	TEST_CHECKF(misses == 0, "%u", misses);
+
+	// Replacing keeps the count
+	TEST_CHECK(openavbHashPut(hash, keys[7], &values[8]));
+	TEST_CHECK(openavbHashGet(hash, keys[7]) == &values[8]);
+	TEST_CHECK(openavbHashCount(hash) == TEST_HASH_KEYS);
+	TEST_CHECK(openavbHashPut(hash, keys[7], &values[7]));
+
+	// Remove every other key
+	for (i1 = 0; i1 < TEST_HASH_KEYS; i1 += 2) {
+		TEST_CHECK(openavbHashRemove(hash, keys[i1]) == &values[i1]);
+	}
+	TEST_CHECK(openavbHashRemove(hash, keys[0]) == NULL);
+	TEST_CHECK(openavbHashCount(hash) == TEST_HASH_KEYS / 2);
+
+	misses = 0;
+	for (i1 = 0; i1 < TEST_HASH_KEYS; i1++) {
+		void *pExpected = (i1 & 1) ? &values[i1] : NULL;
+		if (openavbHashGet(hash, keys[i1]) != pExpected)
+			misses++;
+	}
+	TEST_CHECKF(misses == 0, "%u", misses);
+
+	for (i1 = 1; i1 < TEST_HASH_KEYS; i1 += 2) {
+		TEST_CHECK(openavbHashRemove(hash, keys[i1]) == &values[i1]);
+	}
+	TEST_CHECK(openavbHashCount(hash) == 0);
+
+	openavbHashDelete(hash);
+}
+
+// Number of streams in x_streamList, checking the back links on the way
+static U32 x_listCount(void)
+{
+	clientStream_t *ps;
+	clientStream_t *pPrev = NULL;
+	U32 count = 0;
+
+	for (ps = x_streamList; ps; ps = ps->next) {
+		TEST_CHECK(ps->prev == pPrev);
+		pPrev = ps;
+		count++;
+	}
+	TEST_CHECK(x_streamListTail == pPrev);
+	return count;
+}
+
+static clientStream_t *x_streamOpen(U32 idx)
+{
+	AVBStreamID_t streamID;
+	struct ether_addr addr;
+
+	x_streamId(idx, &streamID);
+	clientStream_t *ps = addStream(TEST_HANDLE_BASE + idx, &streamID);
+	if (!ps)
+		return NULL;
+
+	void *hndMaap = openavbMaapAllocate(1, &addr);
+	TEST_CHECKF(hndMaap != NULL, "stream %u", idx);
+	if (hndMaap) {
+		memcpy(ps->destAddr, addr.ether_addr_octet, ETH_ALEN);
+		setStreamMaap(ps, hndMaap);
+	}
+
+#ifdef AVB_FEATURE_FQTSS
+	// Odd streams in class A, even ones in class B
+	ps->srClass = (idx & 1) ? SR_CLASS_A : SR_CLASS_B;
+	ps->fwmark = openavbQmgrAddStream(ps->srClass, 8000, 1, 200);
+	TEST_CHECKF(ps->fwmark != INVALID_FWMARK, "stream %u", idx);
+#endif
+	return ps;
+}
+
+static void x_streamClose(clientStream_t *ps)
+{
+#ifdef AVB_FEATURE_FQTSS
+	if (ps->fwmark != INVALID_FWMARK)
+		openavbQmgrRemoveStream(ps->fwmark);
+#endif
+	if (ps->hndMaap)
+		openavbMaapRelease(ps->hndMaap);
+	delStream(ps);
+}
+
+static U64 x_macValue(const U8 *pAddr)
+{
+	U64 value = 0;
+	int i1;
+	for (i1 = 0; i1 < ETH_ALEN; i1++)
+		value = (value << 8) | pAddr[i1];
+	return value;
+}
+
+static int x_cmpU64(const void *pA, const void *pB)
+{
+	U64 a = *(const U64 *)pA, b = *(const U64 *)pB;
+	return a < b ? -1 : a > b;
+}
+
+// Checks the stream of each index, or its absence, through all three indexes
+static void x_checkStreams(clientStream_t **pStreams)
+{
+	AVBStreamID_t streamID;
+	U32 mismatches = 0;
+	U32 i1;
+
+	for (i1 = 0; i1 < TEST_STREAMS; i1++) {
+		clientStream_t *ps = pStreams[i1];
+		x_streamId(i1, &streamID);
+		if (findStream(&streamID) != ps || findStreamHandle(TEST_HANDLE_BASE + i1) != ps)
+			mismatches++;
+		else if (ps && findStreamMaap(ps->hndMaap) != ps)
+			mismatches++;
+	}
+	TEST_CHECKF(mismatches == 0, "%u", mismatches);
+}
+
+static void x_testStreams(void)
+{
+	static clientStream_t *pStreams[TEST_STREAMS];
+	static U64 addrs[TEST_STREAMS];
+	static U64 reusedAddrs[TEST_STREAMS / 2];
+	static U64 freedAddrs[TEST_STREAMS / 2];
+	AVBStreamID_t streamID;
+	struct ether_addr addr;
+	U32 i1;
+
+	x_cfg.maxStreams = TEST_STREAMS;
+	TEST_CHECK(x_streamIndexOpen());
+	TEST_CHECK(openavbMaapInitialize("lo", 0, NULL, x_cfg.maxStreams, maapRestartCallback));
+#ifdef AVB_FEATURE_FQTSS
+	TEST_CHECK(openavbQmgrInitialize(AVB_SHAPER_DISABLED, 0, "lo", 1500, 1000000, 250000));
+#endif
+
+	for (i1 = 0; i1 < TEST_STREAMS; i1++) {
+		pStreams[i1] = x_streamOpen(i1);
+		TEST_CHECKF(pStreams[i1] != NULL, "stream %u", i1);
+	}
+	TEST_CHECK(x_listCount() == TEST_STREAMS);
+	x_checkStreams(pStreams);
+
+	// Past max_streams both the stream table and MAAP refuse
+	x_streamId(TEST_STREAMS, &streamID);
+	TEST_CHECK(addStream(TEST_HANDLE_BASE + TEST_STREAMS, &streamID) == NULL);
+	TEST_CHECK(openavbMaapAllocate(1, &addr) == NULL);
+
+	// Every MAAP address is different
+	for (i1 = 0; i1 < TEST_STREAMS; i1++) {
+		addrs[i1] = x_macValue(pStreams[i1]->destAddr);
+	}
+	qsort(addrs, TEST_STREAMS, sizeof(U64), x_cmpU64);
+	U32 duplicates = 0;
+	for (i1 = 1; i1 < TEST_STREAMS; i1++) {
+		if (addrs[i1] == addrs[i1 - 1])
+			duplicates++;
+	}
+	TEST_CHECKF(duplicates == 0, "%u", duplicates);
+
+#ifdef AVB_FEATURE_FQTSS
+	// 500 streams per class, so the class tables grew past 256, with fwmarks unique in a class
+	U32 maxStream = 0;
+	for (i1 = 0; i1 < TEST_STREAMS; i1++) {
+		int fwmark = pStreams[i1]->fwmark;
+		TEST_CHECK(TC_AVB_MARK_CLASS(fwmark) == (int)pStreams[i1]->srClass);
+		if (TC_AVB_MARK_STREAM(fwmark) > maxStream)
+			maxStream = TC_AVB_MARK_STREAM(fwmark);
+	}
+	TEST_CHECKF(maxStream == TEST_STREAMS / 2 - 1, "%u", maxStream);
+	for (i1 = 0; i1 < TEST_STREAMS; i1++) {
+		addrs[i1] = pStreams[i1]->fwmark;
+	}
+	qsort(addrs, TEST_STREAMS, sizeof(U64), x_cmpU64);
+	duplicates = 0;
+	for (i1 = 1; i1 < TEST_STREAMS; i1++) {
+		if (addrs[i1] == addrs[i1 - 1])
+			duplicates++;
+	}
+	TEST_CHECKF(duplicates == 0, "%u", duplicates);
+#endif
+
+	// Close every other stream, from the middle of the list as well as its ends
+	for (i1 = 0; i1 < TEST_STREAMS; i1 += 2) {
+		freedAddrs[i1 / 2] = x_macValue(pStreams[i1]->destAddr);
+		x_streamClose(pStreams[i1]);
+		pStreams[i1] = NULL;
+	}
+	TEST_CHECK(x_listCount() == TEST_STREAMS / 2);
+	x_checkStreams(pStreams);
+
+	// Reopen them, the MAAP addresses released are exactly the ones handed out again
+	for (i1 = 0; i1 < TEST_STREAMS; i1 += 2) {
+		pStreams[i1] = x_streamOpen(i1);
+		TEST_CHECKF(pStreams[i1] != NULL, "stream %u", i1);
+		if (pStreams[i1])
+			reusedAddrs[i1 / 2] = x_macValue(pStreams[i1]->destAddr);
+	}
+	qsort(freedAddrs, TEST_STREAMS / 2, sizeof(U64), x_cmpU64);
+	qsort(reusedAddrs, TEST_STREAMS / 2, sizeof(U64), x_cmpU64);
+	TEST_CHECK(memcmp(freedAddrs, reusedAddrs, sizeof(freedAddrs)) == 0);
+	TEST_CHECK(openavbMaapAllocate(1, &addr) == NULL);
+	TEST_CHECK(x_listCount() == TEST_STREAMS);
+	x_checkStreams(pStreams);
+
+#ifdef AVB_FEATURE_FQTSS
+	// Class B (even streams) reused its freed stream numbers instead of growing
+	U32 maxStreamB = 0;
+	for (i1 = 0; i1 < TEST_STREAMS; i1 += 2) {
+		if (TC_AVB_MARK_STREAM(pStreams[i1]->fwmark) > maxStreamB)
+			maxStreamB = TC_AVB_MARK_STREAM(pStreams[i1]->fwmark);
+	}
+	TEST_CHECKF(maxStreamB == TEST_STREAMS / 2 - 1, "%u", maxStreamB);
+#endif
+
+	for (i1 = 0; i1 < TEST_STREAMS; i1++) {
+		if (pStreams[i1])
+			x_streamClose(pStreams[i1]);
+		pStreams[i1] = NULL;
+	}
+	TEST_CHECK(x_listCount() == 0);
+	x_checkStreams(pStreams);
+
+#ifdef AVB_FEATURE_FQTSS
+	openavbQmgrFinalize();
+#endif
+	openavbMaapFinalize();
+	x_streamIndexClose();
+}
+
+int main(int argc, char *argv[])
+{
+	// Each MAAP allocation is logged
+	FILE *pLogFile = fopen("/dev/null", "w");
+	avbLogInitEx(pLogFile);
+
+	x_testHash();
+	x_testStreams();
+
+	avbLogExit();
+	if (pLogFile)
+		fclose(pLogFile);
+	return TEST_RESULT();
+}
@@ -0,0 +1,297 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Checks the ALSA interface mmap capture and playback writes against alsa-lib.
+*
+* The PCMs are the alsa-lib file plugin on top of the null plugin, so no sound card is needed:
+* capture reads a known input file through the mapped ring, and playback leaves everything
+* written in an output file. Reads and writes come in sizes from one frame to more than the
+* ring holds. Playback is run with mmap access and with read/write access. Only built when
+* CMake finds alsa-lib.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "openavb_test.h"
+
+// The transfer functions and the private data are static, build the module into the test
+#include "openavb_intf_alsa.c"
+#include "openavb_intf_alsa_asrc.c"
+
+#define TEST_RATE			48000
+#define TEST_CHANNELS		2
+#define TEST_FRAME_BYTES	(TEST_CHANNELS * 2)		// S16_LE
+#define TEST_PERIOD			240
+#define TEST_BUFFER			960
+#define TEST_FRAMES			9600
+#define TEST_MAX_WAITS		1000
+
+// Transfer sizes in frames, cycled through: single frames, part periods, whole periods and
+// more than the ring
+static const U32 chunkFrames[] = { 1, 7, TEST_PERIOD, 500, TEST_BUFFER, 1200, 3 };
+
+static U8 pattern[TEST_FRAMES * TEST_FRAME_BYTES];
+static U8 result[TEST_FRAMES * TEST_FRAME_BYTES];
+
+// Open a file plugin PCM over the null plugin and set it up like the interface module does.
+// pInFile is read by capture, pOutFile gets what is played.
+static bool x_pcmOpen(pvt_data_t *pPvtData, snd_pcm_stream_t stream, const char *pOutFile, const char *pInFile)
+{
+	char conf[512];
+	snd_config_t *pConf = NULL;
+	snd_input_t *pInput = NULL;
+	snd_pcm_hw_params_t *hwParams = NULL;
+	snd_pcm_sw_params_t *swParams = NULL;
+	snd_pcm_uframes_t period = TEST_PERIOD, buffer = TEST_BUFFER;
+	unsigned int rate = TEST_RATE;
+	int rslt;
+
+	snprintf(conf, sizeof(conf),
+		"pcm.avbtest { type file slave.pcm { type null } file \"%s\" %s%s%s format raw }",
+		pOutFile, pInFile ? "infile \"" : "", pInFile ? pInFile : "", pInFile ? "\"" : "");
+
+	rslt = snd_config_top(&pConf);
+	if (rslt >= 0) {
+		rslt = snd_input_buffer_open(&pInput, conf, strlen(conf));
+	}
+	if (rslt >= 0) {
+		rslt = snd_config_load(pConf, pInput);
+		snd_input_close(pInput);
+	}
+	if (rslt >= 0) {
+		rslt = snd_pcm_open_lconf(&pPvtData->pcmHandle, "avbtest", stream, 0, pConf);
+	}
+	if (pConf) {
+		snd_config_delete(pConf);
+	}
+	if (rslt < 0) {
+		fprintf(stderr, "PCM open: %s\n", snd_strerror(rslt));
+		pPvtData->pcmHandle = NULL;
+		return FALSE;
+	}
+
+	rslt = snd_pcm_hw_params_malloc(&hwParams);
+	if (rslt >= 0)
+		rslt = snd_pcm_hw_params_any(pPvtData->pcmHandle, hwParams);
+	if (rslt >= 0)
+		rslt = x_setAccess(pPvtData, hwParams);
+	if (rslt >= 0)
+		rslt = snd_pcm_hw_params_set_format(pPvtData->pcmHandle, hwParams, SND_PCM_FORMAT_S16_LE);
+	if (rslt >= 0)
+		rslt = snd_pcm_hw_params_set_rate_near(pPvtData->pcmHandle, hwParams, &rate, 0);
+	if (rslt >= 0)
+		rslt = snd_pcm_hw_params_set_channels(pPvtData->pcmHandle, hwParams, TEST_CHANNELS);
+	if (rslt >= 0)
+		rslt = snd_pcm_hw_params_set_period_size_near(pPvtData->pcmHandle, hwParams, &period, 0);
+	if (rslt >= 0)
+		rslt = snd_pcm_hw_params_set_buffer_size_near(pPvtData->pcmHandle, hwParams, &buffer);
+	if (rslt >= 0)
+		rslt = snd_pcm_hw_params(pPvtData->pcmHandle, hwParams);
+	if (hwParams) {
+		snd_pcm_hw_params_free(hwParams);
+	}
+	if (rslt >= 0)
+		rslt = snd_pcm_get_params(pPvtData->pcmHandle, &pPvtData->bufferFrames, &pPvtData->periodFrames);
+
+	// Playback starts at two periods, as openavbIntfAlsaRxInitCB() sets it up by default
+	if (rslt >= 0 && stream == SND_PCM_STREAM_PLAYBACK) {
+		pPvtData->startThresholdFrames = pPvtData->periodFrames * 2;
+		rslt = snd_pcm_sw_params_malloc(&swParams);
+		if (rslt >= 0)
+			rslt = snd_pcm_sw_params_current(pPvtData->pcmHandle, swParams);
+		if (rslt >= 0)
+			rslt = snd_pcm_sw_params_set_start_threshold(pPvtData->pcmHandle, swParams, pPvtData->startThresholdFrames);
+		if (rslt >= 0)
+			rslt = snd_pcm_sw_params(pPvtData->pcmHandle, swParams);
+		if (swParams) {
+			snd_pcm_sw_params_free(swParams);
+		}
+	}
+	if (rslt >= 0)
+		rslt = snd_pcm_prepare(pPvtData->pcmHandle);
+
+	if (rslt < 0) {
+		fprintf(stderr, "PCM setup: %s\n", snd_strerror(rslt));
+		snd_pcm_close(pPvtData->pcmHandle);
+		pPvtData->pcmHandle = NULL;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+// Temporary file name, the file is created empty
+static bool x_tempFile(char *pName, size_t size)
+{
+	snprintf(pName, size, "/tmp/test_intf_alsa_XXXXXX");
+	int fd = mkstemp(pName);
+	if (fd < 0) {
+		return FALSE;
+	}
+	close(fd);
+	return TRUE;
+}
+
+// Read up to len bytes of a file, returns the number read
+static size_t x_readFile(const char *pName, U8 *pData, size_t len)
+{
+	FILE *pFile = fopen(pName, "rb");
+	if (!pFile) {
+		return 0;
+	}
+	size_t got = fread(pData, 1, len, pFile);
+	// One byte more means the file is longer than expected
+	U8 extra;
+	if (got == len && fread(&extra, 1, 1, pFile) == 1) {
+		got++;
+	}
+	fclose(pFile);
+	return got;
+}
+
+static void x_testCapture(void)
+{
+	char inFile[64];
+	pvt_data_t pvt;
+	U32 total = 0, chunk = 0, waits = 0;
+
+	TEST_CHECK(x_tempFile(inFile, sizeof(inFile)));
+	FILE *pFile = fopen(inFile, "wb");
+	TEST_CHECK(pFile && fwrite(pattern, 1, sizeof(pattern), pFile) == sizeof(pattern));
+	if (pFile) {
+		fclose(pFile);
+	}
+
+	memset(&pvt, 0, sizeof(pvt));
+	pvt.useMmap = TRUE;
+	bool bOpen = x_pcmOpen(&pvt, SND_PCM_STREAM_CAPTURE, "/dev/null", inFile);
+	TEST_CHECK(bOpen);
+	if (bOpen) {
+		TEST_CHECK(pvt.useMmap);
+		TEST_CHECK(snd_pcm_start(pvt.pcmHandle) >= 0);
+
+		memset(result, 0, sizeof(result));
+		while (total < TEST_FRAMES && waits < TEST_MAX_WAITS) {
+			U32 want = chunkFrames[chunk % (sizeof(chunkFrames) / sizeof(chunkFrames[0]))];
+			if (want > TEST_FRAMES - total) {
+				want = TEST_FRAMES - total;
+			}
+
+			snd_pcm_sframes_t got = x_mmapCapture(&pvt, result + total * TEST_FRAME_BYTES, want, TEST_FRAME_BYTES);
+			if (got == -EAGAIN) {
+				snd_pcm_wait(pvt.pcmHandle, PCM_MMAP_WAIT_MSEC);
+				waits++;
+				continue;
+			}
+			// A whole item, or at least a period toward it
+			TEST_CHECKF(got > 0 && (U32)got <= want && ((U32)got == want || (U32)got >= pvt.periodFrames),
+				"capture %u of %u frames at %u", (unsigned)got, want, total);
+			if (got <= 0) {
+				break;
+			}
+			total += got;
+			chunk++;
+		}
+		TEST_CHECKF(total == TEST_FRAMES, "captured %u frames", total);
+		TEST_CHECK(memcmp(result, pattern, sizeof(pattern)) == 0);
+		snd_pcm_close(pvt.pcmHandle);
+	}
+	unlink(inFile);
+}
+
+static void x_testPlayback(bool bMmap)
+{
+	char outFile[64];
+	pvt_data_t pvt;
+	U32 total = 0, chunk = 0;
+
+	TEST_CHECK(x_tempFile(outFile, sizeof(outFile)));
+	memset(&pvt, 0, sizeof(pvt));
+	pvt.useMmap = bMmap;
+	bool bOpen = x_pcmOpen(&pvt, SND_PCM_STREAM_PLAYBACK, outFile, NULL);
+	TEST_CHECKF(bOpen, "mmap %d", bMmap);
+	if (bOpen) {
+		TEST_CHECKF(pvt.useMmap == bMmap, "mmap %d", bMmap);
+
+		while (total < TEST_FRAMES) {
+			U32 want = chunkFrames[chunk % (sizeof(chunkFrames) / sizeof(chunkFrames[0]))];
+			if (want > TEST_FRAMES - total) {
+				want = TEST_FRAMES - total;
+			}
+
+			// Blocks until everything is in the ring
+			snd_pcm_sframes_t written = x_playbackWrite(&pvt, pattern + total * TEST_FRAME_BYTES, want, TEST_FRAME_BYTES);
+			TEST_CHECKF(written == (snd_pcm_sframes_t)want, "mmap %d wrote %d of %u frames at %u", bMmap, (int)written, want, total);
+			if (written <= 0) {
+				break;
+			}
+			total += written;
+			chunk++;
+
+			// Started once the start threshold is queued
+			if (total >= pvt.startThresholdFrames) {
+				TEST_CHECKF(snd_pcm_state(pvt.pcmHandle) == SND_PCM_STATE_RUNNING, "mmap %d at %u", bMmap, total);
+			}
+		}
+
+		snd_pcm_drain(pvt.pcmHandle);
+		snd_pcm_close(pvt.pcmHandle);
+
+		memset(result, 0, sizeof(result));
+		size_t got = x_readFile(outFile, result, sizeof(result));
+		TEST_CHECKF(got == sizeof(pattern), "mmap %d played %u bytes", bMmap, (unsigned)got);
+		TEST_CHECKF(memcmp(result, pattern, sizeof(pattern)) == 0, "mmap %d", bMmap);
+	}
+	unlink(outFile);
+}
+
+int main(int argc, char *argv[])
+{
+	U32 seed = 0x1234567;
+
+	// The module logs when mmap access falls back, keep that out of the output
+	FILE *pLogFile = fopen("/dev/null", "w");
+	avbLogInitEx(pLogFile);
+
+	testRandFill(pattern, sizeof(pattern), &seed);
+	x_testCapture();
+	x_testPlayback(TRUE);
+	x_testPlayback(FALSE);
+
+	snd_config_update_free_global();
+	avbLogExit();
+	if (pLogFile) {
+		fclose(pLogFile);
+	}
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,382 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Checks the shared memory ring interface module with its client API.
+*
+* The interface module runs on a media queue in the main thread while a client thread
+* attaches with openavbShmClientOpen(), as an external application would. Items are sent
+* both ways with sequence numbers, varying lengths and timestamps. The test fails on a lost,
+* reordered or corrupted item, on a listener overrun and on a ring left behind after the
+* stream stops.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "openavb_test.h"
+#include "openavb_platform_pub.h"
+#include "openavb_mediaq_pub.h"
+#include "openavb_intf_pub.h"
+#include "openavb_avtp_time_pub.h"
+#include "openavb_intf_shm_pub.h"
+
+#define	AVB_LOG_COMPONENT	"Shm Test"
+#include "openavb_log_pub.h"
+
+#define TEST_ITEMS			100000
+#define TEST_MQ_ITEMS		16
+#define TEST_ITEM_SIZE		300
+#define TEST_SLOTS			"8"
+#define TEST_WAIT_MSEC		5000
+#define TEST_TIMEOUT_SEC	60
+
+extern bool openavbIntfShmInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+
+typedef struct {
+	char name[OPENAVB_SHM_NAME_MAX];
+	openavb_shm_client_t client;
+	volatile bool bOpen;
+	U32 items;
+	U32 errors;
+} shm_test_client_t;
+
+// Item seq carries 1 to TEST_ITEM_SIZE bytes of a pattern that depends on seq
+static U32 x_itemLen(U32 seq)
+{
+	return 1 + (seq * 7) % TEST_ITEM_SIZE;
+}
+
+static void x_itemFill(U8 *pData, U32 seq)
+{
+	U32 i1, len = x_itemLen(seq);
+	memcpy(pData, &seq, len < sizeof(seq) ? len : sizeof(seq));
+	for (i1 = sizeof(seq); i1 < len; i1++) {
+		pData[i1] = (U8)(seq + i1);
+	}
+}
+
+static bool x_itemCheck(const U8 *pData, U32 len, U32 seq)
+{
+	U8 expected[TEST_ITEM_SIZE];
+	if (len != x_itemLen(seq)) {
+		return FALSE;
+	}
+	x_itemFill(expected, seq);
+	return memcmp(pData, expected, len) == 0;
+}
+
+// Listener items with an odd seq have no timestamp. Talker items always carry one, without
+// it the talker reads the gPTP time, which is not available to the test.
+static U64 x_itemTime(U32 seq)
+{
+	return 1000000000ULL + seq * 125000ULL;
+}
+
+static double x_now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static media_q_t *x_open(openavb_intf_cb_t *pIntfCB, const char *pName, bool bTalker)
+{
+	media_q_t *pMediaQ = openavbMediaQCreate();
+	if (!pMediaQ) {
+		return NULL;
+	}
+	openavbMediaQSetSize(pMediaQ, TEST_MQ_ITEMS, TEST_ITEM_SIZE);
+
+	memset(pIntfCB, 0, sizeof(*pIntfCB));
+	if (!openavbIntfShmInitialize(pMediaQ, pIntfCB)) {
+		openavbMediaQDelete(pMediaQ);
+		return NULL;
+	}
+	pIntfCB->intf_cfg_cb(pMediaQ, "intf_nv_shm_name", pName);
+	pIntfCB->intf_cfg_cb(pMediaQ, "intf_nv_shm_slots", TEST_SLOTS);
+	pIntfCB->intf_cfg_cb(pMediaQ, "intf_nv_ignore_timestamp", "1");
+	pIntfCB->intf_gen_init_cb(pMediaQ);
+	if (bTalker) {
+		pIntfCB->intf_tx_init_cb(pMediaQ);
+	}
+	else {
+		pIntfCB->intf_rx_init_cb(pMediaQ);
+	}
+	return pMediaQ;
+}
+
+static void x_close(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB)
+{
+	pIntfCB->intf_end_cb(pMediaQ);
+	pIntfCB->intf_gen_end_cb(pMediaQ);
+	openavbMediaQDelete(pMediaQ);
+}
+
+// The application side of a talker: writes every item, sleeping while the ring is full
+static void *x_producerFn(void *pv)
+{
+	shm_test_client_t *pTest = pv;
+	U32 seq;
+
+	if (!openavbShmClientOpen(&pTest->client, pTest->name)) {
+		pTest->errors++;
+		return NULL;
+	}
+	pTest->bOpen = TRUE;
+
+	for (seq = 0; seq < TEST_ITEMS; seq++) {
+		openavb_shm_slot_t *pSlot;
+		while ((pSlot = openavbShmClientReserve(&pTest->client)) == NULL) {
+			if (!openavbShmClientWait(&pTest->client, TEST_WAIT_MSEC)) {
+				pTest->errors++;
+				openavbShmClientClose(&pTest->client);
+				return NULL;
+			}
+		}
+		x_itemFill(OPENAVB_SHM_SLOT_DATA(pSlot), seq);
+		pSlot->dataLen = x_itemLen(seq);
+		pSlot->flags = OPENAVB_SHM_SLOT_TIMESTAMP_VALID;
+		pSlot->timestampNS = x_itemTime(seq);
+		openavbShmClientPublish(&pTest->client);
+		pTest->items++;
+	}
+
+	openavbShmClientClose(&pTest->client);
+	return NULL;
+}
+
+// The application side of a listener: reads until the stream stops and the ring is empty
+static void *x_consumerFn(void *pv)
+{
+	shm_test_client_t *pTest = pv;
+
+	if (!openavbShmClientOpen(&pTest->client, pTest->name)) {
+		pTest->errors++;
+		return NULL;
+	}
+	pTest->bOpen = TRUE;
+
+	while (1) {
+		openavb_shm_slot_t *pSlot = openavbShmClientPeek(&pTest->client);
+		if (!pSlot) {
+			if (!openavbShmClientWait(&pTest->client, TEST_WAIT_MSEC)) {
+				break;
+			}
+			continue;
+		}
+
+		U32 seq = pTest->items;
+		bool bTimestamp = !(seq & 1);
+		if (!x_itemCheck(OPENAVB_SHM_SLOT_DATA(pSlot), pSlot->dataLen, seq)
+			|| ((pSlot->flags & OPENAVB_SHM_SLOT_TIMESTAMP_VALID) != 0) != bTimestamp
+			|| (bTimestamp && pSlot->timestampNS != x_itemTime(seq))) {
+			if (pTest->errors++ < 10) {
+				fprintf(stderr, "listener item %u: %u bytes, flags %x\n", seq, pSlot->dataLen, pSlot->flags);
+			}
+		}
+		openavbShmClientRelease(&pTest->client);
+		pTest->items++;
+	}
+
+	openavbShmClientClose(&pTest->client);
+	return NULL;
+}
+
+// The stream removes the ring when it stops
+static void x_checkRemoved(const char *pName)
+{
+	char shmName[OPENAVB_SHM_NAME_MAX + 16];
+	openavb_shm_client_t client;
+
+	snprintf(shmName, sizeof(shmName), "/" OPENAVB_SHM_NAME_PREFIX "%s", pName);
+	int fd = shm_open(shmName, O_RDONLY, 0);
+	TEST_CHECKF(fd < 0 && errno == ENOENT, "%s still exists", shmName);
+	if (fd >= 0) {
+		close(fd);
+	}
+	TEST_CHECKF(!openavbShmClientOpen(&client, pName), "%s", pName);
+}
+
+static void x_checkTalker(void)
+{
+	static shm_test_client_t test;
+	openavb_intf_cb_t intfCB;
+	pthread_t thread;
+	U32 seq = 0;
+
+	snprintf(test.name, sizeof(test.name), "test_tx_%d", (int)getpid());
+	media_q_t *pMediaQ = x_open(&intfCB, test.name, TRUE);
+	TEST_CHECK(pMediaQ != NULL);
+	if (!pMediaQ) {
+		return;
+	}
+	TEST_CHECK(pthread_create(&thread, NULL, x_producerFn, &test) == 0);
+
+	// The talker thread: one item per transmit interval, read by the mapping module
+	double deadline = x_now() + TEST_TIMEOUT_SEC;
+	while (seq < TEST_ITEMS && x_now() < deadline) {
+		if (!intfCB.intf_tx_cb(pMediaQ)) {
+			sched_yield();
+		}
+		media_q_item_t *pItem = openavbMediaQTailLock(pMediaQ, TRUE);
+		if (!pItem) {
+			continue;
+		}
+		if (!x_itemCheck(pItem->pPubData, pItem->dataLen, seq)
+			|| !openavbAvtpTimeTimestampIsValid(pItem->pAvtpTime)
+			|| openavbAvtpTimeGetAvtpTimeNS(pItem->pAvtpTime) != x_itemTime(seq)) {
+			TEST_CHECKF(FALSE, "talker item %u: %u bytes", seq, pItem->dataLen);
+			break;
+		}
+		openavbMediaQTailPull(pMediaQ);
+		seq++;
+	}
+
+	pthread_join(thread, NULL);
+	TEST_CHECKF(seq == TEST_ITEMS, "talker received %u items", seq);
+	TEST_CHECKF(test.items == TEST_ITEMS && test.errors == 0, "talker client wrote %u items, %u errors", test.items, test.errors);
+	printf("talker: %u items\n", seq);
+
+	x_close(pMediaQ, &intfCB);
+	x_checkRemoved(test.name);
+}
+
+static void x_checkListener(void)
+{
+	static shm_test_client_t test;
+	openavb_intf_cb_t intfCB;
+	pthread_t thread;
+	U32 seq = 0;
+
+	snprintf(test.name, sizeof(test.name), "test_rx_%d", (int)getpid());
+	media_q_t *pMediaQ = x_open(&intfCB, test.name, FALSE);
+	TEST_CHECK(pMediaQ != NULL);
+	if (!pMediaQ) {
+		return;
+	}
+	TEST_CHECK(pthread_create(&thread, NULL, x_consumerFn, &test) == 0);
+
+	// The listener thread: items from the mapping module, moved to the ring on each Rx callback
+	double deadline = x_now() + TEST_TIMEOUT_SEC;
+	while (!test.bOpen && !test.errors && x_now() < deadline) {
+		sched_yield();
+	}
+	openavb_shm_hdr_t *pHdr = test.client.pHdr;
+	while (test.bOpen && seq < TEST_ITEMS && x_now() < deadline) {
+		// Do not run ahead of the application, that would count as an overrun
+		if (pHdr->head - pHdr->tail >= pHdr->slotCount) {
+			sched_yield();
+			continue;
+		}
+		media_q_item_t *pItem = openavbMediaQHeadLock(pMediaQ);
+		TEST_CHECK(pItem != NULL);
+		if (!pItem) {
+			break;
+		}
+		x_itemFill(pItem->pPubData, seq);
+		pItem->dataLen = x_itemLen(seq);
+		if (seq & 1) {
+			openavbAvtpTimeSetTimestampValid(pItem->pAvtpTime, FALSE);
+		}
+		else {
+			openavbAvtpTimeSetToTimestampNS(pItem->pAvtpTime, x_itemTime(seq));
+		}
+		openavbMediaQHeadPush(pMediaQ);
+		TEST_CHECK(intfCB.intf_rx_cb(pMediaQ));
+		seq++;
+	}
+
+	// Stopping the stream wakes the application, which drains the ring and returns
+	x_close(pMediaQ, &intfCB);
+	pthread_join(thread, NULL);
+	TEST_CHECKF(seq == TEST_ITEMS, "listener sent %u items", seq);
+	TEST_CHECKF(test.items == TEST_ITEMS && test.errors == 0, "listener client read %u items, %u errors", test.items, test.errors);
+	printf("listener: %u items\n", test.items);
+
+	x_checkRemoved(test.name);
+}
+
+// Every item the application does not take in time is dropped and counted
+static void x_checkOverrun(void)
+{
+	openavb_intf_cb_t intfCB;
+	openavb_shm_client_t client;
+	char name[OPENAVB_SHM_NAME_MAX];
+	U32 seq, slots = atoi(TEST_SLOTS);
+
+	snprintf(name, sizeof(name), "test_overrun_%d", (int)getpid());
+	media_q_t *pMediaQ = x_open(&intfCB, name, FALSE);
+	TEST_CHECK(pMediaQ != NULL);
+	if (!pMediaQ) {
+		return;
+	}
+	TEST_CHECK(openavbShmClientOpen(&client, name));
+
+	for (seq = 0; seq < slots + 5; seq++) {
+		media_q_item_t *pItem = openavbMediaQHeadLock(pMediaQ);
+		x_itemFill(pItem->pPubData, seq);
+		pItem->dataLen = x_itemLen(seq);
+		openavbMediaQHeadPush(pMediaQ);
+		intfCB.intf_rx_cb(pMediaQ);
+	}
+	TEST_CHECK(intfCB.intf_get_xruns_cb(pMediaQ) == 5);
+	TEST_CHECK(client.pHdr->overruns == 5);
+
+	// The oldest items are kept
+	for (seq = 0; seq < slots; seq++) {
+		openavb_shm_slot_t *pSlot = openavbShmClientPeek(&client);
+		TEST_CHECKF(pSlot && x_itemCheck(OPENAVB_SHM_SLOT_DATA(pSlot), pSlot->dataLen, seq), "item %u", seq);
+		openavbShmClientRelease(&client);
+	}
+	TEST_CHECK(openavbShmClientPeek(&client) == NULL);
+	TEST_CHECK(!openavbShmClientWait(&client, 10));
+
+	openavbShmClientClose(&client);
+	x_close(pMediaQ, &intfCB);
+}
+
+int main(int argc, char *argv[])
+{
+	avbLogInit();
+
+	x_checkTalker();
+	x_checkListener();
+	x_checkOverrun();
+
+	avbLogExit();
+	return TEST_RESULT();
+}
@@ -0,0 +1,250 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Checks the frames the tone generator interface module writes.
+*
+* Runs the tone generator as a talker into an AAF media queue, the same way a talker
+* stream does, and compares every sample of the items with a tone computed here. The
+* cases cover the frame tables and the per sample fallback for long periods, fixed value
+* channels, both byte orders, tone on / off switching and item frames with padding.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "openavb_test.h"
+#include "openavb_platform_pub.h"
+#include "openavb_mediaq_pub.h"
+#include "openavb_map_pub.h"
+#include "openavb_intf_pub.h"
+#include "openavb_map_uncmp_audio_pub.h"
+
+#define	AVB_LOG_COMPONENT	"Tone Gen Test"
+#include "openavb_log_pub.h"
+
+#define TEST_ITEM_COUNT		20
+#define TEST_TRANSIT_USEC	2000
+#define TEST_MAX_CFG		8
+
+extern bool openavbMapAVTPAudioInitialize(media_q_t *pMediaQ, openavb_map_cb_t *pMapCB, U32 inMaxTransitUsec);
+extern bool openavbIntfToneGenInitialize(media_q_t *pMediaQ, openavb_intf_cb_t *pIntfCB);
+
+typedef struct {
+	const char *pName;
+	const char *pCfg[TEST_MAX_CFG];	// name=value pairs, map_ and intf_ names
+	U32 rate;
+	U32 bitDepth;
+	bool bFloat;
+	bool bBigEndian;
+	U32 channels;
+	U32 toneHz;
+	U32 onOffMSec;
+	U32 fvChannels;
+	U32 fv[2];
+	U32 itemSampleBytes;			// Bytes per sample in the media queue item
+	double seconds;					// Audio checked
+} tonegen_case_t;
+
+static const tonegen_case_t tonegenCases[] = {
+	{ "2ch_s16_be", { "intf_nv_audio_rate=48000", "intf_nv_audio_bit_depth=16", "intf_nv_audio_channels=2",
+		"intf_nv_audio_endian=big", "intf_nv_tone_hz=1000" },
+		48000, 16, FALSE, TRUE, 2, 1000, 0, 0, { 0, 0 }, 2, 1.2 },
+	{ "2ch_s16_le", { "intf_nv_audio_rate=48000", "intf_nv_audio_bit_depth=16", "intf_nv_audio_channels=2",
+		"intf_nv_audio_endian=little", "intf_nv_tone_hz=997" },
+		48000, 16, FALSE, FALSE, 2, 997, 0, 0, { 0, 0 }, 2, 1.2 },
+	{ "8ch_s24_on_off", { "intf_nv_audio_rate=48000", "intf_nv_audio_bit_depth=24", "intf_nv_audio_channels=8",
+		"intf_nv_audio_endian=big", "intf_nv_tone_hz=480", "intf_nv_on_off_interval_msec=30" },
+		48000, 24, FALSE, TRUE, 8, 480, 30, 0, { 0, 0 }, 3, 0.5 },
+	{ "8ch_s32_fv", { "intf_nv_audio_rate=48000", "intf_nv_audio_bit_depth=32", "intf_nv_audio_channels=8",
+		"intf_nv_audio_endian=little", "intf_nv_tone_hz=997", "intf_nv_fv1=287454020", "intf_nv_fv2=-5" },
+		48000, 32, FALSE, FALSE, 8, 997, 0, 2, { 287454020, (U32)-5 }, 4, 1.2 },
+	{ "2ch_float", { "intf_nv_audio_rate=48000", "intf_nv_audio_bit_depth=32", "intf_nv_audio_type=float",
+		"intf_nv_audio_channels=2", "intf_nv_audio_endian=big", "intf_nv_tone_hz=1000" },
+		48000, 32, TRUE, TRUE, 2, 1000, 0, 0, { 0, 0 }, 4, 0.2 },
+	// 24 bit samples in 32 bit items leave 10 bytes of padding per frame
+	{ "10ch_s24_int32_items", { "map_nv_item_format=int32", "intf_nv_audio_rate=48000", "intf_nv_audio_bit_depth=24",
+		"intf_nv_audio_channels=10", "intf_nv_audio_endian=little", "intf_nv_tone_hz=1000" },
+		48000, 24, FALSE, FALSE, 10, 1000, 0, 0, { 0, 0 }, 4, 0.2 },
+	// A 64000 frame period is too large for a frame table
+	{ "64ch_s32_192k_441hz", { "intf_nv_audio_rate=192000", "intf_nv_audio_bit_depth=32", "intf_nv_audio_channels=64",
+		"intf_nv_audio_endian=big", "intf_nv_tone_hz=441" },
+		192000, 32, FALSE, TRUE, 64, 441, 0, 0, { 0, 0 }, 4, 0.4 },
+};
+
+#define TONEGEN_CASE_COUNT	(sizeof(tonegenCases) / sizeof(tonegenCases[0]))
+
+// Encode the tone sample of frame n the way the module defines it
+static void x_expectedSample(const tonegen_case_t *pCase, U64 n, U8 *pOut)
+{
+	U32 freq = pCase->toneHz;
+	S32 v32;
+	U32 i1;
+
+	// Tone on / off starts with the tone off
+	if (pCase->onOffMSec && ((n / (pCase->rate / 1000 * pCase->onOffMSec)) & 1) == 0) {
+		freq = 0;
+	}
+	float value = sin(2.0 * M_PI * (n * freq % pCase->rate) / pCase->rate) * 1.0f;
+
+	if (pCase->bFloat) {
+		memcpy(&v32, &value, 4);
+	}
+	else if (pCase->bitDepth == 16) {
+		v32 = (S16)(S32)(value * 32000);
+	}
+	else {
+		v32 = (S32)(value * (32000 << 16));
+	}
+
+	// The upper bytes of the 32 bit value, most significant first in big endian
+	U32 bytes = pCase->bitDepth / 8;
+	U32 w = bytes == 2 ? (U32)v32 << 16 : (U32)v32;
+	for (i1 = 0; i1 < bytes; i1++) {
+		U8 b = w >> (24 - 8 * i1);
+		pOut[pCase->bBigEndian ? i1 : bytes - 1 - i1] = b;
+	}
+}
+
+static void x_runCase(const tonegen_case_t *pCase)
+{
+	openavb_map_cb_t mapCB;
+	openavb_intf_cb_t intfCB;
+	U32 i1, ch, frame, items = 0;
+	U64 n = 0;
+	bool bMismatch = FALSE;
+
+	media_q_t *pMediaQ = openavbMediaQCreate();
+	TEST_CHECKF(pMediaQ != NULL, "%s", pCase->pName);
+	if (!pMediaQ) {
+		return;
+	}
+
+	memset(&mapCB, 0, sizeof(mapCB));
+	memset(&intfCB, 0, sizeof(intfCB));
+	TEST_CHECKF(openavbMapAVTPAudioInitialize(pMediaQ, &mapCB, TEST_TRANSIT_USEC), "%s", pCase->pName);
+	TEST_CHECKF(openavbIntfToneGenInitialize(pMediaQ, &intfCB), "%s", pCase->pName);
+
+	// Configure as openavbTLConfigure() does
+	char value[16];
+	snprintf(value, sizeof(value), "%u", TEST_ITEM_COUNT);
+	mapCB.map_cfg_cb(pMediaQ, "map_nv_item_count", value);
+	mapCB.map_cfg_cb(pMediaQ, "map_nv_tx_rate", "8000");
+	for (i1 = 0; i1 < TEST_MAX_CFG && pCase->pCfg[i1]; i1++) {
+		char cfg[64];
+		snprintf(cfg, sizeof(cfg), "%s", pCase->pCfg[i1]);
+		char *pValue = strchr(cfg, '=');
+		*pValue++ = '\0';
+		if (strncmp(cfg, "map_", 4) == 0) {
+			mapCB.map_cfg_cb(pMediaQ, cfg, pValue);
+		}
+		else {
+			intfCB.intf_cfg_cb(pMediaQ, cfg, pValue);
+		}
+	}
+	mapCB.map_gen_init_cb(pMediaQ);
+	intfCB.intf_gen_init_cb(pMediaQ);
+	mapCB.map_tx_init_cb(pMediaQ);
+	intfCB.intf_tx_init_cb(pMediaQ);
+
+	media_q_pub_map_uncmp_audio_info_t *pPubMapInfo = pMediaQ->pPubMapInfo;
+	U32 frameBytes = pPubMapInfo->itemFrameSizeBytes;
+	U32 sampleBytes = pCase->bitDepth / 8;
+	U32 toneChannels = pCase->channels - pCase->fvChannels;
+	TEST_CHECKF(frameBytes == pCase->channels * pCase->itemSampleBytes, "%s frame %u bytes", pCase->pName, frameBytes);
+
+	while (n < pCase->seconds * pCase->rate && !bMismatch) {
+		media_q_item_t *pItem;
+		for (i1 = 0; i1 < pPubMapInfo->packingFactor; i1++) {
+			TEST_CHECK(intfCB.intf_tx_cb(pMediaQ));
+		}
+		pItem = openavbMediaQTailLock(pMediaQ, TRUE);
+		TEST_CHECKF(pItem != NULL, "%s item %u", pCase->pName, items);
+		if (!pItem) {
+			break;
+		}
+		TEST_CHECKF(pItem->dataLen == pPubMapInfo->framesPerItem * frameBytes, "%s item %u length %u", pCase->pName, items, pItem->dataLen);
+
+		for (frame = 0; frame < pPubMapInfo->framesPerItem && !bMismatch; frame++, n++) {
+			const U8 *pFrame = (const U8 *)pItem->pPubData + frame * frameBytes;
+			U8 expected[4];
+
+			x_expectedSample(pCase, n, expected);
+			for (ch = 0; ch < toneChannels; ch++) {
+				if (memcmp(pFrame + ch * sampleBytes, expected, sampleBytes) != 0) {
+					TEST_CHECKF(FALSE, "%s frame %llu channel %u", pCase->pName, (unsigned long long)n, ch);
+					bMismatch = TRUE;
+				}
+			}
+			for (ch = 0; ch < pCase->fvChannels; ch++) {
+				U32 fv = pCase->fv[ch];
+				U8 fvBytes[4] = { fv, fv >> 8, fv >> 16, fv >> 24 };
+				if (memcmp(pFrame + (toneChannels + ch) * sampleBytes, fvBytes, 4) != 0) {
+					TEST_CHECKF(FALSE, "%s frame %llu fixed value %u", pCase->pName, (unsigned long long)n, ch);
+					bMismatch = TRUE;
+				}
+			}
+			for (i1 = pCase->channels * sampleBytes; i1 < frameBytes; i1++) {
+				if (pFrame[i1] != 0) {
+					TEST_CHECKF(FALSE, "%s frame %llu padding byte %u", pCase->pName, (unsigned long long)n, i1);
+					bMismatch = TRUE;
+				}
+			}
+		}
+		openavbMediaQTailPull(pMediaQ);
+		items++;
+	}
+	printf("%s: %u items\n", pCase->pName, items);
+
+	intfCB.intf_end_cb(pMediaQ);
+	mapCB.map_end_cb(pMediaQ);
+	intfCB.intf_gen_end_cb(pMediaQ);
+	mapCB.map_gen_end_cb(pMediaQ);
+	openavbMediaQDelete(pMediaQ);
+}
+
+int main(int argc, char *argv[])
+{
+	U32 i1;
+
+	// Without gPTP every item logs that the wall time is not available, keep that out of the output
+	FILE *pLogFile = fopen("/dev/null", "w");
+	avbLogInitEx(pLogFile);
+	for (i1 = 0; i1 < TONEGEN_CASE_COUNT; i1++) {
+		x_runCase(&tonegenCases[i1]);
+	}
+	avbLogExit();
+	if (pLogFile) {
+		fclose(pLogFile);
+	}
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,109 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Checks the order and content of the messages of the logging thread.
+*
+* Messages captured as binary records and messages that fall back to the msg queue
+* ('*' width) are logged interleaved, with a sequence number, into a temporary file. The
+* test fails when a message is missing, out of order or when a %s argument that fits in a
+* message is cut short.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "openavb_test.h"
+#include "openavb_platform_pub.h"
+
+#define	AVB_LOG_COMPONENT	"Log Test"
+#include "openavb_log_pub.h"
+
+// Fewer fallback messages than LOG_QUEUE_MSG_CNT per LOG_QUEUE_SLEEP_MSEC so none is dropped
+#define TEST_MSGS			64
+#define TEST_LONG_LEN		(LOG_MSG_LEN / 2)
+#define TEST_LINE_LEN		(LOG_FULL_MSG_LEN + 64)
+
+int main(int argc, char *argv[])
+{
+	static char longStr[TEST_LONG_LEN + 1];
+	static char line[TEST_LINE_LEN];
+	FILE *pFile = tmpfile();
+	U32 i1;
+
+	if (!pFile) {
+		fprintf(stderr, "Failed to create the log file\n");
+		return 1;
+	}
+
+	for (i1 = 0; i1 < TEST_LONG_LEN; i1++) {
+		longStr[i1] = 'a' + i1 % 26;
+	}
+	longStr[TEST_LONG_LEN] = 0x00;
+
+	avbLogInitEx(pFile);
+
+	for (i1 = 0; i1 < TEST_MSGS; i1++) {
+		if (i1 % 3 == 1) {
+			AVB_LOGF_INFO("seq %*u fallback", 4, i1);
+		}
+		else {
+			AVB_LOGF_INFO("seq %4u binary", i1);
+		}
+	}
+	AVB_LOGF_INFO("long %s end", longStr);
+
+	avbLogExit();
+
+	U32 nextSeq = 0;
+	bool bLong = FALSE;
+	rewind(pFile);
+	while (fgets(line, sizeof(line), pFile)) {
+		char *pSeq = strstr(line, "seq ");
+		char *pLong = strstr(line, "long ");
+		if (pSeq) {
+			U32 seq = strtoul(pSeq + 4, NULL, 10);
+			TEST_CHECKF(seq == nextSeq, "seq %u, expected %u", seq, nextSeq);
+			TEST_CHECKF(strstr(pSeq, seq % 3 == 1 ? "fallback" : "binary") != NULL, "seq %u", seq);
+			nextSeq = seq + 1;
+		}
+		else if (pLong) {
+			TEST_CHECK(nextSeq == TEST_MSGS);
+			TEST_CHECK(strncmp(pLong + 5, longStr, TEST_LONG_LEN) == 0);
+			TEST_CHECK(strncmp(pLong + 5 + TEST_LONG_LEN, " end", 4) == 0);
+			bLong = TRUE;
+		}
+	}
+	TEST_CHECKF(nextSeq == TEST_MSGS, "%u messages", nextSeq);
+	TEST_CHECK(bLong);
+
+	fclose(pFile);
+	return TEST_RESULT();
+}
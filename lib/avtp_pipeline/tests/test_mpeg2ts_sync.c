@@ -0,0 +1,589 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Checks the MPEG2 TS sync scanners and PCR timestamps.
+*
+* Every vector scanner compiled for this CPU is run against the scalar scanner and an
+* independent reference, from every start offset, on buffers dense in sync bytes and on
+* 188 and 192 byte streams that lose sync through dropped or inserted bytes. Buffers are
+* allocated to the exact size so reads past the end show up under AddressSanitizer.
+* The talker callback is then run on such streams twice, with the selected scanner and with
+* the scalar one; the frames must match and every packet away from the damage must come out.
+* Last, PCR extraction and the PCR timeline (interpolation, PID lock, re-anchoring and the
+* drift clamp) are checked against values worked out by hand.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "openavb_test.h"
+
+// The scanners, the callbacks and the private data are static, build the module into the test
+#include "openavb_map_mpeg2ts_sync.c"
+#include "openavb_map_mpeg2ts.c"
+
+#define SCAN_MAX_LEN		(4 * 192 + 80)
+#define STREAM_PKTS			2000
+#define STREAM_DAMAGE_GAP	8			// Packets between damaged packets, at least
+#define STREAM_MAX_LEN		(STREAM_PKTS * (192 + 24) + 256)
+#define TEST_TRANSIT_USEC	2000
+#define TEST_ITEM_SIZE		2048
+#define TEST_FRAME_LEN		(TOTAL_HEADER_SIZE + AVTP_DFLT_SRC_PKTS * MPEGTS_SRC_PKT_SIZE)
+#define TEST_ITEM_NS		1000000000ULL
+
+typedef struct {
+	const char *pName;
+	const char *pIsa;		// Needed CPU feature, NULL when always present
+	openavb_mpeg2ts_sync_scan_fn_t scanFn;
+} sync_kernel_t;
+
+static const sync_kernel_t kernels[] = {
+#if MPEG2TS_SYNC_X86
+	{ "sse2SyncScan", "sse2", x_sse2SyncScan },
+	{ "avx2SyncScan", "avx2", x_avx2SyncScan },
+#elif MPEG2TS_SYNC_NEON
+	{ "neonSyncScan", NULL, x_neonSyncScan },
+#endif
+	{ NULL, NULL, NULL }
+};
+
+static const U32 strides[] = { MPEG2_TS_PKT_SIZE, MPEGTS_SRC_PKT_SIZE };
+
+static bool x_isaAvailable(const char *pIsa)
+{
+#if MPEG2TS_SYNC_X86
+	return !pIsa || x_cpuHas(pIsa);
+#else
+	return TRUE;
+#endif
+}
+
+// First offset from startIdx with a sync byte repeated at the stride for the packets that fit
+static int x_refSyncScan(const U8 *pData, U32 len, U32 startIdx, U32 stride)
+{
+	U32 offset, pkt;
+	for (offset = startIdx; offset < len; offset++) {
+		bool bMatch = TRUE;
+		for (pkt = 0; pkt < MPEG2TS_SYNC_CHECK_PKTS && offset + pkt * stride < len; pkt++) {
+			if (pData[offset + pkt * stride] != MPEG2_TS_SYNC_BYTE) {
+				bMatch = FALSE;
+				break;
+			}
+		}
+		if (bMatch) {
+			return offset;
+		}
+	}
+	return -1;
+}
+
+// Scan pData from every start offset with the kernel, the scalar scanner and the reference.
+static void x_checkScan(const sync_kernel_t *pKernel, const char *pWhat, const U8 *pData, U32 len, U32 stride)
+{
+	U8 *pBuf = malloc(len + 1);
+	U32 startIdx;
+	if (!pBuf) {
+		TEST_CHECK(pBuf != NULL);
+		return;
+	}
+	memcpy(pBuf, pData, len);
+
+	for (startIdx = 0; startIdx <= len; startIdx++) {
+		int ref = x_refSyncScan(pBuf, len, startIdx, stride);
+		int scalar = x_scalarSyncScan(pBuf, len, startIdx, stride);
+		int vector = pKernel->scanFn(pBuf, len, startIdx, stride);
+		TEST_CHECKF(scalar == ref, "scalar %s len %u stride %u start %u: %d != %d", pWhat, len, stride, startIdx, scalar, ref);
+		if (vector != ref) {
+			TEST_CHECKF(vector == ref, "%s %s len %u stride %u start %u: %d != %d", pKernel->pName, pWhat, len, stride, startIdx, vector, ref);
+			break;
+		}
+	}
+	free(pBuf);
+}
+
+// Any byte but the sync byte
+static U8 x_noSync(U32 *pState)
+{
+	return testRand(pState) & 0x3F;
+}
+
+// Transport stream packet number num: everything but the sync byte follows from the number
+static void x_fillPacket(U8 *pTsPkt, U32 num, bool bPayloadSync)
+{
+	U32 i1;
+
+	pTsPkt[0] = MPEG2_TS_SYNC_BYTE;
+	for (i1 = 1; i1 < MPEG2_TS_PKT_SIZE; i1++) {
+		pTsPkt[i1] = (num * 37 + i1 * 11) & 0x3F;
+	}
+	pTsPkt[4] = num & 0x3F;
+	pTsPkt[5] = (num >> 6) & 0x3F;
+	// Sync bytes in the payload make false candidates for the scanners
+	if (bPayloadSync) {
+		for (i1 = 0; i1 < num % 4; i1++) {
+			pTsPkt[8 + (num * 53 + i1 * 97) % (MPEG2_TS_PKT_SIZE - 8)] = MPEG2_TS_SYNC_BYTE;
+		}
+	}
+}
+
+// Build a stream of stride byte packets (sync byte after the source packet header for 192)
+// after a garbage prefix. Every gap packets or so one packet loses or gains up to 24 bytes
+// after its number; the last packets are left whole. Fills pDamaged[pkt] and returns the
+// stream length.
+static U32 x_buildStream(U8 *pStream, U32 stride, U32 pkts, U32 gap, bool bPayloadSync, bool *pDamaged, U32 *pState)
+{
+	const U32 syncIdx = stride - MPEG2_TS_PKT_SIZE;
+	U32 len = 0, pkt, i1;
+
+	U32 prefix = testRand(pState) % 300;
+	for (i1 = 0; i1 < prefix; i1++) {
+		pStream[len++] = x_noSync(pState);
+	}
+
+	U32 nextDamage = gap + testRand(pState) % gap;
+	for (pkt = 0; pkt < pkts; pkt++) {
+		U8 *pPkt = pStream + len;
+		for (i1 = 0; i1 < syncIdx; i1++) {
+			pPkt[i1] = x_noSync(pState);
+		}
+		x_fillPacket(pPkt + syncIdx, pkt, bPayloadSync);
+		len += stride;
+
+		pDamaged[pkt] = (pkt == nextDamage && pkt + MPEG2TS_SYNC_CHECK_PKTS < pkts);
+		if (pDamaged[pkt]) {
+			U32 at = syncIdx + 8 + testRand(pState) % (MPEG2_TS_PKT_SIZE - 8);
+			U32 count = 1 + testRand(pState) % 24;
+			if (testRand(pState) & 1) {
+				// Drop bytes
+				if (at + count > stride) {
+					count = stride - at;
+				}
+				memmove(pPkt + at, pPkt + at + count, stride - at - count);
+				len -= count;
+			}
+			else {
+				// Insert bytes
+				memmove(pPkt + at + count, pPkt + at, stride - at);
+				for (i1 = 0; i1 < count; i1++) {
+					pPkt[at + i1] = x_noSync(pState);
+				}
+				len += count;
+			}
+			nextDamage = pkt + gap + testRand(pState) % gap;
+		}
+	}
+	return len;
+}
+
+static void x_checkKernel(const sync_kernel_t *pKernel, U32 *pState)
+{
+	static U8 buf[SCAN_MAX_LEN];
+	static U8 stream[STREAM_MAX_LEN];
+	static bool damaged[STREAM_PKTS];
+	U32 len, i1, i2, run;
+
+	for (i1 = 0; i1 < sizeof(strides) / sizeof(strides[0]); i1++) {
+		U32 stride = strides[i1];
+
+		// Random bytes, one in two a sync byte so that most offsets are candidates
+		for (len = 0; len <= SCAN_MAX_LEN; len += 1 + len / 64) {
+			for (i2 = 0; i2 < len; i2++) {
+				buf[i2] = (testRand(pState) & 1) ? MPEG2_TS_SYNC_BYTE : testRand(pState);
+			}
+			x_checkScan(pKernel, "random", buf, len, stride);
+		}
+
+		// Streams that lose sync, cut into pieces the size of interface reads
+		for (run = 0; run < 4; run++) {
+			U32 streamLen = x_buildStream(stream, stride, 40, 3, run & 1, damaged, pState);
+			U32 offset = 0;
+			while (offset < streamLen) {
+				len = 1 + testRand(pState) % (3 * stride + 64);
+				if (len > streamLen - offset) {
+					len = streamLen - offset;
+				}
+				x_checkScan(pKernel, "stream", stream + offset, len, stride);
+				offset += len;
+			}
+		}
+	}
+}
+
+// The selected scanner finds each packet start after a damaged packet
+static void x_checkResync(U32 *pState)
+{
+	static U8 stream[STREAM_MAX_LEN];
+	static bool damaged[STREAM_PKTS];
+	openavb_mpeg2ts_sync_scan_fn_t scanFn = openavbMpeg2tsSyncScanSelect();
+	U32 i1;
+
+	for (i1 = 0; i1 < sizeof(strides) / sizeof(strides[0]); i1++) {
+		U32 stride = strides[i1];
+		U32 streamLen = x_buildStream(stream, stride, STREAM_PKTS, STREAM_DAMAGE_GAP, FALSE, damaged, pState);
+
+		// Walk the sync bytes as the talker does: step a packet, rescan after a damaged one
+		int syncPos = scanFn(stream, streamLen, 0, stride);
+		U32 pkt = 0;
+		while (syncPos >= 0 && syncPos + MPEG2_TS_PKT_SIZE <= streamLen && pkt < STREAM_PKTS) {
+			U32 got = stream[syncPos + 4] | (stream[syncPos + 5] << 6);
+			TEST_CHECKF(got == pkt, "stride %u offset %d packet %u != %u", stride, syncPos, got, pkt);
+			if (got != pkt) {
+				break;
+			}
+			syncPos = damaged[pkt] ? scanFn(stream, streamLen, syncPos + 1, stride) : (int)(syncPos + stride);
+			pkt++;
+		}
+		TEST_CHECKF(pkt == STREAM_PKTS, "stride %u found %u", stride, pkt);
+	}
+}
+
+typedef struct {
+	media_q_t *pMediaQ;
+	openavb_map_cb_t mapCB;
+} test_map_t;
+
+// Configure a talker mapping as openavbTLConfigure() does
+static bool x_mapOpen(test_map_t *pMap, U32 stride, bool bScalar)
+{
+	char value[16];
+
+	memset(pMap, 0, sizeof(*pMap));
+	pMap->pMediaQ = openavbMediaQCreate();
+	if (!pMap->pMediaQ || !openavbMapMpeg2tsInitialize(pMap->pMediaQ, &pMap->mapCB, TEST_TRANSIT_USEC)) {
+		return FALSE;
+	}
+
+	snprintf(value, sizeof(value), "%u", stride);
+	pMap->mapCB.map_cfg_cb(pMap->pMediaQ, "map_nv_ts_packet_size", value);
+	snprintf(value, sizeof(value), "%u", TEST_ITEM_SIZE);
+	pMap->mapCB.map_cfg_cb(pMap->pMediaQ, "map_nv_item_size", value);
+
+	pMap->mapCB.map_gen_init_cb(pMap->pMediaQ);
+	pMap->mapCB.map_tx_init_cb(pMap->pMediaQ);
+	if (bScalar) {
+		pvt_data_t *pPvtData = pMap->pMediaQ->pPvtMapInfo;
+		pPvtData->syncScanFn = openavbMpeg2tsSyncScanSelectScalar();
+	}
+	return TRUE;
+}
+
+static void x_mapClose(test_map_t *pMap)
+{
+	if (pMap->pMediaQ) {
+		pMap->mapCB.map_end_cb(pMap->pMediaQ);
+		pMap->mapCB.map_gen_end_cb(pMap->pMediaQ);
+		openavbMediaQDelete(pMap->pMediaQ);
+	}
+}
+
+// Put the same pieces of the stream in both talker queues until they are full
+static void x_fillItems(media_q_t *pQ, media_q_t *pScalarQ, const U8 *pStream, U32 streamLen, U32 stride,
+	U32 *pOffset, U32 *pState)
+{
+	media_q_item_t *pItem;
+
+	while (*pOffset < streamLen && (pItem = openavbMediaQHeadLock(pQ)) != NULL) {
+		media_q_item_t *pScalarItem = openavbMediaQHeadLock(pScalarQ);
+		TEST_CHECK(pScalarItem != NULL);
+		if (!pScalarItem) {
+			openavbMediaQHeadUnlock(pQ);
+			return;
+		}
+
+		// Reads of at least a packet, so that a split packet has its end in the next item
+		U32 len = stride + testRand(pState) % (TEST_ITEM_SIZE - stride + 1);
+		if (len > streamLen - *pOffset) {
+			len = streamLen - *pOffset;
+		}
+		memcpy(pItem->pPubData, pStream + *pOffset, len);
+		memcpy(pScalarItem->pPubData, pStream + *pOffset, len);
+		pItem->dataLen = pScalarItem->dataLen = len;
+		pItem->readIdx = pScalarItem->readIdx = 0;
+		openavbAvtpTimeSetToTimestampNS(pItem->pAvtpTime, TEST_ITEM_NS + *pOffset);
+		openavbAvtpTimeSetToTimestampNS(pScalarItem->pAvtpTime, TEST_ITEM_NS + *pOffset);
+		openavbMediaQHeadPush(pQ);
+		openavbMediaQHeadPush(pScalarQ);
+		*pOffset += len;
+	}
+}
+
+// Number of the packet in a source packet of a frame, or -1 when it is not intact
+static int x_packetNumber(const U8 *pSrcPkt, bool bPayloadSync)
+{
+	const U8 *pTsPkt = pSrcPkt + MPEGTS_SRC_PKT_HDR_SIZE;
+	U8 want[MPEG2_TS_PKT_SIZE];
+	U32 num = pTsPkt[4] | (pTsPkt[5] << 6);
+
+	if (num >= STREAM_PKTS) {
+		return -1;
+	}
+	x_fillPacket(want, num, bPayloadSync);
+	return (memcmp(pTsPkt, want, sizeof(want)) == 0) ? (int)num : -1;
+}
+
+// The talker callback with the selected and the scalar scanner on a stream that loses sync
+static void x_runTalker(U32 stride, bool bPayloadSync, U32 *pState)
+{
+	static U8 stream[STREAM_MAX_LEN];
+	static bool damaged[STREAM_PKTS];
+	static bool seen[STREAM_PKTS];
+	test_map_t map, scalar;
+	U8 frame[TEST_FRAME_LEN], scalarFrame[TEST_FRAME_LEN];
+	U32 offset = 0, frames = 0, pkt, i1;
+	int lastPkt = -1;
+
+	U32 streamLen = x_buildStream(stream, stride, STREAM_PKTS, STREAM_DAMAGE_GAP, bPayloadSync, damaged, pState);
+	memset(seen, 0, sizeof(seen));
+
+	bool bOpen = x_mapOpen(&map, stride, FALSE) && x_mapOpen(&scalar, stride, TRUE);
+	TEST_CHECKF(bOpen, "stride %u", stride);
+	while (bOpen) {
+		x_fillItems(map.pMediaQ, scalar.pMediaQ, stream, streamLen, stride, &offset, pState);
+
+		memset(frame, 0, sizeof(frame));
+		memset(scalarFrame, 0, sizeof(scalarFrame));
+		U32 len = sizeof(frame), scalarLen = sizeof(scalarFrame);
+		tx_cb_ret_t ret = map.mapCB.map_tx_cb(map.pMediaQ, frame, &len);
+		tx_cb_ret_t scalarRet = scalar.mapCB.map_tx_cb(scalar.pMediaQ, scalarFrame, &scalarLen);
+
+		if (ret != scalarRet || (ret == TX_CB_RET_PACKET_READY && (len != scalarLen || memcmp(frame, scalarFrame, len) != 0))) {
+			TEST_CHECKF(FALSE, "stride %u frame %u differs", stride, frames);
+			break;
+		}
+		if (ret != TX_CB_RET_PACKET_READY) {
+			break;
+		}
+		frames++;
+
+		// Intact packets come out in order, each source packet starts with a sync byte
+		for (i1 = TOTAL_HEADER_SIZE; i1 < len; i1 += MPEGTS_SRC_PKT_SIZE) {
+			TEST_CHECKF(frame[i1 + MPEGTS_SRC_PKT_HDR_SIZE] == MPEG2_TS_SYNC_BYTE, "stride %u frame %u", stride, frames);
+			int num = x_packetNumber(frame + i1, bPayloadSync);
+			if (num >= 0) {
+				TEST_CHECKF(num > lastPkt, "stride %u packet %d after %d", stride, num, lastPkt);
+				lastPkt = num;
+				seen[num] = TRUE;
+			}
+		}
+	}
+	TEST_CHECKF(offset == streamLen, "stride %u offset %u of %u", stride, offset, streamLen);
+
+	// A damaged packet, like the garbage before the first one, takes at most the two after it
+	// along when it lands across items. A sync byte in the payload within a stride of the end
+	// of an item passes for a packet start, so with those only the frames are compared.
+	for (pkt = 0; pkt < STREAM_PKTS && !bPayloadSync; pkt++) {
+		bool bNearDamage = pkt < 2 || damaged[pkt] || damaged[pkt - 1] || damaged[pkt - 2];
+		TEST_CHECKF(seen[pkt] || bNearDamage, "stride %u packet %u missing", stride, pkt);
+	}
+
+	x_mapClose(&map);
+	x_mapClose(&scalar);
+}
+
+// Write a transport stream packet header with a PCR in the adaptation field
+static void x_buildPcrPacket(U8 *pTsPkt, U16 pid, U64 pcr, bool bDiscontinuity)
+{
+	U64 base = pcr / 300;
+	U32 ext = pcr % 300;
+
+	memset(pTsPkt, 0xFF, MPEG2_TS_PKT_SIZE);
+	pTsPkt[0] = MPEG2_TS_SYNC_BYTE;
+	pTsPkt[1] = 0x40 | ((pid >> 8) & 0x1F);
+	pTsPkt[2] = pid & 0xFF;
+	pTsPkt[3] = 0x30;
+	pTsPkt[4] = 7;
+	pTsPkt[5] = 0x10 | (bDiscontinuity ? 0x80 : 0x00);
+	pTsPkt[6] = base >> 25;
+	pTsPkt[7] = base >> 17;
+	pTsPkt[8] = base >> 9;
+	pTsPkt[9] = base >> 1;
+	pTsPkt[10] = ((base & 1) << 7) | 0x7E | (ext >> 8);
+	pTsPkt[11] = ext & 0xFF;
+}
+
+// A payload only packet
+static void x_buildPlainPacket(U8 *pTsPkt, U16 pid)
+{
+	memset(pTsPkt, 0xFF, MPEG2_TS_PKT_SIZE);
+	pTsPkt[0] = MPEG2_TS_SYNC_BYTE;
+	pTsPkt[1] = (pid >> 8) & 0x1F;
+	pTsPkt[2] = pid & 0xFF;
+	pTsPkt[3] = 0x10;
+}
+
+static void x_checkGetPcr(U32 *pState)
+{
+	U8 pkt[MPEG2_TS_PKT_SIZE];
+	U16 pid;
+	U64 pcr;
+	bool bDiscontinuity;
+	U32 i1;
+
+	for (i1 = 0; i1 < 10000; i1++) {
+		U16 wantPid = testRand(pState) & 0x1FFF;
+		U64 wantPcr = (((U64)testRand(pState) << 32) | testRand(pState)) % (((U64)1 << 33) * 300);
+		bool bWantDisc = testRand(pState) & 1;
+		x_buildPcrPacket(pkt, wantPid, wantPcr, bWantDisc);
+		TEST_CHECK(x_getPcr(pkt, &pid, &pcr, &bDiscontinuity));
+		TEST_CHECKF(pid == wantPid && pcr == wantPcr && bDiscontinuity == bWantDisc,
+			"pid 0x%x pcr %llu disc %d", wantPid, (unsigned long long)wantPcr, bWantDisc);
+	}
+
+	x_buildPlainPacket(pkt, 0x100);
+	TEST_CHECK(!x_getPcr(pkt, &pid, &pcr, &bDiscontinuity));
+	x_buildPcrPacket(pkt, 0x100, 1000, FALSE);
+	pkt[5] &= ~0x10;
+	TEST_CHECK(!x_getPcr(pkt, &pid, &pcr, &bDiscontinuity));
+	x_buildPcrPacket(pkt, 0x100, 1000, FALSE);
+	pkt[4] = 1;
+	TEST_CHECK(!x_getPcr(pkt, &pid, &pcr, &bDiscontinuity));
+	x_buildPcrPacket(pkt, 0x100, 1000, FALSE);
+	pkt[3] = 0x10;
+	TEST_CHECK(!x_getPcr(pkt, &pid, &pcr, &bDiscontinuity));
+}
+
+#define PCR_TICKS_PER_PKT	2700		// 100 us
+#define PCR_NS_PER_PKT		100000ULL
+
+static void x_checkPcrTime(void)
+{
+	U8 pkt[MPEG2_TS_PKT_SIZE];
+	pvt_data_t pvt;
+	U64 pcr0 = 27000000ULL * 3600;
+	U64 itemNs = TEST_ITEM_NS;
+	U32 i1;
+
+	memset(&pvt, 0, sizeof(pvt));
+	pvt.pcrPid = PCR_PID_ANY;
+
+	// Walltime until the first PCR, which anchors the timeline
+	x_buildPlainPacket(pkt, 0x100);
+	TEST_CHECK(x_pcrTimeNs(&pvt, itemNs, pkt) == itemNs);
+	x_buildPcrPacket(pkt, 0x100, pcr0, FALSE);
+	TEST_CHECK(x_pcrTimeNs(&pvt, itemNs + 7, pkt) == itemNs + 7);
+	TEST_CHECK(pvt.pcrValid && pvt.pcrLockedPid == 0x100);
+	itemNs += 7;
+
+	// No rate yet: the packets after the first PCR hold its time
+	x_buildPlainPacket(pkt, 0x100);
+	for (i1 = 1; i1 < 10; i1++) {
+		TEST_CHECKF(x_pcrTimeNs(&pvt, itemNs + i1, pkt) == itemNs, "packet %u", i1);
+	}
+
+	// The second PCR sets the rate the packets after it are interpolated at
+	x_buildPcrPacket(pkt, 0x100, pcr0 + 10 * PCR_TICKS_PER_PKT, FALSE);
+	TEST_CHECK(x_pcrTimeNs(&pvt, itemNs, pkt) == itemNs + 10 * PCR_NS_PER_PKT);
+	TEST_CHECK(pvt.pcrTicksPerPkt == PCR_TICKS_PER_PKT);
+	for (i1 = 1; i1 < 10; i1++) {
+		// A PCR on another PID does not move the timeline locked to the first one
+		if (i1 == 5) {
+			x_buildPcrPacket(pkt, 0x200, pcr0 / 2, TRUE);
+		}
+		else {
+			x_buildPlainPacket(pkt, 0x100);
+		}
+		TEST_CHECKF(x_pcrTimeNs(&pvt, itemNs, pkt) == itemNs + (10 + i1) * PCR_NS_PER_PKT, "packet %u", i1);
+	}
+	x_buildPcrPacket(pkt, 0x100, pcr0 + 20 * PCR_TICKS_PER_PKT, FALSE);
+	TEST_CHECK(x_pcrTimeNs(&pvt, itemNs, pkt) == itemNs + 20 * PCR_NS_PER_PKT);
+
+	// Discontinuity flag, PCR going back and a PCR gap over a second re-anchor on the walltime
+	U64 pcr = pcr0 + 20 * PCR_TICKS_PER_PKT;
+	for (i1 = 0; i1 < 3; i1++) {
+		itemNs += 50000000;
+		if (i1 == 0) {
+			pcr += 5 * PCR_TICKS_PER_PKT;
+		}
+		else if (i1 == 1) {
+			pcr -= 100 * PCR_TICKS_PER_PKT;
+		}
+		else {
+			pcr += PCR_MAX_GAP + 1;
+		}
+		x_buildPcrPacket(pkt, 0x100, pcr, i1 == 0);
+		TEST_CHECKF(x_pcrTimeNs(&pvt, itemNs, pkt) == itemNs, "re-anchor %u", i1);
+		TEST_CHECKF(pvt.pcrAnchor == pcr && pvt.pcrTicksPerPkt == 0, "re-anchor %u", i1);
+	}
+
+	// PCRs every 100 ms against a walltime that stands still: re-anchored past 500 ms
+	for (i1 = 1; i1 <= 7; i1++) {
+		x_buildPcrPacket(pkt, 0x100, pcr + i1 * 2700000ULL, FALSE);
+		U64 want = (i1 == 6) ? itemNs : (i1 == 7) ? itemNs + 100000000ULL : itemNs + i1 * 100000000ULL;
+		TEST_CHECKF(x_pcrTimeNs(&pvt, itemNs, pkt) == want, "drift %u", i1);
+	}
+
+	// A configured PID ignores PCRs on others
+	memset(&pvt, 0, sizeof(pvt));
+	pvt.pcrPid = 0x200;
+	x_buildPcrPacket(pkt, 0x100, pcr0, FALSE);
+	TEST_CHECK(x_pcrTimeNs(&pvt, itemNs, pkt) == itemNs && !pvt.pcrValid);
+	x_buildPcrPacket(pkt, 0x200, pcr0, FALSE);
+	TEST_CHECK(x_pcrTimeNs(&pvt, itemNs + 3, pkt) == itemNs + 3 && pvt.pcrValid && pvt.pcrLockedPid == 0x200);
+	x_buildPcrPacket(pkt, 0x100, pcr0 + 100 * PCR_TICKS_PER_PKT, FALSE);
+	TEST_CHECK(x_pcrTimeNs(&pvt, itemNs, pkt) == itemNs + 3 && pvt.pcrAnchor == pcr0);
+}
+
+int main(int argc, char *argv[])
+{
+	U32 seed = 0x1234567;
+	U32 i1;
+
+	// Lost sync and PCR discontinuities are logged, keep that out of the output
+	FILE *pLogFile = fopen("/dev/null", "w");
+	avbLogInitEx(pLogFile);
+
+	for (i1 = 0; kernels[i1].pName; i1++) {
+		if (x_isaAvailable(kernels[i1].pIsa)) {
+			x_checkKernel(&kernels[i1], &seed);
+		}
+		else {
+			printf("%s skipped, no %s\n", kernels[i1].pName, kernels[i1].pIsa);
+		}
+	}
+	const sync_kernel_t selected = { "selected", NULL, openavbMpeg2tsSyncScanSelect() };
+	x_checkKernel(&selected, &seed);
+	x_checkResync(&seed);
+
+	for (i1 = 0; i1 < sizeof(strides) / sizeof(strides[0]); i1++) {
+		x_runTalker(strides[i1], FALSE, &seed);
+		x_runTalker(strides[i1], TRUE, &seed);
+	}
+
+	x_checkGetPcr(&seed);
+	x_checkPcrTime();
+
+	avbLogExit();
+	if (pLogFile) {
+		fclose(pLogFile);
+	}
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,227 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Checks the talker / listener worker pool.
+*
+* Streams are run on a pool with a stub openavbTLStep() that records when each stream is
+* stepped and asks to be stepped again after its interval. The test fails when a stream is
+* starved or stepped much more often than due, when a role is spread unevenly over the
+* workers, when thread_affinity is not honoured, or when a stopped stream is stepped again
+* or not released exactly once.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include "openavb_test.h"
+#include "openavb_platform.h"
+#include "openavb_tl.h"
+
+#define	AVB_LOG_COMPONENT	"TL Pool Test"
+#include "openavb_log.h"
+
+#define TEST_WORKERS		4
+#define TEST_STREAMS		300
+#define TEST_INTERVAL_NS	(2 * NANOSECONDS_PER_MSEC)
+#define TEST_RUN_MSEC		500
+
+typedef struct {
+	volatile U32 steps;
+	volatile U32 stepsStopped;
+	volatile U32 releases;
+} test_stream_t;
+
+static test_stream_t testStreams[TEST_STREAMS + 1];
+
+// Stands in for the talker and listener life cycle. endpointHandle is the index of the stream.
+bool openavbTLStep(tl_state_t *pTLState, U64 nowNS, U64 *pNextNS)
+{
+	test_stream_t *pStream = &testStreams[pTLState->endpointHandle];
+
+	if (!pTLState->bRunning) {
+		if (pStream->releases++)
+			pStream->stepsStopped++;
+		return FALSE;
+	}
+
+	pStream->steps++;
+	*pNextNS = nowNS + TEST_INTERVAL_NS;
+	return TRUE;
+}
+
+static void x_testInit(tl_state_t *pTLState, U32 idx, avb_role_t role, U32 affinity)
+{
+	memset(pTLState, 0, sizeof(tl_state_t));
+	pTLState->endpointHandle = idx;
+	pTLState->cfg.role = role;
+	pTLState->cfg.thread_affinity = affinity;
+	snprintf(pTLState->cfg.friendly_name, sizeof(pTLState->cfg.friendly_name), "stream%u", idx);
+}
+
+// CPUs the test may pin workers to, at most 32
+static U32 x_cpuMask(void)
+{
+	cpu_set_t cpus;
+	U32 mask = 0;
+	int cpu;
+
+	if (sched_getaffinity(0, sizeof(cpus), &cpus) == 0) {
+		for (cpu = 0; cpu < 32; cpu++) {
+			if (CPU_ISSET(cpu, &cpus))
+				mask |= 1U << cpu;
+		}
+	}
+	return mask;
+}
+
+int main(int argc, char *argv[])
+{
+	static tl_state_t tlStates[TEST_STREAMS + 1];
+	openavb_tl_pool_stats_t stats[TEST_WORKERS];
+	U32 cpuMask = x_cpuMask();
+	U32 i1;
+
+	FILE *pLogFile = fopen("/dev/null", "w");
+	avbLogInitEx(pLogFile);
+
+	TEST_CHECK(openavbTLPoolCreate(0, cpuMask, 0) == NULL);
+
+	tl_pool_handle_t pool = openavbTLPoolCreate(TEST_WORKERS, cpuMask, 0);
+	TEST_CHECK(pool != NULL);
+	if (!pool) {
+		avbLogExit();
+		return TEST_RESULT();
+	}
+	TEST_CHECK(openavbTLPoolWorkerCount(pool) == TEST_WORKERS);
+	TEST_CHECK(!openavbTLPoolGetStats(pool, TEST_WORKERS, &stats[0]));
+
+	// Waiting talkers can't share a worker
+	x_testInit(&tlStates[0], 0, AVB_ROLE_TALKER, 0xFFFFFFFF);
+	tlStates[0].cfg.spin_wait = TRUE;
+	TEST_CHECK(!openavbTLPoolAccepts(&tlStates[0]));
+
+	// Talkers and listeners alternate, none pinned
+	for (i1 = 0; i1 < TEST_STREAMS; i1++) {
+		x_testInit(&tlStates[i1], i1, (i1 & 1) ? AVB_ROLE_LISTENER : AVB_ROLE_TALKER, 0xFFFFFFFF);
+		TEST_CHECK(openavbTLPoolAccepts(&tlStates[i1]));
+		TEST_CHECK(openavbTLPoolAttach(pool, &tlStates[i1]));
+		tlStates[i1].bRunning = TRUE;
+		TEST_CHECK(openavbTLPoolStart(&tlStates[i1]));
+	}
+
+	// Each role is spread evenly
+	U32 minTalkers = (U32)-1, maxTalkers = 0, minListeners = (U32)-1, maxListeners = 0;
+	for (i1 = 0; i1 < TEST_WORKERS; i1++) {
+		TEST_CHECK(openavbTLPoolGetStats(pool, i1, &stats[i1]));
+		if (stats[i1].talkers < minTalkers) minTalkers = stats[i1].talkers;
+		if (stats[i1].talkers > maxTalkers) maxTalkers = stats[i1].talkers;
+		if (stats[i1].listeners < minListeners) minListeners = stats[i1].listeners;
+		if (stats[i1].listeners > maxListeners) maxListeners = stats[i1].listeners;
+	}
+	TEST_CHECKF(maxTalkers - minTalkers <= 1, "talkers %u to %u", minTalkers, maxTalkers);
+	TEST_CHECKF(maxListeners - minListeners <= 1, "listeners %u to %u", minListeners, maxListeners);
+
+	// A talker pinned to the CPU of the last worker goes to a worker on that CPU
+	U32 pinnedCpu = stats[TEST_WORKERS - 1].cpu;
+	if (stats[TEST_WORKERS - 1].cpu >= 0) {
+		x_testInit(&tlStates[TEST_STREAMS], TEST_STREAMS, AVB_ROLE_TALKER, 1U << pinnedCpu);
+		TEST_CHECK(openavbTLPoolAttach(pool, &tlStates[TEST_STREAMS]));
+		tlStates[TEST_STREAMS].bRunning = TRUE;
+		TEST_CHECK(openavbTLPoolStart(&tlStates[TEST_STREAMS]));
+		for (i1 = 0; i1 < TEST_WORKERS; i1++) {
+			openavb_tl_pool_stats_t after;
+			TEST_CHECK(openavbTLPoolGetStats(pool, i1, &after));
+			if (after.talkers != stats[i1].talkers)
+				TEST_CHECKF(after.cpu == (int)pinnedCpu, "worker %u on cpu %d", i1, after.cpu);
+		}
+	}
+
+	// Streams can't be attached once configured, nor the pool deleted while they run
+	tl_state_t configured;
+	x_testInit(&configured, TEST_STREAMS, AVB_ROLE_LISTENER, 0xFFFFFFFF);
+	configured.pMediaQ = (media_q_t *)&configured;
+	TEST_CHECK(!openavbTLPoolAttach(pool, &configured));
+	TEST_CHECK(!openavbTLPoolDelete(pool));
+
+	U64 startNS, endNS;
+	CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &startNS);
+	SLEEP_MSEC(TEST_RUN_MSEC);
+	CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &endNS);
+
+	// Stepped about once per interval. Lenient below as the machine may be loaded, strict above
+	// since stepping ahead of time would mean the workers spin.
+	U32 nStreams = tlStates[TEST_STREAMS].bRunning ? TEST_STREAMS + 1 : TEST_STREAMS;
+	U32 dueSteps = (endNS - startNS) / TEST_INTERVAL_NS;
+	U32 minSteps = (U32)-1, maxSteps = 0;
+	for (i1 = 0; i1 < nStreams; i1++) {
+		U32 steps = testStreams[i1].steps;
+		if (steps < minSteps) minSteps = steps;
+		if (steps > maxSteps) maxSteps = steps;
+	}
+	TEST_CHECKF(minSteps >= dueSteps / 4, "%u steps, %u due", minSteps, dueSteps);
+	TEST_CHECKF(maxSteps <= dueSteps + dueSteps / 4 + 2, "%u steps, %u due", maxSteps, dueSteps);
+
+	U64 steps = 0;
+	for (i1 = 0; i1 < TEST_WORKERS; i1++) {
+		TEST_CHECK(openavbTLPoolGetStats(pool, i1, &stats[i1]));
+		TEST_CHECK(stats[i1].busyNS <= stats[i1].runNS);
+		steps += stats[i1].steps;
+	}
+	TEST_CHECK(steps >= minSteps * nStreams);
+
+	// Stop them all, each is released once and not stepped after
+	for (i1 = 0; i1 < nStreams; i1++) {
+		tlStates[i1].bRunning = FALSE;
+		openavbTLPoolStop(&tlStates[i1]);
+		TEST_CHECKF(testStreams[i1].releases == 1, "stream %u", i1);
+		TEST_CHECK(!tlStates[i1].bPoolActive);
+	}
+	for (i1 = 0; i1 < TEST_WORKERS; i1++) {
+		TEST_CHECK(openavbTLPoolGetStats(pool, i1, &stats[i1]));
+		TEST_CHECK(stats[i1].talkers == 0 && stats[i1].listeners == 0);
+	}
+	U32 stoppedSteps[TEST_STREAMS + 1];
+	for (i1 = 0; i1 < nStreams; i1++) {
+		stoppedSteps[i1] = testStreams[i1].steps;
+	}
+	SLEEP_MSEC(20);
+	for (i1 = 0; i1 < nStreams; i1++) {
+		TEST_CHECKF(testStreams[i1].steps == stoppedSteps[i1] && testStreams[i1].stepsStopped == 0, "stream %u", i1);
+	}
+
+	TEST_CHECK(openavbTLPoolDelete(pool));
+
+	avbLogExit();
+	if (pLogFile)
+		fclose(pLogFile);
+	return TEST_RESULT();
+}
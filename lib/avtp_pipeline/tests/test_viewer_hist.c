@@ -0,0 +1,192 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Checks the latency histograms of the viewer interface module.
+*
+* Bucket boundaries are checked to map back to their bucket over the whole range. Sets of
+* values from several distributions, including negative values, are recorded and the
+* reported percentiles are compared with the exact values from the sorted set, which they
+* may only exceed by the width of one bucket. Merged histograms must match a histogram
+* that recorded every value.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "openavb_test.h"
+
+// The bucket helpers are static, build the module into the test to reach them
+#include "openavb_intf_viewer_hist.c"
+
+#define TEST_VALUES		200000
+
+static S64 values[TEST_VALUES];
+static S64 sorted[TEST_VALUES];
+static viewer_hist_t hist, histA, histB;
+
+static int x_compareS64(const void *pA, const void *pB)
+{
+	S64 a = *(const S64 *)pA, b = *(const S64 *)pB;
+	return a < b ? -1 : a > b;
+}
+
+static void x_checkBuckets(void)
+{
+	U64 low, high, prevHigh = 0;
+	U32 idx;
+
+	for (idx = 0; idx < VIEWER_HIST_BUCKETS; idx++) {
+		x_bucketRange(idx, &low, &high);
+		TEST_CHECKF(low <= high, "bucket %u", idx);
+		TEST_CHECKF(idx == 0 || low == prevHigh + 1, "bucket %u starts at %llu", idx, (unsigned long long)low);
+		TEST_CHECKF(x_bucketIndex(low) == idx && x_bucketIndex(high) == idx, "bucket %u [%llu, %llu]",
+			idx, (unsigned long long)low, (unsigned long long)high);
+		if (low >= (1 << VIEWER_HIST_SUB_BITS)) {
+			// Relative width bounds the error of a reported value
+			TEST_CHECKF((high - low + 1) * VIEWER_HIST_HALF_COUNT <= low, "bucket %u too wide", idx);
+		}
+		prevHigh = high;
+	}
+	TEST_CHECK(prevHigh == VIEWER_HIST_MAX_MAG);
+	TEST_CHECK(x_bucketIndex(VIEWER_HIST_MAX_MAG + 1) == VIEWER_HIST_BUCKETS - 1);
+	TEST_CHECK(x_bucketIndex(~0ULL) == VIEWER_HIST_BUCKETS - 1);
+}
+
+// Magnitudes spread over many powers of two, like latencies with a long tail
+static S64 x_logValue(U32 *pState, U32 maxBits)
+{
+	U32 bits = testRand(pState) % maxBits;
+	return (S64)(((U64)testRand(pState) << 32 | testRand(pState)) & ((2ULL << bits) - 1));
+}
+
+static void x_checkPercentiles(const char *pName, U32 count)
+{
+	static const U32 ppms[] = { 1, 1000, 100000, VIEWER_HIST_P50, 900000, VIEWER_HIST_P99, VIEWER_HIST_P999, 999999, 1000000 };
+	openavb_intf_latency_t summary;
+	S64 sum = 0;
+	U32 i1;
+
+	openavbViewerHistReset(&hist);
+	for (i1 = 0; i1 < count; i1++) {
+		openavbViewerHistRecord(&hist, values[i1]);
+		sum += values[i1];
+	}
+	memcpy(sorted, values, count * sizeof(S64));
+	qsort(sorted, count, sizeof(S64), x_compareS64);
+
+	for (i1 = 0; i1 < sizeof(ppms) / sizeof(ppms[0]); i1++) {
+		U64 rank = ((U64)count * ppms[i1] + 999999) / 1000000;
+		S64 exact = sorted[(rank ? rank : 1) - 1];
+		S64 reported = openavbViewerHistPercentile(&hist, ppms[i1]);
+		U64 mag = exact < 0 ? -(U64)exact : (U64)exact;
+		U64 low, high;
+
+		// The reported value is the bucket end toward +inf, at most one bucket away
+		x_bucketRange(x_bucketIndex(mag), &low, &high);
+		TEST_CHECKF(reported >= exact && (U64)(reported - exact) <= high - low, "%s p%u: %lld, exact %lld",
+			pName, ppms[i1], (long long)reported, (long long)exact);
+	}
+
+	openavbViewerHistSummary(&hist, &summary);
+	TEST_CHECKF(summary.count == count, "%s", pName);
+	TEST_CHECKF(summary.minNS == sorted[0], "%s", pName);
+	TEST_CHECKF(summary.maxNS == sorted[count - 1], "%s", pName);
+	TEST_CHECKF(summary.meanNS == sum / (S64)count, "%s", pName);
+	TEST_CHECKF(summary.p50NS == openavbViewerHistPercentile(&hist, VIEWER_HIST_P50), "%s", pName);
+
+	// Two halves merged must match the whole
+	openavbViewerHistReset(&histA);
+	openavbViewerHistReset(&histB);
+	for (i1 = 0; i1 < count; i1++) {
+		openavbViewerHistRecord((i1 & 1) ? &histB : &histA, values[i1]);
+	}
+	openavbViewerHistMerge(&histA, &histB);
+	TEST_CHECKF(memcmp(&histA, &hist, sizeof(hist)) == 0, "%s merge", pName);
+}
+
+int main(int argc, char *argv[])
+{
+	U32 randState = 0x1722B15;
+	openavb_intf_latency_t summary;
+	U32 i1;
+
+	x_checkBuckets();
+
+	openavbViewerHistReset(&hist);
+	TEST_CHECK(openavbViewerHistPercentile(&hist, VIEWER_HIST_P50) == 0);
+	openavbViewerHistSummary(&hist, &summary);
+	TEST_CHECK(summary.count == 0 && summary.maxNS == 0);
+	openavbViewerHistMerge(&histA, &hist);
+
+	values[0] = 12345;
+	x_checkPercentiles("single", 1);
+
+	// Small values each have their own bucket, so every percentile is exact
+	for (i1 = 0; i1 < TEST_VALUES; i1++) {
+		values[i1] = testRand(&randState) % 64;
+	}
+	x_checkPercentiles("small", TEST_VALUES);
+
+	for (i1 = 0; i1 < TEST_VALUES; i1++) {
+		values[i1] = 100000 + testRand(&randState) % 2000000;
+	}
+	x_checkPercentiles("uniform", TEST_VALUES);
+
+	for (i1 = 0; i1 < TEST_VALUES; i1++) {
+		values[i1] = x_logValue(&randState, 36);
+	}
+	x_checkPercentiles("long tail", TEST_VALUES);
+
+	// Early packets give negative latencies
+	for (i1 = 0; i1 < TEST_VALUES; i1++) {
+		values[i1] = x_logValue(&randState, 24) - (1 << 20);
+	}
+	x_checkPercentiles("negative", TEST_VALUES);
+
+	// Out of range magnitudes go to the last bucket, min and max stay exact
+	for (i1 = 0; i1 < 1000; i1++) {
+		values[i1] = (i1 & 1) ? (S64)(3ULL << 40) + i1 : -(S64)(5ULL << 41) - i1;
+	}
+	openavbViewerHistReset(&hist);
+	for (i1 = 0; i1 < 1000; i1++) {
+		openavbViewerHistRecord(&hist, values[i1]);
+	}
+	TEST_CHECK(hist.pos[VIEWER_HIST_BUCKETS - 1] == 500 && hist.neg[VIEWER_HIST_BUCKETS - 1] == 500);
+	TEST_CHECK(openavbViewerHistPercentile(&hist, 1000000) == (S64)(3ULL << 40) + 999);
+	TEST_CHECK(hist.min == -(S64)(5ULL << 41) - 998);
+
+	// The most negative values report the end of the last bucket toward zero
+	U64 low, high;
+	x_bucketRange(VIEWER_HIST_BUCKETS - 1, &low, &high);
+	TEST_CHECK(openavbViewerHistPercentile(&hist, 1) == -(S64)low);
+
+	return TEST_RESULT();
+}
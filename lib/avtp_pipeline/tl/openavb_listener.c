@@ -51,6 +51,50 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 #include "openavb_debug.h"
 
+// How often a listener that isn't streaming looks for endpoint messages
+#define LISTENER_IDLE_MSEC	1
+
+typedef enum {
+	LISTENER_METRIC_CALLS = TL_METRIC_COMMON_COUNT,
+	LISTENER_METRIC_FRAMES,
+	LISTENER_METRIC_LOST,
+	LISTENER_METRIC_BYTES,
+	LISTENER_METRIC_RX_BUFFER_LEVEL,
+	LISTENER_METRIC_COUNT
+} listener_metric_t;
+
+static const openavb_metric_def_t listenerMetricDefs[LISTENER_METRIC_COUNT] = {
+	TL_METRIC_COMMON_DEFS,
+	{ "rx_calls_total", "Listener receive calls", OPENAVB_METRIC_COUNTER },
+	{ "rx_frames_total", "Frames received", OPENAVB_METRIC_COUNTER },
+	{ "rx_lost_total", "Frames lost according to the AVTP sequence number", OPENAVB_METRIC_COUNTER },
+	{ "rx_bytes_total", "Bytes received", OPENAVB_METRIC_COUNTER },
+	{ "rx_buffer_level", "Frames waiting in the raw socket receive buffer", OPENAVB_METRIC_GAUGE },
+};
+
+// Add the progress since the last call to the metrics and refresh the gauges.
+static void listenerPublishStats(listener_data_t *pListenerData, tl_state_t *pTLState)
+{
+	openavb_metrics_group_t *pMetrics = pTLState->pMetrics;
+	U64 lost = openavbAvtpLost(pListenerData->avtpHandle);
+	U64 bytes = openavbAvtpBytes(pListenerData->avtpHandle);
+
+	pListenerData->reportLost += lost;
+	pListenerData->reportBytes += bytes;
+	openavbMetricsAdd(pMetrics, LISTENER_METRIC_CALLS, pListenerData->nReportCalls - pListenerData->pubReportCalls);
+	openavbMetricsAdd(pMetrics, LISTENER_METRIC_FRAMES, pListenerData->nReportFrames - pListenerData->pubReportFrames);
+	openavbMetricsAdd(pMetrics, LISTENER_METRIC_LOST, lost);
+	openavbMetricsAdd(pMetrics, LISTENER_METRIC_BYTES, bytes);
+	pListenerData->pubReportCalls = pListenerData->nReportCalls;
+	pListenerData->pubReportFrames = pListenerData->nReportFrames;
+
+	if (pListenerData->avtpHandle) {
+		openavbMetricsSet(pMetrics, LISTENER_METRIC_RX_BUFFER_LEVEL, openavbAvtpRxBufferLevel(pListenerData->avtpHandle));
+	}
+
+	openavbTLMetricsPublish(pTLState);
+}
+
 bool listenerStartStream(tl_state_t *pTLState)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_TL);
@@ -81,6 +125,11 @@ bool listenerStartStream(tl_state_t *pTLState)
 		return FALSE;
 	}
 
+	if (pTLState->pPool) {
+		// Workers poll each of their listeners in turn, so receiving must not block.
+		openavbAvtpSetRxPoll(pListenerData->avtpHandle, TRUE);
+	}
+
 	// Setup timers
 	U64 nowNS;
 	CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &nowNS);
@@ -91,12 +140,18 @@ bool listenerStartStream(tl_state_t *pTLState)
 	// Clear counters
 	pListenerData->nReportCalls = 0;
 	pListenerData->nReportFrames = 0;
+	pListenerData->pubReportCalls = 0;
+	pListenerData->pubReportFrames = 0;
+	pListenerData->reportLost = 0;
+	pListenerData->reportBytes = 0;
 
 	// Clear stats
 	openavbListenerClearStats(pTLState);
 
 	// we're good to go!
 	pTLState->bStreaming = TRUE;
+	openavbTLMarkStartup(&pTLState->streamingNS);
+	openavbMetricsSet(pTLState->pMetrics, TL_METRIC_STREAMING, 1);
 
 	AVB_TRACE_EXIT(AVB_TRACE_TL);
 	return TRUE;
@@ -119,10 +174,7 @@ void listenerStopStream(tl_state_t *pTLState)
 		return;
 	}
 
-	openavbListenerAddStat(pTLState, TL_STAT_RX_CALLS, pListenerData->nReportCalls);
-	openavbListenerAddStat(pTLState, TL_STAT_RX_FRAMES, pListenerData->nReportFrames);
-	openavbListenerAddStat(pTLState, TL_STAT_RX_LOST, openavbAvtpLost(pListenerData->avtpHandle));
-	openavbListenerAddStat(pTLState, TL_STAT_RX_BYTES, openavbAvtpBytes(pListenerData->avtpHandle));
+	listenerPublishStats(pListenerData, pTLState);
 
 	AVB_LOGF_INFO("RX "STREAMID_FORMAT", Totals: calls=%" PRIu64 ", frames=%" PRIu64 ", lost=%" PRIu64 ", bytes=%" PRIu64,
 		STREAMID_ARGS(&pListenerData->streamID),
@@ -135,14 +187,17 @@ void listenerStopStream(tl_state_t *pTLState)
 		openavbAvtpShutdownListener(pListenerData->avtpHandle);
 		pTLState->bStreaming = FALSE;
 	}
+	openavbMetricsSet(pTLState->pMetrics, TL_METRIC_STREAMING, 0);
 
 	AVB_TRACE_EXIT(AVB_TRACE_TL);
 }
 
 static inline void listenerShowStats(listener_data_t *pListenerData, tl_state_t *pTLState)
 {
-	U64 lost = openavbAvtpLost(pListenerData->avtpHandle);
-	U64 bytes = openavbAvtpBytes(pListenerData->avtpHandle);
+	listenerPublishStats(pListenerData, pTLState);
+
+	U64 lost = pListenerData->reportLost;
+	U64 bytes = pListenerData->reportBytes;
 	U32 rxbuf = openavbAvtpRxBufferLevel(pListenerData->avtpHandle);
 	U32 mqbuf = openavbMediaQCountItems(pTLState->pMediaQ, TRUE);
 	U32 mqrdy = openavbMediaQCountItems(pTLState->pMediaQ, FALSE);
@@ -156,8 +211,8 @@ static inline void listenerShowStats(listener_data_t *pListenerData, tl_state_t
 	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, FALSE, "mqbuf=%d, ", LOG_RT_DATATYPE_U32, &mqbuf);
 	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, LOG_RT_END, "mqrdy=%d", LOG_RT_DATATYPE_U32, &mqrdy);
 
-	openavbListenerAddStat(pTLState, TL_STAT_RX_LOST, lost);
-	openavbListenerAddStat(pTLState, TL_STAT_RX_BYTES, bytes);
+	pListenerData->reportLost = 0;
+	pListenerData->reportBytes = 0;
 }
 
 static inline bool listenerDoStream(tl_state_t *pTLState)
@@ -182,6 +237,7 @@ static inline bool listenerDoStream(tl_state_t *pTLState)
 		// Try to receive a frame
 		if (IS_OPENAVB_SUCCESS(openavbAvtpRx(pListenerData->avtpHandle))) {
 			pListenerData->nReportFrames++;
+			openavbTLMarkStartup(&pTLState->firstFrameNS);
 		}
 
 		CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &nowNS);
@@ -190,11 +246,10 @@ static inline bool listenerDoStream(tl_state_t *pTLState)
 			if (nowNS > pListenerData->nextReportNS) {
 				listenerShowStats(pListenerData, pTLState);
 
-				openavbListenerAddStat(pTLState, TL_STAT_RX_CALLS, pListenerData->nReportCalls);
-				openavbListenerAddStat(pTLState, TL_STAT_RX_FRAMES, pListenerData->nReportFrames);
-
 				pListenerData->nReportCalls = 0;
 				pListenerData->nReportFrames = 0;
+				pListenerData->pubReportCalls = 0;
+				pListenerData->pubReportFrames = 0;
 				pListenerData->nextReportNS += (pCfg->report_seconds * NANOSECONDS_PER_SECOND);
 			}
 		} else if (pCfg->report_frames > 0 && pListenerData->nReportFrames != pListenerData->lastReportFrames) {
@@ -207,10 +262,13 @@ static inline bool listenerDoStream(tl_state_t *pTLState)
 		if (nowNS > pListenerData->nextSecondNS) {
 			pListenerData->nextSecondNS += NANOSECONDS_PER_SECOND;
 			bRet = TRUE;
+			listenerPublishStats(pListenerData, pTLState);
 		}
 	}
 	else {
-		SLEEP_MSEC(1);
+		if (!pTLState->pPool) {
+			SLEEP_MSEC(LISTENER_IDLE_MSEC);
+		}
 		bRet = TRUE;
 	}
 
@@ -218,89 +276,130 @@ static inline bool listenerDoStream(tl_state_t *pTLState)
 	return bRet;
 }
 
-// Called from openavbTLThreadFn() which is started from openavbTLRun()
-void openavbTLRunListener(tl_state_t *pTLState)
+// The stream the listener attaches to, from its configuration.
+static void listenerCfgStreamID(tl_state_t *pTLState, AVBStreamID_t *pStreamID)
+{
+	openavb_tl_cfg_t *pCfg = &pTLState->cfg;
+
+	memset(pStreamID, 0, sizeof(*pStreamID));
+	memcpy(pStreamID->addr, pCfg->stream_addr.mac, ETH_ALEN);
+	pStreamID->uniqueID = pCfg->stream_uid;
+}
+
+// Set up the listener once connected to the endpoint. Returns FALSE, with everything released, on failure.
+bool openavbTLRunListenerBegin(tl_state_t *pTLState)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_TL);
 
 	if (!pTLState) {
 		AVB_LOG_ERROR("Invalid TLState");
 		AVB_TRACE_EXIT(AVB_TRACE_TL);
-		return;
+		return FALSE;
 	}
 
-	openavb_tl_cfg_t *pCfg = &pTLState->cfg;
-
 	pTLState->pPvtListenerData = calloc(1, sizeof(listener_data_t));
 	if (!pTLState->pPvtListenerData) {
 		AVB_LOG_WARNING("Failed to allocate listener data.");
-		return;
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
 	}
 
 	AVBStreamID_t streamID;
-	memset(&streamID, 0, sizeof(streamID));
-	memcpy(streamID.addr, pCfg->stream_addr.mac, ETH_ALEN);
-	streamID.uniqueID = pCfg->stream_uid;
+	listenerCfgStreamID(pTLState, &streamID);
 
 	AVB_LOGF_INFO("Attach "STREAMID_FORMAT, STREAMID_ARGS(&streamID));
 
-	// Create Stats Mutex
-	{
-		MUTEX_ATTR_HANDLE(mta);
-		MUTEX_ATTR_INIT(mta);
-		MUTEX_ATTR_SET_TYPE(mta, MUTEX_ATTR_TYPE_DEFAULT);
-		MUTEX_ATTR_SET_NAME(mta, "TLStatsMutex");
-		MUTEX_CREATE_ERR();
-		MUTEX_CREATE(pTLState->statsMutex, mta);
-		MUTEX_LOG_ERR("Could not create/initialize 'TLStatsMutex' mutex");
-	}
+	openavbTLMetricsOpen(pTLState, "listener", listenerMetricDefs, LISTENER_METRIC_COUNT);
 
 	// Tell endpoint to listen for our stream.
 	// If there is a talker, we'll get callback (above.)
 	pTLState->bConnected = openavbTLRunListenerInit(pTLState->endpointHandle, &streamID);
 
 	if (pTLState->bConnected) {
-		bool bServiceIPC;
+		openavbTLMarkStartup(&pTLState->connectedNS);
+
+		// Replies to the attach are flagged as they arrive
+		openavbEptClntNotify(pTLState->endpointHandle, &pTLState->bEndpointPending);
 
 		// Notify AVDECC Msg of the state change.
 		openavbAvdeccMsgClntNotifyCurrentState(pTLState);
+	}
+	else {
+		AVB_LOGF_WARNING("Failed to connect to endpoint "STREAMID_FORMAT, STREAMID_ARGS(&streamID));
 
-		// Do until we are stopped or lose connection to endpoint
-		while (pTLState->bRunning && pTLState->bConnected) {
+		openavbTLMetricsClose(pTLState);
 
-			// Listen for an RX frame (or just sleep if not streaming)
-			bServiceIPC = listenerDoStream(pTLState);
+		free(pTLState->pPvtListenerData);
+		pTLState->pPvtListenerData = NULL;
+	}
 
-			if (bServiceIPC) {
-				// Look for messages from endpoint.  Don't block (timeout=0)
-				if (!openavbEptClntService(pTLState->endpointHandle, 0)) {
-					AVB_LOGF_WARNING("Lost connection to endpoint "STREAMID_FORMAT, STREAMID_ARGS(&streamID));
-					pTLState->bConnected = FALSE;
-					pTLState->endpointHandle = 0;
-				}
-			}
-		}
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return pTLState->bConnected;
+}
 
-		// Stop streaming
-		listenerStopStream(pTLState);
+// One pass of the listener loop. When run by a pool worker pNextNS is set to when the next pass is due.
+void openavbTLRunListenerStep(tl_state_t *pTLState, U64 *pNextNS)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
 
-		{
-			MUTEX_CREATE_ERR();
-			MUTEX_DESTROY(pTLState->statsMutex); // Destroy Stats Mutex
-			MUTEX_LOG_ERR("Error destroying mutex");
+	listener_data_t *pListenerData = pTLState->pPvtListenerData;
+	unsigned long nFrames = pListenerData->nReportFrames;
+
+	// Listen for an RX frame (or just sleep if not streaming)
+	bool bServiceIPC = listenerDoStream(pTLState);
+
+	// Messages the endpoint sends are flagged as they arrive. The endpoint status
+	// table is looked at whenever the IPC is serviced.
+	if (bServiceIPC || pTLState->bEndpointPending) {
+		pTLState->bEndpointPending = FALSE;
+		// Look for messages from endpoint.  Don't block (timeout=0)
+		if (!openavbEptClntService(pTLState->endpointHandle, 0)) {
+			AVBStreamID_t streamID;
+			listenerCfgStreamID(pTLState, &streamID);
+			AVB_LOGF_WARNING("Lost connection to endpoint "STREAMID_FORMAT, STREAMID_ARGS(&streamID));
+			pTLState->bConnected = FALSE;
+			pTLState->endpointHandle = 0;
 		}
+		else {
+			openavbTLRunListenerStatus(pTLState);
+			openavbEptClntNotify(pTLState->endpointHandle, &pTLState->bEndpointPending);
+		}
+	}
 
-		// withdraw our listener attach
-		if (pTLState->bConnected)
-			openavbEptClntStopStream(pTLState->endpointHandle, &streamID);
-
-		// Notify AVDECC Msg of the state change.
-		openavbAvdeccMsgClntNotifyCurrentState(pTLState);
+	if (pNextNS) {
+		CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, pNextNS);
+		if (!pTLState->bStreaming) {
+			*pNextNS += LISTENER_IDLE_MSEC * NANOSECONDS_PER_MSEC;
+		}
+		else if (pListenerData->nReportFrames == nFrames) {
+			// Nothing was waiting. Look again on the next poll.
+			*pNextNS += openavbTLPoolRxPollNS(pTLState->pPool);
+		}
 	}
-	else {
-		AVB_LOGF_WARNING("Failed to connect to endpoint "STREAMID_FORMAT, STREAMID_ARGS(&streamID));
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+}
+
+// Tear down what openavbTLRunListenerBegin() set up.
+void openavbTLRunListenerEnd(tl_state_t *pTLState)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	// Stop streaming
+	listenerStopStream(pTLState);
+
+	// withdraw our listener attach
+	if (pTLState->bConnected) {
+		AVBStreamID_t streamID;
+		listenerCfgStreamID(pTLState, &streamID);
+		openavbEptClntStopStream(pTLState->endpointHandle, &streamID);
 	}
 
+	// Notify AVDECC Msg of the state change.
+	openavbAvdeccMsgClntNotifyCurrentState(pTLState);
+
+	openavbTLMetricsClose(pTLState);
+
 	if (pTLState->pPvtListenerData) {
 		free(pTLState->pPvtListenerData);
 		pTLState->pPvtListenerData = NULL;
@@ -309,6 +408,23 @@ void openavbTLRunListener(tl_state_t *pTLState)
 	AVB_TRACE_EXIT(AVB_TRACE_TL);
 }
 
+// Called from openavbTLThreadFn() which is started from openavbTLRun()
+void openavbTLRunListener(tl_state_t *pTLState)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	if (openavbTLRunListenerBegin(pTLState)) {
+		// Do until we are stopped or lose connection to endpoint
+		while (pTLState->bRunning && pTLState->bConnected) {
+			openavbTLRunListenerStep(pTLState, NULL);
+		}
+
+		openavbTLRunListenerEnd(pTLState);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+}
+
 void openavbTLPauseListener(tl_state_t *pTLState, bool bPause)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_TL);
@@ -352,9 +468,10 @@ void openavbListenerClearStats(tl_state_t *pTLState)
 		return;
 	}
 
-	LOCK_STATS();
-	memset(&pListenerData->stats, 0, sizeof(pListenerData->stats));
-	UNLOCK_STATS();
+	U32 i1;
+	for (i1 = 0; i1 < LISTENER_METRIC_COUNT; i1++) {
+		openavbMetricsSet(pTLState->pMetrics, i1, 0);
+	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_TL);
 }
@@ -376,27 +493,26 @@ void openavbListenerAddStat(tl_state_t *pTLState, tl_stat_t stat, U64 val)
 		return;
 	}
 
-	LOCK_STATS();
 	switch (stat) {
 		case TL_STAT_TX_CALLS:
 		case TL_STAT_TX_FRAMES:
 		case TL_STAT_TX_LATE:
 		case TL_STAT_TX_BYTES:
+		case TL_STAT_INTF_XRUNS:
 			break;
 		case TL_STAT_RX_CALLS:
-			pListenerData->stats.totalCalls += val;
+			openavbMetricsAdd(pTLState->pMetrics, LISTENER_METRIC_CALLS, val);
 			break;
 		case TL_STAT_RX_FRAMES:
-			pListenerData->stats.totalFrames += val;
+			openavbMetricsAdd(pTLState->pMetrics, LISTENER_METRIC_FRAMES, val);
 			break;
 		case TL_STAT_RX_LOST:
-			pListenerData->stats.totalLost += val;
+			openavbMetricsAdd(pTLState->pMetrics, LISTENER_METRIC_LOST, val);
 			break;
 		case TL_STAT_RX_BYTES:
-			pListenerData->stats.totalBytes += val;
+			openavbMetricsAdd(pTLState->pMetrics, LISTENER_METRIC_BYTES, val);
 			break;
 	}
-	UNLOCK_STATS();
 
 	AVB_TRACE_EXIT(AVB_TRACE_TL);
 }
@@ -419,27 +535,26 @@ U64 openavbListenerGetStat(tl_state_t *pTLState, tl_stat_t stat)
 		return 0;
 	}
 
-	LOCK_STATS();
 	switch (stat) {
 		case TL_STAT_TX_CALLS:
 		case TL_STAT_TX_FRAMES:
 		case TL_STAT_TX_LATE:
 		case TL_STAT_TX_BYTES:
+		case TL_STAT_INTF_XRUNS:
 			break;
 		case TL_STAT_RX_CALLS:
-			val = pListenerData->stats.totalCalls;
+			val = openavbMetricsGet(pTLState->pMetrics, LISTENER_METRIC_CALLS);
 			break;
 		case TL_STAT_RX_FRAMES:
-			val = pListenerData->stats.totalFrames;
+			val = openavbMetricsGet(pTLState->pMetrics, LISTENER_METRIC_FRAMES);
 			break;
 		case TL_STAT_RX_LOST:
-			val = pListenerData->stats.totalLost;
+			val = openavbMetricsGet(pTLState->pMetrics, LISTENER_METRIC_LOST);
 			break;
 		case TL_STAT_RX_BYTES:
-			val = pListenerData->stats.totalBytes;
+			val = openavbMetricsGet(pTLState->pMetrics, LISTENER_METRIC_BYTES);
 			break;
 	}
-	UNLOCK_STATS();
 
 	AVB_TRACE_EXIT(AVB_TRACE_TL);
 	return val;
@@ -38,13 +38,6 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 #include "openavb_tl.h"
 
-typedef struct {
-	U64 totalCalls;
-	U64 totalFrames;
-	U64 totalLost;
-	U64 totalBytes;
-} listener_stats_t;
-
 typedef struct {
 	// Data from callback
 	char			ifname[IFNAMSIZ + 10]; // Include space for the socket type prefix (e.g. "simple:eth0")
@@ -52,6 +45,8 @@ typedef struct {
 	U8				destAddr[ETH_ALEN];
 	AVBTSpec_t		tSpec;
 	long			nFramesRx;
+	// Changes of our slot in the endpoint status table already acted on
+	U32				statusUpdates;
 
 	// State info for streaming
 	void			*avtpHandle;
@@ -60,15 +55,23 @@ typedef struct {
 	U64 			nextReportNS;
 	U64				nextSecondNS;
 	unsigned long	lastReportFrames;
-	listener_stats_t stats;
+	unsigned long	pubReportCalls;		// Part of nReportCalls already added to the metrics
+	unsigned long	pubReportFrames;	// Part of nReportFrames already added to the metrics
+	U64				reportLost;			// Lost frames since the last report
+	U64				reportBytes;		// Bytes since the last report
 } listener_data_t;
 
 void openavbTLRunListener(tl_state_t *pTLState);
+bool openavbTLRunListenerBegin(tl_state_t *pTLState);
+void openavbTLRunListenerStep(tl_state_t *pTLState, U64 *pNextNS);
+void openavbTLRunListenerEnd(tl_state_t *pTLState);
 void openavbTLPauseListener(tl_state_t *pTLState, bool bPause);
 void openavbListenerClearStats(tl_state_t *pTLState);
 void openavbListenerAddStat(tl_state_t *pTLState, tl_stat_t stat, U64 val);
 U64 openavbListenerGetStat(tl_state_t *pTLState, tl_stat_t stat);
 bool openavbTLRunListenerInit(int h, AVBStreamID_t *streamID);
+// Act on changes the endpoint made to our stream in its status table
+void openavbTLRunListenerStatus(tl_state_t *pTLState);
 bool listenerStartStream(tl_state_t *pTLState);
 void listenerStopStream(tl_state_t *pTLState);
 
@@ -40,6 +40,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_trace.h"
 #include "openavb_tl.h"
 #include "openavb_endpoint.h"
+#include "openavb_endpoint_status.h"
 #include "openavb_avtp.h"
 #include "openavb_listener.h"
 #include "openavb_avdecc_msg.h"
@@ -50,37 +51,22 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #define	AVB_LOG_COMPONENT	"Listener"
 #include "openavb_log.h"
 
-/* Listener callback comes from endpoint, to indicate when talkers
- * come and go. We may need to start or stop the listener thread.
+static const U8 emptyMAC[ETH_ALEN] = { 0, 0, 0, 0, 0, 0 };
+
+/* The endpoint tells us when talkers come and go, either with a
+ * callback or through the stream status table. We may need to start
+ * or stop the listener thread.
  */
-void openavbEptClntNotifyLstnrOfSrpCb(int endpointHandle,
+static void x_listenerSrpUpdate(tl_state_t *pTLState,
 	AVBStreamID_t 	*streamID,
 	char 			*ifname,
 	U8 			destAddr[],
 	openavbSrpAttribType_t tlkrDecl,
-	AVBTSpec_t		*tSpec,
-	U8				srClassID,
-	U32			latency,
-	openavbSrpFailInfo_t *failInfo)
+	AVBTSpec_t		*tSpec)
 {
-	AVB_TRACE_ENTRY(AVB_TRACE_TL);
-
-	static const U8 emptyMAC[ETH_ALEN] = { 0, 0, 0, 0, 0, 0 };
-	tl_state_t *pTLState = TLHandleListGet(endpointHandle);
 	openavb_tl_cfg_t *pCfg = &pTLState->cfg;
 	listener_data_t *pListenerData = pTLState->pPvtListenerData;
 
-	if (!pTLState) {
-		AVB_LOG_WARNING("Unable to get listener from endpoint handle.");
-		return;
-	}
-
-	// If not a listener, ignore this callback.
-	if (pTLState->cfg.role != AVB_ROLE_LISTENER) {
-		AVB_LOG_DEBUG("Ignoring Listener callback");
-		return;
-	}
-
 	AVB_LOGF_DEBUG("%s streaming=%d, tlkrDecl=%d", __FUNCTION__, pTLState->bStreaming, tlkrDecl);
 
 	if (!pTLState->bStreaming
@@ -144,6 +130,37 @@ void openavbEptClntNotifyLstnrOfSrpCb(int endpointHandle,
 			openavbAvdeccMsgClntChangeNotification(pTLState->avdeccMsgHandle, OPENAVB_AVDECC_MSG_STOPPED_UNEXPECTEDLY);
 		}
 	}
+}
+
+/* Listener callback comes from endpoint for a stream without a slot
+ * in the status table.
+ */
+void openavbEptClntNotifyLstnrOfSrpCb(int endpointHandle,
+	AVBStreamID_t 	*streamID,
+	char 			*ifname,
+	U8 			destAddr[],
+	openavbSrpAttribType_t tlkrDecl,
+	AVBTSpec_t		*tSpec,
+	U8				srClassID,
+	U32			latency,
+	openavbSrpFailInfo_t *failInfo)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	tl_state_t *pTLState = TLHandleListGet(endpointHandle);
+
+	if (!pTLState) {
+		AVB_LOG_WARNING("Unable to get listener from endpoint handle.");
+		return;
+	}
+
+	// If not a listener, ignore this callback.
+	if (pTLState->cfg.role != AVB_ROLE_LISTENER) {
+		AVB_LOG_DEBUG("Ignoring Listener callback");
+		return;
+	}
+
+	x_listenerSrpUpdate(pTLState, streamID, ifname, destAddr, tlkrDecl, tSpec);
 
 	AVB_TRACE_EXIT(AVB_TRACE_TL);
 }
@@ -152,3 +169,39 @@ bool openavbTLRunListenerInit(int h, AVBStreamID_t *streamID)
 {
 	return(openavbEptClntAttachStream(h, streamID, openavbSrp_LDSt_Interest));
 }
+
+void openavbTLRunListenerStatus(tl_state_t *pTLState)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	openavb_tl_cfg_t *pCfg = &pTLState->cfg;
+	listener_data_t *pListenerData = pTLState->pPvtListenerData;
+	openavb_endpoint_status_t status;
+	char ifname[IFNAMSIZ + 10];
+
+	AVBStreamID_t streamID;
+	memset(&streamID, 0, sizeof(AVBStreamID_t));
+	memcpy(streamID.addr, pCfg->stream_addr.mac, ETH_ALEN);
+	streamID.uniqueID = pCfg->stream_uid;
+
+	if (!openavbEptStatusFind(&streamID, &status)
+		|| status.updates == pListenerData->statusUpdates
+		|| !openavbEptStatusIfname(ifname, sizeof(ifname))) {
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return;
+	}
+	pListenerData->statusUpdates = status.updates;
+
+	// The talker may have gone and come back between two looks, as on a MAAP restart.
+	// Stop first if the stream moved, so it starts again with the new address.
+	if (pTLState->bStreaming
+		&& memcmp(status.destAddr, emptyMAC, ETH_ALEN) != 0
+		&& memcmp(status.destAddr, pListenerData->destAddr, ETH_ALEN) != 0) {
+		x_listenerSrpUpdate(pTLState, &status.streamID, ifname, status.destAddr, openavbSrp_AtTyp_None, &status.tSpec);
+	}
+
+	x_listenerSrpUpdate(pTLState, &status.streamID, ifname, status.destAddr,
+		(openavbSrpAttribType_t)status.tlkrDecl, &status.tSpec);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+}
@@ -66,6 +66,9 @@ bool openavbTLRunListenerInit(int hnd, AVBStreamID_t *streamID)
 	return TRUE;
 }
 
+void openavbTLRunListenerStatus(tl_state_t *pTLState)
+{
+}
 
 void openavbEptClntNotifyLstnrOfSrpCb(int endpointHandle,
 	AVBStreamID_t *streamID,
@@ -49,7 +49,52 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 
 #include "openavb_debug.h"
 
+// How often a talker that isn't streaming looks for endpoint messages
+#define TALKER_IDLE_MSEC	10
+
+typedef enum {
+	TALKER_METRIC_CALLS = TL_METRIC_COMMON_COUNT,
+	TALKER_METRIC_FRAMES,
+	TALKER_METRIC_LATE,
+	TALKER_METRIC_BYTES,
+	TALKER_METRIC_TX_BUFFER_LEVEL,
+	TALKER_METRIC_TX_OUT_OF_BUFFERS,
+	TALKER_METRIC_COUNT
+} talker_metric_t;
+
+static const openavb_metric_def_t talkerMetricDefs[TALKER_METRIC_COUNT] = {
+	TL_METRIC_COMMON_DEFS,
+	{ "tx_calls_total", "Talker wake ups", OPENAVB_METRIC_COUNTER },
+	{ "tx_frames_total", "Frames transmitted", OPENAVB_METRIC_COUNTER },
+	{ "tx_late_total", "Wake ups missing at report time", OPENAVB_METRIC_COUNTER },
+	{ "tx_bytes_total", "Bytes transmitted", OPENAVB_METRIC_COUNTER },
+	{ "tx_buffer_level", "Frames waiting in the raw socket transmit buffer", OPENAVB_METRIC_GAUGE },
+	{ "tx_out_of_buffers_total", "Times the raw socket ran out of transmit buffers", OPENAVB_METRIC_COUNTER },
+};
+
+// Add the progress since the last call to the metrics and refresh the gauges.
+static void talkerPublishStats(talker_data_t *pTalkerData, tl_state_t *pTLState)
+{
+	openavb_metrics_group_t *pMetrics = pTLState->pMetrics;
+	U64 bytes = openavbAvtpBytes(pTalkerData->avtpHandle);
+
+	pTalkerData->reportBytes += bytes;
+	openavbMetricsAdd(pMetrics, TALKER_METRIC_CALLS, pTalkerData->cntWakes - pTalkerData->pubWakes);
+	openavbMetricsAdd(pMetrics, TALKER_METRIC_FRAMES, pTalkerData->cntFrames - pTalkerData->pubFrames);
+	openavbMetricsAdd(pMetrics, TALKER_METRIC_BYTES, bytes);
+	pTalkerData->pubWakes = pTalkerData->cntWakes;
+	pTalkerData->pubFrames = pTalkerData->cntFrames;
+
+	if (pTalkerData->avtpHandle) {
+		void *rawsock = ((avtp_stream_t*)pTalkerData->avtpHandle)->rawsock;
+		openavbMetricsSet(pMetrics, TALKER_METRIC_TX_BUFFER_LEVEL, openavbAvtpTxBufferLevel(pTalkerData->avtpHandle));
+		if (rawsock) {
+			openavbMetricsSet(pMetrics, TALKER_METRIC_TX_OUT_OF_BUFFERS, openavbRawsockGetTXOutOfBuffers(rawsock));
+		}
+	}
 
+	openavbTLMetricsPublish(pTLState);
+}
 
 bool talkerStartStream(tl_state_t *pTLState)
 {
@@ -123,6 +168,9 @@ bool talkerStartStream(tl_state_t *pTLState)
 	// counts of intervals and frames between reports
 	pTalkerData->cntFrames = 0;
 	pTalkerData->cntWakes = 0;
+	pTalkerData->pubFrames = 0;
+	pTalkerData->pubWakes = 0;
+	pTalkerData->reportBytes = 0;
 
 	// setup the initial times
 	U64 nowNS;
@@ -146,6 +194,8 @@ bool talkerStartStream(tl_state_t *pTLState)
 
 	// we're good to go!
 	pTLState->bStreaming = TRUE;
+	openavbTLMarkStartup(&pTLState->streamingNS);
+	openavbMetricsSet(pTLState->pMetrics, TL_METRIC_STREAMING, 1);
 
 	AVB_TRACE_EXIT(AVB_TRACE_TL);
 	return TRUE;
@@ -173,10 +223,8 @@ void talkerStopStream(tl_state_t *pTLState)
 		rawsock = ((avtp_stream_t*)pTalkerData->avtpHandle)->rawsock;
 	}
 
-	openavbTalkerAddStat(pTLState, TL_STAT_TX_CALLS, pTalkerData->cntWakes);
-	openavbTalkerAddStat(pTLState, TL_STAT_TX_FRAMES, pTalkerData->cntFrames);
+	talkerPublishStats(pTalkerData, pTLState);
 //	openavbTalkerAddStat(pTLState, TL_STAT_TX_LATE, 0);		// Can't calculate at this time
-	openavbTalkerAddStat(pTLState, TL_STAT_TX_BYTES, openavbAvtpBytes(pTalkerData->avtpHandle));
 
 	AVB_LOGF_INFO("TX "STREAMID_FORMAT", Totals: calls=%" PRIu64 ", frames=%" PRIu64 ", late=%" PRIu64 ", bytes=%" PRIu64 ", TXOutOfBuffs=%ld",
 		STREAMID_ARGS(&pTalkerData->streamID),
@@ -191,14 +239,17 @@ void talkerStopStream(tl_state_t *pTLState)
 		openavbAvtpShutdownTalker(pTalkerData->avtpHandle);
 		pTLState->bStreaming = FALSE;
 	}
+	openavbMetricsSet(pTLState->pMetrics, TL_METRIC_STREAMING, 0);
 
 	AVB_TRACE_EXIT(AVB_TRACE_TL);
 }
 
 static inline void talkerShowStats(talker_data_t *pTalkerData, tl_state_t *pTLState)
 {
+	talkerPublishStats(pTalkerData, pTLState);
+
 	S32 late = pTalkerData->wakesPerReport - pTalkerData->cntWakes;
-	U64 bytes = openavbAvtpBytes(pTalkerData->avtpHandle);
+	U64 bytes = pTalkerData->reportBytes;
 	if (late < 0) late = 0;
 	U32 txbuf = openavbAvtpTxBufferLevel(pTalkerData->avtpHandle);
 	U32 mqbuf = openavbMediaQCountItems(pTLState->pMediaQ, TRUE);
@@ -212,7 +263,7 @@ static inline void talkerShowStats(talker_data_t *pTalkerData, tl_state_t *pTLSt
 	AVB_LOGRT_INFO(FALSE, LOG_RT_ITEM, LOG_RT_END, "mqbuf=%d, ", LOG_RT_DATATYPE_U32, &mqbuf);
 
 	openavbTalkerAddStat(pTLState, TL_STAT_TX_LATE, late);
-	openavbTalkerAddStat(pTLState, TL_STAT_TX_BYTES, bytes);
+	pTalkerData->reportBytes = 0;
 }
 
 static inline bool talkerDoStream(tl_state_t *pTLState)
@@ -234,7 +285,9 @@ static inline bool talkerDoStream(tl_state_t *pTLState)
 
 		if (!pCfg->tx_blocking_in_intf) {
 
-			if (!pCfg->spin_wait) {
+			if (pTLState->pPool) {
+				// The pool worker only steps us once the interval is due
+			} else if (!pCfg->spin_wait) {
 				// sleep until the next interval
 				SLEEP_UNTIL_NSEC(pTalkerData->nextCycleNS);
 			} else {
@@ -260,6 +313,10 @@ static inline bool talkerDoStream(tl_state_t *pTLState)
 				pTalkerData->cntFrames++;
 		}
 
+		if (!pTLState->firstFrameNS && pTalkerData->cntFrames) {
+			openavbTLMarkStartup(&pTLState->firstFrameNS);
+		}
+
 		if (!pCfg->spin_wait) {
 			CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &nowNS);
 		} else {
@@ -277,12 +334,11 @@ static inline bool talkerDoStream(tl_state_t *pTLState)
 		if (pCfg->report_seconds > 0) {
 			if (nowNS > pTalkerData->nextReportNS) {
 				talkerShowStats(pTalkerData, pTLState);
-			  
-				openavbTalkerAddStat(pTLState, TL_STAT_TX_CALLS, pTalkerData->cntWakes);
-				openavbTalkerAddStat(pTLState, TL_STAT_TX_FRAMES, pTalkerData->cntFrames);
 
 				pTalkerData->cntFrames = 0;
 				pTalkerData->cntWakes = 0;
+				pTalkerData->pubFrames = 0;
+				pTalkerData->pubWakes = 0;
 				pTalkerData->nextReportNS = nowNS + (pCfg->report_seconds * NANOSECONDS_PER_SECOND);
 			}
 		} else if (pCfg->report_frames > 0 && pTalkerData->cntFrames != pTalkerData->lastReportFrames) {
@@ -297,6 +353,10 @@ static inline bool talkerDoStream(tl_state_t *pTLState)
 			bRet = TRUE;
 		}
 
+		if (bRet) {
+			talkerPublishStats(pTalkerData, pTLState);
+		}
+
 		if (!pCfg->tx_blocking_in_intf) {
 			pTalkerData->nextCycleNS += pTalkerData->intervalNS;
 
@@ -309,7 +369,9 @@ static inline bool talkerDoStream(tl_state_t *pTLState)
 		}
 	}
 	else {
-		SLEEP_MSEC(10);
+		if (!pTLState->pPool) {
+			SLEEP_MSEC(TALKER_IDLE_MSEC);
+		}
 
 		// time to service the endpoint IPC
 		bRet = TRUE;
@@ -320,84 +382,111 @@ static inline bool talkerDoStream(tl_state_t *pTLState)
 }
 
 
-// Called from openavbTLThreadFn() which is started from openavbTLRun() 
-void openavbTLRunTalker(tl_state_t *pTLState)
+// Set up the talker once connected to the endpoint. Returns FALSE, with everything released, on failure.
+bool openavbTLRunTalkerBegin(tl_state_t *pTLState)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_TL);
 
 	if (!pTLState) {
 		AVB_LOG_ERROR("Invalid TLState");
 		AVB_TRACE_EXIT(AVB_TRACE_TL);
-		return;
+		return FALSE;
 	}
 
 	pTLState->pPvtTalkerData = calloc(1, sizeof(talker_data_t));
 	if (!pTLState->pPvtTalkerData) {
 		AVB_LOG_WARNING("Failed to allocate talker data.");
-		return;
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
 	}
 
-	// Create Stats Mutex
-	{
-		MUTEX_ATTR_HANDLE(mta);
-		MUTEX_ATTR_INIT(mta);
-		MUTEX_ATTR_SET_TYPE(mta, MUTEX_ATTR_TYPE_DEFAULT);
-		MUTEX_ATTR_SET_NAME(mta, "TLStatsMutex");
-		MUTEX_CREATE_ERR();
-		MUTEX_CREATE(pTLState->statsMutex, mta);
-		MUTEX_LOG_ERR("Could not create/initialize 'TLStatsMutex' mutex");
-	}
+	openavbTLMetricsOpen(pTLState, "talker", talkerMetricDefs, TALKER_METRIC_COUNT);
 
 	/* If using endpoint register talker,
 	   else register with tpsec */
 	pTLState->bConnected = openavbTLRunTalkerInit(pTLState); 
 
 	if (pTLState->bConnected) {
-		bool bServiceIPC;
+		openavbTLMarkStartup(&pTLState->connectedNS);
+
+		// Replies to the registration are flagged as they arrive
+		openavbEptClntNotify(pTLState->endpointHandle, &pTLState->bEndpointPending);
 
 		// Notify AVDECC Msg of the state change.
 		openavbAvdeccMsgClntNotifyCurrentState(pTLState);
+	}
+	else {
+		AVB_LOGF_WARNING("Failed to connect to endpoint"STREAMID_FORMAT, STREAMID_ARGS(&(((talker_data_t *)pTLState->pPvtTalkerData)->streamID)));
 
-		// Do until we are stopped or lose connection to endpoint
-		while (pTLState->bRunning && pTLState->bConnected) {
-
-			// Talk (or just sleep if not streaming.)
-			bServiceIPC = talkerDoStream(pTLState);
-
-			// TalkerDoStream() returns TRUE occasionally,
-			// so that we can service our IPC at that low rate.
-			if (bServiceIPC) {
-				// Look for messages from endpoint.  Don't block (timeout=0)
-				if (!openavbEptClntService(pTLState->endpointHandle, 0)) {
-					AVB_LOGF_WARNING("Lost connection to endpoint, will retry "STREAMID_FORMAT, STREAMID_ARGS(&(((talker_data_t *)pTLState->pPvtTalkerData)->streamID)));
-					pTLState->bConnected = FALSE;
-					pTLState->endpointHandle = 0;
-				}
-			}
-		}
+		openavbTLMetricsClose(pTLState);
 
-		// Stop streaming
-		talkerStopStream(pTLState);
+		free(pTLState->pPvtTalkerData);
+		pTLState->pPvtTalkerData = NULL;
+	}
 
-		{
-			MUTEX_CREATE_ERR();
-			MUTEX_DESTROY(pTLState->statsMutex); // Destroy Stats Mutex
-			MUTEX_LOG_ERR("Error destroying mutex");
-		}
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return pTLState->bConnected;
+}
 
-		// withdraw our talker registration
-		if (pTLState->bConnected)
-			openavbEptClntStopStream(pTLState->endpointHandle, &(((talker_data_t *)pTLState->pPvtTalkerData)->streamID));
+// One pass of the talker loop. When run by a pool worker pNextNS is set to when the next pass is due.
+void openavbTLRunTalkerStep(tl_state_t *pTLState, U64 *pNextNS)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
 
-		openavbTLRunTalkerFinish(pTLState);
+	talker_data_t *pTalkerData = pTLState->pPvtTalkerData;
 
-		// Notify AVDECC Msg of the state change.
-		openavbAvdeccMsgClntNotifyCurrentState(pTLState);
+	// Talk (or just sleep if not streaming.)
+	bool bServiceIPC = talkerDoStream(pTLState);
+
+	// TalkerDoStream() returns TRUE occasionally,
+	// so that we can service our IPC and look at the endpoint status table at that low rate.
+	// In between, messages the endpoint sends are flagged as they arrive.
+	if (bServiceIPC || pTLState->bEndpointPending) {
+		pTLState->bEndpointPending = FALSE;
+		// Look for messages from endpoint.  Don't block (timeout=0)
+		if (!openavbEptClntService(pTLState->endpointHandle, 0)) {
+			AVB_LOGF_WARNING("Lost connection to endpoint, will retry "STREAMID_FORMAT, STREAMID_ARGS(&pTalkerData->streamID));
+			pTLState->bConnected = FALSE;
+			pTLState->endpointHandle = 0;
+		}
+		else {
+			openavbTLRunTalkerStatus(pTLState);
+			openavbEptClntNotify(pTLState->endpointHandle, &pTLState->bEndpointPending);
+		}
 	}
-	else {
-		AVB_LOGF_WARNING("Failed to connect to endpoint"STREAMID_FORMAT, STREAMID_ARGS(&(((talker_data_t *)pTLState->pPvtTalkerData)->streamID)));
+
+	if (pNextNS) {
+		if (pTLState->bStreaming) {
+			*pNextNS = pTalkerData->nextCycleNS;
+		}
+		else {
+			CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, pNextNS);
+			*pNextNS += TALKER_IDLE_MSEC * NANOSECONDS_PER_MSEC;
+		}
 	}
 
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+}
+
+// Tear down what openavbTLRunTalkerBegin() set up.
+void openavbTLRunTalkerEnd(tl_state_t *pTLState)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	// Stop streaming
+	talkerStopStream(pTLState);
+
+	// withdraw our talker registration
+	if (pTLState->bConnected)
+		openavbEptClntStopStream(pTLState->endpointHandle, &(((talker_data_t *)pTLState->pPvtTalkerData)->streamID));
+
+	openavbTLRunTalkerFinish(pTLState);
+
+	// Notify AVDECC Msg of the state change.
+	openavbAvdeccMsgClntNotifyCurrentState(pTLState);
+
+	openavbTLMetricsClose(pTLState);
+
 	if (pTLState->pPvtTalkerData) {
 		free(pTLState->pPvtTalkerData);
 		pTLState->pPvtTalkerData = NULL;
@@ -406,6 +495,23 @@ void openavbTLRunTalker(tl_state_t *pTLState)
 	AVB_TRACE_EXIT(AVB_TRACE_TL);
 }
 
+// Called from openavbTLThreadFn() which is started from openavbTLRun() 
+void openavbTLRunTalker(tl_state_t *pTLState)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	if (openavbTLRunTalkerBegin(pTLState)) {
+		// Do until we are stopped or lose connection to endpoint
+		while (pTLState->bRunning && pTLState->bConnected) {
+			openavbTLRunTalkerStep(pTLState, NULL);
+		}
+
+		openavbTLRunTalkerEnd(pTLState);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+}
+
 void openavbTLPauseTalker(tl_state_t *pTLState, bool bPause)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_TL);
@@ -449,9 +555,10 @@ void openavbTalkerClearStats(tl_state_t *pTLState)
 		return;
 	}
 
-	LOCK_STATS();
-	memset(&pTalkerData->stats, 0, sizeof(pTalkerData->stats));
-	UNLOCK_STATS();
+	U32 i1;
+	for (i1 = 0; i1 < TALKER_METRIC_COUNT; i1++) {
+		openavbMetricsSet(pTLState->pMetrics, i1, 0);
+	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_TL);
 }
@@ -473,27 +580,26 @@ void openavbTalkerAddStat(tl_state_t *pTLState, tl_stat_t stat, U64 val)
 		return;
 	}
 
-	LOCK_STATS();
 	switch (stat) {
 		case TL_STAT_TX_CALLS:
-			pTalkerData->stats.totalCalls += val;
+			openavbMetricsAdd(pTLState->pMetrics, TALKER_METRIC_CALLS, val);
 			break;
 		case TL_STAT_TX_FRAMES:
-			pTalkerData->stats.totalFrames += val;
+			openavbMetricsAdd(pTLState->pMetrics, TALKER_METRIC_FRAMES, val);
 			break;
 		case TL_STAT_TX_LATE:
-			pTalkerData->stats.totalLate += val;
+			openavbMetricsAdd(pTLState->pMetrics, TALKER_METRIC_LATE, val);
 			break;
 		case TL_STAT_TX_BYTES:
-			pTalkerData->stats.totalBytes += val;
+			openavbMetricsAdd(pTLState->pMetrics, TALKER_METRIC_BYTES, val);
 			break;
 		case TL_STAT_RX_CALLS:
 		case TL_STAT_RX_FRAMES:
 		case TL_STAT_RX_LOST:
 		case TL_STAT_RX_BYTES:
+		case TL_STAT_INTF_XRUNS:
 			break;
 	}
-	UNLOCK_STATS();
 
 	AVB_TRACE_EXIT(AVB_TRACE_TL);
 }
@@ -516,27 +622,26 @@ U64 openavbTalkerGetStat(tl_state_t *pTLState, tl_stat_t stat)
 		return 0;
 	}
 
-	LOCK_STATS();
 	switch (stat) {
 		case TL_STAT_TX_CALLS:
-			val = pTalkerData->stats.totalCalls;
+			val = openavbMetricsGet(pTLState->pMetrics, TALKER_METRIC_CALLS);
 			break;
 		case TL_STAT_TX_FRAMES:
-			val = pTalkerData->stats.totalFrames;
+			val = openavbMetricsGet(pTLState->pMetrics, TALKER_METRIC_FRAMES);
 			break;
 		case TL_STAT_TX_LATE:
-			val = pTalkerData->stats.totalLate;
+			val = openavbMetricsGet(pTLState->pMetrics, TALKER_METRIC_LATE);
 			break;
 		case TL_STAT_TX_BYTES:
-			val = pTalkerData->stats.totalBytes;
+			val = openavbMetricsGet(pTLState->pMetrics, TALKER_METRIC_BYTES);
 			break;
 		case TL_STAT_RX_CALLS:
 		case TL_STAT_RX_FRAMES:
 		case TL_STAT_RX_LOST:
 		case TL_STAT_RX_BYTES:
+		case TL_STAT_INTF_XRUNS:
 			break;
 	}
-	UNLOCK_STATS();
 
 	AVB_TRACE_EXIT(AVB_TRACE_TL);
 	return val;
@@ -49,6 +49,8 @@ typedef struct {
 	U32				fwmark;
 	U16				vlanID;
 	U8				vlanPCP;
+	// Changes of our slot in the endpoint status table already acted on
+	U32				statusUpdates;
 
 	// State info for streaming
 	void			*avtpHandle;
@@ -63,11 +65,16 @@ typedef struct {
 	U64 			nextReportNS;
 	U64				nextSecondNS;
 	unsigned long	lastReportFrames;
-	talker_stats_t	stats;
+	unsigned long	pubWakes;		// Part of cntWakes already added to the metrics
+	unsigned long	pubFrames;		// Part of cntFrames already added to the metrics
+	U64				reportBytes;	// Bytes since the last report
 } talker_data_t;
 
 
 void openavbTLRunTalker(tl_state_t *pTLState);
+bool openavbTLRunTalkerBegin(tl_state_t *pTLState);
+void openavbTLRunTalkerStep(tl_state_t *pTLState, U64 *pNextNS);
+void openavbTLRunTalkerEnd(tl_state_t *pTLState);
 void openavbTLPauseTalker(tl_state_t *pTLState, bool bPause);
 void openavbTalkerClearStats(tl_state_t *pTLState);
 void openavbTalkerAddStat(tl_state_t *pTLState, tl_stat_t stat, U64 val);
@@ -76,5 +83,7 @@ bool talkerStartStream(tl_state_t *pTLState);
 void talkerStopStream(tl_state_t *pTLState);
 bool openavbTLRunTalkerInit(tl_state_t *pTLState);
 void openavbTLRunTalkerFinish(tl_state_t *pTLState);
+// Act on changes the endpoint made to our stream in its status table
+void openavbTLRunTalkerStatus(tl_state_t *pTLState);
 
 #endif  // OPENAVB_TL_TALKER_H
@@ -39,6 +39,8 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_trace.h"
 #include "openavb_tl.h"
 #include "openavb_endpoint.h"
+#include "openavb_endpoint_status.h"
+#include "openavb_qmgr.h"
 #include "openavb_avtp.h"
 #include "openavb_talker.h"
 #include "openavb_time.h"
@@ -50,36 +52,23 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #define	AVB_LOG_COMPONENT	"Talker"
 #include "openavb_log.h"
 
-/* Talker callback comes from endpoint, to indicate when listeners
- * come and go. We may need to start or stop the talker thread.
+/* The endpoint tells us when listeners come and go, either with a
+ * callback or through the stream status table. We may need to start
+ * or stop the talker thread.
  */
-void openavbEptClntNotifyTlkrOfSrpCb(int                      endpointHandle,
-                                 AVBStreamID_t           *streamID,
-                                 char                    *ifname,
-                                 U8                       destAddr[],
-                                 openavbSrpLsnrDeclSubtype_t  lsnrDecl,
-                                 U8                       srClass,
-                                 U32                      classRate,
-                                 U16                      vlanID,
-                                 U8                       priority,
-                                 U16                      fwmark)
+static void x_talkerSrpUpdate(tl_state_t                  *pTLState,
+                              AVBStreamID_t               *streamID,
+                              char                        *ifname,
+                              U8                           destAddr[],
+                              openavbSrpLsnrDeclSubtype_t  lsnrDecl,
+                              U8                           srClass,
+                              U32                          classRate,
+                              U16                          vlanID,
+                              U8                           priority,
+                              U16                          fwmark)
 {
-	AVB_TRACE_ENTRY(AVB_TRACE_TL);
-
-	tl_state_t *pTLState = TLHandleListGet(endpointHandle);
 	talker_data_t *pTalkerData = pTLState->pPvtTalkerData;
 
-	if (!pTLState) {
-		AVB_LOG_WARNING("Unable to get talker from endpoint handle.");
-		return;
-	}
-
-	// If not a talker, ignore this callback.
-	if (pTLState->cfg.role != AVB_ROLE_TALKER) {
-		AVB_LOG_DEBUG("Ignoring Talker callback");
-		return;
-	}
-
 	AVB_LOGF_DEBUG("%s streaming=%d, lsnrDecl=%d", __FUNCTION__, pTLState->bStreaming, lsnrDecl);
 
 	openavb_tl_cfg_t *pCfg = &pTLState->cfg;
@@ -130,8 +119,43 @@ void openavbEptClntNotifyTlkrOfSrpCb(int                      endpointHandle,
 			talkerStopStream(pTLState);
 		}
 	}
+}
+
+/* Talker callback comes from endpoint for a stream without a slot
+ * in the status table.
+ */
+void openavbEptClntNotifyTlkrOfSrpCb(int                      endpointHandle,
+                                 AVBStreamID_t           *streamID,
+                                 char                    *ifname,
+                                 U8                       destAddr[],
+                                 openavbSrpLsnrDeclSubtype_t  lsnrDecl,
+                                 U8                       srClass,
+                                 U32                      classRate,
+                                 U16                      vlanID,
+                                 U8                       priority,
+                                 U16                      fwmark)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	tl_state_t *pTLState = TLHandleListGet(endpointHandle);
+
+	if (!pTLState) {
+		AVB_LOG_WARNING("Unable to get talker from endpoint handle.");
+		return;
+	}
+
+	// If not a talker, ignore this callback.
+	if (pTLState->cfg.role != AVB_ROLE_TALKER) {
+		AVB_LOG_DEBUG("Ignoring Talker callback");
+		return;
+	}
+
+	talker_data_t *pTalkerData = pTLState->pPvtTalkerData;
+
+	x_talkerSrpUpdate(pTLState, streamID, ifname, destAddr, lsnrDecl, srClass, classRate, vlanID, priority, fwmark);
 
 	// Let the AVDECC Msg server know our current stream ID, in case it was updated by MAAP.
+	// (AVDECC reads it from the status table itself for streams that have a slot.)
 	if (pTLState->avdeccMsgHandle != AVB_AVDECC_MSG_HANDLE_INVALID) {
 		if (!openavbAvdeccMsgClntTalkerStreamID(pTLState->avdeccMsgHandle,
 				pTalkerData->srClass, pTalkerData->streamID.addr, pTalkerData->streamID.uniqueID,
@@ -197,3 +221,48 @@ bool openavbTLRunTalkerInit(tl_state_t *pTLState)
 void openavbTLRunTalkerFinish(tl_state_t *pTLState)
 {
 }
+
+void openavbTLRunTalkerStatus(tl_state_t *pTLState)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	openavb_tl_cfg_t *pCfg = &pTLState->cfg;
+	talker_data_t *pTalkerData = pTLState->pPvtTalkerData;
+	openavb_endpoint_status_t status;
+	char ifname[IFNAMSIZ + 10];
+
+	AVBStreamID_t streamID;
+	memset(&streamID, 0, sizeof(AVBStreamID_t));
+	if (pCfg->stream_addr.mac)
+		memcpy(streamID.addr, pCfg->stream_addr.mac, ETH_ALEN);
+	streamID.uniqueID = pCfg->stream_uid;
+
+	if (!openavbEptStatusFind(&streamID, &status)
+		|| status.updates == pTalkerData->statusUpdates
+		|| !openavbEptStatusIfname(ifname, sizeof(ifname))) {
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return;
+	}
+	pTalkerData->statusUpdates = status.updates;
+
+	// The slot keeps the last listener declaration. Until somebody is listening
+	// it only describes the stream, as the Stream_Info callback does.
+	openavbSrpLsnrDeclSubtype_t lsnrDecl = openavbSrp_LDSt_Stream_Info;
+	if ((status.lsnrDecl == openavbSrp_LDSt_Ready || status.lsnrDecl == openavbSrp_LDSt_Ready_Failed)
+		&& status.fwmark != INVALID_FWMARK) {
+		lsnrDecl = (openavbSrpLsnrDeclSubtype_t)status.lsnrDecl;
+	}
+
+	// Listeners may have gone and come back between two looks, as on a MAAP restart.
+	// Stop first if the stream moved, so it starts again with the new address and queue.
+	if (pTLState->bStreaming
+		&& (memcmp(status.destAddr, pTalkerData->destAddr, ETH_ALEN) != 0 || status.fwmark != pTalkerData->fwmark)) {
+		x_talkerSrpUpdate(pTLState, &status.streamID, ifname, status.destAddr, openavbSrp_LDSt_Stream_Info,
+			status.srClass, status.classRate, status.vlanID, status.priority, status.fwmark);
+	}
+
+	x_talkerSrpUpdate(pTLState, &status.streamID, ifname, status.destAddr, lsnrDecl,
+		status.srClass, status.classRate, status.vlanID, status.priority, status.fwmark);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+}
@@ -147,6 +147,10 @@ void openavbTLRunTalkerFinish(tl_state_t *pTLState)
 	openavbQmgrRemoveStream(pTalkerData->fwmark);
 }
 
+void openavbTLRunTalkerStatus(tl_state_t *pTLState)
+{
+}
+
 void openavbEptClntNotifyTlkrOfSrpCb(
 int                      endpointHandle,
 AVBStreamID_t           *streamID,
@@ -305,6 +305,8 @@ EXTERN_DLL_EXPORT bool openavbTLInitialize(U32 maxTL)
 EXTERN_DLL_EXPORT bool openavbTLCleanup()
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+	openavbEptClntNotifyStop();
+
 	if (gTLHandleList) {
 		free(gTLHandleList);
 		gTLHandleList = NULL;
@@ -489,9 +491,15 @@ EXTERN_DLL_EXPORT bool openavbTLConfigure(tl_handle_t handle, openavb_tl_cfg_t *
 	pTLState->cfg.map_cb.map_gen_init_cb(pTLState->pMediaQ);
 	pTLState->cfg.intf_cb.intf_gen_init_cb(pTLState->pMediaQ);
 
-	// Initialize the AVDECC support for this Talker/Listener.
-	pTLState->bAvdeccMsgRunning = TRUE;
-	THREAD_CREATE_AVDECC_MSG();
+	if (pTLState->pPool && !openavbTLPoolAccepts(pTLState)) {
+		pTLState->pPool = NULL;
+	}
+
+	// Initialize the AVDECC support for this Talker/Listener. Pooled ones go without to keep the thread count bounded.
+	if (!pTLState->pPool) {
+		pTLState->bAvdeccMsgRunning = TRUE;
+		THREAD_CREATE_AVDECC_MSG();
+	}
 
 	return TRUE;
 }
@@ -510,9 +518,25 @@ EXTERN_DLL_EXPORT bool openavbTLRun(tl_handle_t handle)
 			break;
 		}
 
+		if (pTLState->bStopPending) {
+			// Wait for the previous run to finish stopping
+			openavbTLStop(handle);
+		}
+
+		pTLState->connectedNS = 0;
+		pTLState->streamingNS = 0;
+		pTLState->firstFrameNS = 0;
+		CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &pTLState->runNS);
+
 		pTLState->bRunning = TRUE;
 		pTLState->bPaused = FALSE;
-		if (pTLState->cfg.role == AVB_ROLE_TALKER) {
+		if (pTLState->pPool) {
+			if (!openavbTLPoolStart(pTLState)) {
+				pTLState->bRunning = FALSE;
+				break;
+			}
+		}
+		else if (pTLState->cfg.role == AVB_ROLE_TALKER) {
 			THREAD_CREATE_TALKER();
 
 			if (pTLState->cfg.thread_rt_priority != 0) { THREAD_SET_RT_PRIORITY(pTLState->TLThread, pTLState->cfg.thread_rt_priority); }
@@ -535,6 +559,42 @@ EXTERN_DLL_EXPORT bool openavbTLRun(tl_handle_t handle)
 	return retVal;
 }
 
+// Ask a talker or listener to stop without waiting for it.
+static void x_TLStopRequest(tl_state_t *pTLState)
+{
+	pTLState->bPaused = FALSE;
+	if (pTLState->bRunning) {
+		// don't set bStreaming to false here, that's needed to track
+		// that the streaming thread is running, so we can shut it down.
+		//pTLState->bStreaming = FALSE;
+		pTLState->bRunning = FALSE;
+		pTLState->bStopPending = TRUE;
+	}
+}
+
+// Wait for a talker or listener asked to stop by x_TLStopRequest().
+static void x_TLStopWait(tl_state_t *pTLState)
+{
+	if (pTLState->bStopPending) {
+		if (pTLState->pPool) {
+			openavbTLPoolStop(pTLState);
+		}
+		else {
+			THREAD_JOIN(pTLState->TLThread, NULL);
+		}
+		pTLState->bStopPending = FALSE;
+	}
+}
+
+// Ask the AVDECC Msg thread to finish without waiting for it.
+static void x_TLAvdeccMsgStopRequest(tl_state_t *pTLState)
+{
+	if (pTLState->bAvdeccMsgRunning) {
+		pTLState->bAvdeccMsgRunning = FALSE;
+		pTLState->bAvdeccMsgStopPending = TRUE;
+	}
+}
+
 extern DLL_EXPORT bool openavbTLStop(tl_handle_t handle)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_TL);
@@ -547,14 +607,34 @@ extern DLL_EXPORT bool openavbTLStop(tl_handle_t handle)
 		return FALSE;
 	}
 
-	pTLState->bPaused = FALSE;
-	if (pTLState->bRunning) {
-		// don't set bStreaming to false here, that's needed to track
-		// that the streaming thread is running, so we can shut it down.
-		//pTLState->bStreaming = FALSE;
-		pTLState->bRunning = FALSE;
+	x_TLStopRequest(pTLState);
+	x_TLStopWait(pTLState);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return TRUE;
+}
+
+EXTERN_DLL_EXPORT bool openavbTLStopAll(tl_handle_t *pHandles, U32 count)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
 
-		THREAD_JOIN(pTLState->TLThread, NULL);
+	if (!pHandles) {
+		AVB_LOG_ERROR("Invalid handle list.");
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	// Let every talker and listener wind down at once, then wait for them.
+	U32 i1;
+	for (i1 = 0; i1 < count; i1++) {
+		if (pHandles[i1]) {
+			x_TLStopRequest((tl_state_t *)pHandles[i1]);
+		}
+	}
+	for (i1 = 0; i1 < count; i1++) {
+		if (pHandles[i1]) {
+			x_TLStopWait((tl_state_t *)pHandles[i1]);
+		}
 	}
 
 	AVB_TRACE_EXIT(AVB_TRACE_TL);
@@ -573,15 +653,15 @@ EXTERN_DLL_EXPORT bool openavbTLClose(tl_handle_t handle)
 		return FALSE;
 	}
 
-	if (pTLState->bRunning == TRUE) {
-		// In case openavbTLStop wasn't called stop is now.
-		openavbTLStop(handle);
-	}
+	// In case openavbTLStop wasn't called stop is now.
+	x_TLStopRequest(pTLState);
+	x_TLStopWait(pTLState);
 
 	// Done with the AVDECC support.
-	if (pTLState->bAvdeccMsgRunning) {
-		pTLState->bAvdeccMsgRunning = FALSE;
+	x_TLAvdeccMsgStopRequest(pTLState);
+	if (pTLState->bAvdeccMsgStopPending) {
 		THREAD_JOIN(pTLState->avdeccMsgThread, NULL);
+		pTLState->bAvdeccMsgStopPending = FALSE;
 	}
 
 	pTLState->cfg.intf_cb.intf_gen_end_cb(pTLState->pMediaQ);
@@ -605,6 +685,40 @@ EXTERN_DLL_EXPORT bool openavbTLClose(tl_handle_t handle)
 	return TRUE;
 }
 
+EXTERN_DLL_EXPORT bool openavbTLCloseAll(tl_handle_t *pHandles, U32 count)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	if (!pHandles) {
+		AVB_LOG_ERROR("Invalid handle list.");
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	// The stream and AVDECC Msg threads each take up to a poll period to notice they should stop.
+	// Tell all of them first so those periods overlap rather than add up.
+	U32 i1;
+	for (i1 = 0; i1 < count; i1++) {
+		if (pHandles[i1]) {
+			x_TLStopRequest((tl_state_t *)pHandles[i1]);
+			x_TLAvdeccMsgStopRequest((tl_state_t *)pHandles[i1]);
+		}
+	}
+
+	bool bRet = TRUE;
+	for (i1 = 0; i1 < count; i1++) {
+		if (pHandles[i1]) {
+			if (!openavbTLClose(pHandles[i1])) {
+				bRet = FALSE;
+			}
+			pHandles[i1] = NULL;
+		}
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return bRet;
+}
+
 EXTERN_DLL_EXPORT void* openavbTLGetIntfHostCBList(tl_handle_t handle)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_TL);
@@ -730,7 +844,13 @@ EXTERN_DLL_EXPORT U64 openavbTLStat(tl_handle_t handle, tl_stat_t stat)
 		return 0;
 	}
 
-	if (pTLState->cfg.role == AVB_ROLE_TALKER) {
+	if (stat == TL_STAT_INTF_XRUNS) {
+		// Kept by the interface module rather than the talker or listener.
+		if (pTLState->cfg.intf_cb.intf_get_xruns_cb && pTLState->pMediaQ) {
+			val = pTLState->cfg.intf_cb.intf_get_xruns_cb(pTLState->pMediaQ);
+		}
+	}
+	else if (pTLState->cfg.role == AVB_ROLE_TALKER) {
 		val = openavbTalkerGetStat(pTLState, stat);
 	}
 	else if (pTLState->cfg.role == AVB_ROLE_LISTENER) {
@@ -741,6 +861,114 @@ EXTERN_DLL_EXPORT U64 openavbTLStat(tl_handle_t handle, tl_stat_t stat)
 	return val;
 }
 
+EXTERN_DLL_EXPORT bool openavbTLGetStartupTimes(tl_handle_t handle, openavb_tl_startup_times_t *pTimes)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	tl_state_t *pTLState = (tl_state_t *)handle;
+
+	if (!pTLState || !pTimes) {
+		AVB_LOG_ERROR("Invalid argument.");
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	U64 runNS = pTLState->runNS;
+	U64 connectedNS = pTLState->connectedNS;
+	U64 streamingNS = pTLState->streamingNS;
+	U64 firstFrameNS = pTLState->firstFrameNS;
+
+	pTimes->connectedNS = connectedNS > runNS ? connectedNS - runNS : 0;
+	pTimes->streamingNS = streamingNS > runNS ? streamingNS - runNS : 0;
+	pTimes->firstFrameNS = firstFrameNS > runNS ? firstFrameNS - runNS : 0;
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return runNS != 0;
+}
+
+EXTERN_DLL_EXPORT bool openavbTLGetIntfLatency(tl_handle_t handle, bool interval, openavb_intf_latency_t *pLatency)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+	bool retVal = FALSE;
+
+	tl_state_t *pTLState = (tl_state_t *)handle;
+
+	if (!pTLState || !pLatency) {
+		AVB_LOG_ERROR("Invalid handle");
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	if (pTLState->cfg.intf_cb.intf_get_latency_cb && pTLState->pMediaQ) {
+		retVal = pTLState->cfg.intf_cb.intf_get_latency_cb(pTLState->pMediaQ, interval, pLatency);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return retVal;
+}
+
+void openavbTLMetricsOpen(tl_state_t *pTLState, const char *pRole, const openavb_metric_def_t *pDefs, U32 count)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	openavb_tl_cfg_t *pCfg = &pTLState->cfg;
+	AVBStreamID_t streamID;
+	char stream[OPENAVB_METRICS_LABEL_LEN];
+
+	memset(&streamID, 0, sizeof(streamID));
+	if (pCfg->stream_addr.mac)
+		memcpy(streamID.addr, pCfg->stream_addr.mac, ETH_ALEN);
+	streamID.uniqueID = pCfg->stream_uid;
+	snprintf(stream, sizeof(stream), STREAMID_FORMAT, STREAMID_ARGS(&streamID));
+
+	pTLState->pMetrics = openavbMetricsGroupOpen(stream, pRole, pCfg->friendly_name, pDefs, count);
+	if (!pTLState->pMetrics) {
+		AVB_LOGF_WARNING("No metrics for "STREAMID_FORMAT, STREAMID_ARGS(&streamID));
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+}
+
+void openavbTLMetricsClose(tl_state_t *pTLState)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	openavb_metrics_group_t *pMetrics = pTLState->pMetrics;
+	pTLState->pMetrics = NULL;
+	openavbMetricsGroupClose(pMetrics);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+}
+
+void openavbTLMetricsPublish(tl_state_t *pTLState)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	openavb_tl_cfg_t *pCfg = &pTLState->cfg;
+	openavb_metrics_group_t *pMetrics = pTLState->pMetrics;
+
+	if (!pMetrics || !pTLState->pMediaQ) {
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return;
+	}
+
+	openavbMetricsSet(pMetrics, TL_METRIC_STREAMING, pTLState->bStreaming ? 1 : 0);
+	openavbMetricsSet(pMetrics, TL_METRIC_MEDIAQ_ITEMS, openavbMediaQCountItems(pTLState->pMediaQ, TRUE));
+
+	if (pCfg->intf_cb.intf_get_xruns_cb) {
+		openavbMetricsSet(pMetrics, TL_METRIC_INTF_XRUNS, pCfg->intf_cb.intf_get_xruns_cb(pTLState->pMediaQ));
+	}
+
+	openavb_intf_latency_t latency;
+	if (pCfg->intf_cb.intf_get_latency_cb && pCfg->intf_cb.intf_get_latency_cb(pTLState->pMediaQ, TRUE, &latency)) {
+		openavbMetricsSet(pMetrics, TL_METRIC_INTF_LATENCY_P50, latency.p50NS > 0 ? latency.p50NS : 0);
+		openavbMetricsSet(pMetrics, TL_METRIC_INTF_LATENCY_P99, latency.p99NS > 0 ? latency.p99NS : 0);
+		openavbMetricsSet(pMetrics, TL_METRIC_INTF_LATENCY_MAX, latency.maxNS > 0 ? latency.maxNS : 0);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+}
+
 EXTERN_DLL_EXPORT void openavbTLPauseStream(tl_handle_t handle, bool bPause)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_TL);
@@ -40,6 +40,7 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include "openavb_osal.h"
 #include "openavb_mediaq_pub.h"
 #include "openavb_tl_pub.h"
+#include "openavb_metrics.h"
 
 typedef enum OPENAVB_TL_AVB_VER_STATE 
 {
@@ -48,12 +49,35 @@ typedef enum OPENAVB_TL_AVB_VER_STATE
 	OPENAVB_TL_AVB_VER_VALID,
 } openavbTLAVBVerState_t;
 
-typedef struct {
-	U64 totalCalls;
-	U64 totalFrames;
-	U64 totalLate;
-	U64 totalBytes;
-} talker_stats_t;
+// Metrics kept for both talkers and listeners. The role specific metrics follow these.
+typedef enum {
+	TL_METRIC_STREAMING = 0,
+	TL_METRIC_MEDIAQ_ITEMS,
+	TL_METRIC_INTF_XRUNS,
+	TL_METRIC_INTF_LATENCY_P50,
+	TL_METRIC_INTF_LATENCY_P99,
+	TL_METRIC_INTF_LATENCY_MAX,
+	TL_METRIC_COMMON_COUNT
+} tl_metric_t;
+
+// Start of every talker and listener metric table, in tl_metric_t order.
+#define TL_METRIC_COMMON_DEFS																			\
+	{ "streaming", "1 while the stream is active", OPENAVB_METRIC_GAUGE },								\
+	{ "mediaq_items", "Items in the media queue", OPENAVB_METRIC_GAUGE },								\
+	{ "intf_xruns_total", "Interface overruns and underruns", OPENAVB_METRIC_COUNTER },					\
+	{ "intf_latency_p50_ns", "Interface latency median over the last interval", OPENAVB_METRIC_GAUGE },	\
+	{ "intf_latency_p99_ns", "Interface latency 99th percentile over the last interval", OPENAVB_METRIC_GAUGE }, \
+	{ "intf_latency_max_ns", "Interface latency maximum over the last interval", OPENAVB_METRIC_GAUGE }
+
+// Where a talker or listener run by a worker pool is in its life cycle. See openavbTLStep().
+typedef enum {
+	TL_STEP_CONNECT = 0,
+	TL_STEP_VERSION,
+	TL_STEP_BEGIN,
+	TL_STEP_STREAM,
+} tl_step_t;
+
+struct tl_pool;
 
 THREAD_TYPE(TLThread);
 THREAD_TYPE(avdeccMsgThread);
@@ -80,6 +104,9 @@ typedef struct {
 	// Handle to the endpoint. (Set once from a single thread no lock needed.)
 	int endpointHandle;
 
+	// Set by the endpoint notify thread when a message from the endpoint is waiting.
+	volatile bool bEndpointPending;
+
 	// Media queue struct.
 	media_q_t *pMediaQ;
 
@@ -92,17 +119,40 @@ typedef struct {
 	// Thread for talker or listener
 	THREAD_DEFINITON(TLThread);
 
+	// Stop was requested and the talker or listener still has to be waited for.
+	bool bStopPending;
+
 	// AVDECC Msg Running flag. (assumed atomic)
 	bool bAvdeccMsgRunning;
 
 	// Thread for AVDECC Msg support
 	THREAD_DEFINITON(avdeccMsgThread);
 
+	// AVDECC Msg was asked to stop and its thread still has to be joined.
+	bool bAvdeccMsgStopPending;
+
 	// Handle to the AVDECC Msg support.  (Value set by avdeccMsgThread)
 	int avdeccMsgHandle;
 
-	// Per stream Stats Mutex
-	MUTEX_HANDLE(statsMutex);
+	// Per stream metrics. Lock-free, updated by the TL thread.
+	openavb_metrics_group_t *pMetrics;
+
+	// Worker pool that runs this talker or listener instead of TLThread. (Set once before configure.)
+	struct tl_pool *pPool;
+
+	// Pooled life cycle state and when the worker should next step it. (Only used by the worker.)
+	tl_step_t step;
+	U64 stepNextNS;
+
+	// Set while a pool worker owns the talker or listener. Cleared by the worker once it has stopped.
+	volatile bool bPoolActive;
+
+	// When the stream was last run and when it reached each stage of starting since. 0 until reached.
+	// (OPENAVB_TIMER_CLOCK, written by the TL thread)
+	U64 runNS;
+	U64 connectedNS;
+	U64 streamingNS;
+	U64 firstFrameNS;
 
 	LINK_LIB(mapLib);
 
@@ -120,10 +170,44 @@ extern MUTEX_HANDLE(gTLStateMutex);
 #define TL_UNLOCK() { MUTEX_CREATE_ERR(); MUTEX_UNLOCK(gTLStateMutex); MUTEX_LOG_ERR("Mutex unlock failure"); }
 
 ////////////////
-// TL stats mutex
+// TL metrics
+////////////////
+// Open the metrics group of the stream. The table must start with TL_METRIC_COMMON_DEFS.
+void openavbTLMetricsOpen(tl_state_t *pTLState, const char *pRole, const openavb_metric_def_t *pDefs, U32 count);
+// Close the metrics group of the stream.
+void openavbTLMetricsClose(tl_state_t *pTLState);
+// Refresh the metrics shared by talkers and listeners. Called from the TL thread.
+void openavbTLMetricsPublish(tl_state_t *pTLState);
+
+////////////////
+// TL startup timing
+////////////////
+// Record the first time a stage of starting is reached.
+static inline void openavbTLMarkStartup(U64 *pMarkNS)
+{
+	if (!*pMarkNS) {
+		CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, pMarkNS);
+	}
+}
+
+////////////////
+// TL worker pool
 ////////////////
-#define LOCK_STATS()        { MUTEX_CREATE_ERR(); MUTEX_LOCK(pTLState->statsMutex); MUTEX_LOG_ERR("Mutex lock failure"); }
-#define UNLOCK_STATS()      { MUTEX_CREATE_ERR(); MUTEX_UNLOCK(pTLState->statsMutex); MUTEX_LOG_ERR("Mutex unlock failure"); }
+// Default period at which pooled listeners look for received frames
+#define TL_POOL_RX_POLL_USEC	125
+
+// Non-blocking counterpart of openavbTLThreadFn() used by the pool workers. Does what is due for the
+// talker or listener and sets *pNextNS (OPENAVB_TIMER_CLOCK) to when it next needs to be stepped.
+// Returns FALSE once it has been stopped and everything it held has been released.
+bool openavbTLStep(tl_state_t *pTLState, U64 nowNS, U64 *pNextNS);
+// Check that the configured talker or listener can share a worker.
+bool openavbTLPoolAccepts(tl_state_t *pTLState);
+// Hand a talker or listener to the least loaded worker of its pool.
+bool openavbTLPoolStart(tl_state_t *pTLState);
+// Wait for the worker to release a talker or listener whose bRunning has been cleared.
+void openavbTLPoolStop(tl_state_t *pTLState);
+// Period at which the listeners of a pool poll for frames.
+U64 openavbTLPoolRxPollNS(struct tl_pool *pPool);
 
 ////////////////
 // timespec support functions
@@ -154,10 +238,23 @@ bool TLHandleRemove(tl_handle_t handle);
 bool openavbTLThreadFnOsal(tl_state_t *pTLState);
 bool openavbTLOpenLinkLibsOsal(tl_state_t *pTLState);
 bool openavbTLCloseLinkLibsOsal(tl_state_t *pTLState);
+// Parse an ini file into pCfg and pNVCfg without checking it against this host. The names of the
+// mapping and interface functions are left in pTLState->mapLib and pTLState->intfLib.
+bool openavbTLParseIniFileOsal(tl_state_t *pTLState, const char *fileName, openavb_tl_cfg_t *pCfg, openavb_tl_cfg_name_value_t *pNVCfg);
+// Check a parsed configuration against this host: the interface must exist and talkers
+// without a stream_addr get the MAC address of their interface.
+bool openavbTLCheckCfgOsal(openavb_tl_cfg_t *pCfg);
+// Look up the mapping or interface initialize function of the given name. Returns NULL if not found.
+void *openavbTLFindInitFnOsal(const char *funcName);
 
 /* These were in openavb_endpoint.h, but was moved here
  * for implementations that do not have endpoint */
 bool openavbEptClntService(int h, int timeout);
 bool openavbEptClntStopStream(int h, AVBStreamID_t *streamID);
+// Set *pPending once the endpoint sends something on connection h. Call again after each
+// openavbEptClntService() to watch for the next message.
+bool openavbEptClntNotify(int h, volatile bool *pPending);
+// Stop watching endpoint connections. Called once all talkers and listeners are closed.
+void openavbEptClntNotifyStop(void);
 
 #endif  // OPENAVB_TL_H
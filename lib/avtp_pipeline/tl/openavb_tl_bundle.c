@@ -0,0 +1,787 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Binary configuration bundles for talkers and listeners
+*
+* A bundle holds the configuration of a set of streams, parsed from their ini files and
+* validated ahead of time, so a host starting many streams neither parses ini files nor
+* looks up the same mapping and interface functions over and over.
+*
+* All values are stored little endian. A bundle is a header followed by a body:
+*   header  magic "AVBTLCFG", U32 version, U32 stream count, U32 symbol count,
+*           U32 body size, U32 FNV-1a hash of the body
+*   body    the names of the mapping and interface initialize functions,
+*           then one record per stream referring to them by index
+* Strings are a U16 length followed by that many bytes, without terminator.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "openavb_platform.h"
+#include "openavb_trace.h"
+#include "openavb_tl.h"
+#include "openavb_hash.h"
+#include "openavb_mediaq.h"
+
+#define	AVB_LOG_COMPONENT	"Talker / Listener"
+#include "openavb_pub.h"
+#include "openavb_log.h"
+
+#define BUNDLE_MAGIC			"AVBTLCFG"
+#define BUNDLE_MAGIC_LEN		8
+// Bump whenever the layout of the stream records changes
+#define BUNDLE_VERSION			1
+#define BUNDLE_HEADER_SIZE		(BUNDLE_MAGIC_LEN + 5 * sizeof(U32))
+
+// Largest bundle that will be loaded
+#define BUNDLE_MAX_SIZE			(64 * 1024 * 1024)
+
+#define MATCH_LEFT(A, B, C)(strncasecmp((A), (B), (C)) == 0)
+
+typedef struct {
+	U8 *pData;
+	U32 size;
+	U32 pos;
+	// Set when a read ran past the end or a write could not grow the buffer
+	bool bError;
+} bundle_buf_t;
+
+typedef struct {
+	char **ppNames;
+	U32 count;
+} bundle_symbols_t;
+
+typedef struct {
+	U32 count;
+	openavb_tl_cfg_t *pCfgs;
+	// Name/value items of each stream, owned by the bundle
+	openavb_tl_cfg_name_value_t *pNVCfgs;
+} tl_bundle_t;
+
+// Key identifying a stream when looking for repeated stream IDs
+typedef struct {
+	U8 role;
+	U8 addr[ETH_ALEN];
+	U16 uid;
+	char ifname[IFNAMSIZ + 10];
+} bundle_stream_key_t;
+
+static U32 x_hash(const U8 *pData, U32 size)
+{
+	U32 hash = 2166136261u;
+	U32 i1;
+	for (i1 = 0; i1 < size; i1++) {
+		hash ^= pData[i1];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+////////////////
+// Encoding
+////////////////
+static void x_putBytes(bundle_buf_t *pBuf, const void *pSrc, U32 len)
+{
+	if (pBuf->bError) {
+		return;
+	}
+	if (pBuf->pos + len > pBuf->size) {
+		U32 size = pBuf->size ? pBuf->size : 4096;
+		while (pBuf->pos + len > size) {
+			size *= 2;
+		}
+		U8 *pData = realloc(pBuf->pData, size);
+		if (!pData) {
+			pBuf->bError = TRUE;
+			return;
+		}
+		pBuf->pData = pData;
+		pBuf->size = size;
+	}
+	memcpy(pBuf->pData + pBuf->pos, pSrc, len);
+	pBuf->pos += len;
+}
+
+static void x_putU8(bundle_buf_t *pBuf, U8 val)
+{
+	x_putBytes(pBuf, &val, 1);
+}
+
+static void x_putU16(bundle_buf_t *pBuf, U16 val)
+{
+	U8 bytes[2] = { val & 0xFF, val >> 8 };
+	x_putBytes(pBuf, bytes, sizeof(bytes));
+}
+
+static void x_putU32(bundle_buf_t *pBuf, U32 val)
+{
+	U8 bytes[4] = { val & 0xFF, (val >> 8) & 0xFF, (val >> 16) & 0xFF, val >> 24 };
+	x_putBytes(pBuf, bytes, sizeof(bytes));
+}
+
+static void x_putStr(bundle_buf_t *pBuf, const char *pStr)
+{
+	size_t len = pStr ? strlen(pStr) : 0;
+	if (len > UINT16_MAX) {
+		pBuf->bError = TRUE;
+		return;
+	}
+	x_putU16(pBuf, len);
+	x_putBytes(pBuf, pStr, len);
+}
+
+static void x_getBytes(bundle_buf_t *pBuf, void *pDst, U32 len)
+{
+	if (pBuf->bError || len > pBuf->size - pBuf->pos) {
+		pBuf->bError = TRUE;
+		memset(pDst, 0, len);
+		return;
+	}
+	memcpy(pDst, pBuf->pData + pBuf->pos, len);
+	pBuf->pos += len;
+}
+
+static U8 x_getU8(bundle_buf_t *pBuf)
+{
+	U8 val;
+	x_getBytes(pBuf, &val, 1);
+	return val;
+}
+
+static U16 x_getU16(bundle_buf_t *pBuf)
+{
+	U8 bytes[2];
+	x_getBytes(pBuf, bytes, sizeof(bytes));
+	return bytes[0] | (bytes[1] << 8);
+}
+
+static U32 x_getU32(bundle_buf_t *pBuf)
+{
+	U8 bytes[4];
+	x_getBytes(pBuf, bytes, sizeof(bytes));
+	return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((U32)bytes[3] << 24);
+}
+
+// Read a string into a buffer of dstSize bytes, which must leave room for the terminator.
+static void x_getStr(bundle_buf_t *pBuf, char *pDst, U32 dstSize)
+{
+	U16 len = x_getU16(pBuf);
+	if (len >= dstSize) {
+		pBuf->bError = TRUE;
+		pDst[0] = '\0';
+		return;
+	}
+	x_getBytes(pBuf, pDst, len);
+	pDst[len] = '\0';
+}
+
+// Read a string into newly allocated memory.
+static char *x_getStrDup(bundle_buf_t *pBuf)
+{
+	U16 len = x_getU16(pBuf);
+	if (pBuf->bError || len > pBuf->size - pBuf->pos) {
+		pBuf->bError = TRUE;
+		return NULL;
+	}
+	char *pStr = malloc(len + 1);
+	if (!pStr) {
+		pBuf->bError = TRUE;
+		return NULL;
+	}
+	x_getBytes(pBuf, pStr, len);
+	pStr[len] = '\0';
+	return pStr;
+}
+
+static void x_putMac(bundle_buf_t *pBuf, const cfg_mac_t *pMac)
+{
+	x_putU8(pBuf, pMac->mac ? 1 : 0);
+	x_putBytes(pBuf, pMac->buffer.ether_addr_octet, ETH_ALEN);
+}
+
+static void x_getMac(bundle_buf_t *pBuf, cfg_mac_t *pMac)
+{
+	bool bValid = x_getU8(pBuf) != 0;
+	x_getBytes(pBuf, pMac->buffer.ether_addr_octet, ETH_ALEN);
+	pMac->mac = bValid ? &pMac->buffer : NULL;
+}
+
+static void x_putStream(bundle_buf_t *pBuf, const openavb_tl_cfg_t *pCfg, const openavb_tl_cfg_name_value_t *pNVCfg, U32 mapSym, U32 intfSym)
+{
+	x_putU32(pBuf, pCfg->role);
+	x_putU32(pBuf, pCfg->initial_state);
+	x_putMac(pBuf, &pCfg->dest_addr);
+	x_putMac(pBuf, &pCfg->stream_addr);
+	x_putU16(pBuf, pCfg->stream_uid);
+	x_putU32(pBuf, pCfg->max_interval_frames);
+	x_putU32(pBuf, pCfg->max_frame_size);
+	x_putU32(pBuf, pCfg->max_transit_usec);
+	x_putU32(pBuf, pCfg->max_transmit_deficit_usec);
+	x_putU32(pBuf, pCfg->internal_latency);
+	x_putU32(pBuf, pCfg->max_stale);
+	x_putU32(pBuf, pCfg->batch_factor);
+	x_putU32(pBuf, pCfg->report_seconds);
+	x_putU32(pBuf, pCfg->report_frames);
+	x_putU8(pBuf, pCfg->start_paused);
+	x_putU8(pBuf, pCfg->sr_class);
+	x_putU8(pBuf, pCfg->sr_rank);
+	x_putU32(pBuf, pCfg->raw_tx_buffers);
+	x_putU32(pBuf, pCfg->raw_rx_buffers);
+	x_putU8(pBuf, pCfg->tx_blocking_in_intf);
+	x_putStr(pBuf, pCfg->ifname);
+	x_putU16(pBuf, pCfg->vlan_id);
+	x_putU8(pBuf, pCfg->rx_signal_mode);
+	x_putU32(pBuf, pCfg->fixed_timestamp);
+	x_putU8(pBuf, pCfg->spin_wait);
+	x_putU32(pBuf, pCfg->thread_affinity);
+	x_putU32(pBuf, pCfg->thread_rt_priority);
+	x_putStr(pBuf, pCfg->friendly_name);
+	x_putU32(pBuf, mapSym);
+	x_putU32(pBuf, intfSym);
+
+	x_putU32(pBuf, pNVCfg->nLibCfgItems);
+	U32 i1;
+	for (i1 = 0; i1 < pNVCfg->nLibCfgItems; i1++) {
+		x_putStr(pBuf, pNVCfg->libCfgNames[i1]);
+		x_putStr(pBuf, pNVCfg->libCfgValues[i1]);
+	}
+}
+
+static bool x_getStream(bundle_buf_t *pBuf, openavb_tl_cfg_t *pCfg, openavb_tl_cfg_name_value_t *pNVCfg, U32 *pMapSym, U32 *pIntfSym)
+{
+	openavbTLInitCfg(pCfg);
+
+	pCfg->role = x_getU32(pBuf);
+	pCfg->initial_state = x_getU32(pBuf);
+	x_getMac(pBuf, &pCfg->dest_addr);
+	x_getMac(pBuf, &pCfg->stream_addr);
+	pCfg->stream_uid = x_getU16(pBuf);
+	pCfg->max_interval_frames = x_getU32(pBuf);
+	pCfg->max_frame_size = x_getU32(pBuf);
+	pCfg->max_transit_usec = x_getU32(pBuf);
+	pCfg->max_transmit_deficit_usec = x_getU32(pBuf);
+	pCfg->internal_latency = x_getU32(pBuf);
+	pCfg->max_stale = x_getU32(pBuf);
+	pCfg->batch_factor = x_getU32(pBuf);
+	pCfg->report_seconds = x_getU32(pBuf);
+	pCfg->report_frames = x_getU32(pBuf);
+	pCfg->start_paused = x_getU8(pBuf) != 0;
+	pCfg->sr_class = x_getU8(pBuf);
+	pCfg->sr_rank = x_getU8(pBuf);
+	pCfg->raw_tx_buffers = x_getU32(pBuf);
+	pCfg->raw_rx_buffers = x_getU32(pBuf);
+	pCfg->tx_blocking_in_intf = x_getU8(pBuf) != 0;
+	x_getStr(pBuf, pCfg->ifname, sizeof(pCfg->ifname));
+	pCfg->vlan_id = x_getU16(pBuf);
+	pCfg->rx_signal_mode = x_getU8(pBuf) != 0;
+	pCfg->fixed_timestamp = x_getU32(pBuf);
+	pCfg->spin_wait = x_getU8(pBuf) != 0;
+	pCfg->thread_affinity = x_getU32(pBuf);
+	pCfg->thread_rt_priority = x_getU32(pBuf);
+	x_getStr(pBuf, pCfg->friendly_name, sizeof(pCfg->friendly_name));
+	*pMapSym = x_getU32(pBuf);
+	*pIntfSym = x_getU32(pBuf);
+
+	memset(pNVCfg, 0, sizeof(*pNVCfg));
+	U32 nItems = x_getU32(pBuf);
+	if (nItems > MAX_LIB_CFG_ITEMS) {
+		pBuf->bError = TRUE;
+		return FALSE;
+	}
+	U32 i1;
+	for (i1 = 0; i1 < nItems && !pBuf->bError; i1++) {
+		pNVCfg->libCfgNames[i1] = x_getStrDup(pBuf);
+		pNVCfg->libCfgValues[i1] = x_getStrDup(pBuf);
+		pNVCfg->nLibCfgItems++;
+	}
+
+	return !pBuf->bError;
+}
+
+static void x_freeNVCfg(openavb_tl_cfg_name_value_t *pNVCfg)
+{
+	U32 i1;
+	for (i1 = 0; i1 < pNVCfg->nLibCfgItems; i1++) {
+		free(pNVCfg->libCfgNames[i1]);
+		free(pNVCfg->libCfgValues[i1]);
+	}
+	pNVCfg->nLibCfgItems = 0;
+}
+
+////////////////
+// Compiling
+////////////////
+// Index of a function name in the symbol table, adding it if new. Bundles use a handful of modules.
+static S32 x_symbolIndex(bundle_symbols_t *pSymbols, const char *pName)
+{
+	U32 i1;
+	for (i1 = 0; i1 < pSymbols->count; i1++) {
+		if (strcmp(pSymbols->ppNames[i1], pName) == 0) {
+			return i1;
+		}
+	}
+
+	char **ppNames = realloc(pSymbols->ppNames, (pSymbols->count + 1) * sizeof(char *));
+	if (!ppNames) {
+		return -1;
+	}
+	pSymbols->ppNames = ppNames;
+	pSymbols->ppNames[pSymbols->count] = strdup(pName);
+	if (!pSymbols->ppNames[pSymbols->count]) {
+		return -1;
+	}
+	return pSymbols->count++;
+}
+
+// Checks of a parsed configuration that do not depend on the host it will run on.
+static bool x_validate(const char *fileName, tl_state_t *pTLState, openavb_tl_cfg_t *pCfg, openavb_hash_t streams)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	if (!((pCfg->role == AVB_ROLE_TALKER) || (pCfg->role == AVB_ROLE_LISTENER))) {
+		AVB_LOGF_ERROR("%s: invalid or missing role", fileName);
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	if ((pCfg->role == AVB_ROLE_TALKER) && (pCfg->max_interval_frames == 0)) {
+		AVB_LOGF_ERROR("%s: talker role requires 'max_interval_frames'", fileName);
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	if (!pTLState->mapLib.funcName || !openavbTLFindInitFnOsal(pTLState->mapLib.funcName)) {
+		AVB_LOGF_ERROR("%s: mapping initialize function '%s' not found", fileName,
+			pTLState->mapLib.funcName ? pTLState->mapLib.funcName : "");
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	if (!pTLState->intfLib.funcName || !openavbTLFindInitFnOsal(pTLState->intfLib.funcName)) {
+		AVB_LOGF_ERROR("%s: interface initialize function '%s' not found", fileName,
+			pTLState->intfLib.funcName ? pTLState->intfLib.funcName : "");
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	// Talkers without a stream_addr take the address of their interface, so the interface stands in for it.
+	bundle_stream_key_t key;
+	memset(&key, 0, sizeof(key));
+	key.role = pCfg->role;
+	key.uid = pCfg->stream_uid;
+	if (pCfg->stream_addr.mac) {
+		memcpy(key.addr, pCfg->stream_addr.buffer.ether_addr_octet, ETH_ALEN);
+	}
+	else {
+		snprintf(key.ifname, sizeof(key.ifname), "%s", pCfg->ifname);
+	}
+
+	const char *pOther = openavbHashGet(streams, &key);
+	if (pOther) {
+		AVB_LOGF_ERROR("%s: same stream ID as %s", fileName, pOther);
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+	openavbHashPut(streams, &key, (void *)fileName);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return TRUE;
+}
+
+// Hand each name/value item of a stream to the cfg callback of its mapping or interface module,
+// loaded on a scratch media queue, as openavbTLConfigure() does. The callbacks return nothing,
+// so a value they log an error for counts as rejected. Called after x_validate().
+static bool x_validateNV(const char *fileName, tl_state_t *pTLState, openavb_tl_cfg_t *pCfg, openavb_tl_cfg_name_value_t *pNVCfg)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	if (pNVCfg->nLibCfgItems == 0) {
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return TRUE;
+	}
+
+	openavb_map_initialize_fn_t pMapInitFn = (openavb_map_initialize_fn_t)openavbTLFindInitFnOsal(pTLState->mapLib.funcName);
+	openavb_intf_initialize_fn_t pIntfInitFn = (openavb_intf_initialize_fn_t)openavbTLFindInitFnOsal(pTLState->intfLib.funcName);
+	openavb_map_cb_t mapCB;
+	openavb_intf_cb_t intfCB;
+	memset(&mapCB, 0, sizeof(mapCB));
+	memset(&intfCB, 0, sizeof(intfCB));
+
+	media_q_t *pMediaQ = openavbMediaQCreate();
+	if (!pMediaQ
+		|| !pMapInitFn(pMediaQ, &mapCB, pCfg->max_transit_usec)
+		|| !pIntfInitFn(pMediaQ, &intfCB)) {
+		AVB_LOGF_ERROR("%s: unable to load the mapping and interface modules", fileName);
+		if (pMediaQ) {
+			openavbMediaQDelete(pMediaQ);
+		}
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	bool bOK = TRUE;
+	U32 i1;
+	for (i1 = 0; i1 < pNVCfg->nLibCfgItems; i1++) {
+		const char *pName = pNVCfg->libCfgNames[i1];
+		const char *pValue = pNVCfg->libCfgValues[i1];
+		U32 errors = avbLogErrorCount();
+
+		if (MATCH_LEFT(pName, "intf_nv_", 8) && intfCB.intf_cfg_cb) {
+			intfCB.intf_cfg_cb(pMediaQ, pName, pValue);
+		}
+		else if (MATCH_LEFT(pName, "map_nv_", 7) && mapCB.map_cfg_cb) {
+			mapCB.map_cfg_cb(pMediaQ, pName, pValue);
+		}
+		else {
+			AVB_LOGF_ERROR("%s: no module takes the setting %s", fileName, pName);
+			bOK = FALSE;
+			continue;
+		}
+
+		if (avbLogErrorCount() != errors) {
+			AVB_LOGF_ERROR("%s: invalid setting %s = %s", fileName, pName, pValue);
+			bOK = FALSE;
+		}
+	}
+
+	// The modules' private data goes with the media queue. Strings a cfg callback keeps
+	// are only released by the gen_end callbacks, which need gen_init to have run.
+	openavbMediaQDelete(pMediaQ);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return bOK;
+}
+
+EXTERN_DLL_EXPORT bool openavbTLBundleCompile(const char *bundleFile, char **ppFileNames, U32 count)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	if (!bundleFile || !ppFileNames) {
+		AVB_LOG_ERROR("Invalid argument.");
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	bundle_symbols_t symbols;
+	memset(&symbols, 0, sizeof(symbols));
+	bundle_buf_t streamBuf;
+	memset(&streamBuf, 0, sizeof(streamBuf));
+	tl_state_t *pTLState = calloc(1, sizeof(tl_state_t));
+	openavb_hash_t streams = openavbHashNew(sizeof(bundle_stream_key_t), count);
+	bool bOK = pTLState && streams;
+
+	U32 i1;
+	for (i1 = 0; i1 < count && bOK; i1++) {
+		openavb_tl_cfg_t cfg;
+		openavb_tl_cfg_name_value_t NVCfg;
+
+		openavbTLInitCfg(&cfg);
+		memset(&NVCfg, 0, sizeof(NVCfg));
+
+		bOK = openavbTLParseIniFileOsal(pTLState, ppFileNames[i1], &cfg, &NVCfg)
+			&& x_validate(ppFileNames[i1], pTLState, &cfg, streams)
+			&& x_validateNV(ppFileNames[i1], pTLState, &cfg, &NVCfg);
+		if (bOK) {
+			S32 mapSym = x_symbolIndex(&symbols, pTLState->mapLib.funcName);
+			S32 intfSym = x_symbolIndex(&symbols, pTLState->intfLib.funcName);
+			bOK = mapSym >= 0 && intfSym >= 0;
+			if (bOK) {
+				x_putStream(&streamBuf, &cfg, &NVCfg, mapSym, intfSym);
+			}
+		}
+
+		x_freeNVCfg(&NVCfg);
+		free(pTLState->mapLib.libName);
+		free(pTLState->mapLib.funcName);
+		free(pTLState->intfLib.libName);
+		free(pTLState->intfLib.funcName);
+		memset(pTLState, 0, sizeof(tl_state_t));
+	}
+
+	bundle_buf_t buf;
+	memset(&buf, 0, sizeof(buf));
+	if (bOK) {
+		// Body first, so its size and hash are known for the header
+		for (i1 = 0; i1 < symbols.count; i1++) {
+			x_putStr(&buf, symbols.ppNames[i1]);
+		}
+		x_putBytes(&buf, streamBuf.pData, streamBuf.pos);
+		bOK = !buf.bError && !streamBuf.bError;
+	}
+
+	if (bOK) {
+		bundle_buf_t header;
+		memset(&header, 0, sizeof(header));
+		x_putBytes(&header, BUNDLE_MAGIC, BUNDLE_MAGIC_LEN);
+		x_putU32(&header, BUNDLE_VERSION);
+		x_putU32(&header, count);
+		x_putU32(&header, symbols.count);
+		x_putU32(&header, buf.pos);
+		x_putU32(&header, x_hash(buf.pData, buf.pos));
+
+		// Write beside the target and rename, so a host never sees half a bundle
+		char tmpFile[1024];
+		snprintf(tmpFile, sizeof(tmpFile), "%s.tmp", bundleFile);
+		FILE *pFile = fopen(tmpFile, "wb");
+		bOK = !header.bError && pFile
+			&& fwrite(header.pData, 1, header.pos, pFile) == header.pos
+			&& fwrite(buf.pData, 1, buf.pos, pFile) == buf.pos;
+		if (pFile && fclose(pFile) != 0) {
+			bOK = FALSE;
+		}
+		if (bOK && rename(tmpFile, bundleFile) != 0) {
+			bOK = FALSE;
+		}
+		if (!bOK) {
+			AVB_LOGF_ERROR("Unable to write bundle: %s", bundleFile);
+			remove(tmpFile);
+		}
+		free(header.pData);
+	}
+
+	for (i1 = 0; i1 < symbols.count; i1++) {
+		free(symbols.ppNames[i1]);
+	}
+	free(symbols.ppNames);
+	free(buf.pData);
+	free(streamBuf.pData);
+	openavbHashDelete(streams);
+	free(pTLState);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return bOK;
+}
+
+////////////////
+// Loading
+////////////////
+EXTERN_DLL_EXPORT void openavbTLBundleClose(tl_bundle_handle_t bundle)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	tl_bundle_t *pBundle = (tl_bundle_t *)bundle;
+	if (pBundle) {
+		U32 i1;
+		if (pBundle->pNVCfgs) {
+			for (i1 = 0; i1 < pBundle->count; i1++) {
+				x_freeNVCfg(&pBundle->pNVCfgs[i1]);
+			}
+		}
+		free(pBundle->pNVCfgs);
+		free(pBundle->pCfgs);
+		free(pBundle);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+}
+
+// Decode the body of a bundle whose header checked out.
+static bool x_decode(tl_bundle_t *pBundle, bundle_buf_t *pBuf, U32 symbolCount)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	// Resolve each function once, however many streams use it
+	void **ppFns = calloc(symbolCount ? symbolCount : 1, sizeof(void *));
+	if (!ppFns) {
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	bool bOK = TRUE;
+	U32 i1;
+	for (i1 = 0; i1 < symbolCount && bOK; i1++) {
+		char name[256];
+		x_getStr(pBuf, name, sizeof(name));
+		ppFns[i1] = pBuf->bError ? NULL : openavbTLFindInitFnOsal(name);
+		if (!ppFns[i1]) {
+			AVB_LOGF_ERROR("Bundle initialize function '%s' not found", name);
+			bOK = FALSE;
+		}
+	}
+
+	for (i1 = 0; i1 < pBundle->count && bOK; i1++) {
+		openavb_tl_cfg_t *pCfg = &pBundle->pCfgs[i1];
+		U32 mapSym, intfSym;
+
+		bOK = x_getStream(pBuf, pCfg, &pBundle->pNVCfgs[i1], &mapSym, &intfSym)
+			&& mapSym < symbolCount && intfSym < symbolCount;
+		if (!bOK) {
+			AVB_LOGF_ERROR("Bundle stream %u is corrupt", i1);
+			break;
+		}
+
+		pCfg->pMapInitFn = (openavb_map_initialize_fn_t)ppFns[mapSym];
+		pCfg->pIntfInitFn = (openavb_intf_initialize_fn_t)ppFns[intfSym];
+
+		U32 i2;
+		for (i2 = 0; i2 < pBundle->pNVCfgs[i1].nLibCfgItems; i2++) {
+			const char *pName = pBundle->pNVCfgs[i1].libCfgNames[i2];
+			if (!MATCH_LEFT(pName, "intf_nv_", 8) && !MATCH_LEFT(pName, "map_nv_", 7)) {
+				AVB_LOGF_ERROR("Bundle stream %u has an unknown setting: %s", i1, pName);
+				bOK = FALSE;
+			}
+		}
+	}
+
+	if (bOK && pBuf->pos != pBuf->size) {
+		AVB_LOG_ERROR("Bundle has trailing data");
+		bOK = FALSE;
+	}
+
+	free(ppFns);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return bOK;
+}
+
+EXTERN_DLL_EXPORT tl_bundle_handle_t openavbTLBundleOpen(const char *bundleFile)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	if (!bundleFile) {
+		AVB_LOG_ERROR("Invalid argument.");
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return NULL;
+	}
+
+	FILE *pFile = fopen(bundleFile, "rb");
+	if (!pFile) {
+		AVB_LOGF_ERROR("Unable to open bundle: %s", bundleFile);
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return NULL;
+	}
+
+	U8 headerData[BUNDLE_HEADER_SIZE];
+	bundle_buf_t header = { headerData, sizeof(headerData), 0, FALSE };
+	if (fread(headerData, 1, sizeof(headerData), pFile) != sizeof(headerData)
+		|| memcmp(headerData, BUNDLE_MAGIC, BUNDLE_MAGIC_LEN) != 0) {
+		AVB_LOGF_ERROR("Not a bundle: %s", bundleFile);
+		fclose(pFile);
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return NULL;
+	}
+	header.pos = BUNDLE_MAGIC_LEN;
+	U32 version = x_getU32(&header);
+	U32 count = x_getU32(&header);
+	U32 symbolCount = x_getU32(&header);
+	U32 bodySize = x_getU32(&header);
+	U32 hash = x_getU32(&header);
+
+	if (version != BUNDLE_VERSION) {
+		AVB_LOGF_ERROR("Bundle %s has version %u, expected %u. Compile it again.", bundleFile, version, BUNDLE_VERSION);
+		fclose(pFile);
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return NULL;
+	}
+	if (bodySize > BUNDLE_MAX_SIZE) {
+		AVB_LOGF_ERROR("Bundle %s is too large", bundleFile);
+		fclose(pFile);
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return NULL;
+	}
+
+	bundle_buf_t body = { malloc(bodySize ? bodySize : 1), bodySize, 0, FALSE };
+	bool bOK = body.pData && fread(body.pData, 1, bodySize, pFile) == bodySize && fgetc(pFile) == EOF;
+	fclose(pFile);
+	if (bOK && x_hash(body.pData, bodySize) != hash) {
+		bOK = FALSE;
+	}
+	if (!bOK) {
+		AVB_LOGF_ERROR("Bundle %s is truncated or corrupt", bundleFile);
+		free(body.pData);
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return NULL;
+	}
+
+	// Each stream takes well over a byte, which bounds the allocations below
+	tl_bundle_t *pBundle = NULL;
+	if (count <= bodySize) {
+		pBundle = calloc(1, sizeof(tl_bundle_t));
+	}
+	if (pBundle) {
+		pBundle->count = count;
+		pBundle->pCfgs = calloc(count ? count : 1, sizeof(openavb_tl_cfg_t));
+		pBundle->pNVCfgs = calloc(count ? count : 1, sizeof(openavb_tl_cfg_name_value_t));
+	}
+	if (!pBundle || !pBundle->pCfgs || !pBundle->pNVCfgs || !x_decode(pBundle, &body, symbolCount)) {
+		AVB_LOGF_ERROR("Unable to load bundle: %s", bundleFile);
+		openavbTLBundleClose(pBundle);
+		pBundle = NULL;
+	}
+
+	free(body.pData);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return pBundle;
+}
+
+EXTERN_DLL_EXPORT U32 openavbTLBundleCount(tl_bundle_handle_t bundle)
+{
+	tl_bundle_t *pBundle = (tl_bundle_t *)bundle;
+	return pBundle ? pBundle->count : 0;
+}
+
+EXTERN_DLL_EXPORT bool openavbTLBundleGetCfg(tl_bundle_handle_t bundle, U32 index, openavb_tl_cfg_t *pCfg, openavb_tl_cfg_name_value_t *pNVCfg)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	tl_bundle_t *pBundle = (tl_bundle_t *)bundle;
+	if (!pBundle || index >= pBundle->count || !pCfg || !pNVCfg) {
+		AVB_LOG_ERROR("Invalid argument.");
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	memcpy(pCfg, &pBundle->pCfgs[index], sizeof(openavb_tl_cfg_t));
+	pCfg->dest_addr.mac = pCfg->dest_addr.mac ? &pCfg->dest_addr.buffer : NULL;
+	pCfg->stream_addr.mac = pCfg->stream_addr.mac ? &pCfg->stream_addr.buffer : NULL;
+
+	// Check the host first, so nothing is handed out on failure
+	memset(pNVCfg, 0, sizeof(*pNVCfg));
+	if (!openavbTLCheckCfgOsal(pCfg)) {
+		AVB_LOGF_ERROR("Bundle stream %u (%s) does not fit this host", index, pCfg->friendly_name);
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	const openavb_tl_cfg_name_value_t *pSrc = &pBundle->pNVCfgs[index];
+	U32 i1;
+	for (i1 = 0; i1 < pSrc->nLibCfgItems; i1++) {
+		pNVCfg->libCfgNames[i1] = strdup(pSrc->libCfgNames[i1]);
+		pNVCfg->libCfgValues[i1] = strdup(pSrc->libCfgValues[i1]);
+		pNVCfg->nLibCfgItems++;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return TRUE;
+}
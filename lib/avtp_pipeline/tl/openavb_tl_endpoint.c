@@ -66,6 +66,20 @@ void openavbEptClntCheckVerMatchesSrvr(int endpointHandle, U32 AVBVersion)
 	AVB_TRACE_EXIT(AVB_TRACE_TL);
 }
 
+/* Start the version check. The endpoint publishes its version in the stream
+ * status table, so a request is only sent when the table can't be read.
+ */
+static bool x_checkEndpointVersion(tl_state_t *pTLState)
+{
+	U32 AVBVersion;
+
+	if (openavbEptStatusEndpointVersion(&AVBVersion)) {
+		openavbEptClntCheckVerMatchesSrvr(pTLState->endpointHandle, AVBVersion);
+		return TRUE;
+	}
+	return openavbEptClntRequestVersionFromServer(pTLState->endpointHandle);
+}
+
 /* Talker Listener thread function that talks primarily with the endpoint
  */
 void* openavbTLThreadFn(void *pv)
@@ -87,7 +101,7 @@ void* openavbTLThreadFn(void *pv)
 
 			// Validate the AVB version for TL and Endpoint are the same before continuing
 			pTLState->AVBVerState = OPENAVB_TL_AVB_VER_UNKNOWN;
-			pTLState->bConnected = openavbEptClntRequestVersionFromServer(pTLState->endpointHandle);
+			pTLState->bConnected = x_checkEndpointVersion(pTLState);
 			while (pTLState->bRunning && pTLState->bConnected && pTLState->AVBVerState == OPENAVB_TL_AVB_VER_UNKNOWN) {
 				// Check for endpoint version message. Timeout in 50 msec.
 				if (!openavbEptClntService(pTLState->endpointHandle, 50)) {
@@ -128,6 +142,108 @@ void* openavbTLThreadFn(void *pv)
 	return NULL;
 }
 
+// Close the endpoint connection of a pooled TL, unless it is already gone.
+static void x_stepCloseConnection(tl_state_t *pTLState)
+{
+	if (pTLState->bConnected) {
+		openavbEptClntCloseSrvrConnection(pTLState->endpointHandle);
+		pTLState->bConnected = FALSE;
+		pTLState->endpointHandle = 0;
+	}
+}
+
+// Pooled version of openavbTLThreadFn(). Each state does the work of one pass of the thread
+// loop above without sleeping; the worker waits until *pNextNS instead.
+bool openavbTLStep(tl_state_t *pTLState, U64 nowNS, U64 *pNextNS)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	// Retry and version check period, as used by openavbTLThreadFn()
+	*pNextNS = nowNS + NANOSECONDS_PER_MSEC;
+
+	switch (pTLState->step) {
+		case TL_STEP_CONNECT:
+			if (!pTLState->bRunning) {
+				AVB_TRACE_EXIT(AVB_TRACE_TL);
+				return FALSE;
+			}
+
+			pTLState->endpointHandle = openavbEptClntOpenSrvrConnection(pTLState);
+			if (pTLState->endpointHandle == AVB_ENDPOINT_HANDLE_INVALID) {
+				// error connecting to endpoint, already logged
+				pTLState->endpointHandle = 0;
+				break;
+			}
+
+			// Validate the AVB version for TL and Endpoint are the same before continuing
+			pTLState->AVBVerState = OPENAVB_TL_AVB_VER_UNKNOWN;
+			pTLState->bConnected = x_checkEndpointVersion(pTLState);
+			pTLState->step = TL_STEP_VERSION;
+			break;
+
+		case TL_STEP_VERSION:
+			if (pTLState->bRunning && pTLState->bConnected && pTLState->AVBVerState == OPENAVB_TL_AVB_VER_UNKNOWN) {
+				// Check for endpoint version message. Don't block.
+				if (!openavbEptClntService(pTLState->endpointHandle, 0)) {
+					AVB_LOG_WARNING("Lost connection to endpoint, will retry");
+					pTLState->bConnected = FALSE;
+					pTLState->endpointHandle = 0;
+				}
+				else if (pTLState->AVBVerState == OPENAVB_TL_AVB_VER_UNKNOWN) {
+					break;
+				}
+			}
+			if (pTLState->AVBVerState == OPENAVB_TL_AVB_VER_INVALID) {
+				AVB_LOG_ERROR("AVB core version is different than Endpoint AVB core version. Streams will not be started. Will reconnect to the endpoint and check again.");
+			}
+
+			if (pTLState->bRunning && pTLState->bConnected && pTLState->AVBVerState == OPENAVB_TL_AVB_VER_VALID) {
+				pTLState->step = TL_STEP_BEGIN;
+				*pNextNS = nowNS;
+			}
+			else {
+				x_stepCloseConnection(pTLState);
+				pTLState->step = TL_STEP_CONNECT;
+			}
+			break;
+
+		case TL_STEP_BEGIN:
+			if (pTLState->cfg.role == AVB_ROLE_TALKER ? openavbTLRunTalkerBegin(pTLState) : openavbTLRunListenerBegin(pTLState)) {
+				pTLState->step = TL_STEP_STREAM;
+				*pNextNS = nowNS;
+			}
+			else {
+				x_stepCloseConnection(pTLState);
+				pTLState->step = TL_STEP_CONNECT;
+			}
+			break;
+
+		case TL_STEP_STREAM:
+			if (pTLState->bRunning && pTLState->bConnected) {
+				if (pTLState->cfg.role == AVB_ROLE_TALKER) {
+					openavbTLRunTalkerStep(pTLState, pNextNS);
+				}
+				else {
+					openavbTLRunListenerStep(pTLState, pNextNS);
+				}
+				break;
+			}
+
+			if (pTLState->cfg.role == AVB_ROLE_TALKER) {
+				openavbTLRunTalkerEnd(pTLState);
+			}
+			else {
+				openavbTLRunListenerEnd(pTLState);
+			}
+			x_stepCloseConnection(pTLState);
+			pTLState->step = TL_STEP_CONNECT;
+			break;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return TRUE;
+}
+
 // This is currently only for used for Endpoint
 tl_handle_t TLHandleListGet(int endpointHandle)
 {
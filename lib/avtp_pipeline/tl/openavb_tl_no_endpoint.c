@@ -55,6 +55,16 @@ void openavbEptClntCheckVerMatchesSrvr(int endpointHandle, U32 AVBVersion)
 }
 
 
+// Assign a unique endpoint handle
+static void x_assignEndpointHandle(tl_state_t *pTLState)
+{
+	static int gEndpointHandle = 1;
+
+	TL_LOCK();
+	pTLState->endpointHandle = gEndpointHandle++;
+	TL_UNLOCK();
+}
+
 // Talker Listener thread function
 void* openavbTLThreadFn(void *pv)
 {
@@ -64,11 +74,7 @@ void* openavbTLThreadFn(void *pv)
 	
 	openavbTLThreadFnOsal(pTLState);
 
-	TL_LOCK();
-	// Assign a unique endpoint handle
-	static int gEndpointHandle = 1;
-	pTLState->endpointHandle = gEndpointHandle++;
-	TL_UNLOCK();
+	x_assignEndpointHandle(pTLState);
 
 	while (pTLState->bRunning) {
 		AVB_TRACE_LINE(AVB_TRACE_TL_DETAIL);
@@ -97,6 +103,73 @@ void* openavbTLThreadFn(void *pv)
 	return NULL;
 }
 
+// Pooled version of openavbTLThreadFn(). Each state does the work of one pass of the thread
+// loop above without sleeping; the worker waits until *pNextNS instead.
+bool openavbTLStep(tl_state_t *pTLState, U64 nowNS, U64 *pNextNS)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	// Retry period, as used by openavbTLThreadFn()
+	*pNextNS = nowNS + NANOSECONDS_PER_MSEC;
+
+	switch (pTLState->step) {
+		case TL_STEP_CONNECT:
+		case TL_STEP_VERSION:
+			if (!pTLState->bRunning) {
+				AVB_TRACE_EXIT(AVB_TRACE_TL);
+				return FALSE;
+			}
+
+			openavbTLThreadFnOsal(pTLState);
+
+			x_assignEndpointHandle(pTLState);
+
+			pTLState->step = TL_STEP_BEGIN;
+			*pNextNS = nowNS;
+			break;
+
+		case TL_STEP_BEGIN:
+			if (!pTLState->bRunning) {
+				AVB_TRACE_EXIT(AVB_TRACE_TL);
+				return FALSE;
+			}
+
+			if (pTLState->cfg.role == AVB_ROLE_TALKER ? openavbTLRunTalkerBegin(pTLState) : openavbTLRunListenerBegin(pTLState)) {
+				pTLState->step = TL_STEP_STREAM;
+				*pNextNS = nowNS;
+			}
+			break;
+
+		case TL_STEP_STREAM:
+			if (pTLState->bRunning && pTLState->bConnected) {
+				if (pTLState->cfg.role == AVB_ROLE_TALKER) {
+					openavbTLRunTalkerStep(pTLState, pNextNS);
+				}
+				else {
+					openavbTLRunListenerStep(pTLState, pNextNS);
+				}
+				break;
+			}
+
+			if (pTLState->cfg.role == AVB_ROLE_TALKER) {
+				openavbTLRunTalkerEnd(pTLState);
+			}
+			else {
+				openavbTLRunListenerEnd(pTLState);
+			}
+
+			if (pTLState->bConnected) {
+				pTLState->bConnected = FALSE;
+				pTLState->endpointHandle = 0;
+			}
+			pTLState->step = TL_STEP_BEGIN;
+			break;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return TRUE;
+}
+
 tl_handle_t TLHandleListGet(int endpointHandle)
 {
 	AVB_TRACE_ENTRY(AVB_TRACE_TL);
@@ -133,3 +206,12 @@ bool openavbEptClntService(int h, int timeout)
 	return TRUE;
 }
 
+bool openavbEptClntNotify(int h, volatile bool *pPending)
+{
+	return TRUE;
+}
+
+void openavbEptClntNotifyStop(void)
+{
+}
+
@@ -0,0 +1,509 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Worker pool for talkers and listeners
+*
+* Instead of a thread of its own, a talker or listener attached to a pool is run by one of a
+* fixed number of worker threads, each pinned to a CPU. A worker steps its talkers first, when
+* their transmit interval is due, then polls its listeners, and sleeps until the next one is due.
+* Workers keep busy and total time so their utilization can be reported.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "openavb_platform.h"
+#include "openavb_trace.h"
+#include "openavb_tl.h"
+#include "openavb_metrics.h"
+
+#define	AVB_LOG_COMPONENT	"TL Pool"
+#include "openavb_pub.h"
+#include "openavb_log.h"
+
+// Longest a worker sleeps, so newly started streams are picked up quickly
+#define POOL_MAX_SLEEP_NS		NANOSECONDS_PER_MSEC
+
+// Initial size of the stream lists of a worker
+#define POOL_LIST_INITIAL_SIZE	16
+
+typedef enum {
+	POOL_METRIC_TALKERS = 0,
+	POOL_METRIC_LISTENERS,
+	POOL_METRIC_BUSY,
+	POOL_METRIC_RUN,
+	POOL_METRIC_STEPS,
+	POOL_METRIC_OVERRUNS,
+	POOL_METRIC_UTILIZATION,
+	POOL_METRIC_COUNT
+} pool_metric_t;
+
+static const openavb_metric_def_t poolMetricDefs[POOL_METRIC_COUNT] = {
+	{ "pool_talkers", "Talkers run by the worker", OPENAVB_METRIC_GAUGE },
+	{ "pool_listeners", "Listeners run by the worker", OPENAVB_METRIC_GAUGE },
+	{ "pool_busy_ns_total", "Time spent stepping streams", OPENAVB_METRIC_COUNTER },
+	{ "pool_run_ns_total", "Time since the worker started", OPENAVB_METRIC_COUNTER },
+	{ "pool_steps_total", "Streams stepped", OPENAVB_METRIC_COUNTER },
+	{ "pool_overruns_total", "Passes that ended after the next stream was due", OPENAVB_METRIC_COUNTER },
+	{ "pool_utilization_pct", "Busy percentage over the last second", OPENAVB_METRIC_GAUGE },
+};
+
+THREAD_TYPE(tlPoolThread);
+
+typedef struct {
+	tl_state_t **ppTL;
+	U32 count;
+	U32 size;
+} pool_list_t;
+
+typedef struct {
+	struct tl_pool *pPool;
+	U32 index;
+	int cpu;
+
+	THREAD_DEFINITON(tlPoolThread);
+
+	// Guards the stream lists. Held by the worker while it steps them.
+	MUTEX_HANDLE_ALT(mutex);
+	pool_list_t talkers;
+	pool_list_t listeners;
+
+	// Only written by the worker
+	volatile U64 busyNS;
+	volatile U64 runNS;
+	volatile U64 steps;
+	volatile U64 overruns;
+	volatile U32 utilization;
+
+	openavb_metrics_group_t *pMetrics;
+} pool_worker_t;
+
+struct tl_pool {
+	volatile bool bRunning;
+	U32 rtPriority;
+	U64 rxPollNS;
+
+	// Serializes the choice of worker when streams are started
+	MUTEX_HANDLE_ALT(startMutex);
+
+	U32 nWorkers;
+	pool_worker_t *pWorkers;
+};
+
+static bool x_listAdd(pool_list_t *pList, tl_state_t *pTLState)
+{
+	if (pList->count == pList->size) {
+		U32 size = pList->size ? pList->size * 2 : POOL_LIST_INITIAL_SIZE;
+		tl_state_t **ppTL = realloc(pList->ppTL, size * sizeof(tl_state_t *));
+		if (!ppTL) {
+			return FALSE;
+		}
+		pList->ppTL = ppTL;
+		pList->size = size;
+	}
+	pList->ppTL[pList->count++] = pTLState;
+	return TRUE;
+}
+
+// Step what is due on a list. Lowers *pNextNS to the earliest time a stream on the list is next due.
+static void x_runList(pool_worker_t *pWorker, pool_list_t *pList, U64 *pNextNS)
+{
+	U32 i = 0;
+	while (i < pList->count) {
+		tl_state_t *pTLState = pList->ppTL[i];
+		U64 nowNS;
+
+		CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &nowNS);
+		if (nowNS >= pTLState->stepNextNS || !pTLState->bRunning) {
+			pWorker->steps++;
+			if (!openavbTLStep(pTLState, nowNS, &pTLState->stepNextNS)) {
+				// Stopped and released. Hand it back to openavbTLPoolStop().
+				pList->ppTL[i] = pList->ppTL[--pList->count];
+				__sync_synchronize();
+				pTLState->bPoolActive = FALSE;
+				continue;
+			}
+		}
+
+		if (pTLState->stepNextNS < *pNextNS) {
+			*pNextNS = pTLState->stepNextNS;
+		}
+		i++;
+	}
+}
+
+static void *x_workerFn(void *pv)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	pool_worker_t *pWorker = (pool_worker_t *)pv;
+	struct tl_pool *pPool = pWorker->pPool;
+	U64 lastNS, windowNS, windowBusyNS = 0;
+
+	CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &lastNS);
+	windowNS = lastNS;
+
+	while (pPool->bRunning) {
+		U64 startNS, endNS;
+		U64 dueNS = (U64)-1;
+
+		CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &startNS);
+
+		MUTEX_LOCK_ALT(pWorker->mutex);
+		// Talkers first, they have transmit deadlines. Listeners are buffered by their media queue.
+		x_runList(pWorker, &pWorker->talkers, &dueNS);
+		x_runList(pWorker, &pWorker->listeners, &dueNS);
+		openavbMetricsSet(pWorker->pMetrics, POOL_METRIC_TALKERS, pWorker->talkers.count);
+		openavbMetricsSet(pWorker->pMetrics, POOL_METRIC_LISTENERS, pWorker->listeners.count);
+		MUTEX_UNLOCK_ALT(pWorker->mutex);
+
+		CLOCK_GETTIME64(OPENAVB_TIMER_CLOCK, &endNS);
+
+		pWorker->busyNS += endNS - startNS;
+		pWorker->runNS += endNS - lastNS;
+		windowBusyNS += endNS - startNS;
+		openavbMetricsAdd(pWorker->pMetrics, POOL_METRIC_BUSY, endNS - startNS);
+		openavbMetricsAdd(pWorker->pMetrics, POOL_METRIC_RUN, endNS - lastNS);
+		lastNS = endNS;
+
+		if (endNS - windowNS >= NANOSECONDS_PER_SECOND) {
+			pWorker->utilization = (U32)((windowBusyNS * 100) / (endNS - windowNS));
+			openavbMetricsSet(pWorker->pMetrics, POOL_METRIC_UTILIZATION, pWorker->utilization);
+			openavbMetricsSet(pWorker->pMetrics, POOL_METRIC_STEPS, pWorker->steps);
+			windowNS = endNS;
+			windowBusyNS = 0;
+		}
+
+		if (dueNS <= endNS) {
+			// Already late for the next stream, go straight round again
+			if (dueNS < startNS || endNS - startNS > POOL_MAX_SLEEP_NS) {
+				pWorker->overruns++;
+				openavbMetricsAdd(pWorker->pMetrics, POOL_METRIC_OVERRUNS, 1);
+			}
+			continue;
+		}
+
+		if (dueNS > endNS + POOL_MAX_SLEEP_NS) {
+			dueNS = endNS + POOL_MAX_SLEEP_NS;
+		}
+		SLEEP_UNTIL_NSEC(dueNS);
+	}
+
+	THREAD_JOINABLE(pWorker->tlPoolThread);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return NULL;
+}
+
+// CPU of the n-th set bit in mask, counting round when n exceeds the bits set.
+static int x_maskCpu(U32 mask, U32 n)
+{
+	U32 bits = __builtin_popcount(mask);
+	if (!bits) {
+		return -1;
+	}
+
+	n %= bits;
+	int cpu;
+	for (cpu = 0; cpu < 32; cpu++) {
+		if ((mask & (1U << cpu)) && n-- == 0) {
+			break;
+		}
+	}
+	return cpu;
+}
+
+EXTERN_DLL_EXPORT tl_pool_handle_t openavbTLPoolCreate(U32 workers, U32 cpuMask, U32 rtPriority)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	if (!workers) {
+		AVB_LOG_ERROR("A pool needs at least one worker");
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return NULL;
+	}
+
+	struct tl_pool *pPool = calloc(1, sizeof(struct tl_pool));
+	if (!pPool) {
+		AVB_LOG_ERROR("Unable to allocate pool");
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return NULL;
+	}
+
+	pPool->pWorkers = calloc(workers, sizeof(pool_worker_t));
+	if (!pPool->pWorkers) {
+		AVB_LOG_ERROR("Unable to allocate pool workers");
+		free(pPool);
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return NULL;
+	}
+
+	pPool->bRunning = TRUE;
+	pPool->rtPriority = rtPriority;
+	pPool->rxPollNS = TL_POOL_RX_POLL_USEC * NANOSECONDS_PER_USEC;
+	pPool->nWorkers = workers;
+	MUTEX_CREATE_ALT(pPool->startMutex);
+
+	U32 i1;
+	for (i1 = 0; i1 < workers; i1++) {
+		pool_worker_t *pWorker = &pPool->pWorkers[i1];
+		char name[OPENAVB_METRICS_LABEL_LEN];
+		char cpu[OPENAVB_METRICS_LABEL_LEN];
+
+		pWorker->pPool = pPool;
+		pWorker->index = i1;
+		pWorker->cpu = x_maskCpu(cpuMask, i1);
+		MUTEX_CREATE_ALT(pWorker->mutex);
+
+		snprintf(name, sizeof(name), "worker%u", i1);
+		snprintf(cpu, sizeof(cpu), "cpu%d", pWorker->cpu);
+		pWorker->pMetrics = openavbMetricsGroupOpen(name, "pool", cpu, poolMetricDefs, POOL_METRIC_COUNT);
+
+		bool errResult;
+		THREAD_CREATE(tlPoolThread, pWorker->tlPoolThread, NULL, x_workerFn, pWorker);
+		THREAD_CHECK_ERROR(pWorker->tlPoolThread, "Thread / task creation failed", errResult);
+		if (errResult) {
+			// Workers already started keep the pool usable
+			AVB_LOGF_ERROR("Unable to start pool worker %u", i1);
+			openavbMetricsGroupClose(pWorker->pMetrics);
+			MUTEX_DESTROY_ALT(pWorker->mutex);
+			pPool->nWorkers = i1;
+			break;
+		}
+
+		if (pPool->rtPriority != 0) { THREAD_SET_RT_PRIORITY(pWorker->tlPoolThread, pPool->rtPriority); }
+		if (pWorker->cpu >= 0) { THREAD_PIN(pWorker->tlPoolThread, 1U << pWorker->cpu); }
+	}
+
+	if (!pPool->nWorkers) {
+		openavbTLPoolDelete(pPool);
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return NULL;
+	}
+
+	AVB_LOGF_INFO("Started %u pool workers", pPool->nWorkers);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return pPool;
+}
+
+EXTERN_DLL_EXPORT bool openavbTLPoolDelete(tl_pool_handle_t pool)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	struct tl_pool *pPool = (struct tl_pool *)pool;
+	if (!pPool) {
+		AVB_LOG_ERROR("Invalid pool.");
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	U32 i1;
+	for (i1 = 0; i1 < pPool->nWorkers; i1++) {
+		if (pPool->pWorkers[i1].talkers.count || pPool->pWorkers[i1].listeners.count) {
+			AVB_LOG_ERROR("Pool still has running streams.");
+			AVB_TRACE_EXIT(AVB_TRACE_TL);
+			return FALSE;
+		}
+	}
+
+	pPool->bRunning = FALSE;
+
+	for (i1 = 0; i1 < pPool->nWorkers; i1++) {
+		pool_worker_t *pWorker = &pPool->pWorkers[i1];
+		THREAD_JOIN(pWorker->tlPoolThread, NULL);
+		openavbMetricsGroupClose(pWorker->pMetrics);
+		MUTEX_DESTROY_ALT(pWorker->mutex);
+		free(pWorker->talkers.ppTL);
+		free(pWorker->listeners.ppTL);
+	}
+
+	MUTEX_DESTROY_ALT(pPool->startMutex);
+	free(pPool->pWorkers);
+	free(pPool);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return TRUE;
+}
+
+EXTERN_DLL_EXPORT bool openavbTLPoolAttach(tl_pool_handle_t pool, tl_handle_t handle)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	tl_state_t *pTLState = (tl_state_t *)handle;
+
+	if (!pool || !pTLState) {
+		AVB_LOG_ERROR("Invalid handle.");
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	if (pTLState->pMediaQ) {
+		// The AVDECC Msg thread is started by openavbTLConfigure() unless pooled
+		AVB_LOG_ERROR("Streams must be attached to a pool before they are configured.");
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	pTLState->pPool = (struct tl_pool *)pool;
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return TRUE;
+}
+
+EXTERN_DLL_EXPORT U32 openavbTLPoolWorkerCount(tl_pool_handle_t pool)
+{
+	struct tl_pool *pPool = (struct tl_pool *)pool;
+	return pPool ? pPool->nWorkers : 0;
+}
+
+EXTERN_DLL_EXPORT bool openavbTLPoolGetStats(tl_pool_handle_t pool, U32 worker, openavb_tl_pool_stats_t *pStats)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	struct tl_pool *pPool = (struct tl_pool *)pool;
+
+	if (!pPool || worker >= pPool->nWorkers || !pStats) {
+		AVB_LOG_ERROR("Invalid argument.");
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	pool_worker_t *pWorker = &pPool->pWorkers[worker];
+	pStats->cpu = pWorker->cpu;
+	pStats->talkers = pWorker->talkers.count;
+	pStats->listeners = pWorker->listeners.count;
+	pStats->busyNS = __sync_add_and_fetch(&pWorker->busyNS, 0);
+	pStats->runNS = __sync_add_and_fetch(&pWorker->runNS, 0);
+	pStats->steps = __sync_add_and_fetch(&pWorker->steps, 0);
+	pStats->overruns = __sync_add_and_fetch(&pWorker->overruns, 0);
+	pStats->utilization = pWorker->utilization;
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return TRUE;
+}
+
+bool openavbTLPoolAccepts(tl_state_t *pTLState)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	openavb_tl_cfg_t *pCfg = &pTLState->cfg;
+
+	if (pCfg->role == AVB_ROLE_TALKER && (pCfg->tx_blocking_in_intf || pCfg->spin_wait)) {
+		// Both wait inside the talker loop for the next interval, which would stall the worker
+		AVB_LOGF_WARNING("%s: tx_blocking_in_intf and spin_wait talkers need a thread of their own, not pooled", pCfg->friendly_name);
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return TRUE;
+}
+
+bool openavbTLPoolStart(tl_state_t *pTLState)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	struct tl_pool *pPool = pTLState->pPool;
+	openavb_tl_cfg_t *pCfg = &pTLState->cfg;
+	bool bTalker = pCfg->role == AVB_ROLE_TALKER;
+	bool bPinned = pCfg->thread_affinity != 0xFFFFFFFF;
+	pool_worker_t *pBest = NULL;
+	U32 i1;
+
+	MUTEX_LOCK_ALT(pPool->startMutex);
+
+	// Spread each role evenly over the workers, honouring thread_affinity where a worker matches it
+	while (!pBest) {
+		for (i1 = 0; i1 < pPool->nWorkers; i1++) {
+			pool_worker_t *pWorker = &pPool->pWorkers[i1];
+			if (bPinned && !(pWorker->cpu >= 0 && pWorker->cpu < 32 && (pCfg->thread_affinity & (1U << pWorker->cpu)))) {
+				continue;
+			}
+			if (!pBest) {
+				pBest = pWorker;
+				continue;
+			}
+
+			U32 role = bTalker ? pWorker->talkers.count : pWorker->listeners.count;
+			U32 bestRole = bTalker ? pBest->talkers.count : pBest->listeners.count;
+			if (role < bestRole ||
+				(role == bestRole && pWorker->talkers.count + pWorker->listeners.count < pBest->talkers.count + pBest->listeners.count)) {
+				pBest = pWorker;
+			}
+		}
+
+		if (!pBest && bPinned) {
+			AVB_LOGF_WARNING("%s: no pool worker on thread_affinity 0x%x, using any", pCfg->friendly_name, pCfg->thread_affinity);
+			bPinned = FALSE;
+		}
+	}
+
+	pTLState->step = TL_STEP_CONNECT;
+	pTLState->stepNextNS = 0;
+	pTLState->bPoolActive = TRUE;
+
+	MUTEX_LOCK_ALT(pBest->mutex);
+	bool bAdded = x_listAdd(bTalker ? &pBest->talkers : &pBest->listeners, pTLState);
+	MUTEX_UNLOCK_ALT(pBest->mutex);
+
+	MUTEX_UNLOCK_ALT(pPool->startMutex);
+
+	if (!bAdded) {
+		AVB_LOG_ERROR("Unable to grow pool worker stream list");
+		pTLState->bPoolActive = FALSE;
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return FALSE;
+	}
+
+	AVB_LOGF_DEBUG("%s: running on pool worker %u", pCfg->friendly_name, pBest->index);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return TRUE;
+}
+
+void openavbTLPoolStop(tl_state_t *pTLState)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	// The worker winds the stream down on its next passes, the same way TLThread would
+	while (pTLState->bPoolActive) {
+		SLEEP_MSEC(1);
+	}
+	__sync_synchronize();
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+}
+
+U64 openavbTLPoolRxPollNS(struct tl_pool *pPool)
+{
+	return pPool ? pPool->rxPollNS : TL_POOL_RX_POLL_USEC * NANOSECONDS_PER_USEC;
+}
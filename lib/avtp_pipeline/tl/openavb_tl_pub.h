@@ -67,6 +67,8 @@ typedef enum {
 	TL_STAT_RX_LOST,
 	/// Number of bytes received
 	TL_STAT_RX_BYTES,
+	/// Number of interface overruns (talker) or underruns (listener)
+	TL_STAT_INTF_XRUNS,
 } tl_stat_t;
 
 /// Maximum number of configuration parameters inside INI file a host can have
@@ -272,6 +274,17 @@ bool openavbTLRun(tl_handle_t handle);
  */
 bool openavbTLStop(tl_handle_t handle);
 
+/** Stop a set of talkers and listeners.
+ *
+ * Same as calling openavbTLStop() for each, except that all of them are
+ * asked to stop before waiting for any, so they wind down in parallel.
+ *
+ * \param pHandles Handles returned from openavbTLOpen(). NULL entries are skipped
+ * \param count Number of handles
+ * \return TRUE on success or FALSE on failure
+ */
+bool openavbTLStopAll(tl_handle_t *pHandles, U32 count);
+
 /** Pause or resume as stream.
  *
  * A paused stream will do everything except will toss both tx and rx packets
@@ -293,6 +306,18 @@ void openavbTLPauseStream(tl_handle_t handle, bool bPause);
  */
 bool openavbTLClose(tl_handle_t handle);
 
+/** Close a set of talkers and listeners.
+ *
+ * Same as calling openavbTLClose() for each, except that the threads of all
+ * of them are asked to finish before waiting for any. The handles are set
+ * to NULL.
+ *
+ * \param pHandles Handles returned from openavbTLOpen(). NULL entries are skipped
+ * \param count Number of handles
+ * \return TRUE on success or FALSE if any failed to close
+ */
+bool openavbTLCloseAll(tl_handle_t *pHandles, U32 count);
+
 /** Get a pointer to a list of interfaces module callbacks.
  *
  * In cases where a host application needs to call directly into an interface
@@ -374,6 +399,38 @@ tl_init_state_t openavbTLGetInitialState(tl_handle_t handle);
  */
 U64 openavbTLStat(tl_handle_t handle, tl_stat_t stat);
 
+/// How long a stream took to reach each stage of starting, measured from openavbTLRun()
+typedef struct {
+	/// Connected to the endpoint and the stream registered or attached
+	U64 connectedNS;
+	/// Stream opened after SRP found a peer
+	U64 streamingNS;
+	/// First frame sent or received
+	U64 firstFrameNS;
+} openavb_tl_startup_times_t;
+
+/** Get how long the last run of a stream took to start.
+ *
+ * Stages not reached yet are reported as 0.
+ *
+ * \param handle The handle return from openavbTLOpen()
+ * \param pTimes Filled in with the times
+ * \return TRUE on success or FALSE if the stream has never been run
+ */
+bool openavbTLGetStartupTimes(tl_handle_t handle, openavb_tl_startup_times_t *pTimes);
+
+/** Get the latency distribution measured by the interface module.
+ *
+ * Only available for interface modules that implement intf_get_latency_cb.
+ *
+ * \param handle The handle return from openavbTLOpen()
+ * \param interval If true report the last completed measurement interval,
+ *        otherwise everything since the stream was started
+ * \param pLatency Filled in with the distribution
+ * \return TRUE on success or FALSE if the interface does not measure latency
+ */
+bool openavbTLGetIntfLatency(tl_handle_t handle, bool interval, openavb_intf_latency_t *pLatency);
+
 /** Read an ini file.
  *
  * Parses an input configuration file tp populate configuration structures, and
@@ -390,6 +447,171 @@ U64 openavbTLStat(tl_handle_t handle, tl_stat_t stat);
  */
 bool openavbTLReadIniFileOsal(tl_handle_t TLhandle, const char *fileName, openavb_tl_cfg_t *pCfg, openavb_tl_cfg_name_value_t *pNVCfg);
 
+/** Read the ini files of a set of talkers and listeners and configure them.
+ *
+ * Does openavbTLReadIniFileOsal() and openavbTLConfigure() for each handle,
+ * with the files parsed and the mapping and interface modules initialized
+ * on several threads at once.
+ *
+ * \param pHandles Handles returned from openavbTLOpen()
+ * \param ppFileNames Configuration file of each handle, as for openavbTLReadIniFileOsal()
+ * \param count Number of handles
+ * \param threads Most files to work on at once. 0 or 1 configures them one after the other
+ * \return TRUE if all were configured or FALSE if any failed
+ *
+ * \warning Not available on all platforms
+ */
+bool openavbTLConfigureIniFilesOsal(tl_handle_t *pHandles, char **ppFileNames, U32 count, U32 threads);
+
+/// Handle to a configuration bundle: the validated configuration of a set of
+/// talkers and listeners, compiled from their ini files into a binary file.
+typedef void *tl_bundle_handle_t;
+
+/** Compile the ini files of a set of talkers and listeners into a bundle.
+ *
+ * Every file is parsed and validated: the role and the keys it requires,
+ * the mapping and interface initialize functions, which must be linked
+ * into the calling program, and the stream IDs, which must not repeat.
+ * The bundle is written only if all of them pass.
+ *
+ * Checks that depend on the host the streams run on, such as the network
+ * interface and the MAC address of talkers without a stream_addr, are
+ * left to openavbTLBundleGetCfg().
+ *
+ * \param bundleFile File to write the bundle to
+ * \param ppFileNames Configuration files, as for openavbTLReadIniFileOsal()
+ * \param count Number of files
+ * \return TRUE on success or FALSE if a file failed to validate
+ *
+ * \warning Not available on all platforms
+ */
+bool openavbTLBundleCompile(const char *bundleFile, char **ppFileNames, U32 count);
+
+/** Load a bundle written by openavbTLBundleCompile().
+ *
+ * The whole bundle is checked before anything is returned, and the mapping
+ * and interface initialize functions are looked up once for all streams.
+ *
+ * \param bundleFile The bundle file
+ * \return handle of the bundle or NULL if it is not valid
+ */
+tl_bundle_handle_t openavbTLBundleOpen(const char *bundleFile);
+
+/** Free a bundle.
+ *
+ * \param bundle The handle returned from openavbTLBundleOpen()
+ */
+void openavbTLBundleClose(tl_bundle_handle_t bundle);
+
+/** Get the number of talkers and listeners in a bundle.
+ *
+ * \param bundle The handle returned from openavbTLBundleOpen()
+ * \return stream count
+ */
+U32 openavbTLBundleCount(tl_bundle_handle_t bundle);
+
+/** Get the configuration of one talker or listener of a bundle.
+ *
+ * Replaces openavbTLReadIniFileOsal(). The results are passed to
+ * openavbTLConfigure() and the name/value items freed the same way.
+ *
+ * \param bundle The handle returned from openavbTLBundleOpen()
+ * \param index Index of the stream, less than openavbTLBundleCount()
+ * \param pCfg Filled in with the configuration
+ * \param pNVCfg Filled in with the mapping and interface module settings
+ * \return TRUE on success or FALSE if the configuration does not fit this host
+ */
+bool openavbTLBundleGetCfg(tl_bundle_handle_t bundle, U32 index, openavb_tl_cfg_t *pCfg, openavb_tl_cfg_name_value_t *pNVCfg);
+
+/** Configure a set of talkers and listeners from a bundle.
+ *
+ * Same as openavbTLConfigureIniFilesOsal(), with stream i1 of the
+ * bundle configuring pHandles[i1].
+ *
+ * \param pHandles Handles returned from openavbTLOpen(), openavbTLBundleCount() of them
+ * \param bundle The handle returned from openavbTLBundleOpen()
+ * \param threads Most streams to work on at once. 0 or 1 configures them one after the other
+ * \return TRUE if all were configured or FALSE if any failed
+ *
+ * \warning Not available on all platforms
+ */
+bool openavbTLConfigureBundleOsal(tl_handle_t *pHandles, tl_bundle_handle_t bundle, U32 threads);
+
+
+/// Handle to a pool of worker threads shared by talkers and listeners.
+typedef void *tl_pool_handle_t;
+
+/// Statistics of one worker of a pool
+typedef struct {
+	/// CPU the worker is pinned to, -1 if it isn't pinned
+	int cpu;
+	/// Talkers currently run by the worker
+	U32 talkers;
+	/// Listeners currently run by the worker
+	U32 listeners;
+	/// Time spent stepping streams since the worker started
+	U64 busyNS;
+	/// Time since the worker started
+	U64 runNS;
+	/// Number of times a stream was stepped
+	U64 steps;
+	/// Passes that ended after the next stream was already due
+	U64 overruns;
+	/// Busy percentage over the last second
+	U32 utilization;
+} openavb_tl_pool_stats_t;
+
+/** Create a pool of worker threads for talkers and listeners.
+ *
+ * Talkers and listeners attached to the pool are run by its workers
+ * instead of each having a streaming thread and an AVDECC Msg thread of
+ * their own. This bounds the number of threads when hosting many streams.
+ *
+ * \param workers Number of worker threads
+ * \param cpuMask CPUs to pin the workers to, one CPU per worker in
+ *        ascending order and starting over when there are more workers
+ *        than CPUs. 0 leaves the workers unpinned
+ * \param rtPriority Real time priority of the workers, 0 for none
+ * \return handle of the pool or NULL on failure
+ */
+tl_pool_handle_t openavbTLPoolCreate(U32 workers, U32 cpuMask, U32 rtPriority);
+
+/** Stop the workers of a pool and free it.
+ *
+ * \param pool The handle returned from openavbTLPoolCreate()
+ * \return TRUE on success or FALSE if streams are still running on the pool
+ */
+bool openavbTLPoolDelete(tl_pool_handle_t pool);
+
+/** Run a talker or listener on a pool.
+ *
+ * Must be called between openavbTLOpen() and openavbTLConfigure().
+ * openavbTLRun() then hands the stream to the least loaded worker.
+ * Pooled streams have no AVDECC Msg support. Talkers configured with
+ * tx_blocking_in_intf or spin_wait still get their own thread.
+ *
+ * \param pool The handle returned from openavbTLPoolCreate()
+ * \param handle The handle return from openavbTLOpen()
+ * \return TRUE on success or FALSE on failure
+ */
+bool openavbTLPoolAttach(tl_pool_handle_t pool, tl_handle_t handle);
+
+/** Number of workers in a pool.
+ *
+ * \param pool The handle returned from openavbTLPoolCreate()
+ * \return worker count
+ */
+U32 openavbTLPoolWorkerCount(tl_pool_handle_t pool);
+
+/** Get the statistics of a pool worker.
+ *
+ * \param pool The handle returned from openavbTLPoolCreate()
+ * \param worker Index of the worker, less than openavbTLPoolWorkerCount()
+ * \param pStats Filled in with the statistics
+ * \return TRUE on success or FALSE on failure
+ */
+bool openavbTLPoolGetStats(tl_pool_handle_t pool, U32 worker, openavb_tl_pool_stats_t *pStats);
+
 
 /** \example openavb_host.c
  * Talker / Listener example host application.
@@ -0,0 +1,212 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Implementation for a basic hash map abstraction
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "openavb_debug.h"
+#include "openavb_hash.h"
+
+OPENAVB_CODE_MODULE_PRI
+
+#define HASH_MIN_BUCKETS	16
+
+struct openavb_hash_node {
+	struct openavb_hash_node *next;
+	void *data;
+	U32 hashVal;
+	U8 key[];
+};
+
+struct openavb_hash {
+	struct openavb_hash_node **buckets;
+	U32 bucketCount;	// always a power of 2
+	U32 count;
+	U32 keyLen;
+};
+
+// 32 bit FNV-1a
+static U32 x_hashKey(const void *key, U32 keyLen)
+{
+	const U8 *p = key;
+	U32 h = 2166136261u;
+	while (keyLen--) {
+		h ^= *p++;
+		h *= 16777619u;
+	}
+	return h;
+}
+
+static bool x_hashGrow(openavb_hash_t hash, U32 bucketCount)
+{
+	struct openavb_hash_node **buckets = calloc(bucketCount, sizeof(struct openavb_hash_node *));
+	if (!buckets) {
+		return FALSE;
+	}
+
+	U32 i;
+	for (i = 0; i < hash->bucketCount; i++) {
+		struct openavb_hash_node *node = hash->buckets[i];
+		while (node) {
+			struct openavb_hash_node *next = node->next;
+			U32 b = node->hashVal & (bucketCount - 1);
+			node->next = buckets[b];
+			buckets[b] = node;
+			node = next;
+		}
+	}
+
+	free(hash->buckets);
+	hash->buckets = buckets;
+	hash->bucketCount = bucketCount;
+	return TRUE;
+}
+
+static struct openavb_hash_node **x_hashFind(openavb_hash_t hash, const void *key, U32 hashVal)
+{
+	struct openavb_hash_node **pp = &hash->buckets[hashVal & (hash->bucketCount - 1)];
+	while (*pp) {
+		if ((*pp)->hashVal == hashVal && memcmp((*pp)->key, key, hash->keyLen) == 0) {
+			break;
+		}
+		pp = &(*pp)->next;
+	}
+	return pp;
+}
+
+openavb_hash_t openavbHashNew(U32 keyLen, U32 sizeHint)
+{
+	if (keyLen == 0) {
+		return NULL;
+	}
+
+	openavb_hash_t hash = calloc(1, sizeof(struct openavb_hash));
+	if (hash) {
+		U32 bucketCount = HASH_MIN_BUCKETS;
+		while (bucketCount < sizeHint && bucketCount < 0x80000000u) {
+			bucketCount <<= 1;
+		}
+		hash->keyLen = keyLen;
+		if (!x_hashGrow(hash, bucketCount)) {
+			free(hash);
+			hash = NULL;
+		}
+	}
+	return hash;
+}
+
+void openavbHashDelete(openavb_hash_t hash)
+{
+	if (hash) {
+		U32 i;
+		for (i = 0; i < hash->bucketCount; i++) {
+			struct openavb_hash_node *node = hash->buckets[i];
+			while (node) {
+				struct openavb_hash_node *next = node->next;
+				free(node);
+				node = next;
+			}
+		}
+		free(hash->buckets);
+		free(hash);
+	}
+}
+
+bool openavbHashPut(openavb_hash_t hash, const void *key, void *data)
+{
+	if (!hash || !key) {
+		return FALSE;
+	}
+
+	U32 hashVal = x_hashKey(key, hash->keyLen);
+	struct openavb_hash_node **pp = x_hashFind(hash, key, hashVal);
+	if (*pp) {
+		(*pp)->data = data;
+		return TRUE;
+	}
+
+	struct openavb_hash_node *node = malloc(sizeof(struct openavb_hash_node) + hash->keyLen);
+	if (!node) {
+		return FALSE;
+	}
+	node->data = data;
+	node->hashVal = hashVal;
+	memcpy(node->key, key, hash->keyLen);
+
+	// A failed grow only costs longer chains, so carry on regardless.
+	if (hash->count >= hash->bucketCount && hash->bucketCount < 0x80000000u) {
+		x_hashGrow(hash, hash->bucketCount << 1);
+	}
+
+	U32 b = hashVal & (hash->bucketCount - 1);
+	node->next = hash->buckets[b];
+	hash->buckets[b] = node;
+	hash->count++;
+	return TRUE;
+}
+
+void *openavbHashGet(openavb_hash_t hash, const void *key)
+{
+	if (!hash || !key) {
+		return NULL;
+	}
+
+	struct openavb_hash_node **pp = x_hashFind(hash, key, x_hashKey(key, hash->keyLen));
+	return *pp ? (*pp)->data : NULL;
+}
+
+void *openavbHashRemove(openavb_hash_t hash, const void *key)
+{
+	if (!hash || !key) {
+		return NULL;
+	}
+
+	struct openavb_hash_node **pp = x_hashFind(hash, key, x_hashKey(key, hash->keyLen));
+	struct openavb_hash_node *node = *pp;
+	if (!node) {
+		return NULL;
+	}
+
+	void *data = node->data;
+	*pp = node->next;
+	free(node);
+	hash->count--;
+	return data;
+}
+
+U32 openavbHashCount(openavb_hash_t hash)
+{
+	return hash ? hash->count : 0;
+}
@@ -0,0 +1,66 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Interface for a basic hash map abstraction
+* - Keys are fixed length byte strings, set when the map is created.
+* - Data elements are not managed; the caller owns them.
+* - Lookup, insert and remove are O(1) on average. The bucket table
+*   doubles when the element count exceeds it.
+* - Not thread safe; callers serialize access.
+*/
+
+#ifndef OPENAVB_HASH_H
+#define OPENAVB_HASH_H 1
+
+#include "openavb_types.h"
+
+typedef struct openavb_hash * openavb_hash_t;
+
+// Create a hash map for keys of keyLen bytes, presized for sizeHint elements. Returns NULL on failure.
+openavb_hash_t openavbHashNew(U32 keyLen, U32 sizeHint);
+
+// Delete a hash map. The data elements are not freed.
+void openavbHashDelete(openavb_hash_t hash);
+
+// Add a data element for key, replacing any existing element. Returns FALSE on failure.
+bool openavbHashPut(openavb_hash_t hash, const void *key, void *data);
+
+// Get the data element for key. Returns NULL if not found.
+void *openavbHashGet(openavb_hash_t hash, const void *key);
+
+// Remove the element for key. Returns the removed data element or NULL if not found.
+void *openavbHashRemove(openavb_hash_t hash, const void *key);
+
+// Returns the number of elements in the hash map.
+U32 openavbHashCount(openavb_hash_t hash);
+
+#endif // OPENAVB_HASH_H
@@ -36,12 +36,27 @@ https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
 #include <string.h>
 #include "openavb_queue.h"
 #include "openavb_tcal_pub.h"
+#include "openavb_trace_pub.h"
 
 #include "openavb_log.h"
 
+
+#if defined(__GNUC__)
+// Binary logging needs thread local storage, a thread exit hook and the gcc atomic builtins.
+#define LOG_BIN_SUPPORTED 1
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define LOG_BIN_TSC 1
+#endif
+#endif
+
 typedef struct {
 	U8 msg[LOG_QUEUE_MSG_SIZE];
   	bool bRT;						// TRUE = Details are in RT queue
+	U64 timestamp;					// Same time base as the binary records, to merge with them
 } log_queue_item_t;
 
 typedef struct {
@@ -65,14 +80,10 @@ static openavb_queue_t logRTQueue;
 static FILE *logOutputFd = NULL;
 
 static char msg[LOG_MSG_LEN] = "";
-static char time_msg[LOG_TIME_LEN] = "";
-static char timestamp_msg[LOG_TIMESTAMP_LEN] = "";
-static char file_msg[LOG_FILE_LEN] = "";
-static char proc_msg[LOG_PROC_LEN] = "";
-static char thread_msg[LOG_THREAD_LEN] = "";
 static char full_msg[LOG_FULL_MSG_LEN] = "";
 
-static char rt_msg[LOG_RT_MSG_LEN] = "";
+// Timestamp of the RT log chain being built in logRTQueue. Protected by gLogMutex.
+static U64 logRTTimestamp = 0;
 
 static bool loggingThreadRunning = false;
 extern void *loggingThreadFn(void *pv);
@@ -83,6 +94,134 @@ static MUTEX_HANDLE_ALT(gLogMutex);
 #define LOG_LOCK() MUTEX_LOCK_ALT(gLogMutex)
 #define LOG_UNLOCK() MUTEX_UNLOCK_ALT(gLogMutex)
 
+// Builds the complete output line for a message. nowNsec is the CLOCK_REALTIME the message was logged at.
+static void x_logCompose(char *pOut, const char *tag, const char *company, const char *component,
+	const char *path, int line, unsigned long threadId, U64 nowNsec, const char *pMsg)
+{
+	char time_msg[LOG_TIME_LEN] = "";
+	char timestamp_msg[LOG_TIMESTAMP_LEN] = "";
+	char file_msg[LOG_FILE_LEN] = "";
+	char proc_msg[LOG_PROC_LEN] = "";
+	char thread_msg[LOG_THREAD_LEN] = "";
+
+	if (OPENAVB_LOG_FILE_INFO && path) {
+		char* file = strrchr(path, '/');
+		if (!file)
+			file = strrchr(path, '\\');
+		if (file)
+			file += 1;
+		else
+			file = (char*)path;
+		snprintf(file_msg, LOG_FILE_LEN, " %s:%d", file, line);
+	}
+	if (OPENAVB_LOG_PROC_INFO) {
+		snprintf(proc_msg, LOG_PROC_LEN, " P:%5.5d", GET_PID());
+	}
+	if (OPENAVB_LOG_THREAD_INFO) {
+		snprintf(thread_msg, LOG_THREAD_LEN, " T:%lu", threadId);
+	}
+	if (OPENAVB_LOG_TIME_INFO) {
+		time_t tNow = nowNsec / NANOSECONDS_PER_SECOND;
+		struct tm tmNow;
+		localtime_r(&tNow, &tmNow);
+
+		snprintf(time_msg, LOG_TIME_LEN, "%2.2d:%2.2d:%2.2d", tmNow.tm_hour, tmNow.tm_min, tmNow.tm_sec);
+	}
+	if (OPENAVB_LOG_TIMESTAMP_INFO) {
+		snprintf(timestamp_msg, LOG_TIMESTAMP_LEN, "%lu:%09lu",
+			(unsigned long)(nowNsec / NANOSECONDS_PER_SECOND), (unsigned long)(nowNsec % NANOSECONDS_PER_SECOND));
+	}
+
+	// using sprintf and puts allows using static buffers rather than heap.
+	if (OPENAVB_TCAL_LOG_EXTRA_NEWLINE)
+		/* S32 full_msg_len = */ snprintf(pOut, LOG_FULL_MSG_LEN, "[%s%s%s%s %s %s%s] %s: %s\n", time_msg, timestamp_msg, proc_msg, thread_msg, company, component, file_msg, tag, pMsg);
+	else
+		/* S32 full_msg_len = */ snprintf(pOut, LOG_FULL_MSG_LEN, "[%s%s%s%s %s %s%s] %s: %s", time_msg, timestamp_msg, proc_msg, thread_msg, company, component, file_msg, tag, pMsg);
+}
+
+static void x_logRTItemFill(log_rt_queue_item_t *pLogRTItem, bool bEnd, char *pFormat, log_rt_datatype_t dataType, void *pVar)
+{
+	pLogRTItem->bEnd = bEnd;
+	pLogRTItem->pFormat = pFormat;
+	pLogRTItem->dataType = dataType;
+
+	switch (pLogRTItem->dataType) {
+		case LOG_RT_DATATYPE_CONST_STR:
+			break;
+		case LOG_RT_DATATYPE_U16:
+			pLogRTItem->data.unsignedLongVar = *(U16 *)pVar;
+			break;
+		case LOG_RT_DATATYPE_S16:
+			pLogRTItem->data.signedLongVar = *(S16 *)pVar;
+			break;
+		case LOG_RT_DATATYPE_U32:
+			pLogRTItem->data.unsignedLongVar = *(U32 *)pVar;
+			break;
+		case LOG_RT_DATATYPE_S32:
+			pLogRTItem->data.signedLongVar = *(S32 *)pVar;
+			break;
+		case LOG_RT_DATATYPE_U64:
+			pLogRTItem->data.unsignedLongLongVar = *(U64 *)pVar;
+			break;
+		case LOG_RT_DATATYPE_S64:
+			pLogRTItem->data.signedLongLongVar = *(S64 *)pVar;
+			break;
+		case LOG_RT_DATATYPE_FLOAT:
+			pLogRTItem->data.floatVar = *(float *)pVar;
+			break;
+		default:
+			break;
+	}
+}
+
+// Appends the rendering of one RT item to pMsg.
+static void x_logRTItemRender(char *pMsg, size_t msgSize, const log_rt_queue_item_t *pLogRTItem)
+{
+	size_t len = strlen(pMsg);
+	char *pOut = pMsg + len;
+	size_t outLen = msgSize - len;
+
+	switch (pLogRTItem->dataType) {
+		case LOG_RT_DATATYPE_CONST_STR:
+			snprintf(pOut, outLen, "%s", pLogRTItem->pFormat);
+			break;
+		case LOG_RT_DATATYPE_NOW_TS:
+			snprintf(pOut, outLen, "[%lu:%09lu] ", pLogRTItem->data.nowTS.tv_sec, pLogRTItem->data.nowTS.tv_nsec);
+			break;
+		case LOG_RT_DATATYPE_U16:
+			snprintf(pOut, outLen, pLogRTItem->pFormat, pLogRTItem->data.unsignedShortVar);
+			break;
+		case LOG_RT_DATATYPE_S16:
+			snprintf(pOut, outLen, pLogRTItem->pFormat, pLogRTItem->data.signedShortVar);
+			break;
+		case LOG_RT_DATATYPE_U32:
+			snprintf(pOut, outLen, pLogRTItem->pFormat, pLogRTItem->data.unsignedLongVar);
+			break;
+		case LOG_RT_DATATYPE_S32:
+			snprintf(pOut, outLen, pLogRTItem->pFormat, pLogRTItem->data.signedLongVar);
+			break;
+		case LOG_RT_DATATYPE_U64:
+			snprintf(pOut, outLen, pLogRTItem->pFormat, pLogRTItem->data.unsignedLongLongVar);
+			break;
+		case LOG_RT_DATATYPE_S64:
+			snprintf(pOut, outLen, pLogRTItem->pFormat, pLogRTItem->data.signedLongLongVar);
+			break;
+		case LOG_RT_DATATYPE_FLOAT:
+			snprintf(pOut, outLen, pLogRTItem->pFormat, pLogRTItem->data.floatVar);
+			break;
+		default:
+			break;
+	}
+
+	if (pLogRTItem->bEnd && OPENAVB_TCAL_LOG_EXTRA_NEWLINE) {
+		len = strlen(pMsg);
+		if (len + 1 < msgSize) {
+			pMsg[len] = '\n';
+			pMsg[len + 1] = 0x00;
+		}
+	}
+}
+
 void avbLogRTRender(log_queue_item_t *pLogItem)
 {
 	if (logRTQueue) {
@@ -92,59 +231,702 @@ void avbLogRTRender(log_queue_item_t *pLogItem)
 			openavb_queue_elem_t elem = openavbQueueTailLock(logRTQueue);
 			if (elem) {
 				log_rt_queue_item_t *pLogRTItem = (log_rt_queue_item_t *)openavbQueueData(elem);
-								
-				switch (pLogRTItem->dataType) {
-					case LOG_RT_DATATYPE_CONST_STR:
-						strcat((char *)pLogItem->msg, pLogRTItem->pFormat);
-						break;
-					case LOG_RT_DATATYPE_NOW_TS:
-						snprintf(rt_msg, LOG_RT_MSG_LEN, "[%lu:%09lu] ", pLogRTItem->data.nowTS.tv_sec, pLogRTItem->data.nowTS.tv_nsec);
-						strcat((char *)pLogItem->msg, rt_msg);
-						break;
-					case LOG_RT_DATATYPE_U16:
-						snprintf(rt_msg, LOG_RT_MSG_LEN, pLogRTItem->pFormat, pLogRTItem->data.unsignedShortVar);
-						strcat((char *)pLogItem->msg, rt_msg);
-						break;
-					case LOG_RT_DATATYPE_S16:
-						snprintf(rt_msg, LOG_RT_MSG_LEN, pLogRTItem->pFormat, pLogRTItem->data.signedShortVar);
-						strcat((char *)pLogItem->msg, rt_msg);
-						break;
-					case LOG_RT_DATATYPE_U32:
-						snprintf(rt_msg, LOG_RT_MSG_LEN, pLogRTItem->pFormat, pLogRTItem->data.unsignedLongVar);
-						strcat((char *)pLogItem->msg, rt_msg);
-						break;
-					case LOG_RT_DATATYPE_S32:
-						snprintf(rt_msg, LOG_RT_MSG_LEN, pLogRTItem->pFormat, pLogRTItem->data.signedLongVar);
-						strcat((char *)pLogItem->msg, rt_msg);
-						break;
-					case LOG_RT_DATATYPE_U64:
-						snprintf(rt_msg, LOG_RT_MSG_LEN, pLogRTItem->pFormat, pLogRTItem->data.unsignedLongLongVar);
-						strcat((char *)pLogItem->msg, rt_msg);
-						break;
-					case LOG_RT_DATATYPE_S64:
-						snprintf(rt_msg, LOG_RT_MSG_LEN, pLogRTItem->pFormat, pLogRTItem->data.signedLongLongVar);
-						strcat((char *)pLogItem->msg, rt_msg);
-						break;
-					case LOG_RT_DATATYPE_FLOAT:
-						snprintf(rt_msg, LOG_RT_MSG_LEN, pLogRTItem->pFormat, pLogRTItem->data.floatVar);
-						strcat((char *)pLogItem->msg, rt_msg);
-						break;
-					default:
-						break;
-				}
+
+				x_logRTItemRender((char *)pLogItem->msg, LOG_QUEUE_MSG_SIZE, pLogRTItem);
 
 				if (pLogRTItem->bEnd) {
-					if (OPENAVB_TCAL_LOG_EXTRA_NEWLINE)
-						strcat((char *)pLogItem->msg, "\n");
 					bMore = FALSE;
 				}
 				openavbQueueTailPull(logRTQueue);
 			}
-		  
+
+		}
+	}
+}
+
+#if LOG_BIN_SUPPORTED
+// Binary logging. Each thread that logs owns a single producer / single consumer ring of binary
+// records. The caller only captures the format pointer, the raw argument values (and copies of %s
+// strings) and a timestamp. All formatting is deferred to the logging thread which merges the
+// rings in timestamp order. Messages that can not be captured use the locked msg queue instead.
+
+#define LOG_BIN_ALIGN(x)		(((x) + 7) & ~7)
+#define LOG_BIN_MAX_SPEC_LEN	31
+
+typedef enum {
+	LOG_BIN_REC_PAD,					// Skip to the end of the ring
+	LOG_BIN_REC_FN,						// avbLogFn() message
+	LOG_BIN_REC_RT,						// avbLogRT() chain
+} log_bin_rec_kind_t;
+
+typedef enum {
+	LOG_BIN_ARG_NONE,					// %%
+	LOG_BIN_ARG_INT,
+	LOG_BIN_ARG_LONG,
+	LOG_BIN_ARG_LLONG,
+	LOG_BIN_ARG_SIZE,
+	LOG_BIN_ARG_PTR,
+	LOG_BIN_ARG_DOUBLE,
+	LOG_BIN_ARG_LDOUBLE,				// Captured and rendered as a double
+	LOG_BIN_ARG_STR,
+	LOG_BIN_ARG_UNSUPPORTED,
+} log_bin_arg_type_t;
+
+// Record header. LOG_BIN_REC_FN is followed by one log_bin_arg_t per conversion in pFormat and
+// then the copies of the %s strings. LOG_BIN_REC_RT is followed by argCount log_rt_queue_item_t.
+typedef struct {
+	U32 size;							// Bytes including this header. Always a multiple of 8
+	U16 kind;
+	U16 argCount;
+	U64 timestamp;
+	unsigned long threadId;
+	const char *pFormat;
+	const char *pTag;
+	const char *pCompany;
+	const char *pComponent;
+	const char *pPath;
+	S32 line;
+} log_bin_rec_t;
+
+typedef union {
+	U64 u;								// Integers, pointers and offset of a string copy
+	double d;
+} log_bin_arg_t;
+
+typedef struct log_bin_ring {
+	struct log_bin_ring *pNext;
+	U8 *pBuf;
+	volatile U32 inUse;
+
+	// Owning thread
+	volatile U32 head;
+	U32 tailCache;
+	volatile U32 dropped;
+	U32 rtCount;
+	U64 rtTimestamp;
+	log_rt_queue_item_t rtItems[LOG_BIN_RT_ITEM_CNT];
+
+	// Logging thread. Kept off the cache line of head.
+	U8 pad[64];
+	volatile U32 tail;
+	U32 droppedReported;
+} log_bin_ring_t;
+
+static log_bin_ring_t *volatile logBinRings = NULL;
+static __thread log_bin_ring_t *pLogBinThreadRing = NULL;
+static pthread_key_t logBinThreadKey;
+static bool logBinReady = FALSE;
+
+// Timestamp calibration. Timestamps are raw TSC ticks where available otherwise CLOCK_REALTIME nsec.
+static U64 logBinTicks0;
+static U64 logBinNsec0;
+static double logBinNsecPerTick = 1.0;
+
+static inline U32 x_binLoad(volatile U32 *pVal)
+{
+	U32 val = *pVal;
+	__sync_synchronize();
+	return val;
+}
+
+static inline void x_binStore(volatile U32 *pVal, U32 val)
+{
+	__sync_synchronize();
+	*pVal = val;
+}
+
+static inline U64 x_binTimestamp(void)
+{
+#if LOG_BIN_TSC
+	return __rdtsc();
+#else
+	U64 nowNsec = 0;
+	CLOCK_GETTIME64(OPENAVB_CLOCK_REALTIME, &nowNsec);
+	return nowNsec;
+#endif
+}
+
+static void x_binCalibrate(void)
+{
+#if LOG_BIN_TSC
+	U64 nowNsec = 0;
+	CLOCK_GETTIME64(OPENAVB_CLOCK_REALTIME, &nowNsec);
+	U64 nowTicks = __rdtsc();
+
+	if (nowNsec > logBinNsec0 && nowTicks > logBinTicks0) {
+		logBinNsecPerTick = (double)(nowNsec - logBinNsec0) / (double)(nowTicks - logBinTicks0);
+	}
+#endif
+}
+
+static U64 x_binNsec(U64 timestamp)
+{
+	return logBinNsec0 + (S64)((double)(S64)(timestamp - logBinTicks0) * logBinNsecPerTick);
+}
+
+static void x_binThreadExit(void *pv)
+{
+	log_bin_ring_t *pRing = (log_bin_ring_t *)pv;
+
+	// Records still in the ring are output as usual. The ring is reused by the next new thread.
+	pLogBinThreadRing = NULL;
+	pRing->rtCount = 0;
+	x_binStore(&pRing->inUse, 0);
+}
+
+static log_bin_ring_t *x_binThreadRing(void)
+{
+	log_bin_ring_t *pRing = pLogBinThreadRing;
+	if (pRing || !logBinReady) {
+		return pRing;
+	}
+
+	for (pRing = logBinRings; pRing; pRing = pRing->pNext) {
+		if (!pRing->inUse && __sync_bool_compare_and_swap(&pRing->inUse, 0, 1)) {
+			break;
+		}
+	}
+
+	if (!pRing) {
+		pRing = calloc(1, sizeof(log_bin_ring_t));
+		if (!pRing) {
+			return NULL;
+		}
+		pRing->pBuf = malloc(LOG_BIN_RING_SIZE);
+		if (!pRing->pBuf) {
+			free(pRing);
+			return NULL;
+		}
+		pRing->inUse = 1;
+		do {
+			pRing->pNext = logBinRings;
+		} while (!__sync_bool_compare_and_swap(&logBinRings, pRing->pNext, pRing));
+	}
+
+	pRing->tailCache = x_binLoad(&pRing->tail);
+	pthread_setspecific(logBinThreadKey, pRing);
+	pLogBinThreadRing = pRing;
+	return pRing;
+}
+
+// Reserves contiguous space for a record of size bytes. Returns NULL if the ring is full.
+// *pNewHead is the head to publish with x_binCommit().
+static log_bin_rec_t *x_binReserve(log_bin_ring_t *pRing, U32 size, U32 *pNewHead)
+{
+	U32 head = pRing->head;
+	U32 offset = head & (LOG_BIN_RING_SIZE - 1);
+	U32 toEnd = LOG_BIN_RING_SIZE - offset;
+	U32 needed = size > toEnd ? size + toEnd : size;
+
+	if (LOG_BIN_RING_SIZE - (head - pRing->tailCache) < needed) {
+		pRing->tailCache = x_binLoad(&pRing->tail);
+		if (LOG_BIN_RING_SIZE - (head - pRing->tailCache) < needed) {
+			pRing->dropped++;
+			return NULL;
+		}
+	}
+
+	if (size > toEnd) {
+		log_bin_rec_t *pPad = (log_bin_rec_t *)(pRing->pBuf + offset);
+		pPad->size = toEnd;
+		pPad->kind = LOG_BIN_REC_PAD;
+		offset = 0;
+	}
+
+	*pNewHead = head + needed;
+	return (log_bin_rec_t *)(pRing->pBuf + offset);
+}
+
+static inline void x_binCommit(log_bin_ring_t *pRing, U32 newHead)
+{
+	x_binStore(&pRing->head, newHead);
+}
+
+// Parses the conversion following a '%'. *ppFmt is advanced past the conversion.
+static log_bin_arg_type_t x_binParseSpec(const char **ppFmt)
+{
+	const char *p = *ppFmt;
+	int lenMod = 0;
+
+	if (*p == '%') {
+		*ppFmt = p + 1;
+		return LOG_BIN_ARG_NONE;
+	}
+
+	while (*p && strchr("-+ #0'", *p)) {
+		p++;
+	}
+	while (*p >= '0' && *p <= '9') {
+		p++;
+	}
+	if (*p == '.') {
+		p++;
+		while (*p >= '0' && *p <= '9') {
+			p++;
 		}
 	}
+
+	// Positional (%1$d) and '*' width or precision take arguments out of order.
+	if (*p == '$' || *p == '*') {
+		return LOG_BIN_ARG_UNSUPPORTED;
+	}
+
+	switch (*p) {
+		case 'h':
+			if (*++p == 'h') {
+				p++;
+			}
+			break;
+		case 'l':
+			lenMod = 'l';
+			if (*++p == 'l') {
+				lenMod = 'q';
+				p++;
+			}
+			break;
+		case 'q':
+		case 'j':
+			lenMod = 'q';
+			p++;
+			break;
+		case 'z':
+		case 't':
+			lenMod = 'z';
+			p++;
+			break;
+		case 'L':
+			lenMod = 'L';
+			p++;
+			break;
+	}
+
+	char conversion = *p;
+	if (!conversion) {
+		return LOG_BIN_ARG_UNSUPPORTED;
+	}
+	*ppFmt = p + 1;
+
+	switch (conversion) {
+		case 'd':
+		case 'i':
+		case 'o':
+		case 'u':
+		case 'x':
+		case 'X':
+			if (lenMod == 'l') {
+				return LOG_BIN_ARG_LONG;
+			}
+			if (lenMod == 'q' || lenMod == 'L') {
+				return LOG_BIN_ARG_LLONG;
+			}
+			if (lenMod == 'z') {
+				return LOG_BIN_ARG_SIZE;
+			}
+			return LOG_BIN_ARG_INT;
+		case 'c':
+			return LOG_BIN_ARG_INT;
+		case 'e':
+		case 'E':
+		case 'f':
+		case 'F':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			return lenMod == 'L' ? LOG_BIN_ARG_LDOUBLE : LOG_BIN_ARG_DOUBLE;
+		case 's':
+			return lenMod == 'l' ? LOG_BIN_ARG_UNSUPPORTED : LOG_BIN_ARG_STR;
+		case 'p':
+			return LOG_BIN_ARG_PTR;
+		default:
+			return LOG_BIN_ARG_UNSUPPORTED;
+	}
 }
 
+static bool x_binLogFn(const char *tag, const char *company, const char *component, const char *path, int line, const char *fmt, va_list args)
+{
+	log_bin_ring_t *pRing = x_binThreadRing();
+	if (!pRing) {
+		return FALSE;
+	}
+
+	U64 timestamp = x_binTimestamp();
+	log_bin_arg_t argVals[LOG_BIN_MAX_ARGS];
+	const char *pStrs[LOG_BIN_MAX_ARGS];
+	U32 strLens[LOG_BIN_MAX_ARGS];
+	U32 argCount = 0;
+	U32 strBytes = 0;
+	const char *p = fmt;
+
+	va_list ap;
+	va_copy(ap, args);
+	while ((p = strchr(p, '%')) != NULL) {
+		const char *pSpec = p++;
+		log_bin_arg_type_t argType = x_binParseSpec(&p);
+
+		if (argType == LOG_BIN_ARG_UNSUPPORTED || p - pSpec > LOG_BIN_MAX_SPEC_LEN
+			|| (argType != LOG_BIN_ARG_NONE && argCount >= LOG_BIN_MAX_ARGS)) {
+			va_end(ap);
+			return FALSE;
+		}
+
+		if (argType == LOG_BIN_ARG_NONE) {
+			continue;
+		}
+
+		pStrs[argCount] = NULL;
+		switch (argType) {
+			case LOG_BIN_ARG_INT:
+				argVals[argCount].u = (U64)(S64)va_arg(ap, int);
+				break;
+			case LOG_BIN_ARG_LONG:
+				argVals[argCount].u = (U64)(S64)va_arg(ap, long);
+				break;
+			case LOG_BIN_ARG_LLONG:
+				argVals[argCount].u = (U64)va_arg(ap, long long);
+				break;
+			case LOG_BIN_ARG_SIZE:
+				argVals[argCount].u = (U64)va_arg(ap, size_t);
+				break;
+			case LOG_BIN_ARG_PTR:
+				argVals[argCount].u = (U64)(uintptr_t)va_arg(ap, void *);
+				break;
+			case LOG_BIN_ARG_DOUBLE:
+				argVals[argCount].d = va_arg(ap, double);
+				break;
+			case LOG_BIN_ARG_LDOUBLE:
+				argVals[argCount].d = (double)va_arg(ap, long double);
+				break;
+			case LOG_BIN_ARG_STR:
+				pStrs[argCount] = va_arg(ap, const char *);
+				if (!pStrs[argCount]) {
+					pStrs[argCount] = "(null)";
+				}
+				strLens[argCount] = strnlen(pStrs[argCount], LOG_BIN_MAX_STR_LEN);
+				strBytes += strLens[argCount] + 1;
+				break;
+			default:
+				break;
+		}
+		argCount++;
+	}
+	va_end(ap);
+
+	U32 size = LOG_BIN_ALIGN(sizeof(log_bin_rec_t) + argCount * sizeof(log_bin_arg_t) + strBytes);
+	U32 newHead;
+	log_bin_rec_t *pRec = x_binReserve(pRing, size, &newHead);
+	if (!pRec) {
+		// Dropped and counted. The logging thread reports it.
+		return TRUE;
+	}
+
+	pRec->size = size;
+	pRec->kind = LOG_BIN_REC_FN;
+	pRec->argCount = argCount;
+	pRec->timestamp = timestamp;
+	pRec->threadId = THREAD_SELF();
+	pRec->pFormat = fmt;
+	pRec->pTag = tag;
+	pRec->pCompany = company;
+	pRec->pComponent = component;
+	pRec->pPath = path;
+	pRec->line = line;
+
+	log_bin_arg_t *pArgs = (log_bin_arg_t *)(pRec + 1);
+	U32 strOffset = sizeof(log_bin_rec_t) + argCount * sizeof(log_bin_arg_t);
+	U32 i1;
+	for (i1 = 0; i1 < argCount; i1++) {
+		if (pStrs[i1]) {
+			memcpy((U8 *)pRec + strOffset, pStrs[i1], strLens[i1]);
+			((U8 *)pRec)[strOffset + strLens[i1]] = 0x00;
+			pArgs[i1].u = strOffset;
+			strOffset += strLens[i1] + 1;
+		}
+		else {
+			pArgs[i1] = argVals[i1];
+		}
+	}
+
+	x_binCommit(pRing, newHead);
+	return TRUE;
+}
+
+static bool x_binLogRT(bool bBegin, bool bItem, bool bEnd, char *pFormat, log_rt_datatype_t dataType, void *pVar)
+{
+	log_bin_ring_t *pRing = bBegin ? x_binThreadRing() : pLogBinThreadRing;
+	if (!pRing) {
+		return FALSE;
+	}
+
+	if (bBegin) {
+		pRing->rtTimestamp = x_binTimestamp();
+		x_logRTItemFill(&pRing->rtItems[0], FALSE, NULL, LOG_RT_DATATYPE_NOW_TS, NULL);
+		pRing->rtCount = 1;
+	}
+	else if (!pRing->rtCount) {
+		// Chain was started on the locked path
+		return FALSE;
+	}
+
+	if (bItem || bEnd) {
+		if (pRing->rtCount < LOG_BIN_RT_ITEM_CNT) {
+			if (bItem)
+				x_logRTItemFill(&pRing->rtItems[pRing->rtCount++], bEnd, pFormat, dataType, pVar);
+			else
+				x_logRTItemFill(&pRing->rtItems[pRing->rtCount++], TRUE, NULL, LOG_RT_DATATYPE_NONE, NULL);
+		}
+	}
+
+	if (bEnd) {
+		U32 itemCount = pRing->rtCount;
+		U32 size = LOG_BIN_ALIGN(sizeof(log_bin_rec_t) + itemCount * sizeof(log_rt_queue_item_t));
+		U32 newHead;
+
+		pRing->rtItems[itemCount - 1].bEnd = TRUE;
+		pRing->rtCount = 0;
+
+		log_bin_rec_t *pRec = x_binReserve(pRing, size, &newHead);
+		if (pRec) {
+			pRec->size = size;
+			pRec->kind = LOG_BIN_REC_RT;
+			pRec->argCount = itemCount;
+			pRec->timestamp = pRing->rtTimestamp;
+			pRec->threadId = THREAD_SELF();
+			memcpy(pRec + 1, pRing->rtItems, itemCount * sizeof(log_rt_queue_item_t));
+			x_binCommit(pRing, newHead);
+		}
+	}
+
+	return TRUE;
+}
+
+static void x_binRenderFormat(const log_bin_rec_t *pRec, char *pOut, size_t outLen)
+{
+	const log_bin_arg_t *pArgs = (const log_bin_arg_t *)(pRec + 1);
+	const char *p = pRec->pFormat;
+	char spec[LOG_BIN_MAX_SPEC_LEN + 1];
+	size_t pos = 0;
+	U32 argIdx = 0;
+
+	while (*p && pos < outLen - 1) {
+		if (*p != '%') {
+			pOut[pos++] = *p++;
+			continue;
+		}
+
+		const char *pSpec = p++;
+		log_bin_arg_type_t argType = x_binParseSpec(&p);
+		size_t specLen = 0;
+		for (; pSpec < p; pSpec++) {
+			if (*pSpec != 'L') {
+				spec[specLen++] = *pSpec;
+			}
+		}
+		spec[specLen] = 0x00;
+
+		char *pDst = pOut + pos;
+		size_t dstLen = outLen - pos;
+		int written = 0;
+		switch (argType) {
+			case LOG_BIN_ARG_NONE:
+				pOut[pos++] = '%';
+				continue;
+			case LOG_BIN_ARG_INT:
+				written = snprintf(pDst, dstLen, spec, (int)pArgs[argIdx].u);
+				break;
+			case LOG_BIN_ARG_LONG:
+				written = snprintf(pDst, dstLen, spec, (long)pArgs[argIdx].u);
+				break;
+			case LOG_BIN_ARG_LLONG:
+				written = snprintf(pDst, dstLen, spec, (long long)pArgs[argIdx].u);
+				break;
+			case LOG_BIN_ARG_SIZE:
+				written = snprintf(pDst, dstLen, spec, (size_t)pArgs[argIdx].u);
+				break;
+			case LOG_BIN_ARG_PTR:
+				written = snprintf(pDst, dstLen, spec, (void *)(uintptr_t)pArgs[argIdx].u);
+				break;
+			case LOG_BIN_ARG_DOUBLE:
+			case LOG_BIN_ARG_LDOUBLE:
+				written = snprintf(pDst, dstLen, spec, pArgs[argIdx].d);
+				break;
+			case LOG_BIN_ARG_STR:
+				written = snprintf(pDst, dstLen, spec, (const char *)pRec + pArgs[argIdx].u);
+				break;
+			default:
+				break;
+		}
+		argIdx++;
+
+		if (written > 0) {
+			pos += written;
+			if (pos > outLen - 1) {
+				pos = outLen - 1;
+			}
+		}
+	}
+	pOut[pos] = 0x00;
+}
+
+static void x_binRender(const log_bin_rec_t *pRec, char *pOut)
+{
+	U64 nowNsec = x_binNsec(pRec->timestamp);
+
+	if (pRec->kind == LOG_BIN_REC_FN) {
+		char binMsg[LOG_MSG_LEN];
+		x_binRenderFormat(pRec, binMsg, LOG_MSG_LEN);
+		x_logCompose(pOut, pRec->pTag, pRec->pCompany, pRec->pComponent, pRec->pPath, pRec->line, pRec->threadId, nowNsec, binMsg);
+	}
+	else {
+		const log_rt_queue_item_t *pItems = (const log_rt_queue_item_t *)(pRec + 1);
+		U32 i1;
+
+		pOut[0] = 0x00;
+		for (i1 = 0; i1 < pRec->argCount; i1++) {
+			log_rt_queue_item_t item = pItems[i1];
+			if (item.dataType == LOG_RT_DATATYPE_NOW_TS) {
+				item.data.nowTS.tv_sec = nowNsec / NANOSECONDS_PER_SECOND;
+				item.data.nowTS.tv_nsec = nowNsec % NANOSECONDS_PER_SECOND;
+			}
+			x_logRTItemRender(pOut, LOG_FULL_MSG_LEN, &item);
+		}
+	}
+}
+
+// Returns the oldest record of the ring or NULL if it is empty.
+static log_bin_rec_t *x_binPeek(log_bin_ring_t *pRing)
+{
+	while (TRUE) {
+		U32 tail = pRing->tail;
+		if (tail == x_binLoad(&pRing->head)) {
+			return NULL;
+		}
+
+		log_bin_rec_t *pRec = (log_bin_rec_t *)(pRing->pBuf + (tail & (LOG_BIN_RING_SIZE - 1)));
+		if (pRec->kind != LOG_BIN_REC_PAD) {
+			return pRec;
+		}
+		x_binStore(&pRing->tail, tail + pRec->size);
+	}
+}
+
+// Outputs the queued records of all threads and the messages of the msg queue in timestamp order.
+// Returns TRUE if anything was output.
+static bool x_binDrain(void)
+{
+	char binFullMsg[LOG_FULL_MSG_LEN];
+	log_bin_ring_t *pRing;
+	bool bOutput = FALSE;
+
+	x_binCalibrate();
+
+	while (TRUE) {
+		log_bin_ring_t *pOldestRing = NULL;
+		log_bin_rec_t *pOldestRec = NULL;
+
+		for (pRing = logBinRings; pRing; pRing = pRing->pNext) {
+			log_bin_rec_t *pRec = x_binPeek(pRing);
+			if (pRec && (!pOldestRec || (S64)(pRec->timestamp - pOldestRec->timestamp) < 0)) {
+				pOldestRing = pRing;
+				pOldestRec = pRec;
+			}
+		}
+
+		// Messages that could not be captured are interleaved by the time they were logged at.
+		openavb_queue_elem_t elem = logQueue ? openavbQueueTailLock(logQueue) : NULL;
+		if (elem) {
+			log_queue_item_t *pLogItem = (log_queue_item_t *)openavbQueueData(elem);
+			if (!pOldestRec || (S64)(pLogItem->timestamp - pOldestRec->timestamp) <= 0) {
+				if (pLogItem->bRT)
+					avbLogRTRender(pLogItem);
+
+				fputs((const char *)pLogItem->msg, logOutputFd);
+				openavbQueueTailPull(logQueue);
+				bOutput = TRUE;
+				continue;
+			}
+			openavbQueueTailUnlock(logQueue);
+		}
+
+		if (!pOldestRec) {
+			break;
+		}
+
+		x_binRender(pOldestRec, binFullMsg);
+		x_binStore(&pOldestRing->tail, pOldestRing->tail + pOldestRec->size);
+
+		fputs(binFullMsg, logOutputFd);
+		bOutput = TRUE;
+	}
+
+	for (pRing = logBinRings; pRing; pRing = pRing->pNext) {
+		U32 dropped = x_binLoad(&pRing->dropped);
+		if (dropped != pRing->droppedReported) {
+			char dropMsg[LOG_MSG_LEN];
+			U64 nowNsec = 0;
+			CLOCK_GETTIME64(OPENAVB_CLOCK_REALTIME, &nowNsec);
+			snprintf(dropMsg, LOG_MSG_LEN, "Log ring full, %u messages dropped\n", dropped - pRing->droppedReported);
+			x_logCompose(binFullMsg, "WARNING", AVB_LOG_COMPANY, "Log", NULL, 0, 0, nowNsec, dropMsg);
+			fputs(binFullMsg, logOutputFd);
+			pRing->droppedReported = dropped;
+			bOutput = TRUE;
+		}
+	}
+
+	return bOutput;
+}
+
+static void x_binInit(void)
+{
+	if (logBinReady || !OPENAVB_LOG_FROM_THREAD || OPENAVB_LOG_PULL_MODE) {
+		return;
+	}
+	if (pthread_key_create(&logBinThreadKey, x_binThreadExit) != 0) {
+		return;
+	}
+
+	logBinTicks0 = x_binTimestamp();
+	CLOCK_GETTIME64(OPENAVB_CLOCK_REALTIME, &logBinNsec0);
+#if !LOG_BIN_TSC
+	logBinTicks0 = logBinNsec0;
+#endif
+	logBinReady = TRUE;
+}
+
+// Timestamp of a msg queue item
+static U64 x_binQueueTimestamp(void)
+{
+	return logBinReady ? x_binTimestamp() : 0;
+}
+
+#else // LOG_BIN_SUPPORTED
+
+static bool x_binLogFn(const char *tag, const char *company, const char *component, const char *path, int line, const char *fmt, va_list args)
+{
+	return FALSE;
+}
+
+static bool x_binLogRT(bool bBegin, bool bItem, bool bEnd, char *pFormat, log_rt_datatype_t dataType, void *pVar)
+{
+	return FALSE;
+}
+
+static bool x_binDrain(void)
+{
+	return FALSE;
+}
+
+static void x_binInit(void)
+{
+}
+
+static U64 x_binQueueTimestamp(void)
+{
+	return 0;
+}
+
+#endif // LOG_BIN_SUPPORTED
+
 extern U32 DLL_EXPORT avbLogGetMsg(U8 *pBuf, U32 bufSize)
 {
 	U32 dataLen = 0;
@@ -173,8 +955,10 @@ void *loggingThreadFn(void *pv)
 	do {
 		SLEEP_MSEC(LOG_QUEUE_SLEEP_MSEC);
 
+		avbTraceService();
+
 		bool more = TRUE;
-		bool flush = FALSE;
+		bool flush = x_binDrain();
 
 		while (more) {
 			more = FALSE;
@@ -220,6 +1004,7 @@ extern void DLL_EXPORT avbLogInitEx(FILE* file)
 	// Start the logging task
 	if (OPENAVB_LOG_FROM_THREAD) {
 		bool errResult;
+		x_binInit();
 		loggingThreadRunning = true;
 		THREAD_CREATE(loggingThread, loggingThread, NULL, loggingThreadFn, NULL);
 		THREAD_CHECK_ERROR(loggingThread, "Thread / task creation failed", errResult);
@@ -237,12 +1022,21 @@ extern void DLL_EXPORT avbLogExit()
 	if (OPENAVB_LOG_FROM_THREAD) {
 		loggingThreadRunning = false;
 		THREAD_JOIN(loggingThread, NULL);
+		x_binDrain();
 	}
 
 	fflush(logOutputFd);
 	logOutputFd = NULL;
 }
 
+// Errors logged by each thread, see avbLogErrorCount()
+static __thread U32 logErrorCount = 0;
+
+extern U32 DLL_EXPORT avbLogErrorCount(void)
+{
+	return logErrorCount;
+}
+
 extern void DLL_EXPORT avbLogFn(
 	int level, 
 	const char *tag, 
@@ -253,49 +1047,28 @@ extern void DLL_EXPORT avbLogFn(
 	const char *fmt, 
 	...)
 {
+	if (level == AVB_LOG_LEVEL_ERROR) {
+		logErrorCount++;
+	}
+
 	if (level <= AVB_LOG_LEVEL) {
 		va_list args;
 		va_start(args, fmt);
 
+		if (x_binLogFn(tag, company, component, path, line, fmt, args)) {
+			va_end(args);
+			return;
+		}
+
 		LOG_LOCK();
 
 		vsprintf(msg, fmt, args);
 
-		if (OPENAVB_LOG_FILE_INFO && path) {
-			char* file = strrchr(path, '/');
-			if (!file)
-				file = strrchr(path, '\\');
-			if (file)
-				file += 1;
-			else
-				file = (char*)path;
-			snprintf(file_msg, LOG_FILE_LEN, " %s:%d", file, line);
-		}
-		if (OPENAVB_LOG_PROC_INFO) {
-			snprintf(proc_msg, LOG_PROC_LEN, " P:%5.5d", GET_PID());
-		}
-		if (OPENAVB_LOG_THREAD_INFO) {
-			snprintf(thread_msg, LOG_THREAD_LEN, " T:%lu", THREAD_SELF());
-		}
-		if (OPENAVB_LOG_TIME_INFO) {
-			time_t tNow = time(NULL);
-			struct tm tmNow;
-			localtime_r(&tNow, &tmNow);
-
-			snprintf(time_msg, LOG_TIME_LEN, "%2.2d:%2.2d:%2.2d", tmNow.tm_hour, tmNow.tm_min, tmNow.tm_sec);
+		U64 nowNsec = 0;
+		if (OPENAVB_LOG_TIME_INFO || OPENAVB_LOG_TIMESTAMP_INFO) {
+			CLOCK_GETTIME64(OPENAVB_CLOCK_REALTIME, &nowNsec);
 		}
-		if (OPENAVB_LOG_TIMESTAMP_INFO) {
-			struct timespec nowTS;
-			CLOCK_GETTIME(OPENAVB_CLOCK_REALTIME, &nowTS);
-
-			snprintf(timestamp_msg, LOG_TIMESTAMP_LEN, "%lu:%09lu", nowTS.tv_sec, nowTS.tv_nsec);
-		}
-
-		// using sprintf and puts allows using static buffers rather than heap.
-		if (OPENAVB_TCAL_LOG_EXTRA_NEWLINE)
-			/* S32 full_msg_len = */ snprintf(full_msg, LOG_FULL_MSG_LEN, "[%s%s%s%s %s %s%s] %s: %s\n", time_msg, timestamp_msg, proc_msg, thread_msg, company, component, file_msg, tag, msg);
-		else
-			/* S32 full_msg_len = */ snprintf(full_msg, LOG_FULL_MSG_LEN, "[%s%s%s%s %s %s%s] %s: %s", time_msg, timestamp_msg, proc_msg, thread_msg, company, component, file_msg, tag, msg);
+		x_logCompose(full_msg, tag, company, component, path, line, THREAD_SELF(), nowNsec, msg);
 
 		if (!OPENAVB_LOG_FROM_THREAD && !OPENAVB_LOG_PULL_MODE) {
 			fputs(full_msg, logOutputFd);
@@ -307,6 +1080,7 @@ extern void DLL_EXPORT avbLogFn(
 				if (elem) {
 					log_queue_item_t *pLogItem = (log_queue_item_t *)openavbQueueData(elem);
 					pLogItem->bRT = FALSE;
+					pLogItem->timestamp = x_binQueueTimestamp();
 					strncpy((char *)pLogItem->msg, full_msg, LOG_QUEUE_MSG_LEN);
 					openavbQueueHeadPush(logQueue);
 				}
@@ -321,16 +1095,19 @@ extern void DLL_EXPORT avbLogFn(
 
 extern void DLL_EXPORT avbLogRT(int level, bool bBegin, bool bItem, bool bEnd, char *pFormat, log_rt_datatype_t dataType, void *pVar)
 {
+	if (x_binLogRT(bBegin, bItem, bEnd, pFormat, dataType, pVar)) {
+		return;
+	}
+
 	if (logRTQueue) {
 		if (bBegin) {
 			LOG_LOCK();
+			logRTTimestamp = x_binQueueTimestamp();
 
 			openavb_queue_elem_t elem = openavbQueueHeadLock(logRTQueue);
 			if (elem) {
 				log_rt_queue_item_t *pLogRTItem = (log_rt_queue_item_t *)openavbQueueData(elem);
-				pLogRTItem->bEnd = FALSE;
-				pLogRTItem->pFormat = NULL;
-				pLogRTItem->dataType = LOG_RT_DATATYPE_NOW_TS;
+				x_logRTItemFill(pLogRTItem, FALSE, NULL, LOG_RT_DATATYPE_NOW_TS, NULL);
 				CLOCK_GETTIME(OPENAVB_CLOCK_REALTIME, &pLogRTItem->data.nowTS);
 				openavbQueueHeadPush(logRTQueue);
 			}
@@ -340,40 +1117,7 @@ extern void DLL_EXPORT avbLogRT(int level, bool bBegin, bool bItem, bool bEnd, c
 			openavb_queue_elem_t elem = openavbQueueHeadLock(logRTQueue);
 			if (elem) {
 				log_rt_queue_item_t *pLogRTItem = (log_rt_queue_item_t *)openavbQueueData(elem);
-				if (bEnd)
-					pLogRTItem->bEnd = TRUE;
-				else
-					pLogRTItem->bEnd = FALSE;
-				pLogRTItem->pFormat = pFormat;
-				pLogRTItem->dataType = dataType;
-
-				switch (pLogRTItem->dataType) {
-					case LOG_RT_DATATYPE_CONST_STR:
-						break;
-					case LOG_RT_DATATYPE_U16:
-						pLogRTItem->data.unsignedLongVar = *(U16 *)pVar;
-						break;
-					case LOG_RT_DATATYPE_S16:
-						pLogRTItem->data.signedLongVar = *(S16 *)pVar;
-						break;
-					case LOG_RT_DATATYPE_U32:
-						pLogRTItem->data.unsignedLongVar = *(U32 *)pVar;
-						break;
-					case LOG_RT_DATATYPE_S32:
-						pLogRTItem->data.signedLongVar = *(S32 *)pVar;
-						break;
-					case LOG_RT_DATATYPE_U64:
-						pLogRTItem->data.unsignedLongLongVar = *(U64 *)pVar;
-						break;
-					case LOG_RT_DATATYPE_S64:
-						pLogRTItem->data.signedLongLongVar = *(S64 *)pVar;
-						break;
-					case LOG_RT_DATATYPE_FLOAT:
-						pLogRTItem->data.floatVar = *(float *)pVar;
-						break;
-					default:
-						break;
-				}
+				x_logRTItemFill(pLogRTItem, bEnd, pFormat, dataType, pVar);
 				openavbQueueHeadPush(logRTQueue);
 			}
 		}
@@ -382,9 +1126,7 @@ extern void DLL_EXPORT avbLogRT(int level, bool bBegin, bool bItem, bool bEnd, c
 			openavb_queue_elem_t elem = openavbQueueHeadLock(logRTQueue);
 			if (elem) {
 				log_rt_queue_item_t *pLogRTItem = (log_rt_queue_item_t *)openavbQueueData(elem);
-				pLogRTItem->bEnd = TRUE;
-				pLogRTItem->pFormat = NULL;
-				pLogRTItem->dataType = LOG_RT_DATATYPE_NONE;
+				x_logRTItemFill(pLogRTItem, TRUE, NULL, LOG_RT_DATATYPE_NONE, NULL);
 				openavbQueueHeadPush(logRTQueue);
 			}
 		}
@@ -395,6 +1137,7 @@ extern void DLL_EXPORT avbLogRT(int level, bool bBegin, bool bItem, bool bEnd, c
 				if (elem) {
 					log_queue_item_t *pLogItem = (log_queue_item_t *)openavbQueueData(elem);
 					pLogItem->bRT = TRUE;
+					pLogItem->timestamp = logRTTimestamp;
 					if (OPENAVB_LOG_FROM_THREAD) {
 						openavbQueueHeadPush(logQueue);
 					} else {
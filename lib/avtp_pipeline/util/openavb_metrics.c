@@ -0,0 +1,354 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Lock-free per-stream metrics registry.
+*
+* Groups live on a singly linked list which only ever grows. Labels are guarded by a sequence
+* count so a reader can take a consistent copy without ever blocking the stream that owns it.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "openavb_platform.h"
+#include "openavb_trace.h"
+#include "openavb_metrics.h"
+
+#define	AVB_LOG_COMPONENT	"Metrics"
+#include "openavb_log.h"
+
+typedef struct {
+	char stream[OPENAVB_METRICS_LABEL_LEN];
+	char role[OPENAVB_METRICS_LABEL_LEN];
+	char name[OPENAVB_METRICS_LABEL_LEN];
+	const openavb_metric_def_t *pDefs;
+	U32 count;
+	U64 values[OPENAVB_METRICS_MAX_VALUES];
+} metrics_snapshot_t;
+
+static openavb_metrics_group_t *volatile metricsGroups = NULL;
+
+static void x_metricsLabel(char *pDst, const char *pSrc)
+{
+	if (pSrc) {
+		strncpy(pDst, pSrc, OPENAVB_METRICS_LABEL_LEN - 1);
+		pDst[OPENAVB_METRICS_LABEL_LEN - 1] = '\0';
+	}
+	else {
+		pDst[0] = '\0';
+	}
+}
+
+openavb_metrics_group_t *openavbMetricsGroupOpen(const char *pStream, const char *pRole, const char *pName, const openavb_metric_def_t *pDefs, U32 count)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+	openavb_metrics_group_t *pGroup;
+	U32 i1;
+
+	if (!pDefs || count == 0 || count > OPENAVB_METRICS_MAX_VALUES) {
+		AVB_LOGF_ERROR("Invalid metrics group (count=%" PRIu32 ")", count);
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return NULL;
+	}
+
+	// Reuse a closed group if there is one.
+	for (pGroup = metricsGroups; pGroup; pGroup = pGroup->pNext) {
+		if (!pGroup->inUse && __sync_bool_compare_and_swap(&pGroup->inUse, 0, 1)) {
+			break;
+		}
+	}
+
+	bool bNew = FALSE;
+	if (!pGroup) {
+		pGroup = calloc(1, sizeof(openavb_metrics_group_t));
+		if (!pGroup) {
+			AVB_LOG_ERROR("Failed to allocate metrics group");
+			AVB_TRACE_EXIT(AVB_TRACE_TL);
+			return NULL;
+		}
+		pGroup->inUse = 1;
+		bNew = TRUE;
+	}
+
+	__sync_fetch_and_add(&pGroup->seq, 1);
+	__sync_synchronize();
+
+	x_metricsLabel(pGroup->stream, pStream);
+	x_metricsLabel(pGroup->role, pRole);
+	x_metricsLabel(pGroup->name, pName);
+	pGroup->pDefs = pDefs;
+	pGroup->count = count;
+	for (i1 = 0; i1 < OPENAVB_METRICS_MAX_VALUES; i1++) {
+		pGroup->values[i1] = 0;
+	}
+
+	__sync_synchronize();
+	__sync_fetch_and_add(&pGroup->seq, 1);
+
+	if (bNew) {
+		openavb_metrics_group_t *pHead;
+		do {
+			pHead = metricsGroups;
+			pGroup->pNext = pHead;
+		} while (!__sync_bool_compare_and_swap(&metricsGroups, pHead, pGroup));
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return pGroup;
+}
+
+void openavbMetricsGroupClose(openavb_metrics_group_t *pGroup)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+
+	if (pGroup) {
+		__sync_fetch_and_add(&pGroup->seq, 1);
+		__sync_synchronize();
+		pGroup->inUse = 0;
+		__sync_synchronize();
+		__sync_fetch_and_add(&pGroup->seq, 1);
+	}
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+}
+
+// Copy up to max open groups. Groups that change while being copied are left out.
+static int x_metricsSnapshot(metrics_snapshot_t *pSnaps, int max)
+{
+	openavb_metrics_group_t *pGroup;
+	int cnt = 0;
+
+	for (pGroup = metricsGroups; pGroup && cnt < max; pGroup = pGroup->pNext) {
+		metrics_snapshot_t *pSnap = &pSnaps[cnt];
+		U32 seq = pGroup->seq;
+		U32 i1;
+
+		__sync_synchronize();
+		if ((seq & 1) || !pGroup->inUse) {
+			continue;
+		}
+
+		memcpy(pSnap->stream, pGroup->stream, OPENAVB_METRICS_LABEL_LEN);
+		memcpy(pSnap->role, pGroup->role, OPENAVB_METRICS_LABEL_LEN);
+		memcpy(pSnap->name, pGroup->name, OPENAVB_METRICS_LABEL_LEN);
+		pSnap->pDefs = pGroup->pDefs;
+		pSnap->count = pGroup->count;
+		if (pSnap->count > OPENAVB_METRICS_MAX_VALUES) {
+			continue;
+		}
+		for (i1 = 0; i1 < pSnap->count; i1++) {
+			pSnap->values[i1] = __sync_add_and_fetch(&pGroup->values[i1], 0);
+		}
+
+		__sync_synchronize();
+		if (pGroup->seq != seq || !pGroup->inUse) {
+			continue;
+		}
+
+		pSnap->stream[OPENAVB_METRICS_LABEL_LEN - 1] = '\0';
+		pSnap->role[OPENAVB_METRICS_LABEL_LEN - 1] = '\0';
+		pSnap->name[OPENAVB_METRICS_LABEL_LEN - 1] = '\0';
+		cnt++;
+	}
+
+	return cnt;
+}
+
+static void x_metricsJsonString(FILE *pFile, const char *pStr)
+{
+	fputc('"', pFile);
+	for (; *pStr; pStr++) {
+		unsigned char c = *pStr;
+		if (c == '"' || c == '\\') {
+			fputc('\\', pFile);
+			fputc(c, pFile);
+		}
+		else if (c < 0x20) {
+			fprintf(pFile, "\\u%04x", c);
+		}
+		else {
+			fputc(c, pFile);
+		}
+	}
+	fputc('"', pFile);
+}
+
+static void x_metricsWriteJson(FILE *pFile, metrics_snapshot_t *pSnaps, int cnt)
+{
+	int i1;
+	U32 i2;
+
+	fputs("{\"streams\":[", pFile);
+	for (i1 = 0; i1 < cnt; i1++) {
+		metrics_snapshot_t *pSnap = &pSnaps[i1];
+
+		fputs(i1 ? ",\n{\"stream\":" : "\n{\"stream\":", pFile);
+		x_metricsJsonString(pFile, pSnap->stream);
+		fputs(",\"role\":", pFile);
+		x_metricsJsonString(pFile, pSnap->role);
+		fputs(",\"name\":", pFile);
+		x_metricsJsonString(pFile, pSnap->name);
+		fputs(",\"metrics\":{", pFile);
+		for (i2 = 0; i2 < pSnap->count; i2++) {
+			if (i2) {
+				fputc(',', pFile);
+			}
+			x_metricsJsonString(pFile, pSnap->pDefs[i2].pName);
+			fprintf(pFile, ":%" PRIu64, pSnap->values[i2]);
+		}
+		fputs("}}", pFile);
+	}
+	fputs("\n]}\n", pFile);
+}
+
+static void x_metricsPromLabel(FILE *pFile, const char *pLabel, const char *pStr)
+{
+	fprintf(pFile, "%s=\"", pLabel);
+	for (; *pStr; pStr++) {
+		if (*pStr == '"' || *pStr == '\\') {
+			fputc('\\', pFile);
+			fputc(*pStr, pFile);
+		}
+		else if (*pStr == '\n') {
+			fputs("\\n", pFile);
+		}
+		else {
+			fputc(*pStr, pFile);
+		}
+	}
+	fputc('"', pFile);
+}
+
+// Index of the named metric in a snapshot or -1.
+static int x_metricsFind(metrics_snapshot_t *pSnap, const openavb_metric_def_t *pDefs, U32 idx)
+{
+	U32 i1;
+
+	if (pSnap->pDefs == pDefs) {
+		return idx < pSnap->count ? (int)idx : -1;
+	}
+	for (i1 = 0; i1 < pSnap->count; i1++) {
+		if (strcmp(pSnap->pDefs[i1].pName, pDefs[idx].pName) == 0) {
+			return i1;
+		}
+	}
+	return -1;
+}
+
+// Prometheus wants all samples of a metric together under a single HELP and TYPE,
+// so walk the distinct metric names and pull that metric from every snapshot.
+static void x_metricsWritePrometheus(FILE *pFile, metrics_snapshot_t *pSnaps, int cnt)
+{
+	int i1, i2, i3;
+	U32 idx;
+
+	for (i1 = 0; i1 < cnt; i1++) {
+		const openavb_metric_def_t *pDefs = pSnaps[i1].pDefs;
+
+		// Each table only once
+		for (i2 = 0; i2 < i1; i2++) {
+			if (pSnaps[i2].pDefs == pDefs) {
+				break;
+			}
+		}
+		if (i2 < i1) {
+			continue;
+		}
+
+		for (idx = 0; idx < pSnaps[i1].count; idx++) {
+			const openavb_metric_def_t *pDef = &pDefs[idx];
+
+			// Each name only once, even if another table shares it
+			for (i2 = 0; i2 < i1; i2++) {
+				if (x_metricsFind(&pSnaps[i2], pDefs, idx) >= 0) {
+					break;
+				}
+			}
+			if (i2 < i1) {
+				continue;
+			}
+
+			fprintf(pFile, "# HELP " OPENAVB_METRICS_PREFIX "%s %s\n", pDef->pName, pDef->pHelp ? pDef->pHelp : pDef->pName);
+			fprintf(pFile, "# TYPE " OPENAVB_METRICS_PREFIX "%s %s\n", pDef->pName, pDef->type == OPENAVB_METRIC_COUNTER ? "counter" : "gauge");
+
+			for (i3 = i1; i3 < cnt; i3++) {
+				int found = x_metricsFind(&pSnaps[i3], pDefs, idx);
+				if (found < 0) {
+					continue;
+				}
+				fprintf(pFile, OPENAVB_METRICS_PREFIX "%s{", pDef->pName);
+				x_metricsPromLabel(pFile, "stream", pSnaps[i3].stream);
+				fputc(',', pFile);
+				x_metricsPromLabel(pFile, "role", pSnaps[i3].role);
+				fputc(',', pFile);
+				x_metricsPromLabel(pFile, "name", pSnaps[i3].name);
+				fprintf(pFile, "} %" PRIu64 "\n", pSnaps[i3].values[found]);
+			}
+		}
+	}
+}
+
+int openavbMetricsWrite(FILE *pFile, openavb_metrics_format_t format)
+{
+	AVB_TRACE_ENTRY(AVB_TRACE_TL);
+	openavb_metrics_group_t *pGroup;
+	int max = 0;
+
+	if (!pFile) {
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return 0;
+	}
+
+	for (pGroup = metricsGroups; pGroup; pGroup = pGroup->pNext) {
+		max++;
+	}
+
+	metrics_snapshot_t *pSnaps = calloc(max ? max : 1, sizeof(metrics_snapshot_t));
+	if (!pSnaps) {
+		AVB_LOG_ERROR("Failed to allocate metrics snapshot");
+		AVB_TRACE_EXIT(AVB_TRACE_TL);
+		return 0;
+	}
+
+	int cnt = x_metricsSnapshot(pSnaps, max);
+	if (format == OPENAVB_METRICS_FORMAT_JSON) {
+		x_metricsWriteJson(pFile, pSnaps, cnt);
+	}
+	else {
+		x_metricsWritePrometheus(pFile, pSnaps, cnt);
+	}
+
+	free(pSnaps);
+
+	AVB_TRACE_EXIT(AVB_TRACE_TL);
+	return cnt;
+}
@@ -0,0 +1,136 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Lock-free per-stream metrics registry.
+*
+* - Each talker or listener owns a group of counters and gauges described by a static table.
+* - Updates are atomic and never block, so they can be made from the streaming thread.
+* - Groups are never freed. A closed group is reused by the next stream that opens one.
+* - openavbMetricsWrite() formats every open group as JSON or Prometheus text.
+* - openavbMetricsServerStart() serves the same output on a local unix socket.
+*/
+
+#ifndef OPENAVB_METRICS_H
+#define OPENAVB_METRICS_H 1
+
+#include <stdio.h>
+#include "openavb_types.h"
+
+// Most metrics a single group can hold
+#define OPENAVB_METRICS_MAX_VALUES		16
+
+// Size of each label of a group
+#define OPENAVB_METRICS_LABEL_LEN		64
+
+// Prefix for all metric names in the Prometheus output
+#define OPENAVB_METRICS_PREFIX			"openavb_"
+
+// Default path of the export socket
+#define OPENAVB_METRICS_UNIX_PATH		"/tmp/avb_metrics"
+
+typedef enum {
+	// Monotonic count. Names should end in _total.
+	OPENAVB_METRIC_COUNTER,
+	// Current level that can go up or down.
+	OPENAVB_METRIC_GAUGE,
+} openavb_metric_type_t;
+
+typedef struct {
+	const char *pName;
+	const char *pHelp;
+	openavb_metric_type_t type;
+} openavb_metric_def_t;
+
+typedef enum {
+	OPENAVB_METRICS_FORMAT_JSON,
+	OPENAVB_METRICS_FORMAT_PROMETHEUS,
+} openavb_metrics_format_t;
+
+typedef struct openavb_metrics_group {
+	struct openavb_metrics_group *pNext;
+	volatile U32 inUse;
+	// Incremented before and after the labels change. Odd while they are being changed.
+	volatile U32 seq;
+	char stream[OPENAVB_METRICS_LABEL_LEN];
+	char role[OPENAVB_METRICS_LABEL_LEN];
+	char name[OPENAVB_METRICS_LABEL_LEN];
+	const openavb_metric_def_t *pDefs;
+	U32 count;
+	volatile U64 values[OPENAVB_METRICS_MAX_VALUES];
+} openavb_metrics_group_t;
+
+// Open a group for a stream. pDefs must stay valid until the group is closed. Returns NULL on failure.
+openavb_metrics_group_t *openavbMetricsGroupOpen(const char *pStream, const char *pRole, const char *pName, const openavb_metric_def_t *pDefs, U32 count);
+
+// Close a group. It is no longer reported and may be handed out again.
+void openavbMetricsGroupClose(openavb_metrics_group_t *pGroup);
+
+// Write all open groups to pFile. Returns the number of groups written.
+int openavbMetricsWrite(FILE *pFile, openavb_metrics_format_t format);
+
+// Start serving the metrics on a unix stream socket at pPath (OPENAVB_METRICS_UNIX_PATH if NULL).
+// A client sends "GET /metrics" for Prometheus text or "GET /metrics.json" for JSON. Plain "json" or
+// "prometheus" lines without HTTP are also accepted. The connection is closed after the response.
+bool openavbMetricsServerStart(const char *pPath);
+
+// Stop the server and remove the socket.
+void openavbMetricsServerStop(void);
+
+// Add to a counter or gauge.
+static inline void openavbMetricsAdd(openavb_metrics_group_t *pGroup, U32 idx, U64 val)
+{
+	if (pGroup && idx < pGroup->count) {
+		__sync_fetch_and_add(&pGroup->values[idx], val);
+	}
+}
+
+// Set a gauge.
+static inline void openavbMetricsSet(openavb_metrics_group_t *pGroup, U32 idx, U64 val)
+{
+	if (pGroup && idx < pGroup->count) {
+		U64 old;
+		do {
+			old = pGroup->values[idx];
+		} while (!__sync_bool_compare_and_swap(&pGroup->values[idx], old, val));
+	}
+}
+
+// Read a value.
+static inline U64 openavbMetricsGet(openavb_metrics_group_t *pGroup, U32 idx)
+{
+	if (pGroup && idx < pGroup->count) {
+		return __sync_add_and_fetch(&pGroup->values[idx], 0);
+	}
+	return 0;
+}
+
+#endif // OPENAVB_METRICS_H
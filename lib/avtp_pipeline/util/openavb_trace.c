@@ -0,0 +1,417 @@
+/*************************************************************************************************************
+Copyright (c) 2012-2015, Symphony Teleca Corporation, a Harman International Industries, Incorporated company
+Copyright (c) 2016-2017, Harman International Industries, Incorporated
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS LISTED "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS LISTED BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Attributions: The inih library portion of the source code is licensed from
+Brush Technology and Ben Hoyt - Copyright (c) 2009, Brush Technology and Copyright (c) 2009, Ben Hoyt.
+Complete license and copyright information can be found at
+https://github.com/benhoyt/inih/commit/74d2ca064fb293bc60a77b0bd068075b293cf175.
+*************************************************************************************************************/
+
+/*
+* MODULE SUMMARY : Runtime switchable trace ring (AVB_TRACE_MODE_RING).
+*
+* Each thread that hits an enabled trace point gets a ring of AVB_TRACE_RING_EVENTS events
+* which keeps the most recent events. Recording only stores the trace point and a raw timestamp.
+* avbTraceDump() converts the rings into a Chrome trace JSON file.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "openavb_types_pub.h"
+#include "openavb_platform_pub.h"
+#include "openavb_trace_pub.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TRACE_TSC 1
+#endif
+
+#define	AVB_LOG_COMPONENT	"Trace"
+#include "openavb_log_pub.h"
+
+#define TRACE_FEATURES_LEN		256
+#define TRACE_THREAD_NAME_LEN	16
+#define TRACE_MAX_RINGS			64
+#define TRACE_FEATURE_PREFIX	"AVB_TRACE_"
+
+typedef struct {
+	U64 timestamp;
+	const avb_trace_site_t *pSite;
+	U32 type;
+} trace_event_t;
+
+typedef struct trace_ring {
+	struct trace_ring *pNext;
+	volatile U32 inUse;
+	U32 head;							// Written by the owning thread only
+	U32 dumped;							// Value of head at the last dump
+	long tid;
+	char threadName[TRACE_THREAD_NAME_LEN];
+	trace_event_t events[AVB_TRACE_RING_EVENTS];
+} trace_ring_t;
+
+volatile U32 avbTraceGen = 0;
+
+static U32 traceLastGen = 0;
+static char traceFeatures[TRACE_FEATURES_LEN] = "";
+static char traceFileName[TRACE_FEATURES_LEN] = AVB_TRACE_RING_FILE;
+static volatile bool traceDumpRequested = FALSE;
+
+static trace_ring_t *volatile traceRings = NULL;
+static __thread trace_ring_t *pTraceThreadRing = NULL;
+static pthread_key_t traceThreadKey;
+static bool traceReady = FALSE;
+
+static U64 traceTicks0;
+static U64 traceNsec0;
+
+static inline U64 x_traceTimestamp(void)
+{
+#if TRACE_TSC
+	return __rdtsc();
+#else
+	U64 nowNsec = 0;
+	CLOCK_GETTIME64(OPENAVB_CLOCK_MONOTONIC, &nowNsec);
+	return nowNsec;
+#endif
+}
+
+static void x_traceThreadExit(void *pv)
+{
+	trace_ring_t *pRing = (trace_ring_t *)pv;
+
+	// The events stay in the ring until another thread reuses it.
+	pTraceThreadRing = NULL;
+	__sync_synchronize();
+	pRing->inUse = 0;
+}
+
+static trace_ring_t *x_traceThreadRing(void)
+{
+	trace_ring_t *pRing = pTraceThreadRing;
+	if (pRing || !traceReady) {
+		return pRing;
+	}
+
+	// Reuse the ring of an exited thread once its events have been written. Past
+	// TRACE_MAX_RINGS the oldest undumped events of exited threads are given up.
+	U32 ringCnt = 0;
+	for (pRing = traceRings; pRing; pRing = pRing->pNext, ringCnt++) {
+		if (!pRing->inUse && pRing->dumped == pRing->head && __sync_bool_compare_and_swap(&pRing->inUse, 0, 1)) {
+			break;
+		}
+	}
+	if (!pRing && ringCnt >= TRACE_MAX_RINGS) {
+		for (pRing = traceRings; pRing; pRing = pRing->pNext) {
+			if (!pRing->inUse && __sync_bool_compare_and_swap(&pRing->inUse, 0, 1)) {
+				pRing->dumped = pRing->head;
+				break;
+			}
+		}
+	}
+
+	if (!pRing) {
+		pRing = calloc(1, sizeof(trace_ring_t));
+		if (!pRing) {
+			return NULL;
+		}
+		pRing->inUse = 1;
+		do {
+			pRing->pNext = traceRings;
+		} while (!__sync_bool_compare_and_swap(&traceRings, pRing->pNext, pRing));
+	}
+
+	pRing->tid = syscall(SYS_gettid);
+	if (pthread_getname_np(pthread_self(), pRing->threadName, TRACE_THREAD_NAME_LEN) != 0) {
+		pRing->threadName[0] = 0x00;
+	}
+	pthread_setspecific(traceThreadKey, pRing);
+	pTraceThreadRing = pRing;
+	return pRing;
+}
+
+// Feature names are matched with or without the AVB_TRACE_ prefix.
+static bool x_traceFeatureEnabled(const char *pFeature)
+{
+	size_t prefixLen = strlen(TRACE_FEATURE_PREFIX);
+	const char *pName = pFeature;
+	if (strncmp(pName, TRACE_FEATURE_PREFIX, prefixLen) == 0) {
+		pName += prefixLen;
+	}
+	size_t nameLen = strlen(pName);
+
+	const char *p = traceFeatures;
+	while (*p) {
+		size_t tokenLen = strcspn(p, ", ");
+		if (tokenLen) {
+			const char *pToken = p;
+			size_t len = tokenLen;
+			if (len > prefixLen && strncmp(pToken, TRACE_FEATURE_PREFIX, prefixLen) == 0) {
+				pToken += prefixLen;
+				len -= prefixLen;
+			}
+			if ((len == 3 && strncmp(pToken, "ALL", 3) == 0)
+				|| (len == nameLen && strncmp(pToken, pName, len) == 0)) {
+				return TRUE;
+			}
+		}
+		p += tokenLen;
+		if (*p) {
+			p++;
+		}
+	}
+	return FALSE;
+}
+
+void avbTraceRingFn(avb_trace_site_t *pSite, avb_trace_ring_type_t type)
+{
+	U32 gen = avbTraceGen;
+	if (pSite->gen != gen) {
+		pSite->bEnabled = x_traceFeatureEnabled(pSite->pFeature);
+		__sync_synchronize();
+		pSite->gen = gen;
+	}
+	if (!pSite->bEnabled) {
+		return;
+	}
+
+	trace_ring_t *pRing = x_traceThreadRing();
+	if (!pRing) {
+		return;
+	}
+
+	U32 head = pRing->head;
+	trace_event_t *pEvent = &pRing->events[head & (AVB_TRACE_RING_EVENTS - 1)];
+	pEvent->timestamp = x_traceTimestamp();
+	pEvent->pSite = pSite;
+	pEvent->type = type;
+	__asm__ __volatile__("" ::: "memory");
+	pRing->head = head + 1;
+}
+
+static void x_traceEnable(void)
+{
+	// Every change of the feature list invalidates the cached trace point state.
+	if (++traceLastGen == 0) {
+		traceLastGen = 1;
+	}
+	avbTraceGen = traceLastGen;
+}
+
+void avbTraceSetFeatures(const char *pFeatures)
+{
+	avbTraceGen = 0;
+	__sync_synchronize();
+
+	if (!pFeatures || !*pFeatures) {
+		traceFeatures[0] = 0x00;
+		return;
+	}
+
+	strncpy(traceFeatures, pFeatures, TRACE_FEATURES_LEN - 1);
+	traceFeatures[TRACE_FEATURES_LEN - 1] = 0x00;
+	x_traceEnable();
+	AVB_LOGF_INFO("Tracing enabled for: %s", traceFeatures);
+}
+
+void avbTraceToggle(void)
+{
+	if (avbTraceGen) {
+		avbTraceGen = 0;
+		traceDumpRequested = TRUE;
+	}
+	else {
+		if (!traceFeatures[0]) {
+			strcpy(traceFeatures, "ALL");
+		}
+		x_traceEnable();
+	}
+}
+
+static void x_traceJsonString(FILE *pFile, const char *pStr)
+{
+	fputc('"', pFile);
+	for (; *pStr; pStr++) {
+		if (*pStr == '"' || *pStr == '\\') {
+			fputc('\\', pFile);
+		}
+		if ((unsigned char)*pStr >= 0x20) {
+			fputc(*pStr, pFile);
+		}
+	}
+	fputc('"', pFile);
+}
+
+bool avbTraceDump(const char *pFileName)
+{
+	if (!traceReady) {
+		return FALSE;
+	}
+
+	FILE *pFile = fopen(pFileName, "w");
+	if (!pFile) {
+		AVB_LOGF_ERROR("Failed to open trace file: %s", pFileName);
+		return FALSE;
+	}
+
+	// Convert the raw timestamps to usec since avbTraceInit().
+	double usecPerTick = 0.001;
+#if TRACE_TSC
+	U64 nowNsec = 0;
+	CLOCK_GETTIME64(OPENAVB_CLOCK_MONOTONIC, &nowNsec);
+	U64 nowTicks = __rdtsc();
+	if (nowNsec > traceNsec0 && nowTicks > traceTicks0) {
+		usecPerTick = (double)(nowNsec - traceNsec0) / (double)(nowTicks - traceTicks0) / 1000.0;
+	}
+#endif
+
+	int pid = GET_PID();
+	U32 eventCnt = 0;
+	bool bFirst = TRUE;
+	trace_ring_t *pRing;
+
+	fprintf(pFile, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	for (pRing = traceRings; pRing; pRing = pRing->pNext) {
+		U32 head = pRing->head;
+		__sync_synchronize();
+		U32 idx = pRing->dumped;
+		if (head - idx > AVB_TRACE_RING_EVENTS) {
+			idx = head - AVB_TRACE_RING_EVENTS;
+		}
+		if (idx == head) {
+			continue;
+		}
+
+		fprintf(pFile, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%ld,\"args\":{\"name\":",
+			bFirst ? "" : ",\n", pid, pRing->tid);
+		x_traceJsonString(pFile, pRing->threadName[0] ? pRing->threadName : "thread");
+		fprintf(pFile, "}}");
+		bFirst = FALSE;
+
+		// Exit events without their entry (lost to the ring wrapping) are skipped.
+		int depth = 0;
+		for (; idx != head; idx++) {
+			const trace_event_t *pEvent = &pRing->events[idx & (AVB_TRACE_RING_EVENTS - 1)];
+			const avb_trace_site_t *pSite = pEvent->pSite;
+			const char *pPhase;
+
+			if (!pSite) {
+				continue;
+			}
+			switch (pEvent->type) {
+				case AVB_TRACE_RING_ENTRY:
+				case AVB_TRACE_RING_LOOP_ENTRY:
+					pPhase = "B";
+					depth++;
+					break;
+				case AVB_TRACE_RING_EXIT:
+				case AVB_TRACE_RING_LOOP_EXIT:
+					if (depth == 0) {
+						continue;
+					}
+					pPhase = "E";
+					depth--;
+					break;
+				default:
+					pPhase = "i";
+					break;
+			}
+
+			const char *pCategory = pSite->pFeature;
+			if (strncmp(pCategory, TRACE_FEATURE_PREFIX, strlen(TRACE_FEATURE_PREFIX)) == 0) {
+				pCategory += strlen(TRACE_FEATURE_PREFIX);
+			}
+
+			fprintf(pFile, ",\n{\"ph\":\"%s\",\"pid\":%d,\"tid\":%ld,\"ts\":%.3f,\"cat\":\"%s\",\"name\":\"%s%s\"",
+				pPhase, pid, pRing->tid, (double)(S64)(pEvent->timestamp - traceTicks0) * usecPerTick,
+				pCategory, pSite->pFunction,
+				(pEvent->type == AVB_TRACE_RING_LOOP_ENTRY || pEvent->type == AVB_TRACE_RING_LOOP_EXIT) ? " loop" : "");
+			if (pPhase[0] == 'i') {
+				fprintf(pFile, ",\"s\":\"t\"");
+			}
+			if (pPhase[0] != 'E') {
+				fprintf(pFile, ",\"args\":{\"line\":%d", pSite->line);
+				if (pSite->pFile[0]) {
+					fprintf(pFile, ",\"file\":");
+					x_traceJsonString(pFile, pSite->pFile);
+				}
+				fprintf(pFile, "}");
+			}
+			fprintf(pFile, "}");
+			eventCnt++;
+		}
+		pRing->dumped = head;
+	}
+	fprintf(pFile, "\n]}\n");
+	fclose(pFile);
+
+	AVB_LOGF_INFO("Trace with %u events written to %s", eventCnt, pFileName);
+	return TRUE;
+}
+
+void avbTraceService(void)
+{
+	if (traceDumpRequested) {
+		traceDumpRequested = FALSE;
+		avbTraceDump(traceFileName);
+	}
+}
+
+void avbTraceInit(void)
+{
+	if (!traceReady) {
+		if (pthread_key_create(&traceThreadKey, x_traceThreadExit) != 0) {
+			AVB_LOG_ERROR("Failed to initialize tracing");
+			return;
+		}
+		traceTicks0 = x_traceTimestamp();
+		CLOCK_GETTIME64(OPENAVB_CLOCK_MONOTONIC, &traceNsec0);
+#if !TRACE_TSC
+		traceTicks0 = traceNsec0;
+#endif
+		traceReady = TRUE;
+	}
+
+	const char *pFileName = getenv("OPENAVB_TRACE_FILE");
+	if (pFileName && *pFileName) {
+		strncpy(traceFileName, pFileName, TRACE_FEATURES_LEN - 1);
+		traceFileName[TRACE_FEATURES_LEN - 1] = 0x00;
+	}
+	avbTraceSetFeatures(getenv("OPENAVB_TRACE"));
+}
+
+void avbTraceExit(void)
+{
+	if (avbTraceGen || traceDumpRequested) {
+		avbTraceGen = 0;
+		traceDumpRequested = FALSE;
+		avbTraceDump(traceFileName);
+	}
+}